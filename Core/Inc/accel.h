@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file           : accel.h
+  * @brief          : LIS3DSH accelerometer on SPI1, with its FIFO read in one
+  *                   DMA burst per interrupt into buffers handed to a task.
+  ******************************************************************************
+  * The sensor samples into its 32 deep FIFO with no CPU involvement.  Every
+  * accelBURST_SAMPLES samples it pulses MEMS_INT2, and the EXTI1 interrupt
+  * starts a DMA read of the FIFO status and then of every queued sample, in
+  * one burst, into one of two buffers.  The reader is handed that buffer as it
+  * is, with no copy, and gives it back with vAccelRelease().  While it holds
+  * one buffer and the other is full, reads wait and the samples queue up in
+  * the sensor's FIFO instead.
+  *
+  * A reader that only wants the current orientation calls xAccelGetLatest()
+  * instead, which hands it the newest sample of the last burst through a
+  * mailbox, see mailbox.h, whatever the buffers are doing.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ACCEL_H
+#define __ACCEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* One sample as the sensor reports it, 0.06 mg per count at the +-2 g scale. */
+typedef struct
+{
+  int16_t sX;
+  int16_t sY;
+  int16_t sZ;
+} AccelSample_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Samples the sensor's FIFO holds. */
+#define accelFIFO_DEPTH             32U
+
+/* Samples between interrupts, at most accelFIFO_DEPTH.  What is left of the
+   FIFO is the time the reader may hold a buffer before samples are lost. */
+#ifndef accelBURST_SAMPLES
+#define accelBURST_SAMPLES          16U
+#endif
+
+/* Output data rate, as CTRL_REG4 ODR code: 4 is 25 Hz, 6 is 100 Hz, 7 is
+   400 Hz. */
+#ifndef accelODR_CODE
+#define accelODR_CODE               6U
+#endif
+
+/* Fastest SPI clock the LIS3DSH takes. */
+#define accelSPI_MAX_HZ             10000000UL
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xAccelStart(void);
+size_t xAccelReceive(const AccelSample_t **ppxSamples, TickType_t xTicksToWait);
+void vAccelRelease(void);
+BaseType_t xAccelGetLatest(AccelSample_t *pxSample);
+uint32_t ulAccelGetOverruns(void);
+uint32_t ulAccelGetErrors(void);
+BaseType_t xAccelIsBusy(void);
+void vAccelUpdateClock(void);
+void vAccelExtiIRQHandler(void);
+void vAccelDmaIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ACCEL_H */
@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file           : audio.h
+  * @brief          : Audio output through the CS43L22 codec, streamed from a
+  *                   stream buffer to I2S3 by circular DMA.
+  ******************************************************************************
+  * A producer task writes interleaved 16 bit stereo frames with
+  * xAudioWrite(), which blocks while the stream buffer is full.  DMA1 Stream7
+  * plays a buffer of two halves round and round, and its half and complete
+  * transfer interrupts refill the half just played straight from the stream
+  * buffer.  The refill does not wait for any task, so it is never later than
+  * the interrupt latency, and a half played is always either the next frames
+  * in order or silence.
+  *
+  * A frame written now is heard at most audioLATENCY_US later: the stream
+  * buffer and both halves of the DMA buffer ahead of it.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_H
+#define __AUDIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Sample rate, 48000 or 44100.  Exact on the HSE clock profiles. */
+#ifndef audioSAMPLE_RATE_HZ
+#define audioSAMPLE_RATE_HZ         48000U
+#endif
+
+/* Frames in each half of the DMA buffer, so also the time the refill has
+   before the DMA comes back round to the half it refills. */
+#ifndef audioHALF_FRAMES
+#define audioHALF_FRAMES            240U
+#endif
+
+/* Frames the stream buffer holds ahead of the DMA buffer, at least three
+   halves. */
+#ifndef audioSTREAM_FRAMES
+#define audioSTREAM_FRAMES          (4U * audioHALF_FRAMES)
+#endif
+
+/* Left and right. */
+#define audioCHANNELS               2U
+#define audioFRAME_BYTES            (audioCHANNELS * sizeof(int16_t))
+
+#define audioLATENCY_US             ((uint32_t) ((((uint64_t) audioSTREAM_FRAMES + (2U * audioHALF_FRAMES)) * \
+                                                  1000000ULL) / audioSAMPLE_RATE_HZ))
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xAudioInit(void);
+size_t xAudioWrite(const int16_t *psFrames, size_t xFrames, TickType_t xTicksToWait);
+void vAudioStop(void);
+uint32_t ulAudioGetUnderruns(void);
+uint32_t ulAudioGetErrors(void);
+BaseType_t xAudioIsBusy(void);
+void vAudioDmaIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AUDIO_H */
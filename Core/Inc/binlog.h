@@ -0,0 +1,117 @@
+/**
+  ******************************************************************************
+  * @file           : binlog.h
+  * @brief          : Log sites whose formatting is deferred to the host: the
+  *                   target sends a format string ID and the raw arguments.
+  ******************************************************************************
+  * BINLOG("fmt", args...) keeps the format string in the .binlog section,
+  * which the linker scripts leave in the ELF and out of flash.  With
+  * binlogENABLE set a call queues one record on the log transport:
+  *
+  *   uint8_t  ucSync       binlogSYNC, never a text byte
+  *   uint8_t  ucArgCount   with binlogCRC_FLAG set if a checksum follows
+  *   uint16_t usFormat     offset of the format string in .binlog
+  *   uint32_t ulTimestamp  ulTimebaseNowUs()
+  *   uint32_t ulArgs[ucArgCount]
+  *   uint32_t ulCrc        with binlogCRC, ulCrcComputeWords() of the above
+  *
+  * all little endian, and Tools/binlog_decode.py turns the records back into
+  * text with the strings from Debug/Lab4.elf.  Text from xLogWrite() and
+  * xLogPrintf() can share the stream.  Without binlogENABLE the same sites
+  * format on the target through xLogPrintf(), without the timestamp.
+  *
+  * Arguments are stored as 32 bit words, so formats may only use the integer
+  * and %c conversions of fmt.h.  Print addresses with 0x%08lx and a cast
+  * rather than %p, and note that %s would only send the address.  GCC checks
+  * each site's arguments against its format either way.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BINLOG_H
+#define __BINLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fmt.h"
+#include "log.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* 1 to send records, 0 to format on the target. */
+#ifndef binlogENABLE
+#define binlogENABLE                0
+#endif
+
+/* 1 to end each record with a CRC-32 from the CRC unit, so the decoder can
+   tell a damaged record from a good one. */
+#ifndef binlogCRC
+#define binlogCRC                   1
+#endif
+
+/* First byte of a record; text on this UART is 7 bit ASCII. */
+#define binlogSYNC                  0xB1U
+
+/* Most arguments one site may pass. */
+#define binlogMAX_ARGS              8U
+
+/* Set in ucArgCount when the record ends with a checksum. */
+#define binlogCRC_FLAG              0x80U
+
+/* Exported macro ------------------------------------------------------------*/
+#if (binlogENABLE == 1)
+
+#define BINLOG(pcFormat, ...)                                                       \
+  do                                                                                \
+  {                                                                                 \
+    static const char cBinLogFormat[] __attribute__((section(".binlog"), used)) =   \
+      pcFormat;                                                                     \
+    const uint32_t ulBinLogArgs[] = { 0U, ##__VA_ARGS__ };                          \
+    _Static_assert((sizeof(ulBinLogArgs) / sizeof(ulBinLogArgs[0])) <=              \
+                   (binlogMAX_ARGS + 1U), "too many BINLOG() arguments");           \
+    if (0)                                                                          \
+    {                                                                               \
+      vBinLogCheckFormat(pcFormat, ##__VA_ARGS__);                                  \
+    }                                                                               \
+    (void) xBinLogWrite((uint16_t) (uintptr_t) cBinLogFormat, &ulBinLogArgs[1],     \
+                        (sizeof(ulBinLogArgs) / sizeof(ulBinLogArgs[0])) - 1U);     \
+  } while (0)
+
+#else
+
+#define BINLOG(pcFormat, ...)       ((void) xLogPrintf(pcFormat, ##__VA_ARGS__))
+
+#endif /* binlogENABLE */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint8_t ucSync;
+  uint8_t ucArgCount;
+  uint16_t usFormat;
+  uint32_t ulTimestamp;
+} BinLogHeader_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+size_t xBinLogWrite(uint16_t usFormat, const uint32_t *pulArgs, size_t xArgCount);
+
+/**
+  * @brief  Never called; lets GCC check a BINLOG() site's arguments.
+  * @retval None
+  */
+static inline void fmtCHECK(1, 2) vBinLogCheckFormat(const char *pcFormat, ...)
+{
+  (void) pcFormat;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BINLOG_H */
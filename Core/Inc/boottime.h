@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file           : boottime.h
+  * @brief          : Boot trace of DWT cycle stamps, from reset to the first
+  *                   task switch.
+  ******************************************************************************
+  * Reset_Handler starts the DWT cycle counter first thing and stamps the end
+  * of each startup phase; main() and the port stamp the rest with
+  * vBootTimeMark().  The stamps live in .noinit, so the bss fill leaves them
+  * alone.  Once the scheduler is running, one line per phase is logged:
+  *
+  *   boot <phase>: <cycles> cycles <us> us
+  *
+  * followed by "boot total: <us> us", for Tools/boottime_report.py.
+  *
+  * Along with its cycle count each stamp keeps the core clock at the time it
+  * was taken, and a phase is converted to microseconds at the clock it ended
+  * on.  The startup phases run on the 16 MHz HSI the core resets to; the
+  * phases that switch clocks are only approximate in microseconds.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BOOTTIME_H
+#define __BOOTTIME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Phases in boot order, each stamped as it ends.  The first three are stamped
+   by the startup code, which addresses them by byte offset. */
+typedef enum
+{
+  BOOT_PHASE_COPY = 0,          /*!< .data and .ccmram copied.                */
+  BOOT_PHASE_ZERO,              /*!< .bss cleared.                            */
+  BOOT_PHASE_CRT,               /*!< SystemInit() and constructors run.       */
+  BOOT_PHASE_HAL_INIT,          /*!< HAL_Init(), including the TIM5 timebase,
+                                     and with clockFAST_BOOT all of the clock
+                                     set up, leaving the next two empty.      */
+  BOOT_PHASE_CLOCK_CONFIG,      /*!< SystemClock_Config().                    */
+  BOOT_PHASE_CLOCK_PROFILE,     /*!< Switch to clockBOOT_PROFILE.             */
+  BOOT_PHASE_PINMUX,            /*!< vPinmuxInit().                           */
+  BOOT_PHASE_PERIPHERALS,       /*!< MX_DMA_Init() and the UART.              */
+  BOOT_PHASE_APP_INIT,          /*!< Trace, low power and periodic jobs.      */
+  BOOT_PHASE_TASKS,             /*!< vTaskRegistryStart().                    */
+  BOOT_PHASE_SCHEDULER,         /*!< vTaskStartScheduler() to the first task. */
+  BOOT_PHASE_COUNT
+} BootPhase_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Core clock of the phases stamped by the startup code. */
+#define boottimeSTARTUP_HZ          16000000UL
+
+/* Exported variables --------------------------------------------------------*/
+extern uint32_t ulBootTraceCycles[BOOT_PHASE_COUNT];
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vBootTimeMark(BootPhase_t ePhase);
+BaseType_t xBootTimeReportStart(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BOOTTIME_H */
@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file           : button.h
+  * @brief          : Debounced user button events from EXTI line 0, delivered
+  *                   as task notification bits.
+  ******************************************************************************
+  * The first edge after a quiet period is taken at once: the EXTI0 interrupt
+  * timestamps it on the timebase counter, notifies the listener and masks the
+  * line.  A timebase one-shot event buttonDEBOUNCE_US later samples the pin;
+  * if it settled the other way, that is reported as the next edge and the
+  * line stays masked for another period, otherwise the line is opened again.
+  * The bounce that follows an edge so never reaches the listener, and nothing
+  * runs between presses, so the low power idle can stop the clocks with the
+  * button as a wakeup source.
+  *
+  * A press reaches the listener after the interrupt entry and one
+  * notification, a few microseconds, however long the debounce period.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BUTTON_H
+#define __BUTTON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Time the contacts are given to settle after an edge. */
+#ifndef buttonDEBOUNCE_US
+#define buttonDEBOUNCE_US           20000UL
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vButtonInit(void);
+void vButtonSetListener(TaskHandle_t xTask, uint32_t ulPress, uint32_t ulRelease);
+BaseType_t xButtonIsPressed(void);
+uint32_t ulButtonGetEdgeUs(void);
+uint32_t ulButtonGetPresses(void);
+void vButtonExtiIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BUTTON_H */
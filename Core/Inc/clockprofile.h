@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : clockprofile.h
+  * @brief          : System clock profiles and switching between them at run
+  *                   time.
+  ******************************************************************************
+  * Each profile fixes the clock source, PLL, bus dividers, flash wait states,
+  * regulator scale and ART prefetch.  Wait states are those of RM0090 table 10
+  * for a 2.7 V to 3.6 V supply, as on the Discovery board, whose 8 MHz HSE
+  * comes from the ST-LINK MCO and is therefore used in bypass mode.
+  *
+  * Switching keeps the TIM5 timebase counting and the tick rate unchanged,
+  * because HAL_RCC_ClockConfig() re-runs HAL_InitTick(), and reprograms the
+  * USART2 baud rate divisor through uartline.h.  configCPU_CLOCK_HZ follows SystemCoreClock.
+  *
+  * The PLLI2S clocks I2S2 and I2S3 and shares the main PLL's source and input
+  * divider.  It runs while any driver holds it, and is stopped across a switch
+  * that changes its input and started again at clockI2SCLK_HZ after it.
+  *
+  * Drivers that need the HSE profiles, for the exact PLLI2S input or the
+  * 48 MHz PLLQ output, hold them; the governor then stays off the low power
+  * profile, and leaves it if it was on it.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CLOCKPROFILE_H
+#define __CLOCKPROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  CLOCK_PROFILE_PERFORMANCE = 0,  /*!< 168 MHz from the HSE, APB1 42 MHz.      */
+  CLOCK_PROFILE_BALANCED,         /*!< 84 MHz from the HSE, APB1 42 MHz.       */
+  CLOCK_PROFILE_LOW_POWER,        /*!< 25 MHz from the HSI, HSE off.           */
+  CLOCK_PROFILE_COUNT
+} ClockProfile_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Profile SystemClock_Config() starts in. */
+#define clockBOOT_PROFILE           CLOCK_PROFILE_PERFORMANCE
+
+/* 1 to start the clocks with xClockProfileFastBoot(), on the LL API, in
+   place of SystemClock_Config() and a switch to clockBOOT_PROFILE. */
+#ifndef clockFAST_BOOT
+#define clockFAST_BOOT              1
+#endif
+
+/* Polls of HSERDY, and of PLLRDY, before xClockProfileFastBoot() gives up on
+   the HSE; about 100 ms, HSE_STARTUP_TIMEOUT, on the 16 MHz HSI. */
+#ifndef clockFAST_BOOT_SPINS
+#define clockFAST_BOOT_SPINS        200000UL
+#endif
+
+/* PLLI2S output and its R divider.  86 MHz with R 3 gives I2S3 48 kHz with
+   MCLK out; 135.5 MHz with R 2 gives it 44.1 kHz. */
+#ifndef clockI2SCLK_HZ
+#define clockI2SCLK_HZ              86000000UL
+#endif
+#ifndef clockPLLI2S_R
+#define clockPLLI2S_R               3U
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xClockProfileFastBoot(void);
+BaseType_t xClockProfileSet(ClockProfile_t eProfile);
+ClockProfile_t eClockProfileGet(void);
+uint32_t ulClockProfileGetSysclkHz(ClockProfile_t eProfile);
+uint32_t ulClockProfileGetPclk1Hz(ClockProfile_t eProfile);
+BaseType_t xClockProfileI2SAcquire(void);
+void vClockProfileI2SRelease(void);
+void vClockProfileHseHold(void);
+void vClockProfileHseRelease(void);
+BaseType_t xClockProfileHseHeld(void);
+uint32_t ulClockProfileGetI2SHz(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CLOCKPROFILE_H */
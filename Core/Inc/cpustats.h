@@ -0,0 +1,110 @@
+/**
+  ******************************************************************************
+  * @file           : cpustats.h
+  * @brief          : Compact binary snapshot of per task CPU load, context
+  *                   switch counts and stack high water marks.
+  ******************************************************************************
+  * A snapshot is one CpuStatsHeader_t followed by ucTaskCount CpuStatsTask_t
+  * records and then ucWakeCount CpuStatsWake_t records, little endian and
+  * naturally aligned so that no packing is needed.  Everything but the stack
+  * high water marks covers the window since the previous snapshot.
+  *
+  * Version 2 added the energy figures.  Each task's running cycles are split
+  * by the clock profile they ran at, ucProfileCount of them, 0 without
+  * configUSE_TASK_ENERGY_STATS, and a task is given the tickless wakes after
+  * which it was the first to run.  The header counts the sleeps and the wake
+  * records name the interrupts that ended them, the commonest
+  * cpustatsMAX_WAKES; both are 0 without tickless idle.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CPUSTATS_H
+#define __CPUSTATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Start of every snapshot, so that a host can find it in the log stream. */
+#define cpustatsMAGIC               0xC5A7U
+#define cpustatsVERSION             2U
+
+/* Most tasks a snapshot can describe; uxTaskGetSystemState() fails outright
+   if more tasks than this exist. */
+#ifndef cpustatsMAX_TASKS
+#define cpustatsMAX_TASKS           12U
+#endif
+
+/* Task name bytes kept per record, not necessarily NUL terminated. */
+#define cpustatsNAME_LENGTH         8U
+
+/* Clock profiles a task record has room for, those of clockprofile.h. */
+#define cpustatsPROFILES            3U
+
+/* Most wake causes a snapshot names. */
+#ifndef cpustatsMAX_WAKES
+#define cpustatsMAX_WAKES           8U
+#endif
+
+/* CpuStatsWake_t.ucIrq of wakes with no interrupt pending. */
+#define cpustatsWAKE_UNKNOWN        0xFFU
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint16_t usMagic;           /* cpustatsMAGIC. */
+  uint8_t ucVersion;          /* cpustatsVERSION. */
+  uint8_t ucTaskCount;        /* Number of CpuStatsTask_t records that follow. */
+  uint32_t ulWindowCycles;    /* DWT cycles since the previous snapshot. */
+  uint32_t ulTickCount;       /* xTaskGetTickCount() when taken. */
+  uint32_t ulStoppedUs;       /* Time spent in STOP mode. */
+  uint16_t usStops;           /* Sleeps in STOP mode. */
+  uint16_t usShallowSleeps;   /* WFI sleeps a busy peripheral kept out of STOP. */
+  uint8_t ucWakeCount;        /* Number of CpuStatsWake_t records that follow. */
+  uint8_t ucProfileCount;     /* Entries of ulProfileCycles filled in. */
+  uint16_t usReserved;
+} CpuStatsHeader_t;
+
+typedef struct
+{
+  char cName[cpustatsNAME_LENGTH];
+  uint32_t ulSwitchIns;       /* Times switched in during the window. */
+  uint32_t ulProfileCycles[cpustatsPROFILES]; /* Running cycles per ClockProfile_t. */
+  uint16_t usLoadPermille;    /* Share of the window spent running, 0-1000. */
+  uint16_t usStackHighWater;  /* Least free stack ever seen, in words. */
+  uint16_t usWakeups;         /* Sleeps after which it ran first. */
+  uint16_t usReserved;
+  uint8_t ucTaskNumber;       /* Low byte of the kernel's unique task number. */
+  uint8_t ucPriority;         /* Current, possibly inherited, priority. */
+  uint8_t ucState;            /* eTaskState. */
+  uint8_t ucReserved;
+} CpuStatsTask_t;
+
+typedef struct
+{
+  uint8_t ucIrq;              /* IRQn_Type, or cpustatsWAKE_UNKNOWN. */
+  uint8_t ucReserved;
+  uint16_t usCount;           /* Sleeps it ended, saturating. */
+} CpuStatsWake_t;
+
+/* Bytes needed for a snapshot of cpustatsMAX_TASKS tasks. */
+#define cpustatsSNAPSHOT_SIZE       (sizeof(CpuStatsHeader_t) + (cpustatsMAX_TASKS * sizeof(CpuStatsTask_t)) + \
+                                     (cpustatsMAX_WAKES * sizeof(CpuStatsWake_t)))
+
+/* Exported functions prototypes ---------------------------------------------*/
+size_t xCpuStatsSnapshot(void *pvBuffer, size_t xBufferLength);
+size_t xCpuStatsSend(void);
+void vCpuStatsPrintSwitchTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CPUSTATS_H */
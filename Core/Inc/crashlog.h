@@ -0,0 +1,103 @@
+/**
+  ******************************************************************************
+  * @file           : crashlog.h
+  * @brief          : Crash and trace log that survives a reset in RAM and a
+  *                   power cycle in flash.
+  ******************************************************************************
+  * Every log message, and anything passed to vCrashLogAppend(), is also
+  * copied into a small ring in .noinit, overwriting the oldest bytes.  A
+  * panic (Error_Handler(), a failed configASSERT(), one of the kernel's
+  * fatal hooks or a fault, see fault.h) notes its reason in the ring's
+  * header and resets the core, and the ring is still there when the next
+  * boot calls vCrashLogInit().
+  * While a debugger is attached a panic stops where it is instead.
+  *
+  * vCrashLogInit() writes what the ring held, with the panic and the reset
+  * flags, as one record to flash, and xCrashLogReportStart() logs it once the
+  * scheduler runs.  Records are appended to one of two 128 KB sectors at the
+  * top of flash, 10 and 11, which the linker script keeps free of code; when
+  * one is full the other is erased and takes over, so the sectors wear
+  * evenly and the older one's records remain until then.  An erase stalls
+  * the boot for a second or two, once every hundred or so records.
+  *
+  * A record is a CrashLogRecord_t followed by ulLength bytes of text padded
+  * to a word, with ulCrc the CRC-32/MPEG-2 of everything after it.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CRASHLOG_H
+#define __CRASHLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+  * @brief  Record header as written to flash.
+  */
+typedef struct
+{
+  uint32_t ulMagic;       /*!< crashlogRECORD_MAGIC.                          */
+  uint32_t ulCrc;         /*!< Over the rest of the header and the text.     */
+  uint32_t ulSequence;    /*!< Counts up from 1 over both sectors.           */
+  uint32_t ulReason;      /*!< One of the crashlogREASON_* codes.            */
+  uint32_t ulArg;         /*!< Reason specific, an address or a line.        */
+  uint32_t ulResetFlags;  /*!< RCC->CSR as the boot found it.                */
+  uint32_t ulLength;      /*!< Bytes of text following the header.           */
+} CrashLogRecord_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Why the previous run ended. */
+#define crashlogREASON_NONE             0U  /* A reset without a panic.      */
+#define crashlogREASON_ERROR_HANDLER    1U  /* ulArg is the caller.          */
+#define crashlogREASON_ASSERT           2U  /* ulArg is the line.            */
+#define crashlogREASON_STACK_OVERFLOW   3U  /* ulArg is the task.            */
+#define crashlogREASON_HEAP_CORRUPTED   4U  /* ulArg is the block.           */
+#define crashlogREASON_FPU_MISUSE       5U  /* ulArg is the task.            */
+#define crashlogREASON_FAULT            6U  /* ulArg is the faulting pc.     */
+#define crashlogREASON_WATCHDOG         7U  /* ulArg is the heartbeat, or 0
+                                               for an IWDG reset.            */
+#define crashlogREASON_COUNT            8U
+
+#define crashlogRECORD_MAGIC            0x474C5243UL  /* "CRLG" */
+
+/* Bytes of text the RAM ring keeps, a power of two. */
+#ifndef crashlogRAM_SIZE
+#define crashlogRAM_SIZE                1024U
+#endif
+
+/* Copy every log message into the ring. */
+#ifndef crashlogMIRROR_LOG
+#define crashlogMIRROR_LOG              1
+#endif
+
+/* Reset after a panic rather than stop, when no debugger is attached. */
+#ifndef crashlogRESET_ON_PANIC
+#define crashlogRESET_ON_PANIC          1
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vCrashLogInit(void);
+void vCrashLogAppend(const void *pvData, size_t xLength);
+void vCrashLogPanic(uint32_t ulReason, uint32_t ulArg) __attribute__((noreturn));
+void vCrashLogAssert(const char *pcFile, uint32_t ulLine) __attribute__((noreturn));
+const CrashLogRecord_t *pxCrashLogLatest(void);
+uint32_t ulCrashLogGetResetFlags(void);
+BaseType_t xCrashLogReportStart(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRASHLOG_H */
@@ -0,0 +1,58 @@
+/**
+  ******************************************************************************
+  * @file           : crc.h
+  * @brief          : CRC-32 checksums on the CRC calculation unit, fed by the
+  *                   CPU for short buffers and by DMA2 for long ones.
+  ******************************************************************************
+  * The unit computes CRC-32/MPEG-2: polynomial 0x04C11DB7, initial value
+  * 0xFFFFFFFF, no reflection and no final XOR, one 32 bit word at a time.  A
+  * buffer is taken as little endian words, the last one padded with zero
+  * bytes, which Tools/binlog_decode.py repeats on the host.  A word costs
+  * four AHB cycles.
+  *
+  * ulCrcCompute() may be called from anywhere: the unit is held with
+  * interrupts masked up to configMAX_SYSCALL_INTERRUPT_PRIORITY for as long
+  * as one buffer takes.  From a task, buffers of crcDMA_THRESHOLD bytes or
+  * more are fed by DMA2 Stream2 instead and the task blocks until done; a
+  * caller that finds the unit busy with such a feed computes the same value
+  * in software rather than wait.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CRC_H
+#define __CRC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Shortest buffer a task has fed by DMA rather than the CPU. */
+#ifndef crcDMA_THRESHOLD
+#define crcDMA_THRESHOLD            1024U
+#endif
+
+/* The value of an empty buffer. */
+#define crcINITIAL                  0xFFFFFFFFUL
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xCrcInit(void);
+uint32_t ulCrcCompute(const void *pvData, size_t xLength);
+uint32_t ulCrcComputeWords(const uint32_t *pulWords, size_t xCount);
+uint32_t ulCrcGetSoftwareFallbacks(void);
+BaseType_t xCrcIsBusy(void);
+void vCrcDmaIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRC_H */
@@ -0,0 +1,105 @@
+/**
+  ******************************************************************************
+  * @file           : deferred.h
+  * @brief          : Deferred interrupt work: handlers post a function and an
+  *                   argument, and a task per level runs them.
+  ******************************************************************************
+  * An interrupt handler that has more to do than clear its flag and move a
+  * byte posts the rest as a bottom half:
+  *
+  *   void USART2_IRQHandler(void)
+  *   {
+  *     uint8_t ucRx = (uint8_t) USART2->DR;
+  *     BaseType_t xWoken = pdFALSE;
+  *
+  *     (void) xDeferredPostFromISR(eDeferredHigh, prvParseByte,
+  *                                 (void *) (uint32_t) ucRx, &xWoken);
+  *     portYIELD_FROM_ISR(xWoken);
+  *   }
+  *
+  * Posting claims a slot in the level's ring with LDREX/STREX and never
+  * masks interrupts, so it costs a few dozen cycles and handlers of any
+  * priority up to configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY may post,
+  * interrupting each other's posts.  Only the first post after the level's
+  * task last looked notifies it; under load the task finds many bottom
+  * halves per wake and runs them deferredBATCH at a time.
+  *
+  * Bottom halves run in order of posting within a level, each to completion
+  * in its level's task, and the high level's task pre-empts the low one's.
+  * They may block, but hold up every later bottom half of their level while
+  * they do.  xTimerPendFunctionCallFromISR() does a similar job, but
+  * INCLUDE_xTimerPendFunctionCall is left at its default of 0, and it would
+  * send every call through the timer command queue to the daemon task, an
+  * extra hop that masks interrupts and runs at the daemon's one priority.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DEFERRED_H
+#define __DEFERRED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*DeferredFunction_t)(void *pvArg);
+
+typedef enum
+{
+  eDeferredHigh = 0,
+  eDeferredLow
+} DeferredLevel_t;
+
+/* Counts for one level since boot. */
+typedef struct
+{
+  uint32_t ulRun;               /*!< Bottom halves run.                        */
+  uint32_t ulDropped;           /*!< Posts refused because the ring was full.  */
+  uint32_t ulWakes;             /*!< Times the task woke to a notification.    */
+  uint32_t ulHighWater;         /*!< Most waiting at the start of a batch.     */
+} DeferredStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+#define deferredLEVELS              2U
+
+/* Bottom halves each level's ring holds; a power of two, at most 256. */
+#ifndef deferredRING_LENGTH
+#define deferredRING_LENGTH         32U
+#endif
+
+/* Bottom halves a task takes from its ring at once.  It yields to tasks of
+   its own priority between batches. */
+#ifndef deferredBATCH
+#define deferredBATCH               8U
+#endif
+
+/* Each level's task, whose stack every bottom half of the level shares. */
+#ifndef deferredSTACK_DEPTH
+#define deferredSTACK_DEPTH         192U
+#endif
+#ifndef deferredPRIORITY_HIGH
+#define deferredPRIORITY_HIGH       (configMAX_PRIORITIES - 2U)
+#endif
+#ifndef deferredPRIORITY_LOW
+#define deferredPRIORITY_LOW        (tskIDLE_PRIORITY + 1U)
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xDeferredPost(DeferredLevel_t eLevel, DeferredFunction_t pxFunction, void *pvArg);
+BaseType_t xDeferredPostFromISR(DeferredLevel_t eLevel, DeferredFunction_t pxFunction, void *pvArg,
+                                BaseType_t *pxHigherPriorityTaskWoken);
+void vDeferredGetStats(DeferredLevel_t eLevel, DeferredStats_t *pxStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DEFERRED_H */
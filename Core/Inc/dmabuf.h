@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file           : dmabuf.h
+  * @brief          : Registry of statically allocated DMA buffers, checked at
+  *                   boot against the memories the DMA controllers can reach.
+  ******************************************************************************
+  * CCM is only wired to the core's D-bus, so a DMA stream pointed at it
+  * transfers nothing useful and raises no error of its own.  Kernel state and
+  * stacks now default to CCM, which makes that mistake easy to make, so every
+  * static DMA buffer is declared with DMA_BUFFER_DEFINE() and
+  * vDmaBufferCheckAll() rejects any that the linker put in CCM.  Buffers from
+  * the heap are covered by heapALLOC_DMA_CAPABLE instead.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DMABUF_H
+#define __DMABUF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  const void *pvBuffer;
+  size_t xLength;
+  const char *pcName;
+} DmaBufferEntry_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Core coupled memory, which no DMA controller can reach. */
+#define dmabufCCM_START             0x10000000UL
+#define dmabufCCM_END               0x10010000UL
+
+/* Exported macro ------------------------------------------------------------*/
+
+/**
+  * @brief  Define a DMA buffer of xCount xType at file scope and register it.
+  * @note   Put static in front for a file local buffer; it applies to the
+  *         buffer, and the registry entry is always local.
+  */
+#define DMA_BUFFER_DEFINE(xType, Name, xCount)                                      \
+  xType Name[(xCount)];                                                             \
+  static const DmaBufferEntry_t x##Name##DmaEntry                                   \
+    __attribute__((section(".dma_registry"), used, aligned(4))) =                   \
+  {                                                                                 \
+    Name, sizeof(Name), #Name                                                       \
+  }
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vDmaBufferCheckAll(void);
+BaseType_t xDmaBufferIsReachable(const void *pvBuffer, size_t xLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DMABUF_H */
@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file           : dmacopy.h
+  * @brief          : Memory to memory copies on DMA2 Stream1, for large
+  *                   copies that can overlap with computation.
+  ******************************************************************************
+  * xDmaCopyStart() takes the engine and starts a copy; the caller carries on
+  * and xDmaCopyWait() blocks on a task notification until the stream is done
+  * and gives the engine back.  Copies shorter than dmacopyTHRESHOLD, or that
+  * touch CCM, which DMA2 cannot reach, are done with memcpy() inside
+  * xDmaCopyStart() instead, so the pair always copies.
+  *
+  * The stream moves a word every few AHB cycles at low priority, about the
+  * rate of a CPU copy, so the gain is the CPU time freed, not a faster copy.
+  * Peripheral streams on DMA2 are served first.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DMACOPY_H
+#define __DMACOPY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Shortest copy worth the stream set up, the interrupt and the two context
+   switches of a wait, about 5 us in all at 168 MHz. */
+#ifndef dmacopyTHRESHOLD
+#define dmacopyTHRESHOLD            512U
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xDmaCopyInit(void);
+BaseType_t xDmaCopyStart(void *pvDest, const void *pvSrc, size_t xLength, TickType_t xTicksToWait);
+BaseType_t xDmaCopyWait(TickType_t xTicksToWait);
+void *pvDmaCopy(void *pvDest, const void *pvSrc, size_t xLength);
+uint32_t ulDmaCopyGetTransfers(void);
+uint32_t ulDmaCopyGetErrors(void);
+BaseType_t xDmaCopyIsBusy(void);
+void vDmaCopyIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DMACOPY_H */
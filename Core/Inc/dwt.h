@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file           : dwt.h
+  * @brief          : DWT cycle counter helpers used for timestamps and
+  *                   cycle accurate measurements.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DWT_H
+#define __DWT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx.h"
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Enable the free running DWT cycle counter.
+  * @note   Safe to call more than once; the counter is only reset the first
+  *         time it is enabled.
+  * @retval None
+  */
+static inline void vDwtInit(void)
+{
+  if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0U)
+  {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0U;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  }
+}
+
+/**
+  * @brief  Read the DWT cycle counter.
+  * @retval Core clock cycles since vDwtInit(), wrapping at 2^32.
+  */
+static inline uint32_t ulDwtCycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DWT_H */
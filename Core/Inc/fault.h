@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file           : fault.h
+  * @brief          : Capture of HardFault, MemManage, BusFault and UsageFault
+  *                   for a post-mortem dump.
+  ******************************************************************************
+  * Each handler saves the stacked frame, r4 to r11, the fault status and
+  * address registers, the running task's name and the first faultSTACK_WORDS
+  * of the stack from the frame up in a FaultRecord_t in .noinit, writes the
+  * same as text to the crash log ring, and panics with crashlogREASON_FAULT.
+  * After the reset the crash log replays the text through the log channel,
+  * and the record stays readable with xFaultGetLast() until the next fault.
+  *
+  * vFaultInit() gives the configurable faults their own handlers, so they
+  * are not escalated to a HardFault and the dump names the real one.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FAULT_H
+#define __FAULT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Words of stack kept, from the exception frame up. */
+#ifndef faultSTACK_WORDS
+#define faultSTACK_WORDS            32U
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+  * @brief  What a fault left behind.  ulFrame and ulStack are only valid as
+  *         far as ulStackWords says, zero if the stack pointer was not in RAM.
+  */
+typedef struct
+{
+  uint32_t ulMagic;
+  uint32_t ulException;                   /*!< 3 HardFault to 6 UsageFault.   */
+  uint32_t ulExcReturn;                   /*!< LR on entry.                   */
+  uint32_t ulSp;                          /*!< Stack the frame was pushed to. */
+  uint32_t ulFrame[8];                    /*!< r0-r3, r12, lr, pc, xpsr.      */
+  uint32_t ulR4ToR11[8];
+  uint32_t ulCfsr;
+  uint32_t ulHfsr;
+  uint32_t ulMmfar;                       /*!< Valid if CFSR MMARVALID.       */
+  uint32_t ulBfar;                        /*!< Valid if CFSR BFARVALID.       */
+  char cTaskName[configMAX_TASK_NAME_LEN];
+  uint32_t ulStackWords;
+  uint32_t ulStack[faultSTACK_WORDS];
+} FaultRecord_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vFaultInit(void);
+const FaultRecord_t *pxFaultGetLast(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FAULT_H */
@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file           : fmt.h
+  * @brief          : Small printf style formatter with no heap, no locale and
+  *                   a fixed stack frame, for the diagnostic paths.
+  ******************************************************************************
+  * Conversions are %d %i %u %x %X %p %s %c and %%.  Flags '-' and '0', a
+  * field width and, for %s, a precision are accepted, either inline or as *.
+  * The h, hh, l and z length modifiers are accepted and ignored, since every
+  * integer argument is 32 bits here; ll, floating point and %n are not
+  * supported and print as '?'.
+  *
+  * The formatter is reentrant and never calls into newlib, so it is safe from
+  * any task or interrupt.  GCC checks the arguments against the format string
+  * at compile time.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FMT_H
+#define __FMT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stddef.h>
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Have GCC check calls like printf(); Format and First count from 1. */
+#define fmtCHECK(Format, First)     __attribute__((format(printf, Format, First)))
+
+/* Exported functions prototypes ---------------------------------------------*/
+size_t xFmtFormat(char *pcBuffer, size_t xLength, const char *pcFormat, ...) fmtCHECK(3, 4);
+size_t xFmtVFormat(char *pcBuffer, size_t xLength, const char *pcFormat, va_list xArgs) fmtCHECK(3, 0);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FMT_H */
@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file           : future.h
+  * @brief          : Futures: results settled once, from a task or an
+  *                   interrupt, that tasks wait on or chain continuations to.
+  ******************************************************************************
+  * A Future_t starts pending and is settled exactly once, resolved with a
+  * value or failed with an error code, typically by the completion interrupt
+  * of the operation it stands for.  Settling it
+  *
+  *   - wakes the task blocked on it in eFutureWait(), xFutureWhenAll() or
+  *     xFutureWhenAny(), and
+  *   - submits its continuation, if xFutureThen() gave it one, to the worker
+  *     pool (see workerpool.h),
+  *
+  * so a flow of several operations can be written as continuations that
+  * start the next one, without a task blocked in each step.
+  *
+  * Waiting tasks are woken through notification index futureNOTIFY_INDEX,
+  * which is theirs to leave alone; index 0 stays free for their own use.
+  * Only one task may wait on a given future at a time.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FUTURE_H
+#define __FUTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "workerpool.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef enum
+{
+  eFuturePending = 0,
+  eFutureResolved,
+  eFutureFailed
+} FutureState_t;
+
+typedef struct xFUTURE Future_t;
+
+/* Run in a worker once the future is settled; the future may be read, and
+   started again with vFutureInit(), from here. */
+typedef void (*FutureContinuation_t)(Future_t *pxFuture, void *pvArg);
+
+/**
+  * @brief  One future.  Owned by the caller, which must keep it alive until
+  *         it is settled and any continuation has run; the fields are
+  *         private to future.c.
+  */
+struct xFUTURE
+{
+  volatile uint8_t ucState;             /*!< A FutureState_t.                  */
+  uint8_t ucLane;                       /*!< Continuation's WorkerPoolLane_t.  */
+  uint32_t ulValue;                     /*!< Result, or error code.            */
+  TaskHandle_t xWaiter;
+  FutureContinuation_t pxContinuation;
+  void *pvContinuationArg;
+};
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Notification index that wakes a waiting task. */
+#ifndef futureNOTIFY_INDEX
+#define futureNOTIFY_INDEX          1U
+#endif
+
+#if (futureNOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES)
+#error futureNOTIFY_INDEX needs configTASK_NOTIFICATION_ARRAY_ENTRIES of at least 2
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vFutureInit(Future_t *pxFuture);
+BaseType_t xFutureResolve(Future_t *pxFuture, uint32_t ulValue);
+BaseType_t xFutureFail(Future_t *pxFuture, uint32_t ulError);
+BaseType_t xFutureResolveFromISR(Future_t *pxFuture, uint32_t ulValue, BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t xFutureFailFromISR(Future_t *pxFuture, uint32_t ulError, BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t xFutureThen(Future_t *pxFuture, WorkerPoolLane_t eLane, FutureContinuation_t pxContinuation,
+                       void *pvArg);
+FutureState_t eFutureGetState(const Future_t *pxFuture);
+uint32_t ulFutureGetValue(const Future_t *pxFuture);
+FutureState_t eFutureWait(Future_t *pxFuture, TickType_t xTicksToWait);
+BaseType_t xFutureWhenAll(Future_t *const pxFutures[], UBaseType_t uxCount, TickType_t xTicksToWait);
+BaseType_t xFutureWhenAny(Future_t *const pxFutures[], UBaseType_t uxCount, TickType_t xTicksToWait,
+                          UBaseType_t *puxIndex);
+uint32_t ulFutureLostContinuations(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FUTURE_H */
@@ -0,0 +1,57 @@
+/**
+  ******************************************************************************
+  * @file           : governor.h
+  * @brief          : Frequency governor stepping between clock profiles on
+  *                   the measured CPU load.
+  ******************************************************************************
+  * A periodic job measures the share of each window the CPU was busy, that
+  * is not in the idle task, against the TIM5 microsecond clock, which keeps
+  * counting across STOP mode where the DWT cycle counter does not.  A busy
+  * window, or a log backlog, jumps straight to the performance profile; a
+  * quiet one steps down one profile at a time, so bursts are served at full
+  * speed and the clock only settles back once they are over.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __GOVERNOR_H
+#define __GOVERNOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "clockprofile.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Sampling window. */
+#ifndef governorPERIOD_MS
+#define governorPERIOD_MS           100U
+#endif
+
+/* Load, in permille of the window, above which the clock goes to full speed
+   and below which it steps down. */
+#ifndef governorRAISE_PERMILLE
+#define governorRAISE_PERMILLE      700U
+#endif
+#ifndef governorLOWER_PERMILLE
+#define governorLOWER_PERMILLE      250U
+#endif
+
+/* Log bytes waiting for DMA that count as a burst whatever the load. */
+#ifndef governorLOG_BACKLOG_BYTES
+#define governorLOG_BACKLOG_BYTES   256U
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xGovernorStart(void);
+uint16_t usGovernorGetLoadPermille(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GOVERNOR_H */
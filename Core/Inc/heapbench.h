@@ -0,0 +1,126 @@
+/**
+  ******************************************************************************
+  * @file           : heapbench.h
+  * @brief          : On-target allocator benchmark: replays alloc/free traces
+  *                   against the heap and logs the results as CSV.
+  ******************************************************************************
+  * With heapbenchENABLE set a task replays every scenario of
+  * heapbenchSCENARIOS once, heapbenchSTART_DELAY_MS after boot, against the
+  * allocator the build selected with configHEAP_IMPLEMENTATION and
+  * if_merge_mem.  Comparing allocators, or merging on and off, takes one
+  * build and one capture each; every row names the allocator it measured.
+  *
+  * Each pvPortMalloc() and vPortFree() is timed with the DWT cycle counter,
+  * lock included.  After each operation the free bytes and the largest free
+  * block are read back, outside the timing, for the fragmentation figures.
+  * The log gets, per scenario, one summary row
+  *
+  *   summary,<heap>,<merge>,<scenario>,<ops>,<malloc min>,<avg>,<max>,
+  *     <free min>,<avg>,<max>,<failed>,<peak frag permille>,<min largest>
+  *
+  * and a sample row every heapbenchSAMPLE_EVERY operations
+  *
+  *   sample,<scenario>,<op>,<free bytes>,<largest free block>
+  *
+  * Fragmentation is 1000 - 1000 * largest free block / free bytes.  Other
+  * tasks keep running and allocating, so bench on a quiet build and compare
+  * the minimums and averages rather than single maximums.
+  *
+  * A scenario frees everything it allocated before the next one starts.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HEAPBENCH_H
+#define __HEAPBENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* 1 to register the benchmark task. */
+#ifndef heapbenchENABLE
+#define heapbenchENABLE             0
+#endif
+
+/* Blocks a scenario may hold at once. */
+#ifndef heapbenchSLOTS
+#define heapbenchSLOTS              32U
+#endif
+
+/* Operations between sample rows, 0 for none. */
+#ifndef heapbenchSAMPLE_EVERY
+#define heapbenchSAMPLE_EVERY       50U
+#endif
+
+/* Left for the boot time allocations to settle. */
+#ifndef heapbenchSTART_DELAY_MS
+#define heapbenchSTART_DELAY_MS     1000U
+#endif
+
+/* Below configHEAP_LOCK_CEILING, like every heap user. */
+#ifndef heapbenchPRIORITY
+#define heapbenchPRIORITY           2U
+#endif
+
+#ifndef heapbenchSEED
+#define heapbenchSEED               0x2545F491UL
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HEAPBENCH_RANDOM = 0,   /*!< Alloc or free a random slot, random sizes.    */
+  HEAPBENCH_LIFO,         /*!< Fill every slot, free newest first.           */
+  HEAPBENCH_FIFO,         /*!< Fill every slot, free oldest first.           */
+  HEAPBENCH_RECORDED      /*!< Replay heapbench_trace.h, if there is one.    */
+} HeapBenchPattern_t;
+
+/**
+  * @brief  One scenario.  usOps counts operations for RANDOM and fill and
+  *         drain rounds for LIFO and FIFO, which draw their sizes from
+  *         usMinSize to usMaxSize; RECORDED ignores all three, and is left
+  *         out of the log when there is no trace.
+  */
+typedef struct
+{
+  const char *pcName;
+  HeapBenchPattern_t ePattern;
+  uint16_t usMinSize;
+  uint16_t usMaxSize;
+  uint16_t usOps;
+} HeapBenchScenario_t;
+
+/**
+  * @brief  One step of a recorded trace: allocate usSize bytes into ucSlot,
+  *         or free ucSlot when usSize is 0.  Tools/heapbench_trace.py writes
+  *         these from a traceMALLOC/traceFREE capture.
+  */
+typedef struct
+{
+  uint16_t usSize;
+  uint8_t ucSlot;
+} HeapBenchOp_t;
+
+#ifndef heapbenchSCENARIOS
+#define heapbenchSCENARIOS                              \
+  {                                                     \
+    { "random",   HEAPBENCH_RANDOM,   8U, 256U, 2000U }, \
+    { "lifo",     HEAPBENCH_LIFO,     8U, 128U,   20U }, \
+    { "fifo",     HEAPBENCH_FIFO,     8U, 128U,   20U }, \
+    { "recorded", HEAPBENCH_RECORDED, 0U,   0U,    0U }  \
+  }
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HEAPBENCH_H */
@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file           : irqlat.h
+  * @brief          : Interrupt latency mode: entry latency histogram of a test
+  *                   timer interrupt, and the longest kernel masked section.
+  ******************************************************************************
+  * With irqlatENABLE set TIM6 raises its update interrupt irqlatRATE_HZ times
+  * a second at irqlatPRIORITY.  The handler reads the counter first thing,
+  * which is the time since the update event, so each interrupt is one
+  * sample of how long it waited to be taken.  At the default priority the
+  * kernel's BASEPRI sections hold it off, and so do PRIMASK sections such as
+  * the timebase's.  For the longest sample the handler also keeps the PC
+  * the interrupted task was stopped at, which is the instruction straight
+  * after the section that held the interrupt off.
+  *
+  * Built with configUSE_MASK_PROFILER set as well, the port times every
+  * outermost BASEPRI section and keeps the longest with the addresses that
+  * raised and cleared it, taskENTER_CRITICAL() sections being credited to
+  * their caller.  Every irqlatREPORT_MS the log gets
+  *
+  *   irqlat: <n> samples, entry min <c> max <c> jitter <c> cycles, worst at <pc>
+  *   irqlat <<limit>: <count>          one per non-empty histogram bucket,
+  *                                     >= for the last
+  *   masked: <n> sections, longest <c> cycles, raised at <pc> cleared at <pc>
+  *
+  * With configUSE_SECTION_PROFILER too, the kernel keeps the worst call sites
+  * of BASEPRI sections and of scheduler suspension, and the report goes on
+  * with up to irqlatSITES of each, longest first:
+  *
+  *   crit <pc>: <n> x, max <c> avg <c> cycles
+  *   susp <pc>: <n> x, max <c> avg <c> cycles
+  *
+  * A susp site is the return address of vTaskSuspendAll(); with
+  * configHEAP_LOCK_CEILING at 0 the heap's free list walks and merges show
+  * under its prvHeapLock(), while with the ceiling they hold off neither.
+  *
+  * and the figures start again.  Addresses are in the ELF, for example
+  * arm-none-eabi-addr2line -f -e Debug/Lab4.elf 0x08001234.
+  *
+  * The clock governor is not started in this mode, so that timer counts
+  * keep a fixed ratio to core cycles.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IRQLAT_H
+#define __IRQLAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* 1 to run the test interrupt and report. */
+#ifndef irqlatENABLE
+#define irqlatENABLE                0
+#endif
+
+/* Test interrupts per second. */
+#ifndef irqlatRATE_HZ
+#define irqlatRATE_HZ               2000U
+#endif
+
+/* Where the kernel masks it, so that its sections show; 4 or less measures
+   the hardware and the PRIMASK sections alone. */
+#ifndef irqlatPRIORITY
+#define irqlatPRIORITY              configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+#endif
+
+/* Bucket n counts samples under 2^(irqlatFIRST_BUCKET_SHIFT + n) cycles; the
+   last bucket also takes the rest. */
+#ifndef irqlatBUCKETS
+#define irqlatBUCKETS               8U
+#endif
+
+#ifndef irqlatFIRST_BUCKET_SHIFT
+#define irqlatFIRST_BUCKET_SHIFT    4U
+#endif
+
+#ifndef irqlatREPORT_MS
+#define irqlatREPORT_MS             5000U
+#endif
+
+/* Call sites reported per section type. */
+#ifndef irqlatSITES
+#define irqlatSITES                 4U
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xIrqLatStart(void);
+void vIrqLatIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IRQLAT_H */
@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file           : irqtable.h
+  * @brief          : The board's interrupt priorities, declared in one table
+  *                   and checked at compile time against the kernel's ceiling.
+  ******************************************************************************
+  * Each row is X(Irq, Priority, Class), Irq being the IRQn_Type name without
+  * its _IRQn suffix and Priority the NVIC preemption priority, 0 the most
+  * urgent, with NVIC_PRIORITYGROUP_4 as HAL_Init() sets it.  Class says what
+  * the handler may do:
+  *
+  *   KERNEL  calls FromISR functions, so must sit at or below
+  *           configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, where kernel
+  *           critical sections mask it
+  *   FAST    never calls the kernel and sits above the ceiling, so no kernel
+  *           critical section ever delays it
+  *   BARE    never calls the kernel, at any priority
+  *
+  * stm32f4xx_it.c expands the table with irqtableCHECK, which rejects a row
+  * whose priority its class does not allow.  Drivers take their priority with
+  * irqtablePRIORITY(), which does not compile for an interrupt with no row,
+  * and a driver whose handler calls the kernel states so with
+  * irqtableREQUIRE_KERNEL(), which does not compile unless its row is KERNEL.
+  * The port's configASSERT() in vPortValidateInterruptPriority() still checks
+  * at run time whatever this does not cover.
+  *
+  * TIM5 is the tick, see timebase.c; HAL_InitTick() runs it at
+  * TICK_INT_PRIORITY until the scheduler starts and moves it to its row.
+  * USART2 and DMA1_Stream6 are also set in Lab4.ioc, and CubeMX writes its
+  * number into the generated code.  main() sets both again from this table
+  * in a USER CODE block, so the table wins, but Lab4.ioc should be kept in
+  * step.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IRQTABLE_H
+#define __IRQTABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "irqlat.h"
+#include "profiler.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/*          Irq            Priority                                      Class */
+#define BOARD_IRQ_TABLE(X)                                                      \
+  X(TIM5,          configLIBRARY_LOWEST_INTERRUPT_PRIORITY,      KERNEL)       \
+  X(USART2,        configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(DMA1_Stream6,  configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(DMA1_Stream5,  configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(OTG_FS,        configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(OTG_FS_WKUP,   configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(EXTI0,         configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(EXTI1,         configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(DMA2_Stream0,  configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(DMA1_Stream7,  configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(DMA1_Stream3,  configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(DMA2_Stream1,  configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(DMA2_Stream2,  configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(TIM7,          configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, KERNEL)       \
+  X(DMA1_Stream0,  configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, BARE)         \
+  X(RTC_WKUP,      configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, BARE)         \
+  X(TIM6_DAC,      irqlatPRIORITY,                               BARE)         \
+  X(TIM2,          profilerPRIORITY,                             FAST)
+
+#define irqtableKERNEL              0
+#define irqtableFAST                1
+#define irqtableBARE                2
+
+/* irqtablePRIO_<Irq> and irqtableCLASS_<Irq> for every row. */
+#define irqtableCONSTANTS(Irq, Priority, Class) \
+  irqtablePRIO_##Irq = (Priority), irqtableCLASS_##Irq = irqtable##Class,
+
+enum
+{
+  BOARD_IRQ_TABLE(irqtableCONSTANTS)
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* The priority of a row, for HAL_NVIC_SetPriority(). */
+#define irqtablePRIORITY(Irq)       ((uint32_t) irqtablePRIO_##Irq)
+
+/* Fails to compile unless the row is KERNEL. */
+#define irqtableREQUIRE_KERNEL(Irq)                                             \
+  _Static_assert(irqtableCLASS_##Irq == irqtableKERNEL,                         \
+                 #Irq " calls the kernel, so its row in BOARD_IRQ_TABLE must be KERNEL")
+
+/* Priorities each class allows. */
+#define irqtableALLOWS_KERNEL(Priority) \
+  (((Priority) >= configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY) &&              \
+   ((Priority) <= configLIBRARY_LOWEST_INTERRUPT_PRIORITY))
+#define irqtableALLOWS_FAST(Priority) \
+  ((Priority) < configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY)
+#define irqtableALLOWS_BARE(Priority) \
+  ((Priority) <= configLIBRARY_LOWEST_INTERRUPT_PRIORITY)
+
+/* One row checked against its class. */
+#define irqtableCHECK(Irq, Priority, Class)                                     \
+  _Static_assert(irqtableALLOWS_##Class(Priority),                              \
+                 #Irq " has a priority a " #Class " interrupt may not have");
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IRQTABLE_H */
@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file           : itm.h
+  * @brief          : ITM stimulus port output on the SWO pin, and a log sink
+  *                   that uses it in place of USART2.
+  ******************************************************************************
+  * vItmInit() starts the TPIU in asynchronous NRZ mode on PB3 (TRACESWO, its
+  * reset function) at itmSWO_BAUD and enables the ITM stimulus ports in
+  * itmPORTS.  The lines then show up in the SWV ITM console of the debugger
+  * set up in Lab4.launch, or in any SWO viewer, with the core clock entered
+  * as the current HCLK.
+  *
+  * A write waits only while the stimulus FIFO, one word deep, is full, and at
+  * the default rate a word leaves in 20 us, an eleventh of the time USART2
+  * needs at 115200 baud.  A port that the debugger has disabled, or any port
+  * before vItmInit(), drops the bytes at once.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ITM_H
+#define __ITM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "log.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* 1 to send the log over SWO from boot, 0 to keep it on USART2. */
+#ifndef itmLOG_SINK
+#define itmLOG_SINK                 0
+#endif
+
+/* SWO bit rate; the prescaler is rounded, so at an HCLK that is not a multiple
+   of it the rate is HCLK / round(HCLK / itmSWO_BAUD). */
+#ifndef itmSWO_BAUD
+#define itmSWO_BAUD                 2000000U
+#endif
+
+/* Stimulus port of xItmLogSink, the one SWV consoles show by default. */
+#ifndef itmPORT_LOG
+#define itmPORT_LOG                 0U
+#endif
+
+/* Ports vItmInit() enables, one bit per port. */
+#ifndef itmPORTS
+#define itmPORTS                    (1UL << itmPORT_LOG)
+#endif
+
+/* Exported variables --------------------------------------------------------*/
+extern const LogSink_t xItmLogSink;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vItmInit(void);
+void vItmUpdateClock(void);
+size_t xItmWrite(uint8_t ucPort, const void *pvData, size_t xLength);
+BaseType_t xItmIsEnabled(uint8_t ucPort);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ITM_H */
@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file           : kernbench.h
+  * @brief          : Kernel microbenchmarks: context switch, ISR to task wake,
+  *                   queue, semaphore, mutex and notification latencies.
+  ******************************************************************************
+  * The Bench build configuration is Debug with kernbenchENABLE=1, so the
+  * numbers describe the kernel as the Debug image runs it.  The clock
+  * governor is not started in that image, and the core stays at
+  * clockBOOT_PROFILE for the whole run.
+  *
+  * kernbenchSTART_DELAY_MS after boot two tasks above every application task
+  * run each test kernbenchSAMPLES times, timing with the DWT cycle counter
+  * from the last instruction before the kernel call that hands over to the
+  * first instruction after the call that takes over:
+  *
+  *   yield      taskYIELD() to the other task of the same priority
+  *   isr_entry  pending TIM7_IRQn to its handler
+  *   isr_wake   pending TIM7_IRQn to the task its handler notified
+  *   queue      xQueueSend() to a higher priority task and back, one round
+  *              trip per sample, for each size of kernbenchQUEUE_SIZES
+  *   semaphore  xSemaphoreGive() to the higher priority task taking it
+  *   mutex      xSemaphoreGive() to the higher priority task blocked on it,
+  *              priority disinheritance included
+  *   notify     xTaskNotifyGive() to the higher priority task waiting
+  *   memcpy_*   one copy of each size of kernbenchMEMOPS_SIZES, through
+  *              newlib and through the port's pvPortMemCpy(), with the
+  *              buffers word aligned and, for the _ua rows, the destination
+  *              one byte and the source two bytes past a word boundary
+  *   memset_*   one fill of each size, through newlib and pvPortMemSet()
+  *
+  * The memcpy and memset rows are only built with configUSE_PORT_MEMOPS.
+  *
+  * TIM7 is otherwise unused here, since timebase.c took over the HAL tick;
+  * its handler in stm32f4xx_it.c is only built into this image.
+  *
+  * The log gets one row per test once every test has run:
+  *
+  *   kbench,<test>,<param>,<samples>,<min>,<avg>,<max>,<hclk MHz>
+  *
+  * in cycles, param being the item size for queue, the length for memcpy and
+  * memset, and 0 otherwise.
+  * Interrupts stay on, so the ticks and the log DMA land in some samples and
+  * the maximums wander; compare minimums and averages between builds, for which
+  * Tools/kernbench_report.py takes two captures.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __KERNBENCH_H
+#define __KERNBENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* 1 to register the benchmark tasks; set by the Bench build configuration. */
+#ifndef kernbenchENABLE
+#define kernbenchENABLE             0
+#endif
+
+/* Runs of each test. */
+#ifndef kernbenchSAMPLES
+#define kernbenchSAMPLES            1000U
+#endif
+
+/* Left for the boot output to drain. */
+#ifndef kernbenchSTART_DELAY_MS
+#define kernbenchSTART_DELAY_MS     1000U
+#endif
+
+/* Item sizes of the queue test, in bytes. */
+#ifndef kernbenchQUEUE_SIZES
+#define kernbenchQUEUE_SIZES        { 4U, 16U, 64U }
+#endif
+
+/* At least the largest of kernbenchQUEUE_SIZES; larger sizes are skipped. */
+#ifndef kernbenchQUEUE_MAX_ITEM
+#define kernbenchQUEUE_MAX_ITEM     64U
+#endif
+
+/* Lengths of the memcpy and memset tests, in bytes. */
+#ifndef kernbenchMEMOPS_SIZES
+#define kernbenchMEMOPS_SIZES       { 16U, 64U, 256U, 1024U }
+#endif
+
+/* At least the largest of kernbenchMEMOPS_SIZES; larger sizes are skipped. */
+#ifndef kernbenchMEMOPS_MAX
+#define kernbenchMEMOPS_MAX         1024U
+#endif
+
+/* The task that starts each test runs one below the peer that answers it. */
+#define kernbenchPEER_PRIORITY      (configMAX_PRIORITIES - 1U)
+#define kernbenchPRIORITY           (kernbenchPEER_PRIORITY - 1U)
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vKernBenchIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __KERNBENCH_H */
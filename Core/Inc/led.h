@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : led.h
+  * @brief          : The four Discovery LEDs as TIM4 PWM channels, with
+  *                   blink, fade and pattern sequencing by DMA.
+  ******************************************************************************
+  * PD12 to PD15 are TIM4 channels 1 to 4.  A static duty is a compare value
+  * and costs no CPU at all.  A pattern is a list of keyframes, each holding or
+  * fading to a set of duties, which is expanded into a circular buffer of
+  * frames.  The CC1 DMA request bursts each frame into CCR1 to CCR4 through
+  * DMAR, once per PWM period, and the CPU only refills one half of the buffer
+  * at each half transfer, a few times a second.
+  *
+  * TIM4 and the DMA stop in STOP mode, so tickless idle sleeps with WFI
+  * instead while a pattern plays or a channel is dimmed.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __LED_H
+#define __LED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* In TIM4 channel order. */
+typedef enum
+{
+  LED_GREEN = 0,
+  LED_ORANGE,
+  LED_RED,
+  LED_BLUE,
+  LED_COUNT
+} Led_t;
+
+/* Duties of every channel a pattern drives, reached at the start of the
+   keyframe, or by its end with ucFade. */
+typedef struct
+{
+  uint16_t usDuty[LED_COUNT];   /*!< Permille, see ledFULL.                    */
+  uint16_t usMs;                /*!< Length, rounded down to whole frames.     */
+  uint8_t ucFade;               /*!< Ramp from the previous keyframe's duties. */
+} LedKeyframe_t;
+
+typedef struct
+{
+  const LedKeyframe_t *pxKeyframes;
+  uint16_t usKeyframes;
+  uint8_t ucChannels;           /*!< Bits of the Led_t channels it drives.     */
+  uint8_t ucRepeat;             /*!< Times to play, 0 to loop until stopped.   */
+} LedPattern_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Duty of a channel that is fully on. */
+#define ledFULL                     1000U
+
+/* PWM period and so frame length; 5 ms is a 200 Hz PWM. */
+#define ledFRAME_MS                 5U
+
+/* Frames in each half of the DMA buffer, refilled in one interrupt. */
+#ifndef ledHALF_FRAMES
+#define ledHALF_FRAMES              32U
+#endif
+
+/* Exported macro ------------------------------------------------------------*/
+#define ledBIT(eLed)                ((uint8_t) (1U << (eLed)))
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vLedInit(void);
+void vLedSet(Led_t eLed, uint16_t usDuty);
+void vLedPlay(const LedPattern_t *pxPattern);
+void vLedStop(void);
+BaseType_t xLedIsBusy(void);
+void vLedUpdateClock(void);
+void vLedDmaIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LED_H */
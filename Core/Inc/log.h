@@ -0,0 +1,117 @@
+/**
+  ******************************************************************************
+  * @file           : log.h
+  * @brief          : Non-blocking log transport for USART2.  Writers copy into
+  *                   a byte ring and return; DMA drains the ring in the
+  *                   background, restarted from the Tx complete callback.
+  ******************************************************************************
+  * The ring is the default sink.  vLogSetSink() sends every writer to another
+  * one, such as the SWO sink of itm.h, without touching the call sites.
+  *
+  * xLogGather() sends a message made of several segments on USART2 without
+  * copying them: the DMA takes each segment in turn from the caller's
+  * buffers, chained from the Tx complete callback, in its place among the
+  * ring's messages.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __LOG_H
+#define __LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "fmt.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Size of the transmit ring in bytes, must be a power of two. */
+#ifndef logRING_SIZE
+#define logRING_SIZE                2048U
+#endif
+
+/* How long _write(), and so printf(), waits for room in a full ring before it
+   drops the text.  0 drops at once, as xLogWrite() does; portMAX_DELAY never
+   drops.  Only a task can wait, and only while the scheduler runs. */
+#ifndef logWRITE_WAIT_TICKS
+#define logWRITE_WAIT_TICKS         pdMS_TO_TICKS(50U)
+#endif
+
+/* Longest line xLogPrintf() formats, on the caller's stack; longer lines are
+   cut off. */
+#ifndef logPRINTF_LENGTH
+#define logPRINTF_LENGTH            96U
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+  * @brief  Where xLogWrite(), xLogPrintf() and _write() send their bytes.
+  */
+typedef struct
+{
+  /* Send or queue a message whole; xLength, or 0 if it was dropped.  Must be
+     callable from tasks, from interrupts up to the kernel priority and before
+     the scheduler starts. */
+  size_t (*pxWrite)(const void *pvData, size_t xLength);
+} LogSink_t;
+
+/**
+  * @brief  One piece of a gathered message.
+  */
+typedef struct
+{
+  const void *pvData;
+  size_t xLength;
+} LogSegment_t;
+
+struct xLOG_GATHER;
+typedef void (*LogGatherDone_t)(struct xLOG_GATHER *pxGather);
+
+/**
+  * @brief  A gathered message on its way out.  Owned by the caller, which
+  *         must keep it and the segments alive until pxDone runs; the fields
+  *         are private to the log.
+  */
+typedef struct xLOG_GATHER
+{
+  struct xLOG_GATHER *pxNext;
+  const LogSegment_t *pxSegments;
+  size_t xCount;
+  size_t xIndex;              /*!< Segment being sent.                       */
+  uint32_t ulMark;            /*!< Ring head when queued; ring bytes before
+                                   it go first.                              */
+  LogGatherDone_t pxDone;
+  void *pvParameter;
+} LogGather_t;
+
+/* Exported variables --------------------------------------------------------*/
+
+/* The USART2 DMA ring described above, the sink at reset. */
+extern const LogSink_t xLogUartSink;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vLogSetSink(const LogSink_t *pxSink);
+size_t xLogWrite(const void *pvData, size_t xLength);
+size_t xLogPrintf(const char *pcFormat, ...) fmtCHECK(1, 2);
+BaseType_t xLogGather(LogGather_t *pxGather, const LogSegment_t *pxSegments, size_t xCount,
+                      LogGatherDone_t pxDone, void *pvParameter);
+size_t xLogWriteSegments(const LogSegment_t *pxSegments, size_t xCount);
+uint32_t ulLogGetDropped(void);
+size_t xLogGetPending(void);
+void vLogInit(void);
+void vLogDmaIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LOG_H */
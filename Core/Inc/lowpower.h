@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file           : lowpower.h
+  * @brief          : Tickless idle for the board.  Long idle periods are spent
+  *                   in STOP mode with the RTC wakeup timer standing in for
+  *                   the TIM5 tick.
+  ******************************************************************************
+  * Every sleep that ends, in STOP or in the WFI a busy peripheral falls back
+  * to, is put down to the interrupt that ended it, the pending and enabled
+  * one with the lowest number, and the kernel is told with
+  * vTaskAttributeWake() so that it can charge the wake to the task that runs
+  * next.  xLowPowerTakeWakes() hands the counts over for cpustats.h.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __LOWPOWER_H
+#define __LOWPOWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "main.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* RTC prescalers.  ck_apre = LSI / (ASYNCH + 1) clocks the sub-second counter
+   used to measure how long the part slept; ck_spre must come out at 1 Hz. */
+#define lpRTC_ASYNCH_PREDIV         7U
+#define lpRTC_SYNCH_PREDIV          ((LSI_VALUE / (lpRTC_ASYNCH_PREDIV + 1U)) - 1U)
+#define lpRTC_SUBSECOND_HZ          (LSI_VALUE / (lpRTC_ASYNCH_PREDIV + 1U))
+
+/* The wakeup timer runs from RTCCLK / 16 and has a 16 bit reload. */
+#define lpRTC_WAKEUP_HZ             (LSI_VALUE / 16U)
+#define lpRTC_WAKEUP_MAX_COUNT      0x10000UL
+
+/* Wake cause of a sleep that ended with no enabled interrupt pending. */
+#define lpWAKE_UNKNOWN              0xFFU
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+  * @brief  Sleep figures since they were last taken.
+  */
+typedef struct
+{
+  uint32_t ulStops;           /*!< Sleeps in STOP mode.                        */
+  uint32_t ulShallowSleeps;   /*!< WFI sleeps a busy peripheral kept out of
+                                   STOP.                                       */
+  uint32_t ulStoppedUs;       /*!< Time spent in STOP.                         */
+} LowPowerStats_t;
+
+/**
+  * @brief  How many sleeps one interrupt ended.
+  */
+typedef struct
+{
+  uint8_t ucIrq;              /*!< IRQn_Type, or lpWAKE_UNKNOWN.               */
+  uint8_t ucReserved;
+  uint16_t usCount;           /*!< Saturates at 0xFFFF.                        */
+} LowPowerWake_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vLowPowerInit(void);
+void vLowPowerWakeupIRQHandler(void);
+size_t xLowPowerTakeWakes(LowPowerStats_t *pxStats, LowPowerWake_t *pxWakes, size_t xMaxWakes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LOWPOWER_H */
@@ -0,0 +1,102 @@
+/**
+  ******************************************************************************
+  * @file           : mailbox.h
+  * @brief          : Latest value mailboxes: a triple buffer that hands the
+  *                   reader the newest complete item, without locks.
+  ******************************************************************************
+  * A queue of one item with xQueueOverwrite() gives a reader the newest
+  * value, but each write and read copies the item inside a critical section
+  * and the writer must be a task or use the FromISR form.  A mailbox holds
+  * three slots of the item instead: the writer owns one, the reader owns
+  * one, and the third is the last one published.  Publishing swaps the
+  * writer's slot with the published one and taking the newest swaps the
+  * reader's slot with it, each a single exchange of one word, so neither
+  * side ever waits for the other, masks interrupts or copies more than it
+  * asks for.  A writer faster than its reader overwrites values the reader
+  * never sees, which is what a reader that wants only the latest value asks
+  * for, and counts them.
+  *
+  *   mailboxDEFINE(ORIENTATION, Orientation_t);
+  *
+  *   vMailboxWrite(&xORIENTATIONMailbox, &xNow);          from any context
+  *
+  *   if (xMailboxRead(&xORIENTATIONMailbox, &xLatest) != pdFALSE)
+  *   {
+  *     ...                                        a value not seen before
+  *   }
+  *
+  * The writer may also fill its slot in place with pvMailboxWriteSlot() and
+  * vMailboxPublish(), and the reader use the newest where it lies with
+  * pvMailboxAcquire(), until its next acquire.  Each mailbox has one writer
+  * and one reader, each of which may be a task or an interrupt.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MAILBOX_H
+#define __MAILBOX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+  * @brief  A mailbox.  Declared with mailboxDEFINE(); the fields are private
+  *         to mailbox.c.
+  */
+typedef struct
+{
+  uint8_t *pucSlots;
+  size_t xItemSize;
+  volatile uint32_t ulShared;   /*!< Published slot, and mailboxFRESH until
+                                     the reader takes it.                    */
+  uint32_t ulWriteSlot;         /*!< Owned by the writer.                    */
+  uint32_t ulReadSlot;          /*!< Owned by the reader.                    */
+  BaseType_t xHasValue;         /*!< The reader's slot holds an item.        */
+  volatile uint32_t ulWrites;
+  volatile uint32_t ulOverwritten; /*!< Writes replaced before the reader
+                                        took them.                           */
+} Mailbox_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+#define mailboxSLOTS                3U
+
+/* Set in ulShared while the published slot holds an item the reader has not
+   taken. */
+#define mailboxFRESH                0x4UL
+
+/* Exported macro ------------------------------------------------------------*/
+
+/**
+  * @brief  Declare a mailbox of Type at file scope.  Defines x<Name>Mailbox.
+  */
+#define mailboxDEFINE(Name, Type)                                                   \
+  static Type x##Name##Slots[mailboxSLOTS];                                         \
+  Mailbox_t x##Name##Mailbox =                                                      \
+  {                                                                                 \
+    (uint8_t *) x##Name##Slots, sizeof(Type), 1U, 0U, 2U, pdFALSE, 0U, 0U           \
+  }
+
+/* Exported functions prototypes ---------------------------------------------*/
+void *pvMailboxWriteSlot(Mailbox_t *pxMailbox);
+void vMailboxPublish(Mailbox_t *pxMailbox);
+void vMailboxWrite(Mailbox_t *pxMailbox, const void *pvItem);
+const void *pvMailboxAcquire(Mailbox_t *pxMailbox, BaseType_t *pxFresh);
+BaseType_t xMailboxRead(Mailbox_t *pxMailbox, void *pvItem);
+uint32_t ulMailboxGetWrites(const Mailbox_t *pxMailbox);
+uint32_t ulMailboxGetOverwritten(const Mailbox_t *pxMailbox);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAILBOX_H */
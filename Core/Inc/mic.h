@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file           : mic.h
+  * @brief          : MP45DT02 PDM microphone on I2S2, decimated to 16 bit PCM
+  *                   in blocks on the DMA half and complete transfer
+  *                   interrupts.
+  ******************************************************************************
+  * I2S2 clocks the microphone at micPDM_RATIO times the sample rate and DMA1
+  * Stream3 lands the bitstream in a circular buffer of two halves.  As each
+  * half fills, a third order CIC filter decimates it by 16, through tables
+  * that add the contribution of a whole PDM byte at once, two outputs per
+  * SADD16, and a micFIR_TAPS FIR decimates by 4 more with SMLAD, two taps per
+  * instruction.  The samples then go through a DC blocker into a stream
+  * buffer for xMicRead().
+  *
+  * Decimating costs about 200 cycles a sample, so 16 kHz mono takes 2 % of
+  * the CPU at 168 MHz and 4 % at 84 MHz, inside micLOAD_BUDGET_PERMILLE.  The
+  * governor keeps to those two profiles while the microphone runs, as it
+  * holds the PLLI2S, so the budget holds whatever the load.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MIC_H
+#define __MIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Output sample rate, mono. */
+#ifndef micSAMPLE_RATE_HZ
+#define micSAMPLE_RATE_HZ           16000U
+#endif
+
+/* PDM bits per output sample: 16 in the CIC, 4 in the FIR. */
+#define micPDM_RATIO                64U
+#define micCIC_DECIMATION           16U
+#define micFIR_DECIMATION           4U
+#define micFIR_TAPS                 64U
+
+/* Samples decimated per interrupt. */
+#ifndef micBLOCK_SAMPLES
+#define micBLOCK_SAMPLES            32U
+#endif
+
+/* Samples the stream buffer holds for the reader. */
+#ifndef micSTREAM_SAMPLES
+#define micSTREAM_SAMPLES           (8U * micBLOCK_SAMPLES)
+#endif
+
+/* Left shift from the filters' 13 bit range to full scale. */
+#ifndef micGAIN_SHIFT
+#define micGAIN_SHIFT               3U
+#endif
+
+/* Share of the block period decimating may take before it is counted as
+   over budget. */
+#ifndef micLOAD_BUDGET_PERMILLE
+#define micLOAD_BUDGET_PERMILLE     50U
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xMicInit(void);
+BaseType_t xMicStart(void);
+void vMicStop(void);
+size_t xMicRead(int16_t *psSamples, size_t xCount, TickType_t xTicksToWait);
+uint32_t ulMicGetOverruns(void);
+uint32_t ulMicGetErrors(void);
+uint16_t usMicGetWorstLoadPermille(void);
+uint32_t ulMicGetBudgetOverruns(void);
+BaseType_t xMicIsBusy(void);
+void vMicDmaIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MIC_H */
@@ -0,0 +1,151 @@
+/**
+  ******************************************************************************
+  * @file           : microjob.h
+  * @brief          : Stackless cooperative jobs run by one host task from a
+  *                   run queue and a list of delayed jobs.
+  ******************************************************************************
+  * A micro job is the co-routine of croutine.c cut down to what tiny work
+  * needs: a MicroJob_t of 16 bytes, owned by the caller, instead of a CRCB
+  * with two list items, or a task's TCB and stack.  Every job runs on the
+  * host task's stack and returns to it at each wait, so any number of jobs
+  * share that one stack.
+  *
+  * A job's function is a state machine written as straight line code
+  * between microjobBEGIN() and microjobEND():
+  *
+  *   static MicroJobStatus_t prvBlink(MicroJob_t *pxJob)
+  *   {
+  *     microjobBEGIN(pxJob);
+  *     for (;;)
+  *     {
+  *       vLedSet(LED_BLUE, ledFULL);
+  *       microjobPERIOD(pxJob, pdMS_TO_TICKS(100));
+  *       vLedSet(LED_BLUE, 0U);
+  *       microjobPERIOD(pxJob, pdMS_TO_TICKS(900));
+  *     }
+  *     microjobEND(pxJob);
+  *   }
+  *
+  * Each wait macro returns to the host and the next run resumes just after
+  * it, so as with crSTART() locals do not survive a wait, and the macros can
+  * only be used in the job function itself, not in functions it calls, nor
+  * in a switch statement of its own, and at most one to a line.  State that
+  * must survive goes in a structure that starts with the MicroJob_t.
+  *
+  * Jobs run in turn, one step each, and must not block; they may start and
+  * signal jobs, including themselves.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MICROJOB_H
+#define __MICROJOB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* What a job asks the host for when it returns, set by the wait macros. */
+typedef enum
+{
+  eMicroJobYield = 0,           /*!< Run again after the other ready jobs.     */
+  eMicroJobDelay,               /*!< Run again at xWake.                       */
+  eMicroJobWait,                /*!< Run again once signalled.                 */
+  eMicroJobDone                 /*!< Finished, may be started again.           */
+} MicroJobStatus_t;
+
+typedef struct xMICRO_JOB MicroJob_t;
+typedef MicroJobStatus_t (*MicroJobFunction_t)(MicroJob_t *pxJob);
+
+/**
+  * @brief  One job.  Owned by the caller, which must keep it alive until the
+  *         job is done; the fields are private to microjob.c and the macros.
+  */
+struct xMICRO_JOB
+{
+  MicroJob_t *pxNext;           /*!< Link in the run queue or delayed list.    */
+  MicroJobFunction_t pxFunction;
+  TickType_t xWake;             /*!< When it is due, and the base for
+                                     microjobPERIOD().                         */
+  uint16_t usResume;            /*!< Line to resume at, 0 from the start.      */
+  uint8_t ucState;              /*!< Where the job is, private to the host.    */
+  uint8_t ucSignalled;          /*!< A signal is pending.                      */
+};
+
+/* Exported constants --------------------------------------------------------*/
+
+/* 1 to build the engine and its host task. */
+#ifndef microjobENABLE
+#define microjobENABLE              0
+#endif
+
+/* The host task, whose stack every job runs on. */
+#ifndef microjobHOST_STACK_DEPTH
+#define microjobHOST_STACK_DEPTH    128U
+#endif
+#ifndef microjobHOST_PRIORITY
+#define microjobHOST_PRIORITY       (tskIDLE_PRIORITY + 1U)
+#endif
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Open the job body; the job resumes here at the wait it returned from. */
+#define microjobBEGIN(pxJob)        switch ((pxJob)->usResume) { case 0:
+
+/* Return with eStatus and resume at this line. */
+#define microjobRETURN(pxJob, eStatus)                                        \
+  do                                                                          \
+  {                                                                           \
+    (pxJob)->usResume = (uint16_t) __LINE__;                                  \
+    return (eStatus);                                                         \
+    case __LINE__:;                                                           \
+  } while (0)
+
+/* Let the other ready jobs run first. */
+#define microjobYIELD(pxJob)        microjobRETURN((pxJob), eMicroJobYield)
+
+/* Wait xTicks from now. */
+#define microjobDELAY(pxJob, xTicks)                                          \
+  do                                                                          \
+  {                                                                           \
+    (pxJob)->xWake = xTaskGetTickCount() + (xTicks);                          \
+    microjobRETURN((pxJob), eMicroJobDelay);                                  \
+  } while (0)
+
+/* Wait until xPeriod after the job was last due, so that a periodic job does
+   not drift; see vMicroJobNextPeriod(). */
+#define microjobPERIOD(pxJob, xPeriod)                                        \
+  do                                                                          \
+  {                                                                           \
+    vMicroJobNextPeriod((pxJob), (xPeriod));                                  \
+    microjobRETURN((pxJob), eMicroJobDelay);                                  \
+  } while (0)
+
+/* Wait for vMicroJobSignal(), or carry on if a signal is already pending. */
+#define microjobWAIT(pxJob)         microjobRETURN((pxJob), eMicroJobWait)
+
+/* Close the job body.  Reaching it finishes the job. */
+#define microjobEND(pxJob)                                                    \
+  }                                                                           \
+  (pxJob)->usResume = 0U;                                                     \
+  return eMicroJobDone
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xMicroJobStart(MicroJob_t *pxJob, MicroJobFunction_t pxFunction, TickType_t xFirstDelay);
+void vMicroJobSignal(MicroJob_t *pxJob);
+void vMicroJobSignalFromISR(MicroJob_t *pxJob, BaseType_t *pxHigherPriorityTaskWoken);
+void vMicroJobNextPeriod(MicroJob_t *pxJob, TickType_t xPeriod);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MICROJOB_H */
@@ -0,0 +1,63 @@
+/**
+  ******************************************************************************
+  * @file           : notifysem.h
+  * @brief          : Binary and counting semaphores kept in one entry of a
+  *                   task's notification array.
+  ******************************************************************************
+  * A semaphore that only one task ever takes needs no queue: its count can
+  * live in one of that task's notification values, and a give is then a
+  * notification, several times faster than xSemaphoreGive() and with no
+  * StaticSemaphore_t.  Any task or interrupt may give; only the owner, the
+  * task named at vNotifySemaphoreInit(), may take.
+  *
+  * Each semaphore needs a notification index of its own on its owner, other
+  * than the default index 0 that the kernel's objects and drivers block on
+  * (see configTASK_NOTIFICATION_ARRAY_ENTRIES).  A binary semaphore holds at
+  * most one give; a counting one counts every give, with no maximum.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NOTIFYSEM_H
+#define __NOTIFYSEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Index a semaphore uses unless told otherwise. */
+#ifndef notifysemDEFAULT_INDEX
+#define notifysemDEFAULT_INDEX      2U
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+  * @brief  One semaphore.  Owned by the caller; the fields are private to
+  *         notifysem.c.
+  */
+typedef struct
+{
+  TaskHandle_t xOwner;
+  UBaseType_t uxIndex;
+  BaseType_t xCounting;
+} NotifySemaphore_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vNotifySemaphoreInit(NotifySemaphore_t *pxSemaphore, TaskHandle_t xOwner, UBaseType_t uxIndex,
+                          BaseType_t xCounting);
+BaseType_t xNotifySemaphoreTake(const NotifySemaphore_t *pxSemaphore, TickType_t xTicksToWait);
+void vNotifySemaphoreGive(const NotifySemaphore_t *pxSemaphore);
+void vNotifySemaphoreGiveFromISR(const NotifySemaphore_t *pxSemaphore, BaseType_t *pxHigherPriorityTaskWoken);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NOTIFYSEM_H */
@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file           : periodic.h
+  * @brief          : Periodic jobs run by a single executor task from a
+  *                   min-heap of deadlines.
+  ******************************************************************************
+  * A job is a callback with a period, so periodic work no longer costs a TCB
+  * and a stack each, only one PeriodicJob_t.  Deadlines are absolute and
+  * advance by whole periods, so a job does not drift however long its
+  * callback or the jobs before it take.  Callbacks run one after another in
+  * the executor task and must not block for long.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PERIODIC_H
+#define __PERIODIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*PeriodicCallback_t)(void *pvParameter);
+
+/**
+  * @brief  One job.  Owned by the caller, which must keep it alive while the
+  *         job is started; the fields are private to periodic.c.
+  */
+typedef struct
+{
+  PeriodicCallback_t pxCallback;
+  void *pvParameter;
+  TickType_t xPeriod;         /*!< 0 for a job that runs once.               */
+  TickType_t xDeadline;       /*!< Tick count when the job is next due.      */
+  UBaseType_t uxHeapIndex;    /*!< Slot in the deadline heap, or the count
+                                   of slots when the job is not started.     */
+} PeriodicJob_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Most jobs started at once. */
+#ifndef periodicMAX_JOBS
+#define periodicMAX_JOBS            8U
+#endif
+
+/* The executor task. */
+#ifndef periodicEXECUTOR_STACK_DEPTH
+#define periodicEXECUTOR_STACK_DEPTH 160U
+#endif
+#ifndef periodicEXECUTOR_PRIORITY
+#define periodicEXECUTOR_PRIORITY   (tskIDLE_PRIORITY + 1U)
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xPeriodicJobStart(PeriodicJob_t *pxJob, PeriodicCallback_t pxCallback, void *pvParameter,
+                             TickType_t xPeriod, TickType_t xFirstDelay);
+BaseType_t xPeriodicJobStop(PeriodicJob_t *pxJob);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PERIODIC_H */
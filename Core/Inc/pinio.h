@@ -0,0 +1,116 @@
+/**
+  ******************************************************************************
+  * @file           : pinio.h
+  * @brief          : Inline GPIO output driver on single BSRR stores, with
+  *                   compile time pin descriptors.
+  ******************************************************************************
+  * A BSRR store sets or clears the pins it names and leaves every other pin of
+  * the port alone, so tasks and interrupts that own different pins of one
+  * port never need a lock between them.  Set, clear and multi-pin writes are
+  * one store each.  A toggle has to learn the current level first, from ODR
+  * or through the bit-band alias, so it is only safe from the pin's single
+  * writer, as with HAL_GPIO_TogglePin().
+  *
+  * Descriptors name a pin by its CubeMX label, pinioPIN(Red_LED), and fold to
+  * constants, so each call compiles to a store of an immediate.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PINIO_H
+#define __PINIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "main.h"
+#include "pinmux.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* One or more pins of one port. */
+typedef struct
+{
+  GPIO_TypeDef *pxPort;
+  uint16_t usPins;
+} PinioPin_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Descriptor of the pin with a CubeMX label, from its main.h defines. */
+#define pinioPIN(Label)             ((PinioPin_t) { Label##_GPIO_Port, Label##_Pin })
+
+/* Descriptor of several pins of one port. */
+#define pinioPINS(pxPort, usPins)   ((PinioPin_t) { (pxPort), (uint16_t) (usPins) })
+
+/* The Discovery LEDs, PD12 to PD15. */
+#define pinioLEDS                   pinioPINS(GPIOD, Green_LED_Pin | Orange_LED_Pin | \
+                                              Red_LED_Pin | Blue_LED_Pin)
+
+/**
+  * @brief  Bit-band alias of one ODR bit, a word that reads as the output
+  *         level and writes it without touching the other pins.
+  * @param  Label CubeMX label of a single pin.
+  */
+#define pinioODR_BITBAND(Label)                                                     \
+  (*(volatile uint32_t *) (PERIPH_BB_BASE                                           \
+                           + (((uint32_t) &Label##_GPIO_Port->ODR - PERIPH_BASE) * 32U) \
+                           + (pinmuxINDEX(Label##_Pin) * 4U)))
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Drive pins high.
+  * @retval None
+  */
+static inline void vPinioSet(PinioPin_t xPin)
+{
+  xPin.pxPort->BSRR = xPin.usPins;
+}
+
+/**
+  * @brief  Drive pins low.
+  * @retval None
+  */
+static inline void vPinioClear(PinioPin_t xPin)
+{
+  xPin.pxPort->BSRR = (uint32_t) xPin.usPins << 16;
+}
+
+/**
+  * @brief  Drive each pin to its bit of usLevels, all in one store.
+  * @retval None
+  */
+static inline void vPinioWrite(PinioPin_t xPin, uint16_t usLevels)
+{
+  xPin.pxPort->BSRR = ((uint32_t) (xPin.usPins & (uint16_t) ~usLevels) << 16)
+                    | (uint32_t) (xPin.usPins & usLevels);
+}
+
+/**
+  * @brief  Invert pins.  Only safe from the single writer of these pins.
+  * @retval None
+  */
+static inline void vPinioToggle(PinioPin_t xPin)
+{
+  vPinioWrite(xPin, (uint16_t) ~xPin.pxPort->ODR);
+}
+
+/**
+  * @brief  Output level of pins as last driven.
+  * @retval Bits of usPins that are high.
+  */
+static inline uint16_t usPinioGetOutput(PinioPin_t xPin)
+{
+  return (uint16_t) (xPin.pxPort->ODR & xPin.usPins);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PINIO_H */
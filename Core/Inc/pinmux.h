@@ -0,0 +1,245 @@
+/**
+  ******************************************************************************
+  * @file           : pinmux.h
+  * @brief          : GPIO configuration from constant register images, built
+  *                   at compile time from a pin table.
+  ******************************************************************************
+  * HAL_GPIO_Init() walks all 16 pin positions of a port and read-modify-writes
+  * each register once per pin.  Here a pin table (see pintable.h) is folded by
+  * the compiler into one PinmuxPort_t per port: the final value and the mask of
+  * every register, so that vPinmuxApplyPort() touches each register once.
+  * Pins a table does not mention keep their state, including the debug pins.
+  *
+  * A table is a macro taking X and a selector, with one row per pin:
+  *
+  *   X(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti)
+  *
+  * Port is the letter, Pin a GPIO_PIN_x mask and the rest the suffixes of the
+  * pinmuxMODE_, pinmuxTYPE_, pinmuxSPEED_, pinmuxPULL_ and pinmuxEXTI_
+  * constants.  Af is the alternate function number and Level the starting
+  * output level.  As in HAL_GPIO_Init(), Type and Speed only apply to
+  * outputs and alternate functions, Af only to alternate functions, and Pull
+  * to everything but analog pins.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PINMUX_H
+#define __PINMUX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "stm32f4xx.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Register images of one port; each value lies within its mask. */
+typedef struct
+{
+  GPIO_TypeDef *pxPort;
+  uint32_t ulModerMask;
+  uint32_t ulModer;
+  uint32_t ulOtyperMask;
+  uint32_t ulOtyper;
+  uint32_t ulOspeedrMask;
+  uint32_t ulOspeedr;
+  uint32_t ulPupdrMask;
+  uint32_t ulPupdr;
+  uint32_t ulAfrMask[2];
+  uint32_t ulAfr[2];
+  uint32_t ulBsrr;            /*!< Starting levels of the outputs.           */
+} PinmuxPort_t;
+
+/* EXTI routing and triggers of every pin of a table. */
+typedef struct
+{
+  uint32_t ulLines;
+  uint32_t ulImr;
+  uint32_t ulEmr;
+  uint32_t ulRtsr;
+  uint32_t ulFtsr;
+  uint32_t ulExticrMask[4];
+  uint32_t ulExticr[4];
+} PinmuxExti_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define pinmuxPORT_A                0U
+#define pinmuxPORT_B                1U
+#define pinmuxPORT_C                2U
+#define pinmuxPORT_D                3U
+#define pinmuxPORT_E                4U
+#define pinmuxPORT_F                5U
+#define pinmuxPORT_G                6U
+#define pinmuxPORT_H                7U
+#define pinmuxPORT_I                8U
+
+/* MODER values. */
+#define pinmuxMODE_INPUT            0U
+#define pinmuxMODE_OUTPUT           1U
+#define pinmuxMODE_AF               2U
+#define pinmuxMODE_ANALOG           3U
+
+#define pinmuxTYPE_PP               0U
+#define pinmuxTYPE_OD               1U
+
+#define pinmuxSPEED_LOW             0U
+#define pinmuxSPEED_MEDIUM          1U
+#define pinmuxSPEED_HIGH            2U
+#define pinmuxSPEED_VERY_HIGH       3U
+
+#define pinmuxPULL_NOPULL           0U
+#define pinmuxPULL_UP               1U
+#define pinmuxPULL_DOWN             2U
+
+/* EXTI use, an interrupt and/or event mask with the edges that trigger it. */
+#define pinmuxEXTI_IT               0x1U
+#define pinmuxEXTI_EVT              0x2U
+#define pinmuxEXTI_RISE             0x4U
+#define pinmuxEXTI_FALL             0x8U
+
+#define pinmuxEXTI_NONE                 0U
+#define pinmuxEXTI_IT_RISING            (pinmuxEXTI_IT | pinmuxEXTI_RISE)
+#define pinmuxEXTI_IT_FALLING           (pinmuxEXTI_IT | pinmuxEXTI_FALL)
+#define pinmuxEXTI_IT_RISING_FALLING    (pinmuxEXTI_IT | pinmuxEXTI_RISE | pinmuxEXTI_FALL)
+#define pinmuxEXTI_EVT_RISING           (pinmuxEXTI_EVT | pinmuxEXTI_RISE)
+#define pinmuxEXTI_EVT_FALLING          (pinmuxEXTI_EVT | pinmuxEXTI_FALL)
+#define pinmuxEXTI_EVT_RISING_FALLING   (pinmuxEXTI_EVT | pinmuxEXTI_RISE | pinmuxEXTI_FALL)
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Position of a single pin mask, as a constant expression. */
+#define pinmuxINDEX(usPin)                                                          \
+  (((usPin) & 0xFF00U) ? (8U + pinmuxINDEX8((usPin) >> 8)) : pinmuxINDEX8(usPin))
+#define pinmuxINDEX8(usPin)                                                         \
+  (((usPin) & 0xF0U) ? (4U + pinmuxINDEX4((usPin) >> 4)) : pinmuxINDEX4(usPin))
+#define pinmuxINDEX4(usPin)                                                         \
+  (((usPin) & 0xCU) ? (((usPin) & 0x8U) ? 3U : 2U) : (((usPin) & 0x2U) ? 1U : 0U))
+
+/* Whether a pin drives its output stage, and whether it has a pull. */
+#define pinmuxDRIVES(Mode)                                                          \
+  ((pinmuxMODE_##Mode == pinmuxMODE_OUTPUT) || (pinmuxMODE_##Mode == pinmuxMODE_AF))
+#define pinmuxPULLS(Mode)           (pinmuxMODE_##Mode != pinmuxMODE_ANALOG)
+
+/* Terms of the register images, each selecting the rows of port Sel. */
+#define pinmuxROW(Sel, Port, Cond, xValue) \
+  | (((pinmuxPORT_##Port == (Sel)) && (Cond)) ? (uint32_t) (xValue) : 0U)
+
+#define pinmuxTERM_MODER_MASK(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, 1, 3U << (pinmuxINDEX(Pin) * 2U))
+#define pinmuxTERM_MODER(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, 1, pinmuxMODE_##Mode << (pinmuxINDEX(Pin) * 2U))
+#define pinmuxTERM_OTYPER_MASK(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, pinmuxDRIVES(Mode), 1U << pinmuxINDEX(Pin))
+#define pinmuxTERM_OTYPER(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, pinmuxDRIVES(Mode), pinmuxTYPE_##Type << pinmuxINDEX(Pin))
+#define pinmuxTERM_OSPEEDR_MASK(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, pinmuxDRIVES(Mode), 3U << (pinmuxINDEX(Pin) * 2U))
+#define pinmuxTERM_OSPEEDR(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, pinmuxDRIVES(Mode), pinmuxSPEED_##Speed << (pinmuxINDEX(Pin) * 2U))
+#define pinmuxTERM_PUPDR_MASK(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, pinmuxPULLS(Mode), 3U << (pinmuxINDEX(Pin) * 2U))
+#define pinmuxTERM_PUPDR(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, pinmuxPULLS(Mode), pinmuxPULL_##Pull << (pinmuxINDEX(Pin) * 2U))
+#define pinmuxTERM_AFRL_MASK(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, (pinmuxMODE_##Mode == pinmuxMODE_AF) && (pinmuxINDEX(Pin) < 8U), \
+            0xFU << ((pinmuxINDEX(Pin) & 7U) * 4U))
+#define pinmuxTERM_AFRL(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, (pinmuxMODE_##Mode == pinmuxMODE_AF) && (pinmuxINDEX(Pin) < 8U), \
+            (uint32_t) (Af) << ((pinmuxINDEX(Pin) & 7U) * 4U))
+#define pinmuxTERM_AFRH_MASK(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, (pinmuxMODE_##Mode == pinmuxMODE_AF) && (pinmuxINDEX(Pin) >= 8U), \
+            0xFU << ((pinmuxINDEX(Pin) & 7U) * 4U))
+#define pinmuxTERM_AFRH(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, (pinmuxMODE_##Mode == pinmuxMODE_AF) && (pinmuxINDEX(Pin) >= 8U), \
+            (uint32_t) (Af) << ((pinmuxINDEX(Pin) & 7U) * 4U))
+#define pinmuxTERM_BSRR(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxROW(Sel, Port, pinmuxMODE_##Mode == pinmuxMODE_OUTPUT, \
+            (uint32_t) (Pin) << ((Level) ? 0U : 16U))
+
+/* Port clocks a table needs, as RCC_AHB1ENR bits. */
+#define pinmuxTERM_CLOCKS(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  | (RCC_AHB1ENR_GPIOAEN << pinmuxPORT_##Port)
+
+/* EXTI terms; Sel picks the EXTICR register for the EXTICR terms. */
+#define pinmuxEXTI_ROW(Exti, Bit, xValue) \
+  | (((pinmuxEXTI_##Exti & (Bit)) != 0U) ? (uint32_t) (xValue) : 0U)
+
+#define pinmuxTERM_EXTI_LINES(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxEXTI_ROW(Exti, pinmuxEXTI_IT | pinmuxEXTI_EVT, Pin)
+#define pinmuxTERM_EXTI_IMR(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxEXTI_ROW(Exti, pinmuxEXTI_IT, Pin)
+#define pinmuxTERM_EXTI_EMR(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxEXTI_ROW(Exti, pinmuxEXTI_EVT, Pin)
+#define pinmuxTERM_EXTI_RTSR(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxEXTI_ROW(Exti, pinmuxEXTI_RISE, Pin)
+#define pinmuxTERM_EXTI_FTSR(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  pinmuxEXTI_ROW(Exti, pinmuxEXTI_FALL, Pin)
+#define pinmuxTERM_EXTICR_MASK(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  | (((pinmuxEXTI_##Exti != 0U) && ((pinmuxINDEX(Pin) >> 2) == (Sel))) ? \
+     (0xFU << ((pinmuxINDEX(Pin) & 3U) * 4U)) : 0U)
+#define pinmuxTERM_EXTICR(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) \
+  | (((pinmuxEXTI_##Exti != 0U) && ((pinmuxINDEX(Pin) >> 2) == (Sel))) ? \
+     (pinmuxPORT_##Port << ((pinmuxINDEX(Pin) & 3U) * 4U)) : 0U)
+
+/* One image, folded over the rows of Table selected by Sel. */
+#define pinmuxFOLD(Table, Field, Sel) (0U Table(pinmuxTERM_##Field, Sel))
+
+/**
+  * @brief  Initializer of the PinmuxPort_t of one port of a table.
+  * @param  Table The table macro.
+  * @param  Port  The port letter.
+  */
+#define pinmuxPORT_IMAGE(Table, Port)                                               \
+  {                                                                                 \
+    GPIO##Port,                                                                     \
+    pinmuxFOLD(Table, MODER_MASK, pinmuxPORT_##Port),                               \
+    pinmuxFOLD(Table, MODER, pinmuxPORT_##Port),                                    \
+    pinmuxFOLD(Table, OTYPER_MASK, pinmuxPORT_##Port),                              \
+    pinmuxFOLD(Table, OTYPER, pinmuxPORT_##Port),                                   \
+    pinmuxFOLD(Table, OSPEEDR_MASK, pinmuxPORT_##Port),                             \
+    pinmuxFOLD(Table, OSPEEDR, pinmuxPORT_##Port),                                  \
+    pinmuxFOLD(Table, PUPDR_MASK, pinmuxPORT_##Port),                               \
+    pinmuxFOLD(Table, PUPDR, pinmuxPORT_##Port),                                    \
+    { pinmuxFOLD(Table, AFRL_MASK, pinmuxPORT_##Port),                              \
+      pinmuxFOLD(Table, AFRH_MASK, pinmuxPORT_##Port) },                            \
+    { pinmuxFOLD(Table, AFRL, pinmuxPORT_##Port),                                   \
+      pinmuxFOLD(Table, AFRH, pinmuxPORT_##Port) },                                 \
+    pinmuxFOLD(Table, BSRR, pinmuxPORT_##Port)                                      \
+  }
+
+/**
+  * @brief  Initializer of the PinmuxExti_t of a table.
+  * @param  Table The table macro.
+  */
+#define pinmuxEXTI_IMAGE(Table)                                                     \
+  {                                                                                 \
+    pinmuxFOLD(Table, EXTI_LINES, 0U),                                              \
+    pinmuxFOLD(Table, EXTI_IMR, 0U),                                                \
+    pinmuxFOLD(Table, EXTI_EMR, 0U),                                                \
+    pinmuxFOLD(Table, EXTI_RTSR, 0U),                                               \
+    pinmuxFOLD(Table, EXTI_FTSR, 0U),                                               \
+    { pinmuxFOLD(Table, EXTICR_MASK, 0U), pinmuxFOLD(Table, EXTICR_MASK, 1U),       \
+      pinmuxFOLD(Table, EXTICR_MASK, 2U), pinmuxFOLD(Table, EXTICR_MASK, 3U) },     \
+    { pinmuxFOLD(Table, EXTICR, 0U), pinmuxFOLD(Table, EXTICR, 1U),                 \
+      pinmuxFOLD(Table, EXTICR, 2U), pinmuxFOLD(Table, EXTICR, 3U) }                \
+  }
+
+/* RCC_AHB1ENR bits of the ports a table uses. */
+#define pinmuxCLOCKS(Table)         pinmuxFOLD(Table, CLOCKS, 0U)
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vPinmuxInit(void);
+void vPinmuxApplyPort(const PinmuxPort_t *pxImage);
+void vPinmuxApplyExti(const PinmuxExti_t *pxImage);
+void vPinmuxSetMode(GPIO_TypeDef *pxPort, uint16_t usPins, uint32_t ulMode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PINMUX_H */
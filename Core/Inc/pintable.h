@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file           : pintable.h
+  * @brief          : The board's GPIO pins, declared in one table and folded
+  *                   at compile time into per port register images.
+  ******************************************************************************
+  * Each row is X(Sel, Port, Pin, Mode, Type, Speed, Pull, Af, Level, Exti) as
+  * described in pinmux.h.  The rows mirror the pin configuration in Lab4.ioc,
+  * which stays the reference: MX_GPIO_Init() is still generated from it but
+  * no longer called, and vPinmuxInit() applies this table instead.  A pin
+  * changed in CubeMX must be changed here too.  The differences are the LEDs,
+  * which are GPIO outputs in Lab4.ioc and TIM4 channels here, see led.h, and
+  * MEMS_INT2, an event line in Lab4.ioc and an interrupt here, see accel.h.
+  *
+  * The USART2 pins are set up by HAL_UART_MspInit() and the debug and
+  * oscillator pins are left at their reset state, so none of them is listed.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PINTABLE_H
+#define __PINTABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "pinmux.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/*            Port  Pin                       Mode    Type Speed Pull    Af  Level Exti */
+#define BOARD_PIN_TABLE(X, Sel)                                                             \
+  X(Sel,      A,    Blue_Button_Pin_Pin,      INPUT,  PP,  LOW,  NOPULL, 0,  0,    IT_RISING) \
+  X(Sel,      A,    I2S3_WS_Pin,              AF,     PP,  LOW,  NOPULL, 6,  0,    NONE)    \
+  X(Sel,      A,    SPI1_SCK_Pin,             AF,     PP,  LOW,  NOPULL, 5,  0,    NONE)    \
+  X(Sel,      A,    SPI1_MISO_Pin,            AF,     PP,  LOW,  NOPULL, 5,  0,    NONE)    \
+  X(Sel,      A,    SPI1_MOSI_Pin,            AF,     PP,  LOW,  NOPULL, 5,  0,    NONE)    \
+  X(Sel,      A,    VBUS_FS_Pin,              INPUT,  PP,  LOW,  NOPULL, 0,  0,    NONE)    \
+  X(Sel,      A,    OTG_FS_ID_Pin,            AF,     PP,  LOW,  NOPULL, 10, 0,    NONE)    \
+  X(Sel,      A,    OTG_FS_DM_Pin,            AF,     PP,  LOW,  NOPULL, 10, 0,    NONE)    \
+  X(Sel,      A,    OTG_FS_DP_Pin,            AF,     PP,  LOW,  NOPULL, 10, 0,    NONE)    \
+  X(Sel,      B,    BOOT1_Pin,                INPUT,  PP,  LOW,  NOPULL, 0,  0,    NONE)    \
+  X(Sel,      B,    CLK_IN_Pin,               AF,     PP,  LOW,  NOPULL, 5,  0,    NONE)    \
+  X(Sel,      B,    Audio_SCL_Pin,            AF,     OD,  LOW,  NOPULL, 4,  0,    NONE)    \
+  X(Sel,      B,    Audio_SDA_Pin,            AF,     OD,  LOW,  NOPULL, 4,  0,    NONE)    \
+  X(Sel,      C,    OTG_FS_PowerSwitchOn_Pin, OUTPUT, PP,  LOW,  NOPULL, 0,  1,    NONE)    \
+  X(Sel,      C,    PDM_OUT_Pin,              AF,     PP,  LOW,  NOPULL, 5,  0,    NONE)    \
+  X(Sel,      C,    I2S3_MCK_Pin,             AF,     PP,  LOW,  NOPULL, 6,  0,    NONE)    \
+  X(Sel,      C,    I2S3_SCK_Pin,             AF,     PP,  LOW,  NOPULL, 6,  0,    NONE)    \
+  X(Sel,      C,    I2S3_SD_Pin,              AF,     PP,  LOW,  NOPULL, 6,  0,    NONE)    \
+  X(Sel,      D,    Green_LED_Pin,            AF,     PP,  LOW,  NOPULL, 2,  0,    NONE)    \
+  X(Sel,      D,    Orange_LED_Pin,           AF,     PP,  LOW,  NOPULL, 2,  0,    NONE)    \
+  X(Sel,      D,    Red_LED_Pin,              AF,     PP,  LOW,  NOPULL, 2,  0,    NONE)    \
+  X(Sel,      D,    Blue_LED_Pin,             AF,     PP,  LOW,  NOPULL, 2,  0,    NONE)    \
+  X(Sel,      D,    Audio_RST_Pin,            OUTPUT, PP,  LOW,  NOPULL, 0,  0,    NONE)    \
+  X(Sel,      D,    OTG_FS_OverCurrent_Pin,   INPUT,  PP,  LOW,  NOPULL, 0,  0,    NONE)    \
+  X(Sel,      E,    MEMS_INT2_Pin,            INPUT,  PP,  LOW,  NOPULL, 0,  0,    IT_RISING) \
+  X(Sel,      E,    CS_I2C_SPI_Pin,           OUTPUT, PP,  LOW,  NOPULL, 0,  0,    NONE)
+
+/* Ports with a row, in the order vPinmuxInit() applies them. */
+#define BOARD_PIN_PORTS(X)          X(A) X(B) X(C) X(D) X(E)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PINTABLE_H */
@@ -0,0 +1,197 @@
+/**
+  ******************************************************************************
+  * @file           : pipeline.h
+  * @brief          : Producer/consumer pipelines of stages joined by stream
+  *                   buffers, read and written in place.
+  ******************************************************************************
+  * A data path such as sensor -> filter -> encoder -> UART is a chain of
+  * stages, each a registered task, joined by links, each a static stream
+  * buffer of fixed size items.  A stage takes a run of items where they lie
+  * in its input with xStreamBufferPeekContiguous(), writes its results
+  * straight into the free space of its output from xStreamBufferReserve(),
+  * and then consumes and commits as many items as its function used and
+  * made.  No item is ever copied between stages, unlike a chain of queues.
+  *
+  *   pipelineLINK(RAW, int16_t, 256U, 64U);
+  *   pipelineLINK(FILTERED, int16_t, 128U, 32U);
+  *
+  *   pipelineFUNCTION(prvFilter, int16_t, int16_t)
+  *   {
+  *     size_t x, xCount = (xInItems < *pxOutItems) ? xInItems : *pxOutItems;
+  *     for (x = 0U; x < xCount; x++) { pxOut[x] = ...pxIn[x]...; }
+  *     *pxOutItems = xCount;
+  *     return xCount;
+  *   }
+  *
+  *   pipelineSTAGE(FILTER, prvFilter, NULL, &xRAWLink, &xFILTEREDLink,
+  *                 pdMS_TO_TICKS(20), 128U, tskIDLE_PRIORITY + 2U);
+  *
+  * with xPipelineLinkInit() called on both links before vTaskRegistryStart().
+  * The function is handed every item its input holds up to where the storage
+  * wraps, and room for as many results as its output has free up to the
+  * same point.  It returns how many items it consumed and sets *pxOutItems to
+  * how many results it made; it must consume or make at least one each time.
+  * A function that works on blocks keeps a partial block in its context.  A
+  * sink has no output link and is called with pvOut NULL and no room.
+  *
+  * Each link has a batch size, its stream buffer's trigger level in items:
+  * a stage blocked on an empty input wakes only once a batch has arrived, or
+  * its xMaxWait has passed with less, and then works through everything
+  * there before it blocks again.  A writer that finds its output full waits
+  * in turn until the reader has freed a batch, so a slow stage holds back
+  * the ones before it without any of them spinning, and each wake-up of
+  * either side moves a batch.  xPipelineSetBatch() trades latency for fewer
+  * wake-ups at run time.
+  *
+  * The first link may be filled by a stage, a task through xPipelineWrite()
+  * or an interrupt through xPipelineReserve() and
+  * vPipelineCommitFromISR(), which never wait.  Each link has one writer and
+  * one reader.  A stage's task notification belongs to its links, so its
+  * function must not use it.
+  *
+  * Every stage counts the items it took and made, its wake-ups, the calls
+  * to its function and the times its output held it up, and notes the most
+  * items it ever found waiting at its input.  uxPipelineGetStats() collects
+  * them, and the shell's pipes command prints them.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PIPELINE_H
+#define __PIPELINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "taskreg.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+  * @brief  Stage function: use up to xInItems at pvIn and write up to
+  *         *pxOutItems at pvOut.
+  * @retval Items consumed; *pxOutItems is set to the items made.
+  */
+typedef size_t (*PipelineFunction_t)(void *pvContext, const void *pvIn, size_t xInItems,
+                                     void *pvOut, size_t *pxOutItems);
+
+/**
+  * @brief  A link between two stages.  Declared with pipelineLINK(); the
+  *         fields are private to pipeline.c.
+  */
+typedef struct
+{
+  uint8_t *pucStorage;
+  size_t xStorageBytes;       /*!< One item more than the link holds.        */
+  size_t xItemSize;
+  size_t xBatch;              /*!< Items that wake the reader, and free
+                                   items that wake a stalled writer.         */
+  StreamBufferHandle_t xStream;
+  StaticStreamBuffer_t xStreamStruct;
+  TaskHandle_t xStalledWriter; /*!< Waiting for a batch of room, or NULL.    */
+  uint32_t ulFull;            /*!< Reservations that found no room.          */
+} PipelineLink_t;
+
+/**
+  * @brief  A stage.  Declared with pipelineSTAGE(); the fields are private to
+  *         pipeline.c.
+  */
+typedef struct xPIPELINE_STAGE
+{
+  const char *pcName;
+  PipelineFunction_t pxFunction;
+  void *pvContext;
+  PipelineLink_t *pxIn;
+  PipelineLink_t *pxOut;      /*!< NULL for a sink.                          */
+  TickType_t xMaxWait;        /*!< Longest a part batch waits.               */
+  struct xPIPELINE_STAGE *pxNext;
+  uint32_t ulItemsIn;
+  uint32_t ulItemsOut;
+  uint32_t ulWakes;
+  uint32_t ulCalls;
+  uint32_t ulStalls;
+  size_t xPeakItems;
+} PipelineStage_t;
+
+/* What uxPipelineGetStats() reports for each stage. */
+typedef struct
+{
+  const char *pcName;
+  uint32_t ulItemsIn;         /*!< Items taken from the input.               */
+  uint32_t ulItemsOut;        /*!< Items committed to the output.            */
+  uint32_t ulWakes;           /*!< Returns from waiting for input.           */
+  uint32_t ulCalls;           /*!< Calls to the stage function.              */
+  uint32_t ulStalls;          /*!< Waits for room in the output.             */
+  uint32_t ulInputFull;       /*!< Writes refused by a full input.           */
+  uint16_t usPeakItems;       /*!< Most items found waiting at the input.    */
+  uint16_t usDepth;           /*!< Items the input holds.                    */
+} PipelineStats_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/**
+  * @brief  Declare a link of xDepth items of Type at file scope, whose reader
+  *         wakes for xBatch of them.  Defines x<Name>Link.
+  * @note   The storage is plain SRAM, so DMA may fill or drain it through
+  *         xPipelineReserve() and the peek and consume of the stream buffer.
+  */
+#define pipelineLINK(Name, Type, xDepth, xBatch)                                    \
+  static Type x##Name##Items[(xDepth) + 1U];                                        \
+  PipelineLink_t x##Name##Link =                                                    \
+  {                                                                                 \
+    (uint8_t *) x##Name##Items, sizeof(x##Name##Items), sizeof(Type), (xBatch)      \
+  }
+
+/**
+  * @brief  Declare a stage function working on typed items.  The braces that
+  *         follow are its body, which sees pvContext, pxIn, xInItems, pxOut
+  *         and pxOutItems.  OutType is void for a sink.
+  */
+#define pipelineFUNCTION(Name, InType, OutType)                                     \
+  static size_t Name##Typed(void *pvContext, const InType *pxIn, size_t xInItems,   \
+                            OutType *pxOut, size_t *pxOutItems);                    \
+  static size_t Name(void *pvContext, const void *pvIn, size_t xInItems,            \
+                     void *pvOut, size_t *pxOutItems)                               \
+  {                                                                                 \
+    return Name##Typed(pvContext, (const InType *) pvIn, xInItems,                  \
+                       (OutType *) pvOut, pxOutItems);                              \
+  }                                                                                 \
+  static size_t Name##Typed(void *pvContext, const InType *pxIn, size_t xInItems,   \
+                            OutType *pxOut, size_t *pxOutItems)
+
+/**
+  * @brief  Declare a stage at file scope: a registered task named Name that
+  *         runs pxFunction from pxIn to pxOut, NULL for a sink.  Defines
+  *         x<Name>Stage and x<Name>Handle.
+  */
+#define pipelineSTAGE(Name, pxFunction, pvContext, pxIn, pxOut, xMaxWait,           \
+                      ulStackDepth, uxPriority)                                     \
+  PipelineStage_t x##Name##Stage =                                                  \
+  {                                                                                 \
+    #Name, (pxFunction), (pvContext), (pxIn), (pxOut), (xMaxWait)                   \
+  };                                                                                \
+  TASK_REGISTER(Name, vPipelineStageTask, &x##Name##Stage, ulStackDepth, uxPriority)
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xPipelineLinkInit(PipelineLink_t *pxLink);
+BaseType_t xPipelineSetBatch(PipelineLink_t *pxLink, size_t xBatch);
+size_t xPipelineReserve(PipelineLink_t *pxLink, void **ppvItems);
+void vPipelineCommit(PipelineLink_t *pxLink, size_t xItems);
+void vPipelineCommitFromISR(PipelineLink_t *pxLink, size_t xItems, BaseType_t *pxHigherPriorityTaskWoken);
+size_t xPipelineWrite(PipelineLink_t *pxLink, const void *pvItems, size_t xItems, TickType_t xTicksToWait);
+UBaseType_t uxPipelineGetStats(PipelineStats_t *pxStats, UBaseType_t uxMaxStages);
+void vPipelineStageTask(void *pvParameters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PIPELINE_H */
@@ -0,0 +1,88 @@
+/**
+  ******************************************************************************
+  * @file           : profiler.h
+  * @brief          : Statistical profiler: the PC and task of whatever was
+  *                   running, sampled from a timer interrupt into a histogram.
+  ******************************************************************************
+  * With profilerENABLE set TIM2 interrupts profilerRATE_HZ times a second at
+  * profilerPRIORITY, above the kernel's ceiling, so critical sections and the
+  * scheduler are sampled as well.  Each interrupt takes the PC the hardware
+  * stacked for the code it interrupted, and the running task unless that
+  * code was itself an interrupt, and counts the pair in a hash table.  Every
+  * profilerREPORT_MS a low priority task logs the table and starts a fresh
+  * one:
+  *
+  *   prof,window,<samples>,<lost>,<rate Hz>
+  *   prof,<task>,<pc>,<count>        one per distinct pair, in no order
+  *
+  * <task> is "isr" for a sample taken in another interrupt and "-" for a
+  * task deleted since.  A sample whose slot could not be found in
+  * profilerPROBES tries counts as lost.  Tools/profile_report.py sums the
+  * windows of a capture and names the PCs from Debug/Lab4.map, or from the
+  * ELF when given one, into a flat profile and one per task.
+  *
+  * The rate is kept off a multiple of the 1 kHz tick, so that the samples do
+  * not lock onto it.  It follows the clock profile the governor picks to
+  * within a window.  A sample costs about 60 cycles, under 0.05% of the
+  * core at the default rate.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* 1 to sample and report. */
+#ifndef profilerENABLE
+#define profilerENABLE              0
+#endif
+
+/* Samples per second. */
+#ifndef profilerRATE_HZ
+#define profilerRATE_HZ             997U
+#endif
+
+/* Above configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, so nothing but a
+   PRIMASK section or a more urgent interrupt hides code from it. */
+#ifndef profilerPRIORITY
+#define profilerPRIORITY            2U
+#endif
+
+/* Distinct task and PC pairs a window can hold, a power of two. */
+#ifndef profilerSLOTS
+#define profilerSLOTS               256U
+#endif
+
+/* Slots tried for a pair before its sample is lost. */
+#ifndef profilerPROBES
+#define profilerPROBES              8U
+#endif
+
+#ifndef profilerREPORT_MS
+#define profilerREPORT_MS           5000U
+#endif
+
+/* Tasks the report can name; with more than this every task is "-". */
+#ifndef profilerMAX_TASKS
+#define profilerMAX_TASKS           16U
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vProfilerSample(const uint32_t *pulFrame, uint32_t ulExcReturn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PROFILER_H */
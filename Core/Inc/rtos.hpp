@@ -0,0 +1,243 @@
+/**
+  ******************************************************************************
+  * @file           : rtos.hpp
+  * @brief          : Header only C++ wrappers for statically allocated
+  *                   queues, tasks and mutexes.
+  ******************************************************************************
+  * The queue API takes void pointers and an item size it only learns at run
+  * time.  rtos::Queue<T, N> fixes both at compile time: it holds the storage
+  * for N items of T and the queue structure itself, so a queue costs no heap
+  * and a send or receive of anything but a T does not compile.  T must be
+  * trivially copyable, since the kernel copies items as bytes.  queue.c
+  * moves items of 4 and 8 bytes with loads and stores of a constant length,
+  * so a queue of words, pointers or pairs of them hops with register moves
+  * rather than a call to portMEMCPY().
+  *
+  *   static rtos::Queue<uint32_t, 8U> xSamples;
+  *   static rtos::StaticTask<256U> xWorker;
+  *   static rtos::Mutex xBusLock;
+  *
+  *   (void) xSamples.send(ulValue, 0U);
+  *   {
+  *     rtos::MutexLock xLock(xBusLock);
+  *     ...                     the bus is held until the end of the block
+  *   }
+  *   (void) xWorker.start(prvWorkerTask, "WORKER", nullptr, tskIDLE_PRIORITY + 1U);
+  *
+  * Queues and mutexes are created by their constructors, so objects with
+  * static storage exist before main() runs; the kernel leaves interrupts
+  * masked from then until the scheduler starts, as it does for any kernel
+  * object created before it.  None of them may be copied or destroyed, as
+  * the kernel holds pointers into them.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __RTOS_HPP
+#define __RTOS_HPP
+
+/* Includes ------------------------------------------------------------------*/
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "taskreg.h"
+
+namespace rtos
+{
+
+/**
+  * @brief  A queue of N items of T, storage included.
+  */
+template <typename T, UBaseType_t N>
+class Queue
+{
+  static_assert(std::is_trivially_copyable<T>::value, "queue items are copied as bytes");
+  static_assert(N > 0U, "a queue holds at least one item");
+
+public:
+  static constexpr UBaseType_t uxItemSize = sizeof(T);
+  static constexpr UBaseType_t uxLength = N;
+
+  Queue() : xHandle(xQueueCreateStatic(N, uxItemSize, ucStorage, &xQueueStruct))
+  {
+    configASSERT(xHandle != nullptr);
+  }
+
+  Queue(const Queue &) = delete;
+  Queue &operator=(const Queue &) = delete;
+
+  bool send(const T &xItem, TickType_t xTicksToWait = 0U)
+  {
+    return xQueueSendToBack(xHandle, &xItem, xTicksToWait) == pdPASS;
+  }
+
+  bool sendToFront(const T &xItem, TickType_t xTicksToWait = 0U)
+  {
+    return xQueueSendToFront(xHandle, &xItem, xTicksToWait) == pdPASS;
+  }
+
+  bool sendFromISR(const T &xItem, BaseType_t *pxHigherPriorityTaskWoken)
+  {
+    return xQueueSendToBackFromISR(xHandle, &xItem, pxHigherPriorityTaskWoken) == pdPASS;
+  }
+
+  /* Only for a queue of one item: replace it, or send if there is none. */
+  void overwrite(const T &xItem)
+  {
+    static_assert(N == 1U, "only a queue of one item can be overwritten");
+    (void) xQueueOverwrite(xHandle, &xItem);
+  }
+
+  bool receive(T &xItem, TickType_t xTicksToWait = portMAX_DELAY)
+  {
+    return xQueueReceive(xHandle, &xItem, xTicksToWait) == pdPASS;
+  }
+
+  bool receiveFromISR(T &xItem, BaseType_t *pxHigherPriorityTaskWoken)
+  {
+    return xQueueReceiveFromISR(xHandle, &xItem, pxHigherPriorityTaskWoken) == pdPASS;
+  }
+
+  bool peek(T &xItem, TickType_t xTicksToWait = 0U)
+  {
+    return xQueuePeek(xHandle, &xItem, xTicksToWait) == pdPASS;
+  }
+
+  UBaseType_t waiting() const
+  {
+    return uxQueueMessagesWaiting(xHandle);
+  }
+
+  UBaseType_t spaces() const
+  {
+    return uxQueueSpacesAvailable(xHandle);
+  }
+
+  void reset()
+  {
+    (void) xQueueReset(xHandle);
+  }
+
+  QueueHandle_t handle() const
+  {
+    return xHandle;
+  }
+
+private:
+  alignas(T) uint8_t ucStorage[N * sizeof(T)];
+  StaticQueue_t xQueueStruct;
+  QueueHandle_t xHandle;
+};
+
+/**
+  * @brief  The TCB and a stack of StackWords for one task, started with
+  *         start().  As with TASK_REGISTER(), the stack gets the MPU guard on
+  *         top of its depth.
+  */
+template <uint32_t StackWords>
+class StaticTask
+{
+  static_assert(StackWords >= configMINIMAL_STACK_SIZE, "stack below configMINIMAL_STACK_SIZE");
+
+public:
+  static constexpr uint32_t ulStackDepth = StackWords + taskregGUARD_WORDS;
+
+  StaticTask() = default;
+
+  StaticTask(const StaticTask &) = delete;
+  StaticTask &operator=(const StaticTask &) = delete;
+
+  /* Create the task, once. */
+  TaskHandle_t start(TaskFunction_t pxEntry, const char *pcName, void *pvParameters, UBaseType_t uxPriority)
+  {
+    configASSERT(xHandle == nullptr);
+    xHandle = xTaskCreateStatic(pxEntry, pcName, ulStackDepth, pvParameters, uxPriority, uxStack, &xTCB);
+    return xHandle;
+  }
+
+  TaskHandle_t handle() const
+  {
+    return xHandle;
+  }
+
+private:
+  StackType_t uxStack[ulStackDepth] taskregSTACK_ALIGNED;
+  StaticTask_t xTCB;
+  TaskHandle_t xHandle = nullptr;
+};
+
+/**
+  * @brief  A mutex, with priority inheritance.  Take it with MutexLock.
+  */
+class Mutex
+{
+public:
+  Mutex() : xHandle(xSemaphoreCreateMutexStatic(&xMutexStruct))
+  {
+    configASSERT(xHandle != nullptr);
+  }
+
+  Mutex(const Mutex &) = delete;
+  Mutex &operator=(const Mutex &) = delete;
+
+  bool lock(TickType_t xTicksToWait = portMAX_DELAY)
+  {
+    return xSemaphoreTake(xHandle, xTicksToWait) == pdPASS;
+  }
+
+  void unlock()
+  {
+    (void) xSemaphoreGive(xHandle);
+  }
+
+  SemaphoreHandle_t handle() const
+  {
+    return xHandle;
+  }
+
+private:
+  StaticSemaphore_t xMutexStruct;
+  SemaphoreHandle_t xHandle;
+};
+
+/**
+  * @brief  Holds a Mutex from its construction to the end of its scope.
+  *         With a timeout the mutex may not be taken: test locked().
+  */
+class MutexLock
+{
+public:
+  explicit MutexLock(Mutex &xMutexToLock, TickType_t xTicksToWait = portMAX_DELAY)
+    : xMutex(xMutexToLock), xLocked(xMutexToLock.lock(xTicksToWait))
+  {
+  }
+
+  ~MutexLock()
+  {
+    if (xLocked)
+    {
+      xMutex.unlock();
+    }
+  }
+
+  MutexLock(const MutexLock &) = delete;
+  MutexLock &operator=(const MutexLock &) = delete;
+
+  bool locked() const
+  {
+    return xLocked;
+  }
+
+private:
+  Mutex &xMutex;
+  const bool xLocked;
+};
+
+} /* namespace rtos */
+
+#endif /* __RTOS_HPP */
@@ -0,0 +1,85 @@
+/**
+  ******************************************************************************
+  * @file           : shell.h
+  * @brief          : On-demand diagnostics shell on USART2, in place of the
+  *                   report the firmware used to print every few seconds.
+  ******************************************************************************
+  * A low priority task reads command lines from the receive ring of uartrx.h
+  * and answers through the log, so the UART carries nothing until asked.
+  * Lines end with CR, LF or both; words are separated by spaces or tabs:
+  *
+  *   help                        the commands, one line each
+  *   heap [changes|owners|leaks] figures, free list changes, or per task use
+  *   tasks                       state, priorities, stack left and CPU share
+  *   stats                       CPU snapshot, switch times and drop counts
+  *   trace start|stop            let the trace recorder run, or hold it
+  *   clock                       profile, SYSCLK and the governor's load
+  *   pipes                       items, wake-ups and stalls of each pipeline
+  *                               stage
+  *   baud [rate]                 line rate, or switch it; see uartline.h
+  *
+  * A line is parsed where it lies in the ring, without copying: the task
+  * scans the bytes as they arrive, writes the terminators of the words over
+  * the separators and hands the line back to reception only once the command
+  * has run.  Only a line that wraps round the end of the ring is copied, to
+  * a buffer of shellLINE_LENGTH.  A longer line is dropped whole.
+  *
+  * The shell takes every received byte, so stdin cannot be read while it is
+  * enabled.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SHELL_H
+#define __SHELL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#ifndef shellENABLE
+#define shellENABLE                 1
+#endif
+
+/* Stack of the shell task in words; the reports it calls format on it. */
+#ifndef shellSTACK_DEPTH
+#define shellSTACK_DEPTH            256U
+#endif
+
+/* Just above the idle task, so a command never delays the application. */
+#ifndef shellPRIORITY
+#define shellPRIORITY               (tskIDLE_PRIORITY + 1U)
+#endif
+
+/* Longest command line, without its terminator; must be less than
+   uartrxRING_SIZE. */
+#ifndef shellLINE_LENGTH
+#define shellLINE_LENGTH            80U
+#endif
+
+/* Most words on a line, the command included. */
+#ifndef shellMAX_ARGS
+#define shellMAX_ARGS               8U
+#endif
+
+/* Most tasks the tasks command lists; with more it lists none. */
+#ifndef shellMAX_TASKS
+#define shellMAX_TASKS              16U
+#endif
+
+/* Most pipeline stages the pipes command lists. */
+#ifndef shellMAX_STAGES
+#define shellMAX_STAGES             8U
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SHELL_H */
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file           : stackcheck.h
+  * @brief          : Runtime stack watermarks of the registered tasks and of
+  *                   the main stack, and the kernel's stack overflow hook.
+  ******************************************************************************
+  * vStackCheckReport() writes one line per task to the log, and one named MSP
+  * for the main stack:
+  *
+  *   stack <name> depth <words> used <words> free <words>
+  *
+  * Once the scheduler has started only exception handlers run on the main
+  * stack, _Min_Stack_Size bytes below _estack.  Reset_Handler paints it with
+  * stackcheckMSP_FILL, and the port sets the stack pointer back to the top
+  * as the first task starts, so main()'s frame is free again; with
+  * stackcheckMSP_RESTART the paint over it is renewed too, and the watermark
+  * then shows the deepest nesting of interrupts alone.
+  *
+  * Tools/stack_usage.py reads these lines from a UART capture and sets them
+  * against the worst case it derives from the .su files of the build, for
+  * the main stack from the handlers of BOARD_IRQ_TABLE nested by priority.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STACKCHECK_H
+#define __STACKCHECK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Word Reset_Handler paints the main stack with, the kernel's stack fill. */
+#define stackcheckMSP_FILL          0xA5A5A5A5UL
+
+/* 1 to repaint the main stack from the timer service task's startup hook, so
+   that the watermark leaves out main() and the boot code.  Needs
+   configUSE_DAEMON_TASK_STARTUP_HOOK. */
+#ifndef stackcheckMSP_RESTART
+#define stackcheckMSP_RESTART       1
+#endif
+
+/* Exported variables --------------------------------------------------------*/
+
+/* Task that tripped the overflow check, for the debugger; NULL until then. */
+extern volatile TaskHandle_t xStackOverflowTask;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vStackCheckReport(void);
+UBaseType_t uxStackCheckMspDepth(void);
+UBaseType_t uxStackCheckMspHighWaterMark(void);
+void vStackCheckMspRestart(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STACKCHECK_H */
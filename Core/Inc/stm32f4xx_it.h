@@ -47,16 +47,26 @@
 
 /* Exported functions prototypes ---------------------------------------------*/
 void NMI_Handler(void);
-void HardFault_Handler(void);
-void MemManage_Handler(void);
-void BusFault_Handler(void);
-void UsageFault_Handler(void);
 //void SVC_Handler(void);
 void DebugMon_Handler(void);
 //void PendSV_Handler(void);
 //void SysTick_Handler(void);
-void TIM7_IRQHandler(void);
+void DMA1_Stream6_IRQHandler(void);
+void USART2_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void TIM5_IRQHandler(void);
+void RTC_WKUP_IRQHandler(void);
+void DMA1_Stream0_IRQHandler(void);
+void DMA1_Stream5_IRQHandler(void);
+void EXTI0_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+void DMA2_Stream0_IRQHandler(void);
+void DMA1_Stream7_IRQHandler(void);
+void DMA1_Stream3_IRQHandler(void);
+void DMA2_Stream1_IRQHandler(void);
+void DMA2_Stream2_IRQHandler(void);
+void OTG_FS_IRQHandler(void);
+void OTG_FS_WKUP_IRQHandler(void);
 
 /* USER CODE END EFP */
 
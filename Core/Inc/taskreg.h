@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : taskreg.h
+  * @brief          : Compile time task registry.  Each TASK_REGISTER() places a
+  *                   descriptor in the .task_registry linker section together
+  *                   with a static TCB and stack, and vTaskRegistryStart()
+  *                   creates every registered task without touching the heap.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TASKREG_H
+#define __TASKREG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if (configSUPPORT_STATIC_ALLOCATION != 1)
+#error The task registry requires configSUPPORT_STATIC_ALLOCATION to be 1
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  TaskFunction_t pxEntry;
+  const char *pcName;
+  void *pvParameters;
+  StackType_t *puxStack;
+  StaticTask_t *pxTCB;
+  TaskHandle_t *pxHandle;
+  uint32_t ulStackDepth;      /* In words, the length of puxStack. */
+  UBaseType_t uxPriority;
+} TaskRegistryEntry_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Where TASK_REGISTER_IN() puts a task's TCB and stack.  The linker script
+   collects each into its own range and checks it against a budget.  CCM is
+   faster and keeps stacks off the bus matrix, but is not reachable by DMA. */
+#define taskregSECTION_SRAM         __attribute__((section(".bss.task_memory")))
+#define taskregSECTION_CCM          __attribute__((section(".ccmbss.task_memory")))
+
+/* With the MPU stack guard, static stacks start on a guard region boundary
+   and get taskregGUARD_WORDS more than the depth declared, so the guard never
+   eats into the depth a task was sized for. */
+#if (configUSE_MPU_STACK_GUARD == 1)
+#define taskregSTACK_ALIGNED        __attribute__((aligned(portSTACK_GUARD_BYTES)))
+#define taskregGUARD_WORDS          (portSTACK_GUARD_BYTES / sizeof(StackType_t))
+#else
+#define taskregSTACK_ALIGNED
+#define taskregGUARD_WORDS          0U
+#endif
+
+/**
+  * @brief  Declare a task at file scope.
+  * @param  Placement SRAM or CCM, see taskregSECTION_*.
+  * @note   Defines x<Name>Handle, which holds the handle once
+  *         vTaskRegistryStart() has run, and the task's static TCB and stack,
+  *         so all of its RAM appears under its own name in the .map file.
+  */
+#define TASK_REGISTER_IN(Placement, Name, pxEntry, pvParameters, ulStackDepth, uxPriority) \
+  TaskHandle_t x##Name##Handle = NULL;                                              \
+  static StackType_t ux##Name##Stack[(ulStackDepth) + taskregGUARD_WORDS]          \
+    taskregSECTION_##Placement taskregSTACK_ALIGNED;                                \
+  static StaticTask_t x##Name##TCB taskregSECTION_##Placement;                      \
+  static const TaskRegistryEntry_t x##Name##Entry                                   \
+    __attribute__((section(".task_registry"), used, aligned(4))) =                  \
+  {                                                                                 \
+    (pxEntry), #Name, (pvParameters), ux##Name##Stack, &x##Name##TCB,               \
+    &x##Name##Handle, (ulStackDepth) + taskregGUARD_WORDS, (uxPriority)             \
+  }
+
+#define TASK_REGISTER(Name, pxEntry, pvParameters, ulStackDepth, uxPriority)       \
+  TASK_REGISTER_IN(SRAM, Name, pxEntry, pvParameters, ulStackDepth, uxPriority)
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vTaskRegistryStart(void);
+UBaseType_t uxTaskRegistryCount(void);
+const TaskRegistryEntry_t *pxTaskRegistryGet(UBaseType_t uxIndex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TASKREG_H */
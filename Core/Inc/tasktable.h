@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file           : tasktable.h
+  * @brief          : The application's boot tasks, declared in one table and
+  *                   expanded at compile time into static TCBs and stacks.
+  ******************************************************************************
+  * Each row is X(Name, entry function, stack depth in words, priority,
+  * placement), with placement SRAM or CCM as for TASK_REGISTER_IN().  main.c
+  * expands the table once with tasktableREGISTER and checks it against the
+  * budgets below with static assertions.  The same budgets are exported to
+  * the linker, which checks them again against everything actually placed,
+  * including tasks registered outside this table.
+  *
+  * Periodic work belongs in a job started with xPeriodicJobStart() rather
+  * than in a task of its own here; see periodic.h.  Short work that would
+  * otherwise delete its task when done belongs in a job submitted to the
+  * worker pool; see workerpool.h.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TASKTABLE_H
+#define __TASKTABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "taskreg.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Bytes of TCB plus stack each placement may hold.  Plain numbers, as they are
+   also handed to the assembler.  CCM is shared with heap_regions.c. */
+#define tasktableSRAM_BUDGET_BYTES  4096
+#define tasktableCCM_BUDGET_BYTES   16384
+
+/*          Name       Entry           Stack  Prio  Placement */
+#define APP_TASK_TABLE(X)
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* One row as a registered task. */
+#define tasktableREGISTER(Name, pxEntry, ulStackDepth, uxPriority, Placement) \
+  TASK_REGISTER_IN(Placement, Name, pxEntry, NULL, ulStackDepth, uxPriority);
+
+/* RAM a row costs, counted only against its own placement. */
+#define tasktableIN_SRAM_SRAM       1U
+#define tasktableIN_SRAM_CCM        0U
+#define tasktableIN_CCM_SRAM        0U
+#define tasktableIN_CCM_CCM         1U
+
+#define tasktableROW_BYTES(ulStackDepth) \
+  ((((ulStackDepth) + taskregGUARD_WORDS) * sizeof(StackType_t)) + sizeof(StaticTask_t))
+
+#define tasktableSRAM_BYTES(Name, pxEntry, ulStackDepth, uxPriority, Placement) \
+  + (tasktableIN_SRAM_##Placement * tasktableROW_BYTES(ulStackDepth))
+
+#define tasktableCCM_BYTES(Name, pxEntry, ulStackDepth, uxPriority, Placement) \
+  + (tasktableIN_CCM_##Placement * tasktableROW_BYTES(ulStackDepth))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TASKTABLE_H */
@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file           : timebase.h
+  * @brief          : One 32-bit TIM5 counter at 1 MHz standing in for SysTick,
+  *                   the TIM7 HAL tick and busy loops.
+  ******************************************************************************
+  * TIM5 free runs from reset, so its counter is a microsecond clock that wraps
+  * every 71 minutes.  Compare channel 1 advances by one tick period at every
+  * match and raises both the HAL tick and, once the scheduler is running, the
+  * kernel tick, which replaces SysTick.  Channel 2 serves one-shot events with
+  * microsecond resolution.
+  *
+  * Until the scheduler starts TIM5 runs at TICK_INT_PRIORITY, so HAL_Delay()
+  * keeps working while kernel objects are created with interrupts masked.
+  * vPortSetupTimerInterrupt() then drops it to the kernel interrupt priority,
+  * as the kernel tick requires.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TIMEBASE_H
+#define __TIMEBASE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*TimebaseCallback_t)(void *pvParameter);
+
+/**
+  * @brief  One one-shot event.  Owned by the caller, which must zero it before
+  *         first use and keep it alive while it is pending; the fields are
+  *         private to the timebase.
+  */
+typedef struct xTIMEBASE_EVENT
+{
+  struct xTIMEBASE_EVENT *pxNext;
+  uint32_t ulDueUs;           /*!< Counter value at which the event fires.   */
+  TimebaseCallback_t pxCallback;
+  void *pvParameter;
+  uint32_t ulPending;         /*!< Non-zero while on the pending list.       */
+} TimebaseEvent_t;
+
+/**
+  * @brief  A notification sent by xTaskNotifyAtUs().  Owned by the caller, as
+  *         for TimebaseEvent_t.
+  */
+typedef struct xTIMEBASE_NOTIFY
+{
+  TimebaseEvent_t xEvent;
+  TaskHandle_t xTask;
+  uint32_t ulValue;
+  eNotifyAction eAction;
+} TimebaseNotify_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Counter rate, and counts per kernel and HAL tick.  One compare raises both,
+   so configTICK_RATE_HZ must stay at the 1 kHz HAL tick rate. */
+#define timebaseCOUNTER_HZ          1000000UL
+#define timebaseTICK_PERIOD_US      (timebaseCOUNTER_HZ / 1000UL)
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* The counter, in microseconds. */
+#define ulTimebaseNowUs()           (TIM5->CNT)
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vTimebaseIRQHandler(void);
+uint32_t ulTimebaseUsIntoTick(void);
+BaseType_t xTimebaseTickPending(void);
+void vTimebaseResumeAfterSleep(uint32_t ulCountAtStop, uint32_t ulSleptUs, uint32_t ulTicksToStep);
+
+void vTimebaseEventStart(TimebaseEvent_t *pxEvent, uint32_t ulDelayUs,
+                         TimebaseCallback_t pxCallback, void *pvParameter);
+void vTimebaseEventStartAt(TimebaseEvent_t *pxEvent, uint32_t ulDueUs,
+                           TimebaseCallback_t pxCallback, void *pvParameter);
+BaseType_t xTimebaseEventStop(TimebaseEvent_t *pxEvent);
+BaseType_t xTimebaseEventsPending(void);
+
+void vTaskDelayUs(uint32_t ulDelayUs);
+BaseType_t xTaskNotifyAtUs(TimebaseNotify_t *pxNotify, TaskHandle_t xTask, uint32_t ulDueUs,
+                           uint32_t ulValue, eNotifyAction eAction);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMEBASE_H */
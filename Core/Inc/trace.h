@@ -0,0 +1,270 @@
+/**
+  ******************************************************************************
+  * @file           : trace.h
+  * @brief          : Binary trace recorder.  Kernel trace hooks append fixed
+  *                   size records to a lock-free ring that a low priority
+  *                   task drains, so tracing costs microseconds at the call
+  *                   site rather than a blocking UART transfer.
+  ******************************************************************************
+  * Besides the allocator and task lifetime events, with traceKERNEL_EVENTS set
+  * the scheduler, queue, delay and notification hooks record too, which is
+  * enough to rebuild a timeline of what ran, what it blocked on and what woke
+  * it.  The drain task sends the records through the log sink as binary
+  * frames, all little endian:
+  *
+  *   uint8_t  ucSync       traceSYNC_RECORDS
+  *   uint8_t  ucCount      1 to traceFRAME_RECORDS
+  *   TraceRecord_t xRecords[ucCount]
+  *
+  *   uint8_t  ucSync       traceSYNC_NAME
+  *   uint8_t  ucLength
+  *   uint32_t ulObject     a task or a registered queue
+  *   char     cName[ucLength]
+  *
+  * A name frame follows the records that first mention a task, or that
+  * register a queue.  Tools/trace_export.py turns a capture into a Perfetto
+  * timeline.  With traceBINARY clear the drain task prints one line per
+  * record instead, as Tools/heapbench_trace.py also reads.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* This header is pulled in from FreeRTOSConfig.h, so it must only depend on
+   standard types. */
+#include <stdint.h>
+
+#ifndef configUSE_TRACE_RECORDER
+#define configUSE_TRACE_RECORDER    0
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+  * @brief  One trace record.  ucEvent is written last and cleared by the
+  *         reader, so a zero event marks a slot that is free or still being
+  *         filled in.
+  */
+typedef struct
+{
+  uint32_t ulTimestamp;   /*!< DWT cycle count when the event was recorded. */
+  uint32_t ulArg0;        /*!< Event specific, typically an address.        */
+  uint16_t usArg1;        /*!< Event specific, typically a size.            */
+  uint8_t  ucEvent;       /*!< One of the traceEVT_* codes.                 */
+  uint8_t  ucReserved;
+} TraceRecord_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Event codes, with what ulArg0 and usArg1 hold.  Zero is reserved to mark
+   an empty slot.  Events without a task argument belong to the task running
+   at the time, or to an interrupt for the ..._FROM_ISR ones. */
+#define traceEVT_MALLOC             1U    /* Block, or NULL; block size.     */
+#define traceEVT_FREE               2U    /* Block; block size.              */
+#define traceEVT_TASK_CREATE        3U    /* Task; priority.                 */
+#define traceEVT_TASK_DELETE        4U    /* Task; priority.                 */
+#define traceEVT_TASK_DELETE_TCB    5U    /* Task; priority.                 */
+#define traceEVT_TASK_SWITCHED_IN   6U    /* Task; priority.                 */
+#define traceEVT_TASK_READY         7U    /* Task; priority.                 */
+#define traceEVT_TASK_DELAY         8U    /* Ticks.                          */
+#define traceEVT_TASK_DELAY_UNTIL   9U    /* Tick to wake on.                */
+#define traceEVT_TASK_SUSPEND       10U   /* Task.                           */
+#define traceEVT_TASK_RESUME        11U   /* Task.                           */
+#define traceEVT_TASK_RESUME_FROM_ISR 12U /* Task.                           */
+#define traceEVT_TASK_PRIORITY_SET  13U   /* Task; new priority.             */
+#define traceEVT_TASK_PRIORITY_INHERIT 14U /* Mutex holder; priority.        */
+#define traceEVT_TASK_PRIORITY_DISINHERIT 15U /* Task; priority.             */
+#define traceEVT_QUEUE_CREATE       16U   /* Queue; length.                  */
+#define traceEVT_QUEUE_DELETE       17U   /* Queue.                          */
+#define traceEVT_QUEUE_REGISTRY_ADD 18U   /* Queue.                          */
+#define traceEVT_QUEUE_SEND         19U   /* Queue; items before the call.   */
+#define traceEVT_QUEUE_SEND_FAILED  20U   /* Queue; items.                   */
+#define traceEVT_QUEUE_RECEIVE      21U   /* Queue; items before the call.   */
+#define traceEVT_QUEUE_RECEIVE_FAILED 22U /* Queue; items.                   */
+#define traceEVT_QUEUE_PEEK         23U   /* Queue; items.                   */
+#define traceEVT_QUEUE_SEND_FROM_ISR 24U  /* Queue; items before the call.   */
+#define traceEVT_QUEUE_RECEIVE_FROM_ISR 25U /* Queue; items before the call. */
+#define traceEVT_BLOCKING_ON_QUEUE_SEND 26U /* Queue.                        */
+#define traceEVT_BLOCKING_ON_QUEUE_RECEIVE 27U /* Queue.                     */
+#define traceEVT_BLOCKING_ON_QUEUE_PEEK 28U /* Queue.                        */
+#define traceEVT_TASK_NOTIFY        29U   /* Task notified; index.           */
+#define traceEVT_TASK_NOTIFY_FROM_ISR 30U /* Task notified; index.           */
+#define traceEVT_TASK_NOTIFY_GIVE_FROM_ISR 31U /* Task notified; index.      */
+#define traceEVT_TASK_NOTIFY_TAKE_BLOCK 32U /* Ticks to wait; index.         */
+#define traceEVT_TASK_NOTIFY_WAIT_BLOCK 33U /* Ticks to wait; index.         */
+#define traceEVT_DROPPED            34U   /* Records dropped since boot.     */
+#define traceEVT_CLOCK              35U   /* SystemCoreClock, in Hz.         */
+
+/* First byte of each frame type; never a text byte, nor binlogSYNC. */
+#define traceSYNC_RECORDS           0xB2U
+#define traceSYNC_NAME              0xB3U
+
+/* 1 to record the scheduler, queue and notification hooks as well as the
+   allocator and task lifetime ones. */
+#ifndef traceKERNEL_EVENTS
+#define traceKERNEL_EVENTS          1
+#endif
+
+/* 1 to send binary frames, 0 to print each record as a line of text. */
+#ifndef traceBINARY
+#define traceBINARY                 1
+#endif
+
+/* Number of records in the ring, must be a power of two.  A context switch
+   costs two or three records, so the ring needs to hold a drain period's
+   worth. */
+#ifndef traceRING_LENGTH
+#define traceRING_LENGTH            256U
+#endif
+
+/* Most records in one frame. */
+#ifndef traceFRAME_RECORDS
+#define traceFRAME_RECORDS          16U
+#endif
+
+/* Tasks the drain task remembers having named; a task it has forgotten is
+   named again. */
+#ifndef traceNAME_CACHE
+#define traceNAME_CACHE             32U
+#endif
+
+/* 1 to record from boot, 0 to wait for vTraceStart(). */
+#ifndef traceSTART_ENABLED
+#define traceSTART_ENABLED          1U
+#endif
+
+/* How often the drain task empties the ring. */
+#ifndef traceDRAIN_PERIOD_MS
+#define traceDRAIN_PERIOD_MS        10U
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vTraceInit(void);
+void vTraceRecord(uint8_t ucEvent, uint32_t ulArg0, uint16_t usArg1);
+void vTraceStart(void);
+void vTraceStop(void);
+uint32_t ulTraceGetDropped(void);
+
+/* Kernel hooks --------------------------------------------------------------*/
+#if (configUSE_TRACE_RECORDER == 1)
+
+#define traceMALLOC(pvAddress, uiSize) \
+  vTraceRecord(traceEVT_MALLOC, (uint32_t) (pvAddress), (uint16_t) (uiSize))
+
+#define traceFREE(pvAddress, uiSize) \
+  vTraceRecord(traceEVT_FREE, (uint32_t) (pvAddress), (uint16_t) (uiSize))
+
+/* These expand inside tasks.c, where the TCB layout is visible. */
+#define traceTASK_CREATE(pxNewTCB) \
+  vTraceRecord(traceEVT_TASK_CREATE, (uint32_t) (pxNewTCB), (uint16_t) (pxNewTCB)->uxPriority)
+
+#define traceTASK_DELETE(pxTaskToDelete) \
+  vTraceRecord(traceEVT_TASK_DELETE, (uint32_t) (pxTaskToDelete), (uint16_t) (pxTaskToDelete)->uxPriority)
+
+#define traceTASK_DELETE_TCB(pxTCB) \
+  vTraceRecord(traceEVT_TASK_DELETE_TCB, (uint32_t) (pxTCB), (uint16_t) (pxTCB)->uxPriority)
+
+#if (traceKERNEL_EVENTS == 1)
+
+/* Also in tasks.c.  The 10.2 notify hooks take no arguments, so these use
+   the locals of the functions they expand in. */
+#define traceTASK_SWITCHED_IN() \
+  vTraceRecord(traceEVT_TASK_SWITCHED_IN, (uint32_t) pxCurrentTCB, (uint16_t) pxCurrentTCB->uxPriority)
+
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB) \
+  vTraceRecord(traceEVT_TASK_READY, (uint32_t) (pxTCB), (uint16_t) (pxTCB)->uxPriority)
+
+#define traceTASK_DELAY() \
+  vTraceRecord(traceEVT_TASK_DELAY, (uint32_t) xTicksToDelay, 0U)
+
+#define traceTASK_DELAY_UNTIL(xTimeToWake) \
+  vTraceRecord(traceEVT_TASK_DELAY_UNTIL, (uint32_t) (xTimeToWake), 0U)
+
+#define traceTASK_SUSPEND(pxTCB) \
+  vTraceRecord(traceEVT_TASK_SUSPEND, (uint32_t) (pxTCB), 0U)
+
+#define traceTASK_RESUME(pxTCB) \
+  vTraceRecord(traceEVT_TASK_RESUME, (uint32_t) (pxTCB), 0U)
+
+#define traceTASK_RESUME_FROM_ISR(pxTCB) \
+  vTraceRecord(traceEVT_TASK_RESUME_FROM_ISR, (uint32_t) (pxTCB), 0U)
+
+#define traceTASK_PRIORITY_SET(pxTask, uxNewPriority) \
+  vTraceRecord(traceEVT_TASK_PRIORITY_SET, (uint32_t) (pxTask), (uint16_t) (uxNewPriority))
+
+#define traceTASK_PRIORITY_INHERIT(pxTCBOfMutexHolder, uxInheritedPriority) \
+  vTraceRecord(traceEVT_TASK_PRIORITY_INHERIT, (uint32_t) (pxTCBOfMutexHolder), (uint16_t) (uxInheritedPriority))
+
+#define traceTASK_PRIORITY_DISINHERIT(pxTCBOfMutexHolder, uxOriginalPriority) \
+  vTraceRecord(traceEVT_TASK_PRIORITY_DISINHERIT, (uint32_t) (pxTCBOfMutexHolder), (uint16_t) (uxOriginalPriority))
+
+#define traceTASK_NOTIFY() \
+  vTraceRecord(traceEVT_TASK_NOTIFY, (uint32_t) pxTCB, (uint16_t) uxIndexToNotify)
+
+#define traceTASK_NOTIFY_FROM_ISR() \
+  vTraceRecord(traceEVT_TASK_NOTIFY_FROM_ISR, (uint32_t) pxTCB, (uint16_t) uxIndexToNotify)
+
+#define traceTASK_NOTIFY_GIVE_FROM_ISR() \
+  vTraceRecord(traceEVT_TASK_NOTIFY_GIVE_FROM_ISR, (uint32_t) pxTCB, (uint16_t) uxIndexToNotify)
+
+#define traceTASK_NOTIFY_TAKE_BLOCK() \
+  vTraceRecord(traceEVT_TASK_NOTIFY_TAKE_BLOCK, (uint32_t) xTicksToWait, (uint16_t) uxIndexToWait)
+
+#define traceTASK_NOTIFY_WAIT_BLOCK() \
+  vTraceRecord(traceEVT_TASK_NOTIFY_WAIT_BLOCK, (uint32_t) xTicksToWait, (uint16_t) uxIndexToWait)
+
+/* These expand inside queue.c, where the queue layout is visible. */
+#define traceQUEUE_CREATE(pxNewQueue) \
+  vTraceRecord(traceEVT_QUEUE_CREATE, (uint32_t) (pxNewQueue), (uint16_t) (pxNewQueue)->uxLength)
+
+#define traceQUEUE_DELETE(pxQueue) \
+  vTraceRecord(traceEVT_QUEUE_DELETE, (uint32_t) (pxQueue), 0U)
+
+#define traceQUEUE_REGISTRY_ADD(xQueue, pcQueueName) \
+  vTraceRecord(traceEVT_QUEUE_REGISTRY_ADD, (uint32_t) (xQueue), 0U)
+
+#define traceQUEUE_SEND(pxQueue) \
+  vTraceRecord(traceEVT_QUEUE_SEND, (uint32_t) (pxQueue), (uint16_t) (pxQueue)->uxMessagesWaiting)
+
+#define traceQUEUE_SEND_FAILED(pxQueue) \
+  vTraceRecord(traceEVT_QUEUE_SEND_FAILED, (uint32_t) (pxQueue), (uint16_t) (pxQueue)->uxMessagesWaiting)
+
+#define traceQUEUE_RECEIVE(pxQueue) \
+  vTraceRecord(traceEVT_QUEUE_RECEIVE, (uint32_t) (pxQueue), (uint16_t) (pxQueue)->uxMessagesWaiting)
+
+#define traceQUEUE_RECEIVE_FAILED(pxQueue) \
+  vTraceRecord(traceEVT_QUEUE_RECEIVE_FAILED, (uint32_t) (pxQueue), (uint16_t) (pxQueue)->uxMessagesWaiting)
+
+#define traceQUEUE_PEEK(pxQueue) \
+  vTraceRecord(traceEVT_QUEUE_PEEK, (uint32_t) (pxQueue), (uint16_t) (pxQueue)->uxMessagesWaiting)
+
+#define traceQUEUE_SEND_FROM_ISR(pxQueue) \
+  vTraceRecord(traceEVT_QUEUE_SEND_FROM_ISR, (uint32_t) (pxQueue), (uint16_t) (pxQueue)->uxMessagesWaiting)
+
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue) \
+  vTraceRecord(traceEVT_QUEUE_RECEIVE_FROM_ISR, (uint32_t) (pxQueue), (uint16_t) (pxQueue)->uxMessagesWaiting)
+
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue) \
+  vTraceRecord(traceEVT_BLOCKING_ON_QUEUE_SEND, (uint32_t) (pxQueue), 0U)
+
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) \
+  vTraceRecord(traceEVT_BLOCKING_ON_QUEUE_RECEIVE, (uint32_t) (pxQueue), 0U)
+
+#define traceBLOCKING_ON_QUEUE_PEEK(pxQueue) \
+  vTraceRecord(traceEVT_BLOCKING_ON_QUEUE_PEEK, (uint32_t) (pxQueue), 0U)
+
+#endif /* traceKERNEL_EVENTS */
+
+#endif /* configUSE_TRACE_RECORDER */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TRACE_H */
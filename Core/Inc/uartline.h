@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file           : uartline.h
+  * @brief          : USART2 line settings: baud rates up to PCLK1 / 8, RTS/CTS
+  *                   flow control and switching the rate at run time.
+  ******************************************************************************
+  * MX_USART2_UART_Init() still sets up the USART from Lab4.ioc, at 115200
+  * baud with 16x oversampling and no flow control; vUartLineInit() then
+  * moves it to 8x oversampling, which doubles the fastest rate to PCLK1 / 8,
+  * 5.25 Mbaud on the HSE profiles, and to uartlineBAUD.  The divisor is
+  * worked out here rather than by the HAL and kept to within
+  * uartlineMAX_ERROR_PERMILLE of the rate asked for, at every clock profile
+  * switch too, through vUartLineUpdateClock().
+  *
+  * With uartlineFLOW_CONTROL the USART stops sending while the host holds
+  * CTS (PD3) high and raises RTS (PA1) while a received byte waits to be
+  * read, so the log's DMA runs at the full rate without ever overrunning the
+  * host.  CTS is pulled down, so without a host driving it the line sends.
+  *
+  * A rate that the low power profile's 6.25 MHz PCLK1 cannot carry holds the
+  * HSE profiles, see vClockProfileHseHold(), and switches to the balanced
+  * profile first if the low power one is in force: the clock sets the
+  * ceiling on the rate, and the rate then keeps the clock up.
+  *
+  * The shell's baud command renegotiates the rate: the answer goes out at
+  * the old rate, the line switches once it has, and unless a command line
+  * arrives at the new rate within uartlineCONFIRM_MS the old rate comes
+  * back, so a host that cannot follow does not lose the shell.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __UARTLINE_H
+#define __UARTLINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Rate at boot, and the one to fall back to if a switch of clock profile
+   leaves the rate set unreachable. */
+#ifndef uartlineBAUD
+#define uartlineBAUD                115200UL
+#endif
+
+/* 1 for RTS/CTS on PA1 and PD3. */
+#ifndef uartlineFLOW_CONTROL
+#define uartlineFLOW_CONTROL        1
+#endif
+
+/* Most a divisor may miss the rate by, in thousandths; a receiver samples
+   8x oversampled bits well to about 3%. */
+#ifndef uartlineMAX_ERROR_PERMILLE
+#define uartlineMAX_ERROR_PERMILLE  20U
+#endif
+
+/* How long a rate set with confirmation waits for vUartLineConfirm(). */
+#ifndef uartlineCONFIRM_MS
+#define uartlineCONFIRM_MS          5000U
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vUartLineInit(void);
+BaseType_t xUartLineSetBaud(uint32_t ulBaud, BaseType_t xConfirm);
+void vUartLineConfirm(void);
+uint32_t ulUartLineGetBaud(void);
+uint32_t ulUartLineGetMaxBaud(void);
+void vUartLineUpdateClock(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UARTLINE_H */
@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file           : uartrx.h
+  * @brief          : USART2 receive path: circular DMA into a byte ring,
+  *                   drained at idle line, half and full transfer events.
+  ******************************************************************************
+  * DMA1 Stream5 copies every received byte into a circular buffer with no CPU
+  * involvement.  HAL_UARTEx_ReceiveToIdle_DMA() raises an Rx event when the
+  * line goes idle after a frame, and when the DMA passes the middle or the end
+  * of the buffer, so a frame of any length costs one interrupt unless it is
+  * longer than half the buffer.  Each event moves the new bytes into an SPSC
+  * ring that one task reads.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __UARTRX_H
+#define __UARTRX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Circular DMA buffer.  Half of it must arrive in less time than the Rx event
+   interrupt can be held off; 256 bytes is 2.7 ms at 921600 baud. */
+#ifndef uartrxDMA_SIZE
+#define uartrxDMA_SIZE              512U
+#endif
+
+/* Ring the reader drains, must be a power of two. */
+#ifndef uartrxRING_SIZE
+#define uartrxRING_SIZE             1024U
+#endif
+
+/* How long after the last byte low power mode stays out of STOP, in which the
+   USART receiver does not run. */
+#ifndef uartrxHOLD_MS
+#define uartrxHOLD_MS               100U
+#endif
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vUartRxStart(void);
+size_t xUartRxRead(void *pvBuffer, size_t xMaxLength, TickType_t xTicksToWait);
+size_t xUartRxAcquire(size_t xSkip, uint8_t **ppucData, TickType_t xTicksToWait);
+void vUartRxRelease(size_t xLength);
+uint32_t ulUartRxGetDropped(void);
+uint32_t ulUartRxGetErrors(void);
+BaseType_t xUartRxIsBusy(void);
+void vUartRxEventCallback(UART_HandleTypeDef *huart, uint16_t usPosition);
+void vUartRxErrorCallback(UART_HandleTypeDef *huart);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UARTRX_H */
@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file           : uarttx.h
+  * @brief          : Transmit side of a USART on the LL API: one DMA stream
+  *                   writes DR, and its interrupt reports the end.
+  ******************************************************************************
+  * HAL_UART_Transmit_DMA() takes the handle lock, checks and sets gState,
+  * sets up the stream through HAL_DMA_Start_IT() and its callbacks, and ends
+  * in two interrupts: the stream's transfer complete, which turns on TCIE,
+  * and then the USART's, which calls HAL_UART_TxCpltCallback().  Here a
+  * transfer is three stream register writes, and the stream's transfer
+  * complete interrupt alone ends it, with a function pointer call.
+  *
+  * The USART itself is still set up by HAL_UART_Init(), so baud rate and
+  * frame stay in MX_USART2_UART_Init() and Lab4.ioc, and the HAL receive path
+  * on the same USART is untouched.  vUartTxInit() sets DMAT once and for all,
+  * which only requests transfers while the stream is enabled, and takes the
+  * stream from whatever HAL_DMA_Init() left.  The handle's gState stays
+  * READY, so the HAL never turns on TXEIE or TCIE.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __UARTTX_H
+#define __UARTTX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_ll_dma.h"
+#include "stm32f4xx_ll_usart.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Called from the stream's interrupt once a transfer has ended, with pdTRUE
+   if the stream stopped on an error. */
+typedef void (*UartTxDone_t)(BaseType_t xError);
+
+typedef struct
+{
+  USART_TypeDef *pxUsart;
+  DMA_TypeDef *pxDma;
+  uint32_t ulStream;            /*!< LL_DMA_STREAM_x.                          */
+  uint32_t ulChannel;           /*!< LL_DMA_CHANNEL_x of the USART's TX
+                                     request on that stream.                   */
+  UartTxDone_t pxDone;
+} UartTx_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vUartTxInit(const UartTx_t *pxTx);
+void vUartTxStart(const UartTx_t *pxTx, const void *pvData, uint16_t usLength);
+BaseType_t xUartTxIsBusy(const UartTx_t *pxTx);
+void vUartTxIRQHandler(const UartTx_t *pxTx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UARTTX_H */
@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file           : usbcdc.h
+  * @brief          : USB OTG FS CDC-ACM device, a virtual serial port on CN5
+  *                   and a log sink that uses it in place of USART2.
+  ******************************************************************************
+  * xUsbCdcStart() brings up the full speed core as a device with one CDC-ACM
+  * function, which a host opens as a serial port without a driver of its own.
+  * Log messages go into a ring of usbcdcRING_SIZE bytes, and the bulk IN
+  * endpoint sends the ring straight from there: a transfer covers all the
+  * contiguous bytes pending, up to usbcdcMAX_TRANSFER, and the transmit FIFO
+  * holds eight 64 byte packets, refilled from its half empty interrupt.  The
+  * host can so take up to 19 packets a frame, about 1.2 MB/s, and the CPU
+  * only copies each byte twice, into the ring and into the FIFO.
+  *
+  * Bytes the host sends are read and dropped.  A message that does not fit
+  * in the ring is dropped whole, before it is configured too, and counted.
+  *
+  * The core needs PLLQ at 48 MHz, so xUsbCdcStart() holds the HSE profiles.
+  * A switch between the two stops PLLQ for the PLL lock time, about 100 us,
+  * and the host retries the transactions that went unanswered.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBCDC_H
+#define __USBCDC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "log.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* 1 to send the log over USB from boot, 0 to keep it on USART2. */
+#ifndef usbcdcLOG_SINK
+#define usbcdcLOG_SINK              0
+#endif
+
+/* Bytes of log held for the host, a power of two. */
+#ifndef usbcdcRING_SIZE
+#define usbcdcRING_SIZE             4096U
+#endif
+
+/* Most bytes in one bulk IN transfer, a multiple of the packet size. */
+#ifndef usbcdcMAX_TRANSFER
+#define usbcdcMAX_TRANSFER          1024U
+#endif
+
+/* Full speed bulk packet size. */
+#define usbcdcPACKET_SIZE           64U
+
+/* Exported variables --------------------------------------------------------*/
+extern const LogSink_t xUsbCdcLogSink;
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xUsbCdcStart(void);
+size_t xUsbCdcWrite(const void *pvData, size_t xLength);
+BaseType_t xUsbCdcIsConfigured(void);
+uint32_t ulUsbCdcGetDropped(void);
+BaseType_t xUsbCdcIsBusy(void);
+void vUsbCdcIRQHandler(void);
+void vUsbCdcWakeupIRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBCDC_H */
@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file           : watchdog.h
+  * @brief          : Independent watchdog fed by a supervisor task only while
+  *                   every registered heartbeat is on time.
+  ******************************************************************************
+  * A task that must keep running registers a heartbeat with a deadline and
+  * calls vWatchdogBeat() more often than that.  The supervisor, at the
+  * highest priority, looks at every heartbeat each watchdogPERIOD_MS and
+  * refreshes the IWDG only if none is late.  A late one is written to the
+  * crash log by name, with how long it has been silent, and the system
+  * panics with crashlogREASON_WATCHDOG at once.  If the supervisor itself is
+  * starved the IWDG resets the core after watchdogTIMEOUT_MS, and the crash
+  * log puts that down to the watchdog from the reset flags.
+  *
+  * The IWDG is started when the supervisor first runs, so the boot, which may
+  * erase flash for the crash log, is not timed, and is frozen while a
+  * debugger halts the core.  It keeps counting in STOP, so the supervisor's
+  * period also bounds how long tickless idle sleeps.
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __WATCHDOG_H
+#define __WATCHDOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+#ifndef watchdogENABLE
+#define watchdogENABLE              1
+#endif
+
+/* IWDG timeout at the nominal 32 kHz LSI; the LSI may run up to 47 kHz, which
+   shortens it by a third. */
+#ifndef watchdogTIMEOUT_MS
+#define watchdogTIMEOUT_MS          2000U
+#endif
+
+/* How often the supervisor checks the heartbeats and feeds the IWDG. */
+#ifndef watchdogPERIOD_MS
+#define watchdogPERIOD_MS           250U
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+  * @brief  One heartbeat.  Owned by the caller, which must keep it alive
+  *         while registered; the fields are private to watchdog.c.
+  */
+typedef struct xWATCHDOG_HEARTBEAT
+{
+  struct xWATCHDOG_HEARTBEAT *pxNext;
+  const char *pcName;
+  TickType_t xDeadline;
+  volatile TickType_t xLastBeat;
+} WatchdogHeartbeat_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vWatchdogRegister(WatchdogHeartbeat_t *pxHeartbeat, const char *pcName, TickType_t xDeadline);
+void vWatchdogUnregister(WatchdogHeartbeat_t *pxHeartbeat);
+void vWatchdogBeat(WatchdogHeartbeat_t *pxHeartbeat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WATCHDOG_H */
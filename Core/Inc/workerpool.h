@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file           : workerpool.h
+  * @brief          : A few worker tasks, created once at boot, that run
+  *                   short jobs from prioritised lanes.
+  ******************************************************************************
+  * Work that would otherwise get a task of its own, only to delete itself
+  * when done, is submitted instead as a function and an argument.  The
+  * workers are static registered tasks and the lanes are static too, so a job
+  * costs no TCB, no stack and no heap, and leaves nothing for the idle task
+  * to clean up.
+  *
+  * A job goes to one of three lanes.  Every worker takes from the high lane
+  * before the normal one and from the normal one before the low one, so a
+  * lane's jobs wait only for higher lanes and for the jobs already running.
+  * Within a lane each worker keeps its own deque: a job submitted from a job
+  * stays with the worker that submitted it, and any other goes to an idle
+  * worker if there is one.  A worker that runs out of work steals from the
+  * others before it sleeps, and a submission wakes at most one worker, so a
+  * burst of jobs from an interrupt does not wake the whole pool.
+  *
+  * Jobs run to completion in whichever worker takes them, at
+  * workerpoolPRIORITY whatever their lane.  A job may block, but holds its
+  * worker while it does; work that waits for long belongs in a task of its
+  * own, and periodic work in a job started with xPeriodicJobStart() (see
+  * periodic.h).
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __WORKERPOOL_H
+#define __WORKERPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*WorkerPoolFunction_t)(void *pvArg);
+
+typedef enum
+{
+  eWorkerPoolLaneHigh = 0,
+  eWorkerPoolLaneNormal,
+  eWorkerPoolLaneLow
+} WorkerPoolLane_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Worker tasks, 1 to 3. */
+#ifndef workerpoolWORKERS
+#define workerpoolWORKERS           2U
+#endif
+
+#define workerpoolLANES             3U
+
+/* Jobs each worker's deque holds in each lane, so a lane holds
+   workerpoolWORKERS times this before submitters have to wait. */
+#ifndef workerpoolDEQUE_LENGTH
+#define workerpoolDEQUE_LENGTH      4U
+#endif
+
+/* Each worker's stack, which every job it runs shares. */
+#ifndef workerpoolSTACK_DEPTH
+#define workerpoolSTACK_DEPTH       192U
+#endif
+#ifndef workerpoolPRIORITY
+#define workerpoolPRIORITY          (tskIDLE_PRIORITY + 1U)
+#endif
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Submit to the normal lane. */
+#define xWorkerPoolSubmit(pxFunction, pvArg, xTicksToWait) \
+  xWorkerPoolSubmitLane(eWorkerPoolLaneNormal, (pxFunction), (pvArg), (xTicksToWait))
+#define xWorkerPoolSubmitFromISR(pxFunction, pvArg, pxHigherPriorityTaskWoken) \
+  xWorkerPoolSubmitLaneFromISR(eWorkerPoolLaneNormal, (pxFunction), (pvArg), (pxHigherPriorityTaskWoken))
+
+/* Exported functions prototypes ---------------------------------------------*/
+BaseType_t xWorkerPoolInit(void);
+BaseType_t xWorkerPoolSubmitLane(WorkerPoolLane_t eLane, WorkerPoolFunction_t pxFunction, void *pvArg,
+                                 TickType_t xTicksToWait);
+BaseType_t xWorkerPoolSubmitLaneFromISR(WorkerPoolLane_t eLane, WorkerPoolFunction_t pxFunction, void *pvArg,
+                                        BaseType_t *pxHigherPriorityTaskWoken);
+UBaseType_t uxWorkerPoolPending(void);
+uint32_t ulWorkerPoolSteals(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WORKERPOOL_H */
@@ -0,0 +1,557 @@
+/**
+  ******************************************************************************
+  * @file           : accel.c
+  * @brief          : LIS3DSH FIFO burst reads over SPI1 by DMA2, triggered by
+  *                   the sensor's MEMS_INT2 line.
+  ******************************************************************************
+  * The LIS3DSH can only signal its FIFO watermark on INT1, which the Discovery
+  * board wires to PE0 and so to EXTI line 0, the user button's.  State machine
+  * 2 is used instead as a sample counter: its timer counts output data periods,
+  * and every accelBURST_SAMPLES of them it pulses INT2, on PE1.  The FIFO runs
+  * in stream mode, so it always holds the latest accelFIFO_DEPTH samples.
+  *
+  * Each read is two SPI1 transactions, both in DMA2 Stream0 (RX) and Stream3
+  * (TX) channel 3 with chip select held low by software:
+  *  - FIFO_SRC, for the number of samples queued;
+  *  - that many samples from OUT_X_L.  With ADD_INC set and the FIFO on, the
+  *    address wraps from OUT_Z_H back to OUT_X_L, so one burst empties it.
+  * The transmitter sends the address byte from DR and then zeros from a
+  * constant without incrementing, and the receiver lands the data one
+  * halfword into the buffer, so the samples are aligned where the reader
+  * finds them.
+  *
+  * The EXTI1 and stream interrupts run at
+  * configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, so they never preempt each
+  * other and critical sections keep the buffer states consistent.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "accel.h"
+#include "irqtable.h"
+#include "dmabuf.h"
+#include "mailbox.h"
+
+#if (accelBURST_SAMPLES == 0U) || (accelBURST_SAMPLES > accelFIFO_DEPTH)
+#error accelBURST_SAMPLES must be 1 to accelFIFO_DEPTH
+#endif
+
+/* Private define ------------------------------------------------------------*/
+
+/* LIS3DSH registers and bits. */
+#define accelREG_WHO_AM_I           0x0FU
+#define accelREG_CTRL_REG4          0x20U
+#define accelREG_CTRL_REG2          0x22U
+#define accelREG_CTRL_REG3          0x23U
+#define accelREG_CTRL_REG6          0x25U
+#define accelREG_OUT_X_L            0x28U
+#define accelREG_FIFO_CTRL          0x2EU
+#define accelREG_FIFO_SRC           0x2FU
+#define accelREG_ST2_1              0x60U
+#define accelREG_TIM1_2_L           0x74U
+#define accelREG_TIM1_2_H           0x75U
+#define accelREG_READ               0x80U
+
+#define accelWHO_AM_I_VALUE         0x3FU
+#define accelCTRL_REG4_XYZ          0x07U
+#define accelCTRL_REG2_SM2_PIN      0x08U  /* State machine 2 signals on INT2. */
+#define accelCTRL_REG2_SM2_EN       0x01U
+#define accelCTRL_REG3_IEA          0x40U  /* Active high. */
+#define accelCTRL_REG3_IEL          0x20U  /* Pulsed, so each burst is an edge. */
+#define accelCTRL_REG3_INT2_EN      0x10U
+#define accelCTRL_REG6_FIFO_EN      0x40U
+#define accelCTRL_REG6_ADD_INC      0x10U
+#define accelFIFO_CTRL_STREAM       0x40U
+#define accelFIFO_SRC_OVRN          0x40U
+#define accelFIFO_SRC_EMPTY         0x20U
+#define accelFIFO_SRC_FSS           0x1FU
+
+/* State machine 2: wait for timer 1 with no reset condition, then raise the
+   interrupt and go back to the start. */
+#define accelSM_NOP_TI1             0x01U
+#define accelSM_CONT                0x11U
+
+#define accelSAMPLE_BYTES           6U
+
+/* Each buffer starts with the halfword whose second byte takes the address
+   phase, and is padded to keep the next one word aligned. */
+#define accelBUFFER_HALFWORDS       (((1U + (accelFIFO_DEPTH * 3U)) + 1U) & ~1U)
+#define accelBUFFER_COUNT           2U
+#define accelNONE                   0xFFU
+
+#define accelEXTI_LINE              MEMS_INT2_Pin
+#define accelRX_STREAM              DMA2_Stream0
+#define accelTX_STREAM              DMA2_Stream3
+#define accelRX_FLAGS               (DMA_LIFCR_CTCIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTEIF0 | \
+                                     DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0)
+#define accelTX_FLAGS               (DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3 | DMA_LIFCR_CTEIF3 | \
+                                     DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3)
+
+/* Private types -------------------------------------------------------------*/
+typedef enum
+{
+  ACCEL_IDLE = 0,
+  ACCEL_READING_STATUS,
+  ACCEL_READING_SAMPLES
+} AccelState_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Written by DMA2 Stream0 before the CPU reads them. */
+static __attribute__((section(".noinit"))) DMA_BUFFER_DEFINE(uint16_t, usAccelBuffers,
+                                                             accelBUFFER_COUNT * accelBUFFER_HALFWORDS);
+static __attribute__((section(".noinit"))) DMA_BUFFER_DEFINE(uint8_t, ucAccelStatus, 2U);
+
+/* Clocked out after each address byte.  DMA2 reads flash. */
+static const uint8_t ucAccelZero = 0U;
+
+static BaseType_t xReady = pdFALSE;
+static uint32_t ulSpiBaudRate = 0U;
+static TaskHandle_t xReader = NULL;
+
+static volatile AccelState_t eState = ACCEL_IDLE;
+static uint8_t ucFilling = 0U;                  /* Buffer the burst in progress writes. */
+static volatile uint8_t ucPublished = accelNONE; /* Buffer offered to, or held by, the reader. */
+static volatile uint8_t ucWaiting = accelNONE;   /* Full buffer queued behind it. */
+static uint8_t ucSamples[accelBUFFER_COUNT];
+static BaseType_t xDeferred = pdFALSE;          /* An interrupt found no buffer free. */
+
+/* Newest sample of each burst, for readers that want nothing older. */
+mailboxDEFINE(ACCEL_LATEST, AccelSample_t);
+
+static volatile uint32_t ulOverruns = 0U;
+static volatile uint32_t ulErrors = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvBurstStart(void);
+static void prvTransfer(uint8_t ucAddress, uint8_t *pucReceive, uint16_t usLength);
+static void prvTransferEnd(void);
+static void prvPublish(BaseType_t *pxHigherPriorityTaskWoken);
+static void prvWriteRegister(uint8_t ucRegister, uint8_t ucValue);
+static uint8_t prvReadRegister(uint8_t ucRegister);
+static uint8_t prvExchange(uint8_t ucByte);
+static AccelSample_t *prvSamplesOf(uint8_t ucBuffer);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Set up SPI1 and DMA2, configure the sensor and start sampling.
+  *         Call once, after vPinmuxInit(), which hands PA5 to PA7 to SPI1.
+  * @retval pdPASS, or pdFAIL if no LIS3DSH answers.
+  */
+BaseType_t xAccelStart(void)
+{
+  __HAL_RCC_SPI1_CLK_ENABLE();
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  HAL_GPIO_WritePin(CS_I2C_SPI_GPIO_Port, CS_I2C_SPI_Pin, GPIO_PIN_SET);
+  xReady = pdTRUE;
+  vAccelUpdateClock();
+
+  if (prvReadRegister(accelREG_WHO_AM_I) != accelWHO_AM_I_VALUE)
+  {
+    xReady = pdFALSE;
+    return pdFAIL;
+  }
+
+  /* FIFO in stream mode, with the address wrapping inside the output
+     registers. */
+  prvWriteRegister(accelREG_CTRL_REG6, accelCTRL_REG6_FIFO_EN | accelCTRL_REG6_ADD_INC);
+  prvWriteRegister(accelREG_FIFO_CTRL, accelFIFO_CTRL_STREAM | (uint8_t) (accelBURST_SAMPLES - 1U));
+
+  /* State machine 2 as a sample counter on INT2. */
+  prvWriteRegister(accelREG_TIM1_2_L, (uint8_t) accelBURST_SAMPLES);
+  prvWriteRegister(accelREG_TIM1_2_H, 0U);
+  prvWriteRegister(accelREG_ST2_1, accelSM_NOP_TI1);
+  prvWriteRegister(accelREG_ST2_1 + 1U, accelSM_CONT);
+  prvWriteRegister(accelREG_CTRL_REG3, accelCTRL_REG3_IEA | accelCTRL_REG3_IEL | accelCTRL_REG3_INT2_EN);
+  prvWriteRegister(accelREG_CTRL_REG2, accelCTRL_REG2_SM2_PIN | accelCTRL_REG2_SM2_EN);
+
+  accelRX_STREAM->PAR = (uint32_t) &SPI1->DR;
+  accelTX_STREAM->PAR = (uint32_t) &SPI1->DR;
+  irqtableREQUIRE_KERNEL(DMA2_Stream0);
+  HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, irqtablePRIORITY(DMA2_Stream0), 0U);
+  HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+  /* vPinmuxInit() armed the rising edge; drop any seen before now. */
+  EXTI->PR = accelEXTI_LINE;
+  irqtableREQUIRE_KERNEL(EXTI1);
+  HAL_NVIC_SetPriority(EXTI1_IRQn, irqtablePRIORITY(EXTI1), 0U);
+  HAL_NVIC_EnableIRQ(EXTI1_IRQn);
+
+  /* Sampling starts last, so the first interrupt finds everything ready. */
+  prvWriteRegister(accelREG_CTRL_REG4, (uint8_t) ((accelODR_CODE << 4U) | accelCTRL_REG4_XYZ));
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Take the next buffer of samples, waiting for one if there is none.
+  * @param  ppxSamples   Set to the samples, oldest first.  They stay valid
+  *                      until vAccelRelease().
+  * @param  xTicksToWait How long to wait.
+  * @note   Only one task may read, and it must release each buffer before
+  *         asking for the next.
+  * @retval Number of samples, 0 if the wait timed out.
+  */
+size_t xAccelReceive(const AccelSample_t **ppxSamples, TickType_t xTicksToWait)
+{
+  TimeOut_t xTimeOut;
+  size_t xCount = 0U;
+  uint8_t ucBuffer;
+
+  configASSERT(xReader == NULL);
+
+  vTaskSetTimeOutState(&xTimeOut);
+  for (;;)
+  {
+    taskENTER_CRITICAL();
+    {
+      ucBuffer = ucPublished;
+      xReader = (ucBuffer == accelNONE) ? xTaskGetCurrentTaskHandle() : NULL;
+    }
+    taskEXIT_CRITICAL();
+
+    if ((ucBuffer != accelNONE) || (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE))
+    {
+      break;
+    }
+
+    (void) ulTaskNotifyTake(pdTRUE, xTicksToWait);
+  }
+
+  xReader = NULL;
+
+  if (ucBuffer != accelNONE)
+  {
+    *ppxSamples = prvSamplesOf(ucBuffer);
+    xCount = ucSamples[ucBuffer];
+  }
+
+  return xCount;
+}
+
+/**
+  * @brief  Give back the buffer xAccelReceive() handed out.
+  * @note   The next full buffer, if any, is offered at once, and a read the
+  *         driver had to hold back for want of a buffer starts.
+  * @retval None
+  */
+void vAccelRelease(void)
+{
+  taskENTER_CRITICAL();
+  {
+    configASSERT(ucPublished != accelNONE);
+
+    ucPublished = ucWaiting;
+    ucWaiting = accelNONE;
+
+    if (xDeferred != pdFALSE)
+    {
+      xDeferred = pdFALSE;
+      prvBurstStart();
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Copy out the newest sample, as of the last burst.  Never waits and
+  *         needs no buffer from xAccelReceive().
+  * @note   Only one task may call this.
+  * @retval pdTRUE if a burst has landed since the last call, else pdFALSE:
+  *         the same sample again, or none copied if no burst has landed yet.
+  */
+BaseType_t xAccelGetLatest(AccelSample_t *pxSample)
+{
+  return xMailboxRead(&xACCEL_LATESTMailbox, pxSample);
+}
+
+/**
+  * @brief  Bursts that found the sensor's FIFO had overrun, losing samples
+  *         because the reader held both buffers for too long.
+  * @retval Overrun count since boot.
+  */
+uint32_t ulAccelGetOverruns(void)
+{
+  return ulOverruns;
+}
+
+/**
+  * @brief  DMA transfer errors.
+  * @retval Error count since boot.
+  */
+uint32_t ulAccelGetErrors(void)
+{
+  return ulErrors;
+}
+
+/**
+  * @brief  Whether a burst is in progress.
+  * @note   SPI1 and the DMA stop in STOP mode, so the low power code keeps out
+  *         of STOP while this returns pdTRUE.  The sensor keeps sampling into
+  *         its FIFO and its interrupt wakes the part.
+  * @retval pdTRUE during a burst.
+  */
+BaseType_t xAccelIsBusy(void)
+{
+  return (eState != ACCEL_IDLE) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  Pick the SPI1 baud rate for the current APB2 clock.  Called by
+  *         xClockProfileSet() after every clock change.
+  * @note   The new rate applies from the next transaction.
+  * @retval None
+  */
+void vAccelUpdateClock(void)
+{
+  uint32_t ulPclk2;
+  uint32_t ulDivider = 0U;
+
+  if (xReady == pdFALSE)
+  {
+    return;
+  }
+
+  /* BR n divides PCLK2 by 2^(n+1). */
+  ulPclk2 = HAL_RCC_GetPCLK2Freq();
+  while (((ulPclk2 >> (ulDivider + 1U)) > accelSPI_MAX_HZ) && (ulDivider < 7U))
+  {
+    ulDivider++;
+  }
+
+  ulSpiBaudRate = ulDivider << SPI_CR1_BR_Pos;
+}
+
+/**
+  * @brief  EXTI1 handler body: the sensor has counted off another burst.
+  * @retval None
+  */
+void vAccelExtiIRQHandler(void)
+{
+  EXTI->PR = accelEXTI_LINE;
+  prvBurstStart();
+}
+
+/**
+  * @brief  DMA2 Stream0 handler body: SPI1 received the last byte of a
+  *         transaction.
+  * @retval None
+  */
+void vAccelDmaIRQHandler(void)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  uint32_t ulFlags = DMA2->LISR;
+  uint8_t ucStatus;
+  uint8_t ucCount;
+
+  DMA2->LIFCR = accelRX_FLAGS;
+  DMA2->LIFCR = accelTX_FLAGS;
+  prvTransferEnd();
+
+  if ((ulFlags & (DMA_LISR_TEIF0 | DMA_LISR_DMEIF0)) != 0U)
+  {
+    ulErrors++;
+    eState = ACCEL_IDLE;
+    return;
+  }
+
+  if (eState == ACCEL_READING_STATUS)
+  {
+    ucStatus = ucAccelStatus[1];
+    ucCount = ucStatus & accelFIFO_SRC_FSS;
+    if ((ucStatus & accelFIFO_SRC_OVRN) != 0U)
+    {
+      ulOverruns++;
+      ucCount = (uint8_t) accelFIFO_DEPTH;
+    }
+    else if ((ucStatus & accelFIFO_SRC_EMPTY) != 0U)
+    {
+      ucCount = 0U;
+    }
+
+    if (ucCount == 0U)
+    {
+      eState = ACCEL_IDLE;
+      return;
+    }
+
+    ucSamples[ucFilling] = ucCount;
+    eState = ACCEL_READING_SAMPLES;
+    prvTransfer(accelREG_OUT_X_L,
+                ((uint8_t *) &usAccelBuffers[ucFilling * accelBUFFER_HALFWORDS]) + 1U,
+                (uint16_t) (1U + (ucCount * accelSAMPLE_BYTES)));
+  }
+  else
+  {
+    eState = ACCEL_IDLE;
+    vMailboxWrite(&xACCEL_LATESTMailbox, &prvSamplesOf(ucFilling)[ucSamples[ucFilling] - 1U]);
+    prvPublish(&xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Start reading the FIFO into a free buffer, or note that the
+  *         interrupt came while there was none.
+  * @note   Called from the interrupts or with them masked.
+  * @retval None
+  */
+static void prvBurstStart(void)
+{
+  uint8_t ucBuffer;
+
+  if (eState != ACCEL_IDLE)
+  {
+    return;
+  }
+
+  for (ucBuffer = 0U; ucBuffer < accelBUFFER_COUNT; ucBuffer++)
+  {
+    if ((ucBuffer != ucPublished) && (ucBuffer != ucWaiting))
+    {
+      break;
+    }
+  }
+
+  if (ucBuffer == accelBUFFER_COUNT)
+  {
+    /* The samples stay in the sensor's FIFO until a buffer is released. */
+    xDeferred = pdTRUE;
+    return;
+  }
+
+  ucFilling = ucBuffer;
+  eState = ACCEL_READING_STATUS;
+  prvTransfer(accelREG_FIFO_SRC, ucAccelStatus, 2U);
+}
+
+/**
+  * @brief  Start a read transaction of usLength bytes, the address byte
+  *         included, with the reply landing at pucReceive.
+  * @retval None
+  */
+static void prvTransfer(uint8_t ucAddress, uint8_t *pucReceive, uint16_t usLength)
+{
+  DMA2->LIFCR = accelRX_FLAGS;
+  DMA2->LIFCR = accelTX_FLAGS;
+
+  accelRX_STREAM->M0AR = (uint32_t) pucReceive;
+  accelRX_STREAM->NDTR = usLength;
+  accelRX_STREAM->CR = DMA_CHANNEL_3 | DMA_SxCR_MINC | DMA_SxCR_PL_1 | DMA_SxCR_TCIE |
+                       DMA_SxCR_TEIE | DMA_SxCR_DMEIE;
+  accelRX_STREAM->CR |= DMA_SxCR_EN;
+
+  /* The address goes out from DR, the zeros after it from the stream. */
+  accelTX_STREAM->M0AR = (uint32_t) &ucAccelZero;
+  accelTX_STREAM->NDTR = (uint32_t) usLength - 1U;
+  accelTX_STREAM->CR = DMA_CHANNEL_3 | DMA_SxCR_DIR_0 | DMA_SxCR_PL_1;
+
+  SPI1->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_CPOL | SPI_CR1_CPHA | ulSpiBaudRate;
+  SPI1->CR1 |= SPI_CR1_SPE;
+  SPI1->CR2 = SPI_CR2_RXDMAEN;
+
+  HAL_GPIO_WritePin(CS_I2C_SPI_GPIO_Port, CS_I2C_SPI_Pin, GPIO_PIN_RESET);
+  *(volatile uint8_t *) &SPI1->DR = ucAddress | accelREG_READ;
+
+  accelTX_STREAM->CR |= DMA_SxCR_EN;
+  SPI1->CR2 = SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+}
+
+/**
+  * @brief  Close a transaction whose last byte has been received.
+  * @retval None
+  */
+static void prvTransferEnd(void)
+{
+  /* Receiving the last byte means the clock has stopped. */
+  HAL_GPIO_WritePin(CS_I2C_SPI_GPIO_Port, CS_I2C_SPI_Pin, GPIO_PIN_SET);
+  SPI1->CR2 = 0U;
+  SPI1->CR1 &= ~SPI_CR1_SPE;
+  accelRX_STREAM->CR &= ~DMA_SxCR_EN;
+  accelTX_STREAM->CR &= ~DMA_SxCR_EN;
+}
+
+/**
+  * @brief  Offer the buffer just filled to the reader, or queue it behind the
+  *         one the reader holds.
+  * @retval None
+  */
+static void prvPublish(BaseType_t *pxHigherPriorityTaskWoken)
+{
+  if (ucPublished == accelNONE)
+  {
+    ucPublished = ucFilling;
+
+    if (xReader != NULL)
+    {
+      vTaskNotifyGiveFromISR(xReader, pxHigherPriorityTaskWoken);
+    }
+  }
+  else
+  {
+    ucWaiting = ucFilling;
+  }
+}
+
+/**
+  * @brief  Write one sensor register, polling.  Only used before the
+  *         interrupts are enabled.
+  * @retval None
+  */
+static void prvWriteRegister(uint8_t ucRegister, uint8_t ucValue)
+{
+  HAL_GPIO_WritePin(CS_I2C_SPI_GPIO_Port, CS_I2C_SPI_Pin, GPIO_PIN_RESET);
+  (void) prvExchange(ucRegister);
+  (void) prvExchange(ucValue);
+  HAL_GPIO_WritePin(CS_I2C_SPI_GPIO_Port, CS_I2C_SPI_Pin, GPIO_PIN_SET);
+}
+
+/**
+  * @brief  Read one sensor register, polling.  Only used before the
+  *         interrupts are enabled.
+  * @retval The register value.
+  */
+static uint8_t prvReadRegister(uint8_t ucRegister)
+{
+  uint8_t ucValue;
+
+  HAL_GPIO_WritePin(CS_I2C_SPI_GPIO_Port, CS_I2C_SPI_Pin, GPIO_PIN_RESET);
+  (void) prvExchange(ucRegister | accelREG_READ);
+  ucValue = prvExchange(0U);
+  HAL_GPIO_WritePin(CS_I2C_SPI_GPIO_Port, CS_I2C_SPI_Pin, GPIO_PIN_SET);
+
+  return ucValue;
+}
+
+/**
+  * @brief  Clock one byte out and the reply in.
+  * @retval The byte received.
+  */
+static uint8_t prvExchange(uint8_t ucByte)
+{
+  SPI1->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_CPOL | SPI_CR1_CPHA |
+              ulSpiBaudRate | SPI_CR1_SPE;
+
+  *(volatile uint8_t *) &SPI1->DR = ucByte;
+  while ((SPI1->SR & SPI_SR_RXNE) == 0U)
+  {
+  }
+
+  return *(volatile uint8_t *) &SPI1->DR;
+}
+
+/**
+  * @brief  Where the samples of a buffer start.
+  * @retval Pointer to the first sample.
+  */
+static AccelSample_t *prvSamplesOf(uint8_t ucBuffer)
+{
+  return (AccelSample_t *) &usAccelBuffers[(ucBuffer * accelBUFFER_HALFWORDS) + 1U];
+}
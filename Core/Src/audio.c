@@ -0,0 +1,597 @@
+/**
+  ******************************************************************************
+  * @file           : audio.c
+  * @brief          : CS43L22 playback over I2S3, refilled from a stream buffer
+  *                   by the DMA1 Stream7 half and complete transfer
+  *                   interrupts.
+  ******************************************************************************
+  * The codec is set up once over I2C1 and left powered down.  Playback starts
+  * when the stream buffer holds a whole DMA buffer, so the first two halves go
+  * out complete, and runs until vAudioStop() has played out what was
+  * written.  In between, each interrupt takes the next half from the stream
+  * buffer with xStreamBufferReceiveFromISR(), which also wakes the producer
+  * if it was waiting for room.  A short read is made up with silence, and is
+  * counted as an underrun when the half before it was complete.
+  *
+  * I2S3 is the master and gives the codec MCLK at 256 times the sample rate,
+  * clocked from the PLLI2S, which is held from clockprofile.c while playing.
+  * The governor keeps to the HSE profiles meanwhile, so a clock switch never
+  * stops it under the audio.
+  *
+  * SPI3_TX is on DMA1 Stream5 or Stream7 channel 0; Stream5 receives for
+  * USART2, so this uses Stream7.  There is no I2C or I2S HAL module in the
+  * tree, so both are driven at register level, like SPI1 in accel.c.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "audio.h"
+#include "irqtable.h"
+#include "dmabuf.h"
+#include "timebase.h"
+#include "clockprofile.h"
+
+#if (audioSTREAM_FRAMES < (3U * audioHALF_FRAMES))
+#error audioSTREAM_FRAMES must be at least three halves, so a write can always start playback
+#endif
+
+/* Private define ------------------------------------------------------------*/
+
+/* Fs = I2SCLK / (256 * (2 * DIV + ODD)), with MCLK out and 16 bit frames;
+   the values of RM0090 table 127. */
+#if (audioSAMPLE_RATE_HZ == 48000U)
+#define audioI2SCLK_HZ              86000000UL
+#define audioI2SDIV                 3U
+#define audioI2SODD                 1U
+#elif (audioSAMPLE_RATE_HZ == 44100U)
+#define audioI2SCLK_HZ              135500000UL
+#define audioI2SDIV                 6U
+#define audioI2SODD                 0U
+#else
+#error audioSAMPLE_RATE_HZ must be 48000 or 44100
+#endif
+
+#if (clockI2SCLK_HZ != audioI2SCLK_HZ)
+#error clockI2SCLK_HZ does not suit audioSAMPLE_RATE_HZ
+#endif
+
+/* CS43L22 registers and values. */
+#define audioCODEC_ADDRESS          0x94U
+#define audioREG_ID                 0x01U
+#define audioREG_POWER_CTL1         0x02U
+#define audioREG_POWER_CTL2         0x04U
+#define audioREG_CLOCKING_CTL       0x05U
+#define audioREG_INTERFACE_CTL1     0x06U
+
+#define audioID_MASK                0xF8U
+#define audioID_VALUE               0xE0U
+#define audioPOWER_CTL1_DOWN        0x9FU
+#define audioPOWER_CTL1_UP          0x9EU
+#define audioPOWER_CTL2_HEADPHONE   0xAFU  /* Headphone on, speaker off. */
+#define audioPOWER_CTL2_OFF         0xFFU
+#define audioCLOCKING_AUTO          0x81U  /* Speed from MCLK/LRCK, MCLK / 2. */
+#define audioINTERFACE_I2S          0x04U  /* Slave, I2S, up to 24 bit. */
+
+/* I2C1 standard mode. */
+#define audioI2C_HZ                 100000UL
+#define audioI2C_TIMEOUT_US         2000UL
+
+#define audioHALF_SAMPLES           (audioHALF_FRAMES * audioCHANNELS)
+#define audioHALF_BYTES             (audioHALF_FRAMES * audioFRAME_BYTES)
+#define audioBUFFER_BYTES           (2U * audioHALF_BYTES)
+#define audioSTREAM_BYTES           (audioSTREAM_FRAMES * audioFRAME_BYTES)
+
+#define audioSTREAM                 DMA1_Stream7
+#define audioDMA_FLAGS              (DMA_HIFCR_CTCIF7 | DMA_HIFCR_CHTIF7 | DMA_HIFCR_CTEIF7 | \
+                                     DMA_HIFCR_CDMEIF7 | DMA_HIFCR_CFEIF7)
+
+/* Private types -------------------------------------------------------------*/
+typedef enum
+{
+  AUDIO_STOPPED = 0,
+  AUDIO_PLAYING,
+  AUDIO_FAILED                /* A DMA error stopped the stream. */
+} AudioState_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Read by DMA1 Stream7 while playing. */
+static __attribute__((section(".noinit"))) DMA_BUFFER_DEFINE(int16_t, sAudioBuffer, 2U * audioHALF_SAMPLES);
+
+/* A static stream buffer holds one byte less than it is given, so this one
+   holds a whole number of frames.  Every write and read is whole frames too,
+   so a frame is never split. */
+static uint8_t ucAudioStorage[audioSTREAM_BYTES + 1U];
+static StaticStreamBuffer_t xAudioStreamStruct;
+static StreamBufferHandle_t xAudioStream = NULL;
+
+static volatile AudioState_t eState = AUDIO_STOPPED;
+static BaseType_t xLastHalfFull = pdFALSE;
+static volatile BaseType_t xDraining = pdFALSE;
+static uint8_t ucSilentHalves = 0U;
+static TaskHandle_t xStopper = NULL;
+static BaseType_t xClockHeld = pdFALSE;
+
+static volatile uint32_t ulUnderruns = 0U;
+static volatile uint32_t ulErrors = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvStartIfPrimed(void);
+static void prvPlaybackStart(void);
+static void prvPlaybackStop(void);
+static void prvRefill(uint32_t ulHalf, BaseType_t *pxHigherPriorityTaskWoken);
+static BaseType_t prvCodecWrite(uint8_t ucRegister, uint8_t ucValue);
+static BaseType_t prvCodecRead(uint8_t ucRegister, uint8_t *pucValue);
+static BaseType_t prvI2cStart(uint8_t ucAddress);
+static BaseType_t prvI2cWait(uint32_t ulFlag);
+static BaseType_t prvWaitUntil(volatile uint32_t *pulRegister, uint32_t ulMask, uint32_t ulValue,
+                               uint32_t ulTimeoutUs);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Reset and configure the codec, leaving it powered down, and set up
+  *         the stream buffer and DMA1 Stream7.  Call once, after
+  *         vPinmuxInit(), which hands the I2C1 and I2S3 pins over.
+  * @retval pdPASS, or pdFAIL if no CS43L22 answers.
+  */
+BaseType_t xAudioInit(void)
+{
+  uint8_t ucId = 0U;
+
+  __HAL_RCC_I2C1_CLK_ENABLE();
+  __HAL_RCC_SPI3_CLK_ENABLE();
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* The pin table held the reset low since vPinmuxInit(), over the 1 ms the
+     codec needs. */
+  HAL_GPIO_WritePin(Audio_RST_GPIO_Port, Audio_RST_Pin, GPIO_PIN_SET);
+
+  if ((prvCodecRead(audioREG_ID, &ucId) != pdPASS) || ((ucId & audioID_MASK) != audioID_VALUE))
+  {
+    HAL_GPIO_WritePin(Audio_RST_GPIO_Port, Audio_RST_Pin, GPIO_PIN_RESET);
+    return pdFAIL;
+  }
+
+  /* The settings the datasheet requires after reset, then the interface. */
+  (void) prvCodecWrite(0x00U, 0x99U);
+  (void) prvCodecWrite(0x47U, 0x80U);
+  (void) prvCodecWrite(0x32U, 0x80U);
+  (void) prvCodecWrite(0x32U, 0x00U);
+  (void) prvCodecWrite(0x00U, 0x00U);
+  (void) prvCodecWrite(audioREG_POWER_CTL1, audioPOWER_CTL1_DOWN);
+  (void) prvCodecWrite(audioREG_POWER_CTL2, audioPOWER_CTL2_HEADPHONE);
+  (void) prvCodecWrite(audioREG_CLOCKING_CTL, audioCLOCKING_AUTO);
+  (void) prvCodecWrite(audioREG_INTERFACE_CTL1, audioINTERFACE_I2S);
+
+  xAudioStream = xStreamBufferCreateStatic(sizeof(ucAudioStorage), audioFRAME_BYTES,
+                                           ucAudioStorage, &xAudioStreamStruct);
+  configASSERT(xAudioStream != NULL);
+
+  audioSTREAM->PAR = (uint32_t) &SPI3->DR;
+  irqtableREQUIRE_KERNEL(DMA1_Stream7);
+  HAL_NVIC_SetPriority(DMA1_Stream7_IRQn, irqtablePRIORITY(DMA1_Stream7), 0U);
+  HAL_NVIC_EnableIRQ(DMA1_Stream7_IRQn);
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Queue frames for playback, starting it once a whole DMA buffer is
+  *         queued.
+  * @param  psFrames     Interleaved left and right samples.
+  * @param  xFrames      Number of frames, pairs of samples.
+  * @param  xTicksToWait How long to wait, in all, for room.
+  * @note   Only one task may write.
+  * @retval Frames queued, fewer than xFrames if the wait timed out.
+  */
+size_t xAudioWrite(const int16_t *psFrames, size_t xFrames, TickType_t xTicksToWait)
+{
+  const uint8_t *pucBytes = (const uint8_t *) psFrames;
+  size_t xBytes = xFrames * audioFRAME_BYTES;
+  size_t xSent = 0U;
+  size_t xChunk;
+  size_t xDone;
+  TimeOut_t xTimeOut;
+  BaseType_t xTimedOut;
+
+  configASSERT(xAudioStream != NULL);
+
+  /* A half at a time, as a stream buffer send only waits for room for all
+     of it at once.  Until playback starts, there is always room for a half,
+     so this cannot wait on a buffer nothing is draining. */
+  vTaskSetTimeOutState(&xTimeOut);
+  while (xSent < xBytes)
+  {
+    prvStartIfPrimed();
+
+    xChunk = configMIN(xBytes - xSent, (size_t) audioHALF_BYTES);
+    xDone = xStreamBufferSend(xAudioStream, &pucBytes[xSent], xChunk, xTicksToWait);
+    xSent += xDone;
+
+    xTimedOut = xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait);
+    if ((xDone < xChunk) && (xTimedOut != pdFALSE))
+    {
+      break;
+    }
+  }
+
+  prvStartIfPrimed();
+
+  return xSent / audioFRAME_BYTES;
+}
+
+/**
+  * @brief  Play out everything written so far, then power the codec down and
+  *         stop I2S3 and let the PLLI2S go.
+  * @note   Called by the writer.  Blocks for up to audioLATENCY_US.
+  * @retval None
+  */
+void vAudioStop(void)
+{
+  configASSERT(xAudioStream != NULL);
+
+  /* Less than a buffer never started playing. */
+  if ((eState != AUDIO_PLAYING) && (xStreamBufferBytesAvailable(xAudioStream) != 0U))
+  {
+    prvPlaybackStart();
+  }
+
+  if (eState == AUDIO_PLAYING)
+  {
+    taskENTER_CRITICAL();
+    {
+      (void) xTaskNotifyStateClear(NULL);
+      xStopper = xTaskGetCurrentTaskHandle();
+      ucSilentHalves = 0U;
+      xDraining = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+
+    /* Two ticks over, for the tick boundaries either side. */
+    (void) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(audioLATENCY_US / 1000U) + 2U);
+
+    xStopper = NULL;
+  }
+
+  prvPlaybackStop();
+  xDraining = pdFALSE;
+}
+
+/**
+  * @brief  Halves that came up short of frames after a complete one, each an
+  *         audible gap because the writer fell behind.
+  * @retval Underrun count since boot.
+  */
+uint32_t ulAudioGetUnderruns(void)
+{
+  return ulUnderruns;
+}
+
+/**
+  * @brief  DMA transfer errors and PLLI2S lock failures, each of which stops
+  *         playback until the next write.
+  * @retval Error count since boot.
+  */
+uint32_t ulAudioGetErrors(void)
+{
+  return ulErrors;
+}
+
+/**
+  * @brief  Whether audio is playing.
+  * @note   I2S3 and the DMA stop in STOP mode, so the low power code keeps
+  *         out of STOP while this returns pdTRUE.
+  * @retval pdTRUE while playing.
+  */
+BaseType_t xAudioIsBusy(void)
+{
+  return (eState == AUDIO_PLAYING) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  DMA1 Stream7 handler body: the DMA has moved on from one half of
+  *         the buffer to the other.
+  * @retval None
+  */
+void vAudioDmaIRQHandler(void)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  uint32_t ulFlags = DMA1->HISR;
+
+  DMA1->HIFCR = audioDMA_FLAGS;
+
+  if ((ulFlags & (DMA_HISR_TEIF7 | DMA_HISR_DMEIF7)) != 0U)
+  {
+    ulErrors++;
+    audioSTREAM->CR &= ~DMA_SxCR_EN;
+    SPI3->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+    eState = AUDIO_FAILED;
+
+    if (xStopper != NULL)
+    {
+      vTaskNotifyGiveFromISR(xStopper, &xHigherPriorityTaskWoken);
+    }
+  }
+  else
+  {
+    /* Both flags together mean this interrupt was held off for a whole
+       half; the first half is then the one further from the DMA. */
+    if ((ulFlags & DMA_HISR_HTIF7) != 0U)
+    {
+      prvRefill(0U, &xHigherPriorityTaskWoken);
+    }
+    if ((ulFlags & DMA_HISR_TCIF7) != 0U)
+    {
+      prvRefill(1U, &xHigherPriorityTaskWoken);
+    }
+  }
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Start playback if it is stopped and a whole DMA buffer is queued.
+  * @retval None
+  */
+static void prvStartIfPrimed(void)
+{
+  if ((eState != AUDIO_PLAYING) && (xStreamBufferBytesAvailable(xAudioStream) >= audioBUFFER_BYTES))
+  {
+    prvPlaybackStart();
+  }
+}
+
+/**
+  * @brief  Fill both halves from the stream buffer, start the DMA and I2S3
+  *         and power the codec up.
+  * @retval None
+  */
+static void prvPlaybackStart(void)
+{
+  uint8_t *pucBuffer = (uint8_t *) sAudioBuffer;
+  size_t xPrimed;
+
+  if ((xClockHeld == pdFALSE) && (xClockProfileI2SAcquire() != pdPASS))
+  {
+    ulErrors++;
+    return;
+  }
+  xClockHeld = pdTRUE;
+
+  /* The interrupt is not running yet, so the writer may read this once. */
+  xPrimed = xStreamBufferReceive(xAudioStream, pucBuffer, audioBUFFER_BYTES, 0U);
+  (void) memset(&pucBuffer[xPrimed], 0, audioBUFFER_BYTES - xPrimed);
+  xLastHalfFull = (xPrimed == audioBUFFER_BYTES) ? pdTRUE : pdFALSE;
+
+  audioSTREAM->CR &= ~DMA_SxCR_EN;
+  (void) prvWaitUntil(&audioSTREAM->CR, DMA_SxCR_EN, 0U, audioI2C_TIMEOUT_US);
+  DMA1->HIFCR = audioDMA_FLAGS;
+  audioSTREAM->M0AR = (uint32_t) sAudioBuffer;
+  audioSTREAM->NDTR = 2U * audioHALF_SAMPLES;
+  audioSTREAM->CR = DMA_CHANNEL_0 | DMA_SxCR_DIR_0 | DMA_SxCR_MINC | DMA_SxCR_PSIZE_0 |
+                    DMA_SxCR_MSIZE_0 | DMA_SxCR_CIRC | DMA_SxCR_PL | DMA_SxCR_HTIE |
+                    DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE;
+  eState = AUDIO_PLAYING;
+  audioSTREAM->CR |= DMA_SxCR_EN;
+
+  /* Master transmit, Philips, 16 bit data in 16 bit channels. */
+  SPI3->I2SCFGR = SPI_I2SCFGR_I2SMOD | SPI_I2SCFGR_I2SCFG_1;
+  SPI3->I2SPR = SPI_I2SPR_MCKOE | (audioI2SODD << SPI_I2SPR_ODD_Pos) | audioI2SDIV;
+  SPI3->CR2 = SPI_CR2_TXDMAEN;
+  SPI3->I2SCFGR |= SPI_I2SCFGR_I2SE;
+
+  /* The codec powers up onto running clocks. */
+  (void) prvCodecWrite(audioREG_POWER_CTL2, audioPOWER_CTL2_HEADPHONE);
+  (void) prvCodecWrite(audioREG_POWER_CTL1, audioPOWER_CTL1_UP);
+}
+
+/**
+  * @brief  Power the codec down, stop I2S3 and the DMA and let the PLLI2S
+  *         go.
+  * @retval None
+  */
+static void prvPlaybackStop(void)
+{
+  /* Outputs off first, against a click. */
+  (void) prvCodecWrite(audioREG_POWER_CTL2, audioPOWER_CTL2_OFF);
+  (void) prvCodecWrite(audioREG_POWER_CTL1, audioPOWER_CTL1_DOWN);
+
+  /* RM0090 has the last frame go out before I2SE is cleared. */
+  (void) prvWaitUntil(&SPI3->SR, SPI_SR_TXE | SPI_SR_BSY, SPI_SR_TXE, audioI2C_TIMEOUT_US);
+  SPI3->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+  SPI3->CR2 = 0U;
+  audioSTREAM->CR &= ~DMA_SxCR_EN;
+  eState = AUDIO_STOPPED;
+
+  if (xClockHeld != pdFALSE)
+  {
+    vClockProfileI2SRelease();
+    xClockHeld = pdFALSE;
+  }
+}
+
+/**
+  * @brief  Refill the half the DMA has just finished with the next frames, or
+  *         with silence when there are none.
+  * @param  ulHalf Half to refill, 0 or 1.
+  * @retval None
+  */
+static void prvRefill(uint32_t ulHalf, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  uint8_t *pucHalf = (uint8_t *) &sAudioBuffer[ulHalf * audioHALF_SAMPLES];
+  size_t xReceived;
+
+  xReceived = xStreamBufferReceiveFromISR(xAudioStream, pucHalf, audioHALF_BYTES, pxHigherPriorityTaskWoken);
+  if (xReceived < audioHALF_BYTES)
+  {
+    (void) memset(&pucHalf[xReceived], 0, audioHALF_BYTES - xReceived);
+
+    if ((xLastHalfFull != pdFALSE) && (xDraining == pdFALSE))
+    {
+      ulUnderruns++;
+    }
+  }
+  xLastHalfFull = (xReceived == audioHALF_BYTES) ? pdTRUE : pdFALSE;
+
+  /* Once both halves have been refilled with nothing, the last frame
+     written has been played. */
+  if (xDraining != pdFALSE)
+  {
+    ucSilentHalves = (xReceived == 0U) ? (uint8_t) (ucSilentHalves + 1U) : 0U;
+    if ((ucSilentHalves == 2U) && (xStopper != NULL))
+    {
+      vTaskNotifyGiveFromISR(xStopper, pxHigherPriorityTaskWoken);
+    }
+  }
+}
+
+/**
+  * @brief  Write one codec register, polling.
+  * @retval pdPASS, or pdFAIL if the codec did not acknowledge.
+  */
+static BaseType_t prvCodecWrite(uint8_t ucRegister, uint8_t ucValue)
+{
+  BaseType_t xResult = prvI2cStart(audioCODEC_ADDRESS);
+
+  if (xResult == pdPASS)
+  {
+    I2C1->DR = ucRegister;
+    xResult = prvI2cWait(I2C_SR1_TXE);
+  }
+  if (xResult == pdPASS)
+  {
+    I2C1->DR = ucValue;
+    xResult = prvI2cWait(I2C_SR1_BTF);
+  }
+
+  I2C1->CR1 |= I2C_CR1_STOP;
+
+  return xResult;
+}
+
+/**
+  * @brief  Read one codec register, polling.
+  * @retval pdPASS, or pdFAIL if the codec did not acknowledge.
+  */
+static BaseType_t prvCodecRead(uint8_t ucRegister, uint8_t *pucValue)
+{
+  BaseType_t xResult = prvI2cStart(audioCODEC_ADDRESS);
+
+  if (xResult == pdPASS)
+  {
+    I2C1->DR = ucRegister;
+    xResult = prvI2cWait(I2C_SR1_BTF);
+  }
+  if (xResult == pdPASS)
+  {
+    /* A single byte read: NACK and STOP go in while ADDR is being
+       cleared. */
+    I2C1->CR1 |= I2C_CR1_START;
+    xResult = prvI2cWait(I2C_SR1_SB);
+  }
+  if (xResult == pdPASS)
+  {
+    I2C1->DR = audioCODEC_ADDRESS | 1U;
+    xResult = prvI2cWait(I2C_SR1_ADDR);
+  }
+  if (xResult == pdPASS)
+  {
+    I2C1->CR1 &= ~I2C_CR1_ACK;
+    (void) I2C1->SR2;
+    I2C1->CR1 |= I2C_CR1_STOP;
+    xResult = prvI2cWait(I2C_SR1_RXNE);
+    *pucValue = (uint8_t) I2C1->DR;
+    return xResult;
+  }
+
+  I2C1->CR1 |= I2C_CR1_STOP;
+
+  return xResult;
+}
+
+/**
+  * @brief  Set I2C1 up for the current APB1 clock, and address a device for
+  *         writing.
+  * @note   The timing is worked out again each time, so clock changes need
+  *         no hook.
+  * @retval pdPASS, or pdFAIL if the device did not acknowledge.
+  */
+static BaseType_t prvI2cStart(uint8_t ucAddress)
+{
+  uint32_t ulPclk1 = HAL_RCC_GetPCLK1Freq();
+  uint32_t ulCcr = ulPclk1 / (2U * audioI2C_HZ);
+
+  /* The last transaction ended with STOP, which clears itself once sent. */
+  (void) prvWaitUntil(&I2C1->CR1, I2C_CR1_STOP, 0U, audioI2C_TIMEOUT_US);
+
+  I2C1->CR1 = 0U;
+  I2C1->CR2 = ulPclk1 / 1000000U;
+  I2C1->CCR = (ulCcr < 4U) ? 4U : ulCcr;
+  I2C1->TRISE = (ulPclk1 / 1000000U) + 1U;
+  I2C1->CR1 = I2C_CR1_PE;
+
+  I2C1->CR1 |= I2C_CR1_START;
+  if (prvI2cWait(I2C_SR1_SB) != pdPASS)
+  {
+    return pdFAIL;
+  }
+
+  I2C1->DR = ucAddress;
+  if (prvI2cWait(I2C_SR1_ADDR) != pdPASS)
+  {
+    return pdFAIL;
+  }
+  (void) I2C1->SR2;
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Wait for an I2C1 SR1 flag, giving up on a NACK or after
+  *         audioI2C_TIMEOUT_US.
+  * @retval pdPASS once the flag is set.
+  */
+static BaseType_t prvI2cWait(uint32_t ulFlag)
+{
+  uint32_t ulStart = ulTimebaseNowUs();
+
+  while ((I2C1->SR1 & ulFlag) == 0U)
+  {
+    if (((I2C1->SR1 & I2C_SR1_AF) != 0U) || ((ulTimebaseNowUs() - ulStart) >= audioI2C_TIMEOUT_US))
+    {
+      I2C1->SR1 = (uint32_t) ~I2C_SR1_AF;
+      return pdFAIL;
+    }
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Wait for the bits of ulMask in a register to read ulValue.
+  * @retval pdPASS, or pdFAIL after ulTimeoutUs.
+  */
+static BaseType_t prvWaitUntil(volatile uint32_t *pulRegister, uint32_t ulMask, uint32_t ulValue,
+                               uint32_t ulTimeoutUs)
+{
+  uint32_t ulStart = ulTimebaseNowUs();
+
+  while ((*pulRegister & ulMask) != ulValue)
+  {
+    if ((ulTimebaseNowUs() - ulStart) >= ulTimeoutUs)
+    {
+      return pdFAIL;
+    }
+  }
+
+  return pdPASS;
+}
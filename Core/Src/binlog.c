@@ -0,0 +1,62 @@
+/**
+  ******************************************************************************
+  * @file           : binlog.c
+  * @brief          : Record writer behind BINLOG().
+  ******************************************************************************
+  * A record is built on the caller's stack and queued with one xLogWrite(),
+  * so it reaches the stream whole or, if the ring is full, is dropped whole
+  * and counted like any other message.  Records from different writers never
+  * interleave.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "binlog.h"
+#include "log.h"
+#include "timebase.h"
+#include "crc.h"
+
+_Static_assert(sizeof(BinLogHeader_t) == 8U, "BinLogHeader_t must be packed into 8 bytes");
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Queue one record.  Called by BINLOG(); not meant to be called
+  *         directly.
+  * @param  usFormat  Offset of the format string in .binlog.
+  * @param  pulArgs   The arguments, as 32 bit words.
+  * @param  xArgCount Number of words at pulArgs, at most binlogMAX_ARGS.
+  * @retval Bytes queued, 0 if the record was dropped.
+  */
+size_t xBinLogWrite(uint16_t usFormat, const uint32_t *pulArgs, size_t xArgCount)
+{
+  uint32_t ulRecord[(sizeof(BinLogHeader_t) / sizeof(uint32_t)) + binlogMAX_ARGS + 1U];
+  BinLogHeader_t *pxHeader = (BinLogHeader_t *) ulRecord;
+  size_t xWords;
+
+  if (xArgCount > binlogMAX_ARGS)
+  {
+    xArgCount = binlogMAX_ARGS;
+  }
+
+  pxHeader->ucSync = (uint8_t) binlogSYNC;
+  pxHeader->ucArgCount = (uint8_t) ((binlogCRC == 1) ? (xArgCount | binlogCRC_FLAG) : xArgCount);
+  pxHeader->usFormat = usFormat;
+  pxHeader->ulTimestamp = ulTimebaseNowUs();
+
+  if (xArgCount != 0U)
+  {
+    (void) memcpy(&ulRecord[sizeof(BinLogHeader_t) / sizeof(uint32_t)], pulArgs,
+                  xArgCount * sizeof(uint32_t));
+  }
+
+  xWords = (sizeof(BinLogHeader_t) / sizeof(uint32_t)) + xArgCount;
+#if (binlogCRC == 1)
+  ulRecord[xWords] = ulCrcComputeWords(ulRecord, xWords);
+  xWords++;
+#endif
+
+  return xLogWrite(ulRecord, xWords * sizeof(uint32_t));
+}
@@ -0,0 +1,103 @@
+/**
+  ******************************************************************************
+  * @file           : boottime.c
+  * @brief          : Boot trace stamps and their report, logged once after
+  *                   the scheduler has started.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "boottime.h"
+#include "periodic.h"
+#include "log.h"
+#include "dwt.h"
+
+/* Exported variables --------------------------------------------------------*/
+
+/* Up to BOOT_PHASE_CRT written by Reset_Handler, before .bss is cleared. */
+uint32_t ulBootTraceCycles[BOOT_PHASE_COUNT] __attribute__((section(".noinit")));
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Core clock when each stamp was taken, unused for the startup phases. */
+static uint32_t ulBootTraceHz[BOOT_PHASE_COUNT] __attribute__((section(".noinit")));
+
+static const char *const pcBootPhaseNames[BOOT_PHASE_COUNT] =
+{
+  "copy", "zero", "crt", "hal_init", "clock_config", "clock_profile",
+  "pinmux", "peripherals", "app_init", "tasks", "scheduler"
+};
+
+static PeriodicJob_t xBootTimeJob;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvBootTimeJob(void *pvParameter);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Stamp the end of a phase.
+  * @param  ePhase A phase after BOOT_PHASE_CRT.
+  * @retval None
+  */
+void vBootTimeMark(BootPhase_t ePhase)
+{
+  configASSERT((ePhase > BOOT_PHASE_CRT) && (ePhase < BOOT_PHASE_COUNT));
+
+  ulBootTraceCycles[ePhase] = ulDwtCycles();
+  ulBootTraceHz[ePhase] = SystemCoreClock;
+}
+
+/**
+  * @brief  Stamp BOOT_PHASE_SCHEDULER, from traceSTART_FIRST_TASK().
+  * @retval None
+  */
+void vBootTimeFirstTask(void)
+{
+  vBootTimeMark(BOOT_PHASE_SCHEDULER);
+}
+
+/**
+  * @brief  Log the trace once the scheduler has started.
+  * @retval Result of xPeriodicJobStart().
+  */
+BaseType_t xBootTimeReportStart(void)
+{
+  return xPeriodicJobStart(&xBootTimeJob, prvBootTimeJob, NULL, 0, 0);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Log "boot <phase>: <cycles> cycles <us> us" for every phase, then
+  *         "boot total: <us> us".
+  * @param  pvParameter Unused.
+  * @retval None
+  */
+static void prvBootTimeJob(void *pvParameter)
+{
+  uint32_t ulPrevious = 0U;
+  uint32_t ulTotalUs = 0U;
+  uint32_t ulCycles;
+  uint32_t ulHz;
+  uint32_t ulUs;
+  BootPhase_t ePhase;
+
+  (void) pvParameter;
+
+  for (ePhase = BOOT_PHASE_COPY; ePhase < BOOT_PHASE_COUNT; ePhase++)
+  {
+    ulCycles = ulBootTraceCycles[ePhase] - ulPrevious;
+    ulPrevious = ulBootTraceCycles[ePhase];
+    ulHz = (ePhase <= BOOT_PHASE_CRT) ? boottimeSTARTUP_HZ : ulBootTraceHz[ePhase];
+    ulUs = (uint32_t) (((uint64_t) ulCycles * 1000000ULL) / ulHz);
+    ulTotalUs += ulUs;
+
+    (void) xLogPrintf("boot %s: %lu cycles %lu us\n\r", pcBootPhaseNames[ePhase],
+                      (unsigned long) ulCycles, (unsigned long) ulUs);
+  }
+
+  (void) xLogPrintf("boot total: %lu us\n\r", (unsigned long) ulTotalUs);
+}
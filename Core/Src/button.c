@@ -0,0 +1,195 @@
+/**
+  ******************************************************************************
+  * @file           : button.c
+  * @brief          : User button on PA0, debounced by masking EXTI line 0
+  *                   behind a timebase one-shot event.
+  ******************************************************************************
+  * The line triggers on both edges.  Its interrupt and the timebase's TIM5
+  * interrupt both run at configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, so
+  * they never preempt each other and the state below needs no guard between
+  * them; vButtonSetListener() masks them to change the listener.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "button.h"
+#include "irqtable.h"
+#include "timebase.h"
+
+/* Private define ------------------------------------------------------------*/
+#define buttonEXTI_LINE             Blue_Button_Pin_Pin
+
+/* Private variables ---------------------------------------------------------*/
+static TimebaseEvent_t xSettleEvent;
+
+static TaskHandle_t xListener = NULL;
+static uint32_t ulPressBits = 0U;
+static uint32_t ulReleaseBits = 0U;
+
+/* State last reported, the time of that edge, and presses since boot. */
+static volatile BaseType_t xPressed = pdFALSE;
+static volatile uint32_t ulEdgeUs = 0U;
+static volatile uint32_t ulPresses = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static BaseType_t prvReadPin(void);
+static void prvReport(BaseType_t xNowPressed, BaseType_t *pxHigherPriorityTaskWoken);
+static void prvSettled(void *pvParameter);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Take the button's state and let its edges interrupt.
+  * @retval None
+  */
+void vButtonInit(void)
+{
+  xPressed = prvReadPin();
+
+  EXTI->IMR &= ~buttonEXTI_LINE;
+  EXTI->RTSR |= buttonEXTI_LINE;
+  EXTI->FTSR |= buttonEXTI_LINE;
+  EXTI->PR = buttonEXTI_LINE;
+  EXTI->IMR |= buttonEXTI_LINE;
+
+  irqtableREQUIRE_KERNEL(EXTI0);
+  HAL_NVIC_SetPriority(EXTI0_IRQn, irqtablePRIORITY(EXTI0), 0U);
+  HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+}
+
+/**
+  * @brief  Choose the task notified of presses and releases.  The bits are
+  *         set in its notification value, eSetBits.
+  * @param  xTask     Task to notify, or NULL for none.
+  * @param  ulPress   Bits set on a press.
+  * @param  ulRelease Bits set on a release; 0 for presses only.
+  * @retval None
+  */
+void vButtonSetListener(TaskHandle_t xTask, uint32_t ulPress, uint32_t ulRelease)
+{
+  taskENTER_CRITICAL();
+  xListener = xTask;
+  ulPressBits = ulPress;
+  ulReleaseBits = ulRelease;
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Debounced state of the button.
+  * @retval pdTRUE while pressed.
+  */
+BaseType_t xButtonIsPressed(void)
+{
+  return xPressed;
+}
+
+/**
+  * @brief  When the last edge reported began, so a listener can tell how
+  *         long ago the button actually moved.
+  * @retval Timebase counter at the edge, in microseconds.
+  */
+uint32_t ulButtonGetEdgeUs(void)
+{
+  return ulEdgeUs;
+}
+
+/**
+  * @brief  Presses since boot.
+  * @retval Count.
+  */
+uint32_t ulButtonGetPresses(void)
+{
+  return ulPresses;
+}
+
+/**
+  * @brief  EXTI0 handler body: the first edge after a quiet period.
+  * @retval None
+  */
+void vButtonExtiIRQHandler(void)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  uint32_t ulNowUs = ulTimebaseNowUs();
+
+  EXTI->PR = buttonEXTI_LINE;
+  EXTI->IMR &= ~buttonEXTI_LINE;
+
+  /* Whatever the pin reads mid bounce, an edge out of a settled state can
+     only be to the other state. */
+  ulEdgeUs = ulNowUs;
+  prvReport((xPressed == pdFALSE) ? pdTRUE : pdFALSE, &xHigherPriorityTaskWoken);
+  vTimebaseEventStart(&xSettleEvent, buttonDEBOUNCE_US, prvSettled, NULL);
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Level of the pin; the board pulls it down and the button drives it
+  *         high.
+  * @retval pdTRUE if pressed.
+  */
+static BaseType_t prvReadPin(void)
+{
+  return ((Blue_Button_Pin_GPIO_Port->IDR & Blue_Button_Pin_Pin) != 0U) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  Record a new state and notify the listener of it.
+  * @retval None
+  */
+static void prvReport(BaseType_t xNowPressed, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  uint32_t ulBits;
+
+  xPressed = xNowPressed;
+  if (xNowPressed != pdFALSE)
+  {
+    ulPresses++;
+  }
+
+  ulBits = (xNowPressed != pdFALSE) ? ulPressBits : ulReleaseBits;
+  if ((xListener != NULL) && (ulBits != 0U))
+  {
+    (void) xTaskNotifyFromISR(xListener, ulBits, eSetBits, pxHigherPriorityTaskWoken);
+  }
+}
+
+/**
+  * @brief  Timebase event at the end of a debounce period: report a state
+  *         the pin settled in that was not reported yet, or open the line
+  *         for the next edge.
+  * @param  pvParameter Unused.
+  * @retval None
+  */
+static void prvSettled(void *pvParameter)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  BaseType_t xNowPressed;
+
+  (void) pvParameter;
+
+  xNowPressed = prvReadPin();
+  if (xNowPressed != xPressed)
+  {
+    /* Changed during the period; it began some time in it. */
+    ulEdgeUs = ulTimebaseNowUs();
+    prvReport(xNowPressed, &xHigherPriorityTaskWoken);
+    vTimebaseEventStart(&xSettleEvent, buttonDEBOUNCE_US, prvSettled, NULL);
+  }
+  else
+  {
+    /* Drop the bounce latched while masked, then catch an edge that came
+       between the read and the unmask. */
+    EXTI->PR = buttonEXTI_LINE;
+    EXTI->IMR |= buttonEXTI_LINE;
+    if (prvReadPin() != xPressed)
+    {
+      EXTI->SWIER = buttonEXTI_LINE;
+    }
+  }
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
@@ -0,0 +1,564 @@
+/**
+  ******************************************************************************
+  * @file           : clockprofile.c
+  * @brief          : System clock profiles and switching between them at run
+  *                   time.
+  ******************************************************************************
+  * A switch runs SYSCLK from the HSI while the PLL is stopped and rebuilt, so
+  * the PLL never has to be reconfigured while it is in use and the regulator
+  * scale can be changed with it off.  HAL_RCC_ClockConfig() orders the flash
+  * latency change against the frequency change itself.
+  *
+  * Interrupts stay enabled throughout, as the HAL oscillator timeouts count
+  * on HAL_GetTick(); other tasks are held off by suspending the scheduler,
+  * and the log is drained first so that no byte goes out at a stale baud
+  * rate.
+  *
+  * At boot none of that is needed: the core is on the HSI at its reset
+  * settings, nothing else runs, and no timebase has started.  With
+  * clockFAST_BOOT, xClockProfileFastBoot() writes clockBOOT_PROFILE straight
+  * into the flash, PWR and RCC registers through the LL API, bounding the
+  * oscillator waits by a poll count, and then moves the HAL tick to the
+  * final clock.  It runs after HAL_Init(), which only starts the timebase on
+  * the HSI, and replaces the generated SystemClock_Config() and the first
+  * xClockProfileSet(), which together set up the PLL twice and the timebase
+  * twice more.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "clockprofile.h"
+#include "log.h"
+#include "led.h"
+#include "itm.h"
+#include "accel.h"
+#include "uartline.h"
+#include "stm32f4xx_ll_bus.h"
+#include "stm32f4xx_ll_pwr.h"
+#include "stm32f4xx_ll_rcc.h"
+#include "stm32f4xx_ll_system.h"
+
+#if (configUSE_TASK_ENERGY_STATS == 1)
+_Static_assert(configENERGY_PROFILES == CLOCK_PROFILE_COUNT,
+               "configENERGY_PROFILES must count the clock profiles, which are the energy profiles");
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t ulSysclkHz;
+  uint32_t ulPllSource;       /*!< RCC_PLLSOURCE_HSI or RCC_PLLSOURCE_HSE.   */
+  uint32_t ulPllM;
+  uint32_t ulPllN;
+  uint32_t ulPllP;
+  uint32_t ulPllQ;
+  uint32_t ulApb1Divider;
+  uint32_t ulApb2Divider;
+  uint32_t ulFlashLatency;
+  uint32_t ulVoltageScale;
+  uint32_t ulPrefetch;        /*!< Only worth its current with wait states.  */
+} ClockProfileConfig_t;
+
+/* Private variables ---------------------------------------------------------*/
+extern UART_HandleTypeDef huart2;
+
+/* PLLQ keeps 48 MHz for USB on the HSE profiles. */
+static const ClockProfileConfig_t xProfiles[CLOCK_PROFILE_COUNT] =
+{
+  [CLOCK_PROFILE_PERFORMANCE] =
+  {
+    168000000UL, RCC_PLLSOURCE_HSE, 8U, 336U, RCC_PLLP_DIV2, 7U,
+    RCC_HCLK_DIV4, RCC_HCLK_DIV2, FLASH_LATENCY_5, PWR_REGULATOR_VOLTAGE_SCALE1, 1U
+  },
+  [CLOCK_PROFILE_BALANCED] =
+  {
+    84000000UL, RCC_PLLSOURCE_HSE, 8U, 336U, RCC_PLLP_DIV4, 7U,
+    RCC_HCLK_DIV2, RCC_HCLK_DIV1, FLASH_LATENCY_2, PWR_REGULATOR_VOLTAGE_SCALE2, 1U
+  },
+  /* The configuration SystemClock_Config() generates. */
+  [CLOCK_PROFILE_LOW_POWER] =
+  {
+    25000000UL, RCC_PLLSOURCE_HSI, 8U, 50U, RCC_PLLP_DIV4, 7U,
+    RCC_HCLK_DIV4, RCC_HCLK_DIV2, FLASH_LATENCY_0, PWR_REGULATOR_VOLTAGE_SCALE2, 0U
+  },
+};
+
+static ClockProfile_t eCurrentProfile = CLOCK_PROFILE_LOW_POWER;
+
+/* Drivers holding the PLLI2S, and drivers holding the HSE profiles. */
+static UBaseType_t uxI2SUsers = 0U;
+static volatile UBaseType_t uxHseHolds = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static HAL_StatusTypeDef prvApplyProfile(const ClockProfileConfig_t *pxConfig);
+static BaseType_t prvI2SClockStart(void);
+static uint32_t prvPllInputHz(void);
+#if (clockFAST_BOOT == 1)
+static BaseType_t prvSpinUntilReady(uint32_t (*pxIsReady)(void));
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+#if (clockFAST_BOOT == 1)
+/**
+  * @brief  Bring the clocks up in clockBOOT_PROFILE from the HSI that
+  *         HAL_Init() leaves them on, and move the HAL tick to the new clock.
+  * @note   Call first thing in USER CODE Init, straight after HAL_Init(), in
+  *         place of SystemClock_Config().
+  * @retval pdPASS, or pdFAIL if the HSE or PLL did not start in
+  *         clockFAST_BOOT_SPINS polls, in which case the clocks are left in
+  *         the low power profile, which needs neither the HSE nor a new PLL.
+  */
+BaseType_t xClockProfileFastBoot(void)
+{
+  ClockProfile_t eProfile = clockBOOT_PROFILE;
+  const ClockProfileConfig_t *pxConfig = &xProfiles[eProfile];
+  BaseType_t xReturn = pdPASS;
+
+  LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_PWR);
+
+  if (pxConfig->ulPllSource == RCC_PLLSOURCE_HSE)
+  {
+    LL_RCC_HSE_EnableBypass();
+    LL_RCC_HSE_Enable();
+    if (prvSpinUntilReady(LL_RCC_HSE_IsReady) != pdPASS)
+    {
+      LL_RCC_HSE_Disable();
+      eProfile = CLOCK_PROFILE_LOW_POWER;
+      pxConfig = &xProfiles[eProfile];
+      xReturn = pdFAIL;
+    }
+  }
+
+  /* The PLL is off out of reset, so VOS can be set now, and the wait states
+     go up before the clock does. */
+  LL_PWR_SetRegulVoltageScaling(pxConfig->ulVoltageScale);
+  LL_FLASH_SetLatency(pxConfig->ulFlashLatency);
+  while (LL_FLASH_GetLatency() != pxConfig->ulFlashLatency)
+  {
+  }
+  LL_FLASH_EnableInstCache();
+  LL_FLASH_EnableDataCache();
+  /* HAL_Init() has turned the prefetch on. */
+  if (pxConfig->ulPrefetch != 0U)
+  {
+    LL_FLASH_EnablePrefetch();
+  }
+  else
+  {
+    LL_FLASH_DisablePrefetch();
+  }
+
+  /* The whole PLL configuration in one write; the HAL's RCC_PLLP_DIVx are
+     2, 4, 6 and 8 where the register field counts from 0. */
+  WRITE_REG(RCC->PLLCFGR, pxConfig->ulPllSource | pxConfig->ulPllM |
+                          (pxConfig->ulPllN << RCC_PLLCFGR_PLLN_Pos) |
+                          (((pxConfig->ulPllP >> 1U) - 1U) << RCC_PLLCFGR_PLLP_Pos) |
+                          (pxConfig->ulPllQ << RCC_PLLCFGR_PLLQ_Pos));
+  LL_RCC_PLL_Enable();
+  if (prvSpinUntilReady(LL_RCC_PLL_IsReady) != pdPASS)
+  {
+    Error_Handler();
+  }
+
+  /* RCC_HCLK_DIVx are PPRE1 values, and PPRE2 is the same field three bits
+     up. */
+  LL_RCC_SetAHBPrescaler(LL_RCC_SYSCLK_DIV_1);
+  LL_RCC_SetAPB1Prescaler(pxConfig->ulApb1Divider);
+  LL_RCC_SetAPB2Prescaler(pxConfig->ulApb2Divider << 3U);
+  LL_RCC_SetSysClkSource(LL_RCC_SYS_CLKSOURCE_PLL);
+  while (LL_RCC_GetSysClkSource() != LL_RCC_SYS_CLKSOURCE_STATUS_PLL)
+  {
+  }
+
+  SystemCoreClock = pxConfig->ulSysclkHz;
+  eCurrentProfile = eProfile;
+#if (configUSE_TASK_ENERGY_STATS == 1)
+  vTaskSetEnergyProfile((UBaseType_t) eProfile);
+#endif
+
+  if (HAL_InitTick(TICK_INT_PRIORITY) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  return xReturn;
+}
+#endif /* clockFAST_BOOT */
+
+/**
+  * @brief  Switch the system clock to eProfile.
+  * @note   May be called before the scheduler starts, or from a task.  Blocks
+  *         for the log to drain and for the HSE and PLL to lock, up to a few
+  *         milliseconds, with the scheduler suspended.
+  * @param  eProfile Profile to switch to.
+  * @retval pdPASS, or pdFAIL if the HSE or PLL did not start, in which case
+  *         the low power profile, which needs neither the HSE nor a new PLL
+  *         lock time, is in force instead, or if a PLLI2S in use did not
+  *         start again.
+  */
+BaseType_t xClockProfileSet(ClockProfile_t eProfile)
+{
+  BaseType_t xSchedulerRunning;
+  BaseType_t xReturn = pdPASS;
+
+  configASSERT(eProfile < CLOCK_PROFILE_COUNT);
+
+  xSchedulerRunning = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) ? pdTRUE : pdFALSE;
+  if (xSchedulerRunning != pdFALSE)
+  {
+    vTaskSuspendAll();
+  }
+
+  /* The DMA completion interrupt still runs with the scheduler suspended. */
+  while (xLogGetPending() != 0U)
+  {
+  }
+  if (huart2.gState != HAL_UART_STATE_RESET)
+  {
+    while ((huart2.Instance->SR & USART_SR_TC) == 0U)
+    {
+    }
+  }
+
+  if (prvApplyProfile(&xProfiles[eProfile]) == HAL_OK)
+  {
+    eCurrentProfile = eProfile;
+  }
+  else
+  {
+    /* The HSI is already running SYSCLK, so this cannot fail on the HSE. */
+    if (prvApplyProfile(&xProfiles[CLOCK_PROFILE_LOW_POWER]) != HAL_OK)
+    {
+      Error_Handler();
+    }
+    eCurrentProfile = CLOCK_PROFILE_LOW_POWER;
+    xReturn = pdFAIL;
+  }
+
+#if (configUSE_TASK_ENERGY_STATS == 1)
+  vTaskSetEnergyProfile((UBaseType_t) eCurrentProfile);
+#endif
+
+  vUartLineUpdateClock();
+  vLedUpdateClock();
+  vItmUpdateClock();
+  vAccelUpdateClock();
+
+  if ((uxI2SUsers != 0U) && (__HAL_RCC_GET_FLAG(RCC_FLAG_PLLI2SRDY) == RESET) &&
+      (prvI2SClockStart() != pdPASS))
+  {
+    xReturn = pdFAIL;
+  }
+
+  if (xSchedulerRunning != pdFALSE)
+  {
+    (void) xTaskResumeAll();
+  }
+
+  return xReturn;
+}
+
+/**
+  * @brief  Profile currently in force.
+  * @retval The profile.
+  */
+ClockProfile_t eClockProfileGet(void)
+{
+  return eCurrentProfile;
+}
+
+/**
+  * @brief  SYSCLK a profile runs at, for sizing work before switching.
+  * @param  eProfile Profile to look up.
+  * @retval Frequency in Hz.
+  */
+uint32_t ulClockProfileGetSysclkHz(ClockProfile_t eProfile)
+{
+  configASSERT(eProfile < CLOCK_PROFILE_COUNT);
+
+  return xProfiles[eProfile].ulSysclkHz;
+}
+
+/**
+  * @brief  PCLK1 a profile runs at, which clocks USART2 among others.
+  * @param  eProfile Profile to look up.
+  * @retval Frequency in Hz.
+  */
+uint32_t ulClockProfileGetPclk1Hz(ClockProfile_t eProfile)
+{
+  configASSERT(eProfile < CLOCK_PROFILE_COUNT);
+
+  /* HCLK is SYSCLK in every profile. */
+  return xProfiles[eProfile].ulSysclkHz >>
+         APBPrescTable[xProfiles[eProfile].ulApb1Divider >> RCC_CFGR_PPRE1_Pos];
+}
+
+/**
+  * @brief  Start the PLLI2S at clockI2SCLK_HZ, or count one more user of it.
+  * @note   May be called before the scheduler starts, or from a task.
+  * @retval pdPASS, or pdFAIL if it did not lock.
+  */
+BaseType_t xClockProfileI2SAcquire(void)
+{
+  BaseType_t xSchedulerRunning;
+  BaseType_t xReturn = pdPASS;
+
+  /* Held off from a profile switch like the switch is from other tasks. */
+  xSchedulerRunning = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) ? pdTRUE : pdFALSE;
+  if (xSchedulerRunning != pdFALSE)
+  {
+    vTaskSuspendAll();
+  }
+
+  if ((uxI2SUsers == 0U) && (prvI2SClockStart() != pdPASS))
+  {
+    __HAL_RCC_PLLI2S_DISABLE();
+    xReturn = pdFAIL;
+  }
+  else
+  {
+    uxI2SUsers++;
+  }
+
+  if (xSchedulerRunning != pdFALSE)
+  {
+    (void) xTaskResumeAll();
+  }
+
+  return xReturn;
+}
+
+/**
+  * @brief  Drop a hold taken by xClockProfileI2SAcquire(), stopping the
+  *         PLLI2S with the last one.
+  * @note   The I2S peripheral must be stopped first.
+  * @retval None
+  */
+void vClockProfileI2SRelease(void)
+{
+  BaseType_t xSchedulerRunning;
+
+  xSchedulerRunning = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) ? pdTRUE : pdFALSE;
+  if (xSchedulerRunning != pdFALSE)
+  {
+    vTaskSuspendAll();
+  }
+
+  configASSERT(uxI2SUsers != 0U);
+  uxI2SUsers--;
+  if (uxI2SUsers == 0U)
+  {
+    __HAL_RCC_PLLI2S_DISABLE();
+  }
+
+  if (xSchedulerRunning != pdFALSE)
+  {
+    (void) xTaskResumeAll();
+  }
+}
+
+/**
+  * @brief  Ask for the HSE profiles, those with PLLQ at 48 MHz and the PLLI2S
+  *         input exact.
+  * @note   May be called from an interrupt.  Takes effect at the governor's
+  *         next window.
+  * @retval None
+  */
+void vClockProfileHseHold(void)
+{
+  UBaseType_t uxSavedInterruptStatus;
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+  uxHseHolds++;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/**
+  * @brief  Drop a hold taken by vClockProfileHseHold().
+  * @note   May be called from an interrupt.
+  * @retval None
+  */
+void vClockProfileHseRelease(void)
+{
+  UBaseType_t uxSavedInterruptStatus;
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+  configASSERT(uxHseHolds != 0U);
+  uxHseHolds--;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/**
+  * @brief  Whether any driver needs the HSE profiles, by a hold or by running
+  *         the PLLI2S, whose input the low power profile would change.
+  * @retval pdTRUE if so.
+  */
+BaseType_t xClockProfileHseHeld(void)
+{
+  return ((uxHseHolds != 0U) || (uxI2SUsers != 0U)) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  I2SCLK as the PLLI2S is programmed now, for working out I2S
+  *         dividers.  Exactly clockI2SCLK_HZ on the HSE profiles.
+  * @retval Frequency in Hz.
+  */
+uint32_t ulClockProfileGetI2SHz(void)
+{
+  uint32_t ulN = (RCC->PLLI2SCFGR & RCC_PLLI2SCFGR_PLLI2SN) >> RCC_PLLI2SCFGR_PLLI2SN_Pos;
+  uint32_t ulR = (RCC->PLLI2SCFGR & RCC_PLLI2SCFGR_PLLI2SR) >> RCC_PLLI2SCFGR_PLLI2SR_Pos;
+
+  return (uint32_t) (((uint64_t) prvPllInputHz() * ulN) / ulR);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Move SYSCLK to the HSI, rebuild the PLL for pxConfig and switch to
+  *         it.
+  * @param  pxConfig Profile to apply.
+  * @retval HAL status of the first step that failed.
+  */
+static HAL_StatusTypeDef prvApplyProfile(const ClockProfileConfig_t *pxConfig)
+{
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+  HAL_StatusTypeDef xStatus;
+
+  /* 16 MHz is within every wait state setting, so the latency can stay as it
+     is for now. */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_SYSCLK;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+  xStatus = HAL_RCC_ClockConfig(&RCC_ClkInitStruct, __HAL_FLASH_GET_LATENCY());
+  if (xStatus != HAL_OK)
+  {
+    return xStatus;
+  }
+
+  /* VOS is only taken up while the PLL is off. */
+  __HAL_RCC_PLL_DISABLE();
+  while (__HAL_RCC_GET_FLAG(RCC_FLAG_PLLRDY) != RESET)
+  {
+  }
+
+  /* The PLLI2S runs off the same source and divider, and has to be off
+     while they change; xClockProfileSet() starts it again. */
+  if ((RCC->PLLCFGR & (RCC_PLLCFGR_PLLSRC | RCC_PLLCFGR_PLLM)) != (pxConfig->ulPllSource | pxConfig->ulPllM))
+  {
+    __HAL_RCC_PLLI2S_DISABLE();
+    while (__HAL_RCC_GET_FLAG(RCC_FLAG_PLLI2SRDY) != RESET)
+    {
+    }
+  }
+
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_PWR_VOLTAGESCALING_CONFIG(pxConfig->ulVoltageScale);
+
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = (pxConfig->ulPllSource == RCC_PLLSOURCE_HSE) ? RCC_HSE_BYPASS : RCC_HSE_OFF;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = pxConfig->ulPllSource;
+  RCC_OscInitStruct.PLL.PLLM = pxConfig->ulPllM;
+  RCC_OscInitStruct.PLL.PLLN = pxConfig->ulPllN;
+  RCC_OscInitStruct.PLL.PLLP = pxConfig->ulPllP;
+  RCC_OscInitStruct.PLL.PLLQ = pxConfig->ulPllQ;
+  xStatus = HAL_RCC_OscConfig(&RCC_OscInitStruct);
+  if (xStatus != HAL_OK)
+  {
+    return xStatus;
+  }
+
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_SYSCLK
+                              |RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = pxConfig->ulApb1Divider;
+  RCC_ClkInitStruct.APB2CLKDivider = pxConfig->ulApb2Divider;
+  xStatus = HAL_RCC_ClockConfig(&RCC_ClkInitStruct, pxConfig->ulFlashLatency);
+  if (xStatus != HAL_OK)
+  {
+    return xStatus;
+  }
+
+  /* The instruction and data caches pay at any wait state and stay on. */
+  if (pxConfig->ulPrefetch != 0U)
+  {
+    __HAL_FLASH_PREFETCH_BUFFER_ENABLE();
+  }
+  else
+  {
+    __HAL_FLASH_PREFETCH_BUFFER_DISABLE();
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Program the PLLI2S for clockI2SCLK_HZ from the PLL input in force
+  *         and start it.
+  * @retval pdPASS, or pdFAIL if it did not lock in PLLI2S_TIMEOUT_VALUE.
+  */
+static BaseType_t prvI2SClockStart(void)
+{
+  uint32_t ulInputHz = prvPllInputHz();
+  uint32_t ulN;
+  uint32_t ulTickStart;
+
+  ulN = ((clockI2SCLK_HZ * clockPLLI2S_R) + (ulInputHz / 2U)) / ulInputHz;
+
+  __HAL_RCC_PLLI2S_DISABLE();
+  while (__HAL_RCC_GET_FLAG(RCC_FLAG_PLLI2SRDY) != RESET)
+  {
+  }
+
+  RCC->PLLI2SCFGR = (ulN << RCC_PLLI2SCFGR_PLLI2SN_Pos) | (clockPLLI2S_R << RCC_PLLI2SCFGR_PLLI2SR_Pos);
+  __HAL_RCC_PLLI2S_ENABLE();
+
+  ulTickStart = HAL_GetTick();
+  while (__HAL_RCC_GET_FLAG(RCC_FLAG_PLLI2SRDY) == RESET)
+  {
+    if ((HAL_GetTick() - ulTickStart) > PLLI2S_TIMEOUT_VALUE)
+    {
+      return pdFAIL;
+    }
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Input to the main PLL and the PLLI2S, after the M divider.
+  * @retval Frequency in Hz.
+  */
+static uint32_t prvPllInputHz(void)
+{
+  uint32_t ulPllCfgr = RCC->PLLCFGR;
+
+  return (((ulPllCfgr & RCC_PLLCFGR_PLLSRC) != 0U) ? HSE_VALUE : HSI_VALUE)
+       / (ulPllCfgr & RCC_PLLCFGR_PLLM);
+}
+
+#if (clockFAST_BOOT == 1)
+/**
+  * @brief  Poll an LL ready flag at most clockFAST_BOOT_SPINS times.
+  * @param  pxIsReady LL_RCC_<oscillator>_IsReady.
+  * @retval pdPASS once it reads 1, or pdFAIL.
+  */
+static BaseType_t prvSpinUntilReady(uint32_t (*pxIsReady)(void))
+{
+  uint32_t ulSpins;
+
+  for (ulSpins = 0U; ulSpins < clockFAST_BOOT_SPINS; ulSpins++)
+  {
+    if (pxIsReady() != 0U)
+    {
+      return pdPASS;
+    }
+  }
+
+  return pdFAIL;
+}
+#endif /* clockFAST_BOOT */
@@ -0,0 +1,349 @@
+/**
+  ******************************************************************************
+  * @file           : cpustats.c
+  * @brief          : Binary CPU load snapshots built on uxTaskGetSystemState().
+  ******************************************************************************
+  * The kernel's run time counters are cumulative DWT cycle counts, which wrap
+  * every 2^32 cycles.  Each snapshot therefore keeps the counters it saw and
+  * reports the difference on the next call; unsigned subtraction keeps that
+  * right across a wrap as long as snapshots are taken more often than the
+  * counter wraps.  DWT stops in STOP mode, so loads are shares of the time
+  * the core was actually clocked.
+  *
+  * The running task's counter is only brought up to date when it is switched
+  * out, so the caller's own load lags by up to one time slice.
+  *
+  * The energy figures are kept the same way.  The wake causes are taken from
+  * lowpower.c, which starts counting afresh each time.
+  *
+  * The module keeps its state in static storage and is meant to be called
+  * from a single task.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cpustats.h"
+#include "lowpower.h"
+#include "log.h"
+
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+
+#if (configUSE_TASK_ENERGY_STATS == 1)
+_Static_assert(configENERGY_PROFILES <= cpustatsPROFILES, "a task record has no room for every energy profile");
+#endif
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  UBaseType_t uxTaskNumber;
+  uint32_t ulRunTime;
+  uint32_t ulSwitchIns;
+#if (configUSE_TASK_ENERGY_STATS == 1)
+  uint32_t ulEnergyRunTime[configENERGY_PROFILES];
+  uint32_t ulWakeCount;
+#endif
+} CpuStatsHistory_t;
+
+/* Private variables ---------------------------------------------------------*/
+static TaskStatus_t xStatus[cpustatsMAX_TASKS];
+
+/* Counters seen by the previous snapshot. */
+static CpuStatsHistory_t xHistory[cpustatsMAX_TASKS];
+static UBaseType_t uxHistoryCount = 0U;
+static uint32_t ulHistoryTotal = 0U;
+
+/* Snapshot being handed to the log; xLogWrite() copies it out. */
+static uint32_t ulSendBuffer[(cpustatsSNAPSHOT_SIZE + 3U) / 4U];
+
+/* Private function prototypes -----------------------------------------------*/
+static const CpuStatsHistory_t *prvFindHistory(UBaseType_t uxTaskNumber);
+static void prvFillEnergy(CpuStatsTask_t *pxRecord, const TaskStatus_t *pxStatus,
+                          const CpuStatsHistory_t *pxPrevious);
+static size_t prvFillWakes(CpuStatsHeader_t *pxHeader, CpuStatsWake_t *pxWake, size_t xRoom);
+#if (configUSE_SWITCH_PROFILER == 1)
+static void prvFormatPair(char *pcOut, size_t xLength, const SwitchProfile_t *pxProfile);
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Write a snapshot covering the window since the previous one.
+  * @param  pvBuffer      Destination, at least cpustatsSNAPSHOT_SIZE bytes to
+  *                       be sure every task fits, aligned to four bytes.
+  * @param  xBufferLength Size of pvBuffer in bytes.
+  * @note   Tasks that do not fit are left out of the snapshot but still tracked.
+  * @retval Bytes written, or 0 if more than cpustatsMAX_TASKS tasks exist.
+  */
+size_t xCpuStatsSnapshot(void *pvBuffer, size_t xBufferLength)
+{
+  CpuStatsHeader_t *pxHeader = (CpuStatsHeader_t *) pvBuffer;
+  CpuStatsTask_t *pxRecord = (CpuStatsTask_t *) (pxHeader + 1);
+  const CpuStatsHistory_t *pxPrevious;
+  UBaseType_t uxTasks;
+  UBaseType_t x;
+  uint32_t ulTotal;
+  uint32_t ulWindow;
+  uint32_t ulRunTime;
+  uint32_t ulSwitchIns;
+  size_t xWritten;
+
+  if (xBufferLength < sizeof(CpuStatsHeader_t))
+  {
+    return 0U;
+  }
+
+  uxTasks = uxTaskGetSystemState(xStatus, cpustatsMAX_TASKS, &ulTotal);
+  if (uxTasks == 0U)
+  {
+    return 0U;
+  }
+
+  ulWindow = ulTotal - ulHistoryTotal;
+  xWritten = sizeof(CpuStatsHeader_t);
+
+  for (x = 0U; x < uxTasks; x++)
+  {
+    pxPrevious = prvFindHistory(xStatus[x].xTaskNumber);
+    ulRunTime = xStatus[x].ulRunTimeCounter;
+    ulSwitchIns = xStatus[x].ulSwitchInCount;
+
+    /* A task created during the window started from zero. */
+    if (pxPrevious != NULL)
+    {
+      ulRunTime -= pxPrevious->ulRunTime;
+      ulSwitchIns -= pxPrevious->ulSwitchIns;
+    }
+
+    if ((xBufferLength - xWritten) < sizeof(CpuStatsTask_t))
+    {
+      continue;
+    }
+
+    strncpy(pxRecord->cName, xStatus[x].pcTaskName, cpustatsNAME_LENGTH);
+    pxRecord->ulSwitchIns = ulSwitchIns;
+    pxRecord->usLoadPermille = (ulWindow != 0U) ? (uint16_t) (((uint64_t) ulRunTime * 1000U) / ulWindow) : 0U;
+    pxRecord->usStackHighWater = (uint16_t) xStatus[x].usStackHighWaterMark;
+    pxRecord->ucTaskNumber = (uint8_t) xStatus[x].xTaskNumber;
+    pxRecord->ucPriority = (uint8_t) xStatus[x].uxCurrentPriority;
+    pxRecord->ucState = (uint8_t) xStatus[x].eCurrentState;
+    pxRecord->ucReserved = 0U;
+    pxRecord->usReserved = 0U;
+    prvFillEnergy(pxRecord, &xStatus[x], pxPrevious);
+
+    pxRecord++;
+    xWritten += sizeof(CpuStatsTask_t);
+  }
+
+  /* Only now is the old history no longer needed. */
+  for (x = 0U; x < uxTasks; x++)
+  {
+    xHistory[x].uxTaskNumber = xStatus[x].xTaskNumber;
+    xHistory[x].ulRunTime = xStatus[x].ulRunTimeCounter;
+    xHistory[x].ulSwitchIns = xStatus[x].ulSwitchInCount;
+#if (configUSE_TASK_ENERGY_STATS == 1)
+    memcpy(xHistory[x].ulEnergyRunTime, xStatus[x].ulEnergyRunTime, sizeof(xHistory[x].ulEnergyRunTime));
+    xHistory[x].ulWakeCount = xStatus[x].ulWakeCount;
+#endif
+  }
+  uxHistoryCount = uxTasks;
+  ulHistoryTotal = ulTotal;
+
+  xWritten += prvFillWakes(pxHeader, (CpuStatsWake_t *) pxRecord,
+                           (xBufferLength - xWritten) / sizeof(CpuStatsWake_t));
+
+  pxHeader->usMagic = cpustatsMAGIC;
+  pxHeader->ucVersion = cpustatsVERSION;
+  pxHeader->ucTaskCount = (uint8_t) ((xWritten - sizeof(CpuStatsHeader_t)) / sizeof(CpuStatsTask_t));
+  pxHeader->ulWindowCycles = ulWindow;
+  pxHeader->ulTickCount = (uint32_t) xTaskGetTickCount();
+#if (configUSE_TASK_ENERGY_STATS == 1)
+  pxHeader->ucProfileCount = (uint8_t) configENERGY_PROFILES;
+#else
+  pxHeader->ucProfileCount = 0U;
+#endif
+  pxHeader->usReserved = 0U;
+
+  return xWritten;
+}
+
+/**
+  * @brief  Take a snapshot and queue it on the log transport.
+  * @note   Never blocks; a snapshot that does not fit in the log ring is
+  *         dropped whole and the window it covered is lost.
+  * @retval Bytes queued, 0 if the snapshot failed or was dropped.
+  */
+size_t xCpuStatsSend(void)
+{
+  size_t xLength;
+
+  xLength = xCpuStatsSnapshot(ulSendBuffer, sizeof(ulSendBuffer));
+  if (xLength == 0U)
+  {
+    return 0U;
+  }
+
+  return xLogWrite(ulSendBuffer, xLength);
+}
+
+#if (configUSE_SWITCH_PROFILER == 1)
+/**
+  * @brief  Log the context switch time as a text line,
+  *         "switch cycles min/max: a/b fpu: c/d", for Tools/ramfunc_report.py.
+  *         On an MPU port a second line gives the region reload time.
+  * @note   Covers the whole run so far, not just the last window.
+  * @retval None
+  */
+void vCpuStatsPrintSwitchTime(void)
+{
+  SwitchProfile_t xIntegerOnly;
+  SwitchProfile_t xWithFPU;
+  char cIntegerOnly[24];
+  char cWithFPU[24];
+
+  vTaskGetSwitchTime(&xIntegerOnly, &xWithFPU);
+
+  prvFormatPair(cIntegerOnly, sizeof(cIntegerOnly), &xIntegerOnly);
+  prvFormatPair(cWithFPU, sizeof(cWithFPU), &xWithFPU);
+  (void) xLogPrintf("switch cycles min/max: %s fpu: %s\n\r", cIntegerOnly, cWithFPU);
+
+#ifdef portSWITCH_PROFILE_REGION_TIME
+  {
+    SwitchProfile_t xRegions;
+    char cRegions[24];
+    uint32_t ulOverruns;
+
+    /* On an MPU port, the region reload part of the above on its own line. */
+    ulOverruns = ulTaskGetRegionSwitchTime(&xRegions);
+    prvFormatPair(cRegions, sizeof(cRegions), &xRegions);
+    (void) xLogPrintf("mpu region cycles min/max: %s budget: %lu over: %lu\n\r", cRegions,
+                      (unsigned long) configMPU_REGION_SWITCH_BUDGET, (unsigned long) ulOverruns);
+  }
+#endif
+}
+#endif /* configUSE_SWITCH_PROFILER */
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Look up the counters the previous snapshot saw for a task.
+  * @param  uxTaskNumber Kernel task number, unique for the life of the system.
+  * @retval The history entry, or NULL for a task new to this window.
+  */
+static const CpuStatsHistory_t *prvFindHistory(UBaseType_t uxTaskNumber)
+{
+  UBaseType_t x;
+
+  for (x = 0U; x < uxHistoryCount; x++)
+  {
+    if (xHistory[x].uxTaskNumber == uxTaskNumber)
+    {
+      return &xHistory[x];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  * @brief  Fill in a task's running cycles per clock profile and its wakes
+  *         for the window, zero where the kernel does not count them.
+  * @param  pxPrevious History of the task, or NULL for a new one.
+  * @retval None
+  */
+static void prvFillEnergy(CpuStatsTask_t *pxRecord, const TaskStatus_t *pxStatus,
+                          const CpuStatsHistory_t *pxPrevious)
+{
+  memset(pxRecord->ulProfileCycles, 0, sizeof(pxRecord->ulProfileCycles));
+  pxRecord->usWakeups = 0U;
+
+#if (configUSE_TASK_ENERGY_STATS == 1)
+  uint32_t ulWakes;
+  UBaseType_t x;
+
+  for (x = 0U; x < configENERGY_PROFILES; x++)
+  {
+    pxRecord->ulProfileCycles[x] = pxStatus->ulEnergyRunTime[x];
+    if (pxPrevious != NULL)
+    {
+      pxRecord->ulProfileCycles[x] -= pxPrevious->ulEnergyRunTime[x];
+    }
+  }
+
+  ulWakes = pxStatus->ulWakeCount;
+  if (pxPrevious != NULL)
+  {
+    ulWakes -= pxPrevious->ulWakeCount;
+  }
+  pxRecord->usWakeups = (ulWakes > 0xFFFFU) ? 0xFFFFU : (uint16_t) ulWakes;
+#else
+  (void) pxStatus;
+  (void) pxPrevious;
+#endif
+}
+
+/**
+  * @brief  Fill in the sleep figures of the header and the wake records that
+  *         fit after the task records.
+  * @param  xRoom Wake records there is room for.
+  * @retval Bytes of wake records written.
+  */
+static size_t prvFillWakes(CpuStatsHeader_t *pxHeader, CpuStatsWake_t *pxWake, size_t xRoom)
+{
+#if (configUSE_TICKLESS_IDLE == 2)
+  LowPowerWake_t xWakes[cpustatsMAX_WAKES];
+  LowPowerStats_t xStats;
+  size_t xCount;
+  size_t x;
+
+  xCount = xLowPowerTakeWakes(&xStats, xWakes, (xRoom < cpustatsMAX_WAKES) ? xRoom : cpustatsMAX_WAKES);
+
+  for (x = 0U; x < xCount; x++)
+  {
+    pxWake[x].ucIrq = (xWakes[x].ucIrq == lpWAKE_UNKNOWN) ? cpustatsWAKE_UNKNOWN : xWakes[x].ucIrq;
+    pxWake[x].ucReserved = 0U;
+    pxWake[x].usCount = xWakes[x].usCount;
+  }
+
+  pxHeader->ulStoppedUs = xStats.ulStoppedUs;
+  pxHeader->usStops = (xStats.ulStops > 0xFFFFU) ? 0xFFFFU : (uint16_t) xStats.ulStops;
+  pxHeader->usShallowSleeps = (xStats.ulShallowSleeps > 0xFFFFU) ? 0xFFFFU : (uint16_t) xStats.ulShallowSleeps;
+  pxHeader->ucWakeCount = (uint8_t) xCount;
+
+  return xCount * sizeof(CpuStatsWake_t);
+#else
+  (void) pxWake;
+  (void) xRoom;
+
+  pxHeader->ulStoppedUs = 0U;
+  pxHeader->usStops = 0U;
+  pxHeader->usShallowSleeps = 0U;
+  pxHeader->ucWakeCount = 0U;
+
+  return 0U;
+#endif
+}
+
+#if (configUSE_SWITCH_PROFILER == 1)
+/**
+  * @brief  Format "min/max" of a profile, "-/-" while it has no samples.
+  * @retval None
+  */
+static void prvFormatPair(char *pcOut, size_t xLength, const SwitchProfile_t *pxProfile)
+{
+  if (pxProfile->ulCount == 0U)
+  {
+    (void) xFmtFormat(pcOut, xLength, "-/-");
+  }
+  else
+  {
+    (void) xFmtFormat(pcOut, xLength, "%lu/%lu", (unsigned long) pxProfile->ulMin,
+                      (unsigned long) pxProfile->ulMax);
+  }
+}
+#endif /* configUSE_SWITCH_PROFILER */
+
+#endif /* configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY */
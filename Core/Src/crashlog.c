@@ -0,0 +1,578 @@
+/**
+  ******************************************************************************
+  * @file           : crashlog.c
+  * @brief          : RAM ring in .noinit, flushed at boot to a wear levelled
+  *                   pair of flash sectors.
+  ******************************************************************************
+  * The ring is guarded by masking interrupts up to
+  * configMAX_SYSCALL_INTERRUPT_PRIORITY, like the log ring, and an append is
+  * one or two memcpy() calls.  Its header carries a magic word and its
+  * complement, which a power cycle leaves random, so the boot only trusts
+  * what a reset left behind.
+  *
+  * A flash sector starts with crashlogSECTOR_MAGIC and a generation that
+  * grows by one at each erase; the sector with the higher generation takes
+  * the appends.  Records are programmed a word at a time, magic first, so a
+  * record torn by a power loss fails its CRC, and an unreadable length ends
+  * the sector, which makes the next flush move to the other one.  Flash is
+  * only written from vCrashLogInit(), before anything else runs, since an
+  * erase or a program stalls every fetch from flash until it is done.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "main.h"
+#include "crashlog.h"
+#include "crc.h"
+#include "fmt.h"
+#include "log.h"
+#include "periodic.h"
+
+#if ((crashlogRAM_SIZE & (crashlogRAM_SIZE - 1U)) != 0U) || (crashlogRAM_SIZE < 64U)
+#error crashlogRAM_SIZE must be a power of two of at least 64
+#endif
+
+/* Private define ------------------------------------------------------------*/
+
+/* Sectors 10 and 11 of the 1 MB part, left out of FLASH by the linker. */
+#define crashlogSECTOR_SIZE         0x20000UL
+#define crashlogSECTOR_COUNT        2U
+
+#define crashlogSECTOR_MAGIC        0x53474C43UL  /* "CLGS" */
+#define crashlogRAM_MAGIC           0x4D52474CUL  /* "LGRM" */
+#define crashlogRAM_CHECK           0xB2ADB8B3UL  /* ~crashlogRAM_MAGIC */
+#define crashlogERASED              0xFFFFFFFFUL
+
+/* Words of a sector header, and of a record header. */
+#define crashlogSECTOR_HEADER_WORDS 2U
+#define crashlogRECORD_WORDS        (sizeof(CrashLogRecord_t) / sizeof(uint32_t))
+
+/* Text bytes logged per run of the report job, and its period. */
+#define crashlogREPORT_CHUNK        64U
+#define crashlogREPORT_PERIOD_MS    20U
+
+/* Private types -------------------------------------------------------------*/
+
+/**
+  * @brief  The RAM ring.  xRecord is laid out right before the text so that
+  *         the pair is programmed, and checked, as one run of words.
+  */
+typedef struct
+{
+  uint32_t ulMagic;
+  uint32_t ulMagicCheck;                      /*!< crashlogRAM_CHECK.         */
+  uint32_t ulHead;                            /*!< Bytes appended, capped on wrap. */
+  uint32_t ulReason;
+  uint32_t ulArg;
+  CrashLogRecord_t xRecord;
+  uint32_t ulText[crashlogRAM_SIZE / sizeof(uint32_t)];
+} CrashLogRam_t;
+
+/* Private variables ---------------------------------------------------------*/
+static CrashLogRam_t xCrashRam __attribute__((section(".noinit")));
+
+static const uint32_t ulSectorBase[crashlogSECTOR_COUNT] = { 0x080C0000UL, 0x080E0000UL };
+static const uint32_t ulSectorNumber[crashlogSECTOR_COUNT] = { FLASH_SECTOR_10, FLASH_SECTOR_11 };
+
+static const char *const pcReasonNames[crashlogREASON_COUNT] =
+{
+  "reset", "error handler", "assert", "stack overflow", "heap corrupted", "fpu misuse", "fault", "watchdog"
+};
+
+/* Whether the ring may be appended to; cleared by the startup code. */
+static BaseType_t xReady = pdFALSE;
+
+/* Found by prvScan(): the sector appended to, or crashlogSECTOR_COUNT for
+   none, its generation, where the next record goes, and the newest record. */
+static uint32_t ulActive = crashlogSECTOR_COUNT;
+static uint32_t ulGeneration = 0U;
+static uint32_t ulWriteAddress = 0U;
+static uint32_t ulLastSequence = 0U;
+static const CrashLogRecord_t *pxLatest = NULL;
+
+static uint32_t ulResetFlags = 0U;
+static BaseType_t xFlushed = pdFALSE;
+
+/* Report state: whether its first lines are out, the text logged so far,
+   and whether the log is being replayed, which must not land in the ring
+   again. */
+static PeriodicJob_t xReportJob;
+static BaseType_t xReportStarted = pdFALSE;
+static size_t xReportDone = 0U;
+static volatile BaseType_t xReplaying = pdFALSE;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvScan(void);
+static uint32_t prvWalk(uint32_t ulSector);
+static void prvFlush(void);
+static BaseType_t prvRotate(void);
+static BaseType_t prvProgram(uint32_t ulAddress, const uint32_t *pulWords, size_t xCount);
+static void prvLinearise(uint8_t *pucRing, size_t xRotate);
+static void prvReverse(uint8_t *pucStart, uint8_t *pucEnd);
+static void prvResetRam(void);
+static void prvReportJob(void *pvParameter);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Write what the last run left in the ring to flash and start a
+  *         fresh ring.  Call once, first thing after HAL_Init().
+  * @note   Takes a second or two when a sector has to be erased.
+  * @retval None
+  */
+void vCrashLogInit(void)
+{
+  ulResetFlags = RCC->CSR;
+  RCC->CSR |= RCC_CSR_RMVF;
+
+  prvScan();
+
+  /* The IWDG bit without a panic means the supervisor itself was starved. */
+  if ((xCrashRam.ulMagic == crashlogRAM_MAGIC) && (xCrashRam.ulMagicCheck == crashlogRAM_CHECK) &&
+      (xCrashRam.ulReason == crashlogREASON_NONE) && ((ulResetFlags & RCC_CSR_IWDGRSTF) != 0U))
+  {
+    xCrashRam.ulReason = crashlogREASON_WATCHDOG;
+    xCrashRam.ulArg = 0U;
+  }
+
+  if ((xCrashRam.ulMagic == crashlogRAM_MAGIC) && (xCrashRam.ulMagicCheck == crashlogRAM_CHECK) &&
+      ((xCrashRam.ulReason != crashlogREASON_NONE) || (xCrashRam.ulHead != 0U)))
+  {
+    prvFlush();
+  }
+
+  prvResetRam();
+  xReady = pdTRUE;
+}
+
+/**
+  * @brief  Append bytes to the ring, pushing out the oldest.
+  * @note   May be called from an interrupt at or below
+  *         configMAX_SYSCALL_INTERRUPT_PRIORITY.
+  * @param  pvData  Bytes to keep.
+  * @param  xLength Number of bytes; only the last crashlogRAM_SIZE are kept.
+  * @retval None
+  */
+void vCrashLogAppend(const void *pvData, size_t xLength)
+{
+  const uint8_t *pucData = (const uint8_t *) pvData;
+  uint8_t *pucRing = (uint8_t *) xCrashRam.ulText;
+  UBaseType_t uxSavedInterruptStatus;
+  uint32_t ulOffset;
+  size_t xFirst;
+
+  if ((xReady == pdFALSE) || (xReplaying != pdFALSE) || (xLength == 0U))
+  {
+    return;
+  }
+
+  if (xLength > crashlogRAM_SIZE)
+  {
+    pucData += xLength - crashlogRAM_SIZE;
+    xLength = crashlogRAM_SIZE;
+  }
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  ulOffset = xCrashRam.ulHead & (crashlogRAM_SIZE - 1U);
+  xFirst = crashlogRAM_SIZE - ulOffset;
+  if (xFirst > xLength)
+  {
+    xFirst = xLength;
+  }
+  memcpy(&pucRing[ulOffset], pucData, xFirst);
+  memcpy(&pucRing[0], &pucData[xFirst], xLength - xFirst);
+
+  /* Kept between one and two ring sizes once it wraps, so it neither
+     overflows nor loses the offset. */
+  xCrashRam.ulHead += xLength;
+  if (xCrashRam.ulHead >= (2U * crashlogRAM_SIZE))
+  {
+    xCrashRam.ulHead -= crashlogRAM_SIZE;
+  }
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/**
+  * @brief  Note why the system cannot go on and reset, or stop while a
+  *         debugger is attached.
+  * @note   The first reason since boot is kept; one panic often causes
+  *         another on the way down.
+  * @param  ulReason One of the crashlogREASON_* codes.
+  * @param  ulArg    Reason specific.
+  * @retval None
+  */
+void vCrashLogPanic(uint32_t ulReason, uint32_t ulArg)
+{
+  __disable_irq();
+
+  if ((xCrashRam.ulMagic != crashlogRAM_MAGIC) || (xCrashRam.ulMagicCheck != crashlogRAM_CHECK))
+  {
+    prvResetRam();
+  }
+  if (xCrashRam.ulReason == crashlogREASON_NONE)
+  {
+    xCrashRam.ulReason = ulReason;
+    xCrashRam.ulArg = ulArg;
+  }
+
+#if (crashlogRESET_ON_PANIC == 1)
+  if ((CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk) == 0U)
+  {
+    NVIC_SystemReset();
+  }
+#endif
+
+  for (;;)
+  {
+  }
+}
+
+/**
+  * @brief  configASSERT() failed: keep the file and line, then panic.
+  * @param  pcFile __FILE__ of the assertion.
+  * @param  ulLine __LINE__ of the assertion.
+  * @retval None
+  */
+void vCrashLogAssert(const char *pcFile, uint32_t ulLine)
+{
+  const char *pcName;
+  char cLine[64];
+  size_t xLength;
+
+  taskDISABLE_INTERRUPTS();
+
+  pcName = strrchr(pcFile, '/');
+  pcName = (pcName != NULL) ? &pcName[1] : pcFile;
+  xLength = xFmtFormat(cLine, sizeof(cLine), "assert %s:%lu\n\r", pcName, (unsigned long) ulLine);
+  vCrashLogAppend(cLine, xLength);
+
+  vCrashLogPanic(crashlogREASON_ASSERT, ulLine);
+}
+
+/**
+  * @brief  Newest intact record in flash.
+  * @retval The record, its text following it, or NULL if there is none.
+  */
+const CrashLogRecord_t *pxCrashLogLatest(void)
+{
+  return pxLatest;
+}
+
+/**
+  * @brief  Reset flags the boot found, RCC_CSR_*RSTF, since vCrashLogInit()
+  *         clears them.
+  * @retval RCC->CSR as it was.
+  */
+uint32_t ulCrashLogGetResetFlags(void)
+{
+  return ulResetFlags;
+}
+
+/**
+  * @brief  Log the reset flags and the record written at boot, if any, once
+  *         the scheduler has started.
+  * @retval Result of xPeriodicJobStart().
+  */
+BaseType_t xCrashLogReportStart(void)
+{
+  return xPeriodicJobStart(&xReportJob, prvReportJob, NULL, pdMS_TO_TICKS(crashlogREPORT_PERIOD_MS), 0);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Find the sector to append to, where, and the newest record.
+  * @retval None
+  */
+static void prvScan(void)
+{
+  const uint32_t *pulHeader;
+  uint32_t ulSector;
+
+  for (ulSector = 0U; ulSector < crashlogSECTOR_COUNT; ulSector++)
+  {
+    pulHeader = (const uint32_t *) ulSectorBase[ulSector];
+    if ((pulHeader[0] == crashlogSECTOR_MAGIC) &&
+        ((ulActive == crashlogSECTOR_COUNT) || (pulHeader[1] > ulGeneration)))
+    {
+      ulActive = ulSector;
+      ulGeneration = pulHeader[1];
+    }
+  }
+
+  /* The older sector first, so that the newest record is the last found. */
+  for (ulSector = 0U; ulSector < crashlogSECTOR_COUNT; ulSector++)
+  {
+    if ((ulSector != ulActive) && (*(const uint32_t *) ulSectorBase[ulSector] == crashlogSECTOR_MAGIC))
+    {
+      (void) prvWalk(ulSector);
+    }
+  }
+  if (ulActive != crashlogSECTOR_COUNT)
+  {
+    ulWriteAddress = prvWalk(ulActive);
+  }
+}
+
+/**
+  * @brief  Step over the records of a sector, noting each intact one.
+  * @retval Address after the last record, or the end of the sector if the
+  *         rest cannot be appended to.
+  */
+static uint32_t prvWalk(uint32_t ulSector)
+{
+  uint32_t ulAddress = ulSectorBase[ulSector] + (crashlogSECTOR_HEADER_WORDS * sizeof(uint32_t));
+  uint32_t ulEnd = ulSectorBase[ulSector] + crashlogSECTOR_SIZE;
+  const CrashLogRecord_t *pxRecord;
+  uint32_t ulWords;
+
+  while ((ulAddress + sizeof(CrashLogRecord_t)) <= ulEnd)
+  {
+    pxRecord = (const CrashLogRecord_t *) ulAddress;
+    if (pxRecord->ulMagic == crashlogERASED)
+    {
+      return ulAddress;
+    }
+    if ((pxRecord->ulMagic != crashlogRECORD_MAGIC) || (pxRecord->ulLength > crashlogRAM_SIZE))
+    {
+      break;
+    }
+
+    ulWords = (uint32_t) crashlogRECORD_WORDS + ((pxRecord->ulLength + 3U) / 4U);
+    if ((ulAddress + (ulWords * sizeof(uint32_t))) > ulEnd)
+    {
+      break;
+    }
+
+    if (ulCrcComputeWords(&pxRecord->ulSequence, ulWords - 2U) == pxRecord->ulCrc)
+    {
+      pxLatest = pxRecord;
+      if (pxRecord->ulSequence > ulLastSequence)
+      {
+        ulLastSequence = pxRecord->ulSequence;
+      }
+    }
+
+    ulAddress += ulWords * sizeof(uint32_t);
+  }
+
+  return ulEnd;
+}
+
+/**
+  * @brief  Program the ring, oldest byte first, as the next record.
+  * @retval None
+  */
+static void prvFlush(void)
+{
+  CrashLogRecord_t *pxRecord = &xCrashRam.xRecord;
+  uint8_t *pucRing = (uint8_t *) xCrashRam.ulText;
+  size_t xLength;
+  size_t xWords;
+
+  if (xCrashRam.ulHead >= crashlogRAM_SIZE)
+  {
+    xLength = crashlogRAM_SIZE;
+    prvLinearise(pucRing, xCrashRam.ulHead & (crashlogRAM_SIZE - 1U));
+  }
+  else
+  {
+    xLength = xCrashRam.ulHead;
+    memset(&pucRing[xLength], 0, ((xLength + 3U) & ~3U) - xLength);
+  }
+
+  xWords = crashlogRECORD_WORDS + ((xLength + 3U) / 4U);
+
+  pxRecord->ulMagic = crashlogRECORD_MAGIC;
+  pxRecord->ulSequence = ulLastSequence + 1U;
+  pxRecord->ulReason = (xCrashRam.ulReason < crashlogREASON_COUNT) ? xCrashRam.ulReason : crashlogREASON_NONE;
+  pxRecord->ulArg = xCrashRam.ulArg;
+  pxRecord->ulResetFlags = ulResetFlags;
+  pxRecord->ulLength = (uint32_t) xLength;
+  pxRecord->ulCrc = ulCrcComputeWords(&pxRecord->ulSequence, xWords - 2U);
+
+  if ((ulActive == crashlogSECTOR_COUNT) ||
+      ((ulWriteAddress + (xWords * sizeof(uint32_t))) > (ulSectorBase[ulActive] + crashlogSECTOR_SIZE)))
+  {
+    if (prvRotate() != pdPASS)
+    {
+      return;
+    }
+  }
+
+  HAL_FLASH_Unlock();
+  __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR |
+                         FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+  if (prvProgram(ulWriteAddress, (const uint32_t *) pxRecord, xWords) == pdPASS)
+  {
+    pxLatest = (const CrashLogRecord_t *) ulWriteAddress;
+    ulLastSequence = pxRecord->ulSequence;
+    xFlushed = pdTRUE;
+  }
+  HAL_FLASH_Lock();
+
+  /* Whatever happened, the rest of this sector is no longer known blank. */
+  ulWriteAddress += xWords * sizeof(uint32_t);
+}
+
+/**
+  * @brief  Erase the sector not in use and make it the one appended to.
+  * @note   Its records go, the other sector's stay.
+  * @retval pdPASS, or pdFAIL if the flash would not erase or program.
+  */
+static BaseType_t prvRotate(void)
+{
+  FLASH_EraseInitTypeDef xErase;
+  uint32_t ulSectorError;
+  uint32_t ulHeader[crashlogSECTOR_HEADER_WORDS];
+  uint32_t ulNext;
+  BaseType_t xReturn = pdFAIL;
+
+  ulNext = (ulActive == 0U) ? 1U : 0U;
+
+  xErase.TypeErase = FLASH_TYPEERASE_SECTORS;
+  xErase.Banks = FLASH_BANK_1;
+  xErase.Sector = ulSectorNumber[ulNext];
+  xErase.NbSectors = 1U;
+  xErase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+  ulHeader[0] = crashlogSECTOR_MAGIC;
+  ulHeader[1] = ulGeneration + 1U;
+
+  HAL_FLASH_Unlock();
+  __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR |
+                         FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+  if ((HAL_FLASHEx_Erase(&xErase, &ulSectorError) == HAL_OK) &&
+      (prvProgram(ulSectorBase[ulNext], ulHeader, crashlogSECTOR_HEADER_WORDS) == pdPASS))
+  {
+    ulActive = ulNext;
+    ulGeneration = ulHeader[1];
+    ulWriteAddress = ulSectorBase[ulNext] + sizeof(ulHeader);
+    xReturn = pdPASS;
+  }
+  HAL_FLASH_Lock();
+
+  return xReturn;
+}
+
+/**
+  * @brief  Program words one at a time, in order.
+  * @note   Called with the flash unlocked.
+  * @retval pdPASS, or pdFAIL at the first word that failed.
+  */
+static BaseType_t prvProgram(uint32_t ulAddress, const uint32_t *pulWords, size_t xCount)
+{
+  size_t xIndex;
+
+  for (xIndex = 0U; xIndex < xCount; xIndex++)
+  {
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, ulAddress + (xIndex * sizeof(uint32_t)),
+                          pulWords[xIndex]) != HAL_OK)
+    {
+      return pdFAIL;
+    }
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Rotate the full ring left in place, so its oldest byte comes
+  *         first.
+  * @param  xRotate Offset of the oldest byte.
+  * @retval None
+  */
+static void prvLinearise(uint8_t *pucRing, size_t xRotate)
+{
+  if (xRotate != 0U)
+  {
+    prvReverse(&pucRing[0], &pucRing[xRotate]);
+    prvReverse(&pucRing[xRotate], &pucRing[crashlogRAM_SIZE]);
+    prvReverse(&pucRing[0], &pucRing[crashlogRAM_SIZE]);
+  }
+}
+
+/**
+  * @brief  Reverse the bytes from pucStart up to pucEnd.
+  * @retval None
+  */
+static void prvReverse(uint8_t *pucStart, uint8_t *pucEnd)
+{
+  uint8_t ucByte;
+
+  while (pucStart < pucEnd)
+  {
+    pucEnd--;
+    ucByte = *pucStart;
+    *pucStart = *pucEnd;
+    *pucEnd = ucByte;
+    pucStart++;
+  }
+}
+
+/**
+  * @brief  Empty the ring and mark it as written by this run.
+  * @retval None
+  */
+static void prvResetRam(void)
+{
+  xCrashRam.ulHead = 0U;
+  xCrashRam.ulReason = crashlogREASON_NONE;
+  xCrashRam.ulArg = 0U;
+  xCrashRam.ulMagic = crashlogRAM_MAGIC;
+  xCrashRam.ulMagicCheck = crashlogRAM_CHECK;
+}
+
+/**
+  * @brief  Log "crashlog: reset flags <csr>", then the record written at
+  *         boot a chunk per run, as far as the log ring takes it, and stop.
+  * @param  pvParameter Unused.
+  * @retval None
+  */
+static void prvReportJob(void *pvParameter)
+{
+  const char *pcText;
+  size_t xChunk;
+
+  (void) pvParameter;
+
+  if (xReportStarted == pdFALSE)
+  {
+    xReportStarted = pdTRUE;
+    (void) xLogPrintf("crashlog: reset flags 0x%08lx\n\r", (unsigned long) ulResetFlags);
+    if ((xFlushed == pdFALSE) || (pxLatest == NULL))
+    {
+      (void) xPeriodicJobStop(&xReportJob);
+      return;
+    }
+    (void) xLogPrintf("crashlog: record %lu, %s 0x%08lx, %lu bytes\n\r", (unsigned long) pxLatest->ulSequence,
+                      pcReasonNames[pxLatest->ulReason], (unsigned long) pxLatest->ulArg,
+                      (unsigned long) pxLatest->ulLength);
+  }
+
+  pcText = (const char *) &pxLatest[1];
+  xReplaying = pdTRUE;
+  while (xReportDone < pxLatest->ulLength)
+  {
+    xChunk = pxLatest->ulLength - xReportDone;
+    if (xChunk > crashlogREPORT_CHUNK)
+    {
+      xChunk = crashlogREPORT_CHUNK;
+    }
+    if (xLogWrite(&pcText[xReportDone], xChunk) == 0U)
+    {
+      /* The log ring is full; try again next period. */
+      xReplaying = pdFALSE;
+      return;
+    }
+    xReportDone += xChunk;
+  }
+  xReplaying = pdFALSE;
+
+  (void) xLogPrintf("\n\rcrashlog: end of record %lu\n\r", (unsigned long) pxLatest->ulSequence);
+  (void) xPeriodicJobStop(&xReportJob);
+}
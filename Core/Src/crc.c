@@ -0,0 +1,359 @@
+/**
+  ******************************************************************************
+  * @file           : crc.c
+  * @brief          : CRC-32 service on the CRC calculation unit.
+  ******************************************************************************
+  * There is no HAL CRC driver in this tree, and the unit is three registers,
+  * so it is driven directly.  The CPU path resets the unit and writes the
+  * words with interrupts masked, so a checksum is never mixed with another
+  * caller's.  The DMA path runs a memory to memory transfer on DMA2 Stream2,
+  * words from the buffer to the fixed address of CRC->DR, under a mutex, and
+  * marks the unit taken while it does so that the CPU path falls back to the
+  * nibble table in prvCrcSoftware() rather than reset it mid feed.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "crc.h"
+#include "irqtable.h"
+#include "dmabuf.h"
+
+/* Private define ------------------------------------------------------------*/
+
+/* Most words one transfer moves, NDTR being 16 bit. */
+#define crcMAX_DMA_WORDS            65535U
+
+/* Private variables ---------------------------------------------------------*/
+
+/* The polynomial applied to each top nibble, four bits at a time. */
+static const uint32_t ulNibbleTable[16] =
+{
+  0x00000000UL, 0x04C11DB7UL, 0x09823B6EUL, 0x0D4326D9UL, 0x130476DCUL, 0x17C56B6BUL, 0x1A864DB2UL, 0x1E475005UL,
+  0x2608EDB8UL, 0x22C9F00FUL, 0x2F8AD6D6UL, 0x2B4BCB61UL, 0x350C9B64UL, 0x31CD86D3UL, 0x3C8EA00AUL, 0x384FBDBDUL
+};
+
+static DMA_HandleTypeDef hdmaCrc;
+
+static StaticSemaphore_t xFeedBuffer;
+static SemaphoreHandle_t xFeed = NULL;
+
+/* Set while DMA feeds the unit; the CPU path must not touch it then. */
+static volatile BaseType_t xFeeding = pdFALSE;
+
+static TaskHandle_t xFeeder = NULL;
+static volatile BaseType_t xChunkDone = pdFALSE;
+static volatile BaseType_t xChunkFailed = pdFALSE;
+
+static volatile uint32_t ulSoftwareFallbacks = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t prvCrcHardware(const uint8_t *pucData, size_t xLength, BaseType_t *pxDone);
+static uint32_t prvCrcDma(const uint8_t *pucData, size_t xLength);
+static uint32_t prvCrcSoftware(uint32_t ulCrc, const uint8_t *pucData, size_t xLength);
+static uint32_t prvTailWord(const uint8_t *pucData, size_t xLength);
+static void prvChunkDone(DMA_HandleTypeDef *hdma);
+static void prvChunkError(DMA_HandleTypeDef *hdma);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Clock the unit and set up the DMA feed.  Call once, before the
+  *         scheduler starts; until then every checksum uses the CPU path.
+  * @retval pdPASS, or pdFAIL if the stream did not initialise.
+  */
+BaseType_t xCrcInit(void)
+{
+  __HAL_RCC_CRC_CLK_ENABLE();
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  hdmaCrc.Instance = DMA2_Stream2;
+  hdmaCrc.Init.Channel = DMA_CHANNEL_0;
+  hdmaCrc.Init.Direction = DMA_MEMORY_TO_MEMORY;
+  hdmaCrc.Init.PeriphInc = DMA_PINC_ENABLE;
+  hdmaCrc.Init.MemInc = DMA_MINC_DISABLE;
+  hdmaCrc.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+  hdmaCrc.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+  hdmaCrc.Init.Mode = DMA_NORMAL;
+  hdmaCrc.Init.Priority = DMA_PRIORITY_LOW;
+  hdmaCrc.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+  hdmaCrc.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+  hdmaCrc.Init.MemBurst = DMA_MBURST_SINGLE;
+  hdmaCrc.Init.PeriphBurst = DMA_PBURST_SINGLE;
+  if (HAL_DMA_Init(&hdmaCrc) != HAL_OK)
+  {
+    return pdFAIL;
+  }
+
+  hdmaCrc.XferCpltCallback = prvChunkDone;
+  hdmaCrc.XferErrorCallback = prvChunkError;
+
+  irqtableREQUIRE_KERNEL(DMA2_Stream2);
+  HAL_NVIC_SetPriority(DMA2_Stream2_IRQn, irqtablePRIORITY(DMA2_Stream2), 0U);
+  HAL_NVIC_EnableIRQ(DMA2_Stream2_IRQn);
+
+  xFeed = xSemaphoreCreateMutexStatic(&xFeedBuffer);
+
+  return pdPASS;
+}
+
+/**
+  * @brief  CRC-32/MPEG-2 of a buffer, as described in crc.h.
+  * @note   May be called from interrupts at or below
+  *         configMAX_SYSCALL_INTERRUPT_PRIORITY, with the scheduler suspended
+  *         and before it starts.
+  * @param  pvData  Bytes, at any alignment.
+  * @param  xLength Their number.
+  * @retval The checksum.
+  */
+uint32_t ulCrcCompute(const void *pvData, size_t xLength)
+{
+  const uint8_t *pucData = (const uint8_t *) pvData;
+  BaseType_t xDone;
+  uint32_t ulCrc;
+
+  if ((xLength >= crcDMA_THRESHOLD) && (xFeed != NULL) && ((((uint32_t) pucData) & 3U) == 0U) &&
+      (xPortIsInsideInterrupt() == pdFALSE) && (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) &&
+      (xDmaBufferIsReachable(pvData, xLength) != pdFALSE))
+  {
+    return prvCrcDma(pucData, xLength);
+  }
+
+  ulCrc = prvCrcHardware(pucData, xLength, &xDone);
+  if (xDone == pdFALSE)
+  {
+    ulSoftwareFallbacks++;
+    ulCrc = prvCrcSoftware(crcINITIAL, pucData, xLength);
+  }
+
+  return ulCrc;
+}
+
+/**
+  * @brief  CRC-32/MPEG-2 of whole words, for records built as words.
+  * @param  pulWords Words.
+  * @param  xCount   Their number.
+  * @retval The checksum, as ulCrcCompute() of the same bytes gives.
+  */
+uint32_t ulCrcComputeWords(const uint32_t *pulWords, size_t xCount)
+{
+  return ulCrcCompute(pulWords, xCount * sizeof(uint32_t));
+}
+
+/**
+  * @brief  Checksums computed in software because DMA was feeding the unit.
+  * @retval Count since boot.
+  */
+uint32_t ulCrcGetSoftwareFallbacks(void)
+{
+  return ulSoftwareFallbacks;
+}
+
+/**
+  * @brief  Whether DMA is feeding the unit.  STOP would freeze the feed.
+  * @retval pdTRUE if busy.
+  */
+BaseType_t xCrcIsBusy(void)
+{
+  return xFeeding;
+}
+
+/**
+  * @brief  DMA2 Stream2 handler body.
+  * @retval None
+  */
+void vCrcDmaIRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdmaCrc);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Feed the unit from the CPU with interrupts masked.
+  * @param  pxDone Set to pdFALSE if DMA holds the unit and nothing was done.
+  * @retval The checksum, if done.
+  */
+static uint32_t prvCrcHardware(const uint8_t *pucData, size_t xLength, BaseType_t *pxDone)
+{
+  UBaseType_t uxSavedInterruptStatus;
+  uint32_t ulWord;
+  uint32_t ulCrc = 0U;
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  if (xFeeding != pdFALSE)
+  {
+    *pxDone = pdFALSE;
+  }
+  else
+  {
+    /* The heap checks its headers before xCrcInit() runs. */
+    if ((RCC->AHB1ENR & RCC_AHB1ENR_CRCEN) == 0U)
+    {
+      __HAL_RCC_CRC_CLK_ENABLE();
+    }
+
+    CRC->CR = CRC_CR_RESET;
+    for (; xLength >= sizeof(uint32_t); xLength -= sizeof(uint32_t))
+    {
+      (void) memcpy(&ulWord, pucData, sizeof(ulWord));
+      CRC->DR = ulWord;
+      pucData += sizeof(uint32_t);
+    }
+    if (xLength != 0U)
+    {
+      CRC->DR = prvTailWord(pucData, xLength);
+    }
+    ulCrc = CRC->DR;
+    *pxDone = pdTRUE;
+  }
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+
+  return ulCrc;
+}
+
+/**
+  * @brief  Feed the unit by DMA, a chunk at a time, blocking the calling
+  *         task until each is done.
+  * @param  pucData Word aligned bytes outside CCM.
+  * @retval The checksum.
+  */
+static uint32_t prvCrcDma(const uint8_t *pucData, size_t xLength)
+{
+  UBaseType_t uxSavedInterruptStatus;
+  const uint8_t *pucNext = pucData;
+  size_t xWords = xLength / sizeof(uint32_t);
+  size_t xChunk;
+  uint32_t ulCrc;
+
+  (void) xSemaphoreTake(xFeed, portMAX_DELAY);
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+  CRC->CR = CRC_CR_RESET;
+  xFeeding = pdTRUE;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+
+  xFeeder = xTaskGetCurrentTaskHandle();
+  xChunkFailed = pdFALSE;
+
+  while ((xWords != 0U) && (xChunkFailed == pdFALSE))
+  {
+    xChunk = (xWords > crcMAX_DMA_WORDS) ? crcMAX_DMA_WORDS : xWords;
+    xChunkDone = pdFALSE;
+    if (HAL_DMA_Start_IT(&hdmaCrc, (uint32_t) pucNext, (uint32_t) &CRC->DR, (uint32_t) xChunk) != HAL_OK)
+    {
+      xChunkFailed = pdTRUE;
+      break;
+    }
+    while (xChunkDone == pdFALSE)
+    {
+      (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    pucNext += xChunk * sizeof(uint32_t);
+    xWords -= xChunk;
+  }
+
+  if (xChunkFailed == pdFALSE)
+  {
+    if ((xLength % sizeof(uint32_t)) != 0U)
+    {
+      CRC->DR = prvTailWord(pucNext, xLength % sizeof(uint32_t));
+    }
+    ulCrc = CRC->DR;
+  }
+  else
+  {
+    ulSoftwareFallbacks++;
+    ulCrc = prvCrcSoftware(crcINITIAL, pucData, xLength);
+  }
+
+  xFeeding = pdFALSE;
+  xFeeder = NULL;
+  (void) xSemaphoreGive(xFeed);
+
+  return ulCrc;
+}
+
+/**
+  * @brief  The unit's computation, a nibble at a time.
+  * @param  ulCrc Value so far.
+  * @retval The checksum.
+  */
+static uint32_t prvCrcSoftware(uint32_t ulCrc, const uint8_t *pucData, size_t xLength)
+{
+  uint32_t ulWord;
+  uint32_t ulNibble;
+
+  while (xLength != 0U)
+  {
+    if (xLength >= sizeof(uint32_t))
+    {
+      (void) memcpy(&ulWord, pucData, sizeof(ulWord));
+      pucData += sizeof(uint32_t);
+      xLength -= sizeof(uint32_t);
+    }
+    else
+    {
+      ulWord = prvTailWord(pucData, xLength);
+      xLength = 0U;
+    }
+
+    ulCrc ^= ulWord;
+    for (ulNibble = 0U; ulNibble < 8U; ulNibble++)
+    {
+      ulCrc = (ulCrc << 4) ^ ulNibbleTable[ulCrc >> 28];
+    }
+  }
+
+  return ulCrc;
+}
+
+/**
+  * @brief  The last one to three bytes as a word, padded with zeros.
+  * @retval The word.
+  */
+static uint32_t prvTailWord(const uint8_t *pucData, size_t xLength)
+{
+  uint32_t ulWord = 0U;
+  size_t xIndex;
+
+  for (xIndex = 0U; xIndex < xLength; xIndex++)
+  {
+    ulWord |= (uint32_t) pucData[xIndex] << (8U * xIndex);
+  }
+
+  return ulWord;
+}
+
+/**
+  * @brief  A chunk is in the unit: wake the feeder.
+  * @retval None
+  */
+static void prvChunkDone(DMA_HandleTypeDef *hdma)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  (void) hdma;
+
+  xChunkDone = pdTRUE;
+  vTaskNotifyGiveFromISR(xFeeder, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  The stream stopped on an error: wake the feeder to finish in
+  *         software.
+  * @retval None
+  */
+static void prvChunkError(DMA_HandleTypeDef *hdma)
+{
+  xChunkFailed = pdTRUE;
+  prvChunkDone(hdma);
+}
@@ -0,0 +1,280 @@
+/**
+  ******************************************************************************
+  * @file           : deferred.c
+  * @brief          : Deferred interrupt work: handlers post a function and an
+  *                   argument, and a task per level runs them.
+  ******************************************************************************
+  * Each level has a ring with free running head and tail indexes, as in
+  * trace.c.  Posters claim a slot by advancing the head with LDREX/STREX,
+  * fill in the argument and then publish the slot by storing the function.
+  * The level's task is the only consumer: it copies up to deferredBATCH
+  * published slots, clears them and advances the tail once, then runs the
+  * copies, so the ring has room again before the first of them starts.  A
+  * slot claimed but not yet published stops the batch there, and the
+  * poster's notification brings the task back for it.
+  *
+  * A wake flag per level coalesces the notifications.  The first post to
+  * find it clear sets it and notifies; the task clears it before it looks at
+  * the ring, so a post that lands after the task last looked always finds it
+  * clear, and no post is left waiting for a wake that never comes.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "deferred.h"
+#include "stm32f4xx.h"
+#include "taskreg.h"
+
+#if (configUSE_TASK_NOTIFICATIONS == 1)
+
+#if ((deferredRING_LENGTH & (deferredRING_LENGTH - 1U)) != 0U) || (deferredRING_LENGTH > 256U)
+#error deferredRING_LENGTH must be a power of two, at most 256
+#endif
+
+#if (deferredBATCH < 1U) || (deferredBATCH > deferredRING_LENGTH)
+#error deferredBATCH must be 1 to deferredRING_LENGTH
+#endif
+
+/* Bottom halves may allocate, and a heap user at the ceiling could take a
+   time slice from another inside the heap. */
+#if (configHEAP_LOCK_CEILING > 0) && (deferredPRIORITY_HIGH >= configHEAP_LOCK_CEILING)
+#error deferredPRIORITY_HIGH must be below configHEAP_LOCK_CEILING
+#endif
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  DeferredFunction_t pxFunction;  /*!< NULL until the slot is published.      */
+  void *pvArg;
+} DeferredItem_t;
+
+typedef struct
+{
+  DeferredItem_t xItems[deferredRING_LENGTH];
+  uint32_t ulHead;              /*!< Next slot to claim.                       */
+  uint32_t ulTail;              /*!< Next slot to run, the task's alone.       */
+  uint32_t ulWakePending;       /*!< Set once the task has been notified.      */
+  DeferredStats_t xStats;
+} DeferredRing_t;
+
+/* Private variables ---------------------------------------------------------*/
+static volatile DeferredRing_t xRings[deferredLEVELS];
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvDeferredTask(void *pvParameters);
+static BaseType_t prvPost(DeferredLevel_t eLevel, DeferredFunction_t pxFunction, void *pvArg,
+                          BaseType_t *pxNotify);
+static BaseType_t prvRunBatch(volatile DeferredRing_t *pxRing);
+
+/* Registered tasks ----------------------------------------------------------*/
+TASK_REGISTER_IN(CCM, DEFERHI, prvDeferredTask, (void *) eDeferredHigh, deferredSTACK_DEPTH,
+                 deferredPRIORITY_HIGH);
+TASK_REGISTER_IN(CCM, DEFERLO, prvDeferredTask, (void *) eDeferredLow, deferredSTACK_DEPTH,
+                 deferredPRIORITY_LOW);
+
+static TaskHandle_t *const pxDeferredHandles[deferredLEVELS] =
+{
+  &xDEFERHIHandle,
+  &xDEFERLOHandle
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Post a bottom half from a task.
+  * @param  eLevel     Level, whose task runs it.
+  * @param  pxFunction Called with pvArg in the level's task.
+  * @param  pvArg      Must stay valid until the function has run.
+  * @note   Never blocks.  May be called before the scheduler starts; the
+  *         tasks run what was posted when they first run.
+  * @retval pdPASS, or pdFAIL if the level's ring was full.
+  */
+BaseType_t xDeferredPost(DeferredLevel_t eLevel, DeferredFunction_t pxFunction, void *pvArg)
+{
+  BaseType_t xNotify;
+
+  if (prvPost(eLevel, pxFunction, pvArg, &xNotify) != pdPASS)
+  {
+    return pdFAIL;
+  }
+
+  if ((xNotify != pdFALSE) && (*pxDeferredHandles[eLevel] != NULL))
+  {
+    (void) xTaskNotifyGive(*pxDeferredHandles[eLevel]);
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Post a bottom half from an interrupt.
+  * @param  pxHigherPriorityTaskWoken Set if the level's task should run on
+  *         exit.
+  * @retval pdPASS, or pdFAIL if the level's ring was full.
+  */
+BaseType_t xDeferredPostFromISR(DeferredLevel_t eLevel, DeferredFunction_t pxFunction, void *pvArg,
+                                BaseType_t *pxHigherPriorityTaskWoken)
+{
+  BaseType_t xNotify;
+
+  if (prvPost(eLevel, pxFunction, pvArg, &xNotify) != pdPASS)
+  {
+    return pdFAIL;
+  }
+
+  if ((xNotify != pdFALSE) && (*pxDeferredHandles[eLevel] != NULL))
+  {
+    vTaskNotifyGiveFromISR(*pxDeferredHandles[eLevel], pxHigherPriorityTaskWoken);
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Copy a level's counts.
+  * @retval None
+  */
+void vDeferredGetStats(DeferredLevel_t eLevel, DeferredStats_t *pxStats)
+{
+  configASSERT((UBaseType_t) eLevel < deferredLEVELS);
+
+  pxStats->ulRun = xRings[eLevel].xStats.ulRun;
+  pxStats->ulDropped = xRings[eLevel].xStats.ulDropped;
+  pxStats->ulWakes = xRings[eLevel].xStats.ulWakes;
+  pxStats->ulHighWater = xRings[eLevel].xStats.ulHighWater;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Run a level's bottom halves as they arrive, sleeping when there
+  *         are none.
+  * @param  pvParameters The level.
+  * @retval None
+  */
+static void prvDeferredTask(void *pvParameters)
+{
+  volatile DeferredRing_t *pxRing = &xRings[(UBaseType_t) pvParameters];
+
+  for (;;)
+  {
+    /* Clear the flag before looking, so a post from here on notifies. */
+    pxRing->ulWakePending = 0U;
+    __DMB();
+
+    while (prvRunBatch(pxRing) != pdFALSE)
+    {
+      taskYIELD();
+    }
+
+    (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    pxRing->xStats.ulWakes++;
+  }
+}
+
+/**
+  * @brief  Claim and publish a slot, then test and set the wake flag.
+  * @param  pxNotify Set if this post must notify the level's task.
+  * @retval pdPASS, or pdFAIL if the ring was full.
+  */
+static BaseType_t prvPost(DeferredLevel_t eLevel, DeferredFunction_t pxFunction, void *pvArg,
+                          BaseType_t *pxNotify)
+{
+  volatile DeferredRing_t *pxRing;
+  volatile DeferredItem_t *pxItem;
+  uint32_t ulHead;
+
+  configASSERT(((UBaseType_t) eLevel < deferredLEVELS) && (pxFunction != NULL));
+
+  pxRing = &xRings[eLevel];
+  *pxNotify = pdFALSE;
+
+  /* The exclusive monitor is cleared by any exception entry, so a post from
+     an interrupt that lands in the middle makes this one retry. */
+  do
+  {
+    ulHead = __LDREXW(&pxRing->ulHead);
+
+    if ((ulHead - pxRing->ulTail) >= deferredRING_LENGTH)
+    {
+      __CLREX();
+      pxRing->xStats.ulDropped++;
+      return pdFAIL;
+    }
+  } while (__STREXW(ulHead + 1U, &pxRing->ulHead) != 0U);
+
+  pxItem = &pxRing->xItems[ulHead & (deferredRING_LENGTH - 1U)];
+  pxItem->pvArg = pvArg;
+  __DMB();
+  pxItem->pxFunction = pxFunction;
+  __DMB();
+
+  do
+  {
+    if (__LDREXW(&pxRing->ulWakePending) != 0U)
+    {
+      __CLREX();
+      return pdPASS;
+    }
+  } while (__STREXW(1U, &pxRing->ulWakePending) != 0U);
+
+  *pxNotify = pdTRUE;
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Take up to deferredBATCH published slots off the ring and run
+  *         them.
+  * @retval pdTRUE if a full batch ran, so more may be waiting.
+  */
+static BaseType_t prvRunBatch(volatile DeferredRing_t *pxRing)
+{
+  DeferredItem_t xBatch[deferredBATCH];
+  volatile DeferredItem_t *pxItem;
+  uint32_t ulTail = pxRing->ulTail;
+  uint32_t ulWaiting = pxRing->ulHead - ulTail;
+  uint32_t ulCount = 0U;
+  uint32_t ul;
+
+  if (ulWaiting > pxRing->xStats.ulHighWater)
+  {
+    pxRing->xStats.ulHighWater = ulWaiting;
+  }
+
+  while ((ulCount < deferredBATCH) && (ulCount < ulWaiting))
+  {
+    pxItem = &pxRing->xItems[(ulTail + ulCount) & (deferredRING_LENGTH - 1U)];
+
+    /* Claimed, but its poster has not published it yet. */
+    if (pxItem->pxFunction == NULL)
+    {
+      break;
+    }
+
+    __DMB();
+    xBatch[ulCount].pxFunction = pxItem->pxFunction;
+    xBatch[ulCount].pvArg = pxItem->pvArg;
+    pxItem->pxFunction = NULL;
+    ulCount++;
+  }
+
+  if (ulCount == 0U)
+  {
+    return pdFALSE;
+  }
+
+  /* Hand the slots back before running anything. */
+  __DMB();
+  pxRing->ulTail = ulTail + ulCount;
+
+  for (ul = 0U; ul < ulCount; ul++)
+  {
+    xBatch[ul].pxFunction(xBatch[ul].pvArg);
+  }
+  pxRing->xStats.ulRun += ulCount;
+
+  return (ulCount == deferredBATCH) ? pdTRUE : pdFALSE;
+}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file           : dmabuf.c
+  * @brief          : Boot time check of the buffers declared with
+  *                   DMA_BUFFER_DEFINE().
+  ******************************************************************************
+  * The descriptors sit in .dma_registry, which the linker script brackets
+  * with __dma_registry_start and __dma_registry_end, in the same way as the
+  * task registry in taskreg.c.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "dmabuf.h"
+
+/* External variables --------------------------------------------------------*/
+extern const DmaBufferEntry_t __dma_registry_start[];
+extern const DmaBufferEntry_t __dma_registry_end[];
+
+/* Private variables ---------------------------------------------------------*/
+
+/* First registered buffer found out of reach, for the debugger. */
+static const DmaBufferEntry_t *volatile pxUnreachableDmaBuffer = NULL;
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Check every registered buffer, stopping on the first one in CCM.
+  * @note   Call once at boot, before any DMA is started.
+  * @retval None
+  */
+void vDmaBufferCheckAll(void)
+{
+  const DmaBufferEntry_t *pxEntry;
+
+  for (pxEntry = __dma_registry_start; pxEntry < __dma_registry_end; pxEntry++)
+  {
+    if (xDmaBufferIsReachable(pxEntry->pvBuffer, pxEntry->xLength) == pdFALSE)
+    {
+      pxUnreachableDmaBuffer = pxEntry;
+      configASSERT(pxUnreachableDmaBuffer == NULL);
+    }
+  }
+}
+
+/**
+  * @brief  Whether the DMA controllers can reach all of a buffer.
+  * @param  pvBuffer Start of the buffer.
+  * @param  xLength  Length in bytes.
+  * @retval pdTRUE, or pdFALSE if any of it is in CCM.
+  */
+BaseType_t xDmaBufferIsReachable(const void *pvBuffer, size_t xLength)
+{
+  uintptr_t uxStart = (uintptr_t) pvBuffer;
+  uintptr_t uxEnd = uxStart + xLength;
+
+  return ((uxEnd <= dmabufCCM_START) || (uxStart >= dmabufCCM_END)) ? pdTRUE : pdFALSE;
+}
@@ -0,0 +1,333 @@
+/**
+  ******************************************************************************
+  * @file           : dmacopy.c
+  * @brief          : Memory to memory copy service on DMA2 Stream1.
+  ******************************************************************************
+  * Only DMA2 can do memory to memory transfers, and only through its FIFO.
+  * Each copy uses the widest unit the two addresses and the length share,
+  * single beats so that no burst can cross a 1 KB boundary, and chunks of at
+  * most 65535 units, the next chunk started from the completion interrupt.
+  *
+  * A mutex hands the stream to one task at a time, and the interrupt gives
+  * that task a notification when the last chunk is done.  A stream error
+  * leaves the copy to the CPU in xDmaCopyWait(), so a copy never comes back
+  * short.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "dmacopy.h"
+#include "irqtable.h"
+#include "dmabuf.h"
+
+/* Private define ------------------------------------------------------------*/
+
+/* Most units the stream moves in one transfer, NDTR being 16 bit. */
+#define dmacopyMAX_UNITS            65535U
+
+/* Private variables ---------------------------------------------------------*/
+static DMA_HandleTypeDef hdmaCopy;
+
+static StaticSemaphore_t xEngineBuffer;
+static SemaphoreHandle_t xEngine = NULL;
+
+/* The copy in hand: its ends, the part still to start, and its unit. */
+static uint8_t *pucDest;
+static const uint8_t *pucSrc;
+static size_t xCopyLength;
+static size_t xDone;
+static uint32_t ulUnit = 0U;
+
+static TaskHandle_t xOwner = NULL;
+static volatile BaseType_t xRunning = pdFALSE;
+static volatile BaseType_t xFailed = pdFALSE;
+
+static volatile uint32_t ulTransfers = 0U;
+static volatile uint32_t ulErrors = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static BaseType_t prvSetUnit(uint32_t ulNewUnit);
+static void prvStartChunk(void);
+static void prvChunkDone(DMA_HandleTypeDef *hdma);
+static void prvChunkError(DMA_HandleTypeDef *hdma);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Set up DMA2 Stream1 for memory to memory copies.  Call once,
+  *         before the scheduler starts.
+  * @retval pdPASS, or pdFAIL if the stream did not initialise.
+  */
+BaseType_t xDmaCopyInit(void)
+{
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  xEngine = xSemaphoreCreateMutexStatic(&xEngineBuffer);
+
+  hdmaCopy.Instance = DMA2_Stream1;
+  hdmaCopy.Init.Channel = DMA_CHANNEL_0;
+  hdmaCopy.Init.Direction = DMA_MEMORY_TO_MEMORY;
+  hdmaCopy.Init.PeriphInc = DMA_PINC_ENABLE;
+  hdmaCopy.Init.MemInc = DMA_MINC_ENABLE;
+  hdmaCopy.Init.Mode = DMA_NORMAL;
+  hdmaCopy.Init.Priority = DMA_PRIORITY_LOW;
+  hdmaCopy.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+  hdmaCopy.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+  hdmaCopy.Init.MemBurst = DMA_MBURST_SINGLE;
+  hdmaCopy.Init.PeriphBurst = DMA_PBURST_SINGLE;
+  if (prvSetUnit(4U) != pdPASS)
+  {
+    return pdFAIL;
+  }
+
+  hdmaCopy.XferCpltCallback = prvChunkDone;
+  hdmaCopy.XferErrorCallback = prvChunkError;
+
+  irqtableREQUIRE_KERNEL(DMA2_Stream1);
+  HAL_NVIC_SetPriority(DMA2_Stream1_IRQn, irqtablePRIORITY(DMA2_Stream1), 0U);
+  HAL_NVIC_EnableIRQ(DMA2_Stream1_IRQn);
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Take the engine and start copying.
+  * @note   Returns as soon as the stream runs; neither buffer may be touched
+  *         until xDmaCopyWait() returns.  A copy that the stream would not
+  *         gain on, or could not make, is done here with memcpy().  The
+  *         buffers must not overlap.  Call from a task.
+  * @param  pvDest       Destination.
+  * @param  pvSrc        Source.
+  * @param  xLength      Bytes to copy.
+  * @param  xTicksToWait Time to wait for a copy of another task to finish.
+  * @retval pdPASS if started or done, pdFAIL if the engine stayed taken, in
+  *         which case nothing was copied and xDmaCopyWait() must not be called.
+  */
+BaseType_t xDmaCopyStart(void *pvDest, const void *pvSrc, size_t xLength, TickType_t xTicksToWait)
+{
+  uint32_t ulBits;
+  uint32_t ulNewUnit;
+
+  configASSERT(xEngine != NULL);
+
+  if (xSemaphoreTake(xEngine, xTicksToWait) != pdTRUE)
+  {
+    return pdFAIL;
+  }
+
+  if ((xLength < dmacopyTHRESHOLD) || (xDmaBufferIsReachable(pvDest, xLength) == pdFALSE) ||
+      (xDmaBufferIsReachable(pvSrc, xLength) == pdFALSE))
+  {
+    (void) memcpy(pvDest, pvSrc, xLength);
+    return pdPASS;
+  }
+
+  ulBits = (uint32_t) pvDest | (uint32_t) pvSrc | (uint32_t) xLength;
+  ulNewUnit = ((ulBits & 3U) == 0U) ? 4U : (((ulBits & 1U) == 0U) ? 2U : 1U);
+  if (prvSetUnit(ulNewUnit) != pdPASS)
+  {
+    (void) memcpy(pvDest, pvSrc, xLength);
+    ulErrors++;
+    return pdPASS;
+  }
+
+  pucDest = (uint8_t *) pvDest;
+  pucSrc = (const uint8_t *) pvSrc;
+  xCopyLength = xLength;
+  xDone = 0U;
+  xOwner = xTaskGetCurrentTaskHandle();
+  xFailed = pdFALSE;
+  xRunning = pdTRUE;
+  ulTransfers++;
+
+  taskENTER_CRITICAL();
+  prvStartChunk();
+  taskEXIT_CRITICAL();
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Wait for the copy started by xDmaCopyStart() and give the engine
+  *         back.
+  * @param  xTicksToWait Time to wait.
+  * @retval pdPASS once copied, pdFAIL on a timeout, when the copy carries on,
+  *         the engine stays taken and xDmaCopyWait() must be called again.
+  */
+BaseType_t xDmaCopyWait(TickType_t xTicksToWait)
+{
+  TimeOut_t xTimeOut;
+
+  vTaskSetTimeOutState(&xTimeOut);
+  while (xRunning != pdFALSE)
+  {
+    if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+    {
+      return pdFAIL;
+    }
+    (void) ulTaskNotifyTake(pdTRUE, xTicksToWait);
+  }
+
+  if (xFailed != pdFALSE)
+  {
+    /* The stream stopped part way; the CPU copies the lot again. */
+    (void) memcpy(pucDest, pucSrc, xCopyLength);
+    xFailed = pdFALSE;
+  }
+
+  xOwner = NULL;
+  (void) xSemaphoreGive(xEngine);
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Copy and wait, in place of memcpy() for large copies, freeing the
+  *         CPU for other tasks while the stream runs.
+  * @retval pvDest.
+  */
+void *pvDmaCopy(void *pvDest, const void *pvSrc, size_t xLength)
+{
+  (void) xDmaCopyStart(pvDest, pvSrc, xLength, portMAX_DELAY);
+  (void) xDmaCopyWait(portMAX_DELAY);
+
+  return pvDest;
+}
+
+/**
+  * @brief  Copies the stream has made.
+  * @retval Count since boot.
+  */
+uint32_t ulDmaCopyGetTransfers(void)
+{
+  return ulTransfers;
+}
+
+/**
+  * @brief  Copies the stream failed and the CPU made instead.
+  * @retval Count since boot.
+  */
+uint32_t ulDmaCopyGetErrors(void)
+{
+  return ulErrors;
+}
+
+/**
+  * @brief  Whether the stream is copying.  STOP would freeze it mid copy.
+  * @retval pdTRUE if busy.
+  */
+BaseType_t xDmaCopyIsBusy(void)
+{
+  return xRunning;
+}
+
+/**
+  * @brief  DMA2 Stream1 handler body.
+  * @retval None
+  */
+void vDmaCopyIRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdmaCopy);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Set the unit both sides of the stream move, if it changed.
+  * @param  ulNewUnit 1, 2 or 4 bytes.
+  * @retval pdPASS, or pdFAIL if the stream did not initialise.
+  */
+static BaseType_t prvSetUnit(uint32_t ulNewUnit)
+{
+  if (ulNewUnit == ulUnit)
+  {
+    return pdPASS;
+  }
+
+  hdmaCopy.Init.PeriphDataAlignment = (ulNewUnit == 4U) ? DMA_PDATAALIGN_WORD :
+                                      ((ulNewUnit == 2U) ? DMA_PDATAALIGN_HALFWORD : DMA_PDATAALIGN_BYTE);
+  hdmaCopy.Init.MemDataAlignment = (ulNewUnit == 4U) ? DMA_MDATAALIGN_WORD :
+                                   ((ulNewUnit == 2U) ? DMA_MDATAALIGN_HALFWORD : DMA_MDATAALIGN_BYTE);
+  if (HAL_DMA_Init(&hdmaCopy) != HAL_OK)
+  {
+    ulUnit = 0U;
+    return pdFAIL;
+  }
+
+  ulUnit = ulNewUnit;
+  return pdPASS;
+}
+
+/**
+  * @brief  Start the next chunk of the copy in hand.
+  * @note   Called with the stream's interrupt masked or from it.
+  * @retval None
+  */
+static void prvStartChunk(void)
+{
+  size_t xChunk = xCopyLength - xDone;
+
+  if (xChunk > (dmacopyMAX_UNITS * ulUnit))
+  {
+    xChunk = dmacopyMAX_UNITS * ulUnit;
+  }
+
+  if (HAL_DMA_Start_IT(&hdmaCopy, (uint32_t) &pucSrc[xDone], (uint32_t) &pucDest[xDone],
+                       (uint32_t) (xChunk / ulUnit)) != HAL_OK)
+  {
+    prvChunkError(&hdmaCopy);
+    return;
+  }
+
+  xDone += xChunk;
+}
+
+/**
+  * @brief  A chunk completed: start the next, or wake the owner.
+  * @retval None
+  */
+static void prvChunkDone(DMA_HandleTypeDef *hdma)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  (void) hdma;
+
+  if (xDone < xCopyLength)
+  {
+    prvStartChunk();
+    return;
+  }
+
+  xRunning = pdFALSE;
+  if (xOwner != NULL)
+  {
+    vTaskNotifyGiveFromISR(xOwner, &xHigherPriorityTaskWoken);
+  }
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  The stream stopped on an error: wake the owner to copy on the CPU.
+  * @retval None
+  */
+static void prvChunkError(DMA_HandleTypeDef *hdma)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  (void) hdma;
+
+  ulErrors++;
+  xFailed = pdTRUE;
+  xRunning = pdFALSE;
+  if (xOwner != NULL)
+  {
+    vTaskNotifyGiveFromISR(xOwner, &xHigherPriorityTaskWoken);
+  }
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
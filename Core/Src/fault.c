@@ -0,0 +1,322 @@
+/**
+  ******************************************************************************
+  * @file           : fault.c
+  * @brief          : Fault handlers that capture the faulting context and
+  *                   hand it to the crash log.
+  ******************************************************************************
+  * The four handlers are naked: the first instructions pick the stack the
+  * frame was pushed to from EXC_RETURN, push r4 to r11 below it and branch to
+  * prvFaultCapture() with all three, before any compiled prologue can move
+  * the stack.  They replace the spinning handlers CubeMX used to put in
+  * stm32f4xx_it.c, whose generation Lab4.ioc now turns off.
+  *
+  * Anything read through a captured pointer is first checked to lie in SRAM
+  * or CCM, since a bus fault inside the handler would lock the core up.
+  * Capture runs on the main stack; an overflowed main stack faults again and
+  * locks up, which the watchdog ends.
+  *
+  * A task's stack overflowing into the MPU stack guard (configUSE_MPU_STACK_
+  * GUARD) arrives as a MemManage fault on a data access or on exception
+  * stacking, the only writes the guard forbids.  It is dumped like any other
+  * fault and then reported as crashlogREASON_STACK_OVERFLOW, as the kernel's
+  * hook would have.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <string.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "fault.h"
+#include "crashlog.h"
+#include "fmt.h"
+#include "stackcheck.h"
+
+/* Private define ------------------------------------------------------------*/
+#define faultMAGIC                  0x544C5546UL  /* "FULT" */
+
+/* Words of stack per line of the dump. */
+#define faultDUMP_WORDS             8U
+
+/* MemManage causes the stack guard can raise. */
+#define faultGUARD_CAUSES           (SCB_CFSR_DACCVIOL_Msk | SCB_CFSR_MSTKERR_Msk | SCB_CFSR_MLSPERR_Msk)
+
+/* Private variables ---------------------------------------------------------*/
+static FaultRecord_t xFaultRecord __attribute__((section(".noinit")));
+
+static const char *const pcFaultNames[] =
+{
+  "HardFault", "MemManage", "BusFault", "UsageFault"
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvFaultCapture(uint32_t *pulFrame, uint32_t ulExcReturn, const uint32_t *pulR4ToR11)
+  __attribute__((used, noreturn));
+static BaseType_t prvIsRam(uint32_t ulAddress, uint32_t ulBytes);
+static void prvFaultDump(void);
+static void prvFaultLine(const char *pcFormat, ...) fmtCHECK(1, 2);
+#if (configUSE_MPU_STACK_GUARD == 1)
+static BaseType_t prvIsStackGuardHit(const FaultRecord_t *pxRecord);
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Enable the MemManage, BusFault and UsageFault handlers.
+  * @retval None
+  */
+void vFaultInit(void)
+{
+  SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk | SCB_SHCSR_USGFAULTENA_Msk;
+}
+
+/**
+  * @brief  What the last fault left, if a fault caused the last reset or any
+  *         reset since without a power cycle.
+  * @retval The record, or NULL.
+  */
+const FaultRecord_t *pxFaultGetLast(void)
+{
+  return (xFaultRecord.ulMagic == faultMAGIC) ? &xFaultRecord : NULL;
+}
+
+/**
+  * @brief  This function handles Hard fault interrupt.
+  */
+__attribute__((naked)) void HardFault_Handler(void)
+{
+  __asm volatile
+  (
+    "   tst lr, #4            \n"
+    "   ite eq                \n"
+    "   mrseq r0, msp         \n"
+    "   mrsne r0, psp         \n"
+    "   mov r1, lr            \n"
+    "   push {r4-r11}         \n"
+    "   mov r2, sp            \n"
+    "   b prvFaultCapture     \n"
+  );
+}
+
+/**
+  * @brief  This function handles Memory management fault.
+  */
+__attribute__((naked)) void MemManage_Handler(void)
+{
+  __asm volatile ("   b HardFault_Handler   \n");
+}
+
+/**
+  * @brief  This function handles Pre-fetch fault, memory access fault.
+  */
+__attribute__((naked)) void BusFault_Handler(void)
+{
+  __asm volatile ("   b HardFault_Handler   \n");
+}
+
+/**
+  * @brief  This function handles Undefined instruction or illegal state.
+  */
+__attribute__((naked)) void UsageFault_Handler(void)
+{
+  __asm volatile ("   b HardFault_Handler   \n");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Fill in xFaultRecord, dump it to the crash log and panic.
+  * @param  pulFrame    Exception frame, on the stack EXC_RETURN names.
+  * @param  ulExcReturn LR on entry.
+  * @param  pulR4ToR11  r4 to r11, as pushed by the handler.
+  * @retval None
+  */
+static void prvFaultCapture(uint32_t *pulFrame, uint32_t ulExcReturn, const uint32_t *pulR4ToR11)
+{
+  FaultRecord_t *pxRecord = &xFaultRecord;
+  TaskHandle_t xTask;
+  uint32_t ulWords;
+
+  __disable_irq();
+
+  memset(pxRecord, 0, sizeof(*pxRecord));
+  pxRecord->ulException = __get_IPSR();
+  pxRecord->ulExcReturn = ulExcReturn;
+  pxRecord->ulSp = (uint32_t) pulFrame;
+  memcpy(pxRecord->ulR4ToR11, pulR4ToR11, sizeof(pxRecord->ulR4ToR11));
+  pxRecord->ulCfsr = SCB->CFSR;
+  pxRecord->ulHfsr = SCB->HFSR;
+  pxRecord->ulMmfar = SCB->MMFAR;
+  pxRecord->ulBfar = SCB->BFAR;
+
+  if (prvIsRam((uint32_t) pulFrame, sizeof(pxRecord->ulFrame)) != pdFALSE)
+  {
+    memcpy(pxRecord->ulFrame, pulFrame, sizeof(pxRecord->ulFrame));
+
+    /* As much of the stack as lies in the same memory. */
+    for (ulWords = faultSTACK_WORDS; ulWords != 0U; ulWords--)
+    {
+      if (prvIsRam((uint32_t) pulFrame, ulWords * sizeof(uint32_t)) != pdFALSE)
+      {
+        break;
+      }
+    }
+    memcpy(pxRecord->ulStack, pulFrame, ulWords * sizeof(uint32_t));
+    pxRecord->ulStackWords = ulWords;
+  }
+
+  xTask = xTaskGetCurrentTaskHandle();
+  if ((xTask != NULL) && (prvIsRam((uint32_t) xTask, 4U) != pdFALSE))
+  {
+    (void) strncpy(pxRecord->cTaskName, pcTaskGetName(xTask), sizeof(pxRecord->cTaskName) - 1U);
+  }
+
+  pxRecord->ulMagic = faultMAGIC;
+
+  prvFaultDump();
+
+#if (configUSE_MPU_STACK_GUARD == 1)
+  if (prvIsStackGuardHit(pxRecord) != pdFALSE)
+  {
+    prvFaultLine("stack overflow %s\n\r", pxRecord->cTaskName);
+#if (INCLUDE_uxTaskGetStackHighWaterMark == 1)
+    xStackOverflowTask = xTask;
+#endif
+    vCrashLogPanic(crashlogREASON_STACK_OVERFLOW, (uint32_t) xTask);
+  }
+#endif
+
+  vCrashLogPanic(crashlogREASON_FAULT, pxRecord->ulFrame[6]);
+}
+
+#if (configUSE_MPU_STACK_GUARD == 1)
+/**
+  * @brief  Whether a task hit the stack guard, itself or through PendSV
+  *         saving its registers.  Stacking errors can only come from the
+  *         guard, the MPU allowing everything else; a data access violation
+  *         only if MMFAR lies in the guard where the task switch left it.
+  * @retval pdTRUE if it did.
+  */
+static BaseType_t prvIsStackGuardHit(const FaultRecord_t *pxRecord)
+{
+  uint32_t ulGuard;
+
+  if ((pxRecord->ulCfsr & faultGUARD_CAUSES) == 0U)
+  {
+    return pdFALSE;
+  }
+
+  if ((pxRecord->ulCfsr & SCB_CFSR_DACCVIOL_Msk) == 0U)
+  {
+    return pdTRUE;
+  }
+
+  MPU->RNR = portSTACK_GUARD_REGION;
+  ulGuard = MPU->RBAR & MPU_RBAR_ADDR_Msk;
+
+  return (((pxRecord->ulCfsr & SCB_CFSR_MMARVALID_Msk) != 0U) && (pxRecord->ulMmfar >= ulGuard) &&
+          ((pxRecord->ulMmfar - ulGuard) < portSTACK_GUARD_BYTES)) ? pdTRUE : pdFALSE;
+}
+#endif /* configUSE_MPU_STACK_GUARD */
+
+/**
+  * @brief  Whether a run of bytes lies wholly in SRAM or wholly in CCM.
+  * @retval pdTRUE if it does.
+  */
+static BaseType_t prvIsRam(uint32_t ulAddress, uint32_t ulBytes)
+{
+  if ((ulAddress & 3U) != 0U)
+  {
+    return pdFALSE;
+  }
+
+  if ((ulAddress >= SRAM1_BASE) && (ulAddress < (SRAM1_BASE + 0x20000UL)) &&
+      (ulBytes <= ((SRAM1_BASE + 0x20000UL) - ulAddress)))
+  {
+    return pdTRUE;
+  }
+
+  if ((ulAddress >= CCMDATARAM_BASE) && (ulAddress < (CCMDATARAM_BASE + 0x10000UL)) &&
+      (ulBytes <= ((CCMDATARAM_BASE + 0x10000UL) - ulAddress)))
+  {
+    return pdTRUE;
+  }
+
+  return pdFALSE;
+}
+
+/**
+  * @brief  Write the record to the crash log ring as text.
+  * @retval None
+  */
+static void prvFaultDump(void)
+{
+  const FaultRecord_t *pxRecord = &xFaultRecord;
+  const uint32_t *pulStack;
+  uint32_t ulIndex;
+  uint32_t ulLeft;
+  const char *pcName = "Fault";
+
+  if ((pxRecord->ulException >= 3U) && (pxRecord->ulException <= 6U))
+  {
+    pcName = pcFaultNames[pxRecord->ulException - 3U];
+  }
+
+  prvFaultLine("%s in %s: pc 0x%08lx lr 0x%08lx xpsr 0x%08lx\n\r", pcName, pxRecord->cTaskName,
+               (unsigned long) pxRecord->ulFrame[6], (unsigned long) pxRecord->ulFrame[5],
+               (unsigned long) pxRecord->ulFrame[7]);
+  prvFaultLine("cfsr 0x%08lx hfsr 0x%08lx mmfar 0x%08lx bfar 0x%08lx\n\r", (unsigned long) pxRecord->ulCfsr,
+               (unsigned long) pxRecord->ulHfsr, (unsigned long) pxRecord->ulMmfar, (unsigned long) pxRecord->ulBfar);
+  prvFaultLine("r0 %08lx r1 %08lx r2 %08lx r3 %08lx r12 %08lx\n\r", (unsigned long) pxRecord->ulFrame[0],
+               (unsigned long) pxRecord->ulFrame[1], (unsigned long) pxRecord->ulFrame[2],
+               (unsigned long) pxRecord->ulFrame[3], (unsigned long) pxRecord->ulFrame[4]);
+  prvFaultLine("r4 %08lx r5 %08lx r6 %08lx r7 %08lx\n\r", (unsigned long) pxRecord->ulR4ToR11[0],
+               (unsigned long) pxRecord->ulR4ToR11[1], (unsigned long) pxRecord->ulR4ToR11[2],
+               (unsigned long) pxRecord->ulR4ToR11[3]);
+  prvFaultLine("r8 %08lx r9 %08lx r10 %08lx r11 %08lx\n\r", (unsigned long) pxRecord->ulR4ToR11[4],
+               (unsigned long) pxRecord->ulR4ToR11[5], (unsigned long) pxRecord->ulR4ToR11[6],
+               (unsigned long) pxRecord->ulR4ToR11[7]);
+  prvFaultLine("sp 0x%08lx exc_return 0x%08lx\n\r", (unsigned long) pxRecord->ulSp,
+               (unsigned long) pxRecord->ulExcReturn);
+
+  for (ulIndex = 0U; ulIndex < pxRecord->ulStackWords; ulIndex += faultDUMP_WORDS)
+  {
+    pulStack = &pxRecord->ulStack[ulIndex];
+    ulLeft = pxRecord->ulStackWords - ulIndex;
+    if (ulLeft >= faultDUMP_WORDS)
+    {
+      prvFaultLine("+%03lx: %08lx %08lx %08lx %08lx %08lx %08lx %08lx %08lx\n\r", (unsigned long) (ulIndex * 4U),
+                   (unsigned long) pulStack[0], (unsigned long) pulStack[1], (unsigned long) pulStack[2],
+                   (unsigned long) pulStack[3], (unsigned long) pulStack[4], (unsigned long) pulStack[5],
+                   (unsigned long) pulStack[6], (unsigned long) pulStack[7]);
+    }
+    else
+    {
+      for (; ulLeft != 0U; ulLeft--, pulStack++)
+      {
+        prvFaultLine("+%03lx: %08lx\n\r", (unsigned long) ((uint32_t) (pulStack - pxRecord->ulStack) * 4U),
+                     (unsigned long) *pulStack);
+      }
+    }
+  }
+}
+
+/**
+  * @brief  Format one line of the dump into the crash log ring.
+  * @retval None
+  */
+static void prvFaultLine(const char *pcFormat, ...)
+{
+  char cLine[96];
+  va_list xArgs;
+  size_t xLength;
+
+  va_start(xArgs, pcFormat);
+  xLength = xFmtVFormat(cLine, sizeof(cLine), pcFormat, xArgs);
+  va_end(xArgs);
+
+  vCrashLogAppend(cLine, xLength);
+}
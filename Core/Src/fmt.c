@@ -0,0 +1,368 @@
+/**
+  ******************************************************************************
+  * @file           : fmt.c
+  * @brief          : The formatter of fmt.h.
+  ******************************************************************************
+  * One pass over the format string, writing straight into the caller's
+  * buffer.  Numbers are converted into a 10 digit scratch array, so the frame
+  * is the same size whatever is formatted, and nothing recurses.  Output that
+  * does not fit is cut off, and the buffer is always terminated.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "fmt.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  char *pcOut;
+  char *pcLast;                 /*!< Reserved for the terminator.  */
+} FmtOutput_t;
+
+typedef struct
+{
+  const char *pcPrefix;         /*!< Sign or 0x, before any zeros. */
+  const char *pcText;
+  size_t xTextLength;
+  size_t xWidth;
+  char cPad;
+  uint8_t ucLeft;
+} FmtField_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/* Decimal digits of the largest 32 bit value. */
+#define fmtDIGITS                   10U
+
+/* Private variables ---------------------------------------------------------*/
+static const char cLowerDigits[] = "0123456789abcdef";
+static const char cUpperDigits[] = "0123456789ABCDEF";
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvPut(FmtOutput_t *pxOutput, char cChar);
+static void prvPutRepeated(FmtOutput_t *pxOutput, char cChar, size_t xCount);
+static void prvPutField(FmtOutput_t *pxOutput, const FmtField_t *pxField);
+static size_t prvLength(const char *pcString, size_t xMax);
+static void prvConvert(FmtField_t *pxField, char *pcDigits, uint32_t ulValue, uint32_t ulBase,
+                       const char *pcSymbols);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Format into a buffer, like snprintf().
+  * @param  pcBuffer Where the text goes.
+  * @param  xLength  Size of pcBuffer, including the terminator.
+  * @retval Characters written, not counting the terminator.
+  */
+size_t xFmtFormat(char *pcBuffer, size_t xLength, const char *pcFormat, ...)
+{
+  va_list xArgs;
+  size_t xWritten;
+
+  va_start(xArgs, pcFormat);
+  xWritten = xFmtVFormat(pcBuffer, xLength, pcFormat, xArgs);
+  va_end(xArgs);
+
+  return xWritten;
+}
+
+/**
+  * @brief  Format into a buffer from a va_list, like vsnprintf().
+  * @note   Unlike vsnprintf() the result is what was written, so it can be
+  *         passed straight to xLogWrite().
+  * @retval Characters written, not counting the terminator.
+  */
+size_t xFmtVFormat(char *pcBuffer, size_t xLength, const char *pcFormat, va_list xArgs)
+{
+  FmtOutput_t xOutput;
+  FmtField_t xField;
+  char cDigits[fmtDIGITS];
+  const char *pcSymbols;
+  uint32_t ulValue;
+  int32_t lValue;
+  size_t xPrecision;
+  int iArg;
+  uint8_t ucLongLong;
+  char cChar;
+
+  if (xLength == 0U)
+  {
+    return 0U;
+  }
+
+  xOutput.pcOut = pcBuffer;
+  xOutput.pcLast = &pcBuffer[xLength - 1U];
+
+  for (; *pcFormat != '\0'; pcFormat++)
+  {
+    if (*pcFormat != '%')
+    {
+      prvPut(&xOutput, *pcFormat);
+      continue;
+    }
+
+    pcFormat++;
+    xField.pcPrefix = "";
+    xField.xWidth = 0U;
+    xField.cPad = ' ';
+    xField.ucLeft = 0U;
+    xPrecision = SIZE_MAX;
+
+    for (;; pcFormat++)
+    {
+      if (*pcFormat == '-')
+      {
+        xField.ucLeft = 1U;
+      }
+      else if (*pcFormat == '0')
+      {
+        xField.cPad = '0';
+      }
+      else
+      {
+        break;
+      }
+    }
+
+    if (*pcFormat == '*')
+    {
+      iArg = va_arg(xArgs, int);
+      if (iArg < 0)
+      {
+        xField.ucLeft = 1U;
+        iArg = -iArg;
+      }
+      xField.xWidth = (size_t) iArg;
+      pcFormat++;
+    }
+    else
+    {
+      while ((*pcFormat >= '0') && (*pcFormat <= '9'))
+      {
+        xField.xWidth = (xField.xWidth * 10U) + (size_t) (*pcFormat++ - '0');
+      }
+    }
+
+    if (*pcFormat == '.')
+    {
+      pcFormat++;
+      xPrecision = 0U;
+      if (*pcFormat == '*')
+      {
+        iArg = va_arg(xArgs, int);
+        xPrecision = (iArg < 0) ? SIZE_MAX : (size_t) iArg;
+        pcFormat++;
+      }
+      else
+      {
+        while ((*pcFormat >= '0') && (*pcFormat <= '9'))
+        {
+          xPrecision = (xPrecision * 10U) + (size_t) (*pcFormat++ - '0');
+        }
+      }
+    }
+
+    ucLongLong = 0U;
+    if ((pcFormat[0] == 'l') && (pcFormat[1] == 'l'))
+    {
+      ucLongLong = 1U;
+      pcFormat += 2;
+    }
+    while ((*pcFormat == 'h') || (*pcFormat == 'l') || (*pcFormat == 'z'))
+    {
+      pcFormat++;
+    }
+
+    /* Zero padding only applies to numbers, and never on the right. */
+    if ((xField.ucLeft != 0U) || (*pcFormat == 's') || (*pcFormat == 'c'))
+    {
+      xField.cPad = ' ';
+    }
+
+    pcSymbols = cLowerDigits;
+    cChar = *pcFormat;
+
+    if ((ucLongLong != 0U) && (cChar != '\0'))
+    {
+      /* Take the 64 bit argument so that the ones after it still line up. */
+      (void) va_arg(xArgs, unsigned long long);
+      cChar = '?';
+    }
+
+    switch (cChar)
+    {
+      case 'd':
+      case 'i':
+        lValue = (int32_t) va_arg(xArgs, int);
+        ulValue = (uint32_t) lValue;
+        if (lValue < 0)
+        {
+          xField.pcPrefix = "-";
+          ulValue = 0U - ulValue;
+        }
+        prvConvert(&xField, cDigits, ulValue, 10U, pcSymbols);
+        break;
+
+      case 'u':
+        ulValue = (uint32_t) va_arg(xArgs, unsigned int);
+        prvConvert(&xField, cDigits, ulValue, 10U, pcSymbols);
+        break;
+
+      case 'X':
+        pcSymbols = cUpperDigits;
+        /* Fall through. */
+      case 'x':
+        ulValue = (uint32_t) va_arg(xArgs, unsigned int);
+        prvConvert(&xField, cDigits, ulValue, 16U, pcSymbols);
+        break;
+
+      case 'p':
+        /* Always all eight digits, as 0x%08lx would print them. */
+        ulValue = (uint32_t) (uintptr_t) va_arg(xArgs, void *);
+        xField.pcPrefix = "0x";
+        prvConvert(&xField, cDigits, ulValue, 16U, pcSymbols);
+        xField.xWidth = (xField.xWidth > 10U) ? xField.xWidth : 10U;
+        xField.cPad = (xField.ucLeft != 0U) ? ' ' : '0';
+        break;
+
+      case 's':
+        xField.pcText = va_arg(xArgs, const char *);
+        if (xField.pcText == NULL)
+        {
+          xField.pcText = "(null)";
+        }
+        xField.xTextLength = prvLength(xField.pcText, xPrecision);
+        break;
+
+      case 'c':
+        cDigits[0] = (char) va_arg(xArgs, int);
+        xField.pcText = cDigits;
+        xField.xTextLength = 1U;
+        break;
+
+      case '%':
+        xField.pcText = "%";
+        xField.xTextLength = 1U;
+        break;
+
+      case '\0':
+        /* A lone % at the end; stop rather than read past the string. */
+        pcFormat--;
+        continue;
+
+      default:
+        xField.pcText = "?";
+        xField.xTextLength = 1U;
+        break;
+    }
+
+    prvPutField(&xOutput, &xField);
+  }
+
+  *xOutput.pcOut = '\0';
+
+  return (size_t) (xOutput.pcOut - pcBuffer);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Append a character if there is room for it and the terminator.
+  * @retval None
+  */
+static void prvPut(FmtOutput_t *pxOutput, char cChar)
+{
+  if (pxOutput->pcOut < pxOutput->pcLast)
+  {
+    *pxOutput->pcOut++ = cChar;
+  }
+}
+
+/**
+  * @brief  Append a character xCount times.
+  * @retval None
+  */
+static void prvPutRepeated(FmtOutput_t *pxOutput, char cChar, size_t xCount)
+{
+  while (xCount-- > 0U)
+  {
+    prvPut(pxOutput, cChar);
+  }
+}
+
+/**
+  * @brief  Append prefix and text, padded out to the field width.
+  * @retval None
+  */
+static void prvPutField(FmtOutput_t *pxOutput, const FmtField_t *pxField)
+{
+  size_t xPrefixLength = prvLength(pxField->pcPrefix, SIZE_MAX);
+  size_t xUsed = xPrefixLength + pxField->xTextLength;
+  size_t xPadding = (pxField->xWidth > xUsed) ? (pxField->xWidth - xUsed) : 0U;
+  size_t x;
+
+  if ((pxField->ucLeft == 0U) && (pxField->cPad == ' '))
+  {
+    prvPutRepeated(pxOutput, ' ', xPadding);
+  }
+
+  for (x = 0U; x < xPrefixLength; x++)
+  {
+    prvPut(pxOutput, pxField->pcPrefix[x]);
+  }
+
+  if ((pxField->ucLeft == 0U) && (pxField->cPad == '0'))
+  {
+    prvPutRepeated(pxOutput, '0', xPadding);
+  }
+
+  for (x = 0U; x < pxField->xTextLength; x++)
+  {
+    prvPut(pxOutput, pxField->pcText[x]);
+  }
+
+  if (pxField->ucLeft != 0U)
+  {
+    prvPutRepeated(pxOutput, ' ', xPadding);
+  }
+}
+
+/**
+  * @brief  Length of a string, stopping at xMax.
+  * @retval Characters before the terminator, at most xMax.
+  */
+static size_t prvLength(const char *pcString, size_t xMax)
+{
+  size_t xLength = 0U;
+
+  while ((xLength < xMax) && (pcString[xLength] != '\0'))
+  {
+    xLength++;
+  }
+
+  return xLength;
+}
+
+/**
+  * @brief  Make a value the text of a field, writing its digits backwards
+  *         from the end of pcDigits.
+  * @param  pcDigits Scratch of fmtDIGITS characters, not terminated.
+  * @retval None
+  */
+static void prvConvert(FmtField_t *pxField, char *pcDigits, uint32_t ulValue, uint32_t ulBase,
+                       const char *pcSymbols)
+{
+  char *pcFirst = &pcDigits[fmtDIGITS];
+
+  do
+  {
+    *--pcFirst = pcSymbols[ulValue % ulBase];
+    ulValue /= ulBase;
+  } while (ulValue != 0U);
+
+  pxField->pcText = pcFirst;
+  pxField->xTextLength = (size_t) (&pcDigits[fmtDIGITS] - pcFirst);
+}
@@ -0,0 +1,384 @@
+/**
+  ******************************************************************************
+  * @file           : future.c
+  * @brief          : Futures: results settled once, from a task or an
+  *                   interrupt, that tasks wait on or chain continuations to.
+  ******************************************************************************
+  * A future's state, waiter and continuation change only inside critical
+  * sections, so settling it races neither a task starting to wait nor
+  * xFutureThen().  The waiter is woken and the continuation submitted after
+  * the critical section, from what was taken out of the future inside it.
+  *
+  * A waiter records itself in every future it waits on and then blocks in
+  * ulTaskNotifyTakeIndexed() on futureNOTIFY_INDEX, checking all of them
+  * again on each wake; a settle that comes between the check and the block
+  * leaves the notification pending, so it is not missed, and one left over
+  * from an earlier wait costs only an extra pass round the loop.
+  *
+  * A continuation that finds its lane full from an interrupt cannot wait for
+  * room, and is dropped and counted; from a task, settling waits for room.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "future.h"
+
+#if (configUSE_TASK_NOTIFICATIONS == 1)
+
+/* Private variables ---------------------------------------------------------*/
+static volatile uint32_t ulLost = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static BaseType_t prvSettle(Future_t *pxFuture, FutureState_t eState, uint32_t ulValue,
+                            BaseType_t *pxHigherPriorityTaskWoken);
+static void prvRunContinuation(void *pvArg);
+static BaseType_t prvWait(Future_t *const pxFutures[], UBaseType_t uxCount, BaseType_t xAll,
+                          TickType_t xTicksToWait, UBaseType_t *puxIndex);
+static void prvForget(Future_t *const pxFutures[], UBaseType_t uxCount, TaskHandle_t xSelf);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Make a future pending, with no waiter or continuation.
+  * @note   Not while a task waits on it or a continuation is due.
+  * @retval None
+  */
+void vFutureInit(Future_t *pxFuture)
+{
+  pxFuture->ucLane = (uint8_t) eWorkerPoolLaneNormal;
+  pxFuture->ulValue = 0U;
+  pxFuture->xWaiter = NULL;
+  pxFuture->pxContinuation = NULL;
+  pxFuture->pvContinuationArg = NULL;
+  pxFuture->ucState = (uint8_t) eFuturePending;
+}
+
+/**
+  * @brief  Settle a future with a value.
+  * @note   Call from a task.
+  * @retval pdPASS, or pdFAIL if it was already settled.
+  */
+BaseType_t xFutureResolve(Future_t *pxFuture, uint32_t ulValue)
+{
+  return prvSettle(pxFuture, eFutureResolved, ulValue, NULL);
+}
+
+/**
+  * @brief  Settle a future with an error code.
+  * @note   Call from a task.
+  * @retval pdPASS, or pdFAIL if it was already settled.
+  */
+BaseType_t xFutureFail(Future_t *pxFuture, uint32_t ulError)
+{
+  return prvSettle(pxFuture, eFutureFailed, ulError, NULL);
+}
+
+/**
+  * @brief  Settle a future with a value from an interrupt.
+  * @param  pxHigherPriorityTaskWoken Set if a woken task should run on exit.
+  * @retval pdPASS, or pdFAIL if it was already settled.
+  */
+BaseType_t xFutureResolveFromISR(Future_t *pxFuture, uint32_t ulValue, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  configASSERT(pxHigherPriorityTaskWoken != NULL);
+
+  return prvSettle(pxFuture, eFutureResolved, ulValue, pxHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  Settle a future with an error code from an interrupt.
+  * @param  pxHigherPriorityTaskWoken Set if a woken task should run on exit.
+  * @retval pdPASS, or pdFAIL if it was already settled.
+  */
+BaseType_t xFutureFailFromISR(Future_t *pxFuture, uint32_t ulError, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  configASSERT(pxHigherPriorityTaskWoken != NULL);
+
+  return prvSettle(pxFuture, eFutureFailed, ulError, pxHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  Have a worker call pxContinuation once the future is settled, or
+  *         at once if it is already.
+  * @param  eLane Worker pool lane the continuation runs from.
+  * @note   Call from a task, at most once per settling.
+  * @retval pdPASS, or pdFAIL if the future already has a continuation.
+  */
+BaseType_t xFutureThen(Future_t *pxFuture, WorkerPoolLane_t eLane, FutureContinuation_t pxContinuation,
+                       void *pvArg)
+{
+  BaseType_t xSettled;
+
+  configASSERT(pxContinuation != NULL);
+
+  taskENTER_CRITICAL();
+  if (pxFuture->pxContinuation != NULL)
+  {
+    taskEXIT_CRITICAL();
+    return pdFAIL;
+  }
+  pxFuture->ucLane = (uint8_t) eLane;
+  pxFuture->pvContinuationArg = pvArg;
+  pxFuture->pxContinuation = pxContinuation;
+  xSettled = (pxFuture->ucState != (uint8_t) eFuturePending) ? pdTRUE : pdFALSE;
+  taskEXIT_CRITICAL();
+
+  /* Settled before the continuation was there to be submitted. */
+  if (xSettled != pdFALSE)
+  {
+    (void) xWorkerPoolSubmitLane(eLane, prvRunContinuation, pxFuture, portMAX_DELAY);
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Whether a future is settled, and how.
+  * @retval The state.
+  */
+FutureState_t eFutureGetState(const Future_t *pxFuture)
+{
+  return (FutureState_t) pxFuture->ucState;
+}
+
+/**
+  * @brief  What a settled future was resolved or failed with.
+  * @retval The value or error code, 0 while pending.
+  */
+uint32_t ulFutureGetValue(const Future_t *pxFuture)
+{
+  return (pxFuture->ucState != (uint8_t) eFuturePending) ? pxFuture->ulValue : 0U;
+}
+
+/**
+  * @brief  Block until a future is settled.
+  * @retval eFutureResolved or eFutureFailed, or eFuturePending if the wait
+  *         timed out.
+  */
+FutureState_t eFutureWait(Future_t *pxFuture, TickType_t xTicksToWait)
+{
+  Future_t *const pxFutures[1] = { pxFuture };
+
+  (void) prvWait(pxFutures, 1U, pdTRUE, xTicksToWait, NULL);
+
+  return (FutureState_t) pxFuture->ucState;
+}
+
+/**
+  * @brief  Block until every one of the futures is settled.
+  * @retval pdPASS, or pdFAIL if the wait timed out first.
+  */
+BaseType_t xFutureWhenAll(Future_t *const pxFutures[], UBaseType_t uxCount, TickType_t xTicksToWait)
+{
+  return prvWait(pxFutures, uxCount, pdTRUE, xTicksToWait, NULL);
+}
+
+/**
+  * @brief  Block until at least one of the futures is settled.
+  * @param  puxIndex Set to the first settled one in the array, if not NULL.
+  * @retval pdPASS, or pdFAIL if the wait timed out first.
+  */
+BaseType_t xFutureWhenAny(Future_t *const pxFutures[], UBaseType_t uxCount, TickType_t xTicksToWait,
+                          UBaseType_t *puxIndex)
+{
+  return prvWait(pxFutures, uxCount, pdFALSE, xTicksToWait, puxIndex);
+}
+
+/**
+  * @brief  Continuations dropped since boot because their lane was full
+  *         when an interrupt settled the future.
+  * @retval The count.
+  */
+uint32_t ulFutureLostContinuations(void)
+{
+  return ulLost;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Settle a future, wake its waiter and submit its continuation.
+  * @param  pxHigherPriorityTaskWoken NULL from a task.
+  * @retval pdPASS, or pdFAIL if it was already settled.
+  */
+static BaseType_t prvSettle(Future_t *pxFuture, FutureState_t eState, uint32_t ulValue,
+                            BaseType_t *pxHigherPriorityTaskWoken)
+{
+  TaskHandle_t xWaiter = NULL;
+  FutureContinuation_t pxContinuation = NULL;
+  BaseType_t xSettled = pdFALSE;
+  UBaseType_t uxSaved = 0U;
+
+  if (pxHigherPriorityTaskWoken != NULL)
+  {
+    uxSaved = taskENTER_CRITICAL_FROM_ISR();
+  }
+  else
+  {
+    taskENTER_CRITICAL();
+  }
+
+  if (pxFuture->ucState == (uint8_t) eFuturePending)
+  {
+    pxFuture->ulValue = ulValue;
+    pxFuture->ucState = (uint8_t) eState;
+    xWaiter = pxFuture->xWaiter;
+    pxFuture->xWaiter = NULL;
+    pxContinuation = pxFuture->pxContinuation;
+    xSettled = pdTRUE;
+  }
+
+  if (pxHigherPriorityTaskWoken != NULL)
+  {
+    taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+  }
+  else
+  {
+    taskEXIT_CRITICAL();
+  }
+
+  if (xSettled == pdFALSE)
+  {
+    return pdFAIL;
+  }
+
+  if (pxHigherPriorityTaskWoken != NULL)
+  {
+    if (xWaiter != NULL)
+    {
+      vTaskNotifyGiveIndexedFromISR(xWaiter, futureNOTIFY_INDEX, pxHigherPriorityTaskWoken);
+    }
+    if ((pxContinuation != NULL) &&
+        (xWorkerPoolSubmitLaneFromISR((WorkerPoolLane_t) pxFuture->ucLane, prvRunContinuation, pxFuture,
+                                      pxHigherPriorityTaskWoken) != pdPASS))
+    {
+      ulLost++;
+    }
+  }
+  else
+  {
+    if (xWaiter != NULL)
+    {
+      (void) xTaskNotifyGiveIndexed(xWaiter, futureNOTIFY_INDEX);
+    }
+    if (pxContinuation != NULL)
+    {
+      (void) xWorkerPoolSubmitLane((WorkerPoolLane_t) pxFuture->ucLane, prvRunContinuation, pxFuture,
+                                   portMAX_DELAY);
+    }
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Worker pool job that calls a settled future's continuation.
+  * @param  pvArg The future.
+  * @retval None
+  */
+static void prvRunContinuation(void *pvArg)
+{
+  Future_t *pxFuture = (Future_t *) pvArg;
+  FutureContinuation_t pxContinuation;
+
+  /* Taken off first, so the continuation may give the future another. */
+  taskENTER_CRITICAL();
+  pxContinuation = pxFuture->pxContinuation;
+  pxFuture->pxContinuation = NULL;
+  taskEXIT_CRITICAL();
+
+  if (pxContinuation != NULL)
+  {
+    pxContinuation(pxFuture, pxFuture->pvContinuationArg);
+  }
+}
+
+/**
+  * @brief  Block until all or any of the futures are settled.
+  * @param  xAll     pdTRUE for all, pdFALSE for any.
+  * @param  puxIndex Set to the first settled one, if not NULL.
+  * @retval pdPASS, or pdFAIL if the wait timed out first.
+  */
+static BaseType_t prvWait(Future_t *const pxFutures[], UBaseType_t uxCount, BaseType_t xAll,
+                          TickType_t xTicksToWait, UBaseType_t *puxIndex)
+{
+  TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+  TimeOut_t xTimeOut;
+  UBaseType_t uxIndex;
+  UBaseType_t uxSettled;
+  UBaseType_t uxFirst;
+  BaseType_t xDone;
+
+  configASSERT(uxCount != 0U);
+
+  vTaskSetTimeOutState(&xTimeOut);
+
+  for (;;)
+  {
+    uxSettled = 0U;
+    uxFirst = uxCount;
+
+    taskENTER_CRITICAL();
+    for (uxIndex = 0U; uxIndex < uxCount; uxIndex++)
+    {
+      if (pxFutures[uxIndex]->ucState != (uint8_t) eFuturePending)
+      {
+        uxSettled++;
+        if (uxFirst == uxCount)
+        {
+          uxFirst = uxIndex;
+        }
+      }
+      else
+      {
+        configASSERT((pxFutures[uxIndex]->xWaiter == NULL) || (pxFutures[uxIndex]->xWaiter == xSelf));
+        pxFutures[uxIndex]->xWaiter = xSelf;
+      }
+    }
+    taskEXIT_CRITICAL();
+
+    xDone = (xAll != pdFALSE) ? ((uxSettled == uxCount) ? pdTRUE : pdFALSE)
+                              : ((uxSettled != 0U) ? pdTRUE : pdFALSE);
+    if (xDone != pdFALSE)
+    {
+      break;
+    }
+
+    if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE)
+    {
+      break;
+    }
+
+    (void) ulTaskNotifyTakeIndexed(futureNOTIFY_INDEX, pdTRUE, xTicksToWait);
+  }
+
+  prvForget(pxFutures, uxCount, xSelf);
+
+  if ((puxIndex != NULL) && (uxFirst != uxCount))
+  {
+    *puxIndex = uxFirst;
+  }
+
+  return xDone;
+}
+
+/**
+  * @brief  Take the task off every future it still waits on.
+  * @retval None
+  */
+static void prvForget(Future_t *const pxFutures[], UBaseType_t uxCount, TaskHandle_t xSelf)
+{
+  UBaseType_t uxIndex;
+
+  taskENTER_CRITICAL();
+  for (uxIndex = 0U; uxIndex < uxCount; uxIndex++)
+  {
+    if (pxFutures[uxIndex]->xWaiter == xSelf)
+    {
+      pxFutures[uxIndex]->xWaiter = NULL;
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
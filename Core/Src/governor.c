@@ -0,0 +1,134 @@
+/**
+  ******************************************************************************
+  * @file           : governor.c
+  * @brief          : Frequency governor stepping between clock profiles on
+  *                   the measured CPU load.
+  ******************************************************************************
+  * Busy time is the DWT cycle count less the idle task's run time counter,
+  * both of which stop in STOP mode, taken at the clock of the profile the
+  * window ran at.  The window itself comes from ulTaskGetTickCountUs(), so a
+  * window spent mostly asleep reads as lightly loaded rather than as busy.
+  *
+  * Peripheral timings follow a switch through xClockProfileSet(): TIM5 and
+  * with it the kernel and HAL ticks through HAL_InitTick(), and the USART2
+  * divisor directly.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "governor.h"
+#include "periodic.h"
+#include "timebase.h"
+#include "log.h"
+#include "dwt.h"
+
+#if (configGENERATE_RUN_TIME_STATS != 1) || (INCLUDE_xTaskGetIdleTaskHandle != 1)
+#error The governor reads the idle task run time, so configGENERATE_RUN_TIME_STATS and INCLUDE_xTaskGetIdleTaskHandle must be 1
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static PeriodicJob_t xGovernorJob;
+
+/* Counters at the start of the current window. */
+static uint32_t ulWindowStartUs;
+static uint32_t ulWindowStartCycles;
+static uint32_t ulWindowStartIdleCycles;
+static BaseType_t xWindowStarted = pdFALSE;
+
+static volatile uint16_t usLastLoadPermille;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvGovernorJob(void *pvParameter);
+static void prvStartWindow(void);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Start sampling.  Call once, before or after the scheduler starts.
+  * @retval Result of xPeriodicJobStart().
+  */
+BaseType_t xGovernorStart(void)
+{
+  return xPeriodicJobStart(&xGovernorJob, prvGovernorJob, NULL,
+                           pdMS_TO_TICKS(governorPERIOD_MS), pdMS_TO_TICKS(governorPERIOD_MS));
+}
+
+/**
+  * @brief  Load measured over the last complete window.
+  * @retval Permille of the window spent outside the idle task.
+  */
+uint16_t usGovernorGetLoadPermille(void)
+{
+  return usLastLoadPermille;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Measure the window just ended and pick the profile for the next.
+  * @param  pvParameter Unused.
+  * @retval None
+  */
+static void prvGovernorJob(void *pvParameter)
+{
+  ClockProfile_t eProfile = eClockProfileGet();
+  ClockProfile_t eNext = eProfile;
+  uint32_t ulWindowUs;
+  uint32_t ulBusyCycles;
+  uint64_t ullBusyUs;
+  uint32_t ulLoad;
+
+  (void) pvParameter;
+
+  /* The idle task only exists once the scheduler is running. */
+  ulWindowUs = ulTaskGetTickCountUs() - ulWindowStartUs;
+  if ((xWindowStarted == pdFALSE) || (ulWindowUs == 0U))
+  {
+    prvStartWindow();
+    return;
+  }
+
+  ulBusyCycles = (ulDwtCycles() - ulWindowStartCycles)
+               - ((uint32_t) xTaskGetIdleRunTimeCounter() - ulWindowStartIdleCycles);
+  ullBusyUs = ((uint64_t) ulBusyCycles * 1000000ULL) / SystemCoreClock;
+  ulLoad = (ullBusyUs >= ulWindowUs) ? 1000U : (uint32_t) ((ullBusyUs * 1000ULL) / ulWindowUs);
+  usLastLoadPermille = (uint16_t) ulLoad;
+
+  if ((ulLoad >= governorRAISE_PERMILLE) || (xLogGetPending() >= governorLOG_BACKLOG_BYTES))
+  {
+    eNext = CLOCK_PROFILE_PERFORMANCE;
+  }
+  else if ((eProfile == CLOCK_PROFILE_LOW_POWER) && (xClockProfileHseHeld() != pdFALSE))
+  {
+    eNext = CLOCK_PROFILE_BALANCED;
+  }
+  else if ((ulLoad < governorLOWER_PERMILLE) && (eProfile < (CLOCK_PROFILE_COUNT - 1)) &&
+           (((eProfile + 1) != CLOCK_PROFILE_LOW_POWER) || (xClockProfileHseHeld() == pdFALSE)))
+  {
+    /* Profiles are listed fastest first.  The low power one moves the PLL
+       off the HSE, losing 48 MHz and stopping the PLLI2S. */
+    eNext = (ClockProfile_t) (eProfile + 1);
+  }
+
+  if (eNext != eProfile)
+  {
+    (void) xClockProfileSet(eNext);
+  }
+
+  /* The cycle counts of a window must all be at one clock. */
+  prvStartWindow();
+}
+
+/**
+  * @brief  Take the counters a window is measured from.
+  * @retval None
+  */
+static void prvStartWindow(void)
+{
+  ulWindowStartUs = ulTaskGetTickCountUs();
+  ulWindowStartCycles = ulDwtCycles();
+  ulWindowStartIdleCycles = (uint32_t) xTaskGetIdleRunTimeCounter();
+  xWindowStarted = pdTRUE;
+}
@@ -0,0 +1,431 @@
+/**
+  ******************************************************************************
+  * @file           : heapbench.c
+  * @brief          : Allocator benchmark task, see heapbench.h.
+  ******************************************************************************
+  * Scenarios allocate into a table of heapbenchSLOTS slots, so a trace is a
+  * sequence of slot operations and replays the same way on every allocator.
+  * Sizes come from a xorshift generator with a fixed seed, so two builds see
+  * the same requests.
+  *
+  * The rows are only written once a scenario has finished, and each waits
+  * for room in the log ring, so the log never competes with the operations
+  * being timed and no row is dropped.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heapbench.h"
+#include "taskreg.h"
+#include "dwt.h"
+#include "log.h"
+#include "fmt.h"
+
+#if (heapbenchENABLE == 1)
+
+#if (configHEAP_LOCK_CEILING > 0) && (heapbenchPRIORITY >= configHEAP_LOCK_CEILING)
+#error heapbenchPRIORITY must be below configHEAP_LOCK_CEILING
+#endif
+
+/* Tools/heapbench_trace.py writes this from a trace recorder capture. */
+#if __has_include("heapbench_trace.h")
+#include "heapbench_trace.h"
+#define heapbenchHAVE_TRACE         1
+_Static_assert(heapbenchTRACE_SLOTS <= heapbenchSLOTS, "the recorded trace needs more slots than heapbenchSLOTS");
+#else
+#define heapbenchHAVE_TRACE         0
+#endif
+
+/* Private define ------------------------------------------------------------*/
+#if (configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_2)
+#define heapbenchHEAP_NAME          "heap_2"
+#elif (configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_BTAG)
+#define heapbenchHEAP_NAME          "heap_btag"
+#elif (configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_TLSF)
+#define heapbenchHEAP_NAME          "heap_tlsf"
+#elif (configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_REGIONS)
+#define heapbenchHEAP_NAME          "heap_regions"
+#else
+#define heapbenchHEAP_NAME          "other"
+#endif
+
+/* Sample rows kept per scenario; later samples are not taken. */
+#define heapbenchMAX_SAMPLES        64U
+
+#define heapbenchSTACK_DEPTH        256U
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t ulMallocMin;
+  uint32_t ulMallocMax;
+  uint32_t ulMallocTotal;
+  uint32_t ulMallocs;
+  uint32_t ulFreeMin;
+  uint32_t ulFreeMax;
+  uint32_t ulFreeTotal;
+  uint32_t ulFrees;
+  uint32_t ulFailed;
+  uint32_t ulOps;
+  uint32_t ulPeakFragmentation;   /*!< Permille. */
+  size_t xMinLargest;
+} HeapBenchResult_t;
+
+typedef struct
+{
+  uint32_t ulOp;
+  uint32_t ulFreeBytes;
+  uint32_t ulLargest;
+} HeapBenchSample_t;
+
+/* Private variables ---------------------------------------------------------*/
+static const HeapBenchScenario_t xScenarios[] = heapbenchSCENARIOS;
+
+static void *pvSlots[heapbenchSLOTS];
+static HeapBenchResult_t xResult;
+static HeapBenchSample_t xSamples[heapbenchMAX_SAMPLES];
+static size_t xSampleCount;
+static uint32_t ulRandom = heapbenchSEED;
+
+static const char cSummaryHeader[] =
+  "summary,heap,merge,scenario,ops,malloc_min,malloc_avg,malloc_max,"
+  "free_min,free_avg,free_max,failed,frag_permille,min_largest\n\r";
+static const char cSampleHeader[] = "sample,scenario,op,free_bytes,largest\n\r";
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvHeapBenchTask(void *pvParameters);
+static void prvRunScenario(const HeapBenchScenario_t *pxScenario);
+static void prvRunFill(const HeapBenchScenario_t *pxScenario);
+static void prvAllocate(size_t xSlot, size_t xSize);
+static void prvFree(size_t xSlot);
+static void prvAfterOperation(void);
+static void prvReleaseAll(void);
+static uint32_t prvRandom(void);
+static size_t prvRandomSize(const HeapBenchScenario_t *pxScenario);
+static void prvReport(const HeapBenchScenario_t *pxScenario);
+static void prvEmitText(const char *pcText, size_t xLength);
+static void prvEmit(const char *pcFormat, ...) fmtCHECK(1, 2);
+
+/* Registered tasks ----------------------------------------------------------*/
+TASK_REGISTER_IN(CCM, HEAPBENCH, prvHeapBenchTask, NULL, heapbenchSTACK_DEPTH, heapbenchPRIORITY);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Run every scenario once, report, and delete itself.
+  * @param  pvParameters Unused.
+  * @retval None
+  */
+static void prvHeapBenchTask(void *pvParameters)
+{
+  size_t x;
+
+  (void) pvParameters;
+
+  vDwtInit();
+  vTaskDelay(pdMS_TO_TICKS(heapbenchSTART_DELAY_MS));
+
+  prvEmitText(cSummaryHeader, sizeof(cSummaryHeader) - 1U);
+  prvEmitText(cSampleHeader, sizeof(cSampleHeader) - 1U);
+
+  for (x = 0U; x < (sizeof(xScenarios) / sizeof(xScenarios[0])); x++)
+  {
+    prvRunScenario(&xScenarios[x]);
+  }
+
+  vTaskDelete(NULL);
+}
+
+/**
+  * @brief  Replay one scenario from an empty slot table and log its rows.
+  * @retval None
+  */
+static void prvRunScenario(const HeapBenchScenario_t *pxScenario)
+{
+  uint32_t ulOp;
+  size_t xSlot;
+
+  xResult = (HeapBenchResult_t) { 0 };
+  xResult.ulMallocMin = UINT32_MAX;
+  xResult.ulFreeMin = UINT32_MAX;
+  xResult.xMinLargest = SIZE_MAX;
+  xSampleCount = 0U;
+
+  switch (pxScenario->ePattern)
+  {
+    case HEAPBENCH_RANDOM:
+      for (ulOp = 0U; ulOp < pxScenario->usOps; ulOp++)
+      {
+        xSlot = (size_t) (prvRandom() % heapbenchSLOTS);
+
+        if (pvSlots[xSlot] == NULL)
+        {
+          prvAllocate(xSlot, prvRandomSize(pxScenario));
+        }
+        else
+        {
+          prvFree(xSlot);
+        }
+      }
+      break;
+
+    case HEAPBENCH_LIFO:
+    case HEAPBENCH_FIFO:
+      prvRunFill(pxScenario);
+      break;
+
+    case HEAPBENCH_RECORDED:
+#if (heapbenchHAVE_TRACE == 1)
+      for (ulOp = 0U; ulOp < (sizeof(xHeapBenchTrace) / sizeof(xHeapBenchTrace[0])); ulOp++)
+      {
+        if (xHeapBenchTrace[ulOp].usSize == 0U)
+        {
+          prvFree(xHeapBenchTrace[ulOp].ucSlot);
+        }
+        else
+        {
+          prvAllocate(xHeapBenchTrace[ulOp].ucSlot, xHeapBenchTrace[ulOp].usSize);
+        }
+      }
+#endif
+      break;
+
+    default:
+      break;
+  }
+
+  prvReleaseAll();
+
+  if (xResult.ulOps != 0U)
+  {
+    prvReport(pxScenario);
+  }
+}
+
+/**
+  * @brief  LIFO and FIFO: fill every slot, then free them all in order or
+  *         in reverse, usOps times.
+  * @retval None
+  */
+static void prvRunFill(const HeapBenchScenario_t *pxScenario)
+{
+  uint16_t usRound;
+  size_t x;
+
+  for (usRound = 0U; usRound < pxScenario->usOps; usRound++)
+  {
+    for (x = 0U; x < heapbenchSLOTS; x++)
+    {
+      prvAllocate(x, prvRandomSize(pxScenario));
+    }
+
+    for (x = 0U; x < heapbenchSLOTS; x++)
+    {
+      prvFree((pxScenario->ePattern == HEAPBENCH_LIFO) ? (heapbenchSLOTS - 1U - x) : x);
+    }
+  }
+}
+
+/**
+  * @brief  Time one allocation into a slot, freeing what it held first.
+  * @retval None
+  */
+static void prvAllocate(size_t xSlot, size_t xSize)
+{
+  uint32_t ulStart;
+  uint32_t ulCycles;
+  void *pvBlock;
+
+  prvFree(xSlot);
+
+  ulStart = ulDwtCycles();
+  pvBlock = pvPortMalloc(xSize);
+  ulCycles = ulDwtCycles() - ulStart;
+
+  if (pvBlock == NULL)
+  {
+    xResult.ulFailed++;
+  }
+  else
+  {
+    pvSlots[xSlot] = pvBlock;
+    xResult.ulMallocMin = (ulCycles < xResult.ulMallocMin) ? ulCycles : xResult.ulMallocMin;
+    xResult.ulMallocMax = (ulCycles > xResult.ulMallocMax) ? ulCycles : xResult.ulMallocMax;
+    xResult.ulMallocTotal += ulCycles;
+    xResult.ulMallocs++;
+  }
+
+  prvAfterOperation();
+}
+
+/**
+  * @brief  Time freeing a slot, if it holds a block.
+  * @retval None
+  */
+static void prvFree(size_t xSlot)
+{
+  uint32_t ulStart;
+  uint32_t ulCycles;
+
+  if (pvSlots[xSlot] == NULL)
+  {
+    return;
+  }
+
+  ulStart = ulDwtCycles();
+  vPortFree(pvSlots[xSlot]);
+  ulCycles = ulDwtCycles() - ulStart;
+
+  pvSlots[xSlot] = NULL;
+  xResult.ulFreeMin = (ulCycles < xResult.ulFreeMin) ? ulCycles : xResult.ulFreeMin;
+  xResult.ulFreeMax = (ulCycles > xResult.ulFreeMax) ? ulCycles : xResult.ulFreeMax;
+  xResult.ulFreeTotal += ulCycles;
+  xResult.ulFrees++;
+
+  prvAfterOperation();
+}
+
+/**
+  * @brief  Update the fragmentation figures, and take a sample when due.
+  * @retval None
+  */
+static void prvAfterOperation(void)
+{
+  HeapStats_t xStats;
+  uint32_t ulFragmentation = 0U;
+
+  vPortGetHeapStats(&xStats);
+  xResult.ulOps++;
+
+  if (xStats.xAvailableHeapSpaceInBytes != 0U)
+  {
+    ulFragmentation = 1000U - (uint32_t) (((uint64_t) xStats.xSizeOfLargestFreeBlockInBytes * 1000U) /
+                                          xStats.xAvailableHeapSpaceInBytes);
+  }
+
+  if (ulFragmentation > xResult.ulPeakFragmentation)
+  {
+    xResult.ulPeakFragmentation = ulFragmentation;
+  }
+
+  if (xStats.xSizeOfLargestFreeBlockInBytes < xResult.xMinLargest)
+  {
+    xResult.xMinLargest = xStats.xSizeOfLargestFreeBlockInBytes;
+  }
+
+  if ((heapbenchSAMPLE_EVERY != 0U) && ((xResult.ulOps % heapbenchSAMPLE_EVERY) == 0U) &&
+      (xSampleCount < heapbenchMAX_SAMPLES))
+  {
+    xSamples[xSampleCount].ulOp = xResult.ulOps;
+    xSamples[xSampleCount].ulFreeBytes = (uint32_t) xStats.xAvailableHeapSpaceInBytes;
+    xSamples[xSampleCount].ulLargest = (uint32_t) xStats.xSizeOfLargestFreeBlockInBytes;
+    xSampleCount++;
+  }
+}
+
+/**
+  * @brief  Free whatever a scenario left allocated, untimed.
+  * @retval None
+  */
+static void prvReleaseAll(void)
+{
+  size_t x;
+
+  for (x = 0U; x < heapbenchSLOTS; x++)
+  {
+    if (pvSlots[x] != NULL)
+    {
+      vPortFree(pvSlots[x]);
+      pvSlots[x] = NULL;
+    }
+  }
+}
+
+/**
+  * @brief  Advance the xorshift32 generator.
+  * @retval The next value.
+  */
+static uint32_t prvRandom(void)
+{
+  ulRandom ^= ulRandom << 13;
+  ulRandom ^= ulRandom >> 17;
+  ulRandom ^= ulRandom << 5;
+
+  return ulRandom;
+}
+
+/**
+  * @brief  Draw a size from the scenario's range.
+  * @retval Bytes to request.
+  */
+static size_t prvRandomSize(const HeapBenchScenario_t *pxScenario)
+{
+  uint32_t ulRange = (uint32_t) (pxScenario->usMaxSize - pxScenario->usMinSize) + 1U;
+
+  return (size_t) (pxScenario->usMinSize + ((prvRandom() >> 8) % ulRange));
+}
+
+/**
+  * @brief  Log the summary row and the samples of the scenario just run.
+  * @retval None
+  */
+static void prvReport(const HeapBenchScenario_t *pxScenario)
+{
+  size_t x;
+
+  prvEmit("summary,%s,%d,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n\r",
+          heapbenchHEAP_NAME, (int) if_merge_mem, pxScenario->pcName,
+          (unsigned long) xResult.ulOps,
+          (unsigned long) ((xResult.ulMallocs != 0U) ? xResult.ulMallocMin : 0U),
+          (unsigned long) ((xResult.ulMallocs != 0U) ? (xResult.ulMallocTotal / xResult.ulMallocs) : 0U),
+          (unsigned long) xResult.ulMallocMax,
+          (unsigned long) ((xResult.ulFrees != 0U) ? xResult.ulFreeMin : 0U),
+          (unsigned long) ((xResult.ulFrees != 0U) ? (xResult.ulFreeTotal / xResult.ulFrees) : 0U),
+          (unsigned long) xResult.ulFreeMax,
+          (unsigned long) xResult.ulFailed,
+          (unsigned long) xResult.ulPeakFragmentation,
+          (unsigned long) xResult.xMinLargest);
+
+  for (x = 0U; x < xSampleCount; x++)
+  {
+    prvEmit("sample,%s,%lu,%lu,%lu\n\r", pxScenario->pcName, (unsigned long) xSamples[x].ulOp,
+            (unsigned long) xSamples[x].ulFreeBytes, (unsigned long) xSamples[x].ulLargest);
+  }
+}
+
+/**
+  * @brief  Queue text once the log ring has room for it.
+  * @retval None
+  */
+static void prvEmitText(const char *pcText, size_t xLength)
+{
+  while ((logRING_SIZE - xLogGetPending()) < xLength)
+  {
+    vTaskDelay(1U);
+  }
+
+  (void) xLogWrite(pcText, xLength);
+}
+
+/**
+  * @brief  Format a row like xLogPrintf() and queue it with prvEmitText().
+  * @retval None
+  */
+static void prvEmit(const char *pcFormat, ...)
+{
+  char cLine[logPRINTF_LENGTH];
+  va_list xArgs;
+  size_t xLength;
+
+  va_start(xArgs, pcFormat);
+  xLength = xFmtVFormat(cLine, sizeof(cLine), pcFormat, xArgs);
+  va_end(xArgs);
+
+  prvEmitText(cLine, xLength);
+}
+
+#endif /* heapbenchENABLE */
@@ -0,0 +1,267 @@
+/**
+  ******************************************************************************
+  * @file           : irqlat.c
+  * @brief          : Interrupt latency mode, see irqlat.h.
+  ******************************************************************************
+  * TIM6 counts at the APB1 timer clock, which is HCLK or HCLK / 2 on every
+  * clock profile, so a count is a whole number of core cycles.  The timer is
+  * only started by the first run of the report job, so the boot, which
+  * runs with interrupts masked until the first task, stays out of the
+  * figures.
+  *
+  * The handler updates the figures with interrupts enabled; the report job
+  * takes and clears them with PRIMASK set, since irqlatPRIORITY may be above
+  * what BASEPRI masks.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "irqlat.h"
+#include "irqtable.h"
+#include "periodic.h"
+#include "log.h"
+
+#if (irqlatENABLE == 1)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t ulCount;
+  uint32_t ulMin;
+  uint32_t ulMax;
+  uint32_t ulMaxAt;           /*!< Interrupted PC of the longest, 0 if not a task. */
+  uint32_t ulBuckets[irqlatBUCKETS];
+} IrqLatStats_t;
+
+/* Private variables ---------------------------------------------------------*/
+static PeriodicJob_t xIrqLatJob;
+static IrqLatStats_t xStats;
+static uint32_t ulCyclesPerCount = 1U;
+#if (configUSE_SECTION_PROFILER == 1)
+static SectionSite_t xSites[irqlatSITES];
+#endif
+static BaseType_t xReady = pdFALSE;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvIrqLatJob(void *pvParameter);
+static void prvStartTimer(void);
+static void prvResetStats(IrqLatStats_t *pxStats);
+static void prvReport(const IrqLatStats_t *pxStats);
+#if (configUSE_SECTION_PROFILER == 1)
+static void prvReportSites(eSectionType eType, const char *pcName);
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Start the report job, whose first run starts the test interrupt.
+  *         Call once, before or after the scheduler starts.
+  * @retval Result of xPeriodicJobStart().
+  */
+BaseType_t xIrqLatStart(void)
+{
+  prvResetStats(&xStats);
+
+  return xPeriodicJobStart(&xIrqLatJob, prvIrqLatJob, NULL, pdMS_TO_TICKS(irqlatREPORT_MS), 0U);
+}
+
+/**
+  * @brief  TIM6 update interrupt body, called from TIM6_DAC_IRQHandler().
+  * @retval None
+  */
+void vIrqLatIRQHandler(void)
+{
+  uint32_t ulCycles = TIM6->CNT * ulCyclesPerCount;
+  uint32_t ulLimit = 1UL << irqlatFIRST_BUCKET_SHIFT;
+  uint32_t ulBucket = 0U;
+
+  TIM6->SR = (uint32_t) ~TIM_SR_UIF;
+
+  while ((ulCycles >= ulLimit) && (ulBucket < (irqlatBUCKETS - 1U)))
+  {
+    ulLimit <<= 1;
+    ulBucket++;
+  }
+
+  xStats.ulBuckets[ulBucket]++;
+  xStats.ulCount++;
+  xStats.ulMin = (ulCycles < xStats.ulMin) ? ulCycles : xStats.ulMin;
+
+  if (ulCycles > xStats.ulMax)
+  {
+    xStats.ulMax = ulCycles;
+
+    /* Returning to thread mode, so the frame the hardware stacked on entry
+       is the task's, at the bottom of its PSP. */
+    if ((SCB->ICSR & SCB_ICSR_RETTOBASE_Msk) != 0U)
+    {
+      xStats.ulMaxAt = ((const uint32_t *) __get_PSP())[6];
+    }
+    else
+    {
+      xStats.ulMaxAt = 0U;
+    }
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Start the test interrupt on the first run, then report and clear
+  *         the figures on every run after.
+  * @param  pvParameter Unused.
+  * @retval None
+  */
+static void prvIrqLatJob(void *pvParameter)
+{
+  IrqLatStats_t xTaken;
+  uint32_t ulPrimask;
+
+  (void) pvParameter;
+
+  if (xReady == pdFALSE)
+  {
+    prvStartTimer();
+    xReady = pdTRUE;
+    return;
+  }
+
+  ulPrimask = __get_PRIMASK();
+  __disable_irq();
+  xTaken = xStats;
+  prvResetStats(&xStats);
+  __set_PRIMASK(ulPrimask);
+
+  prvReport(&xTaken);
+}
+
+/**
+  * @brief  Run TIM6 at irqlatRATE_HZ from its full timer clock.
+  * @retval None
+  */
+static void prvStartTimer(void)
+{
+  RCC_ClkInitTypeDef xClocks;
+  uint32_t ulLatency;
+  uint32_t ulTimerHz;
+
+  __HAL_RCC_TIM6_CLK_ENABLE();
+
+  /* APB1 timers run at twice PCLK1 whenever APB1 is divided. */
+  HAL_RCC_GetClockConfig(&xClocks, &ulLatency);
+  ulTimerHz = HAL_RCC_GetPCLK1Freq();
+  if (xClocks.APB1CLKDivider != RCC_HCLK_DIV1)
+  {
+    ulTimerHz *= 2U;
+  }
+
+  configASSERT(((ulTimerHz / irqlatRATE_HZ) - 1U) <= 0xFFFFU);
+  ulCyclesPerCount = SystemCoreClock / ulTimerHz;
+
+  TIM6->CR1 = 0U;
+  TIM6->PSC = 0U;
+  TIM6->ARR = (ulTimerHz / irqlatRATE_HZ) - 1U;
+  TIM6->EGR = TIM_EGR_UG;
+  TIM6->SR = 0U;
+  TIM6->DIER = TIM_DIER_UIE;
+
+  HAL_NVIC_SetPriority(TIM6_DAC_IRQn, irqtablePRIORITY(TIM6_DAC), 0U);
+  HAL_NVIC_ClearPendingIRQ(TIM6_DAC_IRQn);
+  HAL_NVIC_EnableIRQ(TIM6_DAC_IRQn);
+
+  TIM6->CR1 = TIM_CR1_CEN;
+}
+
+/**
+  * @brief  Empty a set of figures.
+  * @retval None
+  */
+static void prvResetStats(IrqLatStats_t *pxStats)
+{
+  *pxStats = (IrqLatStats_t) { 0 };
+  pxStats->ulMin = UINT32_MAX;
+}
+
+/**
+  * @brief  Log one period's figures, and the port's masked section figures
+  *         when the mask profiler is built in.
+  * @retval None
+  */
+static void prvReport(const IrqLatStats_t *pxStats)
+{
+  uint32_t ulLimit = 1UL << irqlatFIRST_BUCKET_SHIFT;
+  uint32_t ulBucket;
+#if (configUSE_MASK_PROFILER == 1)
+  PortMaskProfile_t xMasked;
+#endif
+
+  if (pxStats->ulCount == 0U)
+  {
+    (void) xLogPrintf("irqlat: no samples\n\r");
+  }
+  else
+  {
+    (void) xLogPrintf("irqlat: %lu samples, entry min %lu max %lu jitter %lu cycles, worst at 0x%08lx\n\r",
+                      (unsigned long) pxStats->ulCount, (unsigned long) pxStats->ulMin,
+                      (unsigned long) pxStats->ulMax, (unsigned long) (pxStats->ulMax - pxStats->ulMin),
+                      (unsigned long) pxStats->ulMaxAt);
+
+    for (ulBucket = 0U; ulBucket < irqlatBUCKETS; ulBucket++, ulLimit <<= 1)
+    {
+      if (pxStats->ulBuckets[ulBucket] == 0U)
+      {
+        continue;
+      }
+
+      if (ulBucket < (irqlatBUCKETS - 1U))
+      {
+        (void) xLogPrintf("irqlat <%lu: %lu\n\r", (unsigned long) ulLimit,
+                          (unsigned long) pxStats->ulBuckets[ulBucket]);
+      }
+      else
+      {
+        (void) xLogPrintf("irqlat >=%lu: %lu\n\r", (unsigned long) (ulLimit >> 1),
+                          (unsigned long) pxStats->ulBuckets[ulBucket]);
+      }
+    }
+  }
+
+#if (configUSE_MASK_PROFILER == 1)
+  vPortGetMaskProfile(&xMasked, pdTRUE);
+  (void) xLogPrintf("masked: %lu sections, longest %lu cycles, raised at 0x%08lx cleared at 0x%08lx\n\r",
+                    (unsigned long) xMasked.ulCount, (unsigned long) xMasked.ulMaxTime,
+                    (unsigned long) xMasked.ulMaxRaisedAt, (unsigned long) xMasked.ulMaxClearedAt);
+#endif
+
+#if (configUSE_SECTION_PROFILER == 1)
+  prvReportSites(eSectionMasked, "crit");
+  prvReportSites(eSectionSchedulerSuspended, "susp");
+#endif
+}
+
+#if (configUSE_SECTION_PROFILER == 1)
+/**
+  * @brief  Log and clear the worst irqlatSITES call sites of one section type.
+  * @param  eType Sections to report.
+  * @param  pcName Line prefix.
+  * @retval None
+  */
+static void prvReportSites(eSectionType eType, const char *pcName)
+{
+  UBaseType_t uxSites = uxTaskGetSectionProfile(eType, xSites, irqlatSITES, pdTRUE);
+  UBaseType_t ux;
+
+  for (ux = 0U; ux < uxSites; ux++)
+  {
+    (void) xLogPrintf("%s 0x%08lx: %lu x, max %lu avg %lu cycles\n\r", pcName,
+                      (unsigned long) xSites[ux].ulSite, (unsigned long) xSites[ux].ulCount,
+                      (unsigned long) xSites[ux].ulMaxTime,
+                      (unsigned long) (xSites[ux].ulTotalTime / xSites[ux].ulCount));
+  }
+}
+#endif
+
+#endif /* irqlatENABLE */
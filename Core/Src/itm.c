@@ -0,0 +1,160 @@
+/**
+  ******************************************************************************
+  * @file           : itm.c
+  * @brief          : SWO output through the ITM stimulus ports.
+  ******************************************************************************
+  * Each ITM write fills the one word stimulus FIFO of a port, which the TPIU
+  * shifts out on TRACESWO at the SWO rate.  Whole words are written where the
+  * message allows, so a FIFO slot carries four bytes rather than one.
+  *
+  * A message is written with interrupts masked up to
+  * configMAX_SYSCALL_INTERRUPT_PRIORITY, as the log ring is, so that messages
+  * from different writers never interleave on a port.  At 2 Mbit/s that holds
+  * off those interrupts for 5 us per byte, 0.5 ms for a full xLogPrintf()
+  * line; the interrupts above the kernel priority keep running.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "itm.h"
+
+/* Private define ------------------------------------------------------------*/
+
+/* Unlocks the ITM registers other than the stimulus ports. */
+#define itmUNLOCK_KEY               0xC5ACCE55UL
+
+/* SPPR protocol and FFCR value for asynchronous NRZ output, formatter off. */
+#define itmPROTOCOL_NRZ             2UL
+#define itmFFCR_TRIGIN              0x100UL
+
+/* ATB ID of the ITM trace stream. */
+#define itmTRACE_BUS_ID             1UL
+
+/* Private variables ---------------------------------------------------------*/
+static BaseType_t xReady = pdFALSE;
+
+/* Private function prototypes -----------------------------------------------*/
+static size_t prvItmLogWrite(const void *pvData, size_t xLength);
+static void prvItmWait(uint8_t ucPort);
+
+/* Exported variables --------------------------------------------------------*/
+const LogSink_t xItmLogSink = { prvItmLogWrite };
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Start the SWO output and enable the stimulus ports in itmPORTS.
+  * @note   Overrides what a debugger set up, so the debugger's SWO rate must
+  *         match itmSWO_BAUD at the current HCLK.
+  * @retval None
+  */
+void vItmInit(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+  /* Trace pins on, in the asynchronous mode that only needs TRACESWO. */
+  DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+
+  TPI->SPPR = itmPROTOCOL_NRZ;
+  TPI->FFCR = itmFFCR_TRIGIN;
+  xReady = pdTRUE;
+  vItmUpdateClock();
+
+  ITM->LAR = itmUNLOCK_KEY;
+  ITM->TCR = 0UL;
+  ITM->TPR = 0UL;
+  ITM->TER = itmPORTS;
+  ITM->TCR = (itmTRACE_BUS_ID << ITM_TCR_TraceBusID_Pos) | ITM_TCR_SYNCENA_Msk | ITM_TCR_ITMENA_Msk;
+}
+
+/**
+  * @brief  Keep the SWO rate at itmSWO_BAUD for the current HCLK.  Called by
+  *         xClockProfileSet().
+  * @retval None
+  */
+void vItmUpdateClock(void)
+{
+  if (xReady == pdFALSE)
+  {
+    return;
+  }
+
+  TPI->ACPR = ((HAL_RCC_GetHCLKFreq() + (itmSWO_BAUD / 2U)) / itmSWO_BAUD) - 1U;
+}
+
+/**
+  * @brief  Send bytes on a stimulus port.
+  * @param  ucPort  Port number, 0 to 31.
+  * @param  pvData  Bytes to send.
+  * @param  xLength Number of bytes.
+  * @retval xLength, or 0 if the port is not enabled.
+  */
+size_t xItmWrite(uint8_t ucPort, const void *pvData, size_t xLength)
+{
+  const uint8_t *pucData = (const uint8_t *) pvData;
+  UBaseType_t uxSavedInterruptStatus;
+  uint32_t ulWord;
+  size_t xLeft;
+
+  if ((xLength == 0U) || (xItmIsEnabled(ucPort) == pdFALSE))
+  {
+    return 0U;
+  }
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  for (xLeft = xLength; xLeft >= sizeof(ulWord); xLeft -= sizeof(ulWord))
+  {
+    memcpy(&ulWord, pucData, sizeof(ulWord));
+    pucData += sizeof(ulWord);
+    prvItmWait(ucPort);
+    ITM->PORT[ucPort].u32 = ulWord;
+  }
+
+  for (; xLeft != 0U; xLeft--)
+  {
+    prvItmWait(ucPort);
+    ITM->PORT[ucPort].u8 = *pucData++;
+  }
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+
+  return xLength;
+}
+
+/**
+  * @brief  Whether writes to a stimulus port go anywhere.
+  * @param  ucPort Port number, 0 to 31.
+  * @retval pdTRUE if the ITM and the port are both enabled.
+  */
+BaseType_t xItmIsEnabled(uint8_t ucPort)
+{
+  return ((ucPort < 32U) && ((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0UL) &&
+          ((ITM->TER & (1UL << ucPort)) != 0UL)) ? pdTRUE : pdFALSE;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  pxWrite of xItmLogSink.
+  * @retval xLength, or 0 if itmPORT_LOG is not enabled.
+  */
+static size_t prvItmLogWrite(const void *pvData, size_t xLength)
+{
+  return xItmWrite(itmPORT_LOG, pvData, xLength);
+}
+
+/**
+  * @brief  Wait for room in the stimulus FIFO of a port.
+  * @note   Gives up if a debugger turns the ITM off meanwhile; the write that
+  *         follows is then ignored by the hardware.
+  * @retval None
+  */
+static void prvItmWait(uint8_t ucPort)
+{
+  while ((ITM->PORT[ucPort].u32 == 0UL) && ((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0UL))
+  {
+  }
+}
@@ -0,0 +1,659 @@
+/**
+  ******************************************************************************
+  * @file           : kernbench.c
+  * @brief          : Kernel microbenchmark tasks, see kernbench.h.
+  ******************************************************************************
+  * The bench task starts each test by telling the peer which one to run and
+  * waking it, then repeats its half kernbenchSAMPLES times while the peer
+  * repeats the other half, and waits for the peer to report that it is done.
+  * Each side records into its own statistics, so a time slice landing in
+  * the middle of a record cannot lose a sample, and the bench task merges
+  * the peer's figures into the test's row afterwards.
+  *
+  * The hand-over time is taken from ulKernBenchStamp, which the side giving
+  * up the CPU writes just before the kernel call, so what is timed is the
+  * call, the switch and the return on the other side.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <string.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "kernbench.h"
+#include "irqtable.h"
+#include "taskreg.h"
+#include "dwt.h"
+#include "log.h"
+#include "fmt.h"
+
+#if (kernbenchENABLE == 1)
+
+#if (configUSE_MUTEXES != 1) || (INCLUDE_vTaskPrioritySet != 1)
+#error The kernel benchmark needs configUSE_MUTEXES and INCLUDE_vTaskPrioritySet
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  KERNBENCH_PEER_YIELD = 0,   /*!< Yield back to the bench task.            */
+  KERNBENCH_PEER_NOTIFY,      /*!< Wait for a notification, from either.    */
+  KERNBENCH_PEER_SEMAPHORE,   /*!< Take xSemaphore.                         */
+  KERNBENCH_PEER_MUTEX,       /*!< Take xMutex once told it is held.        */
+  KERNBENCH_PEER_QUEUE        /*!< Echo xRequests into xReplies.            */
+} KernBenchPeer_t;
+
+typedef struct
+{
+  uint32_t ulMin;
+  uint32_t ulMax;
+  uint64_t ullTotal;
+  uint32_t ulCount;
+} KernBenchStats_t;
+
+typedef struct
+{
+  const char *pcName;
+  uint32_t ulParam;
+  KernBenchStats_t xStats;
+} KernBenchResult_t;
+
+/* Private define ------------------------------------------------------------*/
+#define kernbenchSTACK_DEPTH        256U
+
+#if (configUSE_PORT_MEMOPS == 1)
+/* Rows per memops size: memcpy through newlib and the port, aligned and
+   unaligned, then memset through both. */
+#define kernbenchMEMOPS_ROWS        6U
+#else
+#define kernbenchMEMOPS_ROWS        0U
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static const uint16_t usQueueSizes[] = kernbenchQUEUE_SIZES;
+static const uint16_t usMemOpsSizes[] = kernbenchMEMOPS_SIZES;
+
+/* yield, isr_entry, isr_wake, semaphore, mutex and notify, then the queues
+   and the memops rows. */
+static KernBenchResult_t xResults[6U + (sizeof(usQueueSizes) / sizeof(usQueueSizes[0])) +
+                                  (kernbenchMEMOPS_ROWS * (sizeof(usMemOpsSizes) / sizeof(usMemOpsSizes[0])))];
+static size_t xResultCount;
+
+static volatile uint32_t ulKernBenchStamp;
+static volatile KernBenchPeer_t ePeerTest;
+static KernBenchStats_t xPeerStats;
+static KernBenchStats_t *volatile pxIsrStats;
+
+static StaticSemaphore_t xSemaphoreBuffer;
+static StaticSemaphore_t xMutexBuffer;
+static SemaphoreHandle_t xSemaphore;
+static SemaphoreHandle_t xMutex;
+
+static StaticQueue_t xRequestsBuffer;
+static StaticQueue_t xRepliesBuffer;
+static uint8_t ucRequestsStorage[kernbenchQUEUE_MAX_ITEM];
+static uint8_t ucRepliesStorage[kernbenchQUEUE_MAX_ITEM];
+static QueueHandle_t xRequests;
+static QueueHandle_t xReplies;
+
+#if (configUSE_PORT_MEMOPS == 1)
+/* A word more than the longest test, for the unaligned offsets. */
+static uint32_t ulMemSource[(kernbenchMEMOPS_MAX / 4U) + 1U];
+static uint32_t ulMemDest[(kernbenchMEMOPS_MAX / 4U) + 1U];
+#endif
+
+static const char cHeader[] = "kbench,test,param,samples,min,avg,max,hclk_mhz\n\r";
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvKernBenchTask(void *pvParameters);
+static void prvKernBenchPeerTask(void *pvParameters);
+static void prvRunYield(void);
+static void prvRunIsr(void);
+static void prvRunQueue(uint16_t usSize);
+static void prvRunSemaphore(void);
+static void prvRunMutex(void);
+static void prvRunNotify(void);
+#if (configUSE_PORT_MEMOPS == 1)
+static void prvRunMemOps(uint16_t usSize);
+static void prvRunMemCpy(const char *pcName, void *(*pxCopy)(void *, const void *, size_t), uint8_t *pucDest,
+                         const uint8_t *pucSource, uint16_t usSize);
+static void prvRunMemSet(const char *pcName, void *(*pxFill)(void *, int, size_t), uint16_t usSize);
+#endif
+static void prvPeerYield(void);
+static void prvPeerQueue(void);
+static void prvStartPeer(KernBenchPeer_t eTest);
+static void prvFinishPeer(KernBenchStats_t *pxInto);
+static KernBenchStats_t *prvNewResult(const char *pcName, uint32_t ulParam);
+static void prvResetStats(KernBenchStats_t *pxStats);
+static void prvRecord(KernBenchStats_t *pxStats, uint32_t ulCycles);
+static void prvMerge(KernBenchStats_t *pxInto, const KernBenchStats_t *pxFrom);
+static void prvReport(void);
+static void prvEmitText(const char *pcText, size_t xLength);
+static void prvEmit(const char *pcFormat, ...) fmtCHECK(1, 2);
+
+/* Registered tasks ----------------------------------------------------------*/
+TASK_REGISTER_IN(CCM, KBENCH, prvKernBenchTask, NULL, kernbenchSTACK_DEPTH, kernbenchPRIORITY);
+TASK_REGISTER_IN(CCM, KBPEER, prvKernBenchPeerTask, NULL, kernbenchSTACK_DEPTH, kernbenchPEER_PRIORITY);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  TIM7_IRQHandler() of the Bench image, pended by prvRunIsr() only.
+  * @retval None
+  */
+void vKernBenchIRQHandler(void)
+{
+  uint32_t ulCycles = ulDwtCycles() - ulKernBenchStamp;
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  prvRecord(pxIsrStats, ulCycles);
+  vTaskNotifyGiveFromISR(xKBPEERHandle, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Run every test once, report, and delete itself.
+  * @param  pvParameters Unused.
+  * @retval None
+  */
+static void prvKernBenchTask(void *pvParameters)
+{
+  size_t x;
+
+  (void) pvParameters;
+
+  vDwtInit();
+  xSemaphore = xSemaphoreCreateBinaryStatic(&xSemaphoreBuffer);
+  xMutex = xSemaphoreCreateMutexStatic(&xMutexBuffer);
+
+  vTaskDelay(pdMS_TO_TICKS(kernbenchSTART_DELAY_MS));
+
+  /* Keep the log DMA and its interrupts out of the measurements. */
+  while (xLogGetPending() != 0U)
+  {
+    vTaskDelay(1U);
+  }
+
+  prvRunYield();
+  prvRunIsr();
+  prvRunSemaphore();
+  prvRunMutex();
+  prvRunNotify();
+
+  for (x = 0U; x < (sizeof(usQueueSizes) / sizeof(usQueueSizes[0])); x++)
+  {
+    prvRunQueue(usQueueSizes[x]);
+  }
+
+#if (configUSE_PORT_MEMOPS == 1)
+  for (x = 0U; x < (sizeof(usMemOpsSizes) / sizeof(usMemOpsSizes[0])); x++)
+  {
+    prvRunMemOps(usMemOpsSizes[x]);
+  }
+#endif
+
+  prvReport();
+
+  vTaskDelete(NULL);
+}
+
+/**
+  * @brief  Run the peer's half of each test it is started for.
+  * @param  pvParameters Unused.
+  * @retval None
+  */
+static void prvKernBenchPeerTask(void *pvParameters)
+{
+  uint32_t ul;
+
+  (void) pvParameters;
+
+  for (;;)
+  {
+    (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    switch (ePeerTest)
+    {
+      case KERNBENCH_PEER_YIELD:
+        prvPeerYield();
+        break;
+
+      case KERNBENCH_PEER_NOTIFY:
+        for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+        {
+          (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+          prvRecord(&xPeerStats, ulDwtCycles() - ulKernBenchStamp);
+        }
+        break;
+
+      case KERNBENCH_PEER_SEMAPHORE:
+        for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+        {
+          (void) xSemaphoreTake(xSemaphore, portMAX_DELAY);
+          prvRecord(&xPeerStats, ulDwtCycles() - ulKernBenchStamp);
+        }
+        break;
+
+      case KERNBENCH_PEER_MUTEX:
+        for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+        {
+          (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+          (void) xSemaphoreTake(xMutex, portMAX_DELAY);
+          prvRecord(&xPeerStats, ulDwtCycles() - ulKernBenchStamp);
+          (void) xSemaphoreGive(xMutex);
+        }
+        break;
+
+      case KERNBENCH_PEER_QUEUE:
+        prvPeerQueue();
+        break;
+
+      default:
+        break;
+    }
+
+    (void) xTaskNotifyGive(xKBENCHHandle);
+  }
+}
+
+/**
+  * @brief  yield: both tasks at the peer's priority yield to each other, and
+  *         each times the switch into it from the other's stamp.
+  * @retval None
+  */
+static void prvRunYield(void)
+{
+  KernBenchStats_t *pxStats = prvNewResult("yield", 0U);
+  uint32_t ul;
+
+  /* Equal priorities, so waking the peer does not switch to it. */
+  vTaskPrioritySet(NULL, kernbenchPEER_PRIORITY);
+  prvStartPeer(KERNBENCH_PEER_YIELD);
+
+  for (ul = 0U; ul < (kernbenchSAMPLES / 2U); ul++)
+  {
+    ulKernBenchStamp = ulDwtCycles();
+    taskYIELD();
+    prvRecord(pxStats, ulDwtCycles() - ulKernBenchStamp);
+  }
+
+  prvFinishPeer(pxStats);
+  vTaskPrioritySet(NULL, kernbenchPRIORITY);
+}
+
+/**
+  * @brief  The peer's half of yield.  Its first turn comes back from the
+  *         start notification rather than from a yield, so is not recorded.
+  * @retval None
+  */
+static void prvPeerYield(void)
+{
+  uint32_t ul;
+
+  for (ul = 0U; ul < (kernbenchSAMPLES / 2U); ul++)
+  {
+    if (ul != 0U)
+    {
+      prvRecord(&xPeerStats, ulDwtCycles() - ulKernBenchStamp);
+    }
+    ulKernBenchStamp = ulDwtCycles();
+    taskYIELD();
+  }
+}
+
+/**
+  * @brief  isr_entry and isr_wake: pend TIM7_IRQn, whose handler notifies the
+  *         waiting peer.
+  * @retval None
+  */
+static void prvRunIsr(void)
+{
+  KernBenchStats_t *pxWake;
+  uint32_t ul;
+
+  pxIsrStats = prvNewResult("isr_entry", 0U);
+  pxWake = prvNewResult("isr_wake", 0U);
+
+  irqtableREQUIRE_KERNEL(TIM7);
+  HAL_NVIC_SetPriority(TIM7_IRQn, irqtablePRIORITY(TIM7), 0U);
+  HAL_NVIC_ClearPendingIRQ(TIM7_IRQn);
+  HAL_NVIC_EnableIRQ(TIM7_IRQn);
+
+  prvStartPeer(KERNBENCH_PEER_NOTIFY);
+
+  for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+  {
+    ulKernBenchStamp = ulDwtCycles();
+    HAL_NVIC_SetPendingIRQ(TIM7_IRQn);
+    __DSB();
+    __ISB();
+  }
+
+  prvFinishPeer(pxWake);
+  HAL_NVIC_DisableIRQ(TIM7_IRQn);
+}
+
+/**
+  * @brief  queue: send an item to the peer and take its echo back, timing
+  *         the round trip.
+  * @param  usSize Item size in bytes.
+  * @retval None
+  */
+static void prvRunQueue(uint16_t usSize)
+{
+  KernBenchStats_t *pxStats;
+  uint8_t ucItem[kernbenchQUEUE_MAX_ITEM] = { 0U };
+  uint32_t ul;
+
+  if ((usSize == 0U) || (usSize > kernbenchQUEUE_MAX_ITEM))
+  {
+    return;
+  }
+
+  pxStats = prvNewResult("queue", usSize);
+  xRequests = xQueueCreateStatic(1U, usSize, ucRequestsStorage, &xRequestsBuffer);
+  xReplies = xQueueCreateStatic(1U, usSize, ucRepliesStorage, &xRepliesBuffer);
+
+  prvStartPeer(KERNBENCH_PEER_QUEUE);
+
+  for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+  {
+    ulKernBenchStamp = ulDwtCycles();
+    (void) xQueueSend(xRequests, ucItem, portMAX_DELAY);
+    (void) xQueueReceive(xReplies, ucItem, portMAX_DELAY);
+    prvRecord(pxStats, ulDwtCycles() - ulKernBenchStamp);
+  }
+
+  prvFinishPeer(NULL);
+  vQueueDelete(xRequests);
+  vQueueDelete(xReplies);
+}
+
+#if (configUSE_PORT_MEMOPS == 1)
+/**
+  * @brief  memcpy and memset of usSize bytes, newlib against the port.  Only
+  *         the bench task runs, so there is no peer to start.
+  * @retval None
+  */
+static void prvRunMemOps(uint16_t usSize)
+{
+  uint8_t *pucSource = (uint8_t *) ulMemSource;
+  uint8_t *pucDest = (uint8_t *) ulMemDest;
+  size_t x;
+
+  if ((usSize == 0U) || (usSize > kernbenchMEMOPS_MAX))
+  {
+    return;
+  }
+
+  for (x = 0U; x < sizeof(ulMemSource); x++)
+  {
+    pucSource[x] = (uint8_t) (x * 7U);
+  }
+
+  prvRunMemCpy("memcpy_newlib", memcpy, pucDest, pucSource, usSize);
+  prvRunMemCpy("memcpy_port", pvPortMemCpy, pucDest, pucSource, usSize);
+  prvRunMemCpy("memcpy_newlib_ua", memcpy, pucDest + 1U, pucSource + 2U, usSize);
+  prvRunMemCpy("memcpy_port_ua", pvPortMemCpy, pucDest + 1U, pucSource + 2U, usSize);
+  prvRunMemSet("memset_newlib", memset, usSize);
+  prvRunMemSet("memset_port", pvPortMemSet, usSize);
+}
+
+/**
+  * @brief  Time pxCopy over usSize bytes, and check the copy.
+  * @retval None
+  */
+static void prvRunMemCpy(const char *pcName, void *(*pxCopy)(void *, const void *, size_t), uint8_t *pucDest,
+                         const uint8_t *pucSource, uint16_t usSize)
+{
+  KernBenchStats_t *pxStats = prvNewResult(pcName, usSize);
+  uint32_t ul, ulStart;
+
+  for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+  {
+    ulStart = ulDwtCycles();
+    (void) pxCopy(pucDest, pucSource, usSize);
+    prvRecord(pxStats, ulDwtCycles() - ulStart);
+  }
+
+  configASSERT(memcmp(pucDest, pucSource, usSize) == 0);
+}
+
+/**
+  * @brief  Time pxFill over usSize bytes at an aligned destination.
+  * @retval None
+  */
+static void prvRunMemSet(const char *pcName, void *(*pxFill)(void *, int, size_t), uint16_t usSize)
+{
+  KernBenchStats_t *pxStats = prvNewResult(pcName, usSize);
+  uint32_t ul, ulStart;
+
+  for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+  {
+    ulStart = ulDwtCycles();
+    (void) pxFill(ulMemDest, (int) ul, usSize);
+    prvRecord(pxStats, ulDwtCycles() - ulStart);
+  }
+}
+#endif /* configUSE_PORT_MEMOPS */
+
+/**
+  * @brief  The peer's half of queue.
+  * @retval None
+  */
+static void prvPeerQueue(void)
+{
+  uint8_t ucItem[kernbenchQUEUE_MAX_ITEM];
+  uint32_t ul;
+
+  for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+  {
+    (void) xQueueReceive(xRequests, ucItem, portMAX_DELAY);
+    (void) xQueueSend(xReplies, ucItem, portMAX_DELAY);
+  }
+}
+
+/**
+  * @brief  semaphore: give the binary semaphore the peer is blocked on.
+  * @retval None
+  */
+static void prvRunSemaphore(void)
+{
+  KernBenchStats_t *pxStats = prvNewResult("semaphore", 0U);
+  uint32_t ul;
+
+  prvStartPeer(KERNBENCH_PEER_SEMAPHORE);
+
+  for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+  {
+    ulKernBenchStamp = ulDwtCycles();
+    (void) xSemaphoreGive(xSemaphore);
+  }
+
+  prvFinishPeer(pxStats);
+}
+
+/**
+  * @brief  mutex: take the mutex, wake the peer so that it blocks on it and
+  *         raises this task to its priority, then give the mutex up.
+  * @retval None
+  */
+static void prvRunMutex(void)
+{
+  KernBenchStats_t *pxStats = prvNewResult("mutex", 0U);
+  uint32_t ul;
+
+  prvStartPeer(KERNBENCH_PEER_MUTEX);
+
+  for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+  {
+    (void) xSemaphoreTake(xMutex, portMAX_DELAY);
+    (void) xTaskNotifyGive(xKBPEERHandle);
+    ulKernBenchStamp = ulDwtCycles();
+    (void) xSemaphoreGive(xMutex);
+  }
+
+  prvFinishPeer(pxStats);
+}
+
+/**
+  * @brief  notify: notify the peer waiting in ulTaskNotifyTake().
+  * @retval None
+  */
+static void prvRunNotify(void)
+{
+  KernBenchStats_t *pxStats = prvNewResult("notify", 0U);
+  uint32_t ul;
+
+  prvStartPeer(KERNBENCH_PEER_NOTIFY);
+
+  for (ul = 0U; ul < kernbenchSAMPLES; ul++)
+  {
+    ulKernBenchStamp = ulDwtCycles();
+    (void) xTaskNotifyGive(xKBPEERHandle);
+  }
+
+  prvFinishPeer(pxStats);
+}
+
+/**
+  * @brief  Start the peer on a test.  Outside yield the peer is above this
+  *         task, so it runs up to its first wait before this returns.
+  * @retval None
+  */
+static void prvStartPeer(KernBenchPeer_t eTest)
+{
+  prvResetStats(&xPeerStats);
+  ePeerTest = eTest;
+  (void) xTaskNotifyGive(xKBPEERHandle);
+}
+
+/**
+  * @brief  Wait for the peer to finish its half of a test.
+  * @param  pxInto Where to merge what the peer recorded, NULL if nothing.
+  * @retval None
+  */
+static void prvFinishPeer(KernBenchStats_t *pxInto)
+{
+  (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+  if (pxInto != NULL)
+  {
+    prvMerge(pxInto, &xPeerStats);
+  }
+}
+
+/**
+  * @brief  Add a row to the report.
+  * @retval Its statistics, empty.
+  */
+static KernBenchStats_t *prvNewResult(const char *pcName, uint32_t ulParam)
+{
+  KernBenchResult_t *pxResult = &xResults[xResultCount++];
+
+  configASSERT(xResultCount <= (sizeof(xResults) / sizeof(xResults[0])));
+
+  pxResult->pcName = pcName;
+  pxResult->ulParam = ulParam;
+  prvResetStats(&pxResult->xStats);
+
+  return &pxResult->xStats;
+}
+
+/**
+  * @brief  Empty a set of statistics.
+  * @retval None
+  */
+static void prvResetStats(KernBenchStats_t *pxStats)
+{
+  *pxStats = (KernBenchStats_t) { 0 };
+  pxStats->ulMin = UINT32_MAX;
+}
+
+/**
+  * @brief  Add one sample.
+  * @retval None
+  */
+static void prvRecord(KernBenchStats_t *pxStats, uint32_t ulCycles)
+{
+  pxStats->ulMin = (ulCycles < pxStats->ulMin) ? ulCycles : pxStats->ulMin;
+  pxStats->ulMax = (ulCycles > pxStats->ulMax) ? ulCycles : pxStats->ulMax;
+  pxStats->ullTotal += ulCycles;
+  pxStats->ulCount++;
+}
+
+/**
+  * @brief  Add one set of samples to another.
+  * @retval None
+  */
+static void prvMerge(KernBenchStats_t *pxInto, const KernBenchStats_t *pxFrom)
+{
+  pxInto->ulMin = (pxFrom->ulMin < pxInto->ulMin) ? pxFrom->ulMin : pxInto->ulMin;
+  pxInto->ulMax = (pxFrom->ulMax > pxInto->ulMax) ? pxFrom->ulMax : pxInto->ulMax;
+  pxInto->ullTotal += pxFrom->ullTotal;
+  pxInto->ulCount += pxFrom->ulCount;
+}
+
+/**
+  * @brief  Log the header and a row per test.
+  * @retval None
+  */
+static void prvReport(void)
+{
+  const KernBenchStats_t *pxStats;
+  size_t x;
+
+  prvEmitText(cHeader, sizeof(cHeader) - 1U);
+
+  for (x = 0U; x < xResultCount; x++)
+  {
+    pxStats = &xResults[x].xStats;
+    prvEmit("kbench,%s,%lu,%lu,%lu,%lu,%lu,%lu\n\r", xResults[x].pcName,
+            (unsigned long) xResults[x].ulParam,
+            (unsigned long) pxStats->ulCount,
+            (unsigned long) ((pxStats->ulCount != 0U) ? pxStats->ulMin : 0U),
+            (unsigned long) ((pxStats->ulCount != 0U) ? (pxStats->ullTotal / pxStats->ulCount) : 0U),
+            (unsigned long) pxStats->ulMax,
+            (unsigned long) (SystemCoreClock / 1000000U));
+  }
+}
+
+/**
+  * @brief  Queue text once the log ring has room for it.
+  * @retval None
+  */
+static void prvEmitText(const char *pcText, size_t xLength)
+{
+  while ((logRING_SIZE - xLogGetPending()) < xLength)
+  {
+    vTaskDelay(1U);
+  }
+
+  (void) xLogWrite(pcText, xLength);
+}
+
+/**
+  * @brief  Format a row like xLogPrintf() and queue it with prvEmitText().
+  * @retval None
+  */
+static void prvEmit(const char *pcFormat, ...)
+{
+  char cLine[logPRINTF_LENGTH];
+  va_list xArgs;
+  size_t xLength;
+
+  va_start(xArgs, pcFormat);
+  xLength = xFmtVFormat(cLine, sizeof(cLine), pcFormat, xArgs);
+  va_end(xArgs);
+
+  prvEmitText(cLine, xLength);
+}
+
+#endif /* kernbenchENABLE */
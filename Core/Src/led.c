@@ -0,0 +1,455 @@
+/**
+  ******************************************************************************
+  * @file           : led.c
+  * @brief          : TIM4 PWM of the Discovery LEDs, with patterns played by
+  *                   DMA bursts into the compare registers.
+  ******************************************************************************
+  * TIM4 counts microseconds up to a ledFRAME_MS period, with CCR1 to CCR4
+  * preloaded so that a new duty only ever applies at the next update.  The
+  * CC1 match requests DMA1 Stream0 channel 2 once per period, and through
+  * DCR and DMAR that one request writes all four compare registers from the
+  * next frame of usLedFrames.  The compare values are capped at ARR, so CC1
+  * still matches every period with the green LED fully on.
+  *
+  * TIM4's update request would be the obvious trigger, but it shares DMA1
+  * Stream6 with the USART2 transmitter.
+  *
+  * The stream interrupt runs at configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+  * and so is held off by critical sections, which is what keeps the pattern
+  * cursor and the static duties consistent.  It makes no API calls.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "led.h"
+#include "irqtable.h"
+#include "dmabuf.h"
+
+/* Private define ------------------------------------------------------------*/
+#define ledCOUNTER_HZ               1000000UL
+#define ledPERIOD_TICKS             (ledFRAME_MS * (ledCOUNTER_HZ / 1000UL))
+#define ledBUFFER_FRAMES            (2U * ledHALF_FRAMES)
+
+/* DBA is CCR1's offset in words, DBL one less than the registers per burst. */
+#define ledDCR_BURST                ((((uint32_t) offsetof(TIM_TypeDef, CCR1) / 4U) << TIM_DCR_DBA_Pos) | \
+                                     ((LED_COUNT - 1U) << TIM_DCR_DBL_Pos))
+
+/* Cycles of the buffer a finished pattern waits, for its last frames to play. */
+#define ledDRAIN_HALVES             2U
+
+#define ledDMA_STREAM               DMA1_Stream0
+#define ledDMA_FLAGS                (DMA_LIFCR_CTCIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTEIF0 | \
+                                     DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0)
+
+/* Private variables ---------------------------------------------------------*/
+
+/* LED_COUNT compare values per frame, in CCR order; written before use. */
+static __attribute__((section(".noinit"))) DMA_BUFFER_DEFINE(uint16_t, usLedFrames,
+                                                             ledBUFFER_FRAMES * LED_COUNT);
+
+static uint16_t usStatic[LED_COUNT];
+static BaseType_t xReady = pdFALSE;
+
+/* Pattern cursor. */
+static const LedPattern_t *pxPlaying;
+static uint16_t usKeyframe;
+static uint16_t usFrame;
+static uint8_t ucPasses;
+static uint16_t usFrom[LED_COUNT];
+static uint8_t ucDrain;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvFill(uint16_t *pusFrame);
+static void prvAdvance(void);
+static uint16_t prvFramesOf(const LedKeyframe_t *pxKeyframe);
+static void prvStartDma(void);
+static void prvStopDma(void);
+static void prvWriteStatic(void);
+static uint16_t prvCompare(uint16_t usDuty);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Start TIM4 with every LED off.  Call after vPinmuxInit(), which
+  *         hands PD12 to PD15 to TIM4, and after MX_DMA_Init().
+  * @retval None
+  */
+void vLedInit(void)
+{
+  __HAL_RCC_TIM4_CLK_ENABLE();
+
+  TIM4->CR1 = TIM_CR1_ARPE;
+  TIM4->ARR = ledPERIOD_TICKS - 1U;
+  TIM4->CCMR1 = TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1PE |
+                TIM_CCMR1_OC2M_2 | TIM_CCMR1_OC2M_1 | TIM_CCMR1_OC2PE;
+  TIM4->CCMR2 = TIM_CCMR2_OC3M_2 | TIM_CCMR2_OC3M_1 | TIM_CCMR2_OC3PE |
+                TIM_CCMR2_OC4M_2 | TIM_CCMR2_OC4M_1 | TIM_CCMR2_OC4PE;
+  TIM4->DCR = ledDCR_BURST;
+  xReady = pdTRUE;
+  vLedUpdateClock();
+  prvWriteStatic();
+
+  /* Load PSC and the compare values before the outputs are enabled. */
+  TIM4->EGR = TIM_EGR_UG;
+  TIM4->CCER = TIM_CCER_CC1E | TIM_CCER_CC2E | TIM_CCER_CC3E | TIM_CCER_CC4E;
+  TIM4->CR1 |= TIM_CR1_CEN;
+
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  ledDMA_STREAM->PAR = (uint32_t) &TIM4->DMAR;
+  HAL_NVIC_SetPriority(DMA1_Stream0_IRQn, irqtablePRIORITY(DMA1_Stream0), 0U);
+  HAL_NVIC_EnableIRQ(DMA1_Stream0_IRQn);
+}
+
+/**
+  * @brief  Set the duty of an LED outside of any pattern.
+  * @param  eLed   The LED.
+  * @param  usDuty Permille of the period it is on for, 0 to ledFULL.
+  * @note   Applies from the next PWM period.  An LED a playing pattern
+  *         drives takes this duty when the pattern ends or is stopped.
+  * @retval None
+  */
+void vLedSet(Led_t eLed, uint16_t usDuty)
+{
+  size_t x;
+
+  configASSERT(eLed < LED_COUNT);
+
+  taskENTER_CRITICAL();
+  {
+    usStatic[eLed] = (usDuty > ledFULL) ? ledFULL : usDuty;
+
+    if (pxPlaying == NULL)
+    {
+      prvWriteStatic();
+    }
+    else if ((pxPlaying->ucChannels & ledBIT(eLed)) == 0U)
+    {
+      /* Every frame holds the same value for this LED, so the order of these
+         stores against the DMA reads does not matter. */
+      for (x = 0U; x < ledBUFFER_FRAMES; x++)
+      {
+        usLedFrames[(x * LED_COUNT) + (size_t) eLed] = prvCompare(usStatic[eLed]);
+      }
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Play a pattern, replacing any that is playing.
+  * @param  pxPattern Must stay valid while it plays.  The first keyframe
+  *         fades from the LEDs' static duties.
+  * @retval None
+  */
+void vLedPlay(const LedPattern_t *pxPattern)
+{
+  size_t x;
+
+  configASSERT((pxPattern != NULL) && (pxPattern->usKeyframes != 0U));
+  configASSERT(xReady != pdFALSE);
+
+  taskENTER_CRITICAL();
+  {
+    prvStopDma();
+
+    pxPlaying = pxPattern;
+    usKeyframe = 0U;
+    usFrame = 0U;
+    ucPasses = 0U;
+    ucDrain = 0U;
+    for (x = 0U; x < LED_COUNT; x++)
+    {
+      usFrom[x] = usStatic[x];
+    }
+
+    for (x = 0U; x < ledBUFFER_FRAMES; x++)
+    {
+      prvFill(&usLedFrames[x * LED_COUNT]);
+    }
+
+    prvStartDma();
+  }
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Stop any pattern and go back to the static duties.
+  * @retval None
+  */
+void vLedStop(void)
+{
+  taskENTER_CRITICAL();
+  {
+    prvStopDma();
+    pxPlaying = NULL;
+    prvWriteStatic();
+  }
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Whether TIM4 has work that low power mode must not stop.
+  * @retval pdTRUE while a pattern plays or any LED is dimmed.
+  */
+BaseType_t xLedIsBusy(void)
+{
+  size_t x;
+
+  if (pxPlaying != NULL)
+  {
+    return pdTRUE;
+  }
+
+  for (x = 0U; x < LED_COUNT; x++)
+  {
+    if ((usStatic[x] != 0U) && (usStatic[x] != ledFULL))
+    {
+      return pdTRUE;
+    }
+  }
+
+  return pdFALSE;
+}
+
+/**
+  * @brief  Count microseconds at the current APB1 clock.  Called by
+  *         xClockProfileSet(); PSC is loaded at the next update.
+  * @retval None
+  */
+void vLedUpdateClock(void)
+{
+  uint32_t ulTimerHz;
+
+  if (xReady == pdFALSE)
+  {
+    return;
+  }
+
+  ulTimerHz = HAL_RCC_GetPCLK1Freq();
+
+  /* APB1 timers run at twice PCLK1 whenever APB1 is divided. */
+  if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+  {
+    ulTimerHz *= 2U;
+  }
+
+  TIM4->PSC = (ulTimerHz / ledCOUNTER_HZ) - 1U;
+}
+
+/**
+  * @brief  DMA1 Stream0: one half of usLedFrames has been played out and
+  *         can take the next frames, or a finished pattern has drained.
+  * @retval None
+  */
+void vLedDmaIRQHandler(void)
+{
+  uint32_t ulFlags = DMA1->LISR;
+  uint16_t *pusHalf;
+  size_t x;
+
+  DMA1->LIFCR = ledDMA_FLAGS;
+
+  if ((ulFlags & DMA_LISR_TEIF0) != 0U)
+  {
+    /* The stream has disabled itself; hold the static duties. */
+    prvStopDma();
+    pxPlaying = NULL;
+    prvWriteStatic();
+    return;
+  }
+
+  if (pxPlaying == NULL)
+  {
+    return;
+  }
+
+  if (ucDrain != 0U)
+  {
+    ucDrain--;
+    if (ucDrain == 0U)
+    {
+      prvStopDma();
+      pxPlaying = NULL;
+      prvWriteStatic();
+      return;
+    }
+  }
+
+  pusHalf = ((ulFlags & DMA_LISR_TCIF0) != 0U) ? &usLedFrames[ledHALF_FRAMES * LED_COUNT]
+                                               : &usLedFrames[0];
+  for (x = 0U; x < ledHALF_FRAMES; x++)
+  {
+    prvFill(&pusHalf[x * LED_COUNT]);
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Write the compare values of the next frame and step the cursor.
+  *         Once the pattern has finished every frame is the static duties.
+  * @retval None
+  */
+static void prvFill(uint16_t *pusFrame)
+{
+  const LedKeyframe_t *pxKeyframe;
+  uint16_t usFrames;
+  int32_t lFrom;
+  int32_t lTo;
+  size_t x;
+
+  if (ucDrain != 0U)
+  {
+    for (x = 0U; x < LED_COUNT; x++)
+    {
+      pusFrame[x] = prvCompare(usStatic[x]);
+    }
+    return;
+  }
+
+  pxKeyframe = &pxPlaying->pxKeyframes[usKeyframe];
+  usFrames = prvFramesOf(pxKeyframe);
+
+  for (x = 0U; x < LED_COUNT; x++)
+  {
+    if ((pxPlaying->ucChannels & ledBIT(x)) == 0U)
+    {
+      pusFrame[x] = prvCompare(usStatic[x]);
+    }
+    else if (pxKeyframe->ucFade == 0U)
+    {
+      pusFrame[x] = prvCompare(pxKeyframe->usDuty[x]);
+    }
+    else
+    {
+      lFrom = (int32_t) usFrom[x];
+      lTo = (int32_t) pxKeyframe->usDuty[x];
+      pusFrame[x] = prvCompare((uint16_t) (lFrom + (((lTo - lFrom) * (int32_t) (usFrame + 1U)) /
+                                                    (int32_t) usFrames)));
+    }
+  }
+
+  prvAdvance();
+}
+
+/**
+  * @brief  Move to the next frame, keyframe or pass, and on the last frame
+  *         of the last pass leave the pattern's final duties as static ones.
+  * @retval None
+  */
+static void prvAdvance(void)
+{
+  const LedKeyframe_t *pxKeyframe = &pxPlaying->pxKeyframes[usKeyframe];
+  size_t x;
+
+  usFrame++;
+  if (usFrame < prvFramesOf(pxKeyframe))
+  {
+    return;
+  }
+
+  usFrame = 0U;
+  for (x = 0U; x < LED_COUNT; x++)
+  {
+    usFrom[x] = pxKeyframe->usDuty[x];
+  }
+
+  usKeyframe++;
+  if (usKeyframe < pxPlaying->usKeyframes)
+  {
+    return;
+  }
+
+  usKeyframe = 0U;
+  if (pxPlaying->ucRepeat == 0U)
+  {
+    return;
+  }
+
+  ucPasses++;
+  if (ucPasses < pxPlaying->ucRepeat)
+  {
+    return;
+  }
+
+  for (x = 0U; x < LED_COUNT; x++)
+  {
+    if ((pxPlaying->ucChannels & ledBIT(x)) != 0U)
+    {
+      usStatic[x] = (pxKeyframe->usDuty[x] > ledFULL) ? ledFULL : pxKeyframe->usDuty[x];
+    }
+  }
+  ucDrain = ledDRAIN_HALVES;
+}
+
+/**
+  * @brief  Frames a keyframe lasts.
+  * @retval At least one.
+  */
+static uint16_t prvFramesOf(const LedKeyframe_t *pxKeyframe)
+{
+  uint16_t usFrames = (uint16_t) (pxKeyframe->usMs / ledFRAME_MS);
+
+  return (usFrames == 0U) ? 1U : usFrames;
+}
+
+/**
+  * @brief  Start the circular transfer of usLedFrames on CC1 matches.
+  * @retval None
+  */
+static void prvStartDma(void)
+{
+  DMA1->LIFCR = ledDMA_FLAGS;
+  ledDMA_STREAM->M0AR = (uint32_t) usLedFrames;
+  ledDMA_STREAM->NDTR = ledBUFFER_FRAMES * LED_COUNT;
+  ledDMA_STREAM->CR = DMA_CHANNEL_2 | DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC |
+                      DMA_SxCR_CIRC | DMA_SxCR_DIR_0 | DMA_SxCR_TCIE | DMA_SxCR_HTIE |
+                      DMA_SxCR_TEIE;
+  ledDMA_STREAM->CR |= DMA_SxCR_EN;
+
+  TIM4->SR = (uint32_t) ~TIM_SR_CC1IF;
+  TIM4->DIER |= TIM_DIER_CC1DE;
+}
+
+/**
+  * @brief  Stop the transfer, if any, and drop its pending interrupts.
+  * @retval None
+  */
+static void prvStopDma(void)
+{
+  TIM4->DIER &= ~TIM_DIER_CC1DE;
+  ledDMA_STREAM->CR &= ~DMA_SxCR_EN;
+  while ((ledDMA_STREAM->CR & DMA_SxCR_EN) != 0U)
+  {
+  }
+  DMA1->LIFCR = ledDMA_FLAGS;
+  HAL_NVIC_ClearPendingIRQ(DMA1_Stream0_IRQn);
+}
+
+/**
+  * @brief  Load the static duties into the compare registers.
+  * @retval None
+  */
+static void prvWriteStatic(void)
+{
+  TIM4->CCR1 = prvCompare(usStatic[LED_GREEN]);
+  TIM4->CCR2 = prvCompare(usStatic[LED_ORANGE]);
+  TIM4->CCR3 = prvCompare(usStatic[LED_RED]);
+  TIM4->CCR4 = prvCompare(usStatic[LED_BLUE]);
+}
+
+/**
+  * @brief  Compare value of a duty, capped at ARR so that CC1 always matches.
+  * @retval Counter ticks of the period the output is high for.
+  */
+static uint16_t prvCompare(uint16_t usDuty)
+{
+  uint32_t ulCompare = ((uint32_t) usDuty * ledPERIOD_TICKS) / ledFULL;
+
+  return (uint16_t) ((ulCompare > (ledPERIOD_TICKS - 1U)) ? (ledPERIOD_TICKS - 1U) : ulCompare);
+}
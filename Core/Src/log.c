@@ -0,0 +1,539 @@
+/**
+  ******************************************************************************
+  * @file           : log.c
+  * @brief          : Ring buffered, DMA driven log output on USART2.
+  ******************************************************************************
+  * xLogWrite() only copies the message into the ring and, if the channel is
+  * idle, hands the oldest contiguous run of bytes to DMA1 Stream6 through
+  * uarttx.c.  When that transfer completes the stream's interrupt releases the
+  * bytes and starts the next run, so the CPU never polls the TXE flag.  A message that does not
+  * fit is dropped whole and counted rather than blocking the writer.
+  *
+  * The ring is guarded by masking interrupts up to
+  * configMAX_SYSCALL_INTERRUPT_PRIORITY, so it may be written from tasks, from
+  * interrupts at or below that priority, with the scheduler suspended, and
+  * before the scheduler has been started.
+  *
+  * _write() is implemented here too, so newlib's printf() and puts() reach
+  * the ring with one copy per flushed buffer instead of one __io_putchar()
+  * call per character.
+  *
+  * Gathered messages wait in a list beside the ring.  Each one notes the ring
+  * head when it was queued, and the channel sends the ring up to that mark
+  * before its segments, so the order of messages on the line is the order
+  * they were queued in.
+  *
+  * Text written with xLogWrite(), xLogPrintf() and _write() is also kept in
+  * the crash log's RAM ring, so the last of it outlives a reset; gathered
+  * messages are not.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "log.h"
+#include "uarttx.h"
+#include "irqtable.h"
+#include "dmabuf.h"
+#include "crashlog.h"
+
+#if ((logRING_SIZE & (logRING_SIZE - 1U)) != 0U) || (logRING_SIZE > 0xffffU)
+#error logRING_SIZE must be a power of two no larger than one DMA transfer
+#endif
+
+/* The TX stream's interrupt wakes gathered writers. */
+irqtableREQUIRE_KERNEL(DMA1_Stream6);
+
+/* Private variables ---------------------------------------------------------*/
+/* Read by DMA1 Stream6, so it must stay out of CCM.  Bytes are written before
+   they are read, so the startup code need not clear it. */
+static __attribute__((section(".noinit"))) DMA_BUFFER_DEFINE(uint8_t, ucLogRing, logRING_SIZE);
+
+/* Free running indexes; the byte offset is the index modulo logRING_SIZE. */
+static uint32_t ulLogHead = 0U;
+static uint32_t ulLogTail = 0U;
+
+/* Length of the transfer DMA currently owns, zero when the channel is idle,
+   and whether it is a gathered segment rather than ring bytes. */
+static uint32_t ulLogInFlight = 0U;
+static BaseType_t xLogInFlightGather = pdFALSE;
+
+/* Gathered messages in queue order, and their bytes not yet sent. */
+static LogGather_t *pxLogGatherHead = NULL;
+static LogGather_t *pxLogGatherTail = NULL;
+static uint32_t ulLogGatherPending = 0U;
+
+static volatile uint32_t ulLogDropped = 0U;
+
+/* Bytes wait in the ring until vLogInit() has taken over the stream. */
+static BaseType_t xLogStarted = pdFALSE;
+
+/* Private function prototypes -----------------------------------------------*/
+static size_t prvLogCopy(const void *pvData, size_t xLength);
+static void prvLogCopyIn(const void *pvData, size_t xLength);
+static void prvLogGatherWake(LogGather_t *pxGather);
+static void prvLogStartTransfer(void);
+static void prvLogTransferDone(BaseType_t xError);
+
+/* USART2 transmits on DMA1 Stream6, channel 4. */
+static const UartTx_t xLogTx = { USART2, DMA1, LL_DMA_STREAM_6, LL_DMA_CHANNEL_4, prvLogTransferDone };
+
+/* Exported variables --------------------------------------------------------*/
+const LogSink_t xLogUartSink = { prvLogCopy };
+
+/* Swapped whole, so a writer sees either the old sink or the new one. */
+static const LogSink_t *volatile pxLogSink = &xLogUartSink;
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Send all further log output to another sink.
+  * @note   Bytes already in the UART ring still go out on USART2.
+  * @param  pxSink The sink, which must stay valid; NULL restores xLogUartSink.
+  * @retval None
+  */
+void vLogSetSink(const LogSink_t *pxSink)
+{
+  pxLogSink = (pxSink != NULL) ? pxSink : &xLogUartSink;
+}
+
+/**
+  * @brief  Queue bytes for transmission.
+  * @note   A copy goes to the crash log ring, dropped or not.
+  * @param  pvData  Bytes to send.
+  * @param  xLength Number of bytes.
+  * @retval xLength if the message was queued, 0 if it was dropped.
+  */
+size_t xLogWrite(const void *pvData, size_t xLength)
+{
+  if (xLength == 0U)
+  {
+    return 0U;
+  }
+
+#if (crashlogMIRROR_LOG == 1)
+  vCrashLogAppend(pvData, xLength);
+#endif
+
+  if (pxLogSink->pxWrite(pvData, xLength) == 0U)
+  {
+    ulLogDropped++;
+    return 0U;
+  }
+
+  return xLength;
+}
+
+/**
+  * @brief  Format a line with xFmtVFormat() and queue it like xLogWrite().
+  * @note   Costs logPRINTF_LENGTH bytes of stack over the formatter's fixed
+  *         frame, and never touches newlib or the heap.
+  * @retval Characters queued, 0 if the line was dropped.
+  */
+size_t xLogPrintf(const char *pcFormat, ...)
+{
+  char cLine[logPRINTF_LENGTH];
+  va_list xArgs;
+  size_t xLength;
+
+  va_start(xArgs, pcFormat);
+  xLength = xFmtVFormat(cLine, sizeof(cLine), pcFormat, xArgs);
+  va_end(xArgs);
+
+  return xLogWrite(cLine, xLength);
+}
+
+/**
+  * @brief  Queue a message of several segments for USART2, to be sent from
+  *         the caller's buffers without copying them.
+  * @note   Goes to USART2 whatever the sink.  May be called from an interrupt
+  *         at or below configMAX_SYSCALL_INTERRUPT_PRIORITY.
+  * @param  pxGather    Caller owned state, kept until pxDone runs.
+  * @param  pxSegments  Segments in order, each 1 to 65535 bytes, outside CCM
+  *                     and unchanged until pxDone runs.
+  * @param  xCount      Number of segments, at least 1.
+  * @param  pxDone      Called from the USART2 DMA interrupt once the last
+  *                     segment is out, or NULL.
+  * @param  pvParameter Left in pxGather->pvParameter for pxDone.
+  * @retval pdPASS if queued, pdFAIL if a segment cannot be sent by DMA.
+  */
+BaseType_t xLogGather(LogGather_t *pxGather, const LogSegment_t *pxSegments, size_t xCount,
+                      LogGatherDone_t pxDone, void *pvParameter)
+{
+  UBaseType_t uxSavedInterruptStatus;
+  uint32_t ulTotal = 0U;
+  size_t xIndex;
+
+  configASSERT((pxGather != NULL) && (pxSegments != NULL) && (xCount != 0U));
+
+  for (xIndex = 0U; xIndex < xCount; xIndex++)
+  {
+    if ((pxSegments[xIndex].xLength == 0U) || (pxSegments[xIndex].xLength > 0xffffU) ||
+        (xDmaBufferIsReachable(pxSegments[xIndex].pvData, pxSegments[xIndex].xLength) == pdFALSE))
+    {
+      return pdFAIL;
+    }
+    ulTotal += (uint32_t) pxSegments[xIndex].xLength;
+  }
+
+  pxGather->pxNext = NULL;
+  pxGather->pxSegments = pxSegments;
+  pxGather->xCount = xCount;
+  pxGather->xIndex = 0U;
+  pxGather->pxDone = pxDone;
+  pxGather->pvParameter = pvParameter;
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  pxGather->ulMark = ulLogHead;
+  if (pxLogGatherTail == NULL)
+  {
+    pxLogGatherHead = pxGather;
+  }
+  else
+  {
+    pxLogGatherTail->pxNext = pxGather;
+  }
+  pxLogGatherTail = pxGather;
+  ulLogGatherPending += ulTotal;
+
+  prvLogStartTransfer();
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Write a message of several segments as one, without first joining
+  *         them in a buffer of the caller's.
+  * @note   From a task, with the log on USART2 and the segments out of CCM,
+  *         the DMA sends them in place and this waits until it has.
+  *         Otherwise they are copied into the ring together, or written to
+  *         the current sink one after the other.
+  * @param  pxSegments Segments in order.
+  * @param  xCount     Number of segments.
+  * @retval Bytes written, 0 if the message was dropped.
+  */
+size_t xLogWriteSegments(const LogSegment_t *pxSegments, size_t xCount)
+{
+  UBaseType_t uxSavedInterruptStatus;
+  LogGather_t xGather;
+  size_t xTotal = 0U;
+  size_t xIndex;
+
+  for (xIndex = 0U; xIndex < xCount; xIndex++)
+  {
+    xTotal += pxSegments[xIndex].xLength;
+  }
+  if (xTotal == 0U)
+  {
+    return 0U;
+  }
+
+  if (pxLogSink != &xLogUartSink)
+  {
+    for (xIndex = 0U; xIndex < xCount; xIndex++)
+    {
+      if ((pxSegments[xIndex].xLength != 0U) &&
+          (xLogWrite(pxSegments[xIndex].pvData, pxSegments[xIndex].xLength) == 0U))
+      {
+        return 0U;
+      }
+    }
+    return xTotal;
+  }
+
+  if ((xPortIsInsideInterrupt() == pdFALSE) && (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING))
+  {
+    xGather.pvParameter = xTaskGetCurrentTaskHandle();
+    if (xLogGather(&xGather, pxSegments, xCount, prvLogGatherWake, xGather.pvParameter) == pdPASS)
+    {
+      /* The segments and xGather must outlive the DMA. */
+      while (*(volatile size_t *) &xGather.xIndex != xCount)
+      {
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      }
+      return xTotal;
+    }
+  }
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+  if (xTotal > (logRING_SIZE - (ulLogHead - ulLogTail)))
+  {
+    ulLogDropped++;
+    xTotal = 0U;
+  }
+  else
+  {
+    for (xIndex = 0U; xIndex < xCount; xIndex++)
+    {
+      prvLogCopyIn(pxSegments[xIndex].pvData, pxSegments[xIndex].xLength);
+    }
+    prvLogStartTransfer();
+  }
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+
+  return xTotal;
+}
+
+/**
+  * @brief  newlib's write system call, for stdout and stderr.
+  * @note   Text is queued in pieces of at most logRING_SIZE bytes.  A piece
+  *         that does not fit is waited for as logWRITE_WAIT_TICKS allows,
+  *         and then dropped and counted like any other message.
+  * @retval len, so that newlib never retries dropped text.
+  */
+int _write(int file, char *ptr, int len)
+{
+  const LogSink_t *pxSink = pxLogSink;
+  TickType_t xStart;
+  BaseType_t xCanWait;
+  size_t xPiece;
+  size_t xLeft;
+
+  (void) file;
+
+  if (len <= 0)
+  {
+    return 0;
+  }
+
+#if (crashlogMIRROR_LOG == 1)
+  vCrashLogAppend(ptr, (size_t) len);
+#endif
+
+  xCanWait = ((logWRITE_WAIT_TICKS != 0U) && (xPortIsInsideInterrupt() == pdFALSE) &&
+              (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)) ? pdTRUE : pdFALSE;
+  xStart = (xCanWait != pdFALSE) ? xTaskGetTickCount() : 0U;
+
+  for (xLeft = (size_t) len; xLeft != 0U; xLeft -= xPiece)
+  {
+    xPiece = (xLeft > logRING_SIZE) ? logRING_SIZE : xLeft;
+
+    while (pxSink->pxWrite(ptr, xPiece) == 0U)
+    {
+      if ((xCanWait == pdFALSE) || ((logWRITE_WAIT_TICKS != portMAX_DELAY) &&
+                                    ((xTaskGetTickCount() - xStart) >= logWRITE_WAIT_TICKS)))
+      {
+        ulLogDropped++;
+        return len;
+      }
+
+      /* The ring drains at one USART byte time per byte; a tick frees about
+         eleven bytes at 115200 baud. */
+      vTaskDelay(1U);
+    }
+
+    ptr += xPiece;
+  }
+
+  return len;
+}
+
+/**
+  * @brief  Number of messages lost because the ring was full.
+  * @retval Dropped message count since boot.
+  */
+uint32_t ulLogGetDropped(void)
+{
+  return ulLogDropped;
+}
+
+/**
+  * @brief  Whether any queued bytes have not yet left the UART.
+  * @note   DMA and the UART stop in STOP mode, so the low power code must not
+  *         enter it while this returns non-zero.
+  * @retval Number of bytes queued or in flight.
+  */
+size_t xLogGetPending(void)
+{
+  return (size_t) ((ulLogHead - ulLogTail) + ulLogGatherPending);
+}
+
+/**
+  * @brief  Take over DMA1 Stream6 for USART2 and send whatever was written
+  *         before.  Call once, after MX_USART2_UART_Init().
+  * @retval None
+  */
+void vLogInit(void)
+{
+  UBaseType_t uxSavedInterruptStatus;
+
+  vUartTxInit(&xLogTx);
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+  xLogStarted = pdTRUE;
+  prvLogStartTransfer();
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/**
+  * @brief  DMA1 Stream6 interrupt body.
+  * @retval None
+  */
+void vLogDmaIRQHandler(void)
+{
+  vUartTxIRQHandler(&xLogTx);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Copy a message into the ring whole and start sending it; the
+  *         pxWrite of xLogUartSink.
+  * @retval xLength, or 0 if it did not fit.
+  */
+static size_t prvLogCopy(const void *pvData, size_t xLength)
+{
+  UBaseType_t uxSavedInterruptStatus;
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  if (xLength > (logRING_SIZE - (ulLogHead - ulLogTail)))
+  {
+    xLength = 0U;
+  }
+  else
+  {
+    prvLogCopyIn(pvData, xLength);
+    prvLogStartTransfer();
+  }
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+
+  return xLength;
+}
+
+/**
+  * @brief  Copy bytes in at the head of the ring.
+  * @note   Called with interrupts masked, once the room is checked.
+  * @retval None
+  */
+static void prvLogCopyIn(const void *pvData, size_t xLength)
+{
+  uint32_t ulOffset;
+  size_t xFirst;
+
+  ulOffset = ulLogHead & (logRING_SIZE - 1U);
+  xFirst = logRING_SIZE - ulOffset;
+
+  if (xFirst > xLength)
+  {
+    xFirst = xLength;
+  }
+
+  memcpy(&ucLogRing[ulOffset], pvData, xFirst);
+  memcpy(&ucLogRing[0], (const uint8_t *) pvData + xFirst, xLength - xFirst);
+  ulLogHead += xLength;
+}
+
+/**
+  * @brief  pxDone of the gathers xLogWriteSegments() waits for.
+  * @retval None
+  */
+static void prvLogGatherWake(LogGather_t *pxGather)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  vTaskNotifyGiveFromISR((TaskHandle_t) pxGather->pvParameter, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  Retire the finished transfer and start the next one; the pxDone
+  *         of xLogTx.
+  * @param  xError pdTRUE if the stream stopped on an error, in which case the
+  *         bytes in flight are retired all the same.
+  * @retval None
+  */
+static void prvLogTransferDone(BaseType_t xError)
+{
+  UBaseType_t uxSavedInterruptStatus;
+  LogGather_t *pxDone = NULL;
+
+  (void) xError;
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  if (xLogInFlightGather != pdFALSE)
+  {
+    ulLogGatherPending -= ulLogInFlight;
+    pxLogGatherHead->xIndex++;
+    if (pxLogGatherHead->xIndex == pxLogGatherHead->xCount)
+    {
+      pxDone = pxLogGatherHead;
+      pxLogGatherHead = pxDone->pxNext;
+      if (pxLogGatherHead == NULL)
+      {
+        pxLogGatherTail = NULL;
+      }
+    }
+  }
+  else
+  {
+    ulLogTail += ulLogInFlight;
+  }
+  ulLogInFlight = 0U;
+  xLogInFlightGather = pdFALSE;
+  prvLogStartTransfer();
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+
+  /* Unmasked, so the callback may queue the next message. */
+  if ((pxDone != NULL) && (pxDone->pxDone != NULL))
+  {
+    pxDone->pxDone(pxDone);
+  }
+}
+
+/**
+  * @brief  Hand the oldest contiguous run of queued bytes to DMA, or the next
+  *         segment of the oldest gathered message once the ring is sent up
+  *         to its mark.
+  * @note   Called with interrupts masked.
+  * @retval None
+  */
+static void prvLogStartTransfer(void)
+{
+  const LogSegment_t *pxSegment;
+  uint32_t ulOffset;
+  uint32_t ulLength;
+
+  if ((ulLogInFlight != 0U) || (xLogStarted == pdFALSE))
+  {
+    return;
+  }
+
+  ulLength = ulLogHead - ulLogTail;
+  if ((pxLogGatherHead != NULL) && ((pxLogGatherHead->ulMark - ulLogTail) < ulLength))
+  {
+    ulLength = pxLogGatherHead->ulMark - ulLogTail;
+  }
+
+  if (ulLength == 0U)
+  {
+    if (pxLogGatherHead != NULL)
+    {
+      pxSegment = &pxLogGatherHead->pxSegments[pxLogGatherHead->xIndex];
+      vUartTxStart(&xLogTx, pxSegment->pvData, (uint16_t) pxSegment->xLength);
+      ulLogInFlight = (uint32_t) pxSegment->xLength;
+      xLogInFlightGather = pdTRUE;
+    }
+    return;
+  }
+
+  ulOffset = ulLogTail & (logRING_SIZE - 1U);
+
+  if (ulLength > (logRING_SIZE - ulOffset))
+  {
+    ulLength = logRING_SIZE - ulOffset;
+  }
+
+  vUartTxStart(&xLogTx, &ucLogRing[ulOffset], (uint16_t) ulLength);
+  ulLogInFlight = ulLength;
+}
@@ -0,0 +1,492 @@
+/**
+  ******************************************************************************
+  * @file           : lowpower.c
+  * @brief          : Board specific vPortSuppressTicksAndSleep() using STOP
+  *                   mode and the RTC wakeup timer.
+  ******************************************************************************
+  * TIM5 and every other high speed clock stop in STOP mode, so the idle
+  * period is timed by the RTC, which keeps running from the LSI.  The F407 has
+  * no LPTIM and the Discovery board fits no LSE crystal, which leaves the RTC
+  * wakeup timer as the only timer that survives STOP.
+  *
+  * The wakeup timer cannot be read back, so the time actually slept is taken
+  * from the calendar sub-second counter instead.  That is read with the shadow
+  * registers bypassed, because they are not resynchronised until two RTCCLK
+  * periods after wakeup.  The sleep is therefore measured to one ck_apre
+  * period (250 us).  The TIM5 counter is wound on by the time slept, so
+  * the tick that was in progress still ends on its original boundary and
+  * microsecond time carries on across the sleep.
+  *
+  * The LSI is only accurate to a few percent, so kernel time drifts against
+  * the HSI while the part is stopped.  Fitting an LSE and selecting it as
+  * RTCCLK removes the drift without any other change here.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lowpower.h"
+#include "irqtable.h"
+#include "timebase.h"
+#include "log.h"
+#include "led.h"
+#include "uartrx.h"
+#include "accel.h"
+#include "audio.h"
+#include "mic.h"
+#include "usbcdc.h"
+#include "dmacopy.h"
+#include "crc.h"
+
+#if (configUSE_TICKLESS_IDLE == 2)
+
+#if (configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2)
+#error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than 2
+#endif
+
+/* Private define ------------------------------------------------------------*/
+
+/* Calendar values are BCD; the measurement only needs the time of day. */
+#define lpSECONDS_PER_DAY           86400UL
+#define lpRTC_UNITS_PER_DAY         (lpSECONDS_PER_DAY * lpRTC_SUBSECOND_HZ)
+
+/* Longest sleep the 16 bit wakeup reload can time. */
+#define lpMAX_SUPPRESSED_TICKS      ((TickType_t) ((lpRTC_WAKEUP_MAX_COUNT * configTICK_RATE_HZ) / lpRTC_WAKEUP_HZ))
+
+/* Interrupts a wake can be put down to. */
+#define lpIRQ_COUNT                 ((uint32_t) FPU_IRQn + 1U)
+
+/* Private variables ---------------------------------------------------------*/
+/* Sleeps each interrupt ended, lpWAKE_UNKNOWN's last, and the figures, since
+   xLowPowerTakeWakes() last took them.  Written by the idle task with
+   interrupts masked. */
+static uint32_t ulWakes[lpIRQ_COUNT + 1U];
+static LowPowerStats_t xSleepStats;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvRtcUnlock(void);
+static void prvRtcLock(void);
+static uint32_t prvRtcNow(void);
+static void prvRtcStartWakeup(uint32_t ulCounts);
+static void prvRtcStopWakeup(void);
+static void prvRestoreClocksAfterStop(void);
+static void prvRecordWake(void);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Start the LSI and the RTC and route the wakeup timer to its IRQ.
+  * @note   Call before the scheduler is started.  The calendar is reset, which
+  *         is harmless because nothing else in the application uses the RTC.
+  * @retval None
+  */
+void vLowPowerInit(void)
+{
+  __HAL_RCC_PWR_CLK_ENABLE();
+  HAL_PWR_EnableBkUpAccess();
+
+  __HAL_RCC_LSI_ENABLE();
+  while (__HAL_RCC_GET_FLAG(RCC_FLAG_LSIRDY) == RESET)
+  {
+  }
+
+  /* RTCSEL can only be changed after a backup domain reset. */
+  if ((RCC->BDCR & RCC_BDCR_RTCSEL) != RCC_RTCCLKSOURCE_LSI)
+  {
+    __HAL_RCC_BACKUPRESET_FORCE();
+    __HAL_RCC_BACKUPRESET_RELEASE();
+    __HAL_RCC_RTC_CONFIG(RCC_RTCCLKSOURCE_LSI);
+  }
+  __HAL_RCC_RTC_ENABLE();
+
+  prvRtcUnlock();
+
+  RTC->ISR |= RTC_ISR_INIT;
+  while ((RTC->ISR & RTC_ISR_INITF) == 0U)
+  {
+  }
+
+  /* The two prescalers must be written in separate accesses. */
+  RTC->PRER = lpRTC_SYNCH_PREDIV;
+  RTC->PRER |= lpRTC_ASYNCH_PREDIV << RTC_PRER_PREDIV_A_Pos;
+  RTC->TR = 0U;
+  RTC->CR = RTC_CR_BYPSHAD;
+
+  RTC->ISR &= ~RTC_ISR_INIT;
+
+  /* Wakeup clock RTCCLK / 16 (WUCKSEL = 0) while the timer is off. */
+  while ((RTC->ISR & RTC_ISR_WUTWF) == 0U)
+  {
+  }
+  RTC->CR &= ~RTC_CR_WUCKSEL;
+
+  prvRtcLock();
+
+  /* The wakeup event reaches the NVIC through EXTI line 22. */
+  EXTI->IMR |= EXTI_IMR_MR22;
+  EXTI->RTSR |= EXTI_RTSR_TR22;
+  EXTI->PR = EXTI_PR_PR22;
+
+  HAL_NVIC_SetPriority(RTC_WKUP_IRQn, irqtablePRIORITY(RTC_WKUP), 0U);
+  HAL_NVIC_EnableIRQ(RTC_WKUP_IRQn);
+
+  /* Trade a little wakeup latency for a lower STOP current. */
+  HAL_PWREx_EnableFlashPowerDown();
+
+#ifdef DEBUG
+  /* Keep the debug port alive while stopped. */
+  HAL_DBGMCU_EnableDBGStopMode();
+#endif
+}
+
+/**
+  * @brief  RTC wakeup interrupt body, called from RTC_WKUP_IRQHandler().
+  * @note   vPortSuppressTicksAndSleep() does the real work with interrupts
+  *         masked; this only acknowledges the event if it is still pending.
+  * @retval None
+  */
+void vLowPowerWakeupIRQHandler(void)
+{
+  prvRtcStopWakeup();
+}
+
+/**
+  * @brief  Take the sleep figures and the commonest wake causes, and start
+  *         counting again.
+  * @param  pxStats   Receives the figures; may be NULL.
+  * @param  pxWakes   Receives up to xMaxWakes causes, in no order.
+  * @param  xMaxWakes Room in pxWakes; the causes of fewest wakes are left
+  *                   out when there are more.
+  * @note   Task context only, from one task.
+  * @retval Causes written to pxWakes.
+  */
+size_t xLowPowerTakeWakes(LowPowerStats_t *pxStats, LowPowerWake_t *pxWakes, size_t xMaxWakes)
+{
+  size_t xCount = 0U;
+  size_t xLeast;
+  size_t x;
+  uint32_t ulIrq;
+  uint32_t ulWakeCount;
+
+  /* The idle task counts with interrupts masked, so it cannot run while this
+     does. */
+  taskENTER_CRITICAL();
+
+  if (pxStats != NULL)
+  {
+    *pxStats = xSleepStats;
+  }
+  xSleepStats = (LowPowerStats_t) { 0 };
+
+  for (ulIrq = 0U; ulIrq <= lpIRQ_COUNT; ulIrq++)
+  {
+    ulWakeCount = (ulWakes[ulIrq] > 0xFFFFU) ? 0xFFFFU : ulWakes[ulIrq];
+    ulWakes[ulIrq] = 0U;
+
+    if (ulWakeCount == 0U)
+    {
+      continue;
+    }
+
+    if (xCount < xMaxWakes)
+    {
+      xLeast = xCount++;
+    }
+    else
+    {
+      xLeast = 0U;
+      for (x = 1U; x < xMaxWakes; x++)
+      {
+        if (pxWakes[x].usCount < pxWakes[xLeast].usCount)
+        {
+          xLeast = x;
+        }
+      }
+
+      if ((xMaxWakes == 0U) || (pxWakes[xLeast].usCount >= ulWakeCount))
+      {
+        continue;
+      }
+    }
+
+    pxWakes[xLeast].ucIrq = (ulIrq == lpIRQ_COUNT) ? lpWAKE_UNKNOWN : (uint8_t) ulIrq;
+    pxWakes[xLeast].ucReserved = 0U;
+    pxWakes[xLeast].usCount = (uint16_t) ulWakeCount;
+  }
+
+  taskEXIT_CRITICAL();
+
+  return xCount;
+}
+
+/**
+  * @brief  Replacement for the generic SysTick based tickless idle.
+  * @param  xExpectedIdleTime Ticks until the kernel next needs to run.
+  * @retval None
+  */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+  TickType_t xModifiableIdleTime;
+  uint32_t ulUsIntoTick;
+  uint32_t ulCountAtStop;
+  uint32_t ulStart;
+  uint32_t ulElapsed;
+  uint32_t ulSleptUs;
+  uint32_t ulCompleteTicks;
+  uint32_t ulWakeupCounts;
+  uint32_t ulSysclkSource;
+
+  if (xExpectedIdleTime > lpMAX_SUPPRESSED_TICKS)
+  {
+    xExpectedIdleTime = lpMAX_SUPPRESSED_TICKS;
+  }
+
+  __disable_irq();
+  __DSB();
+  __ISB();
+
+  /* A context switch may have been pended since the idle task decided to
+     sleep. */
+  if (eTaskConfirmSleepModeStatus() == eAbortSleep)
+  {
+    __enable_irq();
+    return;
+  }
+
+  /* DMA would freeze mid transfer, so wait for the log in ordinary sleep.
+     STOP would hold up a microsecond event until the next tick, and would
+     stop TIM4 with dimmed LEDs or a pattern half played, USART2 would
+     miss the rest of a conversation on its receive line, SPI1 would
+     stall an accelerometer burst, I2S2 and I2S3 would stop the
+     microphone and the audio, the USB core could not answer the host
+     before it suspends the bus, and a DMA copy or a CRC feed would stop
+     half made. */
+  if ((xLogGetPending() != 0U) || (xTimebaseEventsPending() != pdFALSE) ||
+      (xLedIsBusy() != pdFALSE) || (xUartRxIsBusy() != pdFALSE) ||
+      (xAccelIsBusy() != pdFALSE) || (xAudioIsBusy() != pdFALSE) ||
+      (xMicIsBusy() != pdFALSE) || (xUsbCdcIsBusy() != pdFALSE) ||
+      (xDmaCopyIsBusy() != pdFALSE) || (xCrcIsBusy() != pdFALSE))
+  {
+    __DSB();
+    __WFI();
+    __ISB();
+    prvRecordWake();
+    xSleepStats.ulShallowSleeps++;
+    __enable_irq();
+    return;
+  }
+
+  HAL_SuspendTick();
+  ulCountAtStop = ulTimebaseNowUs();
+  ulUsIntoTick = ulTimebaseUsIntoTick();
+
+  /* Round the wakeup down so that the part is running again, and TIM5 has a
+     chance to raise the final tick itself, when the deadline passes. */
+  ulWakeupCounts = (uint32_t) (((uint64_t) (xExpectedIdleTime - 1U) * lpRTC_WAKEUP_HZ) / configTICK_RATE_HZ);
+
+  /* Leave the pending tick to its handler rather than sleeping past it. */
+  if ((ulWakeupCounts == 0U) || (xTimebaseTickPending() != pdFALSE))
+  {
+    HAL_ResumeTick();
+    __enable_irq();
+    return;
+  }
+
+  ulSysclkSource = __HAL_RCC_GET_SYSCLK_SOURCE();
+  ulStart = prvRtcNow();
+  prvRtcStartWakeup(ulWakeupCounts);
+
+  xModifiableIdleTime = xExpectedIdleTime;
+  configPRE_SLEEP_PROCESSING(xModifiableIdleTime);
+  if (xModifiableIdleTime > 0)
+  {
+    HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+
+    /* Before the clocks are restored, while the waking interrupt is the
+       most likely to be the only one pending. */
+    prvRecordWake();
+    xSleepStats.ulStops++;
+  }
+  configPOST_SLEEP_PROCESSING(xExpectedIdleTime);
+
+  /* STOP always wakes on the HSI with the PLL off. */
+  if (ulSysclkSource == RCC_SYSCLKSOURCE_STATUS_PLLCLK)
+  {
+    prvRestoreClocksAfterStop();
+  }
+
+  ulElapsed = (prvRtcNow() + lpRTC_UNITS_PER_DAY - ulStart) % lpRTC_UNITS_PER_DAY;
+  prvRtcStopWakeup();
+  HAL_NVIC_ClearPendingIRQ(RTC_WKUP_IRQn);
+
+  ulSleptUs = (uint32_t) (((uint64_t) ulElapsed * timebaseCOUNTER_HZ) / lpRTC_SUBSECOND_HZ);
+  xSleepStats.ulStoppedUs += ulSleptUs;
+  ulCompleteTicks = (ulUsIntoTick + ulSleptUs) / timebaseTICK_PERIOD_US;
+
+  /* The last tick of the idle period must come from the tick interrupt so
+     that the task waiting on it is unblocked normally. */
+  if (ulCompleteTicks >= xExpectedIdleTime)
+  {
+    ulCompleteTicks = xExpectedIdleTime - 1U;
+  }
+
+  /* Wind the counter on by the time it was stopped, and the tick compare by
+     the ticks stepped here, so the tick in progress finishes on time. */
+  vTimebaseResumeAfterSleep(ulCountAtStop, ulSleptUs, ulCompleteTicks);
+
+  vTaskStepTick(ulCompleteTicks);
+  /* TIM5 raises the HAL tick too; keep HAL_GetTick() in step with the
+     kernel. */
+  uwTick += ulCompleteTicks;
+  HAL_ResumeTick();
+
+  __enable_irq();
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Count a sleep against the interrupt that ended it, and have the
+  *         kernel charge it to the task that runs next.
+  * @note   Called with interrupts masked, so the waking interrupt is still
+  *         pending.  Should several be, the lowest numbered is taken.
+  * @retval None
+  */
+static void prvRecordWake(void)
+{
+  uint32_t ulIrq = lpIRQ_COUNT;
+  uint32_t ulPending;
+  uint32_t ulWord;
+
+  for (ulWord = 0U; ulWord < ((lpIRQ_COUNT + 31U) / 32U); ulWord++)
+  {
+    ulPending = NVIC->ISPR[ulWord] & NVIC->ISER[ulWord];
+    if (ulPending != 0U)
+    {
+      ulIrq = (ulWord * 32U) + (uint32_t) __builtin_ctz(ulPending);
+      break;
+    }
+  }
+
+  ulWakes[(ulIrq < lpIRQ_COUNT) ? ulIrq : lpIRQ_COUNT]++;
+
+#if (configUSE_TASK_ENERGY_STATS == 1)
+  vTaskAttributeWake();
+#endif
+}
+
+/**
+  * @brief  Remove the RTC register write protection.
+  * @retval None
+  */
+static void prvRtcUnlock(void)
+{
+  RTC->WPR = 0xCAU;
+  RTC->WPR = 0x53U;
+}
+
+/**
+  * @brief  Restore the RTC register write protection.
+  * @retval None
+  */
+static void prvRtcLock(void)
+{
+  RTC->WPR = 0xFFU;
+}
+
+/**
+  * @brief  Read the time of day in ck_apre periods.
+  * @note   With BYPSHAD set the registers are read straight from the counters,
+  *         so the pair is re-read until two consecutive reads agree.
+  * @retval Periods of lpRTC_SUBSECOND_HZ since midnight.
+  */
+static uint32_t prvRtcNow(void)
+{
+  uint32_t ulSubSeconds;
+  uint32_t ulTime;
+  uint32_t ulSeconds;
+
+  do
+  {
+    ulSubSeconds = RTC->SSR;
+    ulTime = RTC->TR;
+  } while ((ulSubSeconds != RTC->SSR) || (ulTime != RTC->TR));
+
+  ulSeconds = (((ulTime & RTC_TR_HT) >> RTC_TR_HT_Pos) * 10U + ((ulTime & RTC_TR_HU) >> RTC_TR_HU_Pos)) * 3600U
+            + (((ulTime & RTC_TR_MNT) >> RTC_TR_MNT_Pos) * 10U + ((ulTime & RTC_TR_MNU) >> RTC_TR_MNU_Pos)) * 60U
+            + (((ulTime & RTC_TR_ST) >> RTC_TR_ST_Pos) * 10U + ((ulTime & RTC_TR_SU) >> RTC_TR_SU_Pos));
+
+  /* SSR counts down from the synchronous prescaler value. */
+  return (ulSeconds * lpRTC_SUBSECOND_HZ) + (lpRTC_SYNCH_PREDIV - (ulSubSeconds & RTC_SSR_SS));
+}
+
+/**
+  * @brief  Arm the wakeup timer.
+  * @param  ulCounts Wakeup period in lpRTC_WAKEUP_HZ counts, 1 to 65536.
+  * @note   Waiting for WUTWF takes up to two RTCCLK periods (about 60 us).
+  * @retval None
+  */
+static void prvRtcStartWakeup(uint32_t ulCounts)
+{
+  prvRtcUnlock();
+
+  RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+  while ((RTC->ISR & RTC_ISR_WUTWF) == 0U)
+  {
+  }
+  RTC->WUTR = ulCounts - 1U;
+
+  /* ISR flags are cleared by writing zero; INIT must stay clear. */
+  RTC->ISR = (uint32_t) ~(RTC_ISR_WUTF | RTC_ISR_INIT);
+  EXTI->PR = EXTI_PR_PR22;
+
+  RTC->CR |= RTC_CR_WUTE | RTC_CR_WUTIE;
+
+  prvRtcLock();
+}
+
+/**
+  * @brief  Disarm the wakeup timer and clear any event it raised.
+  * @retval None
+  */
+static void prvRtcStopWakeup(void)
+{
+  prvRtcUnlock();
+  RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+  RTC->ISR = (uint32_t) ~(RTC_ISR_WUTF | RTC_ISR_INIT);
+  prvRtcLock();
+
+  EXTI->PR = EXTI_PR_PR22;
+}
+
+/**
+  * @brief  Bring SYSCLK back to the PLL after STOP.
+  * @note   PLLCFGR, HSEBYP and the bus prescalers survive STOP, so only the
+  *         HSE, when it feeds the PLL, and the PLL need restarting.  This
+  *         avoids xClockProfileSet(), which would also re-run HAL_InitTick()
+  *         with interrupts masked.
+  * @retval None
+  */
+static void prvRestoreClocksAfterStop(void)
+{
+  if ((RCC->PLLCFGR & RCC_PLLCFGR_PLLSRC) == RCC_PLLSOURCE_HSE)
+  {
+    RCC->CR |= RCC_CR_HSEON;
+    while (__HAL_RCC_GET_FLAG(RCC_FLAG_HSERDY) == RESET)
+    {
+    }
+  }
+
+  __HAL_RCC_PLL_ENABLE();
+  while (__HAL_RCC_GET_FLAG(RCC_FLAG_PLLRDY) == RESET)
+  {
+  }
+
+  __HAL_RCC_SYSCLK_CONFIG(RCC_SYSCLKSOURCE_PLLCLK);
+  while (__HAL_RCC_GET_SYSCLK_SOURCE() != RCC_SYSCLKSOURCE_STATUS_PLLCLK)
+  {
+  }
+}
+
+#endif /* configUSE_TICKLESS_IDLE */
@@ -0,0 +1,172 @@
+/**
+  ******************************************************************************
+  * @file           : mailbox.c
+  * @brief          : Latest value mailboxes, see mailbox.h.
+  ******************************************************************************
+  * The three slot numbers are always 0, 1 and 2 in some order between the
+  * writer, the reader and ulShared, since each side only ever trades its own
+  * for the shared one.  Only the writer sets mailboxFRESH and only the
+  * reader clears it, so a reader that saw it set still finds it set at its
+  * exchange, however many items were published in between, and gets the
+  * newest.
+  *
+  * The exchange is LDREX/STREX, as in trace.c and deferred.c.  The exclusive
+  * monitor is cleared by any exception entry, so it only retries when an
+  * interrupt landed between the two, and then only once per interrupt.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "mailbox.h"
+#include "stm32f4xx.h"
+
+/* Private define ------------------------------------------------------------*/
+#define mailboxSLOT_MASK            0x3UL
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t prvExchange(volatile uint32_t *pulWord, uint32_t ulValue);
+static uint8_t *prvSlot(const Mailbox_t *pxMailbox, uint32_t ulSlot);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  The writer's slot, to fill in place and hand over with
+  *         vMailboxPublish().
+  * @note   Only the mailbox's writer may call this.  The slot changes at
+  *         each publish.
+  * @retval The slot, xItemSize bytes.
+  */
+void *pvMailboxWriteSlot(Mailbox_t *pxMailbox)
+{
+  return prvSlot(pxMailbox, pxMailbox->ulWriteSlot);
+}
+
+/**
+  * @brief  Make the writer's slot the newest item, in place of any the
+  *         reader has not taken, and take the old one to write next.
+  * @note   Only the mailbox's writer may call this, from a task or an
+  *         interrupt.  Never blocks.
+  * @retval None
+  */
+void vMailboxPublish(Mailbox_t *pxMailbox)
+{
+  uint32_t ulOld;
+
+  /* The item must be whole before the reader can see its slot. */
+  __DMB();
+  ulOld = prvExchange(&pxMailbox->ulShared, pxMailbox->ulWriteSlot | mailboxFRESH);
+  pxMailbox->ulWriteSlot = ulOld & mailboxSLOT_MASK;
+
+  pxMailbox->ulWrites++;
+  if ((ulOld & mailboxFRESH) != 0U)
+  {
+    pxMailbox->ulOverwritten++;
+  }
+}
+
+/**
+  * @brief  Copy an item in and publish it.
+  * @note   As vMailboxPublish().
+  * @retval None
+  */
+void vMailboxWrite(Mailbox_t *pxMailbox, const void *pvItem)
+{
+  (void) memcpy(prvSlot(pxMailbox, pxMailbox->ulWriteSlot), pvItem, pxMailbox->xItemSize);
+  vMailboxPublish(pxMailbox);
+}
+
+/**
+  * @brief  Take the newest item, where it lies.
+  * @param  pxFresh Set to pdTRUE if the item was published since the last
+  *                 acquire, else pdFALSE.  May be NULL.
+  * @note   Only the mailbox's reader may call this, from a task or an
+  *         interrupt.  The item stays put until its next acquire or read.
+  * @retval The item, or NULL if none has been published yet.
+  */
+const void *pvMailboxAcquire(Mailbox_t *pxMailbox, BaseType_t *pxFresh)
+{
+  BaseType_t xFresh = pdFALSE;
+
+  if ((pxMailbox->ulShared & mailboxFRESH) != 0U)
+  {
+    pxMailbox->ulReadSlot = prvExchange(&pxMailbox->ulShared, pxMailbox->ulReadSlot) & mailboxSLOT_MASK;
+    __DMB();
+    pxMailbox->xHasValue = pdTRUE;
+    xFresh = pdTRUE;
+  }
+
+  if (pxFresh != NULL)
+  {
+    *pxFresh = xFresh;
+  }
+
+  return (pxMailbox->xHasValue != pdFALSE) ? prvSlot(pxMailbox, pxMailbox->ulReadSlot) : NULL;
+}
+
+/**
+  * @brief  Copy out the newest item.
+  * @note   As pvMailboxAcquire().
+  * @retval pdTRUE if the item was published since the last read, else
+  *         pdFALSE: the same item again, or nothing copied if none has been
+  *         published yet.
+  */
+BaseType_t xMailboxRead(Mailbox_t *pxMailbox, void *pvItem)
+{
+  BaseType_t xFresh;
+  const void *pvLatest = pvMailboxAcquire(pxMailbox, &xFresh);
+
+  if (pvLatest != NULL)
+  {
+    (void) memcpy(pvItem, pvLatest, pxMailbox->xItemSize);
+  }
+
+  return xFresh;
+}
+
+/**
+  * @brief  Items published since boot.
+  * @retval The count.
+  */
+uint32_t ulMailboxGetWrites(const Mailbox_t *pxMailbox)
+{
+  return pxMailbox->ulWrites;
+}
+
+/**
+  * @brief  Items published and then replaced before the reader took them.
+  * @retval The count.
+  */
+uint32_t ulMailboxGetOverwritten(const Mailbox_t *pxMailbox)
+{
+  return pxMailbox->ulOverwritten;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Store ulValue in *pulWord and return what was there, as one step
+  *         for anything else that exchanges it.
+  * @retval The old value.
+  */
+static uint32_t prvExchange(volatile uint32_t *pulWord, uint32_t ulValue)
+{
+  uint32_t ulOld;
+
+  do
+  {
+    ulOld = __LDREXW(pulWord);
+  } while (__STREXW(ulValue, pulWord) != 0U);
+
+  return ulOld;
+}
+
+/**
+  * @brief  Where a slot's item lies.
+  * @retval The slot.
+  */
+static uint8_t *prvSlot(const Mailbox_t *pxMailbox, uint32_t ulSlot)
+{
+  return &pxMailbox->pucSlots[ulSlot * pxMailbox->xItemSize];
+}
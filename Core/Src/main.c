@@ -23,6 +23,37 @@
 /* USER CODE BEGIN Includes */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "trace.h"
+#include "log.h"
+#include "lowpower.h"
+#include "tasktable.h"
+#include "stackcheck.h"
+#include "periodic.h"
+#include "clockprofile.h"
+#include "governor.h"
+#include "cpustats.h"
+#include "dmabuf.h"
+#include "boottime.h"
+#include "pinmux.h"
+#include "led.h"
+#include "uartrx.h"
+#include "uartline.h"
+#include "itm.h"
+#include "kernbench.h"
+#include "irqlat.h"
+#include "accel.h"
+#include "audio.h"
+#include "mic.h"
+#include "usbcdc.h"
+#include "button.h"
+#include "dmacopy.h"
+#include "crc.h"
+#include "crashlog.h"
+#include "fault.h"
+#include "watchdog.h"
+#include "workerpool.h"
+#include "irqtable.h"
+#include "shell.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -32,6 +63,15 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+/* Free heap left, over every region, below which the log gets a warning. */
+#define mainHEAP_LOW_BYTES (4U * 1024U)
+/* How often the periodic executor beats, and how late it may be, print_job
+   included. */
+#define mainEXECUTOR_BEAT_MS 500U
+#define mainEXECUTOR_DEADLINE_MS 1500U
+/* Reports print_job makes before a block still allocated is listed as a
+   possible leak. */
+#define mainHEAP_LEAK_AGE 10U
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -41,65 +81,100 @@
 
 /* Private variables ---------------------------------------------------------*/
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_tx;
 
 /* USER CODE BEGIN PV */
+#if (shellENABLE == 0)
+static PeriodicJob_t xPrintJob;
+#endif
+#if (watchdogENABLE == 1)
+static PeriodicJob_t xExecutorBeatJob;
+static WatchdogHeartbeat_t xExecutorHeartbeat;
+#endif
+#if (configHEAP_GUARD == 1)
+/* Header that failed its check, for the debugger. */
+void * volatile pvHeapCorruptedBlock = NULL;
+#endif
+#if (configUSE_TASK_FPU_POLICY == 1)
+/* Integer only task that was switched out with an FPU frame, for the debugger. */
+volatile TaskHandle_t xFpuMisuseTask = NULL;
+#endif
+
+/* Red blinks at 1 Hz and green at 0.5 Hz, both starting on. */
+static const LedKeyframe_t xBlinkKeyframes[] =
+{
+  /*  Green    Orange  Red      Blue  Ms    Fade */
+  { { ledFULL, 0U,     ledFULL, 0U }, 500U, 0U },
+  { { ledFULL, 0U,     0U,      0U }, 500U, 0U },
+  { { 0U,      0U,     ledFULL, 0U }, 500U, 0U },
+  { { 0U,      0U,     0U,      0U }, 500U, 0U },
+};
+
+static const LedPattern_t xBlinkPattern =
+{
+  xBlinkKeyframes,
+  sizeof(xBlinkKeyframes) / sizeof(xBlinkKeyframes[0]),
+  ledBIT(LED_GREEN) | ledBIT(LED_RED),
+  0U
+};
 
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
-static void MX_GPIO_Init(void);
+void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART2_UART_Init(void);
 /* USER CODE BEGIN PFP */
+#if (configUSE_HEAP_WATCH == 1)
+static void prvHeapLow(void *pvContext, size_t xFreeBytes, size_t xLargestFreeBlock);
+#endif
+#if (watchdogENABLE == 1)
+static void prvExecutorBeat(void *pvParameter);
+#endif
 
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
-void red_LED_task(void *pvParameters)
+void job1(void *pvArg)
 {
-	while (1) {
-		HAL_GPIO_TogglePin(GPIOD, GPIO_PIN_14);
-		vTaskDelay(500);
-	}
+	(void) pvArg;
 }
 
-void green_LED_task(void *pvParameters)
+void job2(void *pvArg)
 {
-	while (1) {
-		HAL_GPIO_TogglePin(GPIOD, GPIO_PIN_12);
-		vTaskDelay(1000);
-	}
+	(void) pvArg;
 }
 
-void task1(void *pvParameters)
+void job3(void *pvArg)
 {
-    while (1) {
-        vTaskDelete(NULL);
-    }
+	(void) pvArg;
 }
 
-void task2(void *pvParameters)
+void print_job(void *pvParameter)
 {
-    while (1) {
-        vTaskDelete(NULL);
-    }
+	/* The figures only move with the free list, so an idle heap costs no
+	UART time at all. */
+	if (xPrintHeapChanges() != pdFALSE)
+	{
+		vPrintHeapStats();
+	}
+#if (configHEAP_TRACK_OWNERS == 1)
+	vPrintHeapOwners();
+	vPrintHeapLeaks(mainHEAP_LEAK_AGE);
+#endif
+	vStackCheckReport();
+	vCpuStatsPrintSwitchTime();
 }
 
-void task3(void *pvParameters)
-{
-    while (1) {
-        vTaskDelete(NULL);
-    }
-}
+/* Static TCBs and stacks for every row of APP_TASK_TABLE. */
+APP_TASK_TABLE(tasktableREGISTER)
 
-void print_task(void *pvParameters)
-{
-    while (1) {
-		vPrintFreeList();
-		vTaskDelay(3000);
-	}
-}
+_Static_assert((0U APP_TASK_TABLE(tasktableSRAM_BYTES)) <= tasktableSRAM_BUDGET_BYTES,
+               "APP_TASK_TABLE exceeds tasktableSRAM_BUDGET_BYTES");
+_Static_assert((0U APP_TASK_TABLE(tasktableCCM_BYTES)) <= tasktableCCM_BUDGET_BYTES,
+               "APP_TASK_TABLE exceeds tasktableCCM_BUDGET_BYTES");
 /* USER CODE END 0 */
 
 /**
@@ -118,26 +193,96 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
+#if (clockFAST_BOOT == 1)
+  (void) xClockProfileFastBoot();
+#endif
+  vCrashLogInit();
+  vFaultInit();
+  vBootTimeMark(BOOT_PHASE_HAL_INIT);
 
   /* USER CODE END Init */
 
-  /* Configure the system clock */
-  SystemClock_Config();
-
   /* USER CODE BEGIN SysInit */
-
+  /* Lab4.ioc leaves the SystemClock_Config() call to this block. */
+#if (clockFAST_BOOT == 0)
+  SystemClock_Config();
+#endif
+  vBootTimeMark(BOOT_PHASE_CLOCK_CONFIG);
+#if (clockFAST_BOOT == 0)
+  /* SystemClock_Config() leaves the low power profile; stay on it if the
+     HSE does not start. */
+  (void) xClockProfileSet(clockBOOT_PROFILE);
+#endif
+  vBootTimeMark(BOOT_PHASE_CLOCK_PROFILE);
+  /* MX_GPIO_Init() is kept as the reference for Core/Inc/pintable.h. */
+  vPinmuxInit();
+  vBootTimeMark(BOOT_PHASE_PINMUX);
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
-  MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
   /* USER CODE BEGIN 2 */
-  xTaskCreate(red_LED_task, "RED_LED", 100, NULL, 0, NULL);
-  xTaskCreate(task1, "TASK1", 50, NULL, 0, NULL);
-  xTaskCreate(task2, "TASK2", 30, NULL, 0, NULL);
-  xTaskCreate(green_LED_task, "GREEN_LED", 130, NULL, 0, NULL);
-  xTaskCreate(task3, "TASK3", 40, NULL, 0, NULL);
-  xTaskCreate(print_task, "PRINT", 130, NULL, 0, NULL);
+  /* The generated code takes these from Lab4.ioc; irqtable.h is the plan
+     that is checked, so it has the last word. */
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, irqtablePRIORITY(DMA1_Stream6), 0U);
+  HAL_NVIC_SetPriority(USART2_IRQn, irqtablePRIORITY(USART2), 0U);
+  vUartLineInit();
+  vLogInit();
+  vBootTimeMark(BOOT_PHASE_PERIPHERALS);
+  vDmaBufferCheckAll();
+  vUartRxStart();
+  (void) xAccelStart();
+  (void) xAudioInit();
+  (void) xMicInit();
+  vButtonInit();
+  (void) xDmaCopyInit();
+  (void) xCrcInit();
+  (void) xWorkerPoolInit();
+  (void) xWorkerPoolSubmit(job1, NULL, 0U);
+  (void) xWorkerPoolSubmit(job2, NULL, 0U);
+  (void) xWorkerPoolSubmit(job3, NULL, 0U);
+#if (itmLOG_SINK == 1)
+  vItmInit();
+  vLogSetSink(&xItmLogSink);
+#endif
+#if (usbcdcLOG_SINK == 1)
+  if (xUsbCdcStart() == pdPASS)
+  {
+    vLogSetSink(&xUsbCdcLogSink);
+  }
+#endif
+#if (configUSE_TRACE_RECORDER == 1)
+  vTraceInit();
+#endif
+#if (configUSE_TICKLESS_IDLE == 2)
+  vLowPowerInit();
+#endif
+#if (configUSE_HEAP_WATCH == 1)
+  (void) xPortHeapWatchAdd(mainHEAP_LOW_BYTES, 0U, prvHeapLow, NULL);
+#endif
+  vLedInit();
+  vLedPlay(&xBlinkPattern);
+#if (shellENABLE == 0)
+  /* With the shell the same reports are printed on request instead. */
+  (void) xPeriodicJobStart(&xPrintJob, print_job, NULL, pdMS_TO_TICKS(3000), 0);
+#endif
+#if (watchdogENABLE == 1)
+  vWatchdogRegister(&xExecutorHeartbeat, "periodic", pdMS_TO_TICKS(mainEXECUTOR_DEADLINE_MS));
+  (void) xPeriodicJobStart(&xExecutorBeatJob, prvExecutorBeat, NULL, pdMS_TO_TICKS(mainEXECUTOR_BEAT_MS), 0);
+#endif
+#if (kernbenchENABLE == 0) && (irqlatENABLE == 0)
+  /* The measurement builds stay on clockBOOT_PROFILE. */
+  (void) xGovernorStart();
+#endif
+#if (irqlatENABLE == 1)
+  (void) xIrqLatStart();
+#endif
+  (void) xBootTimeReportStart();
+  (void) xCrashLogReportStart();
+  vBootTimeMark(BOOT_PHASE_APP_INIT);
+  vTaskRegistryStart();
+  vBootTimeMark(BOOT_PHASE_TASKS);
   vTaskStartScheduler();
   /* USER CODE END 2 */
 
@@ -231,12 +376,28 @@ static void MX_USART2_UART_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
   * @retval None
   */
-static void MX_GPIO_Init(void)
+void MX_GPIO_Init(void)
 {
   GPIO_InitTypeDef GPIO_InitStruct = {0};
 
@@ -370,29 +531,98 @@ static void MX_GPIO_Init(void)
 }
 
 /* USER CODE BEGIN 4 */
+/**
+  * @brief  UART error callback.
+  * @param  huart UART handle.
+  * @retval None
+  */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  vUartRxErrorCallback(huart);
+}
 
-/* USER CODE END 4 */
+/**
+  * @brief  Reception event callback, at idle line or half or full buffer.
+  * @param  huart UART handle.
+  * @param  Size  Position reached in the receive buffer.
+  * @retval None
+  */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+  vUartRxEventCallback(huart, Size);
+}
 
+#if (configHEAP_GUARD == 1)
 /**
-  * @brief  Period elapsed callback in non blocking mode
-  * @note   This function is called  when TIM7 interrupt took place, inside
-  * HAL_TIM_IRQHandler(). It makes a direct call to HAL_IncTick() to increment
-  * a global variable "uwTick" used as application time base.
-  * @param  htim : TIM handle
+  * @brief  Called by heap_2.c when a block header or tail canary fails its
+  *         check.
+  * @note   The heap can no longer be trusted, so as with a stack overflow
+  *         the system panics, with the header in pvHeapCorruptedBlock.
+  * @param  pvBlock Header that failed.
   * @retval None
   */
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+void vApplicationHeapCorruptedHook(void *pvBlock)
 {
-  /* USER CODE BEGIN Callback 0 */
+  taskDISABLE_INTERRUPTS();
+  pvHeapCorruptedBlock = pvBlock;
+  vCrashLogPanic(crashlogREASON_HEAP_CORRUPTED, (uint32_t) pvBlock);
+}
+#endif
 
-  /* USER CODE END Callback 0 */
-  if (htim->Instance == TIM7) {
-    HAL_IncTick();
-  }
-  /* USER CODE BEGIN Callback 1 */
+#if (configUSE_TASK_FPU_POLICY == 1)
+/**
+  * @brief  Called from the context switch when an integer only task is
+  *         switched out with an FPU frame.
+  * @note   Either the task needs vTaskSetFpuPolicy(xTask, eTaskFpuAllowed)
+  *         or something it calls uses the FPU unexpectedly.  The system
+  *         panics with the task in xFpuMisuseTask; its stacked PC is near
+  *         the first floating point instruction it ran.
+  * @param  xTask Task switched out.
+  * @param  pcTaskName Its name.
+  * @retval None
+  */
+void vApplicationFpuMisuseHook(TaskHandle_t xTask, char *pcTaskName)
+{
+  (void) pcTaskName;
 
-  /* USER CODE END Callback 1 */
+  taskDISABLE_INTERRUPTS();
+  xFpuMisuseTask = xTask;
+  vCrashLogPanic(crashlogREASON_FPU_MISUSE, (uint32_t) xTask);
 }
+#endif
+
+#if (configUSE_HEAP_WATCH == 1)
+/**
+  * @brief  Heap watch callback, run once each time the free heap falls under
+  *         mainHEAP_LOW_BYTES.
+  * @param  pvContext Unused.
+  * @param  xFreeBytes Bytes left free.
+  * @param  xLargestFreeBlock Not measured by this watch.
+  * @retval None
+  */
+static void prvHeapLow(void *pvContext, size_t xFreeBytes, size_t xLargestFreeBlock)
+{
+  (void) pvContext;
+  (void) xLargestFreeBlock;
+  (void) xLogPrintf("heap low: %lu bytes free\n\r", (unsigned long) xFreeBytes);
+}
+#endif
+
+#if (watchdogENABLE == 1)
+/**
+  * @brief  Periodic job that shows the watchdog the executor still runs its
+  *         jobs in time.
+  * @param  pvParameter Unused.
+  * @retval None
+  */
+static void prvExecutorBeat(void *pvParameter)
+{
+  (void) pvParameter;
+  vWatchdogBeat(&xExecutorHeartbeat);
+}
+#endif
+
+/* USER CODE END 4 */
 
 /**
   * @brief  This function is executed in case of error occurrence.
@@ -401,11 +631,9 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
-  /* User can add his own implementation to report the HAL error return state */
-  __disable_irq();
-  while (1)
-  {
-  }
+  /* Kept in the crash log with the caller, which is where the HAL call
+     failed. */
+  vCrashLogPanic(crashlogREASON_ERROR_HANDLER, (uint32_t) __builtin_return_address(0));
   /* USER CODE END Error_Handler_Debug */
 }
 
@@ -0,0 +1,513 @@
+/**
+  ******************************************************************************
+  * @file           : mic.c
+  * @brief          : PDM capture on I2S2 by DMA1 Stream3, with the CIC and FIR
+  *                   decimators run on the half and complete transfer
+  *                   interrupts.
+  ******************************************************************************
+  * CIC stage.  A third order CIC decimating by 16 is an FIR of the box of 16
+  * convolved with itself three times, 46 taps adding up to 4096.  Each output
+  * then covers six PDM bytes, each byte adding a sum that depends only on its
+  * value and its place, so tables of those sums replace the bit by bit
+  * integrators.  Consecutive outputs are 16 bits apart, so one pass over
+  * eight bytes makes two, each table entry holding a byte's share of both in
+  * its two halves, added with one SADD16.  Sums stay within +-4096, so the
+  * halves never saturate.
+  *
+  * FIR stage.  A 64 tap Hamming windowed sinc, 6 kHz cut-off at 64 kHz, in
+  * Q15: flat to 4.5 kHz and 52 dB down at the 8 kHz Nyquist of the output.
+  * It is symmetric, so its taps apply in either order, and pairs of them
+  * multiply pairs of CIC outputs with SMLAD.  CIC droop is under 0.2 dB at
+  * 4 kHz and left alone.
+  *
+  * SPI2_RX is DMA1 Stream3 channel 0.  The decimators take about 40 us of a
+  * 2 ms block at 168 MHz; the interrupt runs at
+  * configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY alongside the other
+  * peripherals'.  There is no I2S HAL module in the tree, so I2S2 is driven
+  * at register level, like I2S3 in audio.c.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "mic.h"
+#include "irqtable.h"
+#include "dmabuf.h"
+#include "dwt.h"
+#include "clockprofile.h"
+
+#if ((micCIC_DECIMATION * micFIR_DECIMATION) != micPDM_RATIO)
+#error micCIC_DECIMATION and micFIR_DECIMATION must make up micPDM_RATIO
+#endif
+
+/* Private define ------------------------------------------------------------*/
+
+/* Bit clock: two 16 bit I2S slots of PDM per stereo frame. */
+#define micBIT_CLOCK_HZ             (micSAMPLE_RATE_HZ * micPDM_RATIO)
+
+#define micCIC_ORDER                3U
+#define micCIC_TAPS                 ((micCIC_ORDER * (micCIC_DECIMATION - 1U)) + 1U)
+#define micCIC_BYTES                6U   /* An output's span, 46 taps padded. */
+#define micCIC_WINDOW_BYTES         8U   /* Two outputs' span. */
+
+/* PDM halfwords per half of the DMA buffer, and CIC outputs per block. */
+#define micHALF_WORDS               ((micBLOCK_SAMPLES * micPDM_RATIO) / 16U)
+#define micBLOCK_CIC_SAMPLES        (micBLOCK_SAMPLES * micFIR_DECIMATION)
+
+/* CIC outputs the FIR still needs from the previous block. */
+#define micFIR_HISTORY              (micFIR_TAPS - micFIR_DECIMATION)
+
+/* Alternating bits, a PDM zero, to start the CIC from. */
+#define micPDM_SILENCE              0xAAAAAAAAUL
+
+/* DC blocker pole, 0.995 in Q15. */
+#define micDC_POLE_Q15              32604
+
+#define micSTREAM_BYTES             (micSTREAM_SAMPLES * sizeof(int16_t))
+
+#define micSTREAM                   DMA1_Stream3
+#define micDMA_FLAGS                (DMA_LIFCR_CTCIF3 | DMA_LIFCR_CHTIF3 | DMA_LIFCR_CTEIF3 | \
+                                     DMA_LIFCR_CDMEIF3 | DMA_LIFCR_CFEIF3)
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Written by DMA1 Stream3 while running. */
+static __attribute__((section(".noinit"))) DMA_BUFFER_DEFINE(uint16_t, usMicPdm, 2U * micHALF_WORDS);
+
+/* Half of the FIR, the other half mirrors it. */
+static const int16_t sFirHalf[micFIR_TAPS / 2U] =
+{
+     -8,   -22,   -31,   -32,   -21,     5,    42,    77,
+     93,    75,    14,   -79,  -176,  -234,  -212,   -93,
+    108,   333,   495,   506,   312,   -75,  -564,  -994,
+  -1170,  -925,  -174,  1045,  2561,  4103,  5360,  6065
+};
+
+/* Built by xMicInit().  CCM, as only the CPU reads them. */
+static uint32_t ulCicTable[micCIC_WINDOW_BYTES][256] __attribute__((section(".ccmbss")));
+static int16_t sFirTaps[micFIR_TAPS] __attribute__((aligned(4)));
+
+/* CIC outputs, the FIR history first. */
+static int16_t sCicOut[micFIR_HISTORY + micBLOCK_CIC_SAMPLES] __attribute__((aligned(4)));
+static uint32_t ulPdmPrevious;
+static int32_t lDcLastIn;
+static int32_t lDcLastOut;
+
+/* A static stream buffer holds one byte less than it is given, so this one
+   holds a whole number of samples. */
+static uint8_t ucMicStorage[micSTREAM_BYTES + 1U];
+static StaticStreamBuffer_t xMicStreamStruct;
+static StreamBufferHandle_t xMicStream = NULL;
+
+static volatile BaseType_t xRunning = pdFALSE;
+static BaseType_t xClockHeld = pdFALSE;
+
+static volatile uint32_t ulOverruns = 0U;
+static volatile uint32_t ulErrors = 0U;
+static volatile uint32_t ulBudgetOverruns = 0U;
+static volatile uint16_t usWorstLoadPermille = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvBuildCicTables(void);
+static void prvDecimate(const uint16_t *pusPdm, BaseType_t *pxHigherPriorityTaskWoken);
+static void prvCic(const uint16_t *pusPdm);
+static void prvFir(int16_t *psOut);
+static uint32_t prvRead2(const int16_t *ps);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Build the filter tables and set up the stream buffer and DMA1
+  *         Stream3.  Call once, after vPinmuxInit(), which hands PB10 and PC3
+  *         to I2S2.
+  * @retval pdPASS.
+  */
+BaseType_t xMicInit(void)
+{
+  uint32_t x;
+
+  __HAL_RCC_SPI2_CLK_ENABLE();
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  vDwtInit();
+
+  prvBuildCicTables();
+  for (x = 0U; x < (micFIR_TAPS / 2U); x++)
+  {
+    sFirTaps[x] = sFirHalf[x];
+    sFirTaps[micFIR_TAPS - 1U - x] = sFirHalf[x];
+  }
+
+  xMicStream = xStreamBufferCreateStatic(sizeof(ucMicStorage), sizeof(int16_t),
+                                         ucMicStorage, &xMicStreamStruct);
+  configASSERT(xMicStream != NULL);
+
+  micSTREAM->PAR = (uint32_t) &SPI2->DR;
+  irqtableREQUIRE_KERNEL(DMA1_Stream3);
+  HAL_NVIC_SetPriority(DMA1_Stream3_IRQn, irqtablePRIORITY(DMA1_Stream3), 0U);
+  HAL_NVIC_EnableIRQ(DMA1_Stream3_IRQn);
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Start clocking the microphone and capturing, with the filters and
+  *         the stream buffer emptied.
+  * @retval pdPASS, or pdFAIL if the PLLI2S did not start.
+  */
+BaseType_t xMicStart(void)
+{
+  uint32_t ulDivider;
+
+  configASSERT(xMicStream != NULL);
+
+  if (xRunning != pdFALSE)
+  {
+    return pdPASS;
+  }
+
+  if ((xClockHeld == pdFALSE) && (xClockProfileI2SAcquire() != pdPASS))
+  {
+    ulErrors++;
+    return pdFAIL;
+  }
+  xClockHeld = pdTRUE;
+
+  (void) memset(sCicOut, 0, sizeof(sCicOut));
+  ulPdmPrevious = micPDM_SILENCE;
+  lDcLastIn = 0;
+  lDcLastOut = 0;
+  (void) xStreamBufferReset(xMicStream);
+
+  micSTREAM->CR &= ~DMA_SxCR_EN;
+  while ((micSTREAM->CR & DMA_SxCR_EN) != 0U)
+  {
+  }
+  DMA1->LIFCR = micDMA_FLAGS;
+  micSTREAM->M0AR = (uint32_t) usMicPdm;
+  micSTREAM->NDTR = 2U * micHALF_WORDS;
+  micSTREAM->CR = DMA_CHANNEL_0 | DMA_SxCR_MINC | DMA_SxCR_PSIZE_0 | DMA_SxCR_MSIZE_0 |
+                  DMA_SxCR_CIRC | DMA_SxCR_PL_1 | DMA_SxCR_HTIE | DMA_SxCR_TCIE |
+                  DMA_SxCR_TEIE | DMA_SxCR_DMEIE;
+  xRunning = pdTRUE;
+  micSTREAM->CR |= DMA_SxCR_EN;
+
+  /* Without MCLK the bit clock is I2SCLK / (2 * DIV + ODD). */
+  ulDivider = (ulClockProfileGetI2SHz() + (micBIT_CLOCK_HZ / 2U)) / micBIT_CLOCK_HZ;
+
+  /* Master receive, LSB justified 16 bit, with the clock idling high as the
+     MP45DT02 clocks out on its falling edge. */
+  SPI2->I2SCFGR = SPI_I2SCFGR_I2SMOD | SPI_I2SCFGR_I2SCFG | SPI_I2SCFGR_I2SSTD_1 | SPI_I2SCFGR_CKPOL;
+  SPI2->I2SPR = ((ulDivider & 1U) << SPI_I2SPR_ODD_Pos) | (ulDivider >> 1U);
+  SPI2->CR2 = SPI_CR2_RXDMAEN;
+  SPI2->I2SCFGR |= SPI_I2SCFGR_I2SE;
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Stop capturing and let the PLLI2S go.  Samples already decimated
+  *         stay readable.
+  * @retval None
+  */
+void vMicStop(void)
+{
+  /* A master receiver stopped mid frame only loses that frame, and the
+     next start begins afresh. */
+  SPI2->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+  SPI2->CR2 = 0U;
+  micSTREAM->CR &= ~DMA_SxCR_EN;
+  xRunning = pdFALSE;
+
+  if (xClockHeld != pdFALSE)
+  {
+    vClockProfileI2SRelease();
+    xClockHeld = pdFALSE;
+  }
+}
+
+/**
+  * @brief  Read decimated samples, waiting for at least one if there are none.
+  * @param  psSamples    Where to put them.
+  * @param  xCount       Most samples to read.
+  * @param  xTicksToWait How long to wait.
+  * @note   Only one task may read.
+  * @retval Samples read, 0 if the wait timed out.
+  */
+size_t xMicRead(int16_t *psSamples, size_t xCount, TickType_t xTicksToWait)
+{
+  configASSERT(xMicStream != NULL);
+
+  return xStreamBufferReceive(xMicStream, psSamples, xCount * sizeof(int16_t), xTicksToWait)
+         / sizeof(int16_t);
+}
+
+/**
+  * @brief  Samples dropped because the reader left the stream buffer full.
+  * @retval Overrun count since boot.
+  */
+uint32_t ulMicGetOverruns(void)
+{
+  return ulOverruns;
+}
+
+/**
+  * @brief  DMA transfer errors and PLLI2S lock failures, each of which stops
+  *         capture until the next xMicStart().
+  * @retval Error count since boot.
+  */
+uint32_t ulMicGetErrors(void)
+{
+  return ulErrors;
+}
+
+/**
+  * @brief  Most a block has taken to decimate, against its period.
+  * @retval Permille of the block period, at the clock it ran at.
+  */
+uint16_t usMicGetWorstLoadPermille(void)
+{
+  return usWorstLoadPermille;
+}
+
+/**
+  * @brief  Blocks that took more than micLOAD_BUDGET_PERMILLE.
+  * @retval Count since boot.
+  */
+uint32_t ulMicGetBudgetOverruns(void)
+{
+  return ulBudgetOverruns;
+}
+
+/**
+  * @brief  Whether the microphone is running.
+  * @note   I2S2 and the DMA stop in STOP mode, so the low power code keeps
+  *         out of STOP while this returns pdTRUE.
+  * @retval pdTRUE while capturing.
+  */
+BaseType_t xMicIsBusy(void)
+{
+  return xRunning;
+}
+
+/**
+  * @brief  DMA1 Stream3 handler body: half of the PDM buffer has filled.
+  * @retval None
+  */
+void vMicDmaIRQHandler(void)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  uint32_t ulFlags = DMA1->LISR;
+
+  DMA1->LIFCR = micDMA_FLAGS;
+
+  if ((ulFlags & (DMA_LISR_TEIF3 | DMA_LISR_DMEIF3)) != 0U)
+  {
+    ulErrors++;
+    SPI2->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+    micSTREAM->CR &= ~DMA_SxCR_EN;
+    xRunning = pdFALSE;
+    return;
+  }
+
+  /* Both flags together mean this interrupt was held off for a whole half,
+     and the first half is being overwritten; it is the older, so it goes
+     first all the same. */
+  if ((ulFlags & DMA_LISR_HTIF3) != 0U)
+  {
+    prvDecimate(&usMicPdm[0], &xHigherPriorityTaskWoken);
+  }
+  if ((ulFlags & DMA_LISR_TCIF3) != 0U)
+  {
+    prvDecimate(&usMicPdm[micHALF_WORDS], &xHigherPriorityTaskWoken);
+  }
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Fill the CIC tables: for each place in a two output window and
+  *         each byte value, the byte's share of the first output in the low
+  *         half and of the second in the high half.
+  * @retval None
+  */
+static void prvBuildCicTables(void)
+{
+  int16_t sTaps[micCIC_BYTES * 8U] = {0};
+  int16_t sBox[micCIC_TAPS] = {0};
+  uint32_t ulLength = 1U;
+  uint32_t ulOrder;
+  uint32_t ulPlace;
+  uint32_t ulByte;
+  uint32_t x;
+  uint32_t y;
+  int32_t lFirst;
+  int32_t lSecond;
+  int32_t lBit;
+
+  /* Convolve a unit impulse with the box micCIC_ORDER times. */
+  sTaps[0] = 1;
+  for (ulOrder = 0U; ulOrder < micCIC_ORDER; ulOrder++)
+  {
+    (void) memset(sBox, 0, sizeof(sBox));
+    for (x = 0U; x < ulLength; x++)
+    {
+      for (y = 0U; y < micCIC_DECIMATION; y++)
+      {
+        sBox[x + y] = (int16_t) (sBox[x + y] + sTaps[x]);
+      }
+    }
+    ulLength += micCIC_DECIMATION - 1U;
+    (void) memcpy(sTaps, sBox, ulLength * sizeof(int16_t));
+  }
+
+  /* A set bit counts +1 and a clear one -1, the first bit in time being the
+     most significant. */
+  for (ulPlace = 0U; ulPlace < micCIC_WINDOW_BYTES; ulPlace++)
+  {
+    for (ulByte = 0U; ulByte < 256U; ulByte++)
+    {
+      lFirst = 0;
+      lSecond = 0;
+      for (x = 0U; x < 8U; x++)
+      {
+        lBit = (((ulByte >> (7U - x)) & 1U) != 0U) ? 1 : -1;
+        if (ulPlace < micCIC_BYTES)
+        {
+          lFirst += lBit * sTaps[(ulPlace * 8U) + x];
+        }
+        if (ulPlace >= 2U)
+        {
+          lSecond += lBit * sTaps[((ulPlace - 2U) * 8U) + x];
+        }
+      }
+      ulCicTable[ulPlace][ulByte] = ((uint32_t) (uint16_t) lFirst) | ((uint32_t) (uint16_t) lSecond << 16);
+    }
+  }
+}
+
+/**
+  * @brief  Decimate one half of the PDM buffer into the stream buffer,
+  *         timing it against the block period.
+  * @retval None
+  */
+static void prvDecimate(const uint16_t *pusPdm, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  int16_t sPcm[micBLOCK_SAMPLES];
+  uint32_t ulStart = ulDwtCycles();
+  uint32_t ulCycles;
+  uint32_t ulPeriod;
+  uint32_t ulLoad;
+  size_t xSent;
+
+  prvCic(pusPdm);
+  prvFir(sPcm);
+
+  xSent = xStreamBufferSendFromISR(xMicStream, sPcm, sizeof(sPcm), pxHigherPriorityTaskWoken);
+  if (xSent < sizeof(sPcm))
+  {
+    ulOverruns += (uint32_t) ((sizeof(sPcm) - xSent) / sizeof(int16_t));
+  }
+
+  ulCycles = ulDwtCycles() - ulStart;
+  ulPeriod = (uint32_t) (((uint64_t) SystemCoreClock * micBLOCK_SAMPLES) / micSAMPLE_RATE_HZ);
+  ulLoad = (uint32_t) (((uint64_t) ulCycles * 1000U) / ulPeriod);
+  if (ulLoad > usWorstLoadPermille)
+  {
+    usWorstLoadPermille = (uint16_t) ((ulLoad > 1000U) ? 1000U : ulLoad);
+  }
+  if (ulLoad > micLOAD_BUDGET_PERMILLE)
+  {
+    ulBudgetOverruns++;
+  }
+}
+
+/**
+  * @brief  CIC decimate a block of PDM into sCicOut, after the FIR history.
+  * @retval None
+  */
+static void prvCic(const uint16_t *pusPdm)
+{
+  uint32_t *pulOut = (uint32_t *) &sCicOut[micFIR_HISTORY];
+  uint32_t ulPrevious = ulPdmPrevious;
+  uint32_t ulCurrent;
+  uint32_t ulSum;
+  uint32_t x;
+
+  /* Each pass takes two new halfwords and the two before them, the earlier
+     one in the upper half of each word, and makes two outputs. */
+  for (x = 0U; x < micHALF_WORDS; x += 2U)
+  {
+    ulCurrent = ((uint32_t) pusPdm[x] << 16) | pusPdm[x + 1U];
+
+    ulSum = ulCicTable[0][ulPrevious >> 24];
+    ulSum = __SADD16(ulSum, ulCicTable[1][(ulPrevious >> 16) & 0xFFU]);
+    ulSum = __SADD16(ulSum, ulCicTable[2][(ulPrevious >> 8) & 0xFFU]);
+    ulSum = __SADD16(ulSum, ulCicTable[3][ulPrevious & 0xFFU]);
+    ulSum = __SADD16(ulSum, ulCicTable[4][ulCurrent >> 24]);
+    ulSum = __SADD16(ulSum, ulCicTable[5][(ulCurrent >> 16) & 0xFFU]);
+    ulSum = __SADD16(ulSum, ulCicTable[6][(ulCurrent >> 8) & 0xFFU]);
+    ulSum = __SADD16(ulSum, ulCicTable[7][ulCurrent & 0xFFU]);
+
+    /* The first output in the low half lands first in memory. */
+    *pulOut++ = ulSum;
+    ulPrevious = ulCurrent;
+  }
+
+  ulPdmPrevious = ulPrevious;
+}
+
+/**
+  * @brief  FIR decimate sCicOut into a block of samples, through the DC
+  *         blocker, and keep the history for the next block.
+  * @retval None
+  */
+static void prvFir(int16_t *psOut)
+{
+  const int16_t *psWindow;
+  int32_t lAccumulator;
+  int32_t lIn;
+  int32_t lOut;
+  uint32_t x;
+  uint32_t y;
+
+  for (x = 0U; x < micBLOCK_SAMPLES; x++)
+  {
+    psWindow = &sCicOut[x * micFIR_DECIMATION];
+    lAccumulator = 0;
+    for (y = 0U; y < micFIR_TAPS; y += 2U)
+    {
+      lAccumulator = (int32_t) __SMLAD(prvRead2(&psWindow[y]), prvRead2(&sFirTaps[y]), (uint32_t) lAccumulator);
+    }
+
+    /* y[n] = x[n] - x[n-1] + a y[n-1] */
+    lIn = lAccumulator >> 15;
+    lOut = (lIn - lDcLastIn) + ((micDC_POLE_Q15 * lDcLastOut) >> 15);
+    lDcLastIn = lIn;
+    lDcLastOut = lOut;
+
+    psOut[x] = (int16_t) __SSAT(lOut * (1 << micGAIN_SHIFT), 16);
+  }
+
+  (void) memmove(sCicOut, &sCicOut[micBLOCK_CIC_SAMPLES], micFIR_HISTORY * sizeof(int16_t));
+}
+
+/**
+  * @brief  Load two adjacent samples as one word for the SIMD instructions.
+  * @param  ps Word aligned.
+  * @retval The first sample in the low half.
+  */
+static inline uint32_t prvRead2(const int16_t *ps)
+{
+  uint32_t ulPair;
+
+  (void) memcpy(&ulPair, ps, sizeof(ulPair));
+
+  return ulPair;
+}
@@ -0,0 +1,320 @@
+/**
+  ******************************************************************************
+  * @file           : microjob.c
+  * @brief          : Stackless cooperative jobs run by one host task from a
+  *                   run queue and a list of delayed jobs.
+  ******************************************************************************
+  * The run queue is a FIFO of ready jobs, so jobs take turns one step at a
+  * time, and the delayed list is kept in order of wake time, so the host only
+  * ever looks at its head.  Both are singly linked through the jobs
+  * themselves, which is where croutine.c's list items and priorities went:
+  * a start or a step costs one link, a delay one walk of the jobs due before
+  * it.
+  *
+  * The host sleeps in ulTaskNotifyTake() until the head of the delayed list
+  * is due, and anything that readies a job or makes a new head notifies it.
+  * Wake times are compared by their signed distance, as in periodic.c, so
+  * no delay may exceed portMAX_DELAY / 2.
+  *
+  * The lists are shared with other tasks and with interrupts that signal
+  * jobs, and are only touched with interrupts masked; job functions run
+  * with nothing held.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "microjob.h"
+#include "taskreg.h"
+
+#if (microjobENABLE == 1) && (configUSE_TASK_NOTIFICATIONS == 1)
+
+/* Private define ------------------------------------------------------------*/
+
+/* ucState of a job. */
+#define microjobSTATE_IDLE          0U  /* Not started, or done. */
+#define microjobSTATE_READY         1U  /* In the run queue. */
+#define microjobSTATE_DELAYED       2U  /* In the delayed list. */
+#define microjobSTATE_WAITING       3U  /* On no list, until signalled. */
+#define microjobSTATE_RUNNING       4U  /* Taken by the host. */
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Whether tick xA is earlier than xB. */
+#define microjobBEFORE(xA, xB)      (((TickType_t) ((xA) - (xB))) > (portMAX_DELAY / 2U))
+
+/* Private variables ---------------------------------------------------------*/
+static MicroJob_t *pxReadyHead = NULL;
+static MicroJob_t *pxReadyTail = NULL;
+static MicroJob_t *pxDelayedHead = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvHostTask(void *pvParameters);
+static void prvReady(MicroJob_t *pxJob);
+static BaseType_t prvDelay(MicroJob_t *pxJob);
+
+/* Registered tasks ----------------------------------------------------------*/
+TASK_REGISTER_IN(CCM, MJOBS, prvHostTask, NULL, microjobHOST_STACK_DEPTH, microjobHOST_PRIORITY);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Start a job from the top of its function.
+  * @param  pxJob       Job storage, which must outlive the job.
+  * @param  xFirstDelay Ticks from now until the first step, 0 for as soon as
+  *                     the host gets to it.
+  * @note   May be called before the scheduler starts and from any task,
+  *         including from a job.
+  * @retval pdPASS, or pdFAIL if the job is already started.
+  */
+BaseType_t xMicroJobStart(MicroJob_t *pxJob, MicroJobFunction_t pxFunction, TickType_t xFirstDelay)
+{
+  BaseType_t xNotify;
+
+  configASSERT(xFirstDelay <= (portMAX_DELAY / 2U));
+
+  taskENTER_CRITICAL();
+  {
+    if (pxJob->ucState != microjobSTATE_IDLE)
+    {
+      taskEXIT_CRITICAL();
+      return pdFAIL;
+    }
+
+    pxJob->pxFunction = pxFunction;
+    pxJob->usResume = 0U;
+    pxJob->ucSignalled = 0U;
+    pxJob->xWake = xTaskGetTickCount() + xFirstDelay;
+
+    if (xFirstDelay == 0U)
+    {
+      prvReady(pxJob);
+      xNotify = pdTRUE;
+    }
+    else
+    {
+      xNotify = prvDelay(pxJob);
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  if ((xNotify != pdFALSE) && (xMJOBSHandle != NULL))
+  {
+    xTaskNotifyGive(xMJOBSHandle);
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Wake a job in microjobWAIT(), or let its next wait pass at once.
+  * @note   Signals do not count: several before a wait let one wait pass.
+  *         A job that is not started ignores them.
+  * @retval None
+  */
+void vMicroJobSignal(MicroJob_t *pxJob)
+{
+  BaseType_t xNotify = pdFALSE;
+
+  taskENTER_CRITICAL();
+  {
+    if (pxJob->ucState == microjobSTATE_WAITING)
+    {
+      prvReady(pxJob);
+      xNotify = pdTRUE;
+    }
+    else if (pxJob->ucState != microjobSTATE_IDLE)
+    {
+      pxJob->ucSignalled = 1U;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  if ((xNotify != pdFALSE) && (xMJOBSHandle != NULL))
+  {
+    xTaskNotifyGive(xMJOBSHandle);
+  }
+}
+
+/**
+  * @brief  vMicroJobSignal() for interrupts at or below
+  *         configMAX_SYSCALL_INTERRUPT_PRIORITY.
+  * @param  pxHigherPriorityTaskWoken Set to pdTRUE if the host should run
+  *         before the interrupted task, as for vTaskNotifyGiveFromISR().
+  * @retval None
+  */
+void vMicroJobSignalFromISR(MicroJob_t *pxJob, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  UBaseType_t uxSavedInterruptStatus;
+  BaseType_t xNotify = pdFALSE;
+
+  uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  {
+    if (pxJob->ucState == microjobSTATE_WAITING)
+    {
+      prvReady(pxJob);
+      xNotify = pdTRUE;
+    }
+    else if (pxJob->ucState != microjobSTATE_IDLE)
+    {
+      pxJob->ucSignalled = 1U;
+    }
+  }
+  taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+  if ((xNotify != pdFALSE) && (xMJOBSHandle != NULL))
+  {
+    vTaskNotifyGiveFromISR(xMJOBSHandle, pxHigherPriorityTaskWoken);
+  }
+}
+
+/**
+  * @brief  Move a job's wake time on by whole periods, for microjobPERIOD().
+  * @note   A job that fell a whole period or more behind skips the steps it
+  *         missed rather than running them back to back, and keeps its
+  *         phase.
+  * @retval None
+  */
+void vMicroJobNextPeriod(MicroJob_t *pxJob, TickType_t xPeriod)
+{
+  TickType_t xNow = xTaskGetTickCount();
+
+  configASSERT((xPeriod > 0U) && (xPeriod <= (portMAX_DELAY / 2U)));
+
+  do
+  {
+    pxJob->xWake += xPeriod;
+  } while (!microjobBEFORE(xNow, pxJob->xWake));
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Run the ready jobs one step at a time, moving delayed jobs to the
+  *         run queue as they fall due, and sleep while none is ready.
+  * @retval None
+  */
+static void prvHostTask(void *pvParameters)
+{
+  MicroJob_t *pxJob;
+  MicroJobStatus_t eStatus;
+  TickType_t xNow;
+  TickType_t xWait = portMAX_DELAY;
+
+  (void) pvParameters;
+
+  for (;;)
+  {
+    taskENTER_CRITICAL();
+    {
+      xNow = xTaskGetTickCount();
+      while ((pxDelayedHead != NULL) && !microjobBEFORE(xNow, pxDelayedHead->xWake))
+      {
+        pxJob = pxDelayedHead;
+        pxDelayedHead = pxJob->pxNext;
+        prvReady(pxJob);
+      }
+
+      pxJob = pxReadyHead;
+      if (pxJob != NULL)
+      {
+        pxReadyHead = pxJob->pxNext;
+        if (pxReadyHead == NULL)
+        {
+          pxReadyTail = NULL;
+        }
+        pxJob->ucState = microjobSTATE_RUNNING;
+      }
+      else
+      {
+        xWait = (pxDelayedHead != NULL) ? (pxDelayedHead->xWake - xNow) : portMAX_DELAY;
+      }
+    }
+    taskEXIT_CRITICAL();
+
+    if (pxJob == NULL)
+    {
+      /* A notification means a job was readied or a new head delayed;
+         either way look again. */
+      (void) ulTaskNotifyTake(pdTRUE, xWait);
+      continue;
+    }
+
+    eStatus = pxJob->pxFunction(pxJob);
+
+    taskENTER_CRITICAL();
+    {
+      switch (eStatus)
+      {
+        case eMicroJobYield:
+          prvReady(pxJob);
+          break;
+
+        case eMicroJobDelay:
+          /* Any new head is seen on the next pass. */
+          (void) prvDelay(pxJob);
+          break;
+
+        case eMicroJobWait:
+          if (pxJob->ucSignalled != 0U)
+          {
+            pxJob->ucSignalled = 0U;
+            prvReady(pxJob);
+          }
+          else
+          {
+            pxJob->ucState = microjobSTATE_WAITING;
+          }
+          break;
+
+        default:
+          pxJob->ucState = microjobSTATE_IDLE;
+          break;
+      }
+    }
+    taskEXIT_CRITICAL();
+  }
+}
+
+/**
+  * @brief  Append a job to the run queue.  Caller has interrupts masked.
+  * @retval None
+  */
+static void prvReady(MicroJob_t *pxJob)
+{
+  pxJob->pxNext = NULL;
+  pxJob->ucState = microjobSTATE_READY;
+
+  if (pxReadyTail != NULL)
+  {
+    pxReadyTail->pxNext = pxJob;
+  }
+  else
+  {
+    pxReadyHead = pxJob;
+  }
+  pxReadyTail = pxJob;
+}
+
+/**
+  * @brief  Insert a job into the delayed list at its wake time, after any
+  *         job due at the same tick.  Caller has interrupts masked.
+  * @retval pdTRUE if the job is the new head, and so the host's sleep is
+  *         too long.
+  */
+static BaseType_t prvDelay(MicroJob_t *pxJob)
+{
+  MicroJob_t **ppxLink = &pxDelayedHead;
+
+  while ((*ppxLink != NULL) && !microjobBEFORE(pxJob->xWake, (*ppxLink)->xWake))
+  {
+    ppxLink = &((*ppxLink)->pxNext);
+  }
+
+  pxJob->pxNext = *ppxLink;
+  pxJob->ucState = microjobSTATE_DELAYED;
+  *ppxLink = pxJob;
+
+  return (ppxLink == &pxDelayedHead) ? pdTRUE : pdFALSE;
+}
+
+#endif /* microjobENABLE */
@@ -0,0 +1,174 @@
+/**
+  ******************************************************************************
+  * @file           : newlibheap.c
+  * @brief          : newlib's malloc family on the kernel allocator, so the
+  *                   firmware has one heap.
+  ******************************************************************************
+  * newlib's own malloc grows with _sbrk() from _end, unsynchronised with the
+  * kernel heap and instrumented by nothing.  These definitions take its place
+  * at link time: the library's printf, strdup and the like call the _r
+  * variants, code that calls malloc() directly the plain ones, and all of
+  * them end in pvPortMallocFlags(), vPortFree() and pvPortRealloc().  Those
+  * take the heap lock themselves, so blocks from malloc() show up in the
+  * heap statistics and owner tracking like any other, and no task can see
+  * the heap half updated.
+  *
+  * Blocks are DMA capable, as newlib's were in SRAM, so a buffer from
+  * malloc() can still be handed to a stream.  With the library's allocator no
+  * longer linked the linker scripts reserve nothing for it: _Min_Heap_Size is
+  * 0 and _sbrk() refuses any request.  __malloc_lock() and __malloc_unlock()
+  * are kept for whatever in the library still takes them.
+  *
+  * Like pvPortMalloc(), none of these may be called from an interrupt.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <errno.h>
+#include <reent.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Private define ------------------------------------------------------------*/
+#define newlibheapFLAGS             heapALLOC_DMA_CAPABLE
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  malloc() for the library.
+  * @retval The block, or NULL with ENOMEM in pxReent.
+  */
+void *_malloc_r(struct _reent *pxReent, size_t xSize)
+{
+  void *pvBlock = pvPortMallocFlags(xSize, newlibheapFLAGS);
+
+  if ((pvBlock == NULL) && (xSize != 0U))
+  {
+    pxReent->_errno = ENOMEM;
+  }
+
+  return pvBlock;
+}
+
+/**
+  * @brief  free() for the library.
+  * @retval None
+  */
+void _free_r(struct _reent *pxReent, void *pv)
+{
+  (void) pxReent;
+
+  vPortFree(pv);
+}
+
+/**
+  * @brief  realloc() for the library.  A block that moves stays DMA capable.
+  * @retval The block, or NULL with ENOMEM in pxReent and pv untouched.
+  */
+void *_realloc_r(struct _reent *pxReent, void *pv, size_t xSize)
+{
+  void *pvBlock;
+
+  if (pv == NULL)
+  {
+    return _malloc_r(pxReent, xSize);
+  }
+
+  pvBlock = pvPortRealloc(pv, xSize);
+  if ((pvBlock == NULL) && (xSize != 0U))
+  {
+    pxReent->_errno = ENOMEM;
+  }
+
+  return pvBlock;
+}
+
+/**
+  * @brief  calloc() for the library.
+  * @retval The zeroed block, or NULL with ENOMEM in pxReent.
+  */
+void *_calloc_r(struct _reent *pxReent, size_t xCount, size_t xSize)
+{
+  void *pvBlock;
+
+  if ((xSize != 0U) && (xCount > (SIZE_MAX / xSize)))
+  {
+    pxReent->_errno = ENOMEM;
+    return NULL;
+  }
+
+  pvBlock = _malloc_r(pxReent, xCount * xSize);
+  if (pvBlock != NULL)
+  {
+    (void) memset(pvBlock, 0, xCount * xSize);
+  }
+
+  return pvBlock;
+}
+
+/**
+  * @brief  memalign() for the library.
+  * @retval The block, or NULL with ENOMEM in pxReent.
+  */
+void *_memalign_r(struct _reent *pxReent, size_t xAlignment, size_t xSize)
+{
+  void *pvBlock = pvPortMallocAligned(xSize, xAlignment, newlibheapFLAGS);
+
+  if ((pvBlock == NULL) && (xSize != 0U))
+  {
+    pxReent->_errno = ENOMEM;
+  }
+
+  return pvBlock;
+}
+
+void *malloc(size_t xSize)
+{
+  return _malloc_r(_REENT, xSize);
+}
+
+void free(void *pv)
+{
+  _free_r(_REENT, pv);
+}
+
+void *realloc(void *pv, size_t xSize)
+{
+  return _realloc_r(_REENT, pv, xSize);
+}
+
+void *calloc(size_t xCount, size_t xSize)
+{
+  return _calloc_r(_REENT, xCount, xSize);
+}
+
+void *memalign(size_t xAlignment, size_t xSize)
+{
+  return _memalign_r(_REENT, xAlignment, xSize);
+}
+
+/**
+  * @brief  The library's allocator lock: the scheduler is suspended.  Nests.
+  * @retval None
+  */
+void __malloc_lock(struct _reent *pxReent)
+{
+  (void) pxReent;
+
+  vTaskSuspendAll();
+}
+
+/**
+  * @brief  Release __malloc_lock().
+  * @retval None
+  */
+void __malloc_unlock(struct _reent *pxReent)
+{
+  (void) pxReent;
+
+  (void) xTaskResumeAll();
+}
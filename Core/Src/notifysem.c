@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : notifysem.c
+  * @brief          : Binary and counting semaphores kept in one entry of a
+  *                   task's notification array.
+  ******************************************************************************
+  * The count is the notification value itself.  A counting give increments
+  * it and a take decrements it; a binary give overwrites it with 1 and a take
+  * clears it, so gives made while the semaphore is already available are
+  * absorbed as a binary semaphore's would be.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "notifysem.h"
+
+#if (configUSE_TASK_NOTIFICATIONS == 1)
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Set up a semaphore, initially unavailable.
+  * @param  xOwner    The only task that may take it, NULL for the caller.
+  * @param  uxIndex   Notification index it keeps its count in, not 0.
+  * @param  xCounting pdTRUE to count gives, pdFALSE for a binary semaphore.
+  * @note   Clears the owner's notification value at uxIndex.
+  * @retval None
+  */
+void vNotifySemaphoreInit(NotifySemaphore_t *pxSemaphore, TaskHandle_t xOwner, UBaseType_t uxIndex,
+                          BaseType_t xCounting)
+{
+  configASSERT((uxIndex != tskDEFAULT_INDEX_TO_NOTIFY) && (uxIndex < configTASK_NOTIFICATION_ARRAY_ENTRIES));
+
+  pxSemaphore->xOwner = (xOwner != NULL) ? xOwner : xTaskGetCurrentTaskHandle();
+  pxSemaphore->uxIndex = uxIndex;
+  pxSemaphore->xCounting = xCounting;
+
+  (void) ulTaskNotifyValueClearIndexed(pxSemaphore->xOwner, uxIndex, 0xFFFFFFFFUL);
+  (void) xTaskNotifyStateClearIndexed(pxSemaphore->xOwner, uxIndex);
+}
+
+/**
+  * @brief  Take the semaphore, blocking until it is available.
+  * @note   Call from the owner only.
+  * @retval pdPASS, or pdFAIL if the wait timed out.
+  */
+BaseType_t xNotifySemaphoreTake(const NotifySemaphore_t *pxSemaphore, TickType_t xTicksToWait)
+{
+  configASSERT(pxSemaphore->xOwner == xTaskGetCurrentTaskHandle());
+
+  return (ulTaskNotifyTakeIndexed(pxSemaphore->uxIndex, (pxSemaphore->xCounting == pdFALSE) ? pdTRUE : pdFALSE,
+                                  xTicksToWait) != 0U) ? pdPASS : pdFAIL;
+}
+
+/**
+  * @brief  Give the semaphore.
+  * @note   Call from a task.
+  * @retval None
+  */
+void vNotifySemaphoreGive(const NotifySemaphore_t *pxSemaphore)
+{
+  if (pxSemaphore->xCounting != pdFALSE)
+  {
+    (void) xTaskNotifyGiveIndexed(pxSemaphore->xOwner, pxSemaphore->uxIndex);
+  }
+  else
+  {
+    (void) xTaskNotifyIndexed(pxSemaphore->xOwner, pxSemaphore->uxIndex, 1U, eSetValueWithOverwrite);
+  }
+}
+
+/**
+  * @brief  Give the semaphore from an interrupt.
+  * @param  pxHigherPriorityTaskWoken Set if the owner should run on exit.
+  * @retval None
+  */
+void vNotifySemaphoreGiveFromISR(const NotifySemaphore_t *pxSemaphore, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  if (pxSemaphore->xCounting != pdFALSE)
+  {
+    vTaskNotifyGiveIndexedFromISR(pxSemaphore->xOwner, pxSemaphore->uxIndex, pxHigherPriorityTaskWoken);
+  }
+  else
+  {
+    (void) xTaskNotifyIndexedFromISR(pxSemaphore->xOwner, pxSemaphore->uxIndex, 1U, eSetValueWithOverwrite,
+                                     pxHigherPriorityTaskWoken);
+  }
+}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
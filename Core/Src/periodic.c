@@ -0,0 +1,300 @@
+/**
+  ******************************************************************************
+  * @file           : periodic.c
+  * @brief          : Periodic jobs run by a single executor task from a
+  *                   min-heap of deadlines.
+  ******************************************************************************
+  * The heap holds pointers to the started jobs, ordered by deadline, so the
+  * executor only ever looks at the root.  It sleeps in ulTaskNotifyTake()
+  * until the root is due, which lets xPeriodicJobStart() wake it with a task
+  * notification when a new job becomes the earliest.
+  *
+  * Deadlines are compared by their signed distance, which stays right across
+  * a tick count wrap as long as no period exceeds portMAX_DELAY / 2.  A job
+  * that falls a whole period or more behind skips the runs it missed instead
+  * of running back to back, and keeps its phase.
+  *
+  * The heap is shared with other tasks and is only touched inside critical
+  * sections; callbacks run outside them.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "periodic.h"
+#include "taskreg.h"
+
+#if (configUSE_TASK_NOTIFICATIONS == 1)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Whether deadline xA is earlier than xB. */
+#define periodicBEFORE(xA, xB)      (((TickType_t) ((xA) - (xB))) > (portMAX_DELAY / 2U))
+
+/* Private variables ---------------------------------------------------------*/
+static PeriodicJob_t *pxHeap[periodicMAX_JOBS];
+static UBaseType_t uxHeapCount = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvExecutorTask(void *pvParameters);
+static void prvHeapInsert(PeriodicJob_t *pxJob);
+static void prvHeapRemove(UBaseType_t uxIndex);
+static void prvHeapSiftUp(UBaseType_t uxIndex);
+static void prvHeapSiftDown(UBaseType_t uxIndex);
+static void prvHeapPlace(PeriodicJob_t *pxJob, UBaseType_t uxIndex);
+
+/* Registered tasks ----------------------------------------------------------*/
+TASK_REGISTER_IN(CCM, JOBS, prvExecutorTask, NULL, periodicEXECUTOR_STACK_DEPTH, periodicEXECUTOR_PRIORITY);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Start a job, or restart it if it is already started.
+  * @param  pxJob       Job storage, which must outlive the job.
+  * @param  xPeriod     Ticks between runs, 0 to run once.
+  * @param  xFirstDelay Ticks from now until the first run.
+  * @note   May be called before the scheduler starts and from any task,
+  *         including from a callback.
+  * @retval pdPASS, or pdFAIL if periodicMAX_JOBS jobs are already started.
+  */
+BaseType_t xPeriodicJobStart(PeriodicJob_t *pxJob, PeriodicCallback_t pxCallback, void *pvParameter,
+                             TickType_t xPeriod, TickType_t xFirstDelay)
+{
+  BaseType_t xEarliest;
+
+  configASSERT(xPeriod <= (portMAX_DELAY / 2U));
+
+  taskENTER_CRITICAL();
+  {
+    /* Callers start a job from scratch, so whatever was in it before is
+       trusted only if it points back at its own slot. */
+    if ((pxJob->uxHeapIndex < uxHeapCount) && (pxHeap[pxJob->uxHeapIndex] == pxJob))
+    {
+      prvHeapRemove(pxJob->uxHeapIndex);
+    }
+
+    if (uxHeapCount >= periodicMAX_JOBS)
+    {
+      taskEXIT_CRITICAL();
+      return pdFAIL;
+    }
+
+    pxJob->pxCallback = pxCallback;
+    pxJob->pvParameter = pvParameter;
+    pxJob->xPeriod = xPeriod;
+    pxJob->xDeadline = xTaskGetTickCount() + xFirstDelay;
+    prvHeapInsert(pxJob);
+    xEarliest = (pxHeap[0] == pxJob) ? pdTRUE : pdFALSE;
+  }
+  taskEXIT_CRITICAL();
+
+  /* Only a new root shortens the executor's sleep. */
+  if ((xEarliest != pdFALSE) && (xJOBSHandle != NULL))
+  {
+    xTaskNotifyGive(xJOBSHandle);
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Stop a started job.
+  * @note   If the executor is running the job's callback at the time, that
+  *         run completes but no further run is scheduled.
+  * @retval pdPASS, or pdFAIL if the job was not started.
+  */
+BaseType_t xPeriodicJobStop(PeriodicJob_t *pxJob)
+{
+  BaseType_t xReturn = pdFAIL;
+
+  taskENTER_CRITICAL();
+  {
+    if ((pxJob->uxHeapIndex < uxHeapCount) && (pxHeap[pxJob->uxHeapIndex] == pxJob))
+    {
+      prvHeapRemove(pxJob->uxHeapIndex);
+      xReturn = pdPASS;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  /* A stopped root only makes the executor wake early and find nothing due,
+     so it is not notified. */
+  return xReturn;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Run each job as it falls due, sleeping until the next deadline.
+  * @retval None
+  */
+static void prvExecutorTask(void *pvParameters)
+{
+  PeriodicJob_t *pxJob;
+  PeriodicCallback_t pxCallback;
+  void *pvParameter;
+  TickType_t xNow;
+  TickType_t xWait;
+
+  (void) pvParameters;
+
+  for (;;)
+  {
+    pxCallback = NULL;
+    pvParameter = NULL;
+    xWait = portMAX_DELAY;
+
+    taskENTER_CRITICAL();
+    {
+      xNow = xTaskGetTickCount();
+      if (uxHeapCount > 0U)
+      {
+        pxJob = pxHeap[0];
+        if (periodicBEFORE(xNow, pxJob->xDeadline))
+        {
+          xWait = pxJob->xDeadline - xNow;
+        }
+        else
+        {
+          pxCallback = pxJob->pxCallback;
+          pvParameter = pxJob->pvParameter;
+
+          /* Reschedule before the run, so that the callback may stop or
+             restart its own job. */
+          if (pxJob->xPeriod == 0U)
+          {
+            prvHeapRemove(0U);
+          }
+          else
+          {
+            do
+            {
+              pxJob->xDeadline += pxJob->xPeriod;
+            } while (!periodicBEFORE(xNow, pxJob->xDeadline));
+            prvHeapSiftDown(0U);
+          }
+        }
+      }
+    }
+    taskEXIT_CRITICAL();
+
+    if (pxCallback != NULL)
+    {
+      pxCallback(pvParameter);
+    }
+    else
+    {
+      /* A notification means the root changed; either way look again. */
+      (void) ulTaskNotifyTake(pdTRUE, xWait);
+    }
+  }
+}
+
+/**
+  * @brief  Add a job to the heap.  Caller holds the critical section and has
+  *         checked there is room.
+  * @retval None
+  */
+static void prvHeapInsert(PeriodicJob_t *pxJob)
+{
+  prvHeapPlace(pxJob, uxHeapCount);
+  uxHeapCount++;
+  prvHeapSiftUp(uxHeapCount - 1U);
+}
+
+/**
+  * @brief  Take the job in slot uxIndex off the heap.  Caller holds the
+  *         critical section.
+  * @retval None
+  */
+static void prvHeapRemove(UBaseType_t uxIndex)
+{
+  PeriodicJob_t *pxJob = pxHeap[uxIndex];
+  PeriodicJob_t *pxLast;
+
+  uxHeapCount--;
+  if (uxIndex != uxHeapCount)
+  {
+    /* Fill the hole with the last job, which may belong above or below it. */
+    pxLast = pxHeap[uxHeapCount];
+    prvHeapPlace(pxLast, uxIndex);
+    prvHeapSiftUp(uxIndex);
+    if (pxLast->uxHeapIndex == uxIndex)
+    {
+      prvHeapSiftDown(uxIndex);
+    }
+  }
+  pxJob->uxHeapIndex = periodicMAX_JOBS;
+}
+
+/**
+  * @brief  Move the job in slot uxIndex towards the root while it is due
+  *         before its parent.
+  * @retval None
+  */
+static void prvHeapSiftUp(UBaseType_t uxIndex)
+{
+  PeriodicJob_t *pxJob = pxHeap[uxIndex];
+  UBaseType_t uxParent;
+
+  while (uxIndex > 0U)
+  {
+    uxParent = (uxIndex - 1U) / 2U;
+    if (!periodicBEFORE(pxJob->xDeadline, pxHeap[uxParent]->xDeadline))
+    {
+      break;
+    }
+    prvHeapPlace(pxHeap[uxParent], uxIndex);
+    uxIndex = uxParent;
+  }
+  prvHeapPlace(pxJob, uxIndex);
+}
+
+/**
+  * @brief  Move the job in slot uxIndex away from the root while a child is
+  *         due before it.
+  * @retval None
+  */
+static void prvHeapSiftDown(UBaseType_t uxIndex)
+{
+  PeriodicJob_t *pxJob;
+  UBaseType_t uxChild;
+
+  if (uxIndex >= uxHeapCount)
+  {
+    return;
+  }
+
+  pxJob = pxHeap[uxIndex];
+  for (;;)
+  {
+    uxChild = (2U * uxIndex) + 1U;
+    if (uxChild >= uxHeapCount)
+    {
+      break;
+    }
+    if (((uxChild + 1U) < uxHeapCount) &&
+        periodicBEFORE(pxHeap[uxChild + 1U]->xDeadline, pxHeap[uxChild]->xDeadline))
+    {
+      uxChild++;
+    }
+    if (!periodicBEFORE(pxHeap[uxChild]->xDeadline, pxJob->xDeadline))
+    {
+      break;
+    }
+    prvHeapPlace(pxHeap[uxChild], uxIndex);
+    uxIndex = uxChild;
+  }
+  prvHeapPlace(pxJob, uxIndex);
+}
+
+/**
+  * @brief  Store a job in a slot and let it remember where it is.
+  * @retval None
+  */
+static void prvHeapPlace(PeriodicJob_t *pxJob, UBaseType_t uxIndex)
+{
+  pxHeap[uxIndex] = pxJob;
+  pxJob->uxHeapIndex = uxIndex;
+}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file           : pinmux.c
+  * @brief          : Applies the register images of pinmux.h, for the board
+  *                   table at boot and for any other table at run time.
+  ******************************************************************************
+  * Registers are written in the order HAL_GPIO_Init() uses per pin: output
+  * levels first, so that no output glitches, then the output stage, pulls and
+  * alternate functions, and MODER last.
+  *
+  * None of this locks.  A caller changing pins at run time must keep other
+  * writers of the same port registers out, for example with a critical
+  * section.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "pinmux.h"
+#include "pintable.h"
+
+/* Private variables ---------------------------------------------------------*/
+#define pinmuxBOARD_PORT(Port)      pinmuxPORT_IMAGE(BOARD_PIN_TABLE, Port),
+
+static const PinmuxPort_t xBoardPorts[] =
+{
+  BOARD_PIN_PORTS(pinmuxBOARD_PORT)
+};
+
+static const PinmuxExti_t xBoardExti = pinmuxEXTI_IMAGE(BOARD_PIN_TABLE);
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t prvSpreadPins(uint32_t ulPins);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Configure every pin of BOARD_PIN_TABLE, replacing MX_GPIO_Init().
+  * @retval None
+  */
+void vPinmuxInit(void)
+{
+  size_t x;
+
+  RCC->AHB1ENR |= pinmuxCLOCKS(BOARD_PIN_TABLE);
+  /* Read back, as __HAL_RCC_GPIOx_CLK_ENABLE() does, so that the clocks are
+     running before the first port write. */
+  (void) RCC->AHB1ENR;
+
+  for (x = 0U; x < (sizeof(xBoardPorts) / sizeof(xBoardPorts[0])); x++)
+  {
+    vPinmuxApplyPort(&xBoardPorts[x]);
+  }
+
+  vPinmuxApplyExti(&xBoardExti);
+}
+
+/**
+  * @brief  Write the images of one port, one access per register.
+  * @param  pxImage Built with pinmuxPORT_IMAGE().  The port clock must be on.
+  * @retval None
+  */
+void vPinmuxApplyPort(const PinmuxPort_t *pxImage)
+{
+  GPIO_TypeDef *pxPort = pxImage->pxPort;
+
+  pxPort->BSRR = pxImage->ulBsrr;
+  pxPort->OTYPER = (pxPort->OTYPER & ~pxImage->ulOtyperMask) | pxImage->ulOtyper;
+  pxPort->OSPEEDR = (pxPort->OSPEEDR & ~pxImage->ulOspeedrMask) | pxImage->ulOspeedr;
+  pxPort->PUPDR = (pxPort->PUPDR & ~pxImage->ulPupdrMask) | pxImage->ulPupdr;
+  pxPort->AFR[0] = (pxPort->AFR[0] & ~pxImage->ulAfrMask[0]) | pxImage->ulAfr[0];
+  pxPort->AFR[1] = (pxPort->AFR[1] & ~pxImage->ulAfrMask[1]) | pxImage->ulAfr[1];
+  pxPort->MODER = (pxPort->MODER & ~pxImage->ulModerMask) | pxImage->ulModer;
+}
+
+/**
+  * @brief  Route and arm the EXTI lines of a table.
+  * @param  pxImage Built with pinmuxEXTI_IMAGE().
+  * @retval None
+  */
+void vPinmuxApplyExti(const PinmuxExti_t *pxImage)
+{
+  size_t x;
+
+  if (pxImage->ulLines == 0U)
+  {
+    return;
+  }
+
+  __HAL_RCC_SYSCFG_CLK_ENABLE();
+
+  for (x = 0U; x < 4U; x++)
+  {
+    if (pxImage->ulExticrMask[x] != 0U)
+    {
+      SYSCFG->EXTICR[x] = (SYSCFG->EXTICR[x] & ~pxImage->ulExticrMask[x]) | pxImage->ulExticr[x];
+    }
+  }
+
+  EXTI->RTSR = (EXTI->RTSR & ~pxImage->ulLines) | pxImage->ulRtsr;
+  EXTI->FTSR = (EXTI->FTSR & ~pxImage->ulLines) | pxImage->ulFtsr;
+  EXTI->EMR = (EXTI->EMR & ~pxImage->ulLines) | pxImage->ulEmr;
+  EXTI->IMR = (EXTI->IMR & ~pxImage->ulLines) | pxImage->ulImr;
+}
+
+/**
+  * @brief  Switch pins between modes with one write to MODER, for example to
+  *         park a bus as analog inputs before a low power stop.
+  * @param  pxPort The port.
+  * @param  usPins GPIO_PIN_x mask of the pins.
+  * @param  ulMode A pinmuxMODE_ constant.
+  * @note   Only MODER changes; an output or alternate function keeps the
+  *         output stage, pull and function it was last given.
+  * @retval None
+  */
+void vPinmuxSetMode(GPIO_TypeDef *pxPort, uint16_t usPins, uint32_t ulMode)
+{
+  uint32_t ulMask = prvSpreadPins(usPins);
+
+  pxPort->MODER = (pxPort->MODER & ~(ulMask * 3U)) | (ulMask * (ulMode & 3U));
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Move bit n of a pin mask to bit 2n.
+  * @retval The low bit of each pin's pair of MODER bits.
+  */
+static uint32_t prvSpreadPins(uint32_t ulPins)
+{
+  ulPins = (ulPins | (ulPins << 8)) & 0x00FF00FFUL;
+  ulPins = (ulPins | (ulPins << 4)) & 0x0F0F0F0FUL;
+  ulPins = (ulPins | (ulPins << 2)) & 0x33333333UL;
+  ulPins = (ulPins | (ulPins << 1)) & 0x55555555UL;
+
+  return ulPins;
+}
@@ -0,0 +1,353 @@
+/**
+  ******************************************************************************
+  * @file           : pipeline.c
+  * @brief          : Producer/consumer pipelines of stages joined by stream
+  *                   buffers, see pipeline.h.
+  ******************************************************************************
+  * A link's storage is a whole number of items and its writes and reads are
+  * too, so the head and tail of its stream buffer only ever sit on item
+  * boundaries and every contiguous run of data or free space is whole items,
+  * wrap or not.  The stream buffer keeps one byte free to tell full from
+  * empty, which here costs the last item, hence the extra item pipelineLINK()
+  * allocates.
+  *
+  * The reader's side is the stream buffer's own: the trigger level is the
+  * batch, and xStreamBufferPeekContiguous() blocks on an empty input until a
+  * commit reaches it.  The writer's side is not, since reservations never
+  * block, so a writer that finds no room parks its handle in the link and
+  * waits for a notification.  The reader checks the link after each consume
+  * and wakes the writer once a batch is free.  Parking and the check both
+  * run with interrupts masked, and the writer clears its notification state
+  * before it looks for room, so a wake that lands between its look and its
+  * wait is not lost.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "pipeline.h"
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Every stage whose task has started, newest first. */
+static PipelineStage_t *pxPipelineStages = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+static size_t prvReserveItems(PipelineLink_t *pxLink, void **ppvItems);
+static BaseType_t prvWaitForRoom(PipelineLink_t *pxLink, TickType_t xTicksToWait);
+static void prvWakeWriter(PipelineLink_t *pxLink);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Create a link's stream buffer.  Call once for each link, before
+  *         vTaskRegistryStart() starts the stages that use it.
+  * @retval pdPASS, or pdFAIL if the batch is 0 or more than the link holds.
+  */
+BaseType_t xPipelineLinkInit(PipelineLink_t *pxLink)
+{
+  size_t xDepth = (pxLink->xStorageBytes / pxLink->xItemSize) - 1U;
+
+  if ((pxLink->xBatch == 0U) || (pxLink->xBatch > xDepth))
+  {
+    return pdFAIL;
+  }
+
+  pxLink->xStream = xStreamBufferCreateStatic(pxLink->xStorageBytes,
+                                              pxLink->xBatch * pxLink->xItemSize,
+                                              pxLink->pucStorage, &pxLink->xStreamStruct);
+  configASSERT(pxLink->xStream != NULL);
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Change the items that wake a link's reader and a stalled writer.
+  * @note   A reader already waiting keeps waiting for the old batch until a
+  *         commit reaches the new one, or its xMaxWait runs out.
+  * @retval pdPASS, or pdFAIL if the batch is 0 or more than the link holds.
+  */
+BaseType_t xPipelineSetBatch(PipelineLink_t *pxLink, size_t xBatch)
+{
+  size_t xDepth = (pxLink->xStorageBytes / pxLink->xItemSize) - 1U;
+
+  configASSERT(pxLink->xStream != NULL);
+
+  if ((xBatch == 0U) || (xBatch > xDepth))
+  {
+    return pdFAIL;
+  }
+
+  pxLink->xBatch = xBatch;
+
+  return xStreamBufferSetTriggerLevel(pxLink->xStream, xBatch * pxLink->xItemSize);
+}
+
+/**
+  * @brief  Find room for items in a link, to fill in place and hand on with
+  *         vPipelineCommit() or vPipelineCommitFromISR().  Never blocks.
+  * @param  ppvItems Set to the first free item.
+  * @note   Only the link's writer may call this.  Counts a full link.
+  * @retval Contiguous free items at *ppvItems, 0 if the link is full.
+  */
+size_t xPipelineReserve(PipelineLink_t *pxLink, void **ppvItems)
+{
+  size_t xItems = prvReserveItems(pxLink, ppvItems);
+
+  if (xItems == 0U)
+  {
+    pxLink->ulFull++;
+  }
+
+  return xItems;
+}
+
+/**
+  * @brief  Hand on items written since xPipelineReserve(), waking the reader
+  *         if they complete its batch.
+  * @retval None
+  */
+void vPipelineCommit(PipelineLink_t *pxLink, size_t xItems)
+{
+  (void) xStreamBufferCommit(pxLink->xStream, xItems * pxLink->xItemSize);
+}
+
+/**
+  * @brief  As vPipelineCommit(), from an interrupt.
+  * @retval None
+  */
+void vPipelineCommitFromISR(PipelineLink_t *pxLink, size_t xItems, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  (void) xStreamBufferCommitFromISR(pxLink->xStream, xItems * pxLink->xItemSize,
+                                    pxHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  Copy items into a link from a task that is not a stage, waiting
+  *         up to xTicksToWait in all for room.
+  * @note   Only the link's writer may call this.
+  * @retval Items written, fewer than xItems if the time ran out.
+  */
+size_t xPipelineWrite(PipelineLink_t *pxLink, const void *pvItems, size_t xItems, TickType_t xTicksToWait)
+{
+  const uint8_t *pucItems = (const uint8_t *) pvItems;
+  TimeOut_t xTimeOut;
+  void *pvFree;
+  size_t xWritten = 0U;
+  size_t xRoom;
+
+  vTaskSetTimeOutState(&xTimeOut);
+
+  while (xWritten < xItems)
+  {
+    xRoom = xPipelineReserve(pxLink, &pvFree);
+
+    if (xRoom == 0U)
+    {
+      if ((xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) != pdFALSE) ||
+          (prvWaitForRoom(pxLink, xTicksToWait) == pdFALSE))
+      {
+        break;
+      }
+      continue;
+    }
+
+    if (xRoom > (xItems - xWritten))
+    {
+      xRoom = xItems - xWritten;
+    }
+
+    (void) memcpy(pvFree, &pucItems[xWritten * pxLink->xItemSize], xRoom * pxLink->xItemSize);
+    vPipelineCommit(pxLink, xRoom);
+    xWritten += xRoom;
+  }
+
+  return xWritten;
+}
+
+/**
+  * @brief  Copy the counters of up to uxMaxStages started stages.
+  * @retval The stages copied.
+  */
+UBaseType_t uxPipelineGetStats(PipelineStats_t *pxStats, UBaseType_t uxMaxStages)
+{
+  const PipelineStage_t *pxStage;
+  UBaseType_t uxCount = 0U;
+
+  for (pxStage = pxPipelineStages; (pxStage != NULL) && (uxCount < uxMaxStages); pxStage = pxStage->pxNext)
+  {
+    pxStats[uxCount].pcName = pxStage->pcName;
+    pxStats[uxCount].ulItemsIn = pxStage->ulItemsIn;
+    pxStats[uxCount].ulItemsOut = pxStage->ulItemsOut;
+    pxStats[uxCount].ulWakes = pxStage->ulWakes;
+    pxStats[uxCount].ulCalls = pxStage->ulCalls;
+    pxStats[uxCount].ulStalls = pxStage->ulStalls;
+    pxStats[uxCount].ulInputFull = pxStage->pxIn->ulFull;
+    pxStats[uxCount].usPeakItems = (uint16_t) pxStage->xPeakItems;
+    pxStats[uxCount].usDepth = (uint16_t) ((pxStage->pxIn->xStorageBytes / pxStage->pxIn->xItemSize) - 1U);
+    uxCount++;
+  }
+
+  return uxCount;
+}
+
+/**
+  * @brief  The task of every stage: wait for a batch at the input, then run
+  *         the function over all there is, a contiguous run at a time, with
+  *         whatever room the output has.
+  * @param  pvParameters The stage, from pipelineSTAGE().
+  * @retval None
+  */
+void vPipelineStageTask(void *pvParameters)
+{
+  PipelineStage_t *pxStage = (PipelineStage_t *) pvParameters;
+  PipelineLink_t *pxIn = pxStage->pxIn;
+  PipelineLink_t *pxOut = pxStage->pxOut;
+  void *pvIn;
+  void *pvOut = NULL;
+  size_t xInItems;
+  size_t xOutItems;
+  size_t xConsumed;
+  size_t xWaiting;
+
+  configASSERT(pxIn->xStream != NULL);
+  configASSERT((pxOut == NULL) || (pxOut->xStream != NULL));
+
+  taskENTER_CRITICAL();
+  {
+    pxStage->pxNext = pxPipelineStages;
+    pxPipelineStages = pxStage;
+  }
+  taskEXIT_CRITICAL();
+
+  for (;;)
+  {
+    xInItems = xStreamBufferPeekContiguous(pxIn->xStream, &pvIn, pxStage->xMaxWait) / pxIn->xItemSize;
+    if (xInItems == 0U)
+    {
+      continue;
+    }
+
+    pxStage->ulWakes++;
+    xWaiting = xStreamBufferBytesAvailable(pxIn->xStream) / pxIn->xItemSize;
+    if (xWaiting > pxStage->xPeakItems)
+    {
+      pxStage->xPeakItems = xWaiting;
+    }
+
+    /* Work through everything there is before waiting again, including what
+       arrives meanwhile. */
+    while (xInItems != 0U)
+    {
+      xOutItems = 0U;
+
+      if (pxOut != NULL)
+      {
+        xOutItems = prvReserveItems(pxOut, &pvOut);
+        if (xOutItems == 0U)
+        {
+          pxStage->ulStalls++;
+          (void) prvWaitForRoom(pxOut, portMAX_DELAY);
+          continue;
+        }
+      }
+
+      xConsumed = pxStage->pxFunction(pxStage->pvContext, pvIn, xInItems, pvOut, &xOutItems);
+      pxStage->ulCalls++;
+
+      configASSERT(xConsumed <= xInItems);
+      configASSERT((pxOut != NULL) || (xOutItems == 0U));
+      configASSERT((xConsumed != 0U) || (xOutItems != 0U));
+
+      if (xOutItems != 0U)
+      {
+        vPipelineCommit(pxOut, xOutItems);
+        pxStage->ulItemsOut += xOutItems;
+      }
+
+      if (xConsumed != 0U)
+      {
+        (void) xStreamBufferConsume(pxIn->xStream, xConsumed * pxIn->xItemSize);
+        prvWakeWriter(pxIn);
+        pxStage->ulItemsIn += xConsumed;
+      }
+
+      xInItems = xStreamBufferPeekContiguous(pxIn->xStream, &pvIn, 0U) / pxIn->xItemSize;
+    }
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Contiguous free items in a link.
+  * @retval The items at *ppvItems.
+  */
+static size_t prvReserveItems(PipelineLink_t *pxLink, void **ppvItems)
+{
+  return xStreamBufferReserve(pxLink->xStream, ppvItems) / pxLink->xItemSize;
+}
+
+/**
+  * @brief  Wait, as the link's writer, until its reader has freed a batch.
+  * @retval pdTRUE if there is room now, else pdFALSE.
+  */
+static BaseType_t prvWaitForRoom(PipelineLink_t *pxLink, TickType_t xTicksToWait)
+{
+  void *pvFree;
+  size_t xRoom;
+
+  taskENTER_CRITICAL();
+  {
+    (void) xTaskNotifyStateClear(NULL);
+
+    xRoom = prvReserveItems(pxLink, &pvFree);
+    if (xRoom == 0U)
+    {
+      pxLink->xStalledWriter = xTaskGetCurrentTaskHandle();
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  if (xRoom == 0U)
+  {
+    (void) xTaskNotifyWait(0U, 0U, NULL, xTicksToWait);
+
+    taskENTER_CRITICAL();
+    {
+      pxLink->xStalledWriter = NULL;
+    }
+    taskEXIT_CRITICAL();
+
+    xRoom = prvReserveItems(pxLink, &pvFree);
+  }
+
+  return (xRoom != 0U) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  After the reader has consumed from a link, wake its writer if it
+  *         is waiting and a batch is now free.
+  * @retval None
+  */
+static void prvWakeWriter(PipelineLink_t *pxLink)
+{
+  TaskHandle_t xWriter = NULL;
+
+  taskENTER_CRITICAL();
+  {
+    if ((pxLink->xStalledWriter != NULL) &&
+        (xStreamBufferSpacesAvailable(pxLink->xStream) >= (pxLink->xBatch * pxLink->xItemSize)))
+    {
+      xWriter = pxLink->xStalledWriter;
+      pxLink->xStalledWriter = NULL;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  if (xWriter != NULL)
+  {
+    (void) xTaskNotify(xWriter, 0U, eNoAction);
+  }
+}
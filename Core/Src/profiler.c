@@ -0,0 +1,267 @@
+/**
+  ******************************************************************************
+  * @file           : profiler.c
+  * @brief          : Statistical PC sampling profiler, see profiler.h.
+  ******************************************************************************
+  * TIM2_IRQHandler() is naked: it picks the stack the interrupted code was
+  * stacked on from EXC_RETURN and branches here with the frame, whose seventh
+  * word is the PC.  The running task comes from xTaskGetCurrentTaskHandle(),
+  * a single load of the kernel's current TCB pointer with no critical
+  * section, which is why the interrupt may sit above the ceiling.  A sample
+  * taken in the middle of a context switch goes to whichever task the
+  * pointer names at the time.
+  *
+  * There are two tables.  The interrupt fills the one ulActive names while
+  * the report task empties the other, so neither ever waits for the other:
+  * the task switches ulActive and, since an interrupt that saw the old value
+  * finishes before the task runs again, has the old table to itself from
+  * then on.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "profiler.h"
+#include "irqtable.h"
+#include "taskreg.h"
+#include "log.h"
+#include "fmt.h"
+
+#if (profilerENABLE == 1)
+
+#if ((profilerSLOTS & (profilerSLOTS - 1U)) != 0U)
+#error profilerSLOTS must be a power of two
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t ulPc;
+  uint32_t ulTask;            /*!< Task handle, 0 for an interrupt.    */
+  uint32_t ulCount;           /*!< 0 while the slot is free.           */
+} ProfilerSlot_t;
+
+typedef struct
+{
+  ProfilerSlot_t xSlots[profilerSLOTS];
+  uint32_t ulSamples;
+  uint32_t ulLost;
+} ProfilerTable_t;
+
+/* Private variables ---------------------------------------------------------*/
+static ProfilerTable_t xTables[2];
+static volatile uint32_t ulActive = 0U;
+/* Only the report task touches this. */
+static TaskStatus_t xTasks[profilerMAX_TASKS];
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvProfilerTask(void *pvParameters);
+static void prvSetRate(void);
+static void prvReport(ProfilerTable_t *pxTable);
+static const char *prvTaskName(uint32_t ulTask, UBaseType_t uxTasks);
+static void prvEmit(const char *pcFormat, ...) fmtCHECK(1, 2);
+
+/* Registered tasks ----------------------------------------------------------*/
+TASK_REGISTER(PROF, prvProfilerTask, NULL, 192, tskIDLE_PRIORITY);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  TIM2 update interrupt body, branched to from TIM2_IRQHandler().
+  * @param  pulFrame    Exception frame of the interrupted code.
+  * @param  ulExcReturn EXC_RETURN of this interrupt.
+  * @retval None
+  */
+void vProfilerSample(const uint32_t *pulFrame, uint32_t ulExcReturn)
+{
+  ProfilerTable_t *pxTable = &xTables[ulActive];
+  ProfilerSlot_t *pxSlot;
+  uint32_t ulPc = pulFrame[6];
+  uint32_t ulTask = 0U;
+  uint32_t ulIndex;
+  uint32_t ulProbe;
+
+  TIM2->SR = (uint32_t) ~TIM_SR_UIF;
+
+  /* Returning to thread mode on the process stack: a task was running. */
+  if ((ulExcReturn & 0x0CU) == 0x0CU)
+  {
+    ulTask = (uint32_t) xTaskGetCurrentTaskHandle();
+  }
+
+  pxTable->ulSamples++;
+
+  /* Fibonacci hashing of both halves of the key; Thumb PCs are even. */
+  ulIndex = (((ulPc >> 1) ^ (ulTask >> 3)) * 2654435761UL) >> 16;
+
+  for (ulProbe = 0U; ulProbe < profilerPROBES; ulProbe++)
+  {
+    pxSlot = &pxTable->xSlots[(ulIndex + ulProbe) & (profilerSLOTS - 1U)];
+
+    if (pxSlot->ulCount == 0U)
+    {
+      pxSlot->ulPc = ulPc;
+      pxSlot->ulTask = ulTask;
+      pxSlot->ulCount = 1U;
+      return;
+    }
+
+    if ((pxSlot->ulPc == ulPc) && (pxSlot->ulTask == ulTask))
+    {
+      pxSlot->ulCount++;
+      return;
+    }
+  }
+
+  pxTable->ulLost++;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Start the sample clock, then report a window every
+  *         profilerREPORT_MS.
+  * @param  pvParameters Unused.
+  * @retval None
+  */
+static void prvProfilerTask(void *pvParameters)
+{
+  TickType_t xLastWake;
+  uint32_t ulTaken;
+
+  (void) pvParameters;
+
+  __HAL_RCC_TIM2_CLK_ENABLE();
+
+  TIM2->CR1 = 0U;
+  TIM2->PSC = 0U;
+  prvSetRate();
+  TIM2->EGR = TIM_EGR_UG;
+  TIM2->SR = 0U;
+  TIM2->DIER = TIM_DIER_UIE;
+
+  HAL_NVIC_SetPriority(TIM2_IRQn, irqtablePRIORITY(TIM2), 0U);
+  HAL_NVIC_ClearPendingIRQ(TIM2_IRQn);
+  HAL_NVIC_EnableIRQ(TIM2_IRQn);
+
+  /* ARR is buffered, so a new rate never leaves the counter above it. */
+  TIM2->CR1 = TIM_CR1_ARPE | TIM_CR1_CEN;
+
+  xLastWake = xTaskGetTickCount();
+
+  for (;;)
+  {
+    vTaskDelayUntil(&xLastWake, pdMS_TO_TICKS(profilerREPORT_MS));
+
+    ulTaken = ulActive;
+    ulActive = ulTaken ^ 1U;
+    __DSB();
+
+    prvReport(&xTables[ulTaken]);
+    prvSetRate();
+  }
+}
+
+/**
+  * @brief  Set the reload for profilerRATE_HZ at the current APB1 timer
+  *         clock, which the governor may have changed.
+  * @retval None
+  */
+static void prvSetRate(void)
+{
+  RCC_ClkInitTypeDef xClocks;
+  uint32_t ulLatency;
+  uint32_t ulTimerHz;
+
+  /* APB1 timers run at twice PCLK1 whenever APB1 is divided. */
+  HAL_RCC_GetClockConfig(&xClocks, &ulLatency);
+  ulTimerHz = HAL_RCC_GetPCLK1Freq();
+  if (xClocks.APB1CLKDivider != RCC_HCLK_DIV1)
+  {
+    ulTimerHz *= 2U;
+  }
+
+  TIM2->ARR = (ulTimerHz / profilerRATE_HZ) - 1U;
+}
+
+/**
+  * @brief  Log a window and empty its table.
+  * @retval None
+  */
+static void prvReport(ProfilerTable_t *pxTable)
+{
+  UBaseType_t uxTasks;
+  uint32_t x;
+
+  uxTasks = uxTaskGetSystemState(xTasks, profilerMAX_TASKS, NULL);
+
+  prvEmit("prof,window,%lu,%lu,%lu\n\r", (unsigned long) pxTable->ulSamples,
+          (unsigned long) pxTable->ulLost, (unsigned long) profilerRATE_HZ);
+
+  for (x = 0U; x < profilerSLOTS; x++)
+  {
+    if (pxTable->xSlots[x].ulCount != 0U)
+    {
+      prvEmit("prof,%s,0x%08lx,%lu\n\r", prvTaskName(pxTable->xSlots[x].ulTask, uxTasks),
+              (unsigned long) pxTable->xSlots[x].ulPc, (unsigned long) pxTable->xSlots[x].ulCount);
+      pxTable->xSlots[x].ulCount = 0U;
+    }
+  }
+
+  pxTable->ulSamples = 0U;
+  pxTable->ulLost = 0U;
+}
+
+/**
+  * @brief  The name of a sampled task, looked up among the tasks that exist
+  *         now, so a deleted one is never dereferenced.
+  * @retval The name, "isr" or "-".
+  */
+static const char *prvTaskName(uint32_t ulTask, UBaseType_t uxTasks)
+{
+  UBaseType_t x;
+
+  if (ulTask == 0U)
+  {
+    return "isr";
+  }
+
+  for (x = 0U; x < uxTasks; x++)
+  {
+    if ((uint32_t) xTasks[x].xHandle == ulTask)
+    {
+      return xTasks[x].pcTaskName;
+    }
+  }
+
+  return "-";
+}
+
+/**
+  * @brief  Format a row like xLogPrintf() and queue it once the log ring has
+  *         room, so a window is never cut short.
+  * @retval None
+  */
+static void prvEmit(const char *pcFormat, ...)
+{
+  char cLine[logPRINTF_LENGTH];
+  va_list xArgs;
+  size_t xLength;
+
+  va_start(xArgs, pcFormat);
+  xLength = xFmtVFormat(cLine, sizeof(cLine), pcFormat, xArgs);
+  va_end(xArgs);
+
+  while ((logRING_SIZE - xLogGetPending()) < xLength)
+  {
+    vTaskDelay(1U);
+  }
+
+  (void) xLogWrite(cLine, xLength);
+}
+
+#endif /* profilerENABLE */
@@ -0,0 +1,495 @@
+/**
+  ******************************************************************************
+  * @file           : shell.c
+  * @brief          : On-demand diagnostics shell on USART2.
+  ******************************************************************************
+  * The task looks at received bytes in the ring with xUartRxAcquire(), past
+  * the ones it has already scanned, until it finds the end of a line.  The
+  * line is then still in the ring, whole, and normally in one piece: the
+  * task writes a NUL over its terminator and over each run of separators,
+  * points the arguments at the words where they lie, runs the command and
+  * only then gives the bytes back with vUartRxRelease().  While it runs,
+  * reception carries on into the rest of the ring.
+  *
+  * Commands answer through xLogPrintf(), which drops what does not fit in
+  * the log ring rather than block, so a long answer on a busy log may come
+  * out short.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "shell.h"
+#include "uartrx.h"
+#include "log.h"
+#include "taskreg.h"
+#include "trace.h"
+#include "cpustats.h"
+#include "clockprofile.h"
+#include "governor.h"
+#include "pipeline.h"
+#include "uartline.h"
+
+#if (shellENABLE == 1)
+
+#if (shellLINE_LENGTH >= uartrxRING_SIZE)
+#error shellLINE_LENGTH must be less than uartrxRING_SIZE
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+  * @brief  One command: its name, a line of help and what runs it, with the
+  *         words of the line, its name first.
+  */
+typedef struct
+{
+  const char *pcName;
+  const char *pcHelp;
+  void (*pxHandler)(UBaseType_t uxArgc, char *ppcArgv[]);
+} ShellCommand_t;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvShellTask(void *pvParameters);
+static char *prvTakeLine(size_t xLength);
+static void prvRunLine(char *pcLine);
+static void prvCommandHelp(UBaseType_t uxArgc, char *ppcArgv[]);
+static void prvCommandHeap(UBaseType_t uxArgc, char *ppcArgv[]);
+static void prvCommandTasks(UBaseType_t uxArgc, char *ppcArgv[]);
+static void prvCommandStats(UBaseType_t uxArgc, char *ppcArgv[]);
+static void prvCommandTrace(UBaseType_t uxArgc, char *ppcArgv[]);
+static void prvCommandClock(UBaseType_t uxArgc, char *ppcArgv[]);
+static void prvCommandPipes(UBaseType_t uxArgc, char *ppcArgv[]);
+static void prvCommandBaud(UBaseType_t uxArgc, char *ppcArgv[]);
+
+/* Private variables ---------------------------------------------------------*/
+static const ShellCommand_t xShellCommands[] =
+{
+  { "help",  "list the commands",                   prvCommandHelp  },
+  { "heap",  "[changes|owners|leaks] heap figures", prvCommandHeap  },
+  { "tasks", "state, priority, stack and CPU share", prvCommandTasks },
+  { "stats", "CPU snapshot and drop counts",        prvCommandStats },
+  { "trace", "start|stop the trace recorder",       prvCommandTrace },
+  { "clock", "clock profile and governor load",     prvCommandClock },
+  { "pipes", "pipeline stage throughput",           prvCommandPipes },
+  { "baud",  "[rate] line rate, or switch it",       prvCommandBaud  },
+};
+
+static const char * const pcShellProfileNames[CLOCK_PROFILE_COUNT] =
+{
+  "performance", "balanced", "low power"
+};
+
+/* Only the shell task touches these. */
+static char cShellLine[shellLINE_LENGTH + 1U];
+static TaskStatus_t xShellTasks[shellMAX_TASKS];
+static PipelineStats_t xShellStages[shellMAX_STAGES];
+/* Run time counters at the previous tasks command, by task number, so the
+   shares cover the time since then whatever the counters have wrapped. */
+static UBaseType_t uxShellTaskNumbers[shellMAX_TASKS];
+static uint32_t ulShellRunTimes[shellMAX_TASKS];
+static UBaseType_t uxShellHistory = 0U;
+static uint32_t ulShellTotal = 0U;
+
+/* Registered tasks ----------------------------------------------------------*/
+TASK_REGISTER_IN(CCM, SHELL, prvShellTask, NULL, shellSTACK_DEPTH, shellPRIORITY);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Wait for lines and run them, one at a time.
+  * @retval None
+  */
+static void prvShellTask(void *pvParameters)
+{
+  uint8_t *pucData;
+  size_t xScanned = 0U;
+  size_t xCount;
+  size_t x;
+  BaseType_t xDiscarding = pdFALSE;
+  char *pcLine;
+
+  (void) pvParameters;
+
+  for (;;)
+  {
+    xCount = xUartRxAcquire(xScanned, &pucData, portMAX_DELAY);
+
+    for (x = 0U; x < xCount; x++)
+    {
+      if ((pucData[x] == (uint8_t) '\r') || (pucData[x] == (uint8_t) '\n'))
+      {
+        break;
+      }
+    }
+
+    if (x == xCount)
+    {
+      /* No end yet.  A line already too long is given back as it comes, so
+         it cannot hold the ring. */
+      xScanned += xCount;
+      if (xScanned > shellLINE_LENGTH)
+      {
+        vUartRxRelease(xScanned);
+        xScanned = 0U;
+        xDiscarding = pdTRUE;
+      }
+      continue;
+    }
+
+    xScanned += x;
+
+    if (xDiscarding != pdFALSE)
+    {
+      (void) xLogPrintf("shell: line over %u characters\n\r", (unsigned) shellLINE_LENGTH);
+      xDiscarding = pdFALSE;
+    }
+    else if (xScanned <= shellLINE_LENGTH)
+    {
+      pcLine = prvTakeLine(xScanned);
+      prvRunLine(pcLine);
+    }
+    else
+    {
+      (void) xLogPrintf("shell: line over %u characters\n\r", (unsigned) shellLINE_LENGTH);
+    }
+
+    /* The terminator goes too; the LF of a CRLF ends an empty line. */
+    vUartRxRelease(xScanned + 1U);
+    xScanned = 0U;
+  }
+}
+
+/**
+  * @brief  Make the line at the front of the ring a C string.
+  * @param  xLength Bytes before its terminator, all received.
+  * @retval The line in place with a NUL over the terminator, or a copy in
+  *         cShellLine if it wraps round the end of the ring.
+  */
+static char *prvTakeLine(size_t xLength)
+{
+  uint8_t *pucData;
+  uint8_t *pucRest;
+  size_t xFirst;
+
+  xFirst = xUartRxAcquire(0U, &pucData, 0U);
+
+  if (xFirst > xLength)
+  {
+    pucData[xLength] = 0U;
+    return (char *) pucData;
+  }
+
+  (void) memcpy(cShellLine, pucData, xFirst);
+  if (xLength > xFirst)
+  {
+    (void) xUartRxAcquire(xFirst, &pucRest, 0U);
+    (void) memcpy(&cShellLine[xFirst], pucRest, xLength - xFirst);
+  }
+  cShellLine[xLength] = '\0';
+
+  return cShellLine;
+}
+
+/**
+  * @brief  Split a line into words in place and run its command.
+  * @retval None
+  */
+static void prvRunLine(char *pcLine)
+{
+  char *ppcArgv[shellMAX_ARGS];
+  UBaseType_t uxArgc = 0U;
+  size_t x;
+
+  for (;;)
+  {
+    while ((*pcLine == ' ') || (*pcLine == '\t'))
+    {
+      *pcLine++ = '\0';
+    }
+
+    if (*pcLine == '\0')
+    {
+      break;
+    }
+
+    if (uxArgc == shellMAX_ARGS)
+    {
+      (void) xLogPrintf("shell: more than %u words\n\r", (unsigned) shellMAX_ARGS);
+      return;
+    }
+
+    ppcArgv[uxArgc++] = pcLine;
+
+    while ((*pcLine != '\0') && (*pcLine != ' ') && (*pcLine != '\t'))
+    {
+      pcLine++;
+    }
+  }
+
+  if (uxArgc == 0U)
+  {
+    return;
+  }
+
+  for (x = 0U; x < (sizeof(xShellCommands) / sizeof(xShellCommands[0])); x++)
+  {
+    if (strcmp(ppcArgv[0], xShellCommands[x].pcName) == 0)
+    {
+      /* The line got here, so the host keeps up with the rate. */
+      vUartLineConfirm();
+      xShellCommands[x].pxHandler(uxArgc, ppcArgv);
+      return;
+    }
+  }
+
+  (void) xLogPrintf("shell: no command %s, try help\n\r", ppcArgv[0]);
+}
+
+/**
+  * @brief  help: one line per command.
+  * @retval None
+  */
+static void prvCommandHelp(UBaseType_t uxArgc, char *ppcArgv[])
+{
+  size_t x;
+
+  (void) uxArgc;
+  (void) ppcArgv;
+
+  for (x = 0U; x < (sizeof(xShellCommands) / sizeof(xShellCommands[0])); x++)
+  {
+    (void) xLogPrintf("%-6s %s\n\r", xShellCommands[x].pcName, xShellCommands[x].pcHelp);
+  }
+}
+
+/**
+  * @brief  heap: the figures, or with an argument the free list changes since
+  *         the last report, the bytes each task holds or the oldest blocks.
+  * @retval None
+  */
+static void prvCommandHeap(UBaseType_t uxArgc, char *ppcArgv[])
+{
+  if (uxArgc == 1U)
+  {
+    vPrintHeapStats();
+  }
+  else if (strcmp(ppcArgv[1], "changes") == 0)
+  {
+    (void) xPrintHeapChanges();
+  }
+#if (configHEAP_TRACK_OWNERS == 1)
+  else if (strcmp(ppcArgv[1], "owners") == 0)
+  {
+    vPrintHeapOwners();
+  }
+  else if (strcmp(ppcArgv[1], "leaks") == 0)
+  {
+    /* Any block that has been through a report before. */
+    vPrintHeapLeaks(1U);
+  }
+#endif
+  else
+  {
+    (void) xLogPrintf("shell: heap %s not known\n\r", ppcArgv[1]);
+  }
+}
+
+/**
+  * @brief  tasks: one line per task, with its CPU share since the previous
+  *         tasks command, or since boot the first time.
+  * @retval None
+  */
+static void prvCommandTasks(UBaseType_t uxArgc, char *ppcArgv[])
+{
+  static const char cStates[] = { 'X', 'R', 'B', 'S', 'D', '?' };
+  UBaseType_t uxTasks;
+  UBaseType_t x;
+  UBaseType_t y;
+  uint32_t ulTotal;
+  uint32_t ulWindow;
+  uint32_t ulRunTime;
+
+  (void) uxArgc;
+  (void) ppcArgv;
+
+  uxTasks = uxTaskGetSystemState(xShellTasks, shellMAX_TASKS, &ulTotal);
+  if (uxTasks == 0U)
+  {
+    (void) xLogPrintf("shell: more than %u tasks\n\r", (unsigned) shellMAX_TASKS);
+    return;
+  }
+
+  ulWindow = ulTotal - ulShellTotal;
+
+  (void) xLogPrintf("%-*s st pri base stack  cpu%%\n\r", configMAX_TASK_NAME_LEN, "task");
+
+  for (x = 0U; x < uxTasks; x++)
+  {
+    ulRunTime = xShellTasks[x].ulRunTimeCounter;
+    for (y = 0U; y < uxShellHistory; y++)
+    {
+      if (uxShellTaskNumbers[y] == xShellTasks[x].xTaskNumber)
+      {
+        ulRunTime -= ulShellRunTimes[y];
+        break;
+      }
+    }
+
+    (void) xLogPrintf("%-*s  %c %3lu %4lu %5lu %3lu.%lu\n\r", configMAX_TASK_NAME_LEN,
+                      xShellTasks[x].pcTaskName,
+                      cStates[(xShellTasks[x].eCurrentState < eInvalid) ? xShellTasks[x].eCurrentState : eInvalid],
+                      (unsigned long) xShellTasks[x].uxCurrentPriority,
+                      (unsigned long) xShellTasks[x].uxBasePriority,
+                      (unsigned long) xShellTasks[x].usStackHighWaterMark,
+                      (unsigned long) ((ulWindow >= 1000U) ? (ulRunTime / (ulWindow / 1000U)) / 10U : 0U),
+                      (unsigned long) ((ulWindow >= 1000U) ? (ulRunTime / (ulWindow / 1000U)) % 10U : 0U));
+  }
+
+  for (x = 0U; x < uxTasks; x++)
+  {
+    uxShellTaskNumbers[x] = xShellTasks[x].xTaskNumber;
+    ulShellRunTimes[x] = xShellTasks[x].ulRunTimeCounter;
+  }
+  uxShellHistory = uxTasks;
+  ulShellTotal = ulTotal;
+}
+
+/**
+  * @brief  stats: a cpustats.h snapshot, the context switch times and what
+  *         each ring has dropped.
+  * @retval None
+  */
+static void prvCommandStats(UBaseType_t uxArgc, char *ppcArgv[])
+{
+  (void) uxArgc;
+  (void) ppcArgv;
+
+  (void) xCpuStatsSend();
+  vCpuStatsPrintSwitchTime();
+  (void) xLogPrintf("dropped log %lu rx %lu, rx errors %lu\n\r",
+                    (unsigned long) ulLogGetDropped(), (unsigned long) ulUartRxGetDropped(),
+                    (unsigned long) ulUartRxGetErrors());
+#if (configUSE_TRACE_RECORDER == 1)
+  (void) xLogPrintf("dropped trace %lu\n\r", (unsigned long) ulTraceGetDropped());
+#endif
+}
+
+/**
+  * @brief  trace start|stop: let the kernel hooks record, or hold them.
+  * @retval None
+  */
+static void prvCommandTrace(UBaseType_t uxArgc, char *ppcArgv[])
+{
+#if (configUSE_TRACE_RECORDER == 1)
+  if ((uxArgc == 2U) && (strcmp(ppcArgv[1], "start") == 0))
+  {
+    vTraceStart();
+  }
+  else if ((uxArgc == 2U) && (strcmp(ppcArgv[1], "stop") == 0))
+  {
+    vTraceStop();
+  }
+  else
+  {
+    (void) xLogPrintf("shell: trace start|stop\n\r");
+  }
+#else
+  (void) uxArgc;
+  (void) ppcArgv;
+
+  (void) xLogPrintf("shell: no trace recorder in this build\n\r");
+#endif
+}
+
+/**
+  * @brief  clock: the profile the governor has chosen and why.
+  * @retval None
+  */
+static void prvCommandClock(UBaseType_t uxArgc, char *ppcArgv[])
+{
+  ClockProfile_t eProfile = eClockProfileGet();
+
+  (void) uxArgc;
+  (void) ppcArgv;
+
+  (void) xLogPrintf("clock %s, sysclk %lu Hz, core %lu Hz, load %u.%u%%\n\r",
+                    pcShellProfileNames[eProfile],
+                    (unsigned long) ulClockProfileGetSysclkHz(eProfile),
+                    (unsigned long) SystemCoreClock,
+                    (unsigned) (usGovernorGetLoadPermille() / 10U),
+                    (unsigned) (usGovernorGetLoadPermille() % 10U));
+}
+
+/**
+  * @brief  pipes: what each pipeline stage has moved, and how many items it
+  *         moved for each wake-up and each call of its function.
+  * @retval None
+  */
+static void prvCommandPipes(UBaseType_t uxArgc, char *ppcArgv[])
+{
+  UBaseType_t uxCount;
+  UBaseType_t x;
+  const PipelineStats_t *pxStats;
+
+  (void) uxArgc;
+  (void) ppcArgv;
+
+  uxCount = uxPipelineGetStats(xShellStages, shellMAX_STAGES);
+  if (uxCount == 0U)
+  {
+    (void) xLogPrintf("shell: no pipeline stages\n\r");
+    return;
+  }
+
+  for (x = 0U; x < uxCount; x++)
+  {
+    pxStats = &xShellStages[x];
+    (void) xLogPrintf("%-8s in %lu out %lu, %lu/wake %lu/call, stalls %lu, full %lu, peak %u/%u\n\r",
+                      pxStats->pcName, (unsigned long) pxStats->ulItemsIn,
+                      (unsigned long) pxStats->ulItemsOut,
+                      (unsigned long) ((pxStats->ulWakes != 0U) ? (pxStats->ulItemsIn / pxStats->ulWakes) : 0U),
+                      (unsigned long) ((pxStats->ulCalls != 0U) ? (pxStats->ulItemsIn / pxStats->ulCalls) : 0U),
+                      (unsigned long) pxStats->ulStalls, (unsigned long) pxStats->ulInputFull,
+                      (unsigned) pxStats->usPeakItems, (unsigned) pxStats->usDepth);
+  }
+}
+
+/**
+  * @brief  baud [rate]: the line's rate and its ceiling, or switch to a new
+  *         rate, which reverts unless a command arrives at it in time.
+  * @retval None
+  */
+static void prvCommandBaud(UBaseType_t uxArgc, char *ppcArgv[])
+{
+  char *pcEnd;
+  uint32_t ulBaud;
+
+  if (uxArgc == 1U)
+  {
+    (void) xLogPrintf("baud %lu, max %lu, flow control %s\n\r",
+                      (unsigned long) ulUartLineGetBaud(),
+                      (unsigned long) ulUartLineGetMaxBaud(),
+                      (uartlineFLOW_CONTROL == 1) ? "rts/cts" : "none");
+    return;
+  }
+
+  ulBaud = (uint32_t) strtoul(ppcArgv[1], &pcEnd, 10);
+  if ((uxArgc != 2U) || (*pcEnd != '\0') || (ulBaud == 0U))
+  {
+    (void) xLogPrintf("shell: baud [rate]\n\r");
+    return;
+  }
+
+  (void) xLogPrintf("baud: switching to %lu, send a line within %u ms to keep it\n\r",
+                    (unsigned long) ulBaud, (unsigned) uartlineCONFIRM_MS);
+
+  if (xUartLineSetBaud(ulBaud, pdTRUE) != pdPASS)
+  {
+    (void) xLogPrintf("shell: baud %lu out of reach\n\r", (unsigned long) ulBaud);
+  }
+}
+
+#endif /* shellENABLE */
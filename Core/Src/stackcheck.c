@@ -0,0 +1,197 @@
+/**
+  ******************************************************************************
+  * @file           : stackcheck.c
+  * @brief          : Runtime stack watermarks of the registered tasks and of
+  *                   the main stack, and the kernel's stack overflow hook.
+  ******************************************************************************
+  * The watermark is the least free stack a task has ever had, found by
+  * uxTaskGetStackHighWaterMark() scanning for the fill pattern the kernel
+  * writes into every new stack.  It only shows the paths that actually ran,
+  * so it complements rather than replaces the static worst case computed by
+  * Tools/stack_usage.py.
+  *
+  * Registered tasks use static memory, so a task that has deleted itself
+  * keeps its TCB and stack and is still reported, with the watermark it left
+  * behind.  The idle and timer service tasks are reported as well, with the
+  * depths taskreg.c gives them.
+  *
+  * The main stack is scanned the same way, up from _sstack for the first
+  * word that is not stackcheckMSP_FILL.  Its words are 32 bits like a
+  * task's, so the figures compare directly.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "stackcheck.h"
+#include "taskreg.h"
+#include "log.h"
+#include "fmt.h"
+#include "crashlog.h"
+#if (configUSE_TIMERS == 1)
+#include "timers.h"
+#endif
+
+#if (INCLUDE_uxTaskGetStackHighWaterMark == 1)
+
+#if (stackcheckMSP_RESTART == 1) && (configUSE_DAEMON_TASK_STARTUP_HOOK != 1)
+#error stackcheckMSP_RESTART needs configUSE_DAEMON_TASK_STARTUP_HOOK
+#endif
+
+/* Exported variables --------------------------------------------------------*/
+volatile TaskHandle_t xStackOverflowTask = NULL;
+
+/* Bounds of the main stack, from the linker script. */
+extern uint32_t _sstack[];
+extern uint32_t _estack[];
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvReportTask(const char *pcName, TaskHandle_t xTask, uint32_t ulDepth);
+static void prvReportLine(const char *pcName, uint32_t ulDepth, uint32_t ulFree);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Log the depth, watermark and free stack of every registered task.
+  * @note   Call only once the scheduler is running.  Each scan walks the unused part of a stack, so the cost grows with
+  *         the stack sizes; call it from a low priority task.
+  * @retval None
+  */
+void vStackCheckReport(void)
+{
+  const TaskRegistryEntry_t *pxEntry;
+  UBaseType_t x;
+
+  for (x = 0U; x < uxTaskRegistryCount(); x++)
+  {
+    pxEntry = pxTaskRegistryGet(x);
+    if (*pxEntry->pxHandle != NULL)
+    {
+      prvReportTask(pxEntry->pcName, *pxEntry->pxHandle, pxEntry->ulStackDepth);
+    }
+  }
+
+#if (INCLUDE_xTaskGetIdleTaskHandle == 1)
+  prvReportTask(pcTaskGetName(xTaskGetIdleTaskHandle()), xTaskGetIdleTaskHandle(),
+                configMINIMAL_STACK_SIZE + taskregGUARD_WORDS);
+#endif
+#if (configUSE_TIMERS == 1)
+  prvReportTask(pcTaskGetName(xTimerGetTimerDaemonTaskHandle()), xTimerGetTimerDaemonTaskHandle(),
+                configTIMER_TASK_STACK_DEPTH + taskregGUARD_WORDS);
+#endif
+
+  prvReportLine("MSP", uxStackCheckMspDepth(), uxStackCheckMspHighWaterMark());
+}
+
+/**
+  * @brief  Size of the main stack.
+  * @retval Words.
+  */
+UBaseType_t uxStackCheckMspDepth(void)
+{
+  return (UBaseType_t) (_estack - _sstack);
+}
+
+/**
+  * @brief  Least free main stack since reset or the last
+  *         vStackCheckMspRestart().
+  * @note   Scans the unused part of the stack, as
+  *         uxTaskGetStackHighWaterMark() does for a task.
+  * @retval Words never written.
+  */
+UBaseType_t uxStackCheckMspHighWaterMark(void)
+{
+  const volatile uint32_t *pulWord = _sstack;
+
+  while ((pulWord < _estack) && (*pulWord == stackcheckMSP_FILL))
+  {
+    pulWord++;
+  }
+
+  return (UBaseType_t) (pulWord - _sstack);
+}
+
+/**
+  * @brief  Paint the whole main stack again, so the watermark starts over.
+  * @note   Call from a task.  Nothing then has a frame on the main stack,
+  *         and interrupts are held off with PRIMASK, FAST ones included,
+  *         for the few microseconds the paint takes.
+  * @retval None
+  */
+void vStackCheckMspRestart(void)
+{
+  volatile uint32_t *pulWord;
+
+  configASSERT(__get_IPSR() == 0U);
+
+  __disable_irq();
+  for (pulWord = _sstack; pulWord < _estack; pulWord++)
+  {
+    *pulWord = stackcheckMSP_FILL;
+  }
+  __enable_irq();
+}
+
+#if (configUSE_DAEMON_TASK_STARTUP_HOOK == 1)
+/**
+  * @brief  Run once by the timer service task before its first command, the
+  *         scheduler being up by then.
+  * @retval None
+  */
+void vApplicationDaemonTaskStartupHook(void)
+{
+#if (stackcheckMSP_RESTART == 1)
+  vStackCheckMspRestart();
+#endif
+}
+#endif /* configUSE_DAEMON_TASK_STARTUP_HOOK */
+
+#if (configCHECK_FOR_STACK_OVERFLOW > 0)
+/**
+  * @brief  Called by the kernel when a task switched out with its stack
+  *         pointer past the limit or the guard pattern at the end overwritten.
+  * @note   Memory next to the stack is already corrupt, so the system
+  *         panics with the culprit in xStackOverflowTask and its name in the
+  *         crash log.
+  * @retval None
+  */
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
+{
+  char cLine[32];
+  size_t xLength;
+
+  taskDISABLE_INTERRUPTS();
+  xStackOverflowTask = xTask;
+  xLength = xFmtFormat(cLine, sizeof(cLine), "stack overflow %s\n\r", pcTaskName);
+  vCrashLogAppend(cLine, xLength);
+  vCrashLogPanic(crashlogREASON_STACK_OVERFLOW, (uint32_t) xTask);
+}
+#endif /* configCHECK_FOR_STACK_OVERFLOW */
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Log one task's line.
+  * @param  ulDepth Stack depth the task was created with, in words.  The
+  *                 MPU stack guard's words are left out of the line, being
+  *                 never written and never usable.
+  * @retval None
+  */
+static void prvReportTask(const char *pcName, TaskHandle_t xTask, uint32_t ulDepth)
+{
+  prvReportLine(pcName, ulDepth - taskregGUARD_WORDS,
+                (uint32_t) uxTaskGetStackHighWaterMark(xTask) - taskregGUARD_WORDS);
+}
+
+/**
+  * @brief  Log a line for a stack of ulDepth words with ulFree never used.
+  * @retval None
+  */
+static void prvReportLine(const char *pcName, uint32_t ulDepth, uint32_t ulFree)
+{
+  (void) xLogPrintf("stack %-*.*s depth %4lu used %4lu free %4lu\n\r",
+                    (int) configMAX_TASK_NAME_LEN, (int) configMAX_TASK_NAME_LEN, pcName,
+                    (unsigned long) ulDepth, (unsigned long) (ulDepth - ulFree), (unsigned long) ulFree);
+}
+
+#endif /* INCLUDE_uxTaskGetStackHighWaterMark */
@@ -22,6 +22,22 @@
 #include "stm32f4xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "FreeRTOS.h"
+#include "log.h"
+#include "lowpower.h"
+#include "timebase.h"
+#include "led.h"
+#include "kernbench.h"
+#include "irqlat.h"
+#include "profiler.h"
+#include "accel.h"
+#include "audio.h"
+#include "mic.h"
+#include "usbcdc.h"
+#include "button.h"
+#include "dmacopy.h"
+#include "crc.h"
+#include "irqtable.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -41,7 +57,8 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN PV */
-
+/* Every row of the interrupt table at a priority its class allows. */
+BOARD_IRQ_TABLE(irqtableCHECK)
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -55,9 +72,11 @@
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
-extern TIM_HandleTypeDef htim7;
+extern DMA_HandleTypeDef hdma_usart2_tx;
+extern UART_HandleTypeDef huart2;
 
 /* USER CODE BEGIN EV */
+extern DMA_HandleTypeDef hdma_usart2_rx;
 
 /* USER CODE END EV */
 
@@ -79,66 +98,6 @@ void NMI_Handler(void)
   /* USER CODE END NonMaskableInt_IRQn 1 */
 }
 
-/**
-  * @brief This function handles Hard fault interrupt.
-  */
-void HardFault_Handler(void)
-{
-  /* USER CODE BEGIN HardFault_IRQn 0 */
-
-  /* USER CODE END HardFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_HardFault_IRQn 0 */
-    /* USER CODE END W1_HardFault_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Memory management fault.
-  */
-void MemManage_Handler(void)
-{
-  /* USER CODE BEGIN MemoryManagement_IRQn 0 */
-
-  /* USER CODE END MemoryManagement_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_MemoryManagement_IRQn 0 */
-    /* USER CODE END W1_MemoryManagement_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Pre-fetch fault, memory access fault.
-  */
-void BusFault_Handler(void)
-{
-  /* USER CODE BEGIN BusFault_IRQn 0 */
-
-  /* USER CODE END BusFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_BusFault_IRQn 0 */
-    /* USER CODE END W1_BusFault_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Undefined instruction or illegal state.
-  */
-void UsageFault_Handler(void)
-{
-  /* USER CODE BEGIN UsageFault_IRQn 0 */
-
-  /* USER CODE END UsageFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_UsageFault_IRQn 0 */
-    /* USER CODE END W1_UsageFault_IRQn 0 */
-  }
-}
-
 /**
   * @brief This function handles System service call via SWI instruction.
   */
@@ -200,19 +159,191 @@ void DebugMon_Handler(void)
 /******************************************************************************/
 
 /**
-  * @brief This function handles TIM7 global interrupt.
+  * @brief This function handles DMA1 stream6 global interrupt.
   */
-void TIM7_IRQHandler(void)
+void DMA1_Stream6_IRQHandler(void)
+{
+  /* USER CODE BEGIN DMA1_Stream6_IRQn 0 */
+
+  /* USER CODE END DMA1_Stream6_IRQn 0 */
+  vLogDmaIRQHandler();
+  /* USER CODE BEGIN DMA1_Stream6_IRQn 1 */
+
+  /* USER CODE END DMA1_Stream6_IRQn 1 */
+}
+
+/**
+  * @brief This function handles USART2 global interrupt.
+  */
+void USART2_IRQHandler(void)
 {
-  /* USER CODE BEGIN TIM7_IRQn 0 */
+  /* USER CODE BEGIN USART2_IRQn 0 */
 
-  /* USER CODE END TIM7_IRQn 0 */
-  HAL_TIM_IRQHandler(&htim7);
-  /* USER CODE BEGIN TIM7_IRQn 1 */
+  /* USER CODE END USART2_IRQn 0 */
+  HAL_UART_IRQHandler(&huart2);
+  /* USER CODE BEGIN USART2_IRQn 1 */
 
-  /* USER CODE END TIM7_IRQn 1 */
+  /* USER CODE END USART2_IRQn 1 */
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles TIM5 global interrupt, the time base, see
+  *        timebase.h.  Lab4.ioc leaves the HAL time base on SysTick, so the
+  *        generator makes neither this handler nor a HAL_InitTick() of its
+  *        own.
+  */
+void TIM5_IRQHandler(void)
+{
+  vTimebaseIRQHandler();
+}
+
+#if (configUSE_TICKLESS_IDLE == 2)
+/**
+  * @brief This function handles RTC wake-up interrupt through EXTI line 22.
+  */
+void RTC_WKUP_IRQHandler(void)
+{
+  vLowPowerWakeupIRQHandler();
+}
+#endif
+
+/**
+  * @brief This function handles DMA1 stream5 global interrupt, USART2 RX.
+  */
+void DMA1_Stream5_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_usart2_rx);
+}
+
+/**
+  * @brief This function handles DMA1 stream0 global interrupt, TIM4_CH1 for
+  *        the LED patterns.
+  */
+void DMA1_Stream0_IRQHandler(void)
+{
+  vLedDmaIRQHandler();
+}
+
+/**
+  * @brief This function handles EXTI line0 interrupt, the user button.
+  */
+void EXTI0_IRQHandler(void)
+{
+  vButtonExtiIRQHandler();
+}
+
+/**
+  * @brief This function handles EXTI line1 interrupt, MEMS_INT2 from the
+  *        accelerometer.
+  */
+void EXTI1_IRQHandler(void)
+{
+  vAccelExtiIRQHandler();
+}
+
+/**
+  * @brief This function handles DMA2 stream0 global interrupt, SPI1 RX for
+  *        the accelerometer.
+  */
+void DMA2_Stream0_IRQHandler(void)
+{
+  vAccelDmaIRQHandler();
+}
+
+/**
+  * @brief This function handles DMA1 stream7 global interrupt, SPI3 TX for
+  *        the audio output.
+  */
+void DMA1_Stream7_IRQHandler(void)
+{
+  vAudioDmaIRQHandler();
+}
+
+/**
+  * @brief This function handles DMA1 stream3 global interrupt, SPI2 RX for
+  *        the PDM microphone.
+  */
+void DMA1_Stream3_IRQHandler(void)
+{
+  vMicDmaIRQHandler();
+}
+
+/**
+  * @brief This function handles DMA2 stream1 global interrupt, memory to
+  *        memory copies.
+  */
+void DMA2_Stream1_IRQHandler(void)
+{
+  vDmaCopyIRQHandler();
+}
+
+/**
+  * @brief This function handles DMA2 stream2 global interrupt, CRC unit
+  *        feeds.
+  */
+void DMA2_Stream2_IRQHandler(void)
+{
+  vCrcDmaIRQHandler();
+}
+
+/**
+  * @brief This function handles USB On The Go FS global interrupt, the CDC
+  *        telemetry port.
+  */
+void OTG_FS_IRQHandler(void)
+{
+  vUsbCdcIRQHandler();
+}
+
+/**
+  * @brief This function handles USB On The Go FS wakeup through EXTI line 18.
+  */
+void OTG_FS_WKUP_IRQHandler(void)
+{
+  vUsbCdcWakeupIRQHandler();
+}
+
+#if (irqlatENABLE == 1)
+/**
+  * @brief This function handles TIM6 global interrupt, the interrupt latency
+  *        test timer.
+  */
+void TIM6_DAC_IRQHandler(void)
+{
+  vIrqLatIRQHandler();
+}
+#endif
+
+#if (profilerENABLE == 1)
+/**
+  * @brief This function handles TIM2 global interrupt, the profiler's sample
+  *        clock.  Naked, so the frame of the interrupted code is found from
+  *        EXC_RETURN before anything else is pushed.
+  */
+__attribute__((naked)) void TIM2_IRQHandler(void)
+{
+  __asm volatile
+  (
+    "   tst lr, #4            \n"
+    "   ite eq                \n"
+    "   mrseq r0, msp         \n"
+    "   mrsne r0, psp         \n"
+    "   mov r1, lr            \n"
+    "   b vProfilerSample     \n"
+  );
+}
+#endif
+
+#if (kernbenchENABLE == 1)
+/**
+  * @brief This function handles TIM7 global interrupt, pended from software
+  *        by the kernel benchmark.
+  */
+void TIM7_IRQHandler(void)
+{
+  vKernBenchIRQHandler();
+}
+#endif
 
 /* USER CODE END 1 */
@@ -35,15 +35,16 @@ static uint8_t *__sbrk_heap_end = NULL;
  *
  * @verbatim
  * ############################################################################
- * #  .data  #  .bss  #       newlib heap       #          MSP stack          #
- * #         #        #                         # Reserved by _Min_Stack_Size #
+ * #  .data  #  .bss  #  newlib heap  #   FreeRTOS heap    #    MSP stack     #
+ * #         #        #               #                    # _Min_Stack_Size  #
  * ############################################################################
- * ^-- RAM start      ^-- _end                             _estack, RAM end --^
+ * ^-- RAM start      ^-- _end        ^-- __heap_sram_start  _estack, RAM end --^
  * @endverbatim
  *
  * This implementation starts allocating at the '_end' linker symbol
- * The '_Min_Stack_Size' linker symbol reserves a memory for the MSP stack
- * The implementation considers '_estack' linker symbol to be RAM end
+ * The '_Min_Heap_Size' linker symbol reserves the memory it may use, up to the
+ * '__heap_sram_start' linker symbol, where the FreeRTOS heap begins.  With
+ * malloc() on the FreeRTOS heap, see newlibheap.c, that is nothing at all
  * NOTE: If the MSP stack, at any point during execution, grows larger than the
  * reserved size, please increase the '_Min_Stack_Size'.
  *
@@ -53,10 +54,8 @@ static uint8_t *__sbrk_heap_end = NULL;
 void *_sbrk(ptrdiff_t incr)
 {
   extern uint8_t _end; /* Symbol defined in the linker script */
-  extern uint8_t _estack; /* Symbol defined in the linker script */
-  extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
-  const uint32_t stack_limit = (uint32_t)&_estack - (uint32_t)&_Min_Stack_Size;
-  const uint8_t *max_heap = (uint8_t *)stack_limit;
+  extern uint8_t __heap_sram_start; /* Symbol defined in the linker script */
+  const uint8_t *max_heap = &__heap_sram_start;
   uint8_t *prev_heap_end;
 
   /* Initialize heap end at first call */
@@ -65,7 +64,7 @@ void *_sbrk(ptrdiff_t incr)
     __sbrk_heap_end = &_end;
   }
 
-  /* Protect heap from growing into the reserved MSP stack */
+  /* Protect the FreeRTOS heap, and the MSP stack beyond it */
   if (__sbrk_heap_end + incr > max_heap)
   {
     errno = ENOMEM;
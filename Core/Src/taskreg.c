@@ -0,0 +1,120 @@
+/**
+  ******************************************************************************
+  * @file           : taskreg.c
+  * @brief          : Creates the tasks declared with TASK_REGISTER() and
+  *                   supplies the kernel's own tasks with static memory.
+  ******************************************************************************
+  * Every descriptor sits in .task_registry, which the linker script brackets
+  * with __task_registry_start and __task_registry_end, so tasks can be
+  * declared in any module without a central list.  Together with the static
+  * idle and timer task memory below, the system boots without a single
+  * pvPortMalloc() call and its task RAM can be budgeted from the .map file.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "taskreg.h"
+#include "tasktable.h"
+
+/* Private define ------------------------------------------------------------*/
+#define taskregSTRINGIFY(x)         #x
+#define taskregEXPAND(x)            taskregSTRINGIFY(x)
+
+/* CCM is 64 KB and heap_regions.c takes configCCM_HEAP_SIZE of it. */
+#if (configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_REGIONS)
+_Static_assert((tasktableCCM_BUDGET_BYTES + configCCM_HEAP_SIZE) <= (64U * 1024U),
+               "tasktableCCM_BUDGET_BYTES and configCCM_HEAP_SIZE overcommit CCM");
+#endif
+
+/* Budgets as absolute symbols for the ASSERT()s in the linker script. */
+__asm(".global __task_sram_budget\n\t"
+      ".set __task_sram_budget, " taskregEXPAND(tasktableSRAM_BUDGET_BYTES) "\n\t"
+      ".global __task_ccm_budget\n\t"
+      ".set __task_ccm_budget, " taskregEXPAND(tasktableCCM_BUDGET_BYTES));
+
+/* External variables --------------------------------------------------------*/
+extern const TaskRegistryEntry_t __task_registry_start[];
+extern const TaskRegistryEntry_t __task_registry_end[];
+
+/* Private variables ---------------------------------------------------------*/
+
+/* The kernel's own tasks run often and never hand their stacks to DMA, so
+   they sit in CCM and count against tasktableCCM_BUDGET_BYTES. */
+static StaticTask_t xIdleTaskTCB taskregSECTION_CCM;
+static StackType_t uxIdleTaskStack[configMINIMAL_STACK_SIZE + taskregGUARD_WORDS] taskregSECTION_CCM taskregSTACK_ALIGNED;
+
+#if (configUSE_TIMERS == 1)
+static StaticTask_t xTimerTaskTCB taskregSECTION_CCM;
+static StackType_t uxTimerTaskStack[configTIMER_TASK_STACK_DEPTH + taskregGUARD_WORDS] taskregSECTION_CCM taskregSTACK_ALIGNED;
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Create every registered task.
+  * @note   Call once, before vTaskStartScheduler().  Creation from static
+  *         memory cannot fail, so a NULL handle means a bad descriptor.
+  * @retval None
+  */
+void vTaskRegistryStart(void)
+{
+  const TaskRegistryEntry_t *pxEntry;
+
+  for (pxEntry = __task_registry_start; pxEntry < __task_registry_end; pxEntry++)
+  {
+    *pxEntry->pxHandle = xTaskCreateStatic(pxEntry->pxEntry, pxEntry->pcName, pxEntry->ulStackDepth,
+                                           pxEntry->pvParameters, pxEntry->uxPriority, pxEntry->puxStack,
+                                           pxEntry->pxTCB);
+    configASSERT(*pxEntry->pxHandle != NULL);
+  }
+}
+
+/**
+  * @brief  Number of registered tasks.
+  * @retval Count of descriptors in .task_registry.
+  */
+UBaseType_t uxTaskRegistryCount(void)
+{
+  return (UBaseType_t) (__task_registry_end - __task_registry_start);
+}
+
+/**
+  * @brief  Descriptor of one registered task, in link order.
+  * @param  uxIndex 0 to uxTaskRegistryCount() - 1.
+  * @retval The descriptor, or NULL if uxIndex is out of range.
+  */
+const TaskRegistryEntry_t *pxTaskRegistryGet(UBaseType_t uxIndex)
+{
+  if (uxIndex >= uxTaskRegistryCount())
+  {
+    return NULL;
+  }
+
+  return &__task_registry_start[uxIndex];
+}
+
+/**
+  * @brief  Memory for the idle task, requested by vTaskStartScheduler().
+  * @retval None
+  */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+  *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+  *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+  *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE + taskregGUARD_WORDS;
+}
+
+#if (configUSE_TIMERS == 1)
+/**
+  * @brief  Memory for the timer service task, requested by xTimerCreateTimerTask().
+  * @retval None
+  */
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+  *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+  *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+  *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH + taskregGUARD_WORDS;
+}
+#endif /* configUSE_TIMERS */
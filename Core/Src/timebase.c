@@ -0,0 +1,513 @@
+/**
+  ******************************************************************************
+  * @file           : timebase.c
+  * @brief          : HAL tick, kernel tick, microsecond clock and one-shot
+  *                   events from the single 32-bit TIM5 counter.
+  ******************************************************************************
+  * Replaces the TIM7 HAL time base and SysTick.  The counter is never stopped
+  * or reset once HAL_InitTick() has started it, so the tick is a compare
+  * match that is moved on by one period each time it fires rather than a
+  * reload, and reprogramming the prescaler for a new clock keeps the count.
+  * A tick whose interrupt is held off past the next one is lost, as it would
+  * be with SysTick; the channel then resynchronises to the counter.
+  *
+  * One-shot events wait on a list sorted by due time, with channel 2 armed
+  * for the head.  Callbacks run in the TIM5 interrupt, so once the scheduler
+  * has started they may use the FromISR API.  vTaskDelayUs() and
+  * xTaskNotifyAtUs() are built on them, and wake only the task concerned
+  * rather than needing a faster tick.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timebase.h"
+#include "irqtable.h"
+
+/* Private function prototypes -----------------------------------------------*/
+extern void xPortSysTickHandler(void);
+static void prvArmEvents(void);
+static void prvUnlinkEvent(TimebaseEvent_t *pxEvent);
+static void prvWakeTask(void *pvParameter);
+static void prvNotifyTask(void *pvParameter);
+
+/* Private variables ---------------------------------------------------------*/
+static volatile uint32_t ulKernelTickStarted = 0U;
+static TimebaseEvent_t *pxEvents = NULL;
+
+/* Private macro -------------------------------------------------------------*/
+
+/* The handler may run at priority 0 before the scheduler starts, above
+   anything BASEPRI can mask, so the shared state is guarded with PRIMASK. */
+#define timebaseENTER()             uint32_t ulPrimask = __get_PRIMASK(); __disable_irq()
+#define timebaseEXIT()              __set_PRIMASK(ulPrimask)
+
+/* Wrap safe "a is at or before b" on the counter. */
+#define timebaseNOT_AFTER(a, b)     ((int32_t) ((a) - (b)) <= 0)
+
+/* Below this a task delay spins, as blocking and being switched back in
+   would take about as long at 25 MHz. */
+#define timebaseSPIN_US             20U
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Start TIM5 as the time base, or adapt its prescaler to a new clock.
+  * @note   Called by HAL_Init() and again by HAL_RCC_ClockConfig().  The
+  *         counter carries on across the second call.
+  * @param  TickPriority Tick interrupt priority until the scheduler starts.
+  * @retval HAL status
+  */
+HAL_StatusTypeDef HAL_InitTick(uint32_t TickPriority)
+{
+  RCC_ClkInitTypeDef clkconfig;
+  uint32_t uwTimclock;
+  uint32_t pFLatency;
+  uint32_t ulCount;
+
+  if (TickPriority >= (1UL << __NVIC_PRIO_BITS))
+  {
+    return HAL_ERROR;
+  }
+
+  __HAL_RCC_TIM5_CLK_ENABLE();
+
+  /* APB1 timers run at twice PCLK1 whenever APB1 is divided. */
+  HAL_RCC_GetClockConfig(&clkconfig, &pFLatency);
+  if (clkconfig.APB1CLKDivider == RCC_HCLK_DIV1)
+  {
+    uwTimclock = HAL_RCC_GetPCLK1Freq();
+  }
+  else
+  {
+    uwTimclock = 2UL * HAL_RCC_GetPCLK1Freq();
+  }
+
+  /* The new prescaler only loads on an update event, which also clears the
+     counter, so put the count back straight after it. */
+  ulCount = TIM5->CNT;
+  TIM5->PSC = (uwTimclock / timebaseCOUNTER_HZ) - 1U;
+  TIM5->EGR = TIM_EGR_UG;
+  TIM5->CNT = ulCount;
+
+  if ((TIM5->CR1 & TIM_CR1_CEN) == 0U)
+  {
+    /* First call: free run over the full 32 bits, first tick one period on,
+       compare channels frozen so they only raise their flags. */
+    TIM5->ARR = 0xFFFFFFFFUL;
+    TIM5->CCMR1 = 0U;
+    TIM5->CCR1 = TIM5->CNT + timebaseTICK_PERIOD_US;
+    TIM5->SR = 0U;
+    TIM5->DIER = TIM_DIER_CC1IE;
+    TIM5->CR1 = TIM_CR1_CEN;
+  }
+
+  /* Once the kernel owns the tick it stays at the kernel priority. */
+  if (ulKernelTickStarted == 0U)
+  {
+    HAL_NVIC_SetPriority(TIM5_IRQn, TickPriority, 0U);
+    uwTickPrio = TickPriority;
+  }
+  HAL_NVIC_EnableIRQ(TIM5_IRQn);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Stop raising HAL and kernel ticks.  The counter keeps running.
+  * @retval None
+  */
+void HAL_SuspendTick(void)
+{
+  timebaseENTER();
+  TIM5->DIER &= ~TIM_DIER_CC1IE;
+  timebaseEXIT();
+}
+
+/**
+  * @brief  Raise HAL and kernel ticks again.
+  * @retval None
+  */
+void HAL_ResumeTick(void)
+{
+  timebaseENTER();
+  TIM5->DIER |= TIM_DIER_CC1IE;
+  timebaseEXIT();
+}
+
+/**
+  * @brief  Hand the tick to the kernel.  Replaces the port's SysTick set up,
+  *         and is called by xPortStartScheduler() with interrupts masked.
+  * @note   SysTick is left off.  The kernel tick handler expects to run at the
+  *         lowest priority, so TIM5 moves to its row in irqtable.h, which
+  *         keeps it there, and the HAL tick with it.
+  * @retval None
+  */
+void vPortSetupTimerInterrupt(void)
+{
+  irqtableREQUIRE_KERNEL(TIM5);
+  uwTickPrio = irqtablePRIORITY(TIM5);
+  HAL_NVIC_SetPriority(TIM5_IRQn, uwTickPrio, 0U);
+  ulKernelTickStarted = 1U;
+}
+
+/**
+  * @brief  TIM5 interrupt body, called from TIM5_IRQHandler().
+  * @retval None
+  */
+void vTimebaseIRQHandler(void)
+{
+  uint32_t ulStatus = TIM5->SR & TIM5->DIER;
+
+  if ((ulStatus & TIM_SR_CC1IF) != 0U)
+  {
+    /* Flags are cleared by writing zero. */
+    TIM5->SR = (uint32_t) ~TIM_SR_CC1IF;
+
+    TIM5->CCR1 += timebaseTICK_PERIOD_US;
+    if (timebaseNOT_AFTER(TIM5->CCR1, TIM5->CNT))
+    {
+      TIM5->CCR1 = TIM5->CNT + timebaseTICK_PERIOD_US;
+    }
+
+    HAL_IncTick();
+    if (ulKernelTickStarted != 0U)
+    {
+      xPortSysTickHandler();
+    }
+  }
+
+  if ((ulStatus & TIM_SR_CC2IF) != 0U)
+  {
+    TimebaseEvent_t *pxDue;
+
+    TIM5->SR = (uint32_t) ~TIM_SR_CC2IF;
+
+    for (;;)
+    {
+      timebaseENTER();
+      pxDue = pxEvents;
+      if ((pxDue != NULL) && timebaseNOT_AFTER(pxDue->ulDueUs, TIM5->CNT))
+      {
+        pxEvents = pxDue->pxNext;
+        pxDue->ulPending = 0U;
+      }
+      else
+      {
+        pxDue = NULL;
+        prvArmEvents();
+      }
+      timebaseEXIT();
+
+      if (pxDue == NULL)
+      {
+        break;
+      }
+
+      /* Outside the guarded section, so the callback may start it again. */
+      pxDue->pxCallback(pxDue->pvParameter);
+    }
+  }
+}
+
+/**
+  * @brief  How far the counter is into the current tick period.
+  * @retval Microseconds since the last tick was due.
+  */
+uint32_t ulTimebaseUsIntoTick(void)
+{
+  return TIM5->CNT - (TIM5->CCR1 - timebaseTICK_PERIOD_US);
+}
+
+/**
+  * @brief  Whether a tick is due but has not been handled, for example
+  *         because ticks are suspended.
+  * @retval pdTRUE or pdFALSE.
+  */
+BaseType_t xTimebaseTickPending(void)
+{
+  return ((TIM5->SR & TIM_SR_CC1IF) != 0U) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  Bring the counter and the tick back into line after STOP mode, with
+  *         ticks still suspended.
+  * @param  ulCountAtStop   ulTimebaseNowUs() just before the sleep was timed.
+  * @param  ulSleptUs       Time that passed from then, measured on the RTC.
+  * @param  ulTicksToStep   Whole ticks the caller is stepping the kernel by.
+  * @retval None
+  */
+void vTimebaseResumeAfterSleep(uint32_t ulCountAtStop, uint32_t ulSleptUs, uint32_t ulTicksToStep)
+{
+  uint32_t ulCounted;
+
+  /* The counter only missed the time it was actually stopped. */
+  ulCounted = TIM5->CNT - ulCountAtStop;
+  if (ulSleptUs > ulCounted)
+  {
+    TIM5->CNT += ulSleptUs - ulCounted;
+  }
+
+  /* Any match while suspended is covered by ulTicksToStep. */
+  TIM5->SR = (uint32_t) ~TIM_SR_CC1IF;
+  TIM5->CCR1 += ulTicksToStep * timebaseTICK_PERIOD_US;
+
+  /* When the caller has held ticks back the next one is already late. */
+  if (timebaseNOT_AFTER(TIM5->CCR1, TIM5->CNT))
+  {
+    TIM5->CCR1 = TIM5->CNT;
+    TIM5->EGR = TIM_EGR_CC1G;
+  }
+
+  /* Overdue events fire as soon as interrupts are enabled again. */
+  timebaseENTER();
+  prvArmEvents();
+  timebaseEXIT();
+}
+
+/**
+  * @brief  Call pxCallback from the TIM5 interrupt ulDelayUs from now.  An
+  *         event that is already pending is moved to the new time.
+  * @param  pxEvent     Event storage, kept alive by the caller while pending.
+  * @param  ulDelayUs   Delay, less than 2^31 microseconds.
+  * @param  pxCallback  Called once, from the interrupt.
+  * @param  pvParameter Passed to pxCallback.
+  * @retval None
+  */
+void vTimebaseEventStart(TimebaseEvent_t *pxEvent, uint32_t ulDelayUs,
+                         TimebaseCallback_t pxCallback, void *pvParameter)
+{
+  vTimebaseEventStartAt(pxEvent, ulTimebaseNowUs() + ulDelayUs, pxCallback, pvParameter);
+}
+
+/**
+  * @brief  As vTimebaseEventStart(), but at an absolute counter value.
+  * @param  pxEvent     Event storage, kept alive by the caller while pending.
+  * @param  ulDueUs     ulTimebaseNowUs() value to fire at, less than 2^31
+  *                     microseconds ahead.  A time already passed fires at
+  *                     once.
+  * @param  pxCallback  Called once, from the interrupt.
+  * @param  pvParameter Passed to pxCallback.
+  * @retval None
+  */
+void vTimebaseEventStartAt(TimebaseEvent_t *pxEvent, uint32_t ulDueUs,
+                           TimebaseCallback_t pxCallback, void *pvParameter)
+{
+  TimebaseEvent_t **ppxLink;
+
+  configASSERT(pxEvent != NULL);
+  configASSERT(pxCallback != NULL);
+
+  timebaseENTER();
+
+  if (pxEvent->ulPending != 0U)
+  {
+    prvUnlinkEvent(pxEvent);
+  }
+
+  pxEvent->ulDueUs = ulDueUs;
+  pxEvent->pxCallback = pxCallback;
+  pxEvent->pvParameter = pvParameter;
+  pxEvent->ulPending = 1U;
+
+  /* Events due at the same time fire in the order they were started. */
+  for (ppxLink = &pxEvents; (*ppxLink != NULL) && timebaseNOT_AFTER((*ppxLink)->ulDueUs, pxEvent->ulDueUs);
+       ppxLink = &((*ppxLink)->pxNext))
+  {
+  }
+  pxEvent->pxNext = *ppxLink;
+  *ppxLink = pxEvent;
+
+  if (pxEvents == pxEvent)
+  {
+    prvArmEvents();
+  }
+
+  timebaseEXIT();
+}
+
+/**
+  * @brief  Cancel a pending event.
+  * @param  pxEvent Event passed to vTimebaseEventStart().
+  * @retval pdTRUE if it was pending, pdFALSE if it had fired or was never
+  *         started.
+  */
+BaseType_t xTimebaseEventStop(TimebaseEvent_t *pxEvent)
+{
+  BaseType_t xReturn = pdFALSE;
+
+  configASSERT(pxEvent != NULL);
+
+  timebaseENTER();
+  if (pxEvent->ulPending != 0U)
+  {
+    prvUnlinkEvent(pxEvent);
+    prvArmEvents();
+    xReturn = pdTRUE;
+  }
+  timebaseEXIT();
+
+  return xReturn;
+}
+
+/**
+  * @brief  Whether any event is pending.  STOP mode would hold it up, so
+  *         tickless idle checks this first.
+  * @retval pdTRUE or pdFALSE.
+  */
+BaseType_t xTimebaseEventsPending(void)
+{
+  return (pxEvents != NULL) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  Block the calling task for ulDelayUs microseconds.
+  * @note   Whole ticks are slept with vTaskDelay(), the rest on a one-shot
+  *         event that wakes this task alone, so the wakeup is not rounded to a
+  *         tick.  Delays too short to be worth a context switch, and any delay
+  *         before the scheduler starts, spin on the counter instead.
+  * @param  ulDelayUs Delay, less than 2^31 microseconds.
+  * @retval None
+  */
+void vTaskDelayUs(uint32_t ulDelayUs)
+{
+  TimebaseEvent_t xEvent;
+  uint32_t ulDueUs = ulTimebaseNowUs() + ulDelayUs;
+  uint32_t ulLeft;
+
+  if ((ulDelayUs <= timebaseSPIN_US) || (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING))
+  {
+    while (!timebaseNOT_AFTER(ulDueUs, ulTimebaseNowUs()))
+    {
+    }
+    return;
+  }
+
+  /* vTaskDelay(n) returns between n - 1 and n periods later, so stop one
+     tick short and leave the rest to the event. */
+  if (ulDelayUs >= (2U * timebaseTICK_PERIOD_US))
+  {
+    vTaskDelay((TickType_t) ((ulDelayUs / timebaseTICK_PERIOD_US) - 1U));
+  }
+
+  ulLeft = ulDueUs - ulTimebaseNowUs();
+  if (((int32_t) ulLeft <= 0) || (ulLeft <= timebaseSPIN_US))
+  {
+    while (!timebaseNOT_AFTER(ulDueUs, ulTimebaseNowUs()))
+    {
+    }
+    return;
+  }
+
+  /* eNoAction leaves the notification value to whoever else uses it; a
+     notification that was already pending just costs one more pass. */
+  xEvent.ulPending = 0U;
+  vTimebaseEventStartAt(&xEvent, ulDueUs, prvWakeTask, xTaskGetCurrentTaskHandle());
+  while (xEvent.ulPending != 0U)
+  {
+    (void) xTaskNotifyWait(0U, 0U, NULL, portMAX_DELAY);
+  }
+}
+
+/**
+  * @brief  Notify xTask from the TIM5 interrupt when the counter reaches
+  *         ulDueUs, as xTaskNotifyFromISR() would.
+  * @param  pxNotify Storage, kept alive by the caller until it has fired.  A
+  *                  pending one is moved to the new time.
+  * @param  xTask    Task to notify.
+  * @param  ulDueUs  ulTimebaseNowUs() value to notify at, less than 2^31
+  *                  microseconds ahead.
+  * @param  ulValue  Notification value, used as eAction says.
+  * @param  eAction  As for xTaskNotify().
+  * @retval pdPASS, or pdFAIL if ulDueUs has already passed, in which case the
+  *         notification is sent at once.
+  */
+BaseType_t xTaskNotifyAtUs(TimebaseNotify_t *pxNotify, TaskHandle_t xTask, uint32_t ulDueUs,
+                           uint32_t ulValue, eNotifyAction eAction)
+{
+  configASSERT(pxNotify != NULL);
+  configASSERT(xTask != NULL);
+
+  /* Fields are not read by the interrupt until the event is started. */
+  (void) xTimebaseEventStop(&(pxNotify->xEvent));
+  pxNotify->xTask = xTask;
+  pxNotify->ulValue = ulValue;
+  pxNotify->eAction = eAction;
+
+  vTimebaseEventStartAt(&(pxNotify->xEvent), ulDueUs, prvNotifyTask, pxNotify);
+
+  return timebaseNOT_AFTER(ulDueUs, ulTimebaseNowUs()) ? pdFAIL : pdPASS;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Point channel 2 at the first pending event, or turn it off.
+  * @note   Called with PRIMASK set.
+  * @retval None
+  */
+static void prvArmEvents(void)
+{
+  if (pxEvents == NULL)
+  {
+    TIM5->DIER &= ~TIM_DIER_CC2IE;
+    return;
+  }
+
+  TIM5->CCR2 = pxEvents->ulDueUs;
+  TIM5->SR = (uint32_t) ~TIM_SR_CC2IF;
+  TIM5->DIER |= TIM_DIER_CC2IE;
+
+  /* A time the counter has already passed would not match again until it
+     wraps, so raise the event by hand. */
+  if (timebaseNOT_AFTER(pxEvents->ulDueUs, TIM5->CNT))
+  {
+    TIM5->EGR = TIM_EGR_CC2G;
+  }
+}
+
+/**
+  * @brief  Event callback of vTaskDelayUs().
+  * @param  pvParameter Handle of the delayed task.
+  * @retval None
+  */
+static void prvWakeTask(void *pvParameter)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  (void) xTaskNotifyFromISR((TaskHandle_t) pvParameter, 0U, eNoAction, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  Event callback of xTaskNotifyAtUs().
+  * @param  pvParameter The TimebaseNotify_t.
+  * @retval None
+  */
+static void prvNotifyTask(void *pvParameter)
+{
+  TimebaseNotify_t *pxNotify = (TimebaseNotify_t *) pvParameter;
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  (void) xTaskNotifyFromISR(pxNotify->xTask, pxNotify->ulValue, pxNotify->eAction, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  Take a pending event off the list.
+  * @note   Called with PRIMASK set.
+  * @param  pxEvent Pending event.
+  * @retval None
+  */
+static void prvUnlinkEvent(TimebaseEvent_t *pxEvent)
+{
+  TimebaseEvent_t **ppxLink;
+
+  for (ppxLink = &pxEvents; *ppxLink != pxEvent; ppxLink = &((*ppxLink)->pxNext))
+  {
+    configASSERT(*ppxLink != NULL);
+  }
+  *ppxLink = pxEvent->pxNext;
+  pxEvent->ulPending = 0U;
+}
@@ -0,0 +1,446 @@
+/**
+  ******************************************************************************
+  * @file           : trace.c
+  * @brief          : Lock-free binary trace ring and its drain task.
+  ******************************************************************************
+  * Producers reserve a slot by advancing the head index with LDREX/STREX, so
+  * they never mask interrupts and may run from any context, including from
+  * within vTaskSuspendAll() in the heap.  A full ring drops the new record and
+  * counts it rather than blocking the caller.  The single consumer is a low
+  * priority task that sends the records through the log sink, several to a
+  * frame.  A record leaves the ring only once the sink has taken its frame,
+  * so a busy log holds records back, and the ring drops the newest, rather
+  * than losing a frame half way.
+  *
+  * Alongside the records the drain task sends what the host needs to read
+  * them: the name of each task the first time a record mentions it, the name
+  * a queue is registered with, SystemCoreClock whenever it changes (the
+  * timestamps are core cycles), and the drop count whenever it grows.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "trace.h"
+#include "dwt.h"
+#include "log.h"
+#include "fmt.h"
+#include "taskreg.h"
+#include "queue.h"
+
+#if (configUSE_TRACE_RECORDER == 1)
+
+#if ((traceRING_LENGTH & (traceRING_LENGTH - 1U)) != 0U)
+#error traceRING_LENGTH must be a power of two
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+/* Slots are written before they are read, so the startup code need not clear
+   them. */
+static TraceRecord_t xTraceRing[traceRING_LENGTH] __attribute__((section(".noinit")));
+
+/* Free running indexes; the slot is the index modulo traceRING_LENGTH. */
+static volatile uint32_t ulTraceHead = 0U;
+static volatile uint32_t ulTraceTail = 0U;
+static volatile uint32_t ulTraceDropped = 0U;
+
+/* Cleared by vTraceStop(); records are let through only while set. */
+static volatile uint32_t ulTraceEnabled = traceSTART_ENABLED;
+
+#if (traceBINARY == 1)
+/* Only the drain task touches these. */
+static uint8_t ucTraceFrame[2U + (traceFRAME_RECORDS * sizeof(TraceRecord_t))];
+static uint8_t ucTraceName[2U + sizeof(uint32_t) + configMAX_TASK_NAME_LEN];
+static uint32_t ulTraceNamed[traceNAME_CACHE];
+static uint32_t ulTraceNextNamed = 0U;
+static uint32_t ulTraceReportedDropped = 0U;
+static uint32_t ulTraceReportedClock = 0U;
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvTraceDrainTask(void *pvParameters);
+#if (traceBINARY == 1)
+static BaseType_t prvSendFrame(void);
+static void prvSendRecord(uint8_t ucEvent, uint32_t ulArg0);
+static void prvSendName(uint32_t ulObject, const char *pcName);
+static void prvNameObject(const TraceRecord_t *pxRecord);
+#else
+static size_t prvFormatRecord(const TraceRecord_t *pxRecord, char *pcBuffer, size_t xBufferLength);
+#endif
+
+/* Registered tasks ----------------------------------------------------------*/
+TASK_REGISTER(TRACE, prvTraceDrainTask, NULL, 128, tskIDLE_PRIORITY);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Enable the timestamp source.
+  * @note   Call before the first task is created so that any allocation made
+  *         at start up is timestamped.  The drain task is declared with
+  *         TASK_REGISTER() and started by vTaskRegistryStart().
+  * @retval None
+  */
+void vTraceInit(void)
+{
+  uint32_t ulIndex;
+
+  vDwtInit();
+
+  /* The ring is not cleared at reset, and the drain task takes a non-zero
+     event as a finished record, so clear the slots not yet claimed. */
+  for (ulIndex = ulTraceHead; ulIndex < traceRING_LENGTH; ulIndex++)
+  {
+    xTraceRing[ulIndex].ucEvent = 0U;
+  }
+}
+
+/**
+  * @brief  Append one record to the ring.
+  * @param  ucEvent One of the traceEVT_* codes.
+  * @param  ulArg0  First event argument.
+  * @param  usArg1  Second event argument.
+  * @retval None
+  */
+void vTraceRecord(uint8_t ucEvent, uint32_t ulArg0, uint16_t usArg1)
+{
+  uint32_t ulHead;
+  TraceRecord_t *pxRecord;
+
+  if (ulTraceEnabled == 0U)
+  {
+    return;
+  }
+
+  /* Claim a slot.  The exclusive monitor is cleared by any exception entry,
+     so an interrupting producer simply makes this one retry. */
+  do
+  {
+    ulHead = __LDREXW((volatile uint32_t *) &ulTraceHead);
+
+    if ((ulHead - ulTraceTail) >= traceRING_LENGTH)
+    {
+      __CLREX();
+      ulTraceDropped++;
+      return;
+    }
+  } while (__STREXW(ulHead + 1U, (volatile uint32_t *) &ulTraceHead) != 0U);
+
+  pxRecord = &xTraceRing[ulHead & (traceRING_LENGTH - 1U)];
+  pxRecord->ulTimestamp = ulDwtCycles();
+  pxRecord->ulArg0 = ulArg0;
+  pxRecord->usArg1 = usArg1;
+
+  /* Publish the record only once its payload is visible. */
+  __DMB();
+  pxRecord->ucEvent = ucEvent;
+}
+
+/**
+  * @brief  Let records into the ring again after vTraceStop().
+  * @note   The drain task names a task again only if it has forgotten it,
+  *         so a capture started here may miss names sent before.
+  * @retval None
+  */
+void vTraceStart(void)
+{
+  ulTraceEnabled = 1U;
+}
+
+/**
+  * @brief  Stop recording.  Records already in the ring are still sent.
+  * @retval None
+  */
+void vTraceStop(void)
+{
+  ulTraceEnabled = 0U;
+}
+
+/**
+  * @brief  Number of records lost because the ring was full.
+  * @retval Dropped record count since boot.
+  */
+uint32_t ulTraceGetDropped(void)
+{
+  return ulTraceDropped;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+#if (traceBINARY == 1)
+
+/**
+  * @brief  Send the oldest records in the ring as one frame.
+  * @retval pdTRUE if a full frame went, so more records may be waiting.
+  */
+static BaseType_t prvSendFrame(void)
+{
+  uint32_t ulTail = ulTraceTail;
+  uint32_t ulCount = 0U;
+  uint32_t ulIndex;
+  TraceRecord_t *pxSlot;
+
+  while ((ulCount < traceFRAME_RECORDS) && ((ulTail + ulCount) != ulTraceHead))
+  {
+    pxSlot = &xTraceRing[(ulTail + ulCount) & (traceRING_LENGTH - 1U)];
+
+    /* The slot is claimed but its producer has not finished with it yet. */
+    if (pxSlot->ucEvent == 0U)
+    {
+      break;
+    }
+
+    __DMB();
+    (void) memcpy(&ucTraceFrame[2U + (ulCount * sizeof(TraceRecord_t))], pxSlot, sizeof(TraceRecord_t));
+    ulCount++;
+  }
+
+  if (ulCount == 0U)
+  {
+    return pdFALSE;
+  }
+
+  ucTraceFrame[0] = traceSYNC_RECORDS;
+  ucTraceFrame[1] = (uint8_t) ulCount;
+
+  /* Leave the records where they are for the next pass if the log is full. */
+  if (xLogWrite(ucTraceFrame, 2U + (ulCount * sizeof(TraceRecord_t))) == 0U)
+  {
+    return pdFALSE;
+  }
+
+  for (ulIndex = 0U; ulIndex < ulCount; ulIndex++)
+  {
+    xTraceRing[(ulTail + ulIndex) & (traceRING_LENGTH - 1U)].ucEvent = 0U;
+  }
+  __DMB();
+  ulTraceTail = ulTail + ulCount;
+
+  for (ulIndex = 0U; ulIndex < ulCount; ulIndex++)
+  {
+    prvNameObject((const TraceRecord_t *) &ucTraceFrame[2U + (ulIndex * sizeof(TraceRecord_t))]);
+  }
+
+  return (ulCount == traceFRAME_RECORDS) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  Send a record the drain task makes itself, in a frame of its own.
+  * @retval None
+  */
+static void prvSendRecord(uint8_t ucEvent, uint32_t ulArg0)
+{
+  TraceRecord_t xRecord;
+
+  xRecord.ulTimestamp = ulDwtCycles();
+  xRecord.ulArg0 = ulArg0;
+  xRecord.usArg1 = 0U;
+  xRecord.ucEvent = ucEvent;
+  xRecord.ucReserved = 0U;
+
+  ucTraceFrame[0] = traceSYNC_RECORDS;
+  ucTraceFrame[1] = 1U;
+  (void) memcpy(&ucTraceFrame[2], &xRecord, sizeof(xRecord));
+  (void) xLogWrite(ucTraceFrame, 2U + sizeof(xRecord));
+}
+
+/**
+  * @brief  Send the name of a task or queue.
+  * @retval None
+  */
+static void prvSendName(uint32_t ulObject, const char *pcName)
+{
+  size_t xLength = strlen(pcName);
+
+  if (xLength > configMAX_TASK_NAME_LEN)
+  {
+    xLength = configMAX_TASK_NAME_LEN;
+  }
+
+  ucTraceName[0] = traceSYNC_NAME;
+  ucTraceName[1] = (uint8_t) xLength;
+  (void) memcpy(&ucTraceName[2], &ulObject, sizeof(ulObject));
+  (void) memcpy(&ucTraceName[2U + sizeof(ulObject)], pcName, xLength);
+  (void) xLogWrite(ucTraceName, 2U + sizeof(ulObject) + xLength);
+}
+
+/**
+  * @brief  Name the task or queue a record just sent mentions, if the host
+  *         has not been told it already.
+  * @note   A task is named from its TCB when its record is sent, so one
+  *         deleted in between may be named with whatever reused the memory;
+  *         the statically allocated tasks of this application never are.
+  * @retval None
+  */
+static void prvNameObject(const TraceRecord_t *pxRecord)
+{
+  uint32_t ulIndex;
+#if (configQUEUE_REGISTRY_SIZE > 0)
+  const char *pcName;
+#endif
+
+  switch (pxRecord->ucEvent)
+  {
+    case traceEVT_TASK_CREATE:
+    case traceEVT_TASK_SWITCHED_IN:
+    case traceEVT_TASK_READY:
+      for (ulIndex = 0U; ulIndex < traceNAME_CACHE; ulIndex++)
+      {
+        if (ulTraceNamed[ulIndex] == pxRecord->ulArg0)
+        {
+          return;
+        }
+      }
+
+      ulTraceNamed[ulTraceNextNamed] = pxRecord->ulArg0;
+      ulTraceNextNamed = (ulTraceNextNamed + 1U) % traceNAME_CACHE;
+      prvSendName(pxRecord->ulArg0, pcTaskGetName((TaskHandle_t) pxRecord->ulArg0));
+      break;
+
+    case traceEVT_TASK_DELETE_TCB:
+      for (ulIndex = 0U; ulIndex < traceNAME_CACHE; ulIndex++)
+      {
+        if (ulTraceNamed[ulIndex] == pxRecord->ulArg0)
+        {
+          ulTraceNamed[ulIndex] = 0U;
+        }
+      }
+      break;
+
+#if (configQUEUE_REGISTRY_SIZE > 0)
+    case traceEVT_QUEUE_REGISTRY_ADD:
+      pcName = pcQueueGetName((QueueHandle_t) pxRecord->ulArg0);
+      if (pcName != NULL)
+      {
+        prvSendName(pxRecord->ulArg0, pcName);
+      }
+      break;
+#endif
+
+    default:
+      break;
+  }
+}
+
+#else
+
+/**
+  * @brief  Turn one record into a line of text.
+  * @retval Length of the line written into pcBuffer.
+  */
+static size_t prvFormatRecord(const TraceRecord_t *pxRecord, char *pcBuffer, size_t xBufferLength)
+{
+  size_t xLength;
+
+  switch (pxRecord->ucEvent)
+  {
+    case traceEVT_MALLOC:
+      xLength = xFmtFormat(pcBuffer, xBufferLength, "[%10lu] pvReturn: 0x%08lx | BlockSize: %3u\n\r",
+                           (unsigned long) pxRecord->ulTimestamp, (unsigned long) pxRecord->ulArg0,
+                           (unsigned) pxRecord->usArg1);
+      break;
+
+    case traceEVT_FREE:
+      xLength = xFmtFormat(pcBuffer, xBufferLength, "[%10lu] vPortFree: 0x%08lx | BlockSize: %3u\n\r",
+                           (unsigned long) pxRecord->ulTimestamp, (unsigned long) pxRecord->ulArg0,
+                           (unsigned) pxRecord->usArg1);
+      break;
+
+    case traceEVT_TASK_CREATE:
+      xLength = xFmtFormat(pcBuffer, xBufferLength, "[%10lu] TaskCreate: 0x%08lx | Priority: %u\n\r",
+                           (unsigned long) pxRecord->ulTimestamp, (unsigned long) pxRecord->ulArg0,
+                           (unsigned) pxRecord->usArg1);
+      break;
+
+    case traceEVT_TASK_DELETE:
+      xLength = xFmtFormat(pcBuffer, xBufferLength, "[%10lu] TaskDelete: 0x%08lx | Priority: %u\n\r",
+                           (unsigned long) pxRecord->ulTimestamp, (unsigned long) pxRecord->ulArg0,
+                           (unsigned) pxRecord->usArg1);
+      break;
+
+    case traceEVT_TASK_DELETE_TCB:
+      xLength = xFmtFormat(pcBuffer, xBufferLength, "[%10lu] TaskFree:   0x%08lx | Priority: %u\n\r",
+                           (unsigned long) pxRecord->ulTimestamp, (unsigned long) pxRecord->ulArg0,
+                           (unsigned) pxRecord->usArg1);
+      break;
+
+    default:
+      xLength = xFmtFormat(pcBuffer, xBufferLength, "[%10lu] event %u: 0x%08lx %u\n\r",
+                           (unsigned long) pxRecord->ulTimestamp, (unsigned) pxRecord->ucEvent,
+                           (unsigned long) pxRecord->ulArg0, (unsigned) pxRecord->usArg1);
+      break;
+  }
+
+  return xLength;
+}
+
+#endif /* traceBINARY */
+
+/**
+  * @brief  Single consumer of the ring.
+  * @param  pvParameters Unused.
+  * @retval None
+  */
+static void prvTraceDrainTask(void *pvParameters)
+{
+#if (traceBINARY == 1)
+  (void) pvParameters;
+
+  for (;;)
+  {
+    if (SystemCoreClock != ulTraceReportedClock)
+    {
+      ulTraceReportedClock = SystemCoreClock;
+      prvSendRecord(traceEVT_CLOCK, ulTraceReportedClock);
+    }
+
+    if (ulTraceDropped != ulTraceReportedDropped)
+    {
+      ulTraceReportedDropped = ulTraceDropped;
+      prvSendRecord(traceEVT_DROPPED, ulTraceReportedDropped);
+    }
+
+    while (prvSendFrame() != pdFALSE)
+    {
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(traceDRAIN_PERIOD_MS));
+  }
+#else
+  TraceRecord_t xRecord;
+  TraceRecord_t *pxSlot;
+  char cLine[64];
+  size_t xLength;
+
+  (void) pvParameters;
+
+  for (;;)
+  {
+    while (ulTraceTail != ulTraceHead)
+    {
+      pxSlot = &xTraceRing[ulTraceTail & (traceRING_LENGTH - 1U)];
+
+      /* The slot is claimed but its producer has not finished with it yet. */
+      if (pxSlot->ucEvent == 0U)
+      {
+        break;
+      }
+
+      __DMB();
+      xRecord = *pxSlot;
+      pxSlot->ucEvent = 0U;
+      __DMB();
+      ulTraceTail++;
+
+      xLength = prvFormatRecord(&xRecord, cLine, sizeof(cLine));
+      xLogWrite(cLine, xLength);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(traceDRAIN_PERIOD_MS));
+  }
+#endif /* traceBINARY */
+}
+
+#endif /* configUSE_TRACE_RECORDER */
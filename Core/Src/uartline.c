@@ -0,0 +1,329 @@
+/**
+  ******************************************************************************
+  * @file           : uartline.c
+  * @brief          : USART2 line settings, see uartline.h.
+  ******************************************************************************
+  * With OVER8 set, BRR holds USARTDIV as a 12 bit mantissa over a 3 bit
+  * fraction, so PCLK1 / baud, rounded, is the divisor in eighths and the
+  * register is that number with the fraction moved down a bit.  The fastest
+  * rate is a divisor of 8, PCLK1 / 8.
+  *
+  * A new rate only goes in once the log has drained and the last byte has
+  * left the shift register, with the scheduler suspended in between as
+  * xClockProfileSet() does, so nothing is sent at a rate half one and half
+  * the other.  The rate set, its hold on the HSE and the confirmation are
+  * changed from the shell task and the timer task, and only ever with the
+  * scheduler suspended.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "uartline.h"
+#include "clockprofile.h"
+#include "log.h"
+
+/* Private define ------------------------------------------------------------*/
+
+/* Largest divisor in eighths: a mantissa of 0xFFF and a fraction of 7. */
+#define uartlineMAX_DIVISOR         ((0xFFFUL << 3) | 7UL)
+
+/* Private variables ---------------------------------------------------------*/
+extern UART_HandleTypeDef huart2;
+
+static uint32_t ulSetBaud = uartlineBAUD;
+static uint32_t ulActualBaud = 0U;
+/* The rate to go back to unless confirmed, 0 if none. */
+static uint32_t ulRevertBaud = 0U;
+static BaseType_t xHoldingHse = pdFALSE;
+
+static StaticTimer_t xConfirmTimerStruct;
+static TimerHandle_t xConfirmTimer = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+static BaseType_t prvDivisor(uint32_t ulPclk, uint32_t ulBaud, uint32_t *pulBrr, uint32_t *pulActual);
+static void prvApply(void);
+static void prvHoldHse(BaseType_t xHold);
+static void prvConfirmTimeout(TimerHandle_t xTimer);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Move USART2 to 8x oversampling, flow control if configured, and
+  *         uartlineBAUD.  Call once, straight after MX_USART2_UART_Init().
+  * @retval None
+  */
+void vUartLineInit(void)
+{
+  uint32_t ulBrr;
+  uint32_t ulActual;
+
+  huart2.Init.OverSampling = UART_OVERSAMPLING_8;
+#if (uartlineFLOW_CONTROL == 1)
+  huart2.Init.HwFlowCtl = UART_HWCONTROL_RTS_CTS;
+#endif
+  huart2.Init.BaudRate = uartlineBAUD;
+
+  /* The handle is READY, so this only rewrites the registers. */
+  if (HAL_UART_Init(&huart2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  vUartLineUpdateClock();
+
+  if (prvDivisor(ulClockProfileGetPclk1Hz(CLOCK_PROFILE_LOW_POWER), uartlineBAUD, &ulBrr, &ulActual) != pdPASS)
+  {
+    prvHoldHse(pdTRUE);
+  }
+
+  xConfirmTimer = xTimerCreateStatic("BAUD", pdMS_TO_TICKS(uartlineCONFIRM_MS), pdFALSE, NULL,
+                                     prvConfirmTimeout, &xConfirmTimerStruct);
+  configASSERT(xConfirmTimer != NULL);
+}
+
+/**
+  * @brief  Change the rate, once everything queued has gone out at the old
+  *         one.
+  * @param  ulBaud   New rate, which the HSE profiles must carry.
+  * @param  xConfirm pdTRUE to go back to the old rate unless
+  *                  vUartLineConfirm() is called within uartlineCONFIRM_MS.
+  * @note   Call from a task.  May switch to the balanced clock profile.
+  * @retval pdPASS, or pdFAIL if the rate is out of reach or the HSE profiles
+  *         could not be had, in which case the old rate stays.
+  */
+BaseType_t xUartLineSetBaud(uint32_t ulBaud, BaseType_t xConfirm)
+{
+  uint32_t ulPrevious;
+  uint32_t ulBrr;
+  uint32_t ulActual;
+  BaseType_t xNeedsHse;
+  BaseType_t xWasHolding;
+  BaseType_t xReturn = pdPASS;
+
+  if ((prvDivisor(ulClockProfileGetPclk1Hz(CLOCK_PROFILE_PERFORMANCE), ulBaud, &ulBrr, &ulActual) != pdPASS) ||
+      (prvDivisor(ulClockProfileGetPclk1Hz(CLOCK_PROFILE_BALANCED), ulBaud, &ulBrr, &ulActual) != pdPASS))
+  {
+    return pdFAIL;
+  }
+
+  xNeedsHse = (prvDivisor(ulClockProfileGetPclk1Hz(CLOCK_PROFILE_LOW_POWER), ulBaud, &ulBrr, &ulActual) != pdPASS)
+              ? pdTRUE : pdFALSE;
+
+  vTaskSuspendAll();
+  {
+    ulPrevious = ulSetBaud;
+    xWasHolding = xHoldingHse;
+    ulSetBaud = ulBaud;
+
+    if (xNeedsHse != pdFALSE)
+    {
+      prvHoldHse(pdTRUE);
+    }
+
+    if ((xNeedsHse != pdFALSE) && (eClockProfileGet() == CLOCK_PROFILE_LOW_POWER))
+    {
+      /* The switch drains the line and sets the new rate. */
+      if (xClockProfileSet(CLOCK_PROFILE_BALANCED) != pdPASS)
+      {
+        ulSetBaud = ulPrevious;
+        prvApply();
+        xReturn = pdFAIL;
+      }
+    }
+    else
+    {
+      prvApply();
+    }
+
+    if (xReturn == pdPASS)
+    {
+      prvHoldHse(xNeedsHse);
+
+      if (xConfirm != pdFALSE)
+      {
+        ulRevertBaud = ulPrevious;
+        (void) xTimerReset(xConfirmTimer, 0U);
+      }
+      else
+      {
+        ulRevertBaud = 0U;
+        (void) xTimerStop(xConfirmTimer, 0U);
+      }
+    }
+    else
+    {
+      prvHoldHse(xWasHolding);
+    }
+  }
+  (void) xTaskResumeAll();
+
+  return xReturn;
+}
+
+/**
+  * @brief  Keep a rate set with confirmation.  The shell calls this for each
+  *         command it recognises, which it can only have read at the new
+  *         rate.
+  * @retval None
+  */
+void vUartLineConfirm(void)
+{
+  vTaskSuspendAll();
+  {
+    if (ulRevertBaud != 0U)
+    {
+      ulRevertBaud = 0U;
+      (void) xTimerStop(xConfirmTimer, 0U);
+    }
+  }
+  (void) xTaskResumeAll();
+}
+
+/**
+  * @brief  The rate the divisor gives at the current PCLK1.
+  * @retval Baud.
+  */
+uint32_t ulUartLineGetBaud(void)
+{
+  return ulActualBaud;
+}
+
+/**
+  * @brief  The fastest rate at the current PCLK1.
+  * @retval Baud.
+  */
+uint32_t ulUartLineGetMaxBaud(void)
+{
+  return HAL_RCC_GetPCLK1Freq() / 8U;
+}
+
+/**
+  * @brief  Keep the rate set for the current PCLK1, or fall back to
+  *         uartlineBAUD if it is out of reach.  Called by xClockProfileSet()
+  *         once the line is idle.
+  * @retval None
+  */
+void vUartLineUpdateClock(void)
+{
+  uint32_t ulPclk = HAL_RCC_GetPCLK1Freq();
+  uint32_t ulBrr;
+
+  if (huart2.gState == HAL_UART_STATE_RESET)
+  {
+    return;
+  }
+
+  if (prvDivisor(ulPclk, ulSetBaud, &ulBrr, &ulActualBaud) != pdPASS)
+  {
+    ulSetBaud = uartlineBAUD;
+    (void) prvDivisor(ulPclk, ulSetBaud, &ulBrr, &ulActualBaud);
+  }
+
+  huart2.Init.BaudRate = ulSetBaud;
+  huart2.Instance->BRR = ulBrr;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Work out the BRR value for a rate at 8x oversampling.
+  * @param  pulBrr    Set to the register value.
+  * @param  pulActual Set to the rate it gives.
+  * @retval pdPASS, or pdFAIL if no divisor comes within
+  *         uartlineMAX_ERROR_PERMILLE.
+  */
+static BaseType_t prvDivisor(uint32_t ulPclk, uint32_t ulBaud, uint32_t *pulBrr, uint32_t *pulActual)
+{
+  uint32_t ulDivisor;
+  uint32_t ulActual;
+  uint32_t ulError;
+
+  if (ulBaud == 0U)
+  {
+    return pdFAIL;
+  }
+
+  ulDivisor = (ulPclk + (ulBaud / 2U)) / ulBaud;
+  if ((ulDivisor < 8U) || (ulDivisor > uartlineMAX_DIVISOR))
+  {
+    return pdFAIL;
+  }
+
+  ulActual = ulPclk / ulDivisor;
+  ulError = (ulActual > ulBaud) ? (ulActual - ulBaud) : (ulBaud - ulActual);
+  if (((uint64_t) ulError * 1000U) > ((uint64_t) ulBaud * uartlineMAX_ERROR_PERMILLE))
+  {
+    return pdFAIL;
+  }
+
+  *pulBrr = ((ulDivisor >> 3) << USART_BRR_DIV_Mantissa_Pos) | (ulDivisor & 7U);
+  *pulActual = ulActual;
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Let the log drain and the last byte go, then set ulSetBaud.
+  * @retval None
+  */
+static void prvApply(void)
+{
+  vTaskSuspendAll();
+  {
+    /* The DMA completion interrupt still runs with the scheduler suspended. */
+    while (xLogGetPending() != 0U)
+    {
+    }
+    while ((huart2.Instance->SR & USART_SR_TC) == 0U)
+    {
+    }
+
+    vUartLineUpdateClock();
+  }
+  (void) xTaskResumeAll();
+}
+
+/**
+  * @brief  Take or drop this module's hold on the HSE profiles.
+  * @retval None
+  */
+static void prvHoldHse(BaseType_t xHold)
+{
+  if ((xHold != pdFALSE) && (xHoldingHse == pdFALSE))
+  {
+    vClockProfileHseHold();
+    xHoldingHse = pdTRUE;
+  }
+  else if ((xHold == pdFALSE) && (xHoldingHse != pdFALSE))
+  {
+    vClockProfileHseRelease();
+    xHoldingHse = pdFALSE;
+  }
+}
+
+/**
+  * @brief  No command came at the new rate: go back to the old one.  Runs in
+  *         the timer task.
+  * @retval None
+  */
+static void prvConfirmTimeout(TimerHandle_t xTimer)
+{
+  uint32_t ulBaud;
+
+  (void) xTimer;
+
+  vTaskSuspendAll();
+  {
+    ulBaud = ulRevertBaud;
+  }
+  (void) xTaskResumeAll();
+
+  if (ulBaud != 0U)
+  {
+    (void) xUartLineSetBaud(ulBaud, pdFALSE);
+  }
+}
@@ -0,0 +1,293 @@
+/**
+  ******************************************************************************
+  * @file           : uartrx.c
+  * @brief          : Circular DMA reception on USART2 with idle line
+  *                   detection, delivered to a task through an SPSC ring.
+  ******************************************************************************
+  * The Rx event callback is passed the DMA write position in ucUartRxDma.
+  * Everything between the previous position and this one is new, wrapping at
+  * the end of the buffer, and is copied into the ring.  The DMA never stops,
+  * so bytes keep arriving while the callback runs, and only a reader that
+  * falls uartrxRING_SIZE bytes behind loses any.
+  *
+  * The callbacks run from the USART2 and DMA1 Stream5 interrupts only, which
+  * makes them the ring's single producer.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "spscring.h"
+#include "uartrx.h"
+#include "irqtable.h"
+#include "dmabuf.h"
+
+#if ((uartrxRING_SIZE & (uartrxRING_SIZE - 1U)) != 0U)
+#error uartrxRING_SIZE must be a power of two
+#endif
+
+#if ((uartrxDMA_SIZE & 1U) != 0U) || (uartrxDMA_SIZE > 0xffffU)
+#error uartrxDMA_SIZE must be even and fit one DMA transfer
+#endif
+
+/* External variables --------------------------------------------------------*/
+extern UART_HandleTypeDef huart2;
+
+/* Private variables ---------------------------------------------------------*/
+DMA_HandleTypeDef hdma_usart2_rx;
+
+/* Written by DMA1 Stream5 before the CPU reads it. */
+static __attribute__((section(".noinit"))) DMA_BUFFER_DEFINE(uint8_t, ucUartRxDma, uartrxDMA_SIZE);
+
+static uint8_t ucUartRxStorage[uartrxRING_SIZE];
+static SpscRing_t xUartRxRing;
+
+/* Offset in ucUartRxDma up to which bytes have been moved into the ring. */
+static uint16_t usUartRxTaken = 0U;
+
+static volatile TickType_t xUartRxLastTick = 0U;
+static volatile uint32_t ulUartRxDropped = 0U;
+static volatile uint32_t ulUartRxErrors = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvUartRxBegin(void);
+static void prvUartRxTake(uint16_t usPosition, BaseType_t *pxHigherPriorityTaskWoken);
+static void prvUartRxPush(const uint8_t *pucData, size_t xLength, BaseType_t *pxHigherPriorityTaskWoken);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Set up DMA1 Stream5 and start receiving.  Call once, after
+  *         MX_USART2_UART_Init().
+  * @retval None
+  */
+void vUartRxStart(void)
+{
+  vSpscRingInit(&xUartRxRing, ucUartRxStorage, sizeof(ucUartRxStorage), 1U);
+
+  hdma_usart2_rx.Instance = DMA1_Stream5;
+  hdma_usart2_rx.Init.Channel = DMA_CHANNEL_4;
+  hdma_usart2_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+  hdma_usart2_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma_usart2_rx.Init.MemInc = DMA_MINC_ENABLE;
+  hdma_usart2_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  hdma_usart2_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+  hdma_usart2_rx.Init.Mode = DMA_CIRCULAR;
+  hdma_usart2_rx.Init.Priority = DMA_PRIORITY_HIGH;
+  hdma_usart2_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+  if (HAL_DMA_Init(&hdma_usart2_rx) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  __HAL_LINKDMA(&huart2, hdmarx, hdma_usart2_rx);
+
+  irqtableREQUIRE_KERNEL(DMA1_Stream5);
+  irqtableREQUIRE_KERNEL(USART2);
+  HAL_NVIC_SetPriority(DMA1_Stream5_IRQn, irqtablePRIORITY(DMA1_Stream5), 0U);
+  HAL_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+
+  prvUartRxBegin();
+}
+
+/**
+  * @brief  Take received bytes, waiting for the first if there are none.
+  * @param  pvBuffer     Where to copy them.
+  * @param  xMaxLength   Size of pvBuffer.
+  * @param  xTicksToWait How long to wait; must be 0 outside a task.
+  * @note   Only one task may read.
+  * @retval Bytes copied, 0 if the wait timed out.
+  */
+size_t xUartRxRead(void *pvBuffer, size_t xMaxLength, TickType_t xTicksToWait)
+{
+  return xSpscRingRead(&xUartRxRing, pvBuffer, xMaxLength, xTicksToWait);
+}
+
+/**
+  * @brief  Look at received bytes where they lie in the ring, waiting for
+  *         one if there are none past xSkip.  See xSpscRingAcquire().
+  * @param  xSkip        Bytes already looked at, from the oldest.
+  * @param  ppucData     Set to the byte xSkip past the oldest.
+  * @param  xTicksToWait How long to wait; must be 0 outside a task.
+  * @note   The reader that takes bytes this way is the one reader allowed,
+  *         so stdin cannot be used alongside it.
+  * @retval Bytes at *ppucData before the ring wraps, 0 if the wait timed out.
+  */
+size_t xUartRxAcquire(size_t xSkip, uint8_t **ppucData, TickType_t xTicksToWait)
+{
+  return xSpscRingAcquire(&xUartRxRing, xSkip, ppucData, xTicksToWait);
+}
+
+/**
+  * @brief  Give back the oldest xLength bytes looked at with
+  *         xUartRxAcquire(), so reception can reuse their room.
+  * @retval None
+  */
+void vUartRxRelease(size_t xLength)
+{
+  vSpscRingRelease(&xUartRxRing, xLength);
+}
+
+/**
+  * @brief  Bytes lost because the reader fell a whole ring behind.
+  * @retval Dropped byte count since boot.
+  */
+uint32_t ulUartRxGetDropped(void)
+{
+  return ulUartRxDropped;
+}
+
+/**
+  * @brief  Overrun, framing, noise and parity errors reported by USART2.
+  * @retval Error count since boot.
+  */
+uint32_t ulUartRxGetErrors(void)
+{
+  return ulUartRxErrors;
+}
+
+/**
+  * @brief  Whether a byte arrived in the last uartrxHOLD_MS.
+  * @note   USART2 does not receive in STOP mode, so the low power code keeps
+  *         out of STOP while this returns pdTRUE.  A sender that finds the
+  *         part stopped loses the first bytes it sends.
+  * @retval pdTRUE while the line is in use.
+  */
+BaseType_t xUartRxIsBusy(void)
+{
+  return ((xTaskGetTickCount() - xUartRxLastTick) < pdMS_TO_TICKS(uartrxHOLD_MS)) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  Hook for HAL_UARTEx_RxEventCallback(): the line went idle or the
+  *         DMA reached half way or the end of the buffer.
+  * @param  huart      UART handle the callback was raised for.
+  * @param  usPosition Offset in ucUartRxDma the DMA will write next,
+  *                    uartrxDMA_SIZE at the end of the buffer.
+  * @retval None
+  */
+void vUartRxEventCallback(UART_HandleTypeDef *huart, uint16_t usPosition)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  if (huart != &huart2)
+  {
+    return;
+  }
+
+  prvUartRxTake(usPosition, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  Hook for HAL_UART_ErrorCallback().
+  * @note   With DMA reception the HAL aborts on any receive error.  The
+  *         bytes the DMA wrote before the abort are still taken, and
+  *         reception restarts at the buffer start.
+  * @param  huart UART handle the callback was raised for.
+  * @retval None
+  */
+void vUartRxErrorCallback(UART_HandleTypeDef *huart)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  if (huart != &huart2)
+  {
+    return;
+  }
+
+  if ((huart->ErrorCode & (HAL_UART_ERROR_ORE | HAL_UART_ERROR_NE |
+                           HAL_UART_ERROR_FE | HAL_UART_ERROR_PE)) != 0U)
+  {
+    ulUartRxErrors++;
+  }
+
+  if (huart->RxState == HAL_UART_STATE_READY)
+  {
+    prvUartRxTake((uint16_t) (uartrxDMA_SIZE - __HAL_DMA_GET_COUNTER(&hdma_usart2_rx)),
+                  &xHigherPriorityTaskWoken);
+    prvUartRxBegin();
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  }
+}
+
+/**
+  * @brief  Blocking read for stdin, replacing the __io_getchar() loop of
+  *         syscalls.c.  Returns once at least one byte has arrived.
+  * @retval Bytes copied.
+  */
+int _read(int file, char *ptr, int len)
+{
+  (void) file;
+
+  if (len <= 0)
+  {
+    return 0;
+  }
+
+  return (int) xUartRxRead(ptr, (size_t) len, portMAX_DELAY);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Start a circular reception to idle from the buffer start.
+  * @retval None
+  */
+static void prvUartRxBegin(void)
+{
+  usUartRxTaken = 0U;
+
+  if (HAL_UARTEx_ReceiveToIdle_DMA(&huart2, ucUartRxDma, uartrxDMA_SIZE) != HAL_OK)
+  {
+    ulUartRxErrors++;
+  }
+}
+
+/**
+  * @brief  Move the bytes up to a DMA write position into the ring.
+  * @param  usPosition Offset the DMA will write next, uartrxDMA_SIZE at the
+  *                    end of the buffer.
+  * @retval None
+  */
+static void prvUartRxTake(uint16_t usPosition, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  if (usPosition == usUartRxTaken)
+  {
+    return;
+  }
+
+  if (usPosition > usUartRxTaken)
+  {
+    prvUartRxPush(&ucUartRxDma[usUartRxTaken], usPosition - usUartRxTaken, pxHigherPriorityTaskWoken);
+  }
+  else
+  {
+    prvUartRxPush(&ucUartRxDma[usUartRxTaken], uartrxDMA_SIZE - usUartRxTaken, pxHigherPriorityTaskWoken);
+    prvUartRxPush(&ucUartRxDma[0], usPosition, pxHigherPriorityTaskWoken);
+  }
+
+  usUartRxTaken = (usPosition == uartrxDMA_SIZE) ? 0U : usPosition;
+  xUartRxLastTick = xTaskGetTickCountFromISR();
+}
+
+/**
+  * @brief  Copy as much of a run of received bytes as the ring has room for.
+  * @retval None
+  */
+static void prvUartRxPush(const uint8_t *pucData, size_t xLength, BaseType_t *pxHigherPriorityTaskWoken)
+{
+  size_t xSpace = xSpscRingSpacesAvailable(&xUartRxRing);
+
+  if (xLength > xSpace)
+  {
+    ulUartRxDropped += (uint32_t) (xLength - xSpace);
+    xLength = xSpace;
+  }
+
+  if (xLength != 0U)
+  {
+    (void) xSpscRingWriteFromISR(&xUartRxRing, pucData, xLength, pxHigherPriorityTaskWoken);
+  }
+}
@@ -0,0 +1,151 @@
+/**
+  ******************************************************************************
+  * @file           : uarttx.c
+  * @brief          : Transmit side of a USART on the LL API: one DMA stream
+  *                   writes DR, and its interrupt reports the end.
+  ******************************************************************************
+  * The stream runs in direct mode, a byte at a time from memory to DR, paced
+  * by TXE.  Transfer complete and the two error flags interrupt; the FIFO
+  * error flag, which direct mode can raise without cause, does not.  After
+  * transfer complete the last byte or two are still in the USART, and the
+  * next transfer simply queues behind them; code that must see the line
+  * idle, such as a clock change, waits for TC itself.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "uarttx.h"
+
+/* Private define ------------------------------------------------------------*/
+
+/* A stream's flags in LISR/HISR and LIFCR/HIFCR, at its offset. */
+#define uarttxFLAG_FE               DMA_LISR_FEIF0
+#define uarttxFLAG_DME              DMA_LISR_DMEIF0
+#define uarttxFLAG_TE               DMA_LISR_TEIF0
+#define uarttxFLAG_HT               DMA_LISR_HTIF0
+#define uarttxFLAG_TC               DMA_LISR_TCIF0
+#define uarttxFLAGS_ALL             (uarttxFLAG_FE | uarttxFLAG_DME | uarttxFLAG_TE | uarttxFLAG_HT | uarttxFLAG_TC)
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Offset of each stream's flags; streams 0 to 3 are in the low registers and
+   4 to 7 in the high ones. */
+static const uint8_t ucFlagShift[8] = { 0U, 6U, 16U, 22U, 0U, 6U, 16U, 22U };
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t prvFlags(const UartTx_t *pxTx);
+static void prvClearFlags(const UartTx_t *pxTx, uint32_t ulFlags);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Take over the stream and point it at the USART.  Call once the
+  *         USART and the DMA clock are on, before the first transfer.
+  * @retval None
+  */
+void vUartTxInit(const UartTx_t *pxTx)
+{
+  LL_DMA_DisableStream(pxTx->pxDma, pxTx->ulStream);
+  while (LL_DMA_IsEnabledStream(pxTx->pxDma, pxTx->ulStream) != 0U)
+  {
+  }
+
+  LL_DMA_ConfigTransfer(pxTx->pxDma, pxTx->ulStream,
+                        LL_DMA_DIRECTION_MEMORY_TO_PERIPH | LL_DMA_MODE_NORMAL | LL_DMA_PERIPH_NOINCREMENT |
+                        LL_DMA_MEMORY_INCREMENT | LL_DMA_PDATAALIGN_BYTE | LL_DMA_MDATAALIGN_BYTE |
+                        LL_DMA_PRIORITY_LOW);
+  LL_DMA_SetChannelSelection(pxTx->pxDma, pxTx->ulStream, pxTx->ulChannel);
+  LL_DMA_DisableFifoMode(pxTx->pxDma, pxTx->ulStream);
+  LL_DMA_SetPeriphAddress(pxTx->pxDma, pxTx->ulStream, LL_USART_DMA_GetRegAddr(pxTx->pxUsart));
+
+  prvClearFlags(pxTx, uarttxFLAGS_ALL);
+  LL_DMA_DisableIT_HT(pxTx->pxDma, pxTx->ulStream);
+  LL_DMA_DisableIT_FE(pxTx->pxDma, pxTx->ulStream);
+  LL_DMA_EnableIT_TC(pxTx->pxDma, pxTx->ulStream);
+  LL_DMA_EnableIT_TE(pxTx->pxDma, pxTx->ulStream);
+  LL_DMA_EnableIT_DME(pxTx->pxDma, pxTx->ulStream);
+
+  LL_USART_EnableDMAReq_TX(pxTx->pxUsart);
+}
+
+/**
+  * @brief  Send usLength bytes from pvData.
+  * @note   The stream must be idle, see xUartTxIsBusy(); pxDone runs when the
+  *         last byte has gone to DR.  pvData must be reachable by the stream
+  *         and stay put until then.
+  * @retval None
+  */
+void vUartTxStart(const UartTx_t *pxTx, const void *pvData, uint16_t usLength)
+{
+  configASSERT((usLength != 0U) && (xUartTxIsBusy(pxTx) == pdFALSE));
+
+  LL_DMA_SetMemoryAddress(pxTx->pxDma, pxTx->ulStream, (uint32_t) pvData);
+  LL_DMA_SetDataLength(pxTx->pxDma, pxTx->ulStream, usLength);
+  LL_DMA_EnableStream(pxTx->pxDma, pxTx->ulStream);
+}
+
+/**
+  * @brief  Whether a transfer is running.
+  * @retval pdTRUE while the stream is enabled.
+  */
+BaseType_t xUartTxIsBusy(const UartTx_t *pxTx)
+{
+  return (LL_DMA_IsEnabledStream(pxTx->pxDma, pxTx->ulStream) != 0U) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  The stream's interrupt body.
+  * @retval None
+  */
+void vUartTxIRQHandler(const UartTx_t *pxTx)
+{
+  uint32_t ulFlags = prvFlags(pxTx);
+
+  prvClearFlags(pxTx, ulFlags);
+
+  if ((ulFlags & (uarttxFLAG_TE | uarttxFLAG_DME)) != 0U)
+  {
+    /* The hardware disables the stream on a transfer error but not on a
+       direct mode error; either way the rest of the transfer is lost. */
+    LL_DMA_DisableStream(pxTx->pxDma, pxTx->ulStream);
+    while (LL_DMA_IsEnabledStream(pxTx->pxDma, pxTx->ulStream) != 0U)
+    {
+    }
+    prvClearFlags(pxTx, uarttxFLAGS_ALL);
+    pxTx->pxDone(pdTRUE);
+  }
+  else if ((ulFlags & uarttxFLAG_TC) != 0U)
+  {
+    pxTx->pxDone(pdFALSE);
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  The stream's flags, shifted down to stream 0's positions.
+  * @retval uarttxFLAG_* bits.
+  */
+static uint32_t prvFlags(const UartTx_t *pxTx)
+{
+  uint32_t ulIsr = (pxTx->ulStream < 4U) ? pxTx->pxDma->LISR : pxTx->pxDma->HISR;
+
+  return (ulIsr >> ucFlagShift[pxTx->ulStream]) & uarttxFLAGS_ALL;
+}
+
+/**
+  * @brief  Clear some of the stream's flags.
+  * @param  ulFlags uarttxFLAG_* bits.
+  * @retval None
+  */
+static void prvClearFlags(const UartTx_t *pxTx, uint32_t ulFlags)
+{
+  if (pxTx->ulStream < 4U)
+  {
+    pxTx->pxDma->LIFCR = ulFlags << ucFlagShift[pxTx->ulStream];
+  }
+  else
+  {
+    pxTx->pxDma->HIFCR = ulFlags << ucFlagShift[pxTx->ulStream];
+  }
+}
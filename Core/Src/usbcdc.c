@@ -0,0 +1,1102 @@
+/**
+  ******************************************************************************
+  * @file           : usbcdc.c
+  * @brief          : USB OTG FS CDC-ACM device, driven at register level.
+  ******************************************************************************
+  * The core runs in device mode with VBUS sensing off, as the Discovery board
+  * powers it from the ST-LINK connector rather than from CN5.  Endpoint 0
+  * answers the standard requests a host sends while enumerating and the
+  * three CDC requests a terminal sends when it opens the port; anything else
+  * is stalled.  SET_CONFIGURATION opens endpoint 1, bulk IN and OUT, and
+  * endpoint 2, the interrupt IN endpoint CDC-ACM declares and never uses.
+  *
+  * The transmit FIFO of endpoint 1 is usbcdcFIFO_EP1_WORDS deep, eight
+  * packets.  A transfer is programmed for all the bytes it covers at once,
+  * and the FIFO empty interrupt, at half empty, writes whole packets for as
+  * long as there is room for them, so the core always has the next packets
+  * queued while the host reads the ones before.  The ring tail only moves on
+  * past bytes that are in the FIFO.  A transfer that is a multiple of the
+  * packet size and leaves the ring empty is followed by a zero length packet,
+  * so the host does not wait for more.
+  *
+  * The interrupts run at configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, so the
+  * writers mask them to share the ring, as log.c does with its DMA.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+#include "usbcdc.h"
+#include "irqtable.h"
+#include "task.h"
+#include "clockprofile.h"
+
+/* Private define ------------------------------------------------------------*/
+
+#define usbcdcDEVICE                ((USB_OTG_DeviceTypeDef *) (USB_OTG_FS_PERIPH_BASE + USB_OTG_DEVICE_BASE))
+#define usbcdcIN(ep)                ((USB_OTG_INEndpointTypeDef *) (USB_OTG_FS_PERIPH_BASE + \
+                                      USB_OTG_IN_ENDPOINT_BASE + ((ep) * USB_OTG_EP_REG_SIZE)))
+#define usbcdcOUT(ep)               ((USB_OTG_OUTEndpointTypeDef *) (USB_OTG_FS_PERIPH_BASE + \
+                                      USB_OTG_OUT_ENDPOINT_BASE + ((ep) * USB_OTG_EP_REG_SIZE)))
+#define usbcdcFIFO(ep)              (*(__IO uint32_t *) (USB_OTG_FS_PERIPH_BASE + USB_OTG_FIFO_BASE + \
+                                      ((ep) * USB_OTG_FIFO_SIZE)))
+#define usbcdcPCGCCTL               (*(__IO uint32_t *) (USB_OTG_FS_PERIPH_BASE + USB_OTG_PCGCCTL_BASE))
+
+/* Endpoints. */
+#define usbcdcEP_CONTROL            0U
+#define usbcdcEP_DATA               1U
+#define usbcdcEP_NOTIFY             2U
+#define usbcdcEP0_SIZE              64U
+#define usbcdcNOTIFY_SIZE           8U
+
+/* FIFO RAM in words, 320 in all: shared receive FIFO, then one transmit FIFO
+   per IN endpoint. */
+#define usbcdcFIFO_RX_WORDS         128U
+#define usbcdcFIFO_EP0_WORDS        16U
+#define usbcdcFIFO_EP1_WORDS        128U
+#define usbcdcFIFO_EP2_WORDS        16U
+
+/* USB turnaround time in PHY clocks for an HCLK of 32 MHz or more, as on the
+   HSE profiles. */
+#define usbcdcTURNAROUND            6U
+
+/* Receive status packet types. */
+#define usbcdcPKTSTS_OUT_DATA       2U
+#define usbcdcPKTSTS_SETUP_DATA     6U
+
+/* Endpoint types in DxEPCTL.EPTYP. */
+#define usbcdcEPTYP_BULK            2U
+#define usbcdcEPTYP_INTERRUPT       3U
+
+/* Standard and CDC requests. */
+#define usbcdcREQ_GET_STATUS        0x00U
+#define usbcdcREQ_CLEAR_FEATURE     0x01U
+#define usbcdcREQ_SET_ADDRESS       0x05U
+#define usbcdcREQ_GET_DESCRIPTOR    0x06U
+#define usbcdcREQ_GET_CONFIGURATION 0x08U
+#define usbcdcREQ_SET_CONFIGURATION 0x09U
+#define usbcdcREQ_GET_INTERFACE     0x0AU
+#define usbcdcREQ_SET_INTERFACE     0x0BU
+#define usbcdcREQ_SET_LINE_CODING   0x20U
+#define usbcdcREQ_GET_LINE_CODING   0x21U
+#define usbcdcREQ_SET_CONTROL_LINE  0x22U
+#define usbcdcREQ_SEND_BREAK        0x23U
+
+#define usbcdcREQTYPE_DIR_IN        0x80U
+#define usbcdcREQTYPE_TYPE_MASK     0x60U
+#define usbcdcREQTYPE_STANDARD      0x00U
+#define usbcdcREQTYPE_CLASS         0x20U
+#define usbcdcREQTYPE_RECIPIENT     0x1FU
+#define usbcdcRECIPIENT_ENDPOINT    0x02U
+
+#define usbcdcDESC_DEVICE           0x01U
+#define usbcdcDESC_CONFIGURATION    0x02U
+#define usbcdcDESC_STRING           0x03U
+
+#define usbcdcCONFIG_VALUE          1U
+#define usbcdcCONFIG_LENGTH         67U
+#define usbcdcLINE_CODING_LENGTH    7U
+
+/* ST's virtual COM port IDs, which hosts already bind to CDC-ACM. */
+#define usbcdcVENDOR_ID             0x0483U
+#define usbcdcPRODUCT_ID            0x5740U
+
+/* Private types -------------------------------------------------------------*/
+
+/* The unsent part of an IN transfer. */
+typedef struct
+{
+  const uint8_t *pucData;
+  uint32_t ulLeft;
+} UsbCdcIn_t;
+
+/* Private variables ---------------------------------------------------------*/
+
+static const uint8_t ucDeviceDescriptor[] =
+{
+  18U, usbcdcDESC_DEVICE,
+  0x00U, 0x02U,                                 /* USB 2.0 */
+  0x02U, 0x00U, 0x00U,                          /* CDC, at the device */
+  usbcdcEP0_SIZE,
+  (uint8_t) usbcdcVENDOR_ID, (uint8_t) (usbcdcVENDOR_ID >> 8),
+  (uint8_t) usbcdcPRODUCT_ID, (uint8_t) (usbcdcPRODUCT_ID >> 8),
+  0x00U, 0x02U,                                 /* Device release 2.00 */
+  1U, 2U, 3U,                                   /* Manufacturer, product, serial */
+  1U                                            /* Configurations */
+};
+
+static const uint8_t ucConfigDescriptor[usbcdcCONFIG_LENGTH] =
+{
+  9U, usbcdcDESC_CONFIGURATION, usbcdcCONFIG_LENGTH, 0x00U, 2U, usbcdcCONFIG_VALUE, 0U,
+  0xC0U, 50U,                                   /* Self powered, 100 mA */
+
+  /* Communication interface, abstract control model, AT commands. */
+  9U, 0x04U, 0U, 0U, 1U, 0x02U, 0x02U, 0x01U, 0U,
+  5U, 0x24U, 0x00U, 0x10U, 0x01U,               /* Header, CDC 1.10 */
+  5U, 0x24U, 0x01U, 0x00U, 1U,                  /* Call management, data on 1 */
+  4U, 0x24U, 0x02U, 0x02U,                      /* ACM: line coding and state */
+  5U, 0x24U, 0x06U, 0U, 1U,                     /* Union of interfaces 0 and 1 */
+  7U, 0x05U, 0x80U | usbcdcEP_NOTIFY, usbcdcEPTYP_INTERRUPT, usbcdcNOTIFY_SIZE, 0x00U, 16U,
+
+  /* Data interface. */
+  9U, 0x04U, 1U, 0U, 2U, 0x0AU, 0x00U, 0x00U, 0U,
+  7U, 0x05U, usbcdcEP_DATA, usbcdcEPTYP_BULK, usbcdcPACKET_SIZE, 0x00U, 0U,
+  7U, 0x05U, 0x80U | usbcdcEP_DATA, usbcdcEPTYP_BULK, usbcdcPACKET_SIZE, 0x00U, 0U
+};
+
+static const char * const pcStrings[] =
+{
+  "STMicroelectronics",
+  "Lab4 telemetry"
+};
+
+/* Ring of log bytes; the head and tail only increase. */
+static uint8_t ucRing[usbcdcRING_SIZE];
+static volatile uint32_t ulHead = 0U;
+static volatile uint32_t ulTail = 0U;
+static volatile uint32_t ulDropped = 0U;
+
+/* Endpoint 1 IN: a transfer running, and its length. */
+static BaseType_t xBulkBusy = pdFALSE;
+static uint32_t ulBulkLength = 0U;
+
+static UsbCdcIn_t xIn[usbcdcEP_DATA + 1U];
+
+/* Last SETUP packet, and the request whose OUT data stage endpoint 0 is
+   receiving. */
+static uint32_t ulSetup[2];
+static uint8_t ucEp0OutRequest = 0U;
+static uint8_t ucEp0Buffer[usbcdcEP0_SIZE];
+
+/* 115200 8N1 until the host sets otherwise; only reported back. */
+static uint8_t ucLineCoding[usbcdcLINE_CODING_LENGTH] = { 0x00U, 0xC2U, 0x01U, 0x00U, 0U, 0U, 8U };
+
+static char cSerial[25];
+
+static BaseType_t xStarted = pdFALSE;
+static volatile BaseType_t xConfigured = pdFALSE;
+static volatile BaseType_t xSuspended = pdTRUE;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvCoreInit(void);
+static void prvBusReset(void);
+static void prvEnumerationDone(void);
+static void prvReceive(void);
+static void prvOutEndpoint(uint32_t ulEp);
+static void prvInEndpoint(uint32_t ulEp);
+static void prvSetup(void);
+static BaseType_t prvStandardRequest(uint8_t ucType, uint8_t ucRequest, uint16_t usValue, uint16_t usIndex,
+                                     uint16_t usLength);
+static BaseType_t prvClassRequest(uint8_t ucRequest, uint16_t usLength);
+static void prvConfigure(uint16_t usValue);
+static void prvEp0Send(const uint8_t *pucData, uint32_t ulLength, uint16_t usMaxLength);
+static void prvEp0ArmOut(void);
+static void prvEp0Stall(void);
+static void prvInStart(uint32_t ulEp, const uint8_t *pucData, uint32_t ulLength);
+static void prvInFill(uint32_t ulEp);
+static void prvBulkStart(void);
+static void prvBulkDone(void);
+static void prvFifoWrite(uint32_t ulEp, const uint8_t *pucData, uint32_t ulLength);
+static void prvFifoRead(uint8_t *pucData, uint32_t ulLength);
+static uint32_t prvStringDescriptor(uint8_t ucIndex);
+
+/* Exported variables --------------------------------------------------------*/
+const LogSink_t xUsbCdcLogSink = { xUsbCdcWrite };
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Start the USB device and connect it to the bus.
+  * @note   Holds the HSE profiles from here on, and leaves the low power one
+  *         at once if it is in force.
+  * @retval pdPASS, or pdFAIL if the clock has no 48 MHz.
+  */
+BaseType_t xUsbCdcStart(void)
+{
+  const uint32_t *pulUid = (const uint32_t *) UID_BASE;
+  static const char cHex[] = "0123456789ABCDEF";
+  uint32_t ulIndex;
+
+  if (xStarted != pdFALSE)
+  {
+    return pdPASS;
+  }
+
+  vClockProfileHseHold();
+  if ((eClockProfileGet() == CLOCK_PROFILE_LOW_POWER) && (xClockProfileSet(CLOCK_PROFILE_BALANCED) != pdPASS))
+  {
+    vClockProfileHseRelease();
+    return pdFAIL;
+  }
+
+  for (ulIndex = 0U; ulIndex < 24U; ulIndex++)
+  {
+    cSerial[ulIndex] = cHex[(pulUid[ulIndex / 8U] >> (28U - (4U * (ulIndex % 8U)))) & 0xFU];
+  }
+  cSerial[24] = '\0';
+
+  __HAL_RCC_USB_OTG_FS_CLK_ENABLE();
+  prvCoreInit();
+
+  /* The wakeup line brings the clocks back from STOP on a resume. */
+  EXTI->PR = EXTI_PR_PR18;
+  EXTI->RTSR |= EXTI_RTSR_TR18;
+  EXTI->IMR |= EXTI_IMR_MR18;
+
+  irqtableREQUIRE_KERNEL(OTG_FS);
+  HAL_NVIC_SetPriority(OTG_FS_IRQn, irqtablePRIORITY(OTG_FS), 0U);
+  HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+  irqtableREQUIRE_KERNEL(OTG_FS_WKUP);
+  HAL_NVIC_SetPriority(OTG_FS_WKUP_IRQn, irqtablePRIORITY(OTG_FS_WKUP), 0U);
+  HAL_NVIC_EnableIRQ(OTG_FS_WKUP_IRQn);
+
+  xStarted = pdTRUE;
+
+  /* Soft connect: pull D+ up. */
+  usbcdcDEVICE->DCTL &= ~USB_OTG_DCTL_SDIS;
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Queue bytes for the host.
+  * @note   May be called from an interrupt at or below
+  *         configMAX_SYSCALL_INTERRUPT_PRIORITY.
+  * @param  pvData  Bytes to send.
+  * @param  xLength Number of bytes.
+  * @retval xLength if queued whole, 0 if dropped for want of room.
+  */
+size_t xUsbCdcWrite(const void *pvData, size_t xLength)
+{
+  UBaseType_t uxSavedInterruptStatus;
+  uint32_t ulOffset;
+  size_t xFirst;
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+
+  if (xLength > (usbcdcRING_SIZE - (ulHead - ulTail)))
+  {
+    ulDropped++;
+    xLength = 0U;
+  }
+  else
+  {
+    ulOffset = ulHead & (usbcdcRING_SIZE - 1U);
+    xFirst = usbcdcRING_SIZE - ulOffset;
+
+    if (xFirst > xLength)
+    {
+      xFirst = xLength;
+    }
+
+    memcpy(&ucRing[ulOffset], pvData, xFirst);
+    memcpy(&ucRing[0], (const uint8_t *) pvData + xFirst, xLength - xFirst);
+    ulHead += xLength;
+
+    prvBulkStart();
+  }
+
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+
+  return xLength;
+}
+
+/**
+  * @brief  Whether a host has configured the device, so bytes written move.
+  * @retval pdTRUE if configured.
+  */
+BaseType_t xUsbCdcIsConfigured(void)
+{
+  return xConfigured;
+}
+
+/**
+  * @brief  Messages dropped because the ring was full.
+  * @retval Count since boot.
+  */
+uint32_t ulUsbCdcGetDropped(void)
+{
+  return ulDropped;
+}
+
+/**
+  * @brief  Whether the bus is active.  The core cannot answer the host from
+  *         STOP, so the low power idle stays in SLEEP until the host suspends
+  *         the bus or the cable is pulled.
+  * @retval pdTRUE if busy.
+  */
+BaseType_t xUsbCdcIsBusy(void)
+{
+  return ((xStarted != pdFALSE) && (xSuspended == pdFALSE)) ? pdTRUE : pdFALSE;
+}
+
+/**
+  * @brief  OTG FS global interrupt.
+  * @retval None
+  */
+void vUsbCdcIRQHandler(void)
+{
+  uint32_t ulStatus;
+  uint32_t ulEndpoints;
+  uint32_t ulEp;
+
+  ulStatus = USB_OTG_FS->GINTSTS & USB_OTG_FS->GINTMSK;
+
+  if ((ulStatus & USB_OTG_GINTSTS_USBRST) != 0U)
+  {
+    USB_OTG_FS->GINTSTS = USB_OTG_GINTSTS_USBRST;
+    prvBusReset();
+  }
+
+  if ((ulStatus & USB_OTG_GINTSTS_ENUMDNE) != 0U)
+  {
+    USB_OTG_FS->GINTSTS = USB_OTG_GINTSTS_ENUMDNE;
+    prvEnumerationDone();
+  }
+
+  if ((ulStatus & USB_OTG_GINTSTS_RXFLVL) != 0U)
+  {
+    prvReceive();
+  }
+
+  if ((ulStatus & USB_OTG_GINTSTS_OEPINT) != 0U)
+  {
+    ulEndpoints = (usbcdcDEVICE->DAINT & usbcdcDEVICE->DAINTMSK) >> USB_OTG_DAINTMSK_OEPM_Pos;
+    for (ulEp = 0U; ulEp <= usbcdcEP_DATA; ulEp++)
+    {
+      if ((ulEndpoints & (1UL << ulEp)) != 0U)
+      {
+        prvOutEndpoint(ulEp);
+      }
+    }
+  }
+
+  if ((ulStatus & USB_OTG_GINTSTS_IEPINT) != 0U)
+  {
+    ulEndpoints = usbcdcDEVICE->DAINT & usbcdcDEVICE->DAINTMSK & 0xFFFFU;
+    for (ulEp = 0U; ulEp <= usbcdcEP_DATA; ulEp++)
+    {
+      if ((ulEndpoints & (1UL << ulEp)) != 0U)
+      {
+        prvInEndpoint(ulEp);
+      }
+    }
+  }
+
+  if ((ulStatus & USB_OTG_GINTSTS_USBSUSP) != 0U)
+  {
+    USB_OTG_FS->GINTSTS = USB_OTG_GINTSTS_USBSUSP;
+    xSuspended = pdTRUE;
+  }
+
+  if ((ulStatus & USB_OTG_GINTSTS_WKUINT) != 0U)
+  {
+    USB_OTG_FS->GINTSTS = USB_OTG_GINTSTS_WKUINT;
+    xSuspended = pdFALSE;
+  }
+}
+
+/**
+  * @brief  OTG FS wakeup line, EXTI18.  Only wakes the core from STOP; the
+  *         resume itself is handled by vUsbCdcIRQHandler().
+  * @retval None
+  */
+void vUsbCdcWakeupIRQHandler(void)
+{
+  EXTI->PR = EXTI_PR_PR18;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Reset the core into device mode, size the FIFOs and unmask the
+  *         interrupts, leaving it soft disconnected.
+  * @retval None
+  */
+static void prvCoreInit(void)
+{
+  uint32_t ulEp;
+
+  while ((USB_OTG_FS->GRSTCTL & USB_OTG_GRSTCTL_AHBIDL) == 0U)
+  {
+  }
+  USB_OTG_FS->GRSTCTL |= USB_OTG_GRSTCTL_CSRST;
+  while ((USB_OTG_FS->GRSTCTL & USB_OTG_GRSTCTL_CSRST) != 0U)
+  {
+  }
+
+  /* Transceiver on, VBUS not sensed; force device mode, which takes 25 ms. */
+  USB_OTG_FS->GCCFG = USB_OTG_GCCFG_PWRDWN | USB_OTG_GCCFG_NOVBUSSENS;
+  USB_OTG_FS->GUSBCFG = (USB_OTG_FS->GUSBCFG & ~(USB_OTG_GUSBCFG_FHMOD | USB_OTG_GUSBCFG_TRDT)) |
+                        USB_OTG_GUSBCFG_PHYSEL | USB_OTG_GUSBCFG_FDMOD |
+                        (usbcdcTURNAROUND << USB_OTG_GUSBCFG_TRDT_Pos);
+  HAL_Delay(25U);
+
+  usbcdcPCGCCTL = 0U;
+  usbcdcDEVICE->DCTL |= USB_OTG_DCTL_SDIS;
+  usbcdcDEVICE->DCFG = (usbcdcDEVICE->DCFG & ~(USB_OTG_DCFG_DSPD | USB_OTG_DCFG_DAD)) | USB_OTG_DCFG_DSPD;
+
+  USB_OTG_FS->GRXFSIZ = usbcdcFIFO_RX_WORDS;
+  USB_OTG_FS->DIEPTXF0_HNPTXFSIZ = (usbcdcFIFO_EP0_WORDS << 16) | usbcdcFIFO_RX_WORDS;
+  USB_OTG_FS->DIEPTXF[0] = (usbcdcFIFO_EP1_WORDS << 16) | (usbcdcFIFO_RX_WORDS + usbcdcFIFO_EP0_WORDS);
+  USB_OTG_FS->DIEPTXF[1] = (usbcdcFIFO_EP2_WORDS << 16) |
+                           (usbcdcFIFO_RX_WORDS + usbcdcFIFO_EP0_WORDS + usbcdcFIFO_EP1_WORDS);
+
+  USB_OTG_FS->GRSTCTL = USB_OTG_GRSTCTL_TXFFLSH | (0x10UL << USB_OTG_GRSTCTL_TXFNUM_Pos);
+  while ((USB_OTG_FS->GRSTCTL & USB_OTG_GRSTCTL_TXFFLSH) != 0U)
+  {
+  }
+  USB_OTG_FS->GRSTCTL = USB_OTG_GRSTCTL_RXFFLSH;
+  while ((USB_OTG_FS->GRSTCTL & USB_OTG_GRSTCTL_RXFFLSH) != 0U)
+  {
+  }
+
+  for (ulEp = 0U; ulEp <= usbcdcEP_NOTIFY; ulEp++)
+  {
+    usbcdcIN(ulEp)->DIEPCTL = 0U;
+    usbcdcIN(ulEp)->DIEPINT = 0xFFFFU;
+    usbcdcOUT(ulEp)->DOEPCTL = 0U;
+    usbcdcOUT(ulEp)->DOEPINT = 0xFFFFU;
+  }
+
+  usbcdcDEVICE->DIEPMSK = USB_OTG_DIEPMSK_XFRCM;
+  usbcdcDEVICE->DOEPMSK = USB_OTG_DOEPMSK_STUPM | USB_OTG_DOEPMSK_XFRCM;
+  usbcdcDEVICE->DAINTMSK = 0U;
+  usbcdcDEVICE->DIEPEMPMSK = 0U;
+
+  USB_OTG_FS->GINTSTS = 0xBFFFFFFFUL;
+  USB_OTG_FS->GINTMSK = USB_OTG_GINTMSK_USBRST | USB_OTG_GINTMSK_ENUMDNEM | USB_OTG_GINTMSK_RXFLVLM |
+                        USB_OTG_GINTMSK_IEPINT | USB_OTG_GINTMSK_OEPINT | USB_OTG_GINTMSK_USBSUSPM |
+                        USB_OTG_GINTMSK_WUIM;
+
+  /* FIFO empty interrupts at half empty. */
+  USB_OTG_FS->GAHBCFG = USB_OTG_GAHBCFG_GINT;
+}
+
+/**
+  * @brief  The host reset the bus: back to the default address with only
+  *         endpoint 0, ready for a SETUP packet.
+  * @retval None
+  */
+static void prvBusReset(void)
+{
+  uint32_t ulEp;
+
+  xSuspended = pdFALSE;
+  xConfigured = pdFALSE;
+  xBulkBusy = pdFALSE;
+  ucEp0OutRequest = 0U;
+
+  usbcdcDEVICE->DCTL &= ~USB_OTG_DCTL_RWUSIG;
+  USB_OTG_FS->GRSTCTL = USB_OTG_GRSTCTL_TXFFLSH | (0x10UL << USB_OTG_GRSTCTL_TXFNUM_Pos);
+  while ((USB_OTG_FS->GRSTCTL & USB_OTG_GRSTCTL_TXFFLSH) != 0U)
+  {
+  }
+
+  for (ulEp = 0U; ulEp <= usbcdcEP_NOTIFY; ulEp++)
+  {
+    usbcdcIN(ulEp)->DIEPCTL &= ~(USB_OTG_DIEPCTL_USBAEP | USB_OTG_DIEPCTL_STALL);
+    usbcdcIN(ulEp)->DIEPINT = 0xFFFFU;
+    usbcdcOUT(ulEp)->DOEPCTL &= ~(USB_OTG_DOEPCTL_USBAEP | USB_OTG_DOEPCTL_STALL);
+    usbcdcOUT(ulEp)->DOEPINT = 0xFFFFU;
+  }
+
+  usbcdcDEVICE->DIEPEMPMSK = 0U;
+  usbcdcDEVICE->DAINTMSK = (1UL << usbcdcEP_CONTROL) | (1UL << (USB_OTG_DAINTMSK_OEPM_Pos + usbcdcEP_CONTROL));
+  usbcdcDEVICE->DCFG &= ~USB_OTG_DCFG_DAD;
+
+  prvEp0ArmOut();
+}
+
+/**
+  * @brief  Speed enumeration finished: endpoint 0 packets of 64 bytes.
+  * @retval None
+  */
+static void prvEnumerationDone(void)
+{
+  usbcdcIN(usbcdcEP_CONTROL)->DIEPCTL &= ~USB_OTG_DIEPCTL_MPSIZ;
+  usbcdcDEVICE->DCTL |= USB_OTG_DCTL_CGINAK;
+}
+
+/**
+  * @brief  Pop one entry of the receive FIFO: SETUP packets are kept,
+  *         endpoint 0 OUT data kept for the request expecting it, and bulk
+  *         OUT data dropped.
+  * @retval None
+  */
+static void prvReceive(void)
+{
+  uint32_t ulStatus;
+  uint32_t ulEp;
+  uint32_t ulCount;
+
+  ulStatus = USB_OTG_FS->GRXSTSP;
+  ulEp = ulStatus & USB_OTG_GRXSTSP_EPNUM;
+  ulCount = (ulStatus & USB_OTG_GRXSTSP_BCNT) >> USB_OTG_GRXSTSP_BCNT_Pos;
+
+  switch ((ulStatus & USB_OTG_GRXSTSP_PKTSTS) >> USB_OTG_GRXSTSP_PKTSTS_Pos)
+  {
+    case usbcdcPKTSTS_SETUP_DATA:
+      prvFifoRead((uint8_t *) ulSetup, sizeof(ulSetup));
+      break;
+
+    case usbcdcPKTSTS_OUT_DATA:
+      prvFifoRead(((ulEp == usbcdcEP_CONTROL) && (ulCount <= sizeof(ucEp0Buffer))) ? ucEp0Buffer : NULL,
+                  ulCount);
+      break;
+
+    default:
+      break;
+  }
+}
+
+/**
+  * @brief  OUT endpoint interrupt: a SETUP stage ended, or OUT data arrived.
+  * @param  ulEp Endpoint number.
+  * @retval None
+  */
+static void prvOutEndpoint(uint32_t ulEp)
+{
+  uint32_t ulStatus;
+
+  ulStatus = usbcdcOUT(ulEp)->DOEPINT & usbcdcDEVICE->DOEPMSK;
+  usbcdcOUT(ulEp)->DOEPINT = ulStatus;
+
+  if (ulEp != usbcdcEP_CONTROL)
+  {
+    if ((ulStatus & USB_OTG_DOEPINT_XFRC) != 0U)
+    {
+      usbcdcOUT(ulEp)->DOEPTSIZ = (1UL << USB_OTG_DOEPTSIZ_PKTCNT_Pos) | usbcdcPACKET_SIZE;
+      usbcdcOUT(ulEp)->DOEPCTL |= USB_OTG_DOEPCTL_EPENA | USB_OTG_DOEPCTL_CNAK;
+    }
+    return;
+  }
+
+  if ((ulStatus & USB_OTG_DOEPINT_STUP) != 0U)
+  {
+    prvSetup();
+  }
+  else if ((ulStatus & USB_OTG_DOEPINT_XFRC) != 0U)
+  {
+    if (ucEp0OutRequest == usbcdcREQ_SET_LINE_CODING)
+    {
+      memcpy(ucLineCoding, ucEp0Buffer, sizeof(ucLineCoding));
+    }
+    if (ucEp0OutRequest != 0U)
+    {
+      ucEp0OutRequest = 0U;
+      prvEp0Send(NULL, 0U, 0U);
+    }
+    prvEp0ArmOut();
+  }
+}
+
+/**
+  * @brief  IN endpoint interrupt: a transfer completed, or the transmit FIFO
+  *         has room for more of it.
+  * @param  ulEp Endpoint number.
+  * @retval None
+  */
+static void prvInEndpoint(uint32_t ulEp)
+{
+  uint32_t ulStatus;
+
+  ulStatus = usbcdcIN(ulEp)->DIEPINT;
+
+  if ((ulStatus & USB_OTG_DIEPINT_XFRC) != 0U)
+  {
+    usbcdcIN(ulEp)->DIEPINT = USB_OTG_DIEPINT_XFRC;
+    if (ulEp == usbcdcEP_DATA)
+    {
+      prvBulkDone();
+    }
+  }
+
+  if (((ulStatus & USB_OTG_DIEPINT_TXFE) != 0U) && ((usbcdcDEVICE->DIEPEMPMSK & (1UL << ulEp)) != 0U))
+  {
+    prvInFill(ulEp);
+  }
+}
+
+/**
+  * @brief  Answer the SETUP packet in ulSetup.
+  * @retval None
+  */
+static void prvSetup(void)
+{
+  uint8_t ucType = (uint8_t) ulSetup[0];
+  uint8_t ucRequest = (uint8_t) (ulSetup[0] >> 8);
+  uint16_t usValue = (uint16_t) (ulSetup[0] >> 16);
+  uint16_t usIndex = (uint16_t) ulSetup[1];
+  uint16_t usLength = (uint16_t) (ulSetup[1] >> 16);
+  BaseType_t xHandled = pdFALSE;
+
+  ucEp0OutRequest = 0U;
+
+  switch (ucType & usbcdcREQTYPE_TYPE_MASK)
+  {
+    case usbcdcREQTYPE_STANDARD:
+      xHandled = prvStandardRequest(ucType, ucRequest, usValue, usIndex, usLength);
+      break;
+
+    case usbcdcREQTYPE_CLASS:
+      xHandled = prvClassRequest(ucRequest, usLength);
+      break;
+
+    default:
+      break;
+  }
+
+  if (xHandled == pdFALSE)
+  {
+    prvEp0Stall();
+  }
+
+  prvEp0ArmOut();
+}
+
+/**
+  * @brief  Answer a standard request, with a data stage or a status stage.
+  * @retval pdTRUE if answered, pdFALSE to stall it.
+  */
+static BaseType_t prvStandardRequest(uint8_t ucType, uint8_t ucRequest, uint16_t usValue, uint16_t usIndex,
+                                     uint16_t usLength)
+{
+  uint32_t ulLength;
+  uint32_t ulEp;
+
+  switch (ucRequest)
+  {
+    case usbcdcREQ_GET_DESCRIPTOR:
+      switch (usValue >> 8)
+      {
+        case usbcdcDESC_DEVICE:
+          prvEp0Send(ucDeviceDescriptor, sizeof(ucDeviceDescriptor), usLength);
+          return pdTRUE;
+
+        case usbcdcDESC_CONFIGURATION:
+          prvEp0Send(ucConfigDescriptor, sizeof(ucConfigDescriptor), usLength);
+          return pdTRUE;
+
+        case usbcdcDESC_STRING:
+          ulLength = prvStringDescriptor((uint8_t) usValue);
+          if (ulLength == 0U)
+          {
+            return pdFALSE;
+          }
+          prvEp0Send(ucEp0Buffer, ulLength, usLength);
+          return pdTRUE;
+
+        default:
+          /* Device qualifier and the rest: a full speed only device. */
+          return pdFALSE;
+      }
+
+    case usbcdcREQ_SET_ADDRESS:
+      /* The core answers the status stage at the old address. */
+      usbcdcDEVICE->DCFG = (usbcdcDEVICE->DCFG & ~USB_OTG_DCFG_DAD) |
+                           (((uint32_t) usValue << USB_OTG_DCFG_DAD_Pos) & USB_OTG_DCFG_DAD);
+      prvEp0Send(NULL, 0U, 0U);
+      return pdTRUE;
+
+    case usbcdcREQ_SET_CONFIGURATION:
+      if (usValue > usbcdcCONFIG_VALUE)
+      {
+        return pdFALSE;
+      }
+      prvConfigure(usValue);
+      prvEp0Send(NULL, 0U, 0U);
+      return pdTRUE;
+
+    case usbcdcREQ_GET_CONFIGURATION:
+      ucEp0Buffer[0] = (xConfigured != pdFALSE) ? usbcdcCONFIG_VALUE : 0U;
+      prvEp0Send(ucEp0Buffer, 1U, usLength);
+      return pdTRUE;
+
+    case usbcdcREQ_GET_STATUS:
+      if ((ucType & usbcdcREQTYPE_RECIPIENT) == usbcdcRECIPIENT_ENDPOINT)
+      {
+        ulEp = usIndex & 0x0FU;
+        ucEp0Buffer[0] = (((usIndex & 0x80U) != 0U) ?
+                          ((usbcdcIN(ulEp)->DIEPCTL & USB_OTG_DIEPCTL_STALL) != 0U) :
+                          ((usbcdcOUT(ulEp)->DOEPCTL & USB_OTG_DOEPCTL_STALL) != 0U)) ? 1U : 0U;
+        ucEp0Buffer[1] = 0U;
+        prvEp0Send(ucEp0Buffer, 2U, usLength);
+      }
+      else
+      {
+        /* Self powered for the device, as in the configuration. */
+        ucEp0Buffer[0] = ((ucType & usbcdcREQTYPE_RECIPIENT) == 0U) ? 1U : 0U;
+        ucEp0Buffer[1] = 0U;
+        prvEp0Send(ucEp0Buffer, 2U, usLength);
+      }
+      return pdTRUE;
+
+    case usbcdcREQ_CLEAR_FEATURE:
+      /* ENDPOINT_HALT: the data toggle starts again at DATA0. */
+      if ((ucType & usbcdcREQTYPE_RECIPIENT) != usbcdcRECIPIENT_ENDPOINT)
+      {
+        return pdFALSE;
+      }
+      ulEp = usIndex & 0x0FU;
+      if ((ulEp != usbcdcEP_CONTROL) && (ulEp <= usbcdcEP_NOTIFY))
+      {
+        if ((usIndex & 0x80U) != 0U)
+        {
+          usbcdcIN(ulEp)->DIEPCTL = (usbcdcIN(ulEp)->DIEPCTL & ~USB_OTG_DIEPCTL_STALL) | USB_OTG_DIEPCTL_SD0PID_SEVNFRM;
+        }
+        else
+        {
+          usbcdcOUT(ulEp)->DOEPCTL = (usbcdcOUT(ulEp)->DOEPCTL & ~USB_OTG_DOEPCTL_STALL) | USB_OTG_DOEPCTL_SD0PID_SEVNFRM;
+        }
+      }
+      prvEp0Send(NULL, 0U, 0U);
+      return pdTRUE;
+
+    case usbcdcREQ_GET_INTERFACE:
+      ucEp0Buffer[0] = 0U;
+      prvEp0Send(ucEp0Buffer, 1U, usLength);
+      return pdTRUE;
+
+    case usbcdcREQ_SET_INTERFACE:
+      if (usValue != 0U)
+      {
+        return pdFALSE;
+      }
+      prvEp0Send(NULL, 0U, 0U);
+      return pdTRUE;
+
+    default:
+      return pdFALSE;
+  }
+}
+
+/**
+  * @brief  Answer a CDC-ACM request.  The line coding is kept to report back;
+  *         the port has no line of its own for it to set.
+  * @retval pdTRUE if answered, pdFALSE to stall it.
+  */
+static BaseType_t prvClassRequest(uint8_t ucRequest, uint16_t usLength)
+{
+  switch (ucRequest)
+  {
+    case usbcdcREQ_SET_LINE_CODING:
+      if (usLength != sizeof(ucLineCoding))
+      {
+        return pdFALSE;
+      }
+      /* Status stage once the data stage is in. */
+      ucEp0OutRequest = ucRequest;
+      return pdTRUE;
+
+    case usbcdcREQ_GET_LINE_CODING:
+      prvEp0Send(ucLineCoding, sizeof(ucLineCoding), usLength);
+      return pdTRUE;
+
+    case usbcdcREQ_SET_CONTROL_LINE:
+    case usbcdcREQ_SEND_BREAK:
+      prvEp0Send(NULL, 0U, 0U);
+      return pdTRUE;
+
+    default:
+      return pdFALSE;
+  }
+}
+
+/**
+  * @brief  Open the data and notification endpoints, or close them for
+  *         configuration 0.
+  * @param  usValue Configuration value.
+  * @retval None
+  */
+static void prvConfigure(uint16_t usValue)
+{
+  UBaseType_t uxSavedInterruptStatus;
+
+  if (usValue == 0U)
+  {
+    xConfigured = pdFALSE;
+    usbcdcIN(usbcdcEP_DATA)->DIEPCTL &= ~USB_OTG_DIEPCTL_USBAEP;
+    usbcdcOUT(usbcdcEP_DATA)->DOEPCTL &= ~USB_OTG_DOEPCTL_USBAEP;
+    usbcdcIN(usbcdcEP_NOTIFY)->DIEPCTL &= ~USB_OTG_DIEPCTL_USBAEP;
+    usbcdcDEVICE->DAINTMSK &= ~((1UL << usbcdcEP_DATA) | (1UL << (USB_OTG_DAINTMSK_OEPM_Pos + usbcdcEP_DATA)));
+    usbcdcDEVICE->DIEPEMPMSK &= ~(1UL << usbcdcEP_DATA);
+    xBulkBusy = pdFALSE;
+    return;
+  }
+
+  usbcdcIN(usbcdcEP_DATA)->DIEPCTL = USB_OTG_DIEPCTL_USBAEP | USB_OTG_DIEPCTL_SD0PID_SEVNFRM |
+                                     (usbcdcEPTYP_BULK << USB_OTG_DIEPCTL_EPTYP_Pos) |
+                                     (usbcdcEP_DATA << USB_OTG_DIEPCTL_TXFNUM_Pos) | usbcdcPACKET_SIZE;
+  usbcdcOUT(usbcdcEP_DATA)->DOEPCTL = USB_OTG_DOEPCTL_USBAEP | USB_OTG_DOEPCTL_SD0PID_SEVNFRM |
+                                      (usbcdcEPTYP_BULK << USB_OTG_DOEPCTL_EPTYP_Pos) | usbcdcPACKET_SIZE;
+  usbcdcIN(usbcdcEP_NOTIFY)->DIEPCTL = USB_OTG_DIEPCTL_USBAEP | USB_OTG_DIEPCTL_SD0PID_SEVNFRM |
+                                       (usbcdcEPTYP_INTERRUPT << USB_OTG_DIEPCTL_EPTYP_Pos) |
+                                       (usbcdcEP_NOTIFY << USB_OTG_DIEPCTL_TXFNUM_Pos) | usbcdcNOTIFY_SIZE;
+  usbcdcDEVICE->DAINTMSK |= (1UL << usbcdcEP_DATA) | (1UL << (USB_OTG_DAINTMSK_OEPM_Pos + usbcdcEP_DATA));
+
+  usbcdcOUT(usbcdcEP_DATA)->DOEPTSIZ = (1UL << USB_OTG_DOEPTSIZ_PKTCNT_Pos) | usbcdcPACKET_SIZE;
+  usbcdcOUT(usbcdcEP_DATA)->DOEPCTL |= USB_OTG_DOEPCTL_EPENA | USB_OTG_DOEPCTL_CNAK;
+
+  uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+  xConfigured = pdTRUE;
+  prvBulkStart();
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+}
+
+/**
+  * @brief  Send the IN data stage of a control transfer, or with no data its
+  *         status stage.
+  * @param  pucData     Bytes to send, which stay valid until sent.
+  * @param  ulLength    Their number.
+  * @param  usMaxLength wLength of the request; the reply is cut to it.
+  * @retval None
+  */
+static void prvEp0Send(const uint8_t *pucData, uint32_t ulLength, uint16_t usMaxLength)
+{
+  if (ulLength > usMaxLength)
+  {
+    ulLength = usMaxLength;
+  }
+
+  /* Endpoint 0 transfers are at most three packets of 127 bytes in all. */
+  configASSERT(ulLength <= 127U);
+
+  prvInStart(usbcdcEP_CONTROL, pucData, ulLength);
+}
+
+/**
+  * @brief  Let endpoint 0 take the next SETUP packet, or an OUT data or
+  *         status stage.
+  * @retval None
+  */
+static void prvEp0ArmOut(void)
+{
+  usbcdcOUT(usbcdcEP_CONTROL)->DOEPTSIZ = (3UL << USB_OTG_DOEPTSIZ_STUPCNT_Pos) |
+                                          (1UL << USB_OTG_DOEPTSIZ_PKTCNT_Pos) | usbcdcEP0_SIZE;
+  usbcdcOUT(usbcdcEP_CONTROL)->DOEPCTL |= USB_OTG_DOEPCTL_EPENA | USB_OTG_DOEPCTL_CNAK;
+}
+
+/**
+  * @brief  Refuse the request; the stall clears at the next SETUP packet.
+  * @retval None
+  */
+static void prvEp0Stall(void)
+{
+  usbcdcIN(usbcdcEP_CONTROL)->DIEPCTL |= USB_OTG_DIEPCTL_STALL;
+  usbcdcOUT(usbcdcEP_CONTROL)->DOEPCTL |= USB_OTG_DOEPCTL_STALL;
+}
+
+/**
+  * @brief  Program an IN transfer and let the FIFO empty interrupt feed it.
+  * @param  ulEp      Endpoint 0 or 1.
+  * @param  pucData   Bytes to send, which stay valid until in the FIFO.
+  * @param  ulLength  Their number, 0 for a zero length packet.
+  * @retval None
+  */
+static void prvInStart(uint32_t ulEp, const uint8_t *pucData, uint32_t ulLength)
+{
+  uint32_t ulPackets;
+
+  ulPackets = (ulLength == 0U) ? 1U : ((ulLength + usbcdcPACKET_SIZE - 1U) / usbcdcPACKET_SIZE);
+
+  xIn[ulEp].pucData = pucData;
+  xIn[ulEp].ulLeft = ulLength;
+
+  usbcdcIN(ulEp)->DIEPTSIZ = (ulPackets << USB_OTG_DIEPTSIZ_PKTCNT_Pos) | ulLength;
+  usbcdcIN(ulEp)->DIEPCTL |= USB_OTG_DIEPCTL_EPENA | USB_OTG_DIEPCTL_CNAK;
+
+  if (ulLength != 0U)
+  {
+    usbcdcDEVICE->DIEPEMPMSK |= 1UL << ulEp;
+  }
+}
+
+/**
+  * @brief  Write whole packets of the transfer while the FIFO has room for
+  *         them, and stop the FIFO empty interrupt once all are in.
+  * @param  ulEp Endpoint 0 or 1.
+  * @retval None
+  */
+static void prvInFill(uint32_t ulEp)
+{
+  UsbCdcIn_t *pxIn = &xIn[ulEp];
+  uint32_t ulPacket;
+
+  while (pxIn->ulLeft != 0U)
+  {
+    ulPacket = (pxIn->ulLeft < usbcdcPACKET_SIZE) ? pxIn->ulLeft : usbcdcPACKET_SIZE;
+    if ((usbcdcIN(ulEp)->DTXFSTS & USB_OTG_DTXFSTS_INEPTFSAV) < ((ulPacket + 3U) / 4U))
+    {
+      break;
+    }
+
+    prvFifoWrite(ulEp, pxIn->pucData, ulPacket);
+    pxIn->pucData += ulPacket;
+    pxIn->ulLeft -= ulPacket;
+
+    if (ulEp == usbcdcEP_DATA)
+    {
+      ulTail += ulPacket;
+    }
+  }
+
+  if (pxIn->ulLeft == 0U)
+  {
+    usbcdcDEVICE->DIEPEMPMSK &= ~(1UL << ulEp);
+  }
+}
+
+/**
+  * @brief  Start a bulk IN transfer of the bytes pending up to the end of the
+  *         ring, if the host can take them and none is running.
+  * @note   Called with the interrupts masked, or from the USB interrupt.
+  * @retval None
+  */
+static void prvBulkStart(void)
+{
+  uint32_t ulOffset;
+  uint32_t ulLength;
+
+  if ((xConfigured == pdFALSE) || (xBulkBusy != pdFALSE) || (ulHead == ulTail))
+  {
+    return;
+  }
+
+  ulOffset = ulTail & (usbcdcRING_SIZE - 1U);
+  ulLength = ulHead - ulTail;
+
+  if (ulLength > (usbcdcRING_SIZE - ulOffset))
+  {
+    ulLength = usbcdcRING_SIZE - ulOffset;
+  }
+  if (ulLength > usbcdcMAX_TRANSFER)
+  {
+    ulLength = usbcdcMAX_TRANSFER;
+  }
+
+  xBulkBusy = pdTRUE;
+  ulBulkLength = ulLength;
+  prvInStart(usbcdcEP_DATA, &ucRing[ulOffset], ulLength);
+}
+
+/**
+  * @brief  A bulk IN transfer completed: end it with a zero length packet if
+  *         the host would otherwise wait for more, or start the next one.
+  * @retval None
+  */
+static void prvBulkDone(void)
+{
+  xBulkBusy = pdFALSE;
+
+  if ((ulBulkLength != 0U) && ((ulBulkLength % usbcdcPACKET_SIZE) == 0U) && (ulHead == ulTail))
+  {
+    xBulkBusy = pdTRUE;
+    ulBulkLength = 0U;
+    prvInStart(usbcdcEP_DATA, NULL, 0U);
+    return;
+  }
+
+  prvBulkStart();
+}
+
+/**
+  * @brief  Push bytes into an endpoint's transmit FIFO a word at a time.
+  * @retval None
+  */
+static void prvFifoWrite(uint32_t ulEp, const uint8_t *pucData, uint32_t ulLength)
+{
+  __IO uint32_t *pulFifo = &usbcdcFIFO(ulEp);
+  uint32_t ulWord;
+  uint32_t ulIndex;
+
+  while (ulLength >= 4U)
+  {
+    *pulFifo = __UNALIGNED_UINT32_READ(pucData);
+    pucData += 4;
+    ulLength -= 4U;
+  }
+
+  if (ulLength != 0U)
+  {
+    ulWord = 0U;
+    for (ulIndex = 0U; ulIndex < ulLength; ulIndex++)
+    {
+      ulWord |= (uint32_t) pucData[ulIndex] << (8U * ulIndex);
+    }
+    *pulFifo = ulWord;
+  }
+}
+
+/**
+  * @brief  Pop bytes from the receive FIFO a word at a time.
+  * @param  pucData  Where to put them, or NULL to drop them.
+  * @param  ulLength Their number.
+  * @retval None
+  */
+static void prvFifoRead(uint8_t *pucData, uint32_t ulLength)
+{
+  __IO uint32_t *pulFifo = &usbcdcFIFO(0U);
+  uint32_t ulWord;
+  uint32_t ulIndex;
+
+  while (ulLength != 0U)
+  {
+    ulWord = *pulFifo;
+    for (ulIndex = 0U; (ulIndex < 4U) && (ulLength != 0U); ulIndex++)
+    {
+      if (pucData != NULL)
+      {
+        *pucData++ = (uint8_t) (ulWord >> (8U * ulIndex));
+      }
+      ulLength--;
+    }
+  }
+}
+
+/**
+  * @brief  Build a string descriptor in ucEp0Buffer: 0 the language, 1 and 2
+  *         from pcStrings, 3 the serial number from the device ID.
+  * @param  ucIndex String index.
+  * @retval Its length, or 0 for no such string.
+  */
+static uint32_t prvStringDescriptor(uint8_t ucIndex)
+{
+  const char *pcString;
+  uint32_t ulLength = 2U;
+
+  if (ucIndex == 0U)
+  {
+    /* English (US). */
+    ucEp0Buffer[2] = 0x09U;
+    ucEp0Buffer[3] = 0x04U;
+    ulLength = 4U;
+  }
+  else
+  {
+    if (ucIndex <= (sizeof(pcStrings) / sizeof(pcStrings[0])))
+    {
+      pcString = pcStrings[ucIndex - 1U];
+    }
+    else if (ucIndex == 3U)
+    {
+      pcString = cSerial;
+    }
+    else
+    {
+      return 0U;
+    }
+
+    while ((*pcString != '\0') && (ulLength < sizeof(ucEp0Buffer)))
+    {
+      ucEp0Buffer[ulLength++] = (uint8_t) *pcString++;
+      ucEp0Buffer[ulLength++] = 0U;
+    }
+  }
+
+  ucEp0Buffer[0] = (uint8_t) ulLength;
+  ucEp0Buffer[1] = usbcdcDESC_STRING;
+
+  return ulLength;
+}
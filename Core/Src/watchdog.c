@@ -0,0 +1,186 @@
+/**
+  ******************************************************************************
+  * @file           : watchdog.c
+  * @brief          : IWDG supervisor task and the heartbeat list it checks.
+  ******************************************************************************
+  * The IWDG is driven through its registers; it has no HAL driver in this
+  * tree.  Heartbeats form a singly linked list guarded by a critical
+  * section, short enough to walk whole inside one.  A beat is one store of
+  * the tick count, so vWatchdogBeat() takes no lock.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "watchdog.h"
+#include "crashlog.h"
+#include "fmt.h"
+#include "taskreg.h"
+
+#if (watchdogENABLE == 1)
+
+/* Private define ------------------------------------------------------------*/
+
+/* Key register values. */
+#define watchdogKEY_ACCESS          0x5555U
+#define watchdogKEY_RELOAD          0xAAAAU
+#define watchdogKEY_START           0xCCCCU
+
+/* LSI divided by 64, a 2 ms count at 32 kHz. */
+#define watchdogPRESCALER           4U
+#define watchdogRELOAD              ((watchdogTIMEOUT_MS * 32U) / 64U)
+
+#if (watchdogRELOAD > 0xFFFU) || ((watchdogPERIOD_MS * 2U) > watchdogTIMEOUT_MS)
+#error watchdogTIMEOUT_MS must be under 8 s and at least twice watchdogPERIOD_MS
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static WatchdogHeartbeat_t *pxHeartbeats = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvWatchdogTask(void *pvParameters);
+static void prvIwdgStart(void);
+static WatchdogHeartbeat_t *prvFindLate(TickType_t *pxSilent);
+
+/* Registered tasks ----------------------------------------------------------*/
+TASK_REGISTER_IN(CCM, WDOG, prvWatchdogTask, NULL, 160, configMAX_PRIORITIES - 1);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Start watching a heartbeat, counting it as just beaten.
+  * @param  pxHeartbeat Caller owned, not registered already.
+  * @param  pcName      Name for the crash log, kept by reference.
+  * @param  xDeadline   Longest time allowed between beats, in ticks, which
+  *                     should leave room for watchdogPERIOD_MS of lateness
+  *                     in noticing.
+  * @retval None
+  */
+void vWatchdogRegister(WatchdogHeartbeat_t *pxHeartbeat, const char *pcName, TickType_t xDeadline)
+{
+  pxHeartbeat->pcName = pcName;
+  pxHeartbeat->xDeadline = xDeadline;
+  pxHeartbeat->xLastBeat = xTaskGetTickCount();
+
+  taskENTER_CRITICAL();
+  pxHeartbeat->pxNext = pxHeartbeats;
+  pxHeartbeats = pxHeartbeat;
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Stop watching a heartbeat, before its task blocks for good or is
+  *         deleted.
+  * @retval None
+  */
+void vWatchdogUnregister(WatchdogHeartbeat_t *pxHeartbeat)
+{
+  WatchdogHeartbeat_t **ppxLink;
+
+  taskENTER_CRITICAL();
+  for (ppxLink = &pxHeartbeats; *ppxLink != NULL; ppxLink = &(*ppxLink)->pxNext)
+  {
+    if (*ppxLink == pxHeartbeat)
+    {
+      *ppxLink = pxHeartbeat->pxNext;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  Report that the heartbeat's owner is making progress.
+  * @note   Call from a task.
+  * @retval None
+  */
+void vWatchdogBeat(WatchdogHeartbeat_t *pxHeartbeat)
+{
+  pxHeartbeat->xLastBeat = xTaskGetTickCount();
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Start the IWDG, then feed it every period while all heartbeats
+  *         are on time.
+  * @param  pvParameters Unused.
+  * @retval None
+  */
+static void prvWatchdogTask(void *pvParameters)
+{
+  WatchdogHeartbeat_t *pxLate;
+  TickType_t xLastWake;
+  TickType_t xSilent;
+  char cLine[64];
+  size_t xLength;
+
+  (void) pvParameters;
+
+  prvIwdgStart();
+  xLastWake = xTaskGetTickCount();
+
+  for (;;)
+  {
+    pxLate = prvFindLate(&xSilent);
+    if (pxLate != NULL)
+    {
+      xLength = xFmtFormat(cLine, sizeof(cLine), "watchdog: %s silent %lu ms, deadline %lu ms\n\r",
+                           pxLate->pcName, (unsigned long) (xSilent * portTICK_PERIOD_MS),
+                           (unsigned long) (pxLate->xDeadline * portTICK_PERIOD_MS));
+      vCrashLogAppend(cLine, xLength);
+      vCrashLogPanic(crashlogREASON_WATCHDOG, (uint32_t) pxLate);
+    }
+
+    IWDG->KR = watchdogKEY_RELOAD;
+    vTaskDelayUntil(&xLastWake, pdMS_TO_TICKS(watchdogPERIOD_MS));
+  }
+}
+
+/**
+  * @brief  Set the timeout and start the IWDG, which then cannot be stopped
+  *         short of a reset.
+  * @retval None
+  */
+static void prvIwdgStart(void)
+{
+  DBGMCU->APB1FZ |= DBGMCU_APB1_FZ_DBG_IWDG_STOP;
+
+  IWDG->KR = watchdogKEY_START;
+  IWDG->KR = watchdogKEY_ACCESS;
+  IWDG->PR = watchdogPRESCALER;
+  IWDG->RLR = watchdogRELOAD;
+  while (IWDG->SR != 0U)
+  {
+  }
+  IWDG->KR = watchdogKEY_RELOAD;
+}
+
+/**
+  * @brief  First heartbeat past its deadline.
+  * @param  pxSilent Set to how long it has been silent.
+  * @retval The heartbeat, or NULL if all are on time.
+  */
+static WatchdogHeartbeat_t *prvFindLate(TickType_t *pxSilent)
+{
+  WatchdogHeartbeat_t *pxHeartbeat;
+  TickType_t xNow;
+
+  taskENTER_CRITICAL();
+  xNow = xTaskGetTickCount();
+  for (pxHeartbeat = pxHeartbeats; pxHeartbeat != NULL; pxHeartbeat = pxHeartbeat->pxNext)
+  {
+    *pxSilent = xNow - pxHeartbeat->xLastBeat;
+    if (*pxSilent > pxHeartbeat->xDeadline)
+    {
+      break;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  return pxHeartbeat;
+}
+
+#endif /* watchdogENABLE */
@@ -0,0 +1,410 @@
+/**
+  ******************************************************************************
+  * @file           : workerpool.c
+  * @brief          : A few worker tasks, created once at boot, that run
+  *                   short jobs from prioritised lanes.
+  ******************************************************************************
+  * Each worker has a ring of jobs per lane.  Its owner takes from the front,
+  * oldest first, and a thief from the back, the job the owner would reach
+  * last.  The rings are only touched inside critical sections of a few
+  * dozen instructions, which interrupts share through the FromISR variant.
+  *
+  * Workers sleep on their task notification rather than on a shared queue.
+  * A worker that finds nothing marks itself idle in the same critical
+  * section, and a submission clears the mark of the one worker it wakes, so
+  * no wake is lost and no worker is woken twice.  A counting semaphore per
+  * lane counts its free slots, and is what a submitter waits on when the
+  * lane is full; holding a slot guarantees some worker's ring has room.
+  *
+  * The workers are registered tasks, started with the others by
+  * vTaskRegistryStart(), after xWorkerPoolInit() has made the semaphores.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "workerpool.h"
+#include "semphr.h"
+#include "taskreg.h"
+
+#if (workerpoolWORKERS < 1U) || (workerpoolWORKERS > 3U)
+#error workerpoolWORKERS must be 1 to 3
+#endif
+
+#if (workerpoolDEQUE_LENGTH < 1U) || (workerpoolDEQUE_LENGTH > 255U)
+#error workerpoolDEQUE_LENGTH must be 1 to 255
+#endif
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  WorkerPoolFunction_t pxFunction;
+  void *pvArg;
+} WorkerPoolJob_t;
+
+/* One worker's jobs in one lane. */
+typedef struct
+{
+  WorkerPoolJob_t xJobs[workerpoolDEQUE_LENGTH];
+  uint8_t ucFront;
+  uint8_t ucCount;
+} WorkerPoolDeque_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/* No worker, as returned by prvCurrentWorker() and prvSubmit(). */
+#define workerpoolNONE              workerpoolWORKERS
+
+/* Private variables ---------------------------------------------------------*/
+static WorkerPoolDeque_t xDeques[workerpoolWORKERS][workerpoolLANES];
+
+static StaticSemaphore_t xSlotsBuffer[workerpoolLANES];
+static SemaphoreHandle_t xSlots[workerpoolLANES] = { NULL };
+
+/* Bit n set while worker n sleeps or is about to. */
+static UBaseType_t uxIdle = 0U;
+
+/* Where the next job from outside the pool goes when no worker is idle. */
+static UBaseType_t uxNextWorker = 0U;
+
+static volatile uint32_t ulSteals = 0U;
+
+/* Private function prototypes -----------------------------------------------*/
+static void prvWorkerTask(void *pvParameters);
+static UBaseType_t prvCurrentWorker(void);
+static UBaseType_t prvSubmit(WorkerPoolLane_t eLane, WorkerPoolFunction_t pxFunction, void *pvArg,
+                             UBaseType_t uxSelf);
+static BaseType_t prvTakeJob(UBaseType_t uxWorker, WorkerPoolJob_t *pxJob, WorkerPoolLane_t *peLane);
+
+/* Registered tasks ----------------------------------------------------------*/
+TASK_REGISTER_IN(CCM, WORKER0, prvWorkerTask, (void *) 0U, workerpoolSTACK_DEPTH, workerpoolPRIORITY);
+#if (workerpoolWORKERS > 1U)
+TASK_REGISTER_IN(CCM, WORKER1, prvWorkerTask, (void *) 1U, workerpoolSTACK_DEPTH, workerpoolPRIORITY);
+#endif
+#if (workerpoolWORKERS > 2U)
+TASK_REGISTER_IN(CCM, WORKER2, prvWorkerTask, (void *) 2U, workerpoolSTACK_DEPTH, workerpoolPRIORITY);
+#endif
+
+static TaskHandle_t *const pxWorkerHandles[workerpoolWORKERS] =
+{
+  &xWORKER0Handle,
+#if (workerpoolWORKERS > 1U)
+  &xWORKER1Handle,
+#endif
+#if (workerpoolWORKERS > 2U)
+  &xWORKER2Handle,
+#endif
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Make the lanes' slot counts.  Call once, before
+  *         vTaskRegistryStart().
+  * @retval pdPASS.
+  */
+BaseType_t xWorkerPoolInit(void)
+{
+  UBaseType_t uxLane;
+
+  for (uxLane = 0U; uxLane < workerpoolLANES; uxLane++)
+  {
+    xSlots[uxLane] = xSemaphoreCreateCountingStatic(workerpoolWORKERS * workerpoolDEQUE_LENGTH,
+                                                    workerpoolWORKERS * workerpoolDEQUE_LENGTH,
+                                                    &xSlotsBuffer[uxLane]);
+    configASSERT(xSlots[uxLane] != NULL);
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Queue a job in a lane for a worker.
+  * @param  eLane        Lane, which orders it against other jobs.
+  * @param  pxFunction   Called with pvArg in a worker task.
+  * @param  pvArg        Must stay valid until the job has run.
+  * @param  xTicksToWait Time to wait for room in the lane.
+  * @note   May be called before the scheduler starts, with no wait, and
+  *         from a job, which keeps the new job on its own worker.
+  * @retval pdPASS, or pdFAIL if the lane stayed full.
+  */
+BaseType_t xWorkerPoolSubmitLane(WorkerPoolLane_t eLane, WorkerPoolFunction_t pxFunction, void *pvArg,
+                                 TickType_t xTicksToWait)
+{
+  UBaseType_t uxWake;
+  UBaseType_t uxSelf;
+
+  configASSERT(((UBaseType_t) eLane < workerpoolLANES) && (xSlots[eLane] != NULL) && (pxFunction != NULL));
+
+  if (xSemaphoreTake(xSlots[eLane], xTicksToWait) != pdTRUE)
+  {
+    return pdFAIL;
+  }
+
+  uxSelf = prvCurrentWorker();
+
+  taskENTER_CRITICAL();
+  uxWake = prvSubmit(eLane, pxFunction, pvArg, uxSelf);
+  taskEXIT_CRITICAL();
+
+  if ((uxWake != workerpoolNONE) && (*pxWorkerHandles[uxWake] != NULL))
+  {
+    xTaskNotifyGive(*pxWorkerHandles[uxWake]);
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Queue a job in a lane from an interrupt, for work too long for
+  *         the handler.
+  * @param  pxHigherPriorityTaskWoken Set if a worker should run on exit.
+  * @retval pdPASS, or pdFAIL if the lane was full.
+  */
+BaseType_t xWorkerPoolSubmitLaneFromISR(WorkerPoolLane_t eLane, WorkerPoolFunction_t pxFunction, void *pvArg,
+                                        BaseType_t *pxHigherPriorityTaskWoken)
+{
+  UBaseType_t uxWake;
+  UBaseType_t uxSaved;
+
+  configASSERT(((UBaseType_t) eLane < workerpoolLANES) && (xSlots[eLane] != NULL) && (pxFunction != NULL));
+
+  if (xSemaphoreTakeFromISR(xSlots[eLane], NULL) != pdTRUE)
+  {
+    return pdFAIL;
+  }
+
+  uxSaved = taskENTER_CRITICAL_FROM_ISR();
+  uxWake = prvSubmit(eLane, pxFunction, pvArg, workerpoolNONE);
+  taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+
+  if ((uxWake != workerpoolNONE) && (*pxWorkerHandles[uxWake] != NULL))
+  {
+    vTaskNotifyGiveFromISR(*pxWorkerHandles[uxWake], pxHigherPriorityTaskWoken);
+  }
+
+  return pdPASS;
+}
+
+/**
+  * @brief  Jobs submitted but not yet taken by a worker, over all lanes.
+  * @retval The count.
+  */
+UBaseType_t uxWorkerPoolPending(void)
+{
+  UBaseType_t uxWorker;
+  UBaseType_t uxLane;
+  UBaseType_t uxPending = 0U;
+
+  taskENTER_CRITICAL();
+  for (uxWorker = 0U; uxWorker < workerpoolWORKERS; uxWorker++)
+  {
+    for (uxLane = 0U; uxLane < workerpoolLANES; uxLane++)
+    {
+      uxPending += xDeques[uxWorker][uxLane].ucCount;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  return uxPending;
+}
+
+/**
+  * @brief  Jobs a worker has taken from another's deque since boot.
+  * @retval The count.
+  */
+uint32_t ulWorkerPoolSteals(void)
+{
+  return ulSteals;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Run jobs as they arrive, one at a time, sleeping when there are
+  *         none.
+  * @param  pvParameters The worker's index.
+  * @retval None
+  */
+static void prvWorkerTask(void *pvParameters)
+{
+  UBaseType_t uxWorker = (UBaseType_t) pvParameters;
+  WorkerPoolJob_t xJob;
+  WorkerPoolLane_t eLane;
+
+  configASSERT(xSlots[0] != NULL);
+
+  for (;;)
+  {
+    if (prvTakeJob(uxWorker, &xJob, &eLane) != pdFALSE)
+    {
+      (void) xSemaphoreGive(xSlots[eLane]);
+      xJob.pxFunction(xJob.pvArg);
+    }
+    else
+    {
+      (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+  }
+}
+
+/**
+  * @brief  The worker the caller is, if it is one.
+  * @retval Its index, or workerpoolNONE.
+  */
+static UBaseType_t prvCurrentWorker(void)
+{
+  TaskHandle_t xCurrent;
+  UBaseType_t uxWorker;
+
+  if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+  {
+    return workerpoolNONE;
+  }
+
+  xCurrent = xTaskGetCurrentTaskHandle();
+  for (uxWorker = 0U; uxWorker < workerpoolWORKERS; uxWorker++)
+  {
+    if (*pxWorkerHandles[uxWorker] == xCurrent)
+    {
+      break;
+    }
+  }
+
+  return uxWorker;
+}
+
+/**
+  * @brief  Put a job in some worker's deque, the caller holding a slot of
+  *         the lane.
+  * @param  uxSelf The submitting worker, or workerpoolNONE.
+  * @note   Call inside a critical section.
+  * @retval The worker to wake, its idle mark cleared, or workerpoolNONE.
+  */
+static UBaseType_t prvSubmit(WorkerPoolLane_t eLane, WorkerPoolFunction_t pxFunction, void *pvArg,
+                             UBaseType_t uxSelf)
+{
+  WorkerPoolDeque_t *pxDeque;
+  UBaseType_t uxTarget;
+  UBaseType_t uxWake = workerpoolNONE;
+  UBaseType_t uxTries;
+  UBaseType_t uxSlot;
+
+  /* Keep a job's children with it, else prefer a worker that is asleep. */
+  if (uxSelf != workerpoolNONE)
+  {
+    uxTarget = uxSelf;
+  }
+  else if (uxIdle != 0U)
+  {
+    for (uxTarget = 0U; (uxIdle & (1U << uxTarget)) == 0U; uxTarget++)
+    {
+    }
+  }
+  else
+  {
+    uxTarget = uxNextWorker;
+    uxNextWorker = (uxNextWorker + 1U) % workerpoolWORKERS;
+  }
+
+  /* The slot held means some deque of the lane has room. */
+  for (uxTries = 0U; uxTries < workerpoolWORKERS; uxTries++)
+  {
+    pxDeque = &xDeques[uxTarget][eLane];
+    if (pxDeque->ucCount < workerpoolDEQUE_LENGTH)
+    {
+      break;
+    }
+    uxTarget = (uxTarget + 1U) % workerpoolWORKERS;
+  }
+  configASSERT(uxTries < workerpoolWORKERS);
+
+  uxSlot = (pxDeque->ucFront + pxDeque->ucCount) % workerpoolDEQUE_LENGTH;
+  pxDeque->xJobs[uxSlot].pxFunction = pxFunction;
+  pxDeque->xJobs[uxSlot].pvArg = pvArg;
+  pxDeque->ucCount++;
+
+  /* One wake at most: the owner if it sleeps, else any sleeper, which will
+     steal the job.  A worker submitting to itself finds the job next. */
+  if (uxTarget != uxSelf)
+  {
+    if ((uxIdle & (1U << uxTarget)) != 0U)
+    {
+      uxWake = uxTarget;
+    }
+    else if (uxIdle != 0U)
+    {
+      for (uxWake = 0U; (uxIdle & (1U << uxWake)) == 0U; uxWake++)
+      {
+      }
+    }
+    else
+    {
+      /* Every worker is busy and will look again when done. */
+    }
+
+    if (uxWake != workerpoolNONE)
+    {
+      uxIdle &= ~(1U << uxWake);
+    }
+  }
+
+  return uxWake;
+}
+
+/**
+  * @brief  Take the next job for a worker: highest lane first, its own
+  *         deque before the others', or else mark it idle.
+  * @retval pdTRUE with the job and its lane, or pdFALSE if there was none.
+  */
+static BaseType_t prvTakeJob(UBaseType_t uxWorker, WorkerPoolJob_t *pxJob, WorkerPoolLane_t *peLane)
+{
+  WorkerPoolDeque_t *pxDeque;
+  UBaseType_t uxLane;
+  UBaseType_t uxVictim;
+  UBaseType_t uxTries;
+  BaseType_t xFound = pdFALSE;
+
+  taskENTER_CRITICAL();
+  for (uxLane = 0U; (uxLane < workerpoolLANES) && (xFound == pdFALSE); uxLane++)
+  {
+    pxDeque = &xDeques[uxWorker][uxLane];
+    if (pxDeque->ucCount != 0U)
+    {
+      *pxJob = pxDeque->xJobs[pxDeque->ucFront];
+      pxDeque->ucFront = (uint8_t) ((pxDeque->ucFront + 1U) % workerpoolDEQUE_LENGTH);
+      pxDeque->ucCount--;
+      xFound = pdTRUE;
+    }
+
+    uxVictim = uxWorker;
+    for (uxTries = 1U; (uxTries < workerpoolWORKERS) && (xFound == pdFALSE); uxTries++)
+    {
+      uxVictim = (uxVictim + 1U) % workerpoolWORKERS;
+      pxDeque = &xDeques[uxVictim][uxLane];
+      if (pxDeque->ucCount != 0U)
+      {
+        pxDeque->ucCount--;
+        *pxJob = pxDeque->xJobs[(pxDeque->ucFront + pxDeque->ucCount) % workerpoolDEQUE_LENGTH];
+        ulSteals++;
+        xFound = pdTRUE;
+      }
+    }
+
+    if (xFound != pdFALSE)
+    {
+      *peLane = (WorkerPoolLane_t) uxLane;
+    }
+  }
+
+  if (xFound != pdFALSE)
+  {
+    uxIdle &= ~(1U << uxWorker);
+  }
+  else
+  {
+    uxIdle |= (1U << uxWorker);
+  }
+  taskEXIT_CRITICAL();
+
+  return xFound;
+}
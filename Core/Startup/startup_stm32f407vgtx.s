@@ -60,46 +60,149 @@ defined in linker script */
 Reset_Handler:  
   ldr   sp, =_estack     /* set stack pointer */
 
+/* Start the DWT cycle counter so that the phases below can be timed, see
+   BootPhase_t in boottime.h.  vDwtInit() later finds it running and leaves it alone. */
+  ldr r0, =0xE000EDFC    /* CoreDebug->DEMCR */
+  ldr r1, [r0]
+  orr r1, r1, #0x01000000 /* TRCENA */
+  str r1, [r0]
+  ldr r0, =0xE0001000    /* DWT->CTRL */
+  movs r1, #0
+  str r1, [r0, #4]       /* DWT->CYCCNT */
+  ldr r1, [r0]
+  orr r1, r1, #1         /* CYCCNTENA */
+  str r1, [r0]
+
+/* Turn on the flash prefetch and caches before the copies read from flash;
+   zero wait states are right for the 16 MHz HSI the core resets to. */
+  ldr r0, =0x40023C00    /* FLASH->ACR */
+  ldr r1, [r0]
+  orr r1, r1, #0x700     /* PRFTEN | ICEN | DCEN */
+  str r1, [r0]
+
 /* Copy the data segment initializers from flash to SRAM */  
   ldr r0, =_sdata
   ldr r1, =_edata
   ldr r2, =_sidata
-  movs r3, #0
-  b LoopCopyDataInit
-
-CopyDataInit:
-  ldr r4, [r2, r3]
-  str r4, [r0, r3]
-  adds r3, r3, #4
+  bl  BlockCopy
 
-LoopCopyDataInit:
-  adds r4, r0, r3
-  cmp r4, r1
-  bcc CopyDataInit
+/* Copy the ccmram segment initializers from flash to CCM */
+  ldr r0, =_sccmram
+  ldr r1, =_eccmram
+  ldr r2, =_siccmram
+  bl  BlockCopy
+  movs r0, #0
+  bl  StampStartup
   
-/* Zero fill the bss segment. */
-  ldr r2, =_sbss
-  ldr r4, =_ebss
-  movs r3, #0
-  b LoopFillZerobss
+/* Zero fill the bss segment.  .noinit and .ccmbss are left as they are. */
+  ldr r0, =_sbss
+  ldr r1, =_ebss
+  bl  BlockZero
+  movs r0, #4
+  bl  StampStartup
 
-FillZerobss:
-  str  r3, [r2]
-  adds r2, r2, #4
-
-LoopFillZerobss:
-  cmp r2, r4
-  bcc FillZerobss
+/* Paint the main stack with stackcheckMSP_FILL.  Nothing has been pushed on it
+   yet, so all of it, up to sp at _estack. */
+  ldr r0, =_sstack
+  ldr r1, =_estack
+  ldr r4, =0xA5A5A5A5
+  bl  BlockFill
 
 /* Call the clock system initialization function.*/
   bl  SystemInit   
 /* Call static constructors */
     bl __libc_init_array
+  movs r0, #8
+  bl  StampStartup
 /* Call the application's entry point.*/
   bl  main
   bx  lr    
 .size  Reset_Handler, .-Reset_Handler
 
+/**
+ * @brief  Copy words from r2 to r0 up to r1, 16 bytes at a time with LDM/STM
+ *         and the remainder a word at a time.  The linker script aligns
+ *         every section bound to 4.
+ * @param  r0 Destination start, r1 destination end, r2 source start.
+ * @retval None; clobbers r0 to r7.
+*/
+    .section  .text.Reset_Handler
+  .type  BlockCopy, %function
+BlockCopy:
+  subs r3, r1, r0
+  bic  r3, r3, #15
+  adds r3, r3, r0        /* end of the whole 16 byte blocks */
+  b    LoopBlockCopy
+BlockCopy16:
+  ldmia r2!, {r4-r7}
+  stmia r0!, {r4-r7}
+LoopBlockCopy:
+  cmp  r0, r3
+  bcc  BlockCopy16
+  b    LoopWordCopy
+WordCopy:
+  ldr  r4, [r2], #4
+  str  r4, [r0], #4
+LoopWordCopy:
+  cmp  r0, r1
+  bcc  WordCopy
+  bx   lr
+.size  BlockCopy, .-BlockCopy
+
+/**
+ * @brief  Zero words from r0 up to r1 in the same way as BlockCopy.
+ * @param  r0 Start, r1 end.
+ * @retval None; clobbers r0 and r3 to r7.
+*/
+  .type  BlockZero, %function
+BlockZero:
+  movs r4, #0
+  b    BlockFill
+.size  BlockZero, .-BlockZero
+
+/**
+ * @brief  Fill words from r0 up to r1 with r4 in the same way as BlockCopy.
+ * @param  r0 Start, r1 end, r4 the word to store.
+ * @retval None; clobbers r0 and r3 to r7.
+*/
+  .type  BlockFill, %function
+BlockFill:
+  mov  r5, r4
+  mov  r6, r4
+  mov  r7, r4
+  subs r3, r1, r0
+  bic  r3, r3, #15
+  adds r3, r3, r0
+  b    LoopBlockFill
+BlockFill16:
+  stmia r0!, {r4-r7}
+LoopBlockFill:
+  cmp  r0, r3
+  bcc  BlockFill16
+  b    LoopWordFill
+WordFill:
+  str  r4, [r0], #4
+LoopWordFill:
+  cmp  r0, r1
+  bcc  WordFill
+  bx   lr
+.size  BlockFill, .-BlockFill
+
+/**
+ * @brief  Store DWT->CYCCNT at byte offset r0 of ulBootTraceCycles[], which
+ *         lives in .noinit and so survives the bss fill.
+ * @param  r0 Byte offset of the stamp.
+ * @retval None; clobbers r1 and r2.
+*/
+  .type  StampStartup, %function
+StampStartup:
+  ldr  r1, =0xE0001004   /* DWT->CYCCNT */
+  ldr  r1, [r1]
+  ldr  r2, =ulBootTraceCycles
+  str  r1, [r2, r0]
+  bx   lr
+.size  StampStartup, .-StampStartup
+
 /**
  * @brief  This is the code that gets called when the processor receives an 
  *         unexpected interrupt.  This simply enters an infinite loop, preserving
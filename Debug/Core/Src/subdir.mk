@@ -5,31 +5,157 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../Core/Src/accel.c \
+../Core/Src/audio.c \
+../Core/Src/binlog.c \
+../Core/Src/boottime.c \
+../Core/Src/button.c \
+../Core/Src/clockprofile.c \
+../Core/Src/cpustats.c \
+../Core/Src/crashlog.c \
+../Core/Src/crc.c \
+../Core/Src/deferred.c \
+../Core/Src/dmabuf.c \
+../Core/Src/dmacopy.c \
+../Core/Src/fault.c \
+../Core/Src/fmt.c \
+../Core/Src/future.c \
+../Core/Src/governor.c \
+../Core/Src/heapbench.c \
+../Core/Src/irqlat.c \
+../Core/Src/itm.c \
+../Core/Src/kernbench.c \
+../Core/Src/led.c \
+../Core/Src/log.c \
+../Core/Src/lowpower.c \
+../Core/Src/mailbox.c \
 ../Core/Src/main.c \
+../Core/Src/mic.c \
+../Core/Src/microjob.c \
+../Core/Src/newlibheap.c \
+../Core/Src/notifysem.c \
+../Core/Src/periodic.c \
+../Core/Src/pinmux.c \
+../Core/Src/pipeline.c \
+../Core/Src/profiler.c \
+../Core/Src/shell.c \
+../Core/Src/stackcheck.c \
 ../Core/Src/stm32f4xx_hal_msp.c \
-../Core/Src/stm32f4xx_hal_timebase_tim.c \
 ../Core/Src/stm32f4xx_it.c \
 ../Core/Src/syscalls.c \
 ../Core/Src/sysmem.c \
-../Core/Src/system_stm32f4xx.c 
+../Core/Src/system_stm32f4xx.c \
+../Core/Src/taskreg.c \
+../Core/Src/timebase.c \
+../Core/Src/trace.c \
+../Core/Src/uartline.c \
+../Core/Src/uartrx.c \
+../Core/Src/uarttx.c \
+../Core/Src/usbcdc.c \
+../Core/Src/watchdog.c \
+../Core/Src/workerpool.c 
 
 OBJS += \
+./Core/Src/accel.o \
+./Core/Src/audio.o \
+./Core/Src/binlog.o \
+./Core/Src/boottime.o \
+./Core/Src/button.o \
+./Core/Src/clockprofile.o \
+./Core/Src/cpustats.o \
+./Core/Src/crashlog.o \
+./Core/Src/crc.o \
+./Core/Src/deferred.o \
+./Core/Src/dmabuf.o \
+./Core/Src/dmacopy.o \
+./Core/Src/fault.o \
+./Core/Src/fmt.o \
+./Core/Src/future.o \
+./Core/Src/governor.o \
+./Core/Src/heapbench.o \
+./Core/Src/irqlat.o \
+./Core/Src/itm.o \
+./Core/Src/kernbench.o \
+./Core/Src/led.o \
+./Core/Src/log.o \
+./Core/Src/lowpower.o \
+./Core/Src/mailbox.o \
 ./Core/Src/main.o \
+./Core/Src/mic.o \
+./Core/Src/microjob.o \
+./Core/Src/newlibheap.o \
+./Core/Src/notifysem.o \
+./Core/Src/periodic.o \
+./Core/Src/pinmux.o \
+./Core/Src/pipeline.o \
+./Core/Src/profiler.o \
+./Core/Src/shell.o \
+./Core/Src/stackcheck.o \
 ./Core/Src/stm32f4xx_hal_msp.o \
-./Core/Src/stm32f4xx_hal_timebase_tim.o \
 ./Core/Src/stm32f4xx_it.o \
 ./Core/Src/syscalls.o \
 ./Core/Src/sysmem.o \
-./Core/Src/system_stm32f4xx.o 
+./Core/Src/system_stm32f4xx.o \
+./Core/Src/taskreg.o \
+./Core/Src/timebase.o \
+./Core/Src/trace.o \
+./Core/Src/uartline.o \
+./Core/Src/uartrx.o \
+./Core/Src/uarttx.o \
+./Core/Src/usbcdc.o \
+./Core/Src/watchdog.o \
+./Core/Src/workerpool.o 
 
 C_DEPS += \
+./Core/Src/accel.d \
+./Core/Src/audio.d \
+./Core/Src/binlog.d \
+./Core/Src/boottime.d \
+./Core/Src/button.d \
+./Core/Src/clockprofile.d \
+./Core/Src/cpustats.d \
+./Core/Src/crashlog.d \
+./Core/Src/crc.d \
+./Core/Src/deferred.d \
+./Core/Src/dmabuf.d \
+./Core/Src/dmacopy.d \
+./Core/Src/fault.d \
+./Core/Src/fmt.d \
+./Core/Src/future.d \
+./Core/Src/governor.d \
+./Core/Src/heapbench.d \
+./Core/Src/irqlat.d \
+./Core/Src/itm.d \
+./Core/Src/kernbench.d \
+./Core/Src/led.d \
+./Core/Src/log.d \
+./Core/Src/lowpower.d \
+./Core/Src/mailbox.d \
 ./Core/Src/main.d \
+./Core/Src/mic.d \
+./Core/Src/microjob.d \
+./Core/Src/newlibheap.d \
+./Core/Src/notifysem.d \
+./Core/Src/periodic.d \
+./Core/Src/pinmux.d \
+./Core/Src/pipeline.d \
+./Core/Src/profiler.d \
+./Core/Src/shell.d \
+./Core/Src/stackcheck.d \
 ./Core/Src/stm32f4xx_hal_msp.d \
-./Core/Src/stm32f4xx_hal_timebase_tim.d \
 ./Core/Src/stm32f4xx_it.d \
 ./Core/Src/syscalls.d \
 ./Core/Src/sysmem.d \
-./Core/Src/system_stm32f4xx.d 
+./Core/Src/system_stm32f4xx.d \
+./Core/Src/taskreg.d \
+./Core/Src/timebase.d \
+./Core/Src/trace.d \
+./Core/Src/uartline.d \
+./Core/Src/uartrx.d \
+./Core/Src/uarttx.d \
+./Core/Src/usbcdc.d \
+./Core/Src/watchdog.d \
+./Core/Src/workerpool.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -39,7 +165,7 @@ Core/Src/%.o Core/Src/%.su Core/Src/%.cyclo: ../Core/Src/%.c Core/Src/subdir.mk
 clean: clean-Core-2f-Src
 
 clean-Core-2f-Src:
-	-$(RM) ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_hal_timebase_tim.cyclo ./Core/Src/stm32f4xx_hal_timebase_tim.d ./Core/Src/stm32f4xx_hal_timebase_tim.o ./Core/Src/stm32f4xx_hal_timebase_tim.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su
+	-$(RM) ./Core/Src/accel.cyclo ./Core/Src/accel.d ./Core/Src/accel.o ./Core/Src/accel.su ./Core/Src/audio.cyclo ./Core/Src/audio.d ./Core/Src/audio.o ./Core/Src/audio.su ./Core/Src/binlog.cyclo ./Core/Src/binlog.d ./Core/Src/binlog.o ./Core/Src/binlog.su ./Core/Src/boottime.cyclo ./Core/Src/boottime.d ./Core/Src/boottime.o ./Core/Src/boottime.su ./Core/Src/button.cyclo ./Core/Src/button.d ./Core/Src/button.o ./Core/Src/button.su ./Core/Src/clockprofile.cyclo ./Core/Src/clockprofile.d ./Core/Src/clockprofile.o ./Core/Src/clockprofile.su ./Core/Src/cpustats.cyclo ./Core/Src/cpustats.d ./Core/Src/cpustats.o ./Core/Src/cpustats.su ./Core/Src/crashlog.cyclo ./Core/Src/crashlog.d ./Core/Src/crashlog.o ./Core/Src/crashlog.su ./Core/Src/crc.cyclo ./Core/Src/crc.d ./Core/Src/crc.o ./Core/Src/crc.su ./Core/Src/deferred.cyclo ./Core/Src/deferred.d ./Core/Src/deferred.o ./Core/Src/deferred.su ./Core/Src/dmabuf.cyclo ./Core/Src/dmabuf.d ./Core/Src/dmabuf.o ./Core/Src/dmabuf.su ./Core/Src/dmacopy.cyclo ./Core/Src/dmacopy.d ./Core/Src/dmacopy.o ./Core/Src/dmacopy.su ./Core/Src/fault.cyclo ./Core/Src/fault.d ./Core/Src/fault.o ./Core/Src/fault.su ./Core/Src/fmt.cyclo ./Core/Src/fmt.d ./Core/Src/fmt.o ./Core/Src/fmt.su ./Core/Src/future.cyclo ./Core/Src/future.d ./Core/Src/future.o ./Core/Src/future.su ./Core/Src/governor.cyclo ./Core/Src/governor.d ./Core/Src/governor.o ./Core/Src/governor.su ./Core/Src/heapbench.cyclo ./Core/Src/heapbench.d ./Core/Src/heapbench.o ./Core/Src/heapbench.su ./Core/Src/irqlat.cyclo ./Core/Src/irqlat.d ./Core/Src/irqlat.o ./Core/Src/irqlat.su ./Core/Src/itm.cyclo ./Core/Src/itm.d ./Core/Src/itm.o ./Core/Src/itm.su ./Core/Src/kernbench.cyclo ./Core/Src/kernbench.d ./Core/Src/kernbench.o ./Core/Src/kernbench.su ./Core/Src/led.cyclo ./Core/Src/led.d ./Core/Src/led.o ./Core/Src/led.su ./Core/Src/log.cyclo ./Core/Src/log.d ./Core/Src/log.o ./Core/Src/log.su ./Core/Src/lowpower.cyclo ./Core/Src/lowpower.d ./Core/Src/lowpower.o ./Core/Src/lowpower.su ./Core/Src/mailbox.cyclo ./Core/Src/mailbox.d ./Core/Src/mailbox.o ./Core/Src/mailbox.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/mic.cyclo ./Core/Src/mic.d ./Core/Src/mic.o ./Core/Src/mic.su ./Core/Src/microjob.cyclo ./Core/Src/microjob.d ./Core/Src/microjob.o ./Core/Src/microjob.su ./Core/Src/newlibheap.cyclo ./Core/Src/newlibheap.d ./Core/Src/newlibheap.o ./Core/Src/newlibheap.su ./Core/Src/notifysem.cyclo ./Core/Src/notifysem.d ./Core/Src/notifysem.o ./Core/Src/notifysem.su ./Core/Src/periodic.cyclo ./Core/Src/periodic.d ./Core/Src/periodic.o ./Core/Src/periodic.su ./Core/Src/pinmux.cyclo ./Core/Src/pinmux.d ./Core/Src/pinmux.o ./Core/Src/pinmux.su ./Core/Src/pipeline.cyclo ./Core/Src/pipeline.d ./Core/Src/pipeline.o ./Core/Src/pipeline.su ./Core/Src/profiler.cyclo ./Core/Src/profiler.d ./Core/Src/profiler.o ./Core/Src/profiler.su ./Core/Src/shell.cyclo ./Core/Src/shell.d ./Core/Src/shell.o ./Core/Src/shell.su ./Core/Src/stackcheck.cyclo ./Core/Src/stackcheck.d ./Core/Src/stackcheck.o ./Core/Src/stackcheck.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su ./Core/Src/taskreg.cyclo ./Core/Src/taskreg.d ./Core/Src/taskreg.o ./Core/Src/taskreg.su ./Core/Src/timebase.cyclo ./Core/Src/timebase.d ./Core/Src/timebase.o ./Core/Src/timebase.su ./Core/Src/trace.cyclo ./Core/Src/trace.d ./Core/Src/trace.o ./Core/Src/trace.su ./Core/Src/uartline.cyclo ./Core/Src/uartline.d ./Core/Src/uartline.o ./Core/Src/uartline.su ./Core/Src/uartrx.cyclo ./Core/Src/uartrx.d ./Core/Src/uartrx.o ./Core/Src/uartrx.su ./Core/Src/uarttx.cyclo ./Core/Src/uarttx.d ./Core/Src/uarttx.o ./Core/Src/uarttx.su ./Core/Src/usbcdc.cyclo ./Core/Src/usbcdc.d ./Core/Src/usbcdc.o ./Core/Src/usbcdc.su ./Core/Src/watchdog.cyclo ./Core/Src/watchdog.d ./Core/Src/watchdog.o ./Core/Src/watchdog.su ./Core/Src/workerpool.cyclo ./Core/Src/workerpool.d ./Core/Src/workerpool.o ./Core/Src/workerpool.su
 
 .PHONY: clean-Core-2f-Src
 
@@ -5,12 +5,15 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../FreeRTOS/portable/ARM_CM4F/memops.c \
 ../FreeRTOS/portable/ARM_CM4F/port.c 
 
 OBJS += \
+./FreeRTOS/portable/ARM_CM4F/memops.o \
 ./FreeRTOS/portable/ARM_CM4F/port.o 
 
 C_DEPS += \
+./FreeRTOS/portable/ARM_CM4F/memops.d \
 ./FreeRTOS/portable/ARM_CM4F/port.d 
 
 
@@ -21,7 +24,7 @@ FreeRTOS/portable/ARM_CM4F/%.o FreeRTOS/portable/ARM_CM4F/%.su FreeRTOS/portable
 clean: clean-FreeRTOS-2f-portable-2f-ARM_CM4F
 
 clean-FreeRTOS-2f-portable-2f-ARM_CM4F:
-	-$(RM) ./FreeRTOS/portable/ARM_CM4F/port.cyclo ./FreeRTOS/portable/ARM_CM4F/port.d ./FreeRTOS/portable/ARM_CM4F/port.o ./FreeRTOS/portable/ARM_CM4F/port.su
+	-$(RM) ./FreeRTOS/portable/ARM_CM4F/memops.cyclo ./FreeRTOS/portable/ARM_CM4F/memops.d ./FreeRTOS/portable/ARM_CM4F/memops.o ./FreeRTOS/portable/ARM_CM4F/memops.su ./FreeRTOS/portable/ARM_CM4F/port.cyclo ./FreeRTOS/portable/ARM_CM4F/port.d ./FreeRTOS/portable/ARM_CM4F/port.o ./FreeRTOS/portable/ARM_CM4F/port.su
 
 .PHONY: clean-FreeRTOS-2f-portable-2f-ARM_CM4F
 
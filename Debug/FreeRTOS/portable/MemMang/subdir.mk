@@ -5,13 +5,37 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
-../FreeRTOS/portable/MemMang/heap_2.c 
+../FreeRTOS/portable/MemMang/heap_2.c \
+../FreeRTOS/portable/MemMang/heap_btag.c \
+../FreeRTOS/portable/MemMang/heap_buddy.c \
+../FreeRTOS/portable/MemMang/heap_handle.c \
+../FreeRTOS/portable/MemMang/heap_isr.c \
+../FreeRTOS/portable/MemMang/heap_regions.c \
+../FreeRTOS/portable/MemMang/heap_report.c \
+../FreeRTOS/portable/MemMang/heap_tlsf.c \
+../FreeRTOS/portable/MemMang/heap_watch.c 
 
 OBJS += \
-./FreeRTOS/portable/MemMang/heap_2.o 
+./FreeRTOS/portable/MemMang/heap_2.o \
+./FreeRTOS/portable/MemMang/heap_btag.o \
+./FreeRTOS/portable/MemMang/heap_buddy.o \
+./FreeRTOS/portable/MemMang/heap_handle.o \
+./FreeRTOS/portable/MemMang/heap_isr.o \
+./FreeRTOS/portable/MemMang/heap_regions.o \
+./FreeRTOS/portable/MemMang/heap_report.o \
+./FreeRTOS/portable/MemMang/heap_tlsf.o \
+./FreeRTOS/portable/MemMang/heap_watch.o 
 
 C_DEPS += \
-./FreeRTOS/portable/MemMang/heap_2.d 
+./FreeRTOS/portable/MemMang/heap_2.d \
+./FreeRTOS/portable/MemMang/heap_btag.d \
+./FreeRTOS/portable/MemMang/heap_buddy.d \
+./FreeRTOS/portable/MemMang/heap_handle.d \
+./FreeRTOS/portable/MemMang/heap_isr.d \
+./FreeRTOS/portable/MemMang/heap_regions.d \
+./FreeRTOS/portable/MemMang/heap_report.d \
+./FreeRTOS/portable/MemMang/heap_tlsf.d \
+./FreeRTOS/portable/MemMang/heap_watch.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -21,7 +45,7 @@ FreeRTOS/portable/MemMang/%.o FreeRTOS/portable/MemMang/%.su FreeRTOS/portable/M
 clean: clean-FreeRTOS-2f-portable-2f-MemMang
 
 clean-FreeRTOS-2f-portable-2f-MemMang:
-	-$(RM) ./FreeRTOS/portable/MemMang/heap_2.cyclo ./FreeRTOS/portable/MemMang/heap_2.d ./FreeRTOS/portable/MemMang/heap_2.o ./FreeRTOS/portable/MemMang/heap_2.su
+	-$(RM) ./FreeRTOS/portable/MemMang/heap_2.cyclo ./FreeRTOS/portable/MemMang/heap_2.d ./FreeRTOS/portable/MemMang/heap_2.o ./FreeRTOS/portable/MemMang/heap_2.su ./FreeRTOS/portable/MemMang/heap_btag.cyclo ./FreeRTOS/portable/MemMang/heap_btag.d ./FreeRTOS/portable/MemMang/heap_btag.o ./FreeRTOS/portable/MemMang/heap_btag.su ./FreeRTOS/portable/MemMang/heap_buddy.cyclo ./FreeRTOS/portable/MemMang/heap_buddy.d ./FreeRTOS/portable/MemMang/heap_buddy.o ./FreeRTOS/portable/MemMang/heap_buddy.su ./FreeRTOS/portable/MemMang/heap_handle.cyclo ./FreeRTOS/portable/MemMang/heap_handle.d ./FreeRTOS/portable/MemMang/heap_handle.o ./FreeRTOS/portable/MemMang/heap_handle.su ./FreeRTOS/portable/MemMang/heap_isr.cyclo ./FreeRTOS/portable/MemMang/heap_isr.d ./FreeRTOS/portable/MemMang/heap_isr.o ./FreeRTOS/portable/MemMang/heap_isr.su ./FreeRTOS/portable/MemMang/heap_regions.cyclo ./FreeRTOS/portable/MemMang/heap_regions.d ./FreeRTOS/portable/MemMang/heap_regions.o ./FreeRTOS/portable/MemMang/heap_regions.su ./FreeRTOS/portable/MemMang/heap_report.cyclo ./FreeRTOS/portable/MemMang/heap_report.d ./FreeRTOS/portable/MemMang/heap_report.o ./FreeRTOS/portable/MemMang/heap_report.su ./FreeRTOS/portable/MemMang/heap_tlsf.cyclo ./FreeRTOS/portable/MemMang/heap_tlsf.d ./FreeRTOS/portable/MemMang/heap_tlsf.o ./FreeRTOS/portable/MemMang/heap_tlsf.su ./FreeRTOS/portable/MemMang/heap_watch.cyclo ./FreeRTOS/portable/MemMang/heap_watch.d ./FreeRTOS/portable/MemMang/heap_watch.o ./FreeRTOS/portable/MemMang/heap_watch.su
 
 .PHONY: clean-FreeRTOS-2f-portable-2f-MemMang
 
@@ -7,8 +7,14 @@
 C_SRCS += \
 ../FreeRTOS/croutine.c \
 ../FreeRTOS/event_groups.c \
+../FreeRTOS/eventflags.c \
+../FreeRTOS/fastmutex.c \
 ../FreeRTOS/list.c \
+../FreeRTOS/mempool.c \
 ../FreeRTOS/queue.c \
+../FreeRTOS/rwlock.c \
+../FreeRTOS/slab.c \
+../FreeRTOS/spscring.c \
 ../FreeRTOS/stream_buffer.c \
 ../FreeRTOS/tasks.c \
 ../FreeRTOS/timers.c 
@@ -16,8 +22,14 @@ C_SRCS += \
 OBJS += \
 ./FreeRTOS/croutine.o \
 ./FreeRTOS/event_groups.o \
+./FreeRTOS/eventflags.o \
+./FreeRTOS/fastmutex.o \
 ./FreeRTOS/list.o \
+./FreeRTOS/mempool.o \
 ./FreeRTOS/queue.o \
+./FreeRTOS/rwlock.o \
+./FreeRTOS/slab.o \
+./FreeRTOS/spscring.o \
 ./FreeRTOS/stream_buffer.o \
 ./FreeRTOS/tasks.o \
 ./FreeRTOS/timers.o 
@@ -25,8 +37,14 @@ OBJS += \
 C_DEPS += \
 ./FreeRTOS/croutine.d \
 ./FreeRTOS/event_groups.d \
+./FreeRTOS/eventflags.d \
+./FreeRTOS/fastmutex.d \
 ./FreeRTOS/list.d \
+./FreeRTOS/mempool.d \
 ./FreeRTOS/queue.d \
+./FreeRTOS/rwlock.d \
+./FreeRTOS/slab.d \
+./FreeRTOS/spscring.d \
 ./FreeRTOS/stream_buffer.d \
 ./FreeRTOS/tasks.d \
 ./FreeRTOS/timers.d 
@@ -39,7 +57,7 @@ FreeRTOS/%.o FreeRTOS/%.su FreeRTOS/%.cyclo: ../FreeRTOS/%.c FreeRTOS/subdir.mk
 clean: clean-FreeRTOS
 
 clean-FreeRTOS:
-	-$(RM) ./FreeRTOS/croutine.cyclo ./FreeRTOS/croutine.d ./FreeRTOS/croutine.o ./FreeRTOS/croutine.su ./FreeRTOS/event_groups.cyclo ./FreeRTOS/event_groups.d ./FreeRTOS/event_groups.o ./FreeRTOS/event_groups.su ./FreeRTOS/list.cyclo ./FreeRTOS/list.d ./FreeRTOS/list.o ./FreeRTOS/list.su ./FreeRTOS/queue.cyclo ./FreeRTOS/queue.d ./FreeRTOS/queue.o ./FreeRTOS/queue.su ./FreeRTOS/stream_buffer.cyclo ./FreeRTOS/stream_buffer.d ./FreeRTOS/stream_buffer.o ./FreeRTOS/stream_buffer.su ./FreeRTOS/tasks.cyclo ./FreeRTOS/tasks.d ./FreeRTOS/tasks.o ./FreeRTOS/tasks.su ./FreeRTOS/timers.cyclo ./FreeRTOS/timers.d ./FreeRTOS/timers.o ./FreeRTOS/timers.su
+	-$(RM) ./FreeRTOS/croutine.cyclo ./FreeRTOS/croutine.d ./FreeRTOS/croutine.o ./FreeRTOS/croutine.su ./FreeRTOS/event_groups.cyclo ./FreeRTOS/event_groups.d ./FreeRTOS/event_groups.o ./FreeRTOS/event_groups.su ./FreeRTOS/eventflags.cyclo ./FreeRTOS/eventflags.d ./FreeRTOS/eventflags.o ./FreeRTOS/eventflags.su ./FreeRTOS/fastmutex.cyclo ./FreeRTOS/fastmutex.d ./FreeRTOS/fastmutex.o ./FreeRTOS/fastmutex.su ./FreeRTOS/list.cyclo ./FreeRTOS/list.d ./FreeRTOS/list.o ./FreeRTOS/list.su ./FreeRTOS/mempool.cyclo ./FreeRTOS/mempool.d ./FreeRTOS/mempool.o ./FreeRTOS/mempool.su ./FreeRTOS/queue.cyclo ./FreeRTOS/queue.d ./FreeRTOS/queue.o ./FreeRTOS/queue.su ./FreeRTOS/rwlock.cyclo ./FreeRTOS/rwlock.d ./FreeRTOS/rwlock.o ./FreeRTOS/rwlock.su ./FreeRTOS/slab.cyclo ./FreeRTOS/slab.d ./FreeRTOS/slab.o ./FreeRTOS/slab.su ./FreeRTOS/spscring.cyclo ./FreeRTOS/spscring.d ./FreeRTOS/spscring.o ./FreeRTOS/spscring.su ./FreeRTOS/stream_buffer.cyclo ./FreeRTOS/stream_buffer.d ./FreeRTOS/stream_buffer.o ./FreeRTOS/stream_buffer.su ./FreeRTOS/tasks.cyclo ./FreeRTOS/tasks.d ./FreeRTOS/tasks.o ./FreeRTOS/tasks.su ./FreeRTOS/timers.cyclo ./FreeRTOS/timers.d ./FreeRTOS/timers.o ./FreeRTOS/timers.su
 
 .PHONY: clean-FreeRTOS
 
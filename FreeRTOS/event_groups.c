@@ -39,6 +39,10 @@ task.h is included from an application file. */
 #include "timers.h"
 #include "event_groups.h"
 
+#if ( configUSE_KERNEL_SLABS == 1 )
+	#include "slab.h"
+#endif
+
 /* Lint e961, e750 and e9021 are suppressed as a MISRA exception justified
 because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
 for the header files above, but not in this file, in order to generate the
@@ -76,6 +80,23 @@ typedef struct EventGroupDef_t
 
 /*-----------------------------------------------------------*/
 
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_KERNEL_SLABS == 1 ) )
+
+	/* Dynamically created event groups, packed together in slabs. */
+	PRIVILEGED_DATA static SlabCache_t xEventGroupSlabs = slabCACHE_INIT( sizeof( EventGroup_t ) );
+
+	#define prvAllocateEventGroup()				pvSlabAlloc( &xEventGroupSlabs )
+	#define prvFreeEventGroup( pxEventBits )	vSlabFree( &xEventGroupSlabs, ( pxEventBits ) )
+
+#else
+
+	#define prvAllocateEventGroup()				pvPortMalloc( sizeof( EventGroup_t ) )
+	#define prvFreeEventGroup( pxEventBits )	vPortFree( pxEventBits )
+
+#endif
+
+/*-----------------------------------------------------------*/
+
 /*
  * Test the bits set in uxCurrentEventBits to see if the wait condition is met.
  * The wait condition is defined by xWaitForAllBits.  If xWaitForAllBits is
@@ -159,7 +180,7 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits, co
 		sizeof( TickType_t ), the TickType_t variables will be accessed in two
 		or more reads operations, and the alignment requirements is only that
 		of each individual read. */
-		pxEventBits = ( EventGroup_t * ) pvPortMalloc( sizeof( EventGroup_t ) ); /*lint !e9087 !e9079 see comment above. */
+		pxEventBits = ( EventGroup_t * ) prvAllocateEventGroup(); /*lint !e9087 !e9079 see comment above. */
 
 		if( pxEventBits != NULL )
 		{
@@ -631,7 +652,7 @@ const List_t *pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 		{
 			/* The event group can only have been allocated dynamically - free
 			it again. */
-			vPortFree( pxEventBits );
+			prvFreeEventGroup( pxEventBits );
 		}
 		#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
 		{
@@ -639,7 +660,7 @@ const List_t *pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 			dynamically, so check before attempting to free the memory. */
 			if( pxEventBits->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
 			{
-				vPortFree( pxEventBits );
+				prvFreeEventGroup( pxEventBits );
 			}
 			else
 			{
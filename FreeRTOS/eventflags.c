@@ -0,0 +1,301 @@
+/*
+ * Event flags that interrupts set directly - see eventflags.h.
+ */
+
+#include <stddef.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "eventflags.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_TASK_NOTIFICATIONS != 1 )
+	#error eventflags.c wakes waiters with a task notification, so configUSE_TASK_NOTIFICATIONS must be 1
+#endif
+
+#if( ( INCLUDE_xTaskGetCurrentTaskHandle != 1 ) && ( configUSE_MUTEXES != 1 ) )
+	#error eventflags.c needs xTaskGetCurrentTaskHandle()
+#endif
+
+/* A task blocked in xEventFlagsWait().  The record is on the task's own stack
+and is only touched with interrupts masked. */
+typedef struct xEVENT_FLAGS_WAITER
+{
+	struct xEVENT_FLAGS_WAITER *pxNext;
+	TaskHandle_t xTask;					/*< Cleared by the setter that wakes the task. */
+	EventBits_t uxBitsToWaitFor;
+	BaseType_t xClearOnExit;
+	BaseType_t xWaitForAllBits;
+} EventFlagsWaiter_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Whether uxBits satisfy a wait for uxBitsToWaitFor.
+ */
+static BaseType_t prvSatisfied( EventBits_t uxBits, EventBits_t uxBitsToWaitFor, BaseType_t xWaitForAllBits );
+
+/*
+ * Set the bits and wake the waiters they satisfy.  Called with interrupts
+ * masked.
+ */
+static EventBits_t prvSet( EventFlags_t *pxFlags, EventBits_t uxBitsToSet, BaseType_t * const pxHigherPriorityTaskWoken );
+
+/*-----------------------------------------------------------*/
+
+void vEventFlagsInit( EventFlags_t *pxFlags )
+{
+	configASSERT( pxFlags );
+
+	pxFlags->uxBits = 0;
+	pxFlags->pxWaiters = NULL;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xEventFlagsSet( EventFlags_t *pxFlags, EventBits_t uxBitsToSet )
+{
+EventBits_t uxReturn;
+BaseType_t xYieldRequired = pdFALSE;
+
+	taskENTER_CRITICAL();
+	{
+		uxReturn = prvSet( pxFlags, uxBitsToSet, &xYieldRequired );
+	}
+	taskEXIT_CRITICAL();
+
+	if( xYieldRequired != pdFALSE )
+	{
+		portYIELD_WITHIN_API();
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xEventFlagsSetFromISR( EventFlags_t *pxFlags, EventBits_t uxBitsToSet, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+EventBits_t uxReturn;
+UBaseType_t uxSavedInterruptStatus;
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		uxReturn = prvSet( pxFlags, uxBitsToSet, pxHigherPriorityTaskWoken );
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xEventFlagsClear( EventFlags_t *pxFlags, EventBits_t uxBitsToClear )
+{
+EventBits_t uxReturn;
+UBaseType_t uxSavedInterruptStatus;
+
+	configASSERT( pxFlags );
+
+	/* Masking rather than a critical section, so one function serves tasks and
+	interrupts. */
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		uxReturn = pxFlags->uxBits;
+		pxFlags->uxBits = uxReturn & ~uxBitsToClear;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xEventFlagsGet( const EventFlags_t *pxFlags )
+{
+	configASSERT( pxFlags );
+
+	return pxFlags->uxBits;
+}
+/*-----------------------------------------------------------*/
+
+EventBits_t xEventFlagsWait( EventFlags_t *pxFlags, EventBits_t uxBitsToWaitFor, BaseType_t xClearOnExit, BaseType_t xWaitForAllBits, TickType_t xTicksToWait )
+{
+EventFlagsWaiter_t xWaiter;
+EventFlagsWaiter_t **ppxLink;
+EventBits_t uxReturn;
+uint32_t ulNotifiedValue = 0;
+BaseType_t xNotified, xWoken;
+
+	configASSERT( pxFlags );
+	configASSERT( uxBitsToWaitFor != 0 );
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	taskENTER_CRITICAL();
+	{
+		uxReturn = pxFlags->uxBits;
+
+		if( prvSatisfied( uxReturn, uxBitsToWaitFor, xWaitForAllBits ) != pdFALSE )
+		{
+			/* Already set, so no need to block. */
+			if( xClearOnExit != pdFALSE )
+			{
+				pxFlags->uxBits = uxReturn & ~uxBitsToWaitFor;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			xTicksToWait = ( TickType_t ) 0;
+		}
+		else if( xTicksToWait != ( TickType_t ) 0 )
+		{
+			/* A notification left over from an earlier wait must not end this
+			one. */
+			( void ) xTaskNotifyStateClear( NULL );
+
+			xWaiter.xTask = xTaskGetCurrentTaskHandle();
+			xWaiter.uxBitsToWaitFor = uxBitsToWaitFor;
+			xWaiter.xClearOnExit = xClearOnExit;
+			xWaiter.xWaitForAllBits = xWaitForAllBits;
+			xWaiter.pxNext = pxFlags->pxWaiters;
+			pxFlags->pxWaiters = &xWaiter;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xTicksToWait != ( TickType_t ) 0 )
+	{
+		xNotified = xTaskNotifyWait( ( uint32_t ) 0, ~( ( uint32_t ) 0 ), &ulNotifiedValue, xTicksToWait );
+
+		taskENTER_CRITICAL();
+		{
+			if( xWaiter.xTask != NULL )
+			{
+				/* Timed out still on the list, so take the record off it
+				before the stack frame holding it goes away. */
+				for( ppxLink = &( pxFlags->pxWaiters ); *ppxLink != &xWaiter; ppxLink = &( ( *ppxLink )->pxNext ) )
+				{
+					configASSERT( *ppxLink != NULL );
+				}
+
+				*ppxLink = xWaiter.pxNext;
+				uxReturn = pxFlags->uxBits;
+				xWoken = pdFALSE;
+			}
+			else
+			{
+				xWoken = pdTRUE;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xWoken != pdFALSE )
+		{
+			if( xNotified == pdFALSE )
+			{
+				/* Woken between the timeout and the critical section above;
+				the notification is already pending, so collect it. */
+				( void ) xTaskNotifyWait( ( uint32_t ) 0, ~( ( uint32_t ) 0 ), &ulNotifiedValue, ( TickType_t ) 0 );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			uxReturn = ( EventBits_t ) ulNotifiedValue;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return uxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSatisfied( EventBits_t uxBits, EventBits_t uxBitsToWaitFor, BaseType_t xWaitForAllBits )
+{
+BaseType_t xReturn;
+
+	if( xWaitForAllBits == pdFALSE )
+	{
+		xReturn = ( ( uxBits & uxBitsToWaitFor ) != ( EventBits_t ) 0 ) ? pdTRUE : pdFALSE;
+	}
+	else
+	{
+		xReturn = ( ( uxBits & uxBitsToWaitFor ) == uxBitsToWaitFor ) ? pdTRUE : pdFALSE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static EventBits_t prvSet( EventFlags_t *pxFlags, EventBits_t uxBitsToSet, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+EventFlagsWaiter_t **ppxLink, *pxWaiter;
+EventBits_t uxBits, uxBitsToClear = 0;
+TaskHandle_t xTask;
+
+	configASSERT( pxFlags );
+
+	uxBits = pxFlags->uxBits | uxBitsToSet;
+	pxFlags->uxBits = uxBits;
+
+	/* Every waiter sees the same flags, so two waiters that both clear on exit
+	are both woken, as with an event group. */
+	ppxLink = &( pxFlags->pxWaiters );
+	while( *ppxLink != NULL )
+	{
+		pxWaiter = *ppxLink;
+
+		if( prvSatisfied( uxBits, pxWaiter->uxBitsToWaitFor, pxWaiter->xWaitForAllBits ) != pdFALSE )
+		{
+			if( pxWaiter->xClearOnExit != pdFALSE )
+			{
+				uxBitsToClear |= pxWaiter->uxBitsToWaitFor;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* Unlink and release the record before the notification; the
+			waiter may return as soon as it sees xTask cleared. */
+			*ppxLink = pxWaiter->pxNext;
+			xTask = pxWaiter->xTask;
+			pxWaiter->xTask = NULL;
+
+			( void ) xTaskNotifyFromISR( xTask, ( uint32_t ) uxBits, eSetValueWithOverwrite, pxHigherPriorityTaskWoken );
+		}
+		else
+		{
+			ppxLink = &( pxWaiter->pxNext );
+		}
+	}
+
+	pxFlags->uxBits = uxBits & ~uxBitsToClear;
+
+	return pxFlags->uxBits;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,258 @@
+/*
+ * Mutexes whose uncontended take and give do not enter the kernel - see
+ * fastmutex.h.
+ */
+
+#include <stddef.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "fastmutex.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_TASK_NOTIFICATIONS != 1 )
+	#error fastmutex.c wakes waiters with a task notification, so configUSE_TASK_NOTIFICATIONS must be 1
+#endif
+
+#if( configUSE_MUTEXES != 1 )
+	#error fastmutex.c uses the kernel priority inheritance, so configUSE_MUTEXES must be 1
+#endif
+
+#if( INCLUDE_uxTaskPriorityGet != 1 )
+	#error fastmutex.c queues waiters by priority, so INCLUDE_uxTaskPriorityGet must be 1
+#endif
+
+/* Set in ulState while tasks are waiting, so the owner's give takes the slow
+path.  TCBs are word aligned, so bit 0 of a handle is always clear. */
+#define fmCONTENDED						( ( uint32_t ) 1UL )
+
+/* One exclusive compare and swap, which on Cortex-M4 is an LDREX, STREX
+loop.  Acquire and release ordering keep the protected accesses inside the
+take and give.  A context switch clears the exclusive monitor, so a task
+preempted between the two instructions just goes round again. */
+#define fmCOMPARE_AND_SWAP( pulState, ulExpected, ulDesired )																\
+	__atomic_compare_exchange_n( ( pulState ), &( ulExpected ), ( ulDesired ), pdFALSE, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED )
+
+/* A task blocked in xFastMutexTake().  The record is on the task's own stack
+and is only touched in critical sections. */
+typedef struct xFAST_MUTEX_WAITER
+{
+	struct xFAST_MUTEX_WAITER *pxNext;
+	TaskHandle_t xTask;					/*< Cleared by the give that hands the mutex over. */
+	UBaseType_t uxPriority;
+} FastMutexWaiter_t;
+
+/*-----------------------------------------------------------*/
+
+void vFastMutexInit( FastMutex_t *pxMutex )
+{
+	configASSERT( pxMutex );
+
+	pxMutex->ulState = 0UL;
+	pxMutex->pxWaiters = NULL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xFastMutexTake( FastMutex_t *pxMutex, TickType_t xTicksToWait )
+{
+FastMutexWaiter_t xWaiter;
+FastMutexWaiter_t **ppxLink;
+const TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+uint32_t ulState = 0UL;
+BaseType_t xReturn = pdFAIL, xHandedOver = pdFALSE;
+
+	configASSERT( pxMutex );
+
+	/* The uncontended case. */
+	if( fmCOMPARE_AND_SWAP( &( pxMutex->ulState ), ulState, ( uint32_t ) xSelf ) != pdFALSE )
+	{
+		return pdPASS;
+	}
+
+	/* Not recursive. */
+	configASSERT( ( ulState & ~fmCONTENDED ) != ( uint32_t ) xSelf );
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	taskENTER_CRITICAL();
+	{
+		/* No task can run in here, so plain accesses to ulState are enough,
+		and the context switch out of this task fails any exclusive store
+		another task had started on it. */
+		ulState = pxMutex->ulState;
+
+		if( ulState == 0UL )
+		{
+			/* Given back since the compare and swap failed. */
+			pxMutex->ulState = ( uint32_t ) xSelf;
+			xReturn = pdPASS;
+			xTicksToWait = ( TickType_t ) 0;
+		}
+		else if( xTicksToWait != ( TickType_t ) 0 )
+		{
+			pxMutex->ulState = ulState | fmCONTENDED;
+
+			/* As with a kernel mutex, the owner runs at no lower a priority
+			than the tasks waiting for it. */
+			( void ) xTaskPriorityInherit( ( TaskHandle_t ) ( ulState & ~fmCONTENDED ) ); /*lint !e923 The handle was stored as an integer. */
+
+			/* A notification left over from an earlier wait must not end this
+			one. */
+			( void ) xTaskNotifyStateClear( NULL );
+
+			/* Highest priority first, and in arrival order within a
+			priority. */
+			xWaiter.xTask = xSelf;
+			xWaiter.uxPriority = uxTaskPriorityGet( NULL );
+			for( ppxLink = &( pxMutex->pxWaiters ); ( *ppxLink != NULL ) && ( ( *ppxLink )->uxPriority >= xWaiter.uxPriority ); ppxLink = &( ( *ppxLink )->pxNext ) )
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			xWaiter.pxNext = *ppxLink;
+			*ppxLink = &xWaiter;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xTicksToWait != ( TickType_t ) 0 )
+	{
+		xHandedOver = xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+
+		taskENTER_CRITICAL();
+		{
+			if( xWaiter.xTask != NULL )
+			{
+				/* Timed out still on the list, so take the record off it
+				before the stack frame holding it goes away. */
+				for( ppxLink = &( pxMutex->pxWaiters ); *ppxLink != &xWaiter; ppxLink = &( ( *ppxLink )->pxNext ) )
+				{
+					configASSERT( *ppxLink != NULL );
+				}
+
+				*ppxLink = xWaiter.pxNext;
+
+				/* The contended mark stays even if no waiters are left, so the
+				give still takes the slow path and drops whatever priority the
+				owner inherited from this task. */
+			}
+			else
+			{
+				/* The give made this task the owner before notifying it. */
+				xReturn = pdPASS;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( ( xReturn == pdPASS ) && ( xHandedOver == pdFALSE ) )
+		{
+			/* Handed over between the timeout and the critical section above;
+			the notification is already pending, so collect it. */
+			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, ( TickType_t ) 0 );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xFastMutexGive( FastMutex_t *pxMutex )
+{
+FastMutexWaiter_t *pxWaiter;
+const TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+uint32_t ulState = ( uint32_t ) xSelf;
+TaskHandle_t xNewOwner;
+BaseType_t xYieldRequired = pdFALSE;
+
+	configASSERT( pxMutex );
+
+	/* The uncontended case.  Nobody waited, so nobody was inherited from. */
+	if( fmCOMPARE_AND_SWAP( &( pxMutex->ulState ), ulState, 0UL ) != pdFALSE )
+	{
+		return pdPASS;
+	}
+
+	/* Only the owner may give the mutex, and the compare and swap only fails
+	for the owner if tasks are, or were, waiting. */
+	configASSERT( ulState == ( ( uint32_t ) xSelf | fmCONTENDED ) );
+
+	taskENTER_CRITICAL();
+	{
+		/* Hand the mutex straight to the highest priority waiter, so a task
+		that gives and takes again in a loop cannot starve it. */
+		pxWaiter = pxMutex->pxWaiters;
+
+		if( pxWaiter != NULL )
+		{
+			pxMutex->pxWaiters = pxWaiter->pxNext;
+
+			xNewOwner = pxWaiter->xTask;
+			pxMutex->ulState = ( uint32_t ) xNewOwner | ( ( pxMutex->pxWaiters != NULL ) ? fmCONTENDED : 0UL );
+
+			/* Release the record before the notification; the waiter may return
+			as soon as it sees xTask cleared. */
+			pxWaiter->xTask = NULL;
+			( void ) xTaskNotifyFromISR( xNewOwner, 0UL, eNoAction, &xYieldRequired );
+		}
+		else
+		{
+			/* Every waiter timed out. */
+			pxMutex->ulState = 0UL;
+		}
+
+		/* Drop any priority inherited from the waiters.  The kernel only does
+		that once no kernel mutexes are held, and counts the mutexes this
+		task holds, so count this one in for the call to count back out. */
+		( void ) pvTaskIncrementMutexHeldCount();
+		if( xTaskPriorityDisinherit( xSelf ) != pdFALSE )
+		{
+			xYieldRequired = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xYieldRequired != pdFALSE )
+	{
+		portYIELD_WITHIN_API();
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+TaskHandle_t xFastMutexGetOwner( const FastMutex_t *pxMutex )
+{
+	configASSERT( pxMutex );
+
+	return ( TaskHandle_t ) ( pxMutex->ulState & ~fmCONTENDED ); /*lint !e923 The handle was stored as an integer. */
+}
+/*-----------------------------------------------------------*/
@@ -67,7 +67,7 @@ extern "C" {
 #endif
 
 /* Required if struct _reent is used. */
-#if ( configUSE_NEWLIB_REENTRANT == 1 )
+#if ( configUSE_NEWLIB_REENTRANT != 0 )
 	#include <reent.h>
 #endif
 /*
@@ -245,6 +245,16 @@ extern "C" {
 	#define portMEMORY_BARRIER()
 #endif
 
+/* Copies and fills made by the kernel and heap.  The defaults need string.h,
+which every file using them includes. */
+#ifndef portMEMCPY
+	#define portMEMCPY( pvDest, pvSrc, xLength )	memcpy( ( pvDest ), ( pvSrc ), ( xLength ) )
+#endif
+
+#ifndef portMEMSET
+	#define portMEMSET( pvDest, iValue, xLength )	memset( ( pvDest ), ( iValue ), ( xLength ) )
+#endif
+
 /* The timers module relies on xTaskGetSchedulerState(). */
 #if configUSE_TIMERS == 1
 
@@ -309,6 +319,12 @@ extern "C" {
 	#define traceEND()
 #endif
 
+#ifndef traceSTART_FIRST_TASK
+	/* Called by the port, with interrupts disabled, immediately before it
+	starts the first task. */
+	#define traceSTART_FIRST_TASK()
+#endif
+
 #ifndef traceTASK_SWITCHED_IN
 	/* Called after a task has been selected to run.  pxCurrentTCB holds a pointer
 	to the task control block of the selected task. */
@@ -504,6 +520,12 @@ extern "C" {
 	#define traceTASK_DELETE( pxTaskToDelete )
 #endif
 
+#ifndef traceTASK_DELETE_TCB
+	/* Called when the memory of a deleted task is about to be reclaimed, either
+	by the idle task or directly by vTaskDelete(). */
+	#define traceTASK_DELETE_TCB( pxTCB )
+#endif
+
 #ifndef traceTASK_DELAY_UNTIL
 	#define traceTASK_DELAY_UNTIL( x )
 #endif
@@ -814,10 +836,348 @@ extern "C" {
 	#define configAPPLICATION_ALLOCATED_HEAP 0
 #endif
 
+#ifndef configHEAP_IMPLEMENTATION
+	#define configHEAP_IMPLEMENTATION heapIMPLEMENTATION_2
+#endif
+
+#ifndef configCCM_HEAP_SIZE
+	#define configCCM_HEAP_SIZE 0
+#endif
+
+#ifndef configHEAP_SRAM_FROM_LINKER
+	#define configHEAP_SRAM_FROM_LINKER 0
+#endif
+
+#ifndef configGENERATE_HEAP_STATS
+	#define configGENERATE_HEAP_STATS 0
+#endif
+
+#ifndef configHEAP_LOCK_CEILING
+	/* 0 locks the heap by suspending the scheduler.  Otherwise the heap runs
+	its caller at this priority instead, so tasks above it keep running. */
+	#define configHEAP_LOCK_CEILING 0
+#endif
+
+#ifndef configUSE_ISR_HEAP_POOLS
+	#define configUSE_ISR_HEAP_POOLS 0
+#endif
+
+#ifndef configUSE_BUDDY_HEAP
+	#define configUSE_BUDDY_HEAP 0
+#endif
+
+#ifndef configBUDDY_HEAP_MIN_BLOCK_ORDER
+	/* Smallest heap_buddy.c block, 2^order bytes. */
+	#define configBUDDY_HEAP_MIN_BLOCK_ORDER 6
+#endif
+
+#ifndef configBUDDY_HEAP_MAX_BLOCK_ORDER
+	/* Largest heap_buddy.c block, 2^order bytes. */
+	#define configBUDDY_HEAP_MAX_BLOCK_ORDER 10
+#endif
+
+#ifndef configBUDDY_HEAP_TOP_BLOCKS
+	/* Largest blocks the heap_buddy.c region is made of. */
+	#define configBUDDY_HEAP_TOP_BLOCKS 4
+#endif
+
+#ifndef configUSE_HEAP_HANDLES
+	#define configUSE_HEAP_HANDLES 0
+#endif
+
+#ifndef configHEAP_HANDLE_REGION_SIZE
+	/* Bytes in the heap_handle.c region. */
+	#define configHEAP_HANDLE_REGION_SIZE 4096
+#endif
+
+#ifndef configHEAP_HANDLES
+	/* Entries in the heap_handle.c handle table. */
+	#define configHEAP_HANDLES 16
+#endif
+
+#ifndef configHEAP_GUARD
+	#define configHEAP_GUARD 0
+#endif
+
+#ifndef configHEAP_GUARD_STEP_BLOCKS
+	/* Blocks xPortHeapGuardStep() checks with the heap locked. */
+	#define configHEAP_GUARD_STEP_BLOCKS 8
+#endif
+
+#ifndef configHEAP_LAZY_COALESCE
+	#define configHEAP_LAZY_COALESCE 0
+#endif
+
+#ifndef configHEAP_FIT_POLICY
+	/* heap_2.c's policy from boot, see HeapFitPolicy_t. */
+	#define configHEAP_FIT_POLICY eHeapFitBest
+#endif
+
+#ifndef configHEAP_TRACK_OWNERS
+	#define configHEAP_TRACK_OWNERS 0
+#endif
+
+#ifndef configHEAP_JOURNAL_LENGTH
+	/* Free list changes kept for xPortGetHeapChanges().  0 keeps only the
+	count of changes. */
+	#define configHEAP_JOURNAL_LENGTH 16
+#endif
+
+#ifndef configUSE_HEAP_WATCH
+	#define configUSE_HEAP_WATCH 0
+#endif
+
+#ifndef configHEAP_WATCHES
+	/* Callbacks xPortHeapWatchAdd() can register. */
+	#define configHEAP_WATCHES 4
+#endif
+
+#ifndef configHEAP_OWNER_SLOTS
+	/* Tasks the heap keeps accounts for, plus one for everything else. */
+	#define configHEAP_OWNER_SLOTS 8
+#endif
+
+#ifndef portHEAP_CALLER
+	/* Return address recorded as the site of each allocation. */
+	#define portHEAP_CALLER() 0UL
+#endif
+
+#ifndef configISR_HEAP_POOLS
+	/* { block size in bytes, number of blocks }, smallest size first. */
+	#define configISR_HEAP_POOLS { { 64, 4 } }
+#endif
+
+#ifndef configKERNEL_HOT_PATHS_IN_RAM
+	/* 1 runs the context switch, the tick and the list primitives from RAM
+	through portRAM_FUNCTION, for ports that provide it. */
+	#define configKERNEL_HOT_PATHS_IN_RAM 0
+#endif
+
+#ifndef configHEAP_HOT_PATHS_IN_RAM
+	/* As configKERNEL_HOT_PATHS_IN_RAM, for pvPortMalloc() and vPortFree(). */
+	#define configHEAP_HOT_PATHS_IN_RAM 0
+#endif
+
+#ifndef configKERNEL_DATA_ATTRIBUTE
+	/* Placement for the scheduler's own state in tasks.c: pxCurrentTCB, the
+	ready, delayed and pending lists and the tick count.  Must name a section
+	the startup code initialises, as most of it relies on static
+	initialisers. */
+	#define configKERNEL_DATA_ATTRIBUTE
+#endif
+
+#if( ( configKERNEL_HOT_PATHS_IN_RAM == 1 ) && defined( portRAM_FUNCTION ) )
+	#define portKERNEL_HOT_PATH portRAM_FUNCTION
+#else
+	#define portKERNEL_HOT_PATH
+#endif
+
+#if( ( configHEAP_HOT_PATHS_IN_RAM == 1 ) && defined( portRAM_FUNCTION ) )
+	#define portHEAP_HOT_PATH portRAM_FUNCTION
+#else
+	#define portHEAP_HOT_PATH
+#endif
+
+#ifndef configUSE_COMPACT_TCB
+	/* 16 bit priorities, mutex counts and task numbers in the TCB, and the
+	task name kept as the pointer passed to xTaskCreate() rather than copied,
+	so it must stay valid for as long as the task exists. */
+	#define configUSE_COMPACT_TCB 0
+#endif
+
+#if( ( configUSE_COMPACT_TCB == 1 ) && ( configMAX_PRIORITIES > 0xFFFF ) )
+	#error configUSE_COMPACT_TCB keeps priorities in 16 bits
+#endif
+
+#ifndef configSTACK_FILL_WINDOW
+	/* Words at the limit of each new stack that are filled with
+	tskSTACK_FILL_BYTE, 0 to fill the whole stack. */
+	#define configSTACK_FILL_WINDOW 0
+#endif
+
+#ifndef configUSE_IDLE_STACK_PAINTER
+	#define configUSE_IDLE_STACK_PAINTER 0
+#endif
+
+#ifndef configSTACK_PAINT_STEP
+	/* Words the idle task fills each time round its loop. */
+	#define configSTACK_PAINT_STEP 64
+#endif
+
+#if( ( configSTACK_FILL_WINDOW > 0 ) && ( configSTACK_FILL_WINDOW < 4 ) )
+	/* configCHECK_FOR_STACK_OVERFLOW 2 checks the lowest 16 bytes. */
+	#error configSTACK_FILL_WINDOW must be at least 4 words
+#endif
+
+#if( ( configUSE_IDLE_STACK_PAINTER == 1 ) && ( configSTACK_FILL_WINDOW == 0 ) )
+	#error configUSE_IDLE_STACK_PAINTER needs configSTACK_FILL_WINDOW, as otherwise every stack is filled whole
+#endif
+
+#ifndef configUSE_KERNEL_SLABS
+	#define configUSE_KERNEL_SLABS 0
+#endif
+
+#ifndef configKERNEL_SLAB_SIZE
+	/* Bytes in each slab.c slab, a power of two. */
+	#define configKERNEL_SLAB_SIZE 512
+#endif
+
+#ifndef configUSE_TASK_POOLS
+	#define configUSE_TASK_POOLS 0
+#endif
+
+#ifndef configTASK_TCB_POOL_LENGTH
+	#define configTASK_TCB_POOL_LENGTH 8
+#endif
+
+#ifndef configUSE_TASK_ARENAS
+	#define configUSE_TASK_ARENAS 0
+#endif
+
+#ifndef configUSE_SWITCH_PROFILER
+	#define configUSE_SWITCH_PROFILER 0
+#endif
+
+#ifndef configUSE_TASK_ENERGY_STATS
+	#define configUSE_TASK_ENERGY_STATS 0
+#endif
+
+#ifndef configENERGY_PROFILES
+	#define configENERGY_PROFILES 1
+#endif
+
+#ifndef configUSE_MASK_PROFILER
+	#define configUSE_MASK_PROFILER 0
+#endif
+
+#ifndef configUSE_SECTION_PROFILER
+	#define configUSE_SECTION_PROFILER 0
+#endif
+
+#ifndef configSECTION_PROFILE_SITES
+	#define configSECTION_PROFILE_SITES 16
+#endif
+
+#ifndef configSWITCH_PROFILE_BUCKETS
+	#define configSWITCH_PROFILE_BUCKETS 8
+#endif
+
+#ifndef configSWITCH_PROFILE_FIRST_BUCKET_SHIFT
+	/* Bucket n of a SwitchProfile_t counts samples shorter than
+	2 ^ ( configSWITCH_PROFILE_FIRST_BUCKET_SHIFT + n ) timer counts, and the
+	last bucket also takes everything longer. */
+	#define configSWITCH_PROFILE_FIRST_BUCKET_SHIFT 6
+#endif
+
+#ifndef configMPU_REGION_SWITCH_BUDGET
+	/* Timer counts a context switch may spend loading the incoming task's MPU
+	regions on ports that report it.  Longer reloads are counted by
+	vTaskGetRegionSwitchTime(). */
+	#define configMPU_REGION_SWITCH_BUDGET 32
+#endif
+
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL 0
+#endif
+
+#ifndef configTIMER_WHEEL_LEVELS
+	#define configTIMER_WHEEL_LEVELS 4
+#endif
+
+#ifndef configTIMER_WHEEL_SLOT_BITS
+	/* Each wheel level has 2 ^ configTIMER_WHEEL_SLOT_BITS slots, so the
+	wheel covers 2 ^ ( configTIMER_WHEEL_LEVELS * configTIMER_WHEEL_SLOT_BITS )
+	ticks.  Timers further out than that wait in an overflow list. */
+	#define configTIMER_WHEEL_SLOT_BITS 5
+#endif
+
+#ifndef configUSE_TIMER_BATCH_COMMANDS
+	#define configUSE_TIMER_BATCH_COMMANDS 0
+#endif
+
+#ifndef configUSE_ZERO_COPY_QUEUES
+	#define configUSE_ZERO_COPY_QUEUES 0
+#endif
+
+#ifndef configUSE_QUEUE_BATCH_OPERATIONS
+	#define configUSE_QUEUE_BATCH_OPERATIONS 0
+#endif
+
+#ifndef configUSE_DELAY_WHEEL
+	#define configUSE_DELAY_WHEEL 0
+#endif
+
+#ifndef configDELAY_WHEEL_SLOT_BITS
+	/* Delayed tasks are hashed by wake time into 2 ^ configDELAY_WHEEL_SLOT_BITS
+	unsorted lists. */
+	#define configDELAY_WHEEL_SLOT_BITS 5
+#endif
+
+#ifndef configUSE_TIME_SLICE_QUANTA
+	#define configUSE_TIME_SLICE_QUANTA 0
+#endif
+
+#ifndef configTIME_SLICE_QUANTA
+	/* Ticks a task may run while an equal priority task waits for its turn,
+	one entry per priority from tskIDLE_PRIORITY up.  An entry left out, or
+	0, means one tick; portMAX_DELAY means equal priority tasks never take
+	turns but run until they block or yield. */
+	#define configTIME_SLICE_QUANTA { 1 }
+#endif
+
+#ifndef configUSE_EDF_SCHEDULING
+	#define configUSE_EDF_SCHEDULING 0
+#endif
+
+#ifndef configEDF_PRIORITY
+	/* Ready tasks at this priority run earliest deadline first, rather than
+	taking turns.  Higher priorities still preempt them. */
+	#define configEDF_PRIORITY 1
+#endif
+
+#ifndef configUSE_TASK_BUDGETS
+	#define configUSE_TASK_BUDGETS 0
+#endif
+
+#ifndef configUSE_BUDGET_OVERRUN_HOOK
+	#define configUSE_BUDGET_OVERRUN_HOOK 0
+#endif
+
+#ifndef configUSE_PREEMPTION_THRESHOLD
+	#define configUSE_PREEMPTION_THRESHOLD 0
+#endif
+
+#ifndef configUSE_TASK_FPU_POLICY
+	#define configUSE_TASK_FPU_POLICY 0
+#endif
+
+#ifndef configUSE_MPU_STACK_GUARD
+	#define configUSE_MPU_STACK_GUARD 0
+#endif
+
+#ifndef configBUDGET_DEMOTED_PRIORITY
+	/* A task that exhausts its budget runs at this priority until the budget
+	is replenished. */
+	#define configBUDGET_DEMOTED_PRIORITY tskIDLE_PRIORITY
+#endif
+
+#ifndef configTASK_STACK_POOLS
+	/* { stack depth in words, number of stacks }, smallest depth first. */
+	#define configTASK_STACK_POOLS { { configMINIMAL_STACK_SIZE, 2 } }
+#endif
+
 #ifndef configUSE_TASK_NOTIFICATIONS
 	#define configUSE_TASK_NOTIFICATIONS 1
 #endif
 
+#ifndef configTASK_NOTIFICATION_ARRAY_ENTRIES
+	#define configTASK_NOTIFICATION_ARRAY_ENTRIES 1
+#endif
+
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES < 1
+	#error configTASK_NOTIFICATION_ARRAY_ENTRIES must be at least 1
+#endif
+
 #ifndef configUSE_POSIX_ERRNO
 	#define configUSE_POSIX_ERRNO 0
 #endif
@@ -836,6 +1196,86 @@ extern "C" {
 	#define configSUPPORT_DYNAMIC_ALLOCATION 1
 #endif
 
+#if( ( configUSE_TASK_ARENAS == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION != 1 ) )
+	#error configUSE_TASK_ARENAS requires configSUPPORT_DYNAMIC_ALLOCATION to be 1
+#endif
+
+#if( ( configUSE_PREEMPTION_THRESHOLD == 1 ) && ( configUSE_PREEMPTION != 1 ) )
+	#error configUSE_PREEMPTION_THRESHOLD requires configUSE_PREEMPTION to be 1
+#endif
+
+#if( ( configUSE_PREEMPTION_THRESHOLD == 1 ) && ( configUSE_TASK_BUDGETS == 1 ) )
+	#error configUSE_PREEMPTION_THRESHOLD and configUSE_TASK_BUDGETS both move a task off its base priority, and cannot be used together
+#endif
+
+#if( ( configUSE_TIME_SLICE_QUANTA == 1 ) && ( ( configUSE_PREEMPTION != 1 ) || ( configUSE_TIME_SLICING != 1 ) ) )
+	#error configUSE_TIME_SLICE_QUANTA requires configUSE_PREEMPTION and configUSE_TIME_SLICING to be 1
+#endif
+
+#if( ( configUSE_TASK_ENERGY_STATS == 1 ) && ( configGENERATE_RUN_TIME_STATS != 1 ) )
+	#error configUSE_TASK_ENERGY_STATS requires configGENERATE_RUN_TIME_STATS to be 1
+#endif
+
+#if( ( configUSE_SWITCH_PROFILER == 1 ) && !defined( portSWITCH_PROFILE_TIME ) )
+	#error configUSE_SWITCH_PROFILER is set to 1 but the port does not provide the portSWITCH_PROFILE_ macros
+#endif
+
+#if( ( configUSE_MASK_PROFILER == 1 ) && ( !defined( portMASK_PROFILE_TIME ) || !defined( portMASK_PROFILE_CALLER ) ) )
+	#error configUSE_MASK_PROFILER is set to 1 but the port does not provide the portMASK_PROFILE_ macros
+#endif
+
+#if( ( configHEAP_GUARD == 1 ) && ( configHEAP_IMPLEMENTATION != heapIMPLEMENTATION_2 ) )
+	#error configHEAP_GUARD is only implemented by heap_2.c
+#endif
+
+#if( ( configHEAP_LAZY_COALESCE == 1 ) && ( configHEAP_IMPLEMENTATION != heapIMPLEMENTATION_2 ) )
+	#error configHEAP_LAZY_COALESCE is only implemented by heap_2.c
+#endif
+
+#if( ( configHEAP_TRACK_OWNERS == 1 ) && ( configHEAP_IMPLEMENTATION != heapIMPLEMENTATION_REGIONS ) )
+	#error configHEAP_TRACK_OWNERS is only implemented by heap_regions.c
+#endif
+
+#if( ( configHEAP_TRACK_OWNERS == 1 ) && ( ( ( INCLUDE_xTaskGetSchedulerState != 1 ) && ( configUSE_TIMERS != 1 ) ) || ( ( INCLUDE_xTaskGetCurrentTaskHandle != 1 ) && ( configUSE_MUTEXES != 1 ) ) ) )
+	#error configHEAP_TRACK_OWNERS needs xTaskGetSchedulerState() and xTaskGetCurrentTaskHandle()
+#endif
+
+#if( ( configUSE_SECTION_PROFILER == 1 ) && ( configUSE_MASK_PROFILER != 1 ) )
+	#error configUSE_SECTION_PROFILER requires configUSE_MASK_PROFILER to be 1, as masked sections are timed by the port
+#endif
+
+#if( ( configUSE_TIMER_WHEEL == 1 ) && ( configTIMER_WHEEL_SLOT_BITS > 5 ) )
+	#error configTIMER_WHEEL_SLOT_BITS must be 5 or less, as each level tracks its occupied slots in a 32-bit mask
+#endif
+
+#if( ( configUSE_TIMER_WHEEL == 1 ) && ( ( configTIMER_WHEEL_LEVELS * configTIMER_WHEEL_SLOT_BITS ) >= ( ( configUSE_16_BIT_TICKS == 1 ) ? 16 : 32 ) ) )
+	#error The timer wheel must cover fewer ticks than TickType_t can count
+#endif
+
+#if( ( configUSE_DELAY_WHEEL == 1 ) && ( configDELAY_WHEEL_SLOT_BITS > 5 ) )
+	#error configDELAY_WHEEL_SLOT_BITS must be 5 or less, as the occupied slots are tracked in a 32-bit mask
+#endif
+
+#if( ( configUSE_EDF_SCHEDULING == 1 ) && ( ( configEDF_PRIORITY < 1 ) || ( configEDF_PRIORITY >= configMAX_PRIORITIES ) ) )
+	#error configEDF_PRIORITY must be above the idle priority and below configMAX_PRIORITIES
+#endif
+
+#if( ( configUSE_TASK_FPU_POLICY == 1 ) && !defined( portTASK_USED_FPU ) )
+	#error configUSE_TASK_FPU_POLICY is set to 1 but the port does not provide portTASK_USED_FPU()
+#endif
+
+#if( ( configUSE_MPU_STACK_GUARD == 1 ) && !defined( portSET_STACK_GUARD ) )
+	#error configUSE_MPU_STACK_GUARD is set to 1 but the port does not provide portSET_STACK_GUARD()
+#endif
+
+#if( ( configUSE_BUDGET_OVERRUN_HOOK == 1 ) && ( configUSE_TASK_BUDGETS != 1 ) )
+	#error configUSE_BUDGET_OVERRUN_HOOK requires configUSE_TASK_BUDGETS to be 1
+#endif
+
+#if( configHEAP_LOCK_CEILING >= configMAX_PRIORITIES )
+	#error configHEAP_LOCK_CEILING must be below configMAX_PRIORITIES
+#endif
+
 #ifndef configSTACK_DEPTH_TYPE
 	/* Defaults to uint16_t for backward compatibility, but can be overridden
 	in FreeRTOSConfig.h if uint16_t is too restrictive. */
@@ -1099,19 +1539,25 @@ typedef struct xSTATIC_TCB
 		xMPU_SETTINGS	xDummy2;
 	#endif
 	StaticListItem_t	xDummy3[ 2 ];
-	UBaseType_t			uxDummy5;
-	void				*pxDummy6;
-	uint8_t				ucDummy7[ configMAX_TASK_NAME_LEN ];
+	#if ( configUSE_COMPACT_TCB == 1 )
+		uint16_t		usDummy5[ 1 + ( ( configUSE_MUTEXES == 1 ) ? 2 : 0 ) + ( ( configUSE_TRACE_FACILITY == 1 ) ? 2 : 0 ) ];
+		void			*pxDummy6;
+		const char		*pcDummy7;
+	#else
+		UBaseType_t		uxDummy5;
+		void			*pxDummy6;
+		uint8_t			ucDummy7[ configMAX_TASK_NAME_LEN ];
+	#endif
 	#if ( ( portSTACK_GROWTH > 0 ) || ( configRECORD_STACK_HIGH_ADDRESS == 1 ) )
 		void			*pxDummy8;
 	#endif
 	#if ( portCRITICAL_NESTING_IN_TCB == 1 )
 		UBaseType_t		uxDummy9;
 	#endif
-	#if ( configUSE_TRACE_FACILITY == 1 )
+	#if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_COMPACT_TCB == 0 ) )
 		UBaseType_t		uxDummy10[ 2 ];
 	#endif
-	#if ( configUSE_MUTEXES == 1 )
+	#if ( ( configUSE_MUTEXES == 1 ) && ( configUSE_COMPACT_TCB == 0 ) )
 		UBaseType_t		uxDummy12[ 2 ];
 	#endif
 	#if ( configUSE_APPLICATION_TASK_TAG == 1 )
@@ -1121,14 +1567,16 @@ typedef struct xSTATIC_TCB
 		void			*pvDummy15[ configNUM_THREAD_LOCAL_STORAGE_POINTERS ];
 	#endif
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
-		uint32_t		ulDummy16;
+		uint32_t		ulDummy16[ 2 ];
 	#endif
 	#if ( configUSE_NEWLIB_REENTRANT == 1 )
 		struct	_reent	xDummy17;
+	#elif ( configUSE_NEWLIB_REENTRANT == 2 )
+		void			*pxDummy17;
 	#endif
 	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
-		uint32_t 		ulDummy18;
-		uint8_t 		ucDummy19;
+		uint32_t 		ulDummy18[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
+		uint8_t 		ucDummy19[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
 	#endif
 	#if ( tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE != 0 )
 		uint8_t			uxDummy20;
@@ -1140,6 +1588,28 @@ typedef struct xSTATIC_TCB
 	#if ( configUSE_POSIX_ERRNO == 1 )
 		int				iDummy22;
 	#endif
+	#if ( configUSE_TASK_ARENAS == 1 )
+		void			*pxDummy23;
+	#endif
+	#if ( configUSE_SWITCH_PROFILER == 1 )
+		uint32_t		ulDummy24[ 4 + configSWITCH_PROFILE_BUCKETS ];
+	#endif
+	#if ( configUSE_EDF_SCHEDULING == 1 )
+		TickType_t		xDummy25[ 4 ];
+		uint32_t		ulDummy26;
+	#endif
+	#if ( configUSE_TASK_BUDGETS == 1 )
+		StaticListItem_t	xDummy27;
+		TickType_t		xDummy28[ 4 ];
+		UBaseType_t		uxDummy29[ 2 ];
+		uint32_t		ulDummy30;
+	#endif
+	#if ( configUSE_TASK_FPU_POLICY == 1 )
+		UBaseType_t		uxDummy31;
+	#endif
+	#if ( configUSE_IDLE_STACK_PAINTER == 1 )
+		void			*pxDummy32[ 2 ];
+	#endif
 } StaticTask_t;
 
 /*
@@ -1176,6 +1646,8 @@ typedef struct xSTATIC_QUEUE
 
 	#if ( configUSE_QUEUE_SETS == 1 )
 		void *pvDummy7;
+		uint32_t ulDummy7[ 2 ];
+		uint8_t ucDummy7[ 2 ];
 	#endif
 
 	#if ( configUSE_TRACE_FACILITY == 1 )
@@ -1183,6 +1655,10 @@ typedef struct xSTATIC_QUEUE
 		uint8_t ucDummy9;
 	#endif
 
+	#if ( configUSE_ZERO_COPY_QUEUES == 1 )
+		void *pvDummy10;
+	#endif
+
 } StaticQueue_t;
 typedef StaticQueue_t StaticSemaphore_t;
 
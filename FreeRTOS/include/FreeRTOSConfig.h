@@ -44,10 +44,120 @@
 /* Ensure stdint is only used by the compiler, and not the assembler. */
 #if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
 	#include <stdint.h>
+	#include <stddef.h>
 	extern uint32_t SystemCoreClock;
+	extern uint32_t ulCrcComputeWords( const uint32_t *pulWords, size_t xCount );
+	extern void vCrashLogAssert( const char *pcFile, uint32_t ulLine ) __attribute__( ( noreturn ) );
 #endif
 
 #define if_merge_mem                    1
+/* Allocator taken from portable/MemMang - see heapIMPLEMENTATION_* in portable.h. */
+#define configHEAP_IMPLEMENTATION		heapIMPLEMENTATION_REGIONS
+/* Size of the heap_regions.c region in CCM RAM, searched before the SRAM heap.
+CCM is not reachable by DMA. */
+#define configCCM_HEAP_SIZE				( 32 * 1024 )
+/* The SRAM heap is whatever RAM the image leaves free, between the linker
+script's __heap_sram_start and __heap_sram_end, rather than configTOTAL_HEAP_SIZE
+bytes. */
+#define configHEAP_SRAM_FROM_LINKER		1
+/* Time pvPortMalloc() and vPortFree() with DWT->CYCCNT for vPortGetHeapStats(). */
+#define configGENERATE_HEAP_STATS		1
+/* Lock the heap by raising its caller to this priority rather than by
+suspending the scheduler.  Every heap user must run below it: priority 3 is
+time sliced, so with the ceiling there the deferred high worker could take a
+slice from a task inside the heap and enter it too.  Tasks at the top
+priority (the kernel benchmark's peer) must not allocate. */
+#define configHEAP_LOCK_CEILING			( configMAX_PRIORITIES - 1 )
+/* Packet buffers interrupt handlers can take with pvPortMallocFromISR() once
+xPortInitialiseISRPools() has carved them out of the SRAM heap. */
+#define configUSE_ISR_HEAP_POOLS		1
+#define configISR_HEAP_POOLS			{ { 64, 8 }, { 256, 4 } }
+/* Packet, DMA and audio buffers of 64 to 1024 bytes from pvPortBuddyMalloc(),
+in an 8 KB SRAM region of their own rather than among the stacks on the SRAM
+heap. */
+#define configUSE_BUDDY_HEAP			1
+#define configBUDDY_HEAP_MIN_BLOCK_ORDER	6
+#define configBUDDY_HEAP_MAX_BLOCK_ORDER	10
+#define configBUDDY_HEAP_TOP_BLOCKS		8
+/* Log and cache buffers from xHeapHandleAlloc(), in an 8 KB SRAM region the
+idle task compacts, so its free space stays in one piece. */
+#define configUSE_HEAP_HANDLES			1
+#define configHEAP_HANDLE_REGION_SIZE	( 8 * 1024 )
+#define configHEAP_HANDLES				16
+/* heap_2.c only: check words in block headers and tail canaries, checked on
+free and by the idle task a few blocks at a time. */
+#ifndef configHEAP_GUARD
+#define configHEAP_GUARD				0
+#endif
+/* Check words from the CRC unit rather than a multiplicative mix - see
+Core/Inc/crc.h. */
+#define configHEAP_GUARD_CHECK_WORD( pulWords, xCount )	ulCrcComputeWords( ( pulWords ), ( xCount ) )
+/* heap_2.c only: vPortFree() defers merging to the idle task, and pvPortMalloc()
+merges everything still waiting when nothing fits. */
+#ifndef configHEAP_LAZY_COALESCE
+#define configHEAP_LAZY_COALESCE		0
+#endif
+/* Record the allocating task and call site in every block header, and keep
+per task byte counts for vPrintHeapOwners() and uxTaskGetSystemState(). */
+#ifndef configHEAP_TRACK_OWNERS
+#define configHEAP_TRACK_OWNERS			0
+#endif
+/* Free list changes the heap keeps for vPrintHeapChanges(), so print_job only
+sends what changed since its last report rather than the whole list. */
+#define configHEAP_JOURNAL_LENGTH		32
+/* Low-water callbacks registered with xPortHeapWatchAdd(), checked after each
+pvPortMalloc(). */
+#ifndef configUSE_HEAP_WATCH
+#define configUSE_HEAP_WATCH			1
+#endif
+/* Run the context switch, tick, list primitives and allocator from SRAM, clear
+of the flash wait states.  Tools/ramfunc_report.py lists what was placed and
+compares the cycle counts of a flash and a RAM build. */
+#define configKERNEL_HOT_PATHS_IN_RAM	1
+#define configHEAP_HOT_PATHS_IN_RAM		1
+/* Queue, stream buffer and reallocation copies and stack fills through the
+port's word copy and fill (portable/ARM_CM4F/memops.c) rather than
+newlib-nano's byte loops. */
+#define configUSE_PORT_MEMOPS			1
+/* Keep the scheduler state in CCM, which the D-bus reaches with no wait states
+and no contention from DMA on SRAM1.  .ccmram is copied from flash at boot. */
+#define configKERNEL_DATA_ATTRIBUTE		__attribute__( ( section( ".ccmram" ) ) )
+/* The boot tasks and the idle task are static (Core/Src/taskreg.c); the heap
+is only used by tasks and objects created at run time. */
+#define configSUPPORT_STATIC_ALLOCATION	1
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
+/* Take TCBs and task stacks for run time xTaskCreate() calls from fixed-size
+pools carved out of the heap once, falling back to pvPortMalloc() when a pool
+is empty.  Stack classes are { depth in words, count }, smallest first. */
+#define configUSE_TASK_POOLS			1
+#define configTASK_TCB_POOL_LENGTH		8
+#define configTASK_STACK_POOLS			{ { 64, 3 }, { 160, 5 } }
+/* Queue, semaphore, mutex, event group and stream buffer structures from
+512 byte slabs of their own kind rather than one heap block each; queue and
+stream buffer storage still comes from the heap. */
+#define configUSE_KERNEL_SLABS			1
+#define configKERNEL_SLAB_SIZE			512
+/* Allow tasks to own a bump-pointer arena that is freed with the task. */
+#define configUSE_TASK_ARENAS			1
+/* Every task shares newlib's reent, and only one that calls
+xTaskNewlibReentCreate() gets one of its own, from the heap. */
+#define configUSE_NEWLIB_REENTRANT		2
+/* Time the PendSV handler and each task's wait between becoming ready and
+running, using the DWT cycle counter started for the run time stats. */
+#define configUSE_SWITCH_PROFILER		1
+/* Time the longest section with BASEPRI raised and where it was raised and
+cleared, for the interrupt latency mode of Core/Inc/irqlat.h. */
+#ifndef configUSE_MASK_PROFILER
+#define configUSE_MASK_PROFILER			0
+#endif
+/* On top of that, keep the worst call sites of masked sections and of
+scheduler suspension in tables of configSECTION_PROFILE_SITES entries. */
+#ifndef configUSE_SECTION_PROFILER
+#define configUSE_SECTION_PROFILER		0
+#endif
+/* Keep delayed tasks in a wheel of unsorted lists hashed by wake time, so
+blocking with a timeout does not walk a sorted list - see tasks.c. */
+#define configUSE_DELAY_WHEEL			1
 #define configUSE_PREEMPTION			1
 #define configUSE_IDLE_HOOK				0
 #define configUSE_TICK_HOOK				0
@@ -55,29 +165,94 @@
 #define configTICK_RATE_HZ				( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES			( 5 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 130 )
+/* Only used by the allocators that have a single static array. */
 #define configTOTAL_HEAP_SIZE			( ( size_t ) ( 5 * 1024 ) )
 #define configMAX_TASK_NAME_LEN			( 10 )
+/* 16 bit priority, mutex and task number fields, and the name kept as a
+pointer to the string given at creation.  Every task here is named with a
+literal (Core/Src/taskreg.c and the kernel's own tasks). */
+#define configUSE_COMPACT_TCB			1
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
 #define configIDLE_SHOULD_YIELD			1
+/* Equal priority tasks take turns every tick above the idle priority, where
+the background tasks (the trace drain, the profiler report) run 10 ms slices
+and switch a tenth as often.  The idle task still yields to them at once. */
+#define configUSE_TIME_SLICE_QUANTA		1
+#define configTIME_SLICE_QUANTA			{ 10, 1, 1, 1, 1 }
 #define configUSE_MUTEXES				1
 #define configQUEUE_REGISTRY_SIZE		8
+/* Allow queues that pass ownership of mempool.h buffers by pointer rather
+than copying each item in and out - see xQueueCreateZeroCopy(). */
+#define configUSE_ZERO_COPY_QUEUES		1
+/* Move runs of queue items under one critical section - see
+uxQueueSendMultiple(). */
+#define configUSE_QUEUE_BATCH_OPERATIONS	1
+/* Keep the lowest 32 bytes of the running task's stack read only through the
+MPU, so an overflow faults at the store that makes it and Core/Src/fault.c
+names the task.  Without the guard, check the stack pointer and the last 16
+bytes of fill pattern at every switch out instead; the hook is in
+Core/Src/stackcheck.c. */
+#ifndef configUSE_MPU_STACK_GUARD
+#define configUSE_MPU_STACK_GUARD		1
+#endif
+#if ( configUSE_MPU_STACK_GUARD == 1 )
 #define configCHECK_FOR_STACK_OVERFLOW	0
+#else
+#define configCHECK_FOR_STACK_OVERFLOW	2
+#endif
+/* New stacks are filled with the high water mark pattern only over their
+lowest 32 words, so creating a task costs the same whatever its stack depth,
+and the idle task paints the rest a step at a time.  Until it has, the high
+water mark of a task reports at most the window as free. */
+#define configSTACK_FILL_WINDOW			32
+#define configUSE_IDLE_STACK_PAINTER	1
+/* Tasks are integer only unless vTaskSetFpuPolicy() allows them the FPU, so
+they switch without s16-s31; one switched out with an FPU frame stops in
+vApplicationFpuMisuseHook() in main.c. */
+#ifndef configUSE_TASK_FPU_POLICY
+#define configUSE_TASK_FPU_POLICY		1
+#endif
 #define configUSE_RECURSIVE_MUTEXES		1
 #define configUSE_MALLOC_FAILED_HOOK	0
 #define configUSE_APPLICATION_TASK_TAG	0
 #define configUSE_COUNTING_SEMAPHORES	1
-#define configGENERATE_RUN_TIME_STATS	0
+/* Queue sets, including the masked sets that report every ready member in one
+32-bit mask (xQueueCreateSetMasked()). */
+#define configUSE_QUEUE_SETS			1
+/* Notification values per task.  Index 0 is the default, which the kernel's
+own objects and the drivers in Core/Src use; futures wake their waiters on 1
+(Core/Inc/future.h), and 2 is left for notification semaphores
+(Core/Inc/notifysem.h). */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES	3
+#define configGENERATE_RUN_TIME_STATS	1
+/* Run time split by clock profile, which clockprofile.c reports with
+vTaskSetEnergyProfile(), and the task each exit from tickless idle woke for -
+see Core/Inc/cpustats.h. */
+#define configUSE_TASK_ENERGY_STATS		1
+#define configENERGY_PROFILES			3
+#define configUSE_TRACE_RECORDER		1
+/* Tickless idle is provided by Core/Src/lowpower.c, which sleeps in STOP mode
+and times the idle period with the RTC wakeup timer. */
+#define configUSE_TICKLESS_IDLE			2
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP	5
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
 #define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
 
-/* Software timer definitions. */
-#define configUSE_TIMERS				0
+/* Software timer definitions.  Active timers are kept in a hierarchical
+wheel rather than in sorted lists, and batches of timers can be started or
+stopped with one command queue message. */
+#define configUSE_TIMERS				1
+#define configUSE_TIMER_WHEEL			1
+#define configUSE_TIMER_BATCH_COMMANDS	1
 #define configTIMER_TASK_PRIORITY		( 2 )
 #define configTIMER_QUEUE_LENGTH		10
 #define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE * 2 )
+/* Core/Src/stackcheck.c repaints the main stack from the hook, once main()
+has no further use for it. */
+#define configUSE_DAEMON_TASK_STARTUP_HOOK	1
 
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
@@ -88,6 +263,8 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
+#define INCLUDE_xTaskGetIdleTaskHandle	1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -114,14 +291,37 @@ to all Cortex-M ports, and do not rely on any particular library functions. */
 See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY 	( configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) )
 	
-/* Normal assert() semantics without relying on the provision of an assert.h
-header file. */
-#define configASSERT( x ) if( ( x ) == 0 ) { taskDISABLE_INTERRUPTS(); for( ;; ); }	
+/* A failed assertion is kept in the crash log and resets the core, or stops
+it while a debugger is attached - see Core/Inc/crashlog.h. */
+#define configASSERT( x ) if( ( x ) == 0 ) { vCrashLogAssert( __FILE__, __LINE__ ); }
 	
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
-standard names. */
+standard names.  The tick comes from TIM5 rather than SysTick, and
+xPortSysTickHandler() is called from Core/Src/timebase.c. */
 #define vPortSVCHandler SVC_Handler
 #define xPortPendSVHandler PendSV_Handler
-#define xPortSysTickHandler SysTick_Handler
+
+/* Free running microsecond counter behind ulTaskGetTickCountUs() - see
+Core/Inc/timebase.h. */
+#define portGET_TIME_US()			( TIM5->CNT )
+
+/* Kernel trace hooks.  trace.h records the allocator, scheduler, queue and
+notification hooks into the binary trace ring rather than printing from inside
+the kernel; Tools/trace_export.py turns a capture into a Perfetto timeline. */
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+	#include "trace.h"
+	#include "dwt.h"
+	extern void vBootTimeFirstTask( void );
+#endif
+
+/* Stamp the end of the boot trace as the first task starts - see
+Core/Inc/boottime.h. */
+#define traceSTART_FIRST_TASK()		vBootTimeFirstTask()
+
+/* Run time stats count core clock cycles on the DWT.  CYCCNT wraps after
+2^32 cycles (about 25 s at 168 MHz) and stops in STOP mode, so loads are best
+taken as differences over shorter windows - see Core/Src/cpustats.c. */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	vDwtInit()
+#define portGET_RUN_TIME_COUNTER_VALUE()			ulDwtCycles()
 
 #endif /* FREERTOS_CONFIG_H */
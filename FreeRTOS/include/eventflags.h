@@ -0,0 +1,85 @@
+/*
+ * Event flags that interrupts set directly.
+ *
+ * xEventGroupSetBitsFromISR() cannot touch an event group's list of waiting
+ * tasks from an interrupt, because task level code walks that list with only
+ * the scheduler suspended, so it defers the work to the timer service task.
+ * An event flags object keeps its waiters on a list that is only ever walked
+ * with interrupts masked instead, so xEventFlagsSetFromISR() wakes every
+ * satisfied waiter itself: a waiting task runs on the context switch at the
+ * end of the interrupt.  The walk is bounded by the number of tasks waiting
+ * on the object.
+ *
+ * Each waiter is woken with a direct to task notification carrying the flags
+ * that satisfied it, so a task's notification value must not be used for
+ * anything else while it waits.  The wait record lives on the waiting task's
+ * stack, so nothing is allocated.
+ *
+ * The waiting semantics are those of xEventGroupWaitBits().  All bits of
+ * EventBits_t can be used.
+ */
+
+#ifndef EVENTFLAGS_H
+#define EVENTFLAGS_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include eventflags.h"
+#endif
+
+#include "task.h"
+#include "event_groups.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/*
+ * The object itself.  Declare one as a variable and set it up with
+ * vEventFlagsInit(); the members are private.
+ */
+typedef struct xEVENT_FLAGS
+{
+	volatile EventBits_t uxBits;
+	struct xEVENT_FLAGS_WAITER *pxWaiters;			/*< Tasks blocked in xEventFlagsWait(), newest first.  Only used with interrupts masked. */
+} EventFlags_t;
+
+/*
+ * Clear all flags.  No task may be waiting.
+ */
+void vEventFlagsInit( EventFlags_t *pxFlags ) PRIVILEGED_FUNCTION;
+
+/*
+ * Set uxBitsToSet and wake every waiter they satisfy, then clear the bits of
+ * any woken waiter that asked for them to be cleared on exit.  Returns the
+ * flags left set.  The FromISR variant sets *pxHigherPriorityTaskWoken to
+ * pdTRUE if a woken task should run as soon as the interrupt returns; it may
+ * be called from interrupts at or below configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ */
+EventBits_t xEventFlagsSet( EventFlags_t *pxFlags, EventBits_t uxBitsToSet ) PRIVILEGED_FUNCTION;
+EventBits_t xEventFlagsSetFromISR( EventFlags_t *pxFlags, EventBits_t uxBitsToSet, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/*
+ * Clear uxBitsToClear and return the flags as they were before.  Safe from
+ * tasks and interrupts alike.
+ */
+EventBits_t xEventFlagsClear( EventFlags_t *pxFlags, EventBits_t uxBitsToClear ) PRIVILEGED_FUNCTION;
+
+/*
+ * The flags now set.
+ */
+EventBits_t xEventFlagsGet( const EventFlags_t *pxFlags ) PRIVILEGED_FUNCTION;
+
+/*
+ * Wait up to xTicksToWait for any of uxBitsToWaitFor, or all of them if
+ * xWaitForAllBits is pdTRUE, and clear them on the way out if xClearOnExit is
+ * pdTRUE.  Returns the flags as they were when the wait was satisfied, before
+ * any clearing, or as they are when it timed out; test the result to tell
+ * which.  Must be called from a task unless xTicksToWait is 0.
+ */
+EventBits_t xEventFlagsWait( EventFlags_t *pxFlags, EventBits_t uxBitsToWaitFor, BaseType_t xClearOnExit, BaseType_t xWaitForAllBits, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* EVENTFLAGS_H */
@@ -0,0 +1,75 @@
+/*
+ * Mutexes whose uncontended take and give do not enter the kernel.
+ *
+ * xSemaphoreTake() on a mutex always goes through xQueueSemaphoreTake(), with
+ * a critical section and the queue bookkeeping even when nobody else holds
+ * it.  A fast mutex is a single word holding its owner: an uncontended take
+ * or give is one exclusive compare and swap (LDREX and STREX on Cortex-M4),
+ * with no critical section and no call into the kernel.
+ *
+ * Only a task that finds the mutex held goes the slow way.  It marks the
+ * mutex contended, raises the owner to its own priority as a kernel mutex
+ * would, and blocks.  The give that finds the contended mark hands the mutex
+ * straight to the highest priority waiter and drops any priority the owner
+ * inherited.  As with kernel mutexes, an inherited priority is only dropped
+ * once the owner holds no kernel mutexes, and is not dropped early if the
+ * waiter that caused it times out.
+ *
+ * Each waiter is woken with a direct to task notification, so a task's
+ * notification value must not be used for anything else while it waits.  The
+ * wait record lives on the waiting task's stack, so nothing is allocated.
+ * Fast mutexes are not recursive and cannot be used from interrupts.
+ */
+
+#ifndef FASTMUTEX_H
+#define FASTMUTEX_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include fastmutex.h"
+#endif
+
+#include "task.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/*
+ * The mutex itself.  Declare one as a variable and set it up with
+ * vFastMutexInit(); the members are private.
+ */
+typedef struct xFAST_MUTEX
+{
+	volatile uint32_t ulState;					/*< The owner's handle, with bit 0 set if tasks are waiting, or 0 if free. */
+	struct xFAST_MUTEX_WAITER *pxWaiters;		/*< Highest priority first.  Only used in critical sections. */
+} FastMutex_t;
+
+/*
+ * Make the mutex free.  No task may hold it or be waiting for it.
+ */
+void vFastMutexInit( FastMutex_t *pxMutex ) PRIVILEGED_FUNCTION;
+
+/*
+ * Take the mutex, waiting up to xTicksToWait for it if another task holds
+ * it.  Returns pdPASS if the mutex was taken, otherwise pdFAIL.  Must be
+ * called from a task unless xTicksToWait is 0, and the calling task must not
+ * already hold the mutex.
+ */
+BaseType_t xFastMutexTake( FastMutex_t *pxMutex, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Give back the mutex, which the calling task must hold.  Always returns
+ * pdPASS.
+ */
+BaseType_t xFastMutexGive( FastMutex_t *pxMutex ) PRIVILEGED_FUNCTION;
+
+/*
+ * The task holding the mutex, or NULL if it is free.
+ */
+TaskHandle_t xFastMutexGetOwner( const FastMutex_t *pxMutex ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* FASTMUTEX_H */
@@ -389,6 +389,23 @@ void vListInsert( List_t * const pxList, ListItem_t * const pxNewListItem ) PRIV
  */
 void vListInsertEnd( List_t * const pxList, ListItem_t * const pxNewListItem ) PRIVILEGED_FUNCTION;
 
+/*
+ * Insert a list item into a list immediately in front of pxPosition, which is
+ * either an item already in the list or the list's end marker.  Lets a list
+ * be kept in an order that vListInsert() cannot express, such as one that
+ * allows for the tick count overflowing.
+ *
+ * @param pxList The list into which the item is to be inserted.
+ *
+ * @param pxPosition The item, or end marker, to insert in front of.
+ *
+ * @param pxNewListItem The list item to be inserted into the list.
+ *
+ * \page vListInsertBefore vListInsertBefore
+ * \ingroup LinkedList
+ */
+void vListInsertBefore( List_t * const pxList, ListItem_t * const pxPosition, ListItem_t * const pxNewListItem ) PRIVILEGED_FUNCTION;
+
 /*
  * Remove an item from a list.  The list item has a pointer to the list that
  * it is in, so only the list item need be passed into the function.
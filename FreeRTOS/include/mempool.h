@@ -0,0 +1,75 @@
+/*
+ * Fixed size block pools.
+ *
+ * A pool carves one block of storage into equal sized blocks and keeps the
+ * free ones on a singly linked list threaded through the blocks themselves,
+ * so allocating is a pop and freeing is a push, both O(1) and free of
+ * fragmentation.  The list is protected by masking interrupts up to
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY for the few instructions of the push
+ * or pop, so a pool can be used from tasks and from interrupts.
+ */
+
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include mempool.h"
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/*
+ * The pool itself.  Declare one as a variable and set it up with
+ * vMemPoolInit(); the members are private.
+ */
+typedef struct xMEMPOOL
+{
+	void *pvFreeList;					/*< First free block, each free block holds a pointer to the next. */
+	uint8_t *pucStart;					/*< Storage managed by the pool, used to tell whether a block belongs to it. */
+	uint8_t *pucEnd;
+	size_t xBlockSize;					/*< Size of each block after alignment. */
+	UBaseType_t uxFreeBlocks;
+	UBaseType_t uxMinimumFreeBlocks;	/*< Low water mark of uxFreeBlocks. */
+} MemPool_t;
+
+/*
+ * Size of the storage needed for uxBlockCount blocks of xBlockSize bytes.
+ */
+#define mempoolSTORAGE_SIZE( xBlockSize, uxBlockCount ) \
+	( ( ( ( ( ( size_t ) ( xBlockSize ) ) < sizeof( void * ) ? sizeof( void * ) : ( size_t ) ( xBlockSize ) ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ) * ( size_t ) ( uxBlockCount ) )
+
+/*
+ * Turn pvStorage, which must be aligned to portBYTE_ALIGNMENT and at least
+ * mempoolSTORAGE_SIZE( xBlockSize, uxBlockCount ) bytes, into a pool of
+ * uxBlockCount blocks.  A NULL pvStorage gives an empty pool.
+ */
+void vMemPoolInit( MemPool_t *pxPool, void *pvStorage, size_t xBlockSize, UBaseType_t uxBlockCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Take a block from the pool.  Returns NULL if the pool is empty.
+ */
+void *pvMemPoolAlloc( MemPool_t *pxPool ) PRIVILEGED_FUNCTION;
+
+/*
+ * Return a block obtained from pvMemPoolAlloc() on the same pool.
+ */
+void vMemPoolFree( MemPool_t *pxPool, void *pv ) PRIVILEGED_FUNCTION;
+
+/*
+ * pdTRUE if pv lies within the storage of the pool.
+ */
+BaseType_t xMemPoolContains( const MemPool_t *pxPool, const void *pv ) PRIVILEGED_FUNCTION;
+
+/*
+ * The number of blocks currently free, and the fewest there have ever been.
+ */
+UBaseType_t uxMemPoolGetFreeBlocks( const MemPool_t *pxPool ) PRIVILEGED_FUNCTION;
+UBaseType_t uxMemPoolGetMinimumFreeBlocks( const MemPool_t *pxPool ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* MEMPOOL_H */
@@ -203,6 +203,48 @@ MessageBufferHandle_t xMessageBuffer;
  */
 #define xMessageBufferCreateStatic( xBufferSizeBytes, pucMessageBufferStorageArea, pxStaticMessageBuffer ) ( MessageBufferHandle_t ) xStreamBufferGenericCreateStatic( xBufferSizeBytes, 0, pdTRUE, pucMessageBufferStorageArea, pxStaticMessageBuffer )
 
+/**
+ * message_buffer.h
+ *
+<pre>
+MessageBufferHandle_t xMessageBufferCreateCompact( size_t xBufferSizeBytes,
+                                                   size_t xLengthBytes );
+
+MessageBufferHandle_t xMessageBufferCreateCompactStatic( size_t xBufferSizeBytes,
+                                                         size_t xLengthBytes,
+                                                         uint8_t *pucMessageBufferStorageArea,
+                                                         StaticMessageBuffer_t *pxStaticMessageBuffer );
+</pre>
+ *
+ * As xMessageBufferCreate() and xMessageBufferCreateStatic(), but each
+ * message's length is stored in xLengthBytes bytes rather than in
+ * sizeof( size_t ) bytes, so a 10 byte message takes up 11 or 12 bytes of
+ * message buffer space instead of 14.  The rest of the message buffer API is
+ * used unchanged.
+ *
+ * @param xLengthBytes 1 or 2, which limits messages to 255 or 65535 bytes
+ * respectively.  Sending a longer message fails an assertion, or returns 0 if
+ * configASSERT() is not defined.
+ *
+ * Example use:
+<pre>
+
+// Trace records of up to 32 bytes, with a one byte length each.
+MessageBufferHandle_t xTraceBuffer;
+
+void vAFunction( void )
+{
+    xTraceBuffer = xMessageBufferCreateCompact( 1024, 1 );
+    configASSERT( xTraceBuffer );
+}
+
+</pre>
+ * \defgroup xMessageBufferCreateCompact xMessageBufferCreateCompact
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferCreateCompact( xBufferSizeBytes, xLengthBytes ) ( MessageBufferHandle_t ) xStreamBufferGenericCreate( xBufferSizeBytes, ( size_t ) 0, ( BaseType_t ) ( xLengthBytes ) + ( BaseType_t ) 1 )
+#define xMessageBufferCreateCompactStatic( xBufferSizeBytes, xLengthBytes, pucMessageBufferStorageArea, pxStaticMessageBuffer ) ( MessageBufferHandle_t ) xStreamBufferGenericCreateStatic( xBufferSizeBytes, 0, ( BaseType_t ) ( xLengthBytes ) + ( BaseType_t ) 1, pucMessageBufferStorageArea, pxStaticMessageBuffer )
+
 /**
  * message_buffer.h
  *
@@ -595,6 +637,69 @@ BaseType_t xHigherPriorityTaskWoken = pdFALSE;  // Initialised to pdFALSE.
  */
 #define xMessageBufferReceiveFromISR( xMessageBuffer, pvRxData, xBufferLengthBytes, pxHigherPriorityTaskWoken ) xStreamBufferReceiveFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pvRxData, xBufferLengthBytes, pxHigherPriorityTaskWoken )
 
+/**
+ * message_buffer.h
+ *
+<pre>
+size_t xMessageBufferReceiveMultiple( MessageBufferHandle_t xMessageBuffer,
+                                      void *pvRxData,
+                                      size_t xBufferLengthBytes,
+                                      size_t *pxMessageLengths,
+                                      size_t xMaxMessages,
+                                      TickType_t xTicksToWait );
+</pre>
+ *
+ * Receives up to xMaxMessages messages in one call.  The messages are copied
+ * one after another into pvRxData and the length of each is written to
+ * pxMessageLengths.  Copying stops at the first message that does not fit in
+ * what remains of pvRxData, which is left in the message buffer for the next
+ * call.  A task blocked sending to the message buffer is notified once for the
+ * whole batch rather than once per message.
+ *
+ * Blocks for up to xTicksToWait only if the message buffer is empty, exactly
+ * as xMessageBufferReceive() does.  Use only from a task.
+ *
+ * @param xMessageBuffer The handle of the message buffer.
+ *
+ * @param pvRxData The buffer the messages are copied into.
+ *
+ * @param xBufferLengthBytes The length of the buffer pointed to by pvRxData.
+ *
+ * @param pxMessageLengths An array of at least xMaxMessages entries that
+ * receives the length of each message copied.
+ *
+ * @param xMaxMessages The most messages to receive.
+ *
+ * @param xTicksToWait The maximum amount of time the task should remain in the
+ * Blocked state to wait for a message, should the message buffer be empty.
+ *
+ * @return The number of messages received, which is 0 if the wait timed out
+ * or the first message is longer than xBufferLengthBytes.
+ *
+ * Example use:
+<pre>
+void vADrainTask( void *pvParameters )
+{
+uint8_t ucRecords[ 256 ];
+size_t xLengths[ 16 ], xCount, x, xOffset;
+
+    for( ;; )
+    {
+        xCount = xMessageBufferReceiveMultiple( xTraceBuffer, ucRecords, sizeof( ucRecords ), xLengths, 16, portMAX_DELAY );
+
+        for( x = 0, xOffset = 0; x < xCount; x++ )
+        {
+            vProcessRecord( &( ucRecords[ xOffset ] ), xLengths[ x ] );
+            xOffset += xLengths[ x ];
+        }
+    }
+}
+</pre>
+ * \defgroup xMessageBufferReceiveMultiple xMessageBufferReceiveMultiple
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferReceiveMultiple( xMessageBuffer, pvRxData, xBufferLengthBytes, pxMessageLengths, xMaxMessages, xTicksToWait ) xStreamBufferReceiveMessages( ( StreamBufferHandle_t ) xMessageBuffer, pvRxData, xBufferLengthBytes, pxMessageLengths, xMaxMessages, xTicksToWait )
+
 /**
  * message_buffer.h
  *
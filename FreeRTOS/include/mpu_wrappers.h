@@ -32,6 +32,21 @@
 only for ports that are using the MPU. */
 #ifdef portUSING_MPU_WRAPPERS
 
+	/* Where the privileged data, the privileged functions and the system
+	calls are placed.  A port that protects the kernel some other way, such as
+	by where in the memory map its data already is, defines its own. */
+	#ifndef portPRIVILEGED_DATA
+		#define portPRIVILEGED_DATA __attribute__((section("privileged_data")))
+	#endif
+
+	#ifndef portPRIVILEGED_FUNCTION
+		#define portPRIVILEGED_FUNCTION __attribute__((section("privileged_functions")))
+	#endif
+
+	#ifndef portFREERTOS_SYSTEM_CALL
+		#define portFREERTOS_SYSTEM_CALL __attribute__((section( "freertos_system_calls")))
+	#endif
+
 	/* MPU_WRAPPERS_INCLUDED_FROM_API_FILE will be defined when this file is
 	included from queue.c or task.c to prevent it from having an effect within
 	those files. */
@@ -79,9 +94,10 @@ only for ports that are using the MPU. */
 		#define vTaskGetRunTimeStats					MPU_vTaskGetRunTimeStats
 		#define xTaskGetIdleRunTimeCounter				MPU_xTaskGetIdleRunTimeCounter
 		#define xTaskGenericNotify						MPU_xTaskGenericNotify
-		#define xTaskNotifyWait							MPU_xTaskNotifyWait
-		#define ulTaskNotifyTake						MPU_ulTaskNotifyTake
-		#define xTaskNotifyStateClear					MPU_xTaskNotifyStateClear
+		#define xTaskGenericNotifyWait					MPU_xTaskGenericNotifyWait
+		#define ulTaskGenericNotifyTake					MPU_ulTaskGenericNotifyTake
+		#define xTaskGenericNotifyStateClear			MPU_xTaskGenericNotifyStateClear
+		#define ulTaskGenericNotifyValueClear			MPU_ulTaskGenericNotifyValueClear
 
 		#define xTaskGetCurrentTaskHandle				MPU_xTaskGetCurrentTaskHandle
 		#define vTaskSetTimeOutState					MPU_vTaskSetTimeOutState
@@ -109,6 +125,9 @@ only for ports that are using the MPU. */
 		#define xQueueAddToSet							MPU_xQueueAddToSet
 		#define xQueueRemoveFromSet						MPU_xQueueRemoveFromSet
 		#define xQueueSelectFromSet						MPU_xQueueSelectFromSet
+		#define xQueueCreateSetMasked					MPU_xQueueCreateSetMasked
+		#define ulQueueSelectMaskFromSet				MPU_ulQueueSelectMaskFromSet
+		#define uxQueueGetSetIndex						MPU_uxQueueGetSetIndex
 		#define xQueueGenericReset						MPU_xQueueGenericReset
 
 		#if( configQUEUE_REGISTRY_SIZE > 0 )
@@ -160,15 +179,15 @@ only for ports that are using the MPU. */
 		macro so applications can place data in privileged access sections
 		(useful when using statically allocated objects). */
 		#define PRIVILEGED_FUNCTION
-		#define PRIVILEGED_DATA __attribute__((section("privileged_data")))
+		#define PRIVILEGED_DATA portPRIVILEGED_DATA
 		#define FREERTOS_SYSTEM_CALL
 
 	#else /* MPU_WRAPPERS_INCLUDED_FROM_API_FILE */
 
 		/* Ensure API functions go in the privileged execution section. */
-		#define PRIVILEGED_FUNCTION __attribute__((section("privileged_functions")))
-		#define PRIVILEGED_DATA __attribute__((section("privileged_data")))
-		#define FREERTOS_SYSTEM_CALL __attribute__((section( "freertos_system_calls")))
+		#define PRIVILEGED_FUNCTION portPRIVILEGED_FUNCTION
+		#define PRIVILEGED_DATA portPRIVILEGED_DATA
+		#define FREERTOS_SYSTEM_CALL portFREERTOS_SYSTEM_CALL
 
 	#endif /* MPU_WRAPPERS_INCLUDED_FROM_API_FILE */
 
@@ -118,13 +118,17 @@ extern "C" {
 	#endif
 #endif
 
-/* Used by heap_5.c. */
+/* Used by heap_5.c and heap_regions.c. */
 typedef struct HeapRegion
 {
 	uint8_t *pucStartAddress;
 	size_t xSizeInBytes;
+	UBaseType_t uxAttributes;	/* heapREGION_* flags, only used by heap_regions.c. */
 } HeapRegion_t;
 
+/* HeapRegion_t attributes. */
+#define heapREGION_DMA_CAPABLE		( 1U << 0 )	/* DMA controllers can reach the region. */
+
 /*
  * Used to define multiple heap regions for use by heap_5.c.  This function
  * must be called before any calls to pvPortMalloc() - not creating a task,
@@ -138,6 +142,126 @@ typedef struct HeapRegion
  */
 void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) PRIVILEGED_FUNCTION;
 
+/*
+ * pvPortMalloc() with placement constraints.  heapALLOC_DMA_CAPABLE restricts
+ * the allocation to regions marked heapREGION_DMA_CAPABLE, and must be used for
+ * any buffer a DMA stream will read or write.  Allocators with a single SRAM
+ * heap ignore the flags.
+ */
+#define heapALLOC_DMA_CAPABLE		( 1U << 0 )
+
+void *pvPortMallocFlags( size_t xWantedSize, UBaseType_t uxFlags ) PRIVILEGED_FUNCTION;
+
+/*
+ * Resize a block from pvPortMalloc().  The block is shrunk in place, and grown
+ * in place when the block physically following it is free and large enough,
+ * so the old and new buffers never have to exist side by side.  Only when that
+ * fails is a new block allocated, the contents copied and the old block freed.
+ * A NULL pv behaves as pvPortMalloc(), a zero xWantedSize as vPortFree().  On
+ * failure NULL is returned and pv is left untouched.
+ */
+void *pvPortRealloc( void *pv, size_t xWantedSize ) PRIVILEGED_FUNCTION;
+
+/*
+ * pvPortMallocFlags() returning memory aligned to xAlignment bytes, which must
+ * be a power of two - for example 32 for DMA buffers that should not share a
+ * cache line or burst with anything else.  The padding needed to reach the
+ * alignment is returned to the heap rather than wasted, and the block can be
+ * freed with vPortFree() or resized with pvPortRealloc() like any other
+ * (pvPortRealloc() does not preserve the alignment if it has to move it).
+ */
+void *pvPortMallocAligned( size_t xWantedSize, size_t xAlignment, UBaseType_t uxFlags ) PRIVILEGED_FUNCTION;
+
+/*
+ * Fixed size blocks for interrupt handlers, which cannot call pvPortMalloc().
+ * configISR_HEAP_POOLS lists { block size in bytes, number of blocks } pairs,
+ * smallest first.  xPortInitialiseISRPools() takes DMA capable storage for
+ * every pool from the heap and must be called from main() or a task before
+ * any interrupt allocates; it returns pdFAIL if the heap could not provide
+ * all of it.  pvPortMallocFromISR() returns a block from the smallest class
+ * that fits and has one free, or NULL, and vPortFreeFromISR() gives it back.
+ * Both may be called from tasks as well as from interrupts at or below
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY.  uxPortGetISRPoolMinimumFreeBlocks()
+ * is the low water mark of the xPool'th class.  Only available when
+ * configUSE_ISR_HEAP_POOLS is 1.
+ */
+BaseType_t xPortInitialiseISRPools( void ) PRIVILEGED_FUNCTION;
+void *pvPortMallocFromISR( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+void vPortFreeFromISR( void *pv ) PRIVILEGED_FUNCTION;
+UBaseType_t uxPortGetISRPoolMinimumFreeBlocks( size_t xPool ) PRIVILEGED_FUNCTION;
+
+/*
+ * Power of two blocks from a region of their own, for packet, DMA and audio
+ * buffers - see heap_buddy.c.  pvPortBuddyMalloc() rounds xWantedSize up to a
+ * power of two of at least 2^configBUDDY_HEAP_MIN_BLOCK_ORDER bytes and
+ * returns a block aligned to that size, or NULL if the request is larger than
+ * 2^configBUDDY_HEAP_MAX_BLOCK_ORDER bytes or no block that large is free.
+ * The region is in SRAM, so every block is DMA capable.  vPortBuddyFree()
+ * gives a block back, and xPortBuddyContains() tells whether a pointer is in
+ * the region.  All of them may be called from tasks and from interrupts at or
+ * below configMAX_SYSCALL_INTERRUPT_PRIORITY.  Only available when
+ * configUSE_BUDDY_HEAP is 1.
+ */
+typedef struct xBUDDY_HEAP_STATS
+{
+	size_t xRegionSize;
+	size_t xFreeBytes;
+	size_t xMinimumEverFreeBytes;
+	size_t xLargestFreeBlock;			/* Largest block pvPortBuddyMalloc() could return now. */
+	size_t xSuccessfulAllocations;
+	size_t xFailedAllocations;
+	size_t xSuccessfulFrees;
+} BuddyHeapStats_t;
+
+void *pvPortBuddyMalloc( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+void vPortBuddyFree( void *pv ) PRIVILEGED_FUNCTION;
+BaseType_t xPortBuddyContains( const void *pv ) PRIVILEGED_FUNCTION;
+void vPortGetBuddyHeapStats( BuddyHeapStats_t *pxStats ) PRIVILEGED_FUNCTION;
+
+/*
+ * Movable blocks reached through handles, from a region the idle task
+ * compacts - see heap_handle.c.  xHeapHandleAlloc() returns a handle to a
+ * block of at least xWantedSize bytes, or NULL.  pvHeapHandleLock() returns
+ * the block's current address and keeps it there until the matching
+ * vHeapHandleUnlock(); locks nest, and a pointer must not be used once the
+ * handle is unlocked.  A handle must be unlocked before vHeapHandleFree().
+ * xPortHeapCompactStep() moves at most one unlocked block down over free
+ * space, with the heap locked, and returns pdTRUE once nothing more can be
+ * moved; the idle task calls it.  All of them are for tasks only.  Only
+ * available when configUSE_HEAP_HANDLES is 1.
+ */
+typedef struct xHEAP_HANDLE * HeapHandle_t;
+
+typedef struct xHEAP_HANDLE_STATS
+{
+	size_t xRegionSize;
+	size_t xFreeBytes;						/* Headers of free blocks included. */
+	size_t xMinimumEverFreeBytes;
+	size_t xLargestFreeBlock;				/* Largest request that could succeed without compacting. */
+	size_t xFreeBlocks;
+	UBaseType_t uxHandlesInUse;
+	size_t xFailedAllocations;
+	size_t xBytesMoved;						/* By compaction, since boot. */
+	size_t xBlocksMoved;
+} HeapHandleStats_t;
+
+HeapHandle_t xHeapHandleAlloc( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+void vHeapHandleFree( HeapHandle_t xHandle ) PRIVILEGED_FUNCTION;
+void *pvHeapHandleLock( HeapHandle_t xHandle ) PRIVILEGED_FUNCTION;
+void vHeapHandleUnlock( HeapHandle_t xHandle ) PRIVILEGED_FUNCTION;
+size_t xHeapHandleGetSize( HeapHandle_t xHandle ) PRIVILEGED_FUNCTION;
+BaseType_t xPortHeapCompactStep( void ) PRIVILEGED_FUNCTION;
+void vPortGetHeapHandleStats( HeapHandleStats_t *pxStats ) PRIVILEGED_FUNCTION;
+
+
+/*
+ * Values for configHEAP_IMPLEMENTATION.  Every allocator in portable/MemMang
+ * is part of the build, and compiles to nothing unless it is the one selected.
+ */
+#define heapIMPLEMENTATION_2		2	/* heap_2.c - size ordered free list. */
+#define heapIMPLEMENTATION_BTAG		6	/* heap_btag.c - boundary tags, O(1) coalescing. */
+#define heapIMPLEMENTATION_TLSF		7	/* heap_tlsf.c - two-level segregated fit, O(1) malloc and free. */
+#define heapIMPLEMENTATION_REGIONS	8	/* heap_regions.c - heap_2.c lists over several regions, CCM first. */
 
 /*
  * Map to the memory management routines required for the port.
@@ -148,6 +272,257 @@ void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Free xCount blocks obtained from pvPortMalloc() in one go.  NULL entries are
+ * skipped.  heap_2.c and heap_regions.c sort the blocks by address and merge
+ * them with the free list in a single walk, where vPortFree() would walk it
+ * once per block; the other allocators free them one by one.  The order of
+ * pvBlocks[] is not changed.
+ */
+void vPortFreeBatch( void * const pvBlocks[], size_t xCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Only available when configHEAP_GUARD is 1, which heap_2.c supports.  Check
+ * the next configHEAP_GUARD_STEP_BLOCKS blocks of the heap in address order,
+ * carrying on from the previous call; the idle task calls it every time
+ * round its loop.  A walk is started again from the bottom of the heap
+ * whenever a block has been allocated or freed since the previous call.
+ * Returns pdTRUE when the call reached the top of the heap, so one full pass
+ * has been made without a fault.
+ *
+ * A header whose check word does not match, or an allocated block whose tail
+ * canary was overwritten, is passed to the application's
+ * vApplicationHeapCorruptedHook( void *pvBlock ), from here and from
+ * vPortFree(), vPortFreeBatch(), pvPortRealloc() and the free list walks.
+ * The heap is locked when the hook is called.  A block that fails its check
+ * is not freed, and pvPortRealloc() returns NULL for it.
+ */
+BaseType_t xPortHeapGuardStep( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Only available when configHEAP_LAZY_COALESCE is 1, which heap_2.c supports.
+ * vPortFree() then leaves freed blocks on a list of their own; this merges
+ * the next few of them with the free list in one walk, with the heap locked.
+ * The idle task calls it every time round its loop.  Returns pdTRUE once no
+ * freed block is left waiting.
+ */
+BaseType_t xPortHeapCoalesceStep( void ) PRIVILEGED_FUNCTION;
+
+/* How heap_2.c picks a free block, and the order it keeps the free list in.
+Best takes the smallest block that fits from a list kept by size, First the
+first that fits from a list kept most recently freed first, Next the first
+that fits after the block the last allocation came from, and Address the
+lowest addressed block that fits. */
+typedef enum
+{
+	eHeapFitBest = 0,
+	eHeapFitFirst,
+	eHeapFitNext,
+	eHeapFitAddress
+} HeapFitPolicy_t;
+
+#define heapFIT_POLICIES	4
+
+/* Figures for one fit policy, counted only while it was the one in use.  A
+fragmented failure is one where enough bytes were free but no block was large
+enough.  The cycle counts are as in HeapStats_t. */
+typedef struct xHEAP_POLICY_STATS
+{
+	size_t xSuccessfulAllocations;
+	size_t xFailedAllocations;
+	size_t xFragmentedFailures;
+	size_t xSuccessfulFrees;
+	uint32_t ulBlocksSearchedAverage;		/* Free blocks passed over per allocation. */
+	uint32_t ulBlocksSearchedMax;
+	uint32_t ulMallocCyclesAverage;
+	uint32_t ulMallocCyclesMax;
+	uint32_t ulFreeCyclesAverage;
+	uint32_t ulFreeCyclesMax;
+} HeapPolicyStats_t;
+
+/*
+ * Only available from heap_2.c.  Switch the fit policy, and whether freed
+ * blocks are merged with their neighbours, at run time; the free list is
+ * reordered for the new policy with the heap locked, one pass over the list
+ * per free block.  Blocks freed unmerged stay apart until freed again next to
+ * a neighbour.  Returns pdFAIL for an unknown policy, or for xMerge pdFALSE
+ * with configHEAP_LAZY_COALESCE 1.
+ */
+BaseType_t xPortHeapSetFitPolicy( HeapFitPolicy_t ePolicy, BaseType_t xMerge ) PRIVILEGED_FUNCTION;
+void vPortGetHeapPolicyStats( HeapFitPolicy_t ePolicy, HeapPolicyStats_t *pxStats ) PRIVILEGED_FUNCTION;
+
+/* One free block as captured by vPortGetHeapSnapshot(). */
+typedef struct xHEAP_BLOCK_INFO
+{
+	void *pvStartAddress;		/* Start of the block, including its header. */
+	size_t xBlockSize;			/* Size of the block, including its header. */
+} HeapBlockInfo_t;
+
+/* Heap wide figures captured in the same pass as the block list. */
+typedef struct xHEAP_SNAPSHOT
+{
+	size_t xHeapSize;				/* Bytes managed by the allocator. */
+	size_t xHeaderSize;				/* Bytes of each block taken by its header. */
+	size_t xFreeBytesRemaining;
+	size_t xNumberOfFreeBlocks;		/* All free blocks, including those that did not fit. */
+	size_t xBlocksCaptured;			/* Entries written to the block array. */
+	uint32_t ulSequence;			/* Free list changes up to the snapshot, see xPortGetHeapChanges(). */
+} HeapSnapshot_t;
+
+/*
+ * Copy the free list into pxBlocks, at most xMaxBlocks entries, with the
+ * scheduler suspended for one pass over the list.  Nothing is formatted or
+ * allocated, so the copy can be printed afterwards without holding the heap.
+ */
+void vPortGetHeapSnapshot( HeapSnapshot_t *pxSnapshot, HeapBlockInfo_t *pxBlocks, size_t xMaxBlocks ) PRIVILEGED_FUNCTION;
+
+/* What happened to the free block in a HeapChange_t. */
+typedef enum
+{
+	eHeapChangeInsert,		/* Joined the free list. */
+	eHeapChangeRemove,		/* Left the free list to be allocated. */
+	eHeapChangeSplit,		/* Cut down to xBlockSize; the rest is the next insert. */
+	eHeapChangeMerge		/* Left the free list, absorbed by a neighbour. */
+} HeapChangeType_t;
+
+/* One entry of the heap's change journal. */
+typedef struct xHEAP_CHANGE
+{
+	HeapChangeType_t eType;
+	void *pvStartAddress;		/* Start of the block, including its header. */
+	size_t xBlockSize;			/* Size of the block after the change. */
+} HeapChange_t;
+
+/*
+ * Every change to the free list is counted, and the last
+ * configHEAP_JOURNAL_LENGTH of them are kept.  *pulSequence holds the count a
+ * reader last saw - from the previous call or from vPortGetHeapSnapshot() -
+ * and the changes since are copied to pxChanges, at most xMaxChanges of them,
+ * with *pulSequence advanced past those copied.  Returns pdFALSE, with nothing
+ * copied and *pulSequence brought up to date, if some of those changes are no
+ * longer in the journal, in which case the reader has to take a new snapshot.
+ * Nothing copied and pdTRUE means the free list has not changed.
+ */
+BaseType_t xPortGetHeapChanges( uint32_t *pulSequence, HeapChange_t *pxChanges, size_t xMaxChanges, size_t *pxChangesCopied ) PRIVILEGED_FUNCTION;
+
+/* Fragmentation, usage and latency figures returned by vPortGetHeapStats().
+The cycle counts are DWT cycles spent inside pvPortMalloc() and vPortFree(),
+and are only collected when configGENERATE_HEAP_STATS is 1. */
+typedef struct xHEAP_STATS
+{
+	size_t xAvailableHeapSpaceInBytes;		/* Total free bytes. */
+	size_t xSizeOfLargestFreeBlockInBytes;	/* Largest request that could succeed, plus its header. */
+	size_t xSizeOfSmallestFreeBlockInBytes;
+	size_t xNumberOfFreeBlocks;
+	size_t xMinimumEverFreeBytesRemaining;
+	size_t xNumberOfSuccessfulAllocations;
+	size_t xNumberOfFailedAllocations;
+	size_t xNumberOfSuccessfulFrees;
+	uint32_t ulMallocCyclesMin;
+	uint32_t ulMallocCyclesMax;
+	uint32_t ulMallocCyclesAverage;
+	uint32_t ulFreeCyclesMin;
+	uint32_t ulFreeCyclesMax;
+	uint32_t ulFreeCyclesAverage;
+} HeapStats_t;
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats ) PRIVILEGED_FUNCTION;
+
+/*
+ * Only available when configUSE_HEAP_WATCH is 1.  Call pxCallback the first
+ * time an allocation leaves fewer than xFreeBytesBelow bytes free, or no free
+ * block as large as xLargestBlockBelow, headers included; 0 leaves either test
+ * out.  It is called again only once the heap has been seen above both.  It
+ * runs in the allocating task after the heap is unlocked, and is passed the
+ * figures that crossed - xLargestFreeBlock is 0 unless some watch has a
+ * largest block threshold, as only then is the free list walked.  Returns
+ * pdFAIL once configHEAP_WATCHES watches are registered.
+ */
+typedef void ( *HeapWatchCallback_t )( void *pvContext, size_t xFreeBytes, size_t xLargestFreeBlock );
+
+BaseType_t xPortHeapWatchAdd( size_t xFreeBytesBelow, size_t xLargestBlockBelow, HeapWatchCallback_t pxCallback, void *pvContext ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called by the allocators at the end of pvPortMalloc().
+ */
+void vPortHeapWatchCheck( void ) PRIVILEGED_FUNCTION;
+
+/* The rest of this section is only available when configHEAP_TRACK_OWNERS is
+1, which heap_regions.c supports.  Task handles are taken as the structure
+pointers they are, as task.h is included after this file. */
+struct tskTaskControlBlock;
+
+/* One slot of the owner table returned by vPortGetHeapOwners().  Slot 0 holds
+the allocations made before the scheduler started, and those of tasks that
+found every slot taken.  Once a task is deleted its slot has no owner, and
+keeps counting until the last of its blocks is freed. */
+typedef struct xHEAP_OWNER_INFO
+{
+	struct tskTaskControlBlock *xOwner;		/* NULL for slot 0, deleted tasks and unused slots. */
+	char pcTaskName[ configMAX_TASK_NAME_LEN ];
+	size_t xBytes;							/* Held now, headers included. */
+	size_t xBlocks;
+	size_t xPeakBytes;						/* Most ever held at once. */
+} HeapOwnerInfo_t;
+
+/* One allocated block as captured by uxPortGetHeapAllocations(). */
+typedef struct xHEAP_ALLOCATION_INFO
+{
+	void *pvStartAddress;		/* Start of the block, including its header. */
+	size_t xBlockSize;			/* Size of the block, including its header. */
+	uint32_t ulSite;			/* Return address of the call that allocated it. */
+	UBaseType_t uxOwner;		/* Its slot in the owner table. */
+} HeapAllocationInfo_t;
+
+/* The blocks one call site allocated that have outlived a number of heap
+generations, as captured by uxPortGetHeapLeaks(). */
+typedef struct xHEAP_LEAK_INFO
+{
+	uint32_t ulSite;			/* Return address of the allocating call. */
+	size_t xBlocks;
+	size_t xBytes;				/* Headers included. */
+	UBaseType_t uxOldestAge;	/* Generations the oldest of them has outlived. */
+} HeapLeakInfo_t;
+
+/*
+ * Copy the whole owner table, configHEAP_OWNER_SLOTS entries, with each live
+ * owner's name, in one pass with the heap locked.
+ */
+void vPortGetHeapOwners( HeapOwnerInfo_t *pxOwners ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copy up to xMaxBlocks allocated blocks, in address order, with the heap
+ * locked for one walk over every region.  Returns the number of allocated
+ * blocks, which may be more than were copied.
+ */
+size_t uxPortGetHeapAllocations( HeapAllocationInfo_t *pxBlocks, size_t xMaxBlocks ) PRIVILEGED_FUNCTION;
+
+/*
+ * Start a new heap generation, returning its number.  Each allocated block is
+ * stamped with the generation it was allocated in, so a block still held
+ * several generations later is a candidate leak.
+ */
+uint32_t ulPortHeapNewGeneration( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Group the allocated blocks that have outlived at least uxMinAge generations
+ * by call site, copying up to xMaxSites sites in the order they are first
+ * found in the heap.  Returns the number of sites copied.
+ */
+size_t uxPortGetHeapLeaks( HeapLeakInfo_t *pxSites, size_t xMaxSites, UBaseType_t uxMinAge ) PRIVILEGED_FUNCTION;
+
+/*
+ * The bytes xTask holds, for vTaskGetInfo().  The heap is not locked, so this
+ * is only consistent when called with the scheduler suspended.
+ */
+size_t xPortGetHeapOwnerBytes( struct tskTaskControlBlock *xTask ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called by vTaskDelete(), so the slot of xTask is no longer found by its
+ * handle, which may be reused.
+ */
+void vPortHeapOwnerDeleted( struct tskTaskControlBlock *xTask ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -180,3 +555,7 @@ void vPortEndScheduler( void ) PRIVILEGED_FUNCTION;
 #endif /* PORTABLE_H */
 
 void vPrintFreeList(void) PRIVILEGED_FUNCTION;
+BaseType_t xPrintHeapChanges(void) PRIVILEGED_FUNCTION;
+void vPrintHeapStats(void) PRIVILEGED_FUNCTION;
+void vPrintHeapOwners(void) PRIVILEGED_FUNCTION;
+void vPrintHeapLeaks(UBaseType_t uxMinAge) PRIVILEGED_FUNCTION;
@@ -39,6 +39,10 @@ extern "C" {
 
 #include "task.h"
 
+#if( configUSE_ZERO_COPY_QUEUES == 1 )
+	#include "mempool.h"
+#endif
+
 /**
  * Type by which queues are referenced.  For example, a call to xQueueCreate()
  * returns an QueueHandle_t variable that can then be used as a parameter to
@@ -1505,6 +1509,169 @@ BaseType_t xQueueGiveMutexRecursive( QueueHandle_t xMutex ) PRIVILEGED_FUNCTION;
 	QueueHandle_t xQueueGenericCreateStatic( const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize, uint8_t *pucQueueStorage, StaticQueue_t *pxStaticQueue, const uint8_t ucQueueType ) PRIVILEGED_FUNCTION;
 #endif
 
+/**
+ * queue. h
+ * <pre>
+ QueueHandle_t xQueueCreateZeroCopy( UBaseType_t uxQueueLength, MemPool_t *pxPool );
+ QueueHandle_t xQueueCreateZeroCopyStatic( UBaseType_t uxQueueLength, MemPool_t *pxPool, void **ppvQueueStorage, StaticQueue_t *pxQueueBuffer );
+ void *pvQueueAcquireBuffer( QueueHandle_t xQueue );
+ BaseType_t xQueueSendBuffer( QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait );
+ BaseType_t xQueueSendBufferFromISR( QueueHandle_t xQueue, void *pvBuffer, BaseType_t *pxHigherPriorityTaskWoken );
+ void *pvQueueReceiveBuffer( QueueHandle_t xQueue, TickType_t xTicksToWait );
+ void *pvQueueReceiveBufferFromISR( QueueHandle_t xQueue, BaseType_t *pxHigherPriorityTaskWoken );
+ void vQueueReleaseBuffer( QueueHandle_t xQueue, void *pvBuffer );
+ </pre>
+ *
+ * A zero copy queue carries pointers to blocks of a MemPool_t instead of
+ * copies of the items, so an item of any size costs one pointer in the queue
+ * storage and is never copied by the kernel.  Each buffer has exactly one
+ * owner at a time:
+ *
+ * - pvQueueAcquireBuffer() takes a free block from the pool; the caller owns it.
+ * - xQueueSendBuffer() hands it to the queue if it returns pdPASS.  The sender
+ *   must not touch the buffer again.  On a timeout the sender still owns it.
+ * - pvQueueReceiveBuffer() hands the oldest buffer to the receiver, which owns
+ *   it until it passes it on or returns it with vQueueReleaseBuffer().
+ *
+ * Sending and receiving block and time out exactly as xQueueSend() and
+ * xQueueReceive().  Acquiring never blocks, as the pool is not a kernel
+ * object; size the pool for the queue length plus the buffers the producers
+ * and consumers hold at once.  The pool, acquire and release can be used from
+ * interrupts.  xQueueReset() and vQueueDelete() return any buffers still
+ * queued to the pool.  xQueuePeek() gives the pointer without ownership.
+ *
+ * configUSE_ZERO_COPY_QUEUES must be set to 1 in FreeRTOSConfig.h for these
+ * functions to be available.
+ *
+ * @param uxQueueLength The maximum number of buffers the queue can hold.
+ *
+ * @param pxPool The pool the buffers come from, set up with vMemPoolInit().
+ * Several queues may share one pool, so a buffer can be forwarded from queue
+ * to queue.
+ *
+ * @param ppvQueueStorage uxQueueLength pointers of storage for the static
+ * variant.
+ *
+ * @return pvQueueAcquireBuffer() returns NULL if the pool is empty, and
+ * pvQueueReceiveBuffer() returns NULL if no buffer arrived before
+ * xTicksToWait passed.
+ *
+ * Example usage:
+   <pre>
+ static MemPool_t xFramePool;
+ static QueueHandle_t xFrameQueue;
+
+ void vSensorTask( void *pvParameters )
+ {
+ SensorFrame_t *pxFrame;
+
+	for( ;; )
+	{
+		pxFrame = pvQueueAcquireBuffer( xFrameQueue );
+		if( pxFrame != NULL )
+		{
+			vReadSensor( pxFrame );
+
+			if( xQueueSendBuffer( xFrameQueue, pxFrame, pdMS_TO_TICKS( 10 ) ) != pdPASS )
+			{
+				// Still ours, so give it back.
+				vQueueReleaseBuffer( xFrameQueue, pxFrame );
+			}
+		}
+	}
+ }
+
+ void vProcessTask( void *pvParameters )
+ {
+ SensorFrame_t *pxFrame;
+
+	for( ;; )
+	{
+		pxFrame = pvQueueReceiveBuffer( xFrameQueue, portMAX_DELAY );
+		vProcessFrame( pxFrame );
+		vQueueReleaseBuffer( xFrameQueue, pxFrame );
+	}
+ }
+ </pre>
+ * \defgroup xQueueCreateZeroCopy xQueueCreateZeroCopy
+ * \ingroup QueueManagement
+ */
+#if( configUSE_ZERO_COPY_QUEUES == 1 )
+	#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		QueueHandle_t xQueueCreateZeroCopy( const UBaseType_t uxQueueLength, MemPool_t *pxPool ) PRIVILEGED_FUNCTION;
+	#endif
+	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		QueueHandle_t xQueueCreateZeroCopyStatic( const UBaseType_t uxQueueLength, MemPool_t *pxPool, void **ppvQueueStorage, StaticQueue_t *pxStaticQueue ) PRIVILEGED_FUNCTION;
+	#endif
+	void *pvQueueAcquireBuffer( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+	BaseType_t xQueueSendBuffer( QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+	BaseType_t xQueueSendBufferFromISR( QueueHandle_t xQueue, void *pvBuffer, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+	void *pvQueueReceiveBuffer( QueueHandle_t xQueue, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+	void *pvQueueReceiveBufferFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+	void vQueueReleaseBuffer( QueueHandle_t xQueue, void *pvBuffer ) PRIVILEGED_FUNCTION;
+#endif /* configUSE_ZERO_COPY_QUEUES */
+
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t uxQueueSendMultiple( QueueHandle_t xQueue, const void *pvItems, UBaseType_t uxCount, TickType_t xTicksToWait );
+ UBaseType_t uxQueueSendMultipleFromISR( QueueHandle_t xQueue, const void *pvItems, UBaseType_t uxCount, BaseType_t *pxHigherPriorityTaskWoken );
+ UBaseType_t uxQueueReceiveMultiple( QueueHandle_t xQueue, void *pvBuffer, UBaseType_t uxMaxCount, TickType_t xTicksToWait );
+ UBaseType_t uxQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void *pvBuffer, UBaseType_t uxMaxCount, BaseType_t *pxHigherPriorityTaskWoken );
+ </pre>
+ *
+ * Move a run of items to the back of a queue, or out of its front, under one
+ * critical section instead of one per item.  Items are copied with at most
+ * two memcpy() calls, and as many blocked tasks are woken as there are items
+ * moved, so a single waiting task is woken once however long the run.
+ *
+ * uxQueueSendMultiple() sends pvItems in order, blocking for up to
+ * xTicksToWait in total while the queue is full, and returns how many were
+ * sent: uxCount, or fewer if the time ran out.  uxQueueReceiveMultiple()
+ * blocks for up to xTicksToWait until at least one item is queued, then takes
+ * as many as are there, up to uxMaxCount, and returns how many it took, 0 on
+ * a timeout.  The FromISR variants never block.
+ *
+ * The items are those of a plain queue of uxItemSize bytes each; these
+ * functions must not be used on semaphores, mutexes or members of a queue
+ * set.  configUSE_QUEUE_BATCH_OPERATIONS must be set to 1 in
+ * FreeRTOSConfig.h for them to be available.
+ *
+ * Example usage:
+   <pre>
+ // UART receive interrupt, draining the hardware FIFO in one queue operation.
+ void vUARTRxISR( void )
+ {
+ uint8_t ucBytes[ 16 ];
+ UBaseType_t uxCount = uxReadRxFifo( ucBytes, sizeof( ucBytes ) );
+ BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	( void ) uxQueueSendMultipleFromISR( xRxQueue, ucBytes, uxCount, &xHigherPriorityTaskWoken );
+	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+ }
+
+ void vParserTask( void *pvParameters )
+ {
+ uint8_t ucBytes[ 32 ];
+ UBaseType_t uxCount;
+
+	for( ;; )
+	{
+		uxCount = uxQueueReceiveMultiple( xRxQueue, ucBytes, sizeof( ucBytes ), portMAX_DELAY );
+		vParse( ucBytes, uxCount );
+	}
+ }
+ </pre>
+ * \defgroup uxQueueSendMultiple uxQueueSendMultiple
+ * \ingroup QueueManagement
+ */
+#if( configUSE_QUEUE_BATCH_OPERATIONS == 1 )
+	UBaseType_t uxQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxCount, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+	UBaseType_t uxQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxCount, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+	UBaseType_t uxQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxCount, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+	UBaseType_t uxQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxCount, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+#endif /* configUSE_QUEUE_BATCH_OPERATIONS */
+
 /*
  * Queue sets provide a mechanism to allow a task to block (pend) on a read
  * operation from multiple queues or semaphores simultaneously.
@@ -1572,10 +1739,14 @@ QueueSetHandle_t xQueueCreateSet( const UBaseType_t uxEventQueueLength ) PRIVILE
  * @param xQueueSet The handle of the queue set to which the queue or semaphore
  * is being added.
  *
+ * Note 2:  A queue set holds at most 32 members.  Each is given the lowest bit
+ * of the set's ready mask not already in use, see uxQueueGetSetIndex(), so
+ * members added in turn to an empty set get bits 0, 1, 2 and so on.
+ *
  * @return If the queue or semaphore was successfully added to the queue set
  * then pdPASS is returned.  If the queue could not be successfully added to the
- * queue set because it is already a member of a different queue set then pdFAIL
- * is returned.
+ * queue set because it is already a member of a different queue set, or the
+ * set already holds 32 members, then pdFAIL is returned.
  */
 BaseType_t xQueueAddToSet( QueueSetMemberHandle_t xQueueOrSemaphore, QueueSetHandle_t xQueueSet ) PRIVILEGED_FUNCTION;
 
@@ -1639,6 +1810,51 @@ QueueSetMemberHandle_t xQueueSelectFromSet( QueueSetHandle_t xQueueSet, const Ti
  */
 QueueSetMemberHandle_t xQueueSelectFromSetFromISR( QueueSetHandle_t xQueueSet ) PRIVILEGED_FUNCTION;
 
+/*
+ * Creates a masked queue set.  A masked set is used like any other, except
+ * that it is read with ulQueueSelectMaskFromSet() instead of
+ * xQueueSelectFromSet(): rather than one event per item posted to a member,
+ * it keeps one bit per member, set while the member holds data (or, for a
+ * semaphore, can be taken), so a single call reports every member that is
+ * ready and the set needs no event storage sized to its members.
+ *
+ * @return The handle of the created queue set, or NULL if it could not be
+ * created.
+ */
+QueueSetHandle_t xQueueCreateSetMasked( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Blocks until at least one member of a masked queue set is ready, and returns
+ * the set's ready mask, in which bit n stands for the member whose
+ * uxQueueGetSetIndex() is n.  The bits are level triggered: a member's bit
+ * stays set until the member is empty, so the task need not drain a member
+ * before it selects again.  Each member whose bit is set can then be read, or
+ * taken, with a block time of 0.
+ *
+ * Only one task may select from a given set.
+ *
+ * @param xQueueSet A set created by xQueueCreateSetMasked().
+ *
+ * @param xTicksToWait The maximum time, in ticks, to wait for a member to be
+ * ready.
+ *
+ * @return The ready mask, or 0 if no member became ready before the block time
+ * expired.
+ */
+uint32_t ulQueueSelectMaskFromSet( QueueSetHandle_t xQueueSet, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * A version of ulQueueSelectMaskFromSet() that can be used from an ISR.  It
+ * does not block.
+ */
+uint32_t ulQueueSelectMaskFromSetFromISR( QueueSetHandle_t xQueueSet ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the bit that stands for a queue or semaphore in its queue set's
+ * ready mask.  The queue or semaphore must be a member of a set.
+ */
+UBaseType_t uxQueueGetSetIndex( QueueSetMemberHandle_t xQueueOrSemaphore ) PRIVILEGED_FUNCTION;
+
 /* Not public API functions. */
 void vQueueWaitForMessageRestricted( QueueHandle_t xQueue, TickType_t xTicksToWait, const BaseType_t xWaitIndefinitely ) PRIVILEGED_FUNCTION;
 BaseType_t xQueueGenericReset( QueueHandle_t xQueue, BaseType_t xNewQueue ) PRIVILEGED_FUNCTION;
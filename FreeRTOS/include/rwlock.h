@@ -0,0 +1,100 @@
+/*
+ * Reader-writer locks for state that is read often and written rarely.
+ *
+ * Any number of tasks may hold the lock for reading at once; a writer holds
+ * it alone.  While no writer holds or wants the lock, a reader only counts
+ * itself in and out inside a short critical section, so readers never wait
+ * for one another.
+ *
+ * Writers are preferred.  Once a writer asks for the lock, new readers queue
+ * on a kernel mutex that the writer holds until it is done, so a stream of
+ * readers cannot starve it.  Because that is an ordinary mutex, writers and
+ * waiting readers are served in priority order, and the writer holding the
+ * lock inherits the priority of any task waiting for it.
+ *
+ * Readers that already hold the lock when a writer arrives inherit the
+ * writer's priority while it waits for them, and drop it again as they give
+ * the lock back, as the holder of a mutex would.  The lock remembers the
+ * first rwlockTRACKED_READERS of them; any readers in at once beyond that
+ * are counted but not raised, so a writer waiting on one of those can still
+ * be held up by tasks of middling priority.  Size rwlockTRACKED_READERS for
+ * the most readers the application ever has inside at once.  A reader
+ * raised by a writer that then times out keeps the raised priority until it
+ * gives the lock back.
+ *
+ * A writer waiting for readers to finish is woken with a direct to task
+ * notification, so its notification value must not be used for anything
+ * else while it waits.  The lock is not recursive: a task holding it for
+ * reading must not ask for it again for writing, and neither side may be
+ * used from interrupts.
+ */
+
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include rwlock.h"
+#endif
+
+#include "task.h"
+#include "semphr.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/* Readers remembered per lock so a waiting writer can raise them. */
+#ifndef rwlockTRACKED_READERS
+	#define rwlockTRACKED_READERS	4
+#endif
+
+/*
+ * The lock itself.  Declare one as a variable and set it up with
+ * xRWLockInit(); the members are private.
+ */
+typedef struct xRW_LOCK
+{
+	SemaphoreHandle_t xWriteMutex;			/*< Held by the writer, and taken briefly by readers that arrive while a writer holds or wants the lock. */
+	volatile UBaseType_t uxReaders;			/*< Tasks holding the lock for reading. */
+	volatile UBaseType_t uxWriters;			/*< Tasks holding or waiting to hold the lock for writing. */
+	TaskHandle_t xWriterWaiting;			/*< The writer waiting for uxReaders to reach 0, if any. */
+	TaskHandle_t xReaderTasks[ rwlockTRACKED_READERS ];	/*< Tasks holding the lock for reading, as far as there is room, else NULL. */
+	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		StaticSemaphore_t xWriteMutexBuffer;
+	#endif
+} RWLock_t;
+
+/*
+ * Make the lock free.  Returns pdFAIL if the mutex could not be allocated,
+ * which can only happen without configSUPPORT_STATIC_ALLOCATION.
+ */
+BaseType_t xRWLockInit( RWLock_t *pxLock ) PRIVILEGED_FUNCTION;
+
+/*
+ * Take the lock for reading, waiting up to xTicksToWait for a writer to
+ * finish.  Returns pdPASS if the lock was taken, otherwise pdFAIL.
+ */
+BaseType_t xRWLockReadTake( RWLock_t *pxLock, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Give back a lock the calling task holds for reading.
+ */
+void vRWLockReadGive( RWLock_t *pxLock ) PRIVILEGED_FUNCTION;
+
+/*
+ * Take the lock for writing, waiting up to xTicksToWait in all for other
+ * writers and then for readers to finish.  Returns pdPASS if the lock was
+ * taken, otherwise pdFAIL.
+ */
+BaseType_t xRWLockWriteTake( RWLock_t *pxLock, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Give back a lock the calling task holds for writing.
+ */
+void vRWLockWriteGive( RWLock_t *pxLock ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* RWLOCK_H */
@@ -0,0 +1,93 @@
+/*
+ * Slab caches for fixed size kernel objects.
+ *
+ * A cache hands out objects of one size from slabs of configKERNEL_SLAB_SIZE
+ * bytes taken from the heap with pvPortMallocAligned(), aligned to their own
+ * size.  Each slab starts with a small header holding a bitmap of its free
+ * objects, so allocating is a find-first-set on the first slab with room and
+ * freeing finds the slab by masking the object's address - both O(1).  The
+ * slabs with room are kept on a list, most recently freed into first.  A slab
+ * that empties is given back to the heap unless it is the only one with room,
+ * so a create and delete in a loop does not take a slab and give it back each
+ * time.
+ *
+ * The bitmap and list are protected by masking interrupts up to
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY for a few instructions, as in
+ * mempool.h; the heap is only called, from task context, when a slab is taken
+ * or given back.
+ */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include slab.h"
+#endif
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/*
+ * The header at the start of every slab.  Private.
+ */
+typedef struct xSLAB
+{
+	struct xSLAB *pxNext;				/*< Slabs with room, in the cache's list. */
+	struct xSLAB *pxPrevious;
+	uint32_t ulFreeMap;					/*< Bit n set while object n is free. */
+} Slab_t;
+
+/*
+ * The cache itself.  Declare one as a variable initialised with
+ * slabCACHE_INIT(); the members are private.
+ */
+typedef struct xSLAB_CACHE
+{
+	Slab_t *pxPartial;					/*< First slab with a free object. */
+	size_t xObjectSize;					/*< Size of each object after alignment. */
+	UBaseType_t uxObjectsPerSlab;
+	UBaseType_t uxSlabs;				/*< Slabs taken from the heap. */
+	UBaseType_t uxObjectsInUse;
+} SlabCache_t;
+
+#define slabALIGNED_SIZE( xSize )			( ( ( size_t ) ( xSize ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define slabHEADER_SIZE						slabALIGNED_SIZE( sizeof( Slab_t ) )
+
+/*
+ * Objects of xSize bytes that fit in a slab after its header, at most the 32
+ * one bitmap word can describe.
+ */
+#define slabOBJECTS_PER_SLAB( xSize )												\
+	( ( ( ( size_t ) configKERNEL_SLAB_SIZE - slabHEADER_SIZE ) / slabALIGNED_SIZE( xSize ) ) > 32U ?	\
+	  ( UBaseType_t ) 32U : ( UBaseType_t ) ( ( ( size_t ) configKERNEL_SLAB_SIZE - slabHEADER_SIZE ) / slabALIGNED_SIZE( xSize ) ) )
+
+/*
+ * Static initialiser for a cache of objects of xSize bytes, which must leave
+ * room for at least one object in a slab.
+ */
+#define slabCACHE_INIT( xSize )		{ NULL, slabALIGNED_SIZE( xSize ), slabOBJECTS_PER_SLAB( xSize ), 0, 0 }
+
+/*
+ * Take an object from the cache, taking a new slab from the heap if none has
+ * room.  Returns NULL if the heap could not provide one.  Task context only.
+ */
+void *pvSlabAlloc( SlabCache_t *pxCache ) PRIVILEGED_FUNCTION;
+
+/*
+ * Return an object obtained from pvSlabAlloc() on the same cache.  Task
+ * context only.
+ */
+void vSlabFree( SlabCache_t *pxCache, void *pv ) PRIVILEGED_FUNCTION;
+
+/*
+ * The objects in use, and the slabs holding them and the free objects.
+ */
+UBaseType_t uxSlabGetObjectsInUse( const SlabCache_t *pxCache ) PRIVILEGED_FUNCTION;
+UBaseType_t uxSlabGetSlabCount( const SlabCache_t *pxCache ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* SLAB_H */
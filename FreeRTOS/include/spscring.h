@@ -0,0 +1,102 @@
+/*
+ * Lock free single producer, single consumer byte rings.
+ *
+ * The producer only ever writes the head index and the consumer only ever
+ * writes the tail index, so neither side masks interrupts or enters a
+ * critical section: the data is stored before the index that publishes it,
+ * and read before the index that releases it.  The producer can therefore be
+ * an interrupt of any priority at or below configMAX_SYSCALL_INTERRUPT_PRIORITY
+ * pushing into a ring that a task drains, or the other way round.
+ *
+ * The consumer may block in xSpscRingRead() until a wake threshold of bytes
+ * is waiting.  The producer only calls into the kernel, with a direct to task
+ * notification, on the write that crosses that threshold while the consumer
+ * is actually blocked; every other write is a copy and two index accesses.
+ * The consumer task's notification value is used for this and must not be
+ * used for anything else while it reads.
+ *
+ * One task or interrupt may write a given ring and one task may read it.
+ */
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include spscring.h"
+#endif
+
+#include "task.h"
+
+#if defined( __cplusplus )
+extern "C" {
+#endif
+
+/*
+ * The ring itself.  Declare one as a variable and set it up with
+ * vSpscRingInit(); the members are private.
+ */
+typedef struct xSPSC_RING
+{
+	uint8_t *pucBuffer;
+	size_t xSize;							/*< Power of two, so free running indexes wrap with a mask. */
+	volatile size_t xHead;					/*< Written only by the producer. */
+	volatile size_t xTail;					/*< Written only by the consumer. */
+	size_t xWakeThreshold;					/*< Bytes that must be waiting before a blocked consumer is woken. */
+	volatile size_t xWaitLevel;				/*< The threshold the blocked consumer is waiting for, capped at its buffer length. */
+	TaskHandle_t volatile xWaitingTask;		/*< The consumer while blocked, claimed by the producer that wakes it. */
+} SpscRing_t;
+
+/*
+ * Turn xSize bytes at pvStorage into an empty ring.  xSize must be a power of
+ * two.  A blocked reader is woken once xWakeThreshold bytes are waiting, or
+ * as many as it asked for if that is fewer; 1 wakes it on every write.
+ */
+void vSpscRingInit( SpscRing_t *pxRing, void *pvStorage, size_t xSize, size_t xWakeThreshold ) PRIVILEGED_FUNCTION;
+
+/*
+ * Change the wake threshold.  Call from the consumer.
+ */
+void vSpscRingSetWakeThreshold( SpscRing_t *pxRing, size_t xWakeThreshold ) PRIVILEGED_FUNCTION;
+
+/*
+ * Producer side.  Copies all xLength bytes or, if they do not fit, none, so
+ * records are never split, and returns the number copied.  Never blocks.
+ * The FromISR variant sets *pxHigherPriorityTaskWoken to pdTRUE if the woken
+ * consumer should run as soon as the interrupt returns.
+ */
+size_t xSpscRingWrite( SpscRing_t *pxRing, const void *pvData, size_t xLength ) PRIVILEGED_FUNCTION;
+size_t xSpscRingWriteFromISR( SpscRing_t *pxRing, const void *pvData, size_t xLength, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/*
+ * Consumer side.  Waits up to xTicksToWait for the wake threshold to be
+ * reached, then copies out as many bytes as are waiting, up to xMaxLength.
+ * Returns the number copied, which may be below the threshold, or 0, if the
+ * wait timed out.  Must be called from a task unless xTicksToWait is 0.
+ */
+size_t xSpscRingRead( SpscRing_t *pxRing, void *pvBuffer, size_t xMaxLength, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Consumer side, without copying.  Waits up to xTicksToWait for more than
+ * xSkip bytes to be waiting, then points *ppucData at the byte xSkip past the
+ * oldest and returns how many follow it in the ring's storage before it wraps,
+ * or 0 if the wait timed out.  Nothing is consumed: the bytes stay the
+ * reader's, to look at or even change in place, until vSpscRingRelease()
+ * hands xLength of them, oldest first, back to the producer.  A reader can
+ * therefore scan a growing message with increasing xSkip and only release it
+ * once it is whole.
+ */
+size_t xSpscRingAcquire( SpscRing_t *pxRing, size_t xSkip, uint8_t **ppucData, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+void vSpscRingRelease( SpscRing_t *pxRing, size_t xLength ) PRIVILEGED_FUNCTION;
+
+/*
+ * The bytes waiting to be read, and the room left for writing.  Exact when
+ * called from the side that would act on the answer.
+ */
+size_t xSpscRingBytesAvailable( const SpscRing_t *pxRing ) PRIVILEGED_FUNCTION;
+size_t xSpscRingSpacesAvailable( const SpscRing_t *pxRing ) PRIVILEGED_FUNCTION;
+
+#if defined( __cplusplus )
+}
+#endif
+
+#endif /* SPSCRING_H */
@@ -586,6 +586,141 @@ size_t xStreamBufferReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
 									size_t xBufferLengthBytes,
 									BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferReserve( StreamBufferHandle_t xStreamBuffer, void **ppvData );
+size_t xStreamBufferCommit( StreamBufferHandle_t xStreamBuffer, size_t xLength );
+size_t xStreamBufferCommitFromISR( StreamBufferHandle_t xStreamBuffer, size_t xLength, BaseType_t * const pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Write into a stream buffer in place rather than through a copy.
+ * xStreamBufferReserve() sets *ppvData to the free space at the write
+ * position and returns how many bytes of it are contiguous - that is, up to
+ * the end of the storage area or the unread data, whichever comes first.  The
+ * writer, or a DMA transfer it sets up, fills some or all of those bytes and
+ * then xStreamBufferCommit() makes xLength of them readable, waking a blocked
+ * reader exactly as xStreamBufferSend() does once the trigger level is met.
+ *
+ * Space can only grow between the two calls, so the reserved bytes stay
+ * valid however long the fill takes.  A reservation that comes back shorter
+ * than wanted because the storage wraps can be committed and followed by a
+ * second reservation at the start of the storage area.  Nothing else may
+ * write to the stream buffer between a reservation and its commit.
+ *
+ * These functions are only for stream buffers, not message buffers.  Reserve
+ * never blocks and can be called from an interrupt.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to write to.
+ *
+ * @param ppvData Set to the first free byte.
+ *
+ * @param xLength The number of bytes written since the reservation; at most
+ * the length it returned.
+ *
+ * @param pxHigherPriorityTaskWoken As for xStreamBufferSendFromISR().
+ *
+ * @return xStreamBufferReserve() returns the number of contiguous free bytes
+ * at *ppvData, 0 if the stream buffer is full.  The commit functions return
+ * xLength.
+ *
+ * Example use:
+<pre>
+// Receive UART bytes by DMA straight into the stream buffer.
+void vStartRx( void )
+{
+uint8_t *pucFree;
+size_t xFree;
+
+    xFree = xStreamBufferReserve( xRxStream, ( void ** ) &pucFree );
+    if( xFree > 0 )
+    {
+        vStartUartDma( pucFree, xFree );
+    }
+}
+
+// Called from the UART idle line or DMA complete interrupt.
+void vRxDone( size_t xReceived )
+{
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    xStreamBufferCommitFromISR( xRxStream, xReceived, &xHigherPriorityTaskWoken );
+    vStartRx();
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+</pre>
+ * \defgroup xStreamBufferReserve xStreamBufferReserve
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReserve( StreamBufferHandle_t xStreamBuffer, void **ppvData ) PRIVILEGED_FUNCTION;
+size_t xStreamBufferCommit( StreamBufferHandle_t xStreamBuffer, size_t xLength ) PRIVILEGED_FUNCTION;
+size_t xStreamBufferCommitFromISR( StreamBufferHandle_t xStreamBuffer, size_t xLength, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferPeekContiguous( StreamBufferHandle_t xStreamBuffer, void **ppvData, TickType_t xTicksToWait );
+size_t xStreamBufferConsume( StreamBufferHandle_t xStreamBuffer, size_t xLength );
+size_t xStreamBufferConsumeFromISR( StreamBufferHandle_t xStreamBuffer, size_t xLength, BaseType_t * const pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Read from a stream buffer in place rather than through a copy.
+ * xStreamBufferPeekContiguous() sets *ppvData to the oldest unread byte and
+ * returns how many unread bytes follow it before the storage area wraps.  The
+ * reader, or a DMA transfer it sets up, uses those bytes where they are and
+ * then xStreamBufferConsume() releases xLength of them, waking a writer
+ * blocked for space exactly as xStreamBufferReceive() does.
+ *
+ * If the stream buffer is empty, peek blocks for up to xTicksToWait for data
+ * to arrive, as xStreamBufferReceive() does.  With an xTicksToWait of 0 it
+ * never blocks and can be called from an interrupt.  The peeked bytes are not
+ * overwritten before they are consumed.  Nothing else may read from the
+ * stream buffer between a peek and its consume.
+ *
+ * These functions are only for stream buffers, not message buffers.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to read from.
+ *
+ * @param ppvData Set to the oldest unread byte.
+ *
+ * @param xTicksToWait The maximum time to wait for data if the stream buffer
+ * is empty.
+ *
+ * @param xLength The number of bytes to release; at most the number of
+ * bytes in the stream buffer.
+ *
+ * @param pxHigherPriorityTaskWoken As for xStreamBufferReceiveFromISR().
+ *
+ * @return xStreamBufferPeekContiguous() returns the number of contiguous
+ * unread bytes at *ppvData, 0 if the stream buffer stayed empty.  The
+ * consume functions return xLength.
+ *
+ * Example use:
+<pre>
+// Hand the oldest contiguous run to a transmit DMA, release it when done.
+void vTxTask( void *pvParameters )
+{
+uint8_t *pucData;
+size_t xLength;
+
+    for( ;; )
+    {
+        xLength = xStreamBufferPeekContiguous( xTxStream, ( void ** ) &pucData, portMAX_DELAY );
+        vUartDmaSendAndWait( pucData, xLength );
+        xStreamBufferConsume( xTxStream, xLength );
+    }
+}
+</pre>
+ *
+ * \defgroup xStreamBufferPeekContiguous xStreamBufferPeekContiguous
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferPeekContiguous( StreamBufferHandle_t xStreamBuffer, void **ppvData, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+size_t xStreamBufferConsume( StreamBufferHandle_t xStreamBuffer, size_t xLength ) PRIVILEGED_FUNCTION;
+size_t xStreamBufferConsumeFromISR( StreamBufferHandle_t xStreamBuffer, size_t xLength, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /**
  * stream_buffer.h
  *
@@ -830,6 +965,14 @@ BaseType_t xStreamBufferReceiveCompletedFromISR( StreamBufferHandle_t xStreamBuf
 BaseType_t xStreamBufferReceiveCompletedFromISR( StreamBufferHandle_t xStreamBuffer, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
 /* Functions below here are not part of the public API. */
+
+/* Values of xIsMessageBuffer, besides pdFALSE for a stream buffer and pdTRUE
+for a message buffer with a full width length header, that create a message
+buffer storing each message length in one or two bytes.  Each is one more
+than the header length, which xMessageBufferCreateCompact() relies on. */
+#define sbMESSAGE_BUFFER_LENGTH_1_BYTE		( ( BaseType_t ) 2 )
+#define sbMESSAGE_BUFFER_LENGTH_2_BYTES		( ( BaseType_t ) 3 )
+
 StreamBufferHandle_t xStreamBufferGenericCreate( size_t xBufferSizeBytes,
 												 size_t xTriggerLevelBytes,
 												 BaseType_t xIsMessageBuffer ) PRIVILEGED_FUNCTION;
@@ -842,6 +985,13 @@ StreamBufferHandle_t xStreamBufferGenericCreateStatic( size_t xBufferSizeBytes,
 
 size_t xStreamBufferNextMessageLengthBytes( StreamBufferHandle_t xStreamBuffer ) PRIVILEGED_FUNCTION;
 
+size_t xStreamBufferReceiveMessages( StreamBufferHandle_t xStreamBuffer,
+									 void *pvRxData,
+									 size_t xBufferLengthBytes,
+									 size_t * const pxMessageLengths,
+									 size_t xMaxMessages,
+									 TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
 #if( configUSE_TRACE_FACILITY == 1 )
 	void vStreamBufferSetStreamBufferNumber( StreamBufferHandle_t xStreamBuffer, UBaseType_t uxStreamBufferNumber ) PRIVILEGED_FUNCTION;
 	UBaseType_t uxStreamBufferGetStreamBufferNumber( StreamBufferHandle_t xStreamBuffer ) PRIVILEGED_FUNCTION;
@@ -51,6 +51,10 @@ extern "C" {
 #define tskKERNEL_VERSION_MINOR 2
 #define tskKERNEL_VERSION_BUILD 0
 
+/* The notification index the functions without an Indexed suffix use, and the
+only one when configTASK_NOTIFICATION_ARRAY_ENTRIES is 1. */
+#define tskDEFAULT_INDEX_TO_NOTIFY ( 0 )
+
 /* MPU region parameters passed in ulParameters
  * of MemoryRegion_t struct. */
 #define tskMPU_REGION_READ_ONLY			( 1UL << 0UL )
@@ -146,10 +150,48 @@ typedef struct xTASK_STATUS
 	UBaseType_t uxCurrentPriority;	/* The priority at which the task was running (may be inherited) when the structure was populated. */
 	UBaseType_t uxBasePriority;		/* The priority to which the task will return if the task's current priority has been inherited to avoid unbounded priority inversion when obtaining a mutex.  Only valid if configUSE_MUTEXES is defined as 1 in FreeRTOSConfig.h. */
 	uint32_t ulRunTimeCounter;		/* The total run time allocated to the task so far, as defined by the run time stats clock.  See http://www.freertos.org/rtos-run-time-stats.html.  Only valid when configGENERATE_RUN_TIME_STATS is defined as 1 in FreeRTOSConfig.h. */
+	uint32_t ulSwitchInCount;		/* The number of times the task has been switched in.  Only valid when configGENERATE_RUN_TIME_STATS is defined as 1 in FreeRTOSConfig.h. */
 	StackType_t *pxStackBase;		/* Points to the lowest address of the task's stack area. */
 	configSTACK_DEPTH_TYPE usStackHighWaterMark;	/* The minimum amount of stack space that has remained for the task since the task was created.  The closer this value is to zero the closer the task has come to overflowing its stack. */
+	#if( configHEAP_TRACK_OWNERS == 1 )
+		size_t xHeapBytes;			/* Heap bytes, headers included, in blocks the task allocated and has not freed.  Only present when configHEAP_TRACK_OWNERS is defined as 1 in FreeRTOSConfig.h. */
+	#endif
+	#if( configUSE_TASK_ENERGY_STATS == 1 )
+		uint32_t ulEnergyRunTime[ configENERGY_PROFILES ];	/* ulRunTimeCounter split by the energy profile, such as the clock profile, in force while the task ran.  Only present when configUSE_TASK_ENERGY_STATS is defined as 1 in FreeRTOSConfig.h. */
+		uint32_t ulWakeCount;		/* Low power sleeps the task was the first to run after, so the task they ended for.  Only present when configUSE_TASK_ENERGY_STATS is defined as 1 in FreeRTOSConfig.h. */
+	#endif
+	#if( configUSE_NEWLIB_REENTRANT == 2 )
+		BaseType_t xNewlibReent;	/* pdTRUE if the task has created a newlib reent of its own with xTaskNewlibReentCreate().  Only present when configUSE_NEWLIB_REENTRANT is defined as 2 in FreeRTOSConfig.h. */
+	#endif
 } TaskStatus_t;
 
+/* Used with vTaskGetReadyLatency() and vTaskGetSwitchTime() to return a
+distribution of times, in portSWITCH_PROFILE_TIME() counts. */
+typedef struct xSWITCH_PROFILE
+{
+	uint32_t ulCount;		/* Number of samples. */
+	uint32_t ulMin;			/* Shortest sample, 0xffffffff while ulCount is 0. */
+	uint32_t ulMax;			/* Longest sample. */
+	uint32_t ulBuckets[ configSWITCH_PROFILE_BUCKETS ];	/* Power of two histogram, see configSWITCH_PROFILE_FIRST_BUCKET_SHIFT. */
+} SwitchProfile_t;
+
+/* The kinds of section the section profiler keeps call sites for. */
+typedef enum
+{
+	eSectionMasked = 0,			/* BASEPRI raised from zero, by taskENTER_CRITICAL() or in an interrupt. */
+	eSectionSchedulerSuspended	/* From the outermost vTaskSuspendAll() to the matching xTaskResumeAll(). */
+} eSectionType;
+
+/* Used with uxTaskGetSectionProfile() to return one call site's sections, in
+portMASK_PROFILE_TIME() counts. */
+typedef struct xSECTION_SITE
+{
+	uint32_t ulSite;		/* Return address into the code that opened the sections. */
+	uint32_t ulCount;		/* Sections opened there since the site entered the table. */
+	uint32_t ulMaxTime;		/* Longest of them. */
+	uint32_t ulTotalTime;	/* All of them, wrapping at 2^32. */
+} SectionSite_t;
+
 /* Possible return values for eTaskConfirmSleepModeStatus(). */
 typedef enum
 {
@@ -1369,6 +1411,21 @@ TickType_t xTaskGetTickCount( void ) PRIVILEGED_FUNCTION;
  */
 TickType_t xTaskGetTickCountFromISR( void ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>uint32_t ulTaskGetTickCountUs( void );</PRE>
+ *
+ * Only available when the port defines portGET_TIME_US().
+ *
+ * @return A free running count of microseconds.  It is not reset when the
+ * scheduler starts and wraps every 2^32 microseconds (about 71 minutes), so
+ * intervals should be taken as unsigned differences.  Safe to call from an ISR.
+ *
+ * \defgroup ulTaskGetTickCountUs ulTaskGetTickCountUs
+ * \ingroup TaskUtils
+ */
+uint32_t ulTaskGetTickCountUs( void ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <PRE>uint16_t uxTaskGetNumberOfTasks( void );</PRE>
@@ -1517,6 +1574,399 @@ constant. */
 
 #endif
 
+#if( configUSE_TASK_ARENAS == 1 )
+
+	/**
+	 * task.h
+	 * <pre>BaseType_t xTaskArenaCreate( TaskHandle_t xTask, size_t xArenaSize );</pre>
+	 *
+	 * configUSE_TASK_ARENAS must be set to 1 in FreeRTOSConfig.h for the arena
+	 * functions to be available.
+	 *
+	 * Gives xTask a private arena of xArenaSize bytes, taken from the heap as a
+	 * single block.  The task then allocates from it with pvTaskArenaAlloc(),
+	 * which just advances a pointer.  Arena memory is never freed
+	 * piecemeal - the whole arena goes back to the heap with one vPortFree()
+	 * when the task is deleted, or is reused after vTaskArenaReset().  Passing
+	 * xTask as NULL gives the arena to the calling task.
+	 *
+	 * @return pdPASS if the arena was created, otherwise
+	 * errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY.
+	 */
+	BaseType_t xTaskArenaCreate( TaskHandle_t xTask, size_t xArenaSize ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>void *pvTaskArenaAlloc( size_t xWantedSize );</pre>
+	 *
+	 * Allocates xWantedSize bytes, rounded up to portBYTE_ALIGNMENT, from the
+	 * calling task's arena.  Returns NULL if the task has no arena or the arena
+	 * is exhausted.  Must only be called by the task that owns the arena.
+	 */
+	void *pvTaskArenaAlloc( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>void vTaskArenaReset( void );</pre>
+	 *
+	 * Releases everything the calling task has allocated from its arena, so a
+	 * task that loops over independent jobs can reuse the same memory.
+	 */
+	void vTaskArenaReset( void ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>size_t xTaskArenaGetFreeSize( TaskHandle_t xTask );</pre>
+	 *
+	 * Returns the number of bytes still available in the arena of xTask, or 0
+	 * if it does not have one.  Passing xTask as NULL queries the calling task.
+	 */
+	size_t xTaskArenaGetFreeSize( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TASK_ARENAS */
+
+#if( configUSE_NEWLIB_REENTRANT == 2 )
+
+	/**
+	 * task.h
+	 * <pre>BaseType_t xTaskNewlibReentCreate( void );</pre>
+	 *
+	 * configUSE_NEWLIB_REENTRANT must be set to 2 in FreeRTOSConfig.h for this
+	 * function to be available.
+	 *
+	 * With configUSE_NEWLIB_REENTRANT set to 1 every TCB holds a struct _reent
+	 * of its own.  Set to 2, a TCB holds only a pointer, and every task shares
+	 * newlib's global reent until it calls this function, which takes one from
+	 * the heap for the calling task and switches to it at once.  A task that
+	 * needs errno, strtok() or stdio state of its own, or calls the library
+	 * while another task may be in it, calls this before its first such use;
+	 * later calls return at once, so it can also go at the top of a helper
+	 * that several tasks use.  The reent is reclaimed and freed when the task
+	 * is deleted.  xTaskHasNewlibReent() and the xNewlibReent field of
+	 * TaskStatus_t report which tasks have one.
+	 *
+	 * @return pdPASS if the task has a reent of its own, otherwise
+	 * errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY.
+	 */
+	BaseType_t xTaskNewlibReentCreate( void ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>BaseType_t xTaskHasNewlibReent( TaskHandle_t xTask );</pre>
+	 *
+	 * Returns pdTRUE if xTask has called xTaskNewlibReentCreate().  Passing
+	 * xTask as NULL queries the calling task.
+	 */
+	BaseType_t xTaskHasNewlibReent( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_NEWLIB_REENTRANT */
+
+#if( configUSE_TASK_ENERGY_STATS == 1 )
+
+	/**
+	 * task.h
+	 * <pre>void vTaskSetEnergyProfile( UBaseType_t uxProfile );</pre>
+	 *
+	 * configUSE_TASK_ENERGY_STATS must be set to 1 in FreeRTOSConfig.h for this
+	 * function to be available.
+	 *
+	 * Tells the kernel the energy profile, 0 to configENERGY_PROFILES - 1, the
+	 * core now runs in - typically the clock profile, called by whatever
+	 * changes the clocks.  The run time of the calling task up to now is
+	 * charged to the profile being left, so every task's ulEnergyRunTime in
+	 * TaskStatus_t splits its ulRunTimeCounter by the profile it ran in.  The
+	 * profile is 0 until this is first called.
+	 */
+	void vTaskSetEnergyProfile( UBaseType_t uxProfile ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>void vTaskAttributeWake( void );</pre>
+	 *
+	 * configUSE_TASK_ENERGY_STATS must be set to 1 in FreeRTOSConfig.h for this
+	 * function to be available.
+	 *
+	 * Called by portSUPPRESS_TICKS_AND_SLEEP() after the core has actually
+	 * slept.  The next task other than the idle task to be switched in has its
+	 * ulWakeCount in TaskStatus_t incremented, being the task the core woke
+	 * for.  A wake no task claims before the idle task sleeps again is counted
+	 * against the idle task, as a wake that served nothing.
+	 */
+	void vTaskAttributeWake( void ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TASK_ENERGY_STATS */
+
+#if( configUSE_SWITCH_PROFILER == 1 )
+
+	/**
+	 * task.h
+	 * <pre>void vTaskGetReadyLatency( TaskHandle_t xTask, SwitchProfile_t *pxProfile );</pre>
+	 *
+	 * configUSE_SWITCH_PROFILER must be set to 1 in FreeRTOSConfig.h for this
+	 * function to be available.
+	 *
+	 * Copies out the distribution of how long xTask has waited between entering
+	 * the Ready state, or being preempted, and actually running.  A task that
+	 * often waits long at a priority it was expected to run promptly at has
+	 * its priority set too low, or shares it with a task that runs too long.
+	 * Passing xTask as NULL queries the calling task.
+	 */
+	void vTaskGetReadyLatency( TaskHandle_t xTask, SwitchProfile_t *pxProfile ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>void vTaskGetSwitchTime( SwitchProfile_t *pxIntegerOnly, SwitchProfile_t *pxWithFPU );</pre>
+	 *
+	 * configUSE_SWITCH_PROFILER must be set to 1 in FreeRTOSConfig.h for this
+	 * function to be available.
+	 *
+	 * Copies out the distribution of time spent in the context switch handler
+	 * itself, split by whether the outgoing task had a floating point context to
+	 * save.  Time spent by the hardware stacking and unstacking the exception
+	 * frame is not included.  Either pointer may be NULL.
+	 */
+	void vTaskGetSwitchTime( SwitchProfile_t *pxIntegerOnly, SwitchProfile_t *pxWithFPU ) PRIVILEGED_FUNCTION;
+
+	#ifdef portSWITCH_PROFILE_REGION_TIME
+
+		/**
+		 * task.h
+		 * <pre>uint32_t ulTaskGetRegionSwitchTime( SwitchProfile_t *pxProfile );</pre>
+		 *
+		 * Only available on ports with an MPU whose context switch reloads the
+		 * incoming task's regions, such as ARM_CM4_MPU.
+		 *
+		 * Copies out the distribution of the part of the context switch spent
+		 * reloading the MPU regions, which is included in vTaskGetSwitchTime().
+		 * Switches back to the task that was already running keep its regions
+		 * and are not counted.
+		 *
+		 * Returns the number of reloads that took longer than
+		 * configMPU_REGION_SWITCH_BUDGET timer counts.
+		 */
+		uint32_t ulTaskGetRegionSwitchTime( SwitchProfile_t *pxProfile ) PRIVILEGED_FUNCTION;
+
+	#endif /* portSWITCH_PROFILE_REGION_TIME */
+
+#endif /* configUSE_SWITCH_PROFILER */
+
+#if( configUSE_SECTION_PROFILER == 1 )
+
+	/**
+	 * task.h
+	 * <pre>UBaseType_t uxTaskGetSectionProfile( eSectionType eType, SectionSite_t *pxSites, UBaseType_t uxMaxSites, BaseType_t xReset );</pre>
+	 *
+	 * configUSE_SECTION_PROFILER must be set to 1 in FreeRTOSConfig.h for this
+	 * function to be available.
+	 *
+	 * Copies out the call sites that opened the longest sections of type
+	 * eType, longest first.  The kernel keeps configSECTION_PROFILE_SITES
+	 * sites per type; once the table is full a new site only gets in with a
+	 * section longer than the longest of the site it replaces, so the sites
+	 * that remain are the worst seen.  Sites are return addresses, to look up
+	 * in the executable.  If xReset is not pdFALSE the table is emptied after
+	 * the copy.
+	 *
+	 * Returns the number of sites copied, at most uxMaxSites.
+	 */
+	UBaseType_t uxTaskGetSectionProfile( eSectionType eType, SectionSite_t *pxSites, UBaseType_t uxMaxSites, BaseType_t xReset ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_SECTION_PROFILER */
+
+#if( configUSE_EDF_SCHEDULING == 1 )
+
+	/**
+	 * task.h
+	 * <pre>BaseType_t xTaskCreateEdf( TaskFunction_t pvTaskCode, const char * const pcName, configSTACK_DEPTH_TYPE usStackDepth, void *pvParameters, TickType_t xPeriod, TickType_t xRelativeDeadline, TaskHandle_t *pvCreatedTask );</pre>
+	 *
+	 * configUSE_EDF_SCHEDULING must be set to 1 in FreeRTOSConfig.h for the
+	 * deadline functions to be available.
+	 *
+	 * As xTaskCreate(), but the task is created at configEDF_PRIORITY with a
+	 * job released every xPeriod ticks, each to be finished within
+	 * xRelativeDeadline ticks of its release.  The first job is released at
+	 * once.  Ready tasks at configEDF_PRIORITY run earliest deadline first
+	 * instead of taking turns, so a set of such tasks whose run time per
+	 * period adds up to no more than the time left by higher priority tasks
+	 * meets every deadline.
+	 *
+	 * The task body runs one job and then calls xTaskWaitForNextPeriod():
+	 * <pre>
+	 void vPeriodicTask( void * pvParameters )
+	 {
+		for( ;; )
+		{
+			vDoTheWork();
+			xTaskWaitForNextPeriod();
+		}
+	 }
+	   </pre>
+	 *
+	 * A task that waits on a queue or semaphore is ordered by its current
+	 * deadline when it becomes ready, but only preempts a running deadline
+	 * task at the next tick or yield.
+	 */
+	#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		BaseType_t xTaskCreateEdf(	TaskFunction_t pxTaskCode,
+									const char * const pcName,	/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+									const configSTACK_DEPTH_TYPE usStackDepth,
+									void * const pvParameters,
+									const TickType_t xPeriod,
+									const TickType_t xRelativeDeadline,
+									TaskHandle_t * const pxCreatedTask ) PRIVILEGED_FUNCTION;
+	#endif
+
+	/**
+	 * task.h
+	 * <pre>void vTaskSetDeadline( TaskHandle_t xTask, TickType_t xPeriod, TickType_t xRelativeDeadline );</pre>
+	 *
+	 * Sets the period and relative deadline of xTask, releasing its first job
+	 * now.  Only has an effect on the order tasks run in while xTask runs at
+	 * configEDF_PRIORITY, so a statically created task can be given a deadline
+	 * after creation.  Passing xTask as NULL sets the calling task.
+	 */
+	void vTaskSetDeadline( TaskHandle_t xTask, TickType_t xPeriod, TickType_t xRelativeDeadline ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>BaseType_t xTaskWaitForNextPeriod( void );</pre>
+	 *
+	 * Ends the calling task's current job and blocks until its next job is
+	 * released, one period after the last.  A job that overran into the next
+	 * period does not block, but the next job is still ordered by its own
+	 * deadline.  The calling task must have a deadline.
+	 *
+	 * @return pdTRUE if the job that just ended met its deadline, pdFALSE if
+	 * it missed it, in which case the task's deadline miss count is also
+	 * incremented.
+	 */
+	BaseType_t xTaskWaitForNextPeriod( void ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>uint32_t ulTaskGetDeadlineMisses( TaskHandle_t xTask );</pre>
+	 *
+	 * Returns how many jobs of xTask have missed their deadline.  Passing
+	 * xTask as NULL queries the calling task.
+	 */
+	uint32_t ulTaskGetDeadlineMisses( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_EDF_SCHEDULING */
+
+#if( configUSE_TASK_BUDGETS == 1 )
+
+	/**
+	 * task.h
+	 * <pre>void vTaskSetBudget( TaskHandle_t xTask, TickType_t xBudget, TickType_t xPeriod );</pre>
+	 *
+	 * configUSE_TASK_BUDGETS must be set to 1 in FreeRTOSConfig.h for the
+	 * budget functions to be available.
+	 *
+	 * Limits xTask to running for xBudget ticks in every xPeriod ticks.  Each
+	 * tick is charged to the task that was running when it ended.  A task
+	 * that uses up its budget is demoted to configBUDGET_DEMOTED_PRIORITY,
+	 * and vApplicationBudgetOverrunHook( xTask ) is called from the tick
+	 * interrupt if configUSE_BUDGET_OVERRUN_HOOK is 1.  The task gets its
+	 * priority back when its period ends.  A demoted task that holds a mutex
+	 * keeps any priority it has inherited.
+	 *
+	 * The first period starts now.  Passing xBudget as 0 removes the limit,
+	 * and passing xTask as NULL sets the calling task.  Calling
+	 * vTaskPrioritySet() on a task while it is demoted only lasts until the
+	 * task's period ends.
+	 */
+	void vTaskSetBudget( TaskHandle_t xTask, TickType_t xBudget, TickType_t xPeriod ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>uint32_t ulTaskGetBudgetOverruns( TaskHandle_t xTask );</pre>
+	 *
+	 * Returns how many times xTask has used up its budget.  Passing xTask as
+	 * NULL queries the calling task.
+	 */
+	uint32_t ulTaskGetBudgetOverruns( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TASK_BUDGETS */
+
+#if( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+	/**
+	 * task.h
+	 * <pre>void vTaskSetPreemptionThreshold( TaskHandle_t xTask, UBaseType_t uxThreshold );</pre>
+	 *
+	 * configUSE_PREEMPTION_THRESHOLD must be set to 1 in FreeRTOSConfig.h for
+	 * the preemption threshold functions to be available.
+	 *
+	 * While xTask runs, only tasks of a priority above uxThreshold preempt it.
+	 * Tasks at or below the threshold, its own priority included, wait until
+	 * it blocks, suspends or is preempted by a more urgent task, so tasks
+	 * that share a threshold never preempt one another and switch only where
+	 * one of them blocks.  The task competes for the processor at its own
+	 * priority while it is not running, and keeps the threshold while it is
+	 * preempted.  taskYIELD() does not hand the processor to a task at or
+	 * below the threshold.
+	 *
+	 * A threshold at or below the task's priority, the default, removes it.
+	 * Passing xTask as NULL sets the calling task.  The threshold must not be
+	 * configEDF_PRIORITY, and a task that allocates from the heap must not be
+	 * given one above configHEAP_LOCK_CEILING.
+	 */
+	void vTaskSetPreemptionThreshold( TaskHandle_t xTask, UBaseType_t uxThreshold ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>UBaseType_t uxTaskGetPreemptionThreshold( TaskHandle_t xTask );</pre>
+	 *
+	 * Returns the threshold set by vTaskSetPreemptionThreshold().  Passing
+	 * xTask as NULL queries the calling task.
+	 */
+	UBaseType_t uxTaskGetPreemptionThreshold( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+
+#if( configUSE_TASK_FPU_POLICY == 1 )
+
+	/* Whether a task may use the floating point unit, see vTaskSetFpuPolicy(). */
+	typedef enum
+	{
+		eTaskFpuNone = 0,	/* Integer only, the default. */
+		eTaskFpuAllowed		/* May use the FPU, so may be switched with its FPU registers. */
+	} eTaskFpuPolicy;
+
+	/**
+	 * task.h
+	 * <pre>void vTaskSetFpuPolicy( TaskHandle_t xTask, eTaskFpuPolicy ePolicy );</pre>
+	 *
+	 * configUSE_TASK_FPU_POLICY must be set to 1 in FreeRTOSConfig.h for the
+	 * FPU policy functions to be available.
+	 *
+	 * Tasks are created integer only.  The port switches such a task by its
+	 * core registers alone, as long as it never executes a floating point
+	 * instruction; one that does carries an FPU frame from then on, and each
+	 * switch of it saves and restores s16-s31 too, with s0-s15 and FPSCR
+	 * stacked by every interrupt that uses the FPU.  The kernel checks each
+	 * integer only task as it is switched out, and calls
+	 * vApplicationFpuMisuseHook( xTask, pcTaskName ) from the context switch
+	 * if it was handed an FPU frame.  Float formatting and compiler spills to
+	 * s registers are the usual causes.
+	 *
+	 * A task that needs the FPU sets eTaskFpuAllowed before its first
+	 * floating point instruction.  Passing xTask as NULL sets the calling
+	 * task.
+	 */
+	void vTaskSetFpuPolicy( TaskHandle_t xTask, eTaskFpuPolicy ePolicy ) PRIVILEGED_FUNCTION;
+
+	/**
+	 * task.h
+	 * <pre>eTaskFpuPolicy eTaskGetFpuPolicy( TaskHandle_t xTask );</pre>
+	 *
+	 * Returns the FPU policy of xTask.  Passing xTask as NULL queries the
+	 * calling task.
+	 */
+	eTaskFpuPolicy eTaskGetFpuPolicy( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TASK_FPU_POLICY */
+
 /**
  * task.h
  * <pre>BaseType_t xTaskCallApplicationTaskHook( TaskHandle_t xTask, void *pvParameter );</pre>
@@ -1772,6 +2222,7 @@ TickType_t xTaskGetIdleRunTimeCounter( void ) PRIVILEGED_FUNCTION;
 /**
  * task. h
  * <PRE>BaseType_t xTaskNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction );</PRE>
+ * <PRE>BaseType_t xTaskNotifyIndexed( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, uint32_t ulValue, eNotifyAction eAction );</PRE>
  *
  * configUSE_TASK_NOTIFICATIONS must be undefined or defined as 1 for this
  * function to be available.
@@ -1779,6 +2230,14 @@ TickType_t xTaskGetIdleRunTimeCounter( void ) PRIVILEGED_FUNCTION;
  * When configUSE_TASK_NOTIFICATIONS is set to one each task has its own private
  * "notification value", which is a 32-bit unsigned integer (uint32_t).
  *
+ * Each task has configTASK_NOTIFICATION_ARRAY_ENTRIES such values, each with
+ * its own pending state, so separate sources can signal one task without
+ * disturbing each other.  Every notification function has an Indexed version
+ * that takes the index to act on; the plain version acts on index
+ * tskDEFAULT_INDEX_TO_NOTIFY, 0, which is what the kernel's own objects that
+ * block on notifications (stream buffers and the like) use.  A task blocked
+ * on one index is only unblocked by a notification sent to that index.
+ *
  * Events can be sent to a task using an intermediary object.  Examples of such
  * objects are queues, semaphores, mutexes and event groups.  Task notifications
  * are a method of sending an event directly to a task without the need for such
@@ -1848,9 +2307,11 @@ TickType_t xTaskGetIdleRunTimeCounter( void ) PRIVILEGED_FUNCTION;
  * \defgroup xTaskNotify xTaskNotify
  * \ingroup TaskNotifications
  */
-BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue ) PRIVILEGED_FUNCTION;
-#define xTaskNotify( xTaskToNotify, ulValue, eAction ) xTaskGenericNotify( ( xTaskToNotify ), ( ulValue ), ( eAction ), NULL )
-#define xTaskNotifyAndQuery( xTaskToNotify, ulValue, eAction, pulPreviousNotifyValue ) xTaskGenericNotify( ( xTaskToNotify ), ( ulValue ), ( eAction ), ( pulPreviousNotifyValue ) )
+BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue ) PRIVILEGED_FUNCTION;
+#define xTaskNotify( xTaskToNotify, ulValue, eAction ) xTaskGenericNotify( ( xTaskToNotify ), ( tskDEFAULT_INDEX_TO_NOTIFY ), ( ulValue ), ( eAction ), NULL )
+#define xTaskNotifyIndexed( xTaskToNotify, uxIndexToNotify, ulValue, eAction ) xTaskGenericNotify( ( xTaskToNotify ), ( uxIndexToNotify ), ( ulValue ), ( eAction ), NULL )
+#define xTaskNotifyAndQuery( xTaskToNotify, ulValue, eAction, pulPreviousNotifyValue ) xTaskGenericNotify( ( xTaskToNotify ), ( tskDEFAULT_INDEX_TO_NOTIFY ), ( ulValue ), ( eAction ), ( pulPreviousNotifyValue ) )
+#define xTaskNotifyAndQueryIndexed( xTaskToNotify, uxIndexToNotify, ulValue, eAction, pulPreviousNotifyValue ) xTaskGenericNotify( ( xTaskToNotify ), ( uxIndexToNotify ), ( ulValue ), ( eAction ), ( pulPreviousNotifyValue ) )
 
 /**
  * task. h
@@ -1939,9 +2400,11 @@ BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNo
  * \defgroup xTaskNotify xTaskNotify
  * \ingroup TaskNotifications
  */
-BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
-#define xTaskNotifyFromISR( xTaskToNotify, ulValue, eAction, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( ulValue ), ( eAction ), NULL, ( pxHigherPriorityTaskWoken ) )
-#define xTaskNotifyAndQueryFromISR( xTaskToNotify, ulValue, eAction, pulPreviousNotificationValue, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( ulValue ), ( eAction ), ( pulPreviousNotificationValue ), ( pxHigherPriorityTaskWoken ) )
+BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+#define xTaskNotifyFromISR( xTaskToNotify, ulValue, eAction, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( tskDEFAULT_INDEX_TO_NOTIFY ), ( ulValue ), ( eAction ), NULL, ( pxHigherPriorityTaskWoken ) )
+#define xTaskNotifyIndexedFromISR( xTaskToNotify, uxIndexToNotify, ulValue, eAction, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( uxIndexToNotify ), ( ulValue ), ( eAction ), NULL, ( pxHigherPriorityTaskWoken ) )
+#define xTaskNotifyAndQueryFromISR( xTaskToNotify, ulValue, eAction, pulPreviousNotificationValue, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( tskDEFAULT_INDEX_TO_NOTIFY ), ( ulValue ), ( eAction ), ( pulPreviousNotificationValue ), ( pxHigherPriorityTaskWoken ) )
+#define xTaskNotifyAndQueryIndexedFromISR( xTaskToNotify, uxIndexToNotify, ulValue, eAction, pulPreviousNotificationValue, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( uxIndexToNotify ), ( ulValue ), ( eAction ), ( pulPreviousNotificationValue ), ( pxHigherPriorityTaskWoken ) )
 
 /**
  * task. h
@@ -2016,7 +2479,9 @@ BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify, uint32_t ulVal
  * \defgroup xTaskNotifyWait xTaskNotifyWait
  * \ingroup TaskNotifications
  */
-BaseType_t xTaskNotifyWait( uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+BaseType_t xTaskGenericNotifyWait( UBaseType_t uxIndexToWaitOn, uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+#define xTaskNotifyWait( ulBitsToClearOnEntry, ulBitsToClearOnExit, pulNotificationValue, xTicksToWait ) xTaskGenericNotifyWait( tskDEFAULT_INDEX_TO_NOTIFY, ( ulBitsToClearOnEntry ), ( ulBitsToClearOnExit ), ( pulNotificationValue ), ( xTicksToWait ) )
+#define xTaskNotifyWaitIndexed( uxIndexToWaitOn, ulBitsToClearOnEntry, ulBitsToClearOnExit, pulNotificationValue, xTicksToWait ) xTaskGenericNotifyWait( ( uxIndexToWaitOn ), ( ulBitsToClearOnEntry ), ( ulBitsToClearOnExit ), ( pulNotificationValue ), ( xTicksToWait ) )
 
 /**
  * task. h
@@ -2062,7 +2527,8 @@ BaseType_t xTaskNotifyWait( uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClea
  * \defgroup xTaskNotifyGive xTaskNotifyGive
  * \ingroup TaskNotifications
  */
-#define xTaskNotifyGive( xTaskToNotify ) xTaskGenericNotify( ( xTaskToNotify ), ( 0 ), eIncrement, NULL )
+#define xTaskNotifyGive( xTaskToNotify ) xTaskGenericNotify( ( xTaskToNotify ), ( tskDEFAULT_INDEX_TO_NOTIFY ), ( 0 ), eIncrement, NULL )
+#define xTaskNotifyGiveIndexed( xTaskToNotify, uxIndexToNotify ) xTaskGenericNotify( ( xTaskToNotify ), ( uxIndexToNotify ), ( 0 ), eIncrement, NULL )
 
 /**
  * task. h
@@ -2117,7 +2583,9 @@ BaseType_t xTaskNotifyWait( uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClea
  * \defgroup xTaskNotifyWait xTaskNotifyWait
  * \ingroup TaskNotifications
  */
-void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+void vTaskGenericNotifyGiveFromISR( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+#define vTaskNotifyGiveFromISR( xTaskToNotify, pxHigherPriorityTaskWoken ) vTaskGenericNotifyGiveFromISR( ( xTaskToNotify ), ( tskDEFAULT_INDEX_TO_NOTIFY ), ( pxHigherPriorityTaskWoken ) )
+#define vTaskNotifyGiveIndexedFromISR( xTaskToNotify, uxIndexToNotify, pxHigherPriorityTaskWoken ) vTaskGenericNotifyGiveFromISR( ( xTaskToNotify ), ( uxIndexToNotify ), ( pxHigherPriorityTaskWoken ) )
 
 /**
  * task. h
@@ -2186,7 +2654,9 @@ void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPri
  * \defgroup ulTaskNotifyTake ulTaskNotifyTake
  * \ingroup TaskNotifications
  */
-uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+uint32_t ulTaskGenericNotifyTake( UBaseType_t uxIndexToWaitOn, BaseType_t xClearCountOnExit, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+#define ulTaskNotifyTake( xClearCountOnExit, xTicksToWait ) ulTaskGenericNotifyTake( ( tskDEFAULT_INDEX_TO_NOTIFY ), ( xClearCountOnExit ), ( xTicksToWait ) )
+#define ulTaskNotifyTakeIndexed( uxIndexToWaitOn, xClearCountOnExit, xTicksToWait ) ulTaskGenericNotifyTake( ( uxIndexToWaitOn ), ( xClearCountOnExit ), ( xTicksToWait ) )
 
 /**
  * task. h
@@ -2202,7 +2672,26 @@ uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait
  * \defgroup xTaskNotifyStateClear xTaskNotifyStateClear
  * \ingroup TaskNotifications
  */
-BaseType_t xTaskNotifyStateClear( TaskHandle_t xTask );
+BaseType_t xTaskGenericNotifyStateClear( TaskHandle_t xTask, UBaseType_t uxIndexToClear ) PRIVILEGED_FUNCTION;
+#define xTaskNotifyStateClear( xTask ) xTaskGenericNotifyStateClear( ( xTask ), ( tskDEFAULT_INDEX_TO_NOTIFY ) )
+#define xTaskNotifyStateClearIndexed( xTask, uxIndexToClear ) xTaskGenericNotifyStateClear( ( xTask ), ( uxIndexToClear ) )
+
+/**
+ * task. h
+ * <PRE>uint32_t ulTaskNotifyValueClear( TaskHandle_t xTask, uint32_t ulBitsToClear );</pre>
+ *
+ * Clear the bits set in ulBitsToClear in the notification value of the task
+ * referenced by xTask, or of the calling task if xTask is NULL, without
+ * touching its notification state.  Pass ~0 to clear the value to 0, for
+ * example to discard gives that arrived while the value was used otherwise.
+ *
+ * @return The notification value before the bits were cleared.
+ * \defgroup ulTaskNotifyValueClear ulTaskNotifyValueClear
+ * \ingroup TaskNotifications
+ */
+uint32_t ulTaskGenericNotifyValueClear( TaskHandle_t xTask, UBaseType_t uxIndexToClear, uint32_t ulBitsToClear ) PRIVILEGED_FUNCTION;
+#define ulTaskNotifyValueClear( xTask, ulBitsToClear ) ulTaskGenericNotifyValueClear( ( xTask ), ( tskDEFAULT_INDEX_TO_NOTIFY ), ( ulBitsToClear ) )
+#define ulTaskNotifyValueClearIndexed( xTask, uxIndexToClear, ulBitsToClear ) ulTaskGenericNotifyValueClear( ( xTask ), ( uxIndexToClear ), ( ulBitsToClear ) )
 
 /*-----------------------------------------------------------
  * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
@@ -2309,6 +2798,18 @@ void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem, const Tick
  */
 portDONT_DISCARD void vTaskSwitchContext( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Accounts a section of type eType, opened from ulSite, that lasted ulTime
+ * portMASK_PROFILE_TIME() counts.  Must be called with BASEPRI raised.
+ */
+#if( configUSE_SECTION_PROFILER == 1 )
+	void vTaskSectionProfileRecord( eSectionType eType, uint32_t ulSite, uint32_t ulTime ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * THESE FUNCTIONS MUST NOT BE USED FROM APPLICATION CODE.  THEY ARE USED BY
  * THE EVENT BITS MODULE.
@@ -2408,6 +2909,17 @@ eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
  */
 TaskHandle_t pvTaskIncrementMutexHeldCount( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * For internal use only.  Run the calling task at uxCeiling until
+ * vTaskPriorityCeilingRestore() is called with the value returned, so no
+ * other task below the ceiling can run in between.  The caller must be below
+ * the ceiling, as a task already at it would share time slices with the
+ * raised one.  Does nothing before the scheduler has started or while it is
+ * suspended.  Used by the heap when configHEAP_LOCK_CEILING is not 0.
+ */
+UBaseType_t uxTaskPriorityCeilingRaise( UBaseType_t uxCeiling ) PRIVILEGED_FUNCTION;
+void vTaskPriorityCeilingRestore( UBaseType_t uxCeiling, UBaseType_t uxPriorityToRestore ) PRIVILEGED_FUNCTION;
+
 /*
  * For internal use only.  Same as vTaskSetTimeOutState(), but without a critial
  * section.
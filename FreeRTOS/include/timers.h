@@ -1096,6 +1096,54 @@ TaskHandle_t xTimerGetTimerDaemonTaskHandle( void ) PRIVILEGED_FUNCTION;
 #define xTimerResetFromISR( xTimer, pxHigherPriorityTaskWoken ) xTimerGenericCommand( ( xTimer ), tmrCOMMAND_RESET_FROM_ISR, ( xTaskGetTickCountFromISR() ), ( pxHigherPriorityTaskWoken ), 0U )
 
 
+/**
+ * BaseType_t xTimerStartBatch( TimerHandle_t const *pxTimers, UBaseType_t uxCount, TickType_t xTicksToWait );
+ * BaseType_t xTimerStopBatch( TimerHandle_t const *pxTimers, UBaseType_t uxCount, TickType_t xTicksToWait );
+ * BaseType_t xTimerResetBatch( TimerHandle_t const *pxTimers, UBaseType_t uxCount, TickType_t xTicksToWait );
+ * BaseType_t xTimerChangePeriodBatch( TimerHandle_t const *pxTimers, UBaseType_t uxCount, TickType_t xNewPeriod, TickType_t xTicksToWait );
+ *
+ * As xTimerStart(), xTimerStop(), xTimerReset() and xTimerChangePeriod(), but
+ * applied to every timer in pxTimers with a single message on the timer
+ * command queue, so a batch takes one slot of configTIMER_QUEUE_LENGTH however
+ * many timers it names.  Start and reset batches share one command time, so
+ * their timers expire together.  The FromISR variants follow
+ * xTimerStartFromISR() and friends.
+ *
+ * configUSE_TIMER_BATCH_COMMANDS must be set to 1 in FreeRTOSConfig.h for
+ * these macros to be available.
+ *
+ * Only the address of pxTimers is queued.  The array must therefore stay
+ * valid and unchanged until the timer service task has processed the
+ * command, which is most simply met by a const array at file scope.
+ *
+ * @param pxTimers The handles of the timers to act on.
+ *
+ * @param uxCount The number of handles in pxTimers.
+ *
+ * @param xTicksToWait As for the single timer macros.
+ *
+ * @return pdFAIL if the command could not be queued before xTicksToWait
+ * passed, otherwise pdPASS.
+ *
+ * Example usage:
+ * @verbatim
+ * static TimerHandle_t xProtocolTimers[ 3 ];
+ *
+ * void vOnLinkDown( void )
+ * {
+ *     // Stop every protocol timeout with one queue message.
+ *     xTimerStopBatch( xProtocolTimers, 3, portMAX_DELAY );
+ * }
+ * @endverbatim
+ */
+#define xTimerStartBatch( pxTimers, uxCount, xTicksToWait ) xTimerGenericCommandBatch( ( pxTimers ), ( uxCount ), tmrCOMMAND_START, ( xTaskGetTickCount() ), NULL, ( xTicksToWait ) )
+#define xTimerStopBatch( pxTimers, uxCount, xTicksToWait ) xTimerGenericCommandBatch( ( pxTimers ), ( uxCount ), tmrCOMMAND_STOP, 0U, NULL, ( xTicksToWait ) )
+#define xTimerResetBatch( pxTimers, uxCount, xTicksToWait ) xTimerGenericCommandBatch( ( pxTimers ), ( uxCount ), tmrCOMMAND_RESET, ( xTaskGetTickCount() ), NULL, ( xTicksToWait ) )
+#define xTimerChangePeriodBatch( pxTimers, uxCount, xNewPeriod, xTicksToWait ) xTimerGenericCommandBatch( ( pxTimers ), ( uxCount ), tmrCOMMAND_CHANGE_PERIOD, ( xNewPeriod ), NULL, ( xTicksToWait ) )
+#define xTimerStartBatchFromISR( pxTimers, uxCount, pxHigherPriorityTaskWoken ) xTimerGenericCommandBatch( ( pxTimers ), ( uxCount ), tmrCOMMAND_START_FROM_ISR, ( xTaskGetTickCountFromISR() ), ( pxHigherPriorityTaskWoken ), 0U )
+#define xTimerStopBatchFromISR( pxTimers, uxCount, pxHigherPriorityTaskWoken ) xTimerGenericCommandBatch( ( pxTimers ), ( uxCount ), tmrCOMMAND_STOP_FROM_ISR, 0, ( pxHigherPriorityTaskWoken ), 0U )
+#define xTimerResetBatchFromISR( pxTimers, uxCount, pxHigherPriorityTaskWoken ) xTimerGenericCommandBatch( ( pxTimers ), ( uxCount ), tmrCOMMAND_RESET_FROM_ISR, ( xTaskGetTickCountFromISR() ), ( pxHigherPriorityTaskWoken ), 0U )
+
 /**
  * BaseType_t xTimerPendFunctionCallFromISR( PendedFunction_t xFunctionToPend,
  *                                          void *pvParameter1,
@@ -1281,6 +1329,10 @@ TickType_t xTimerGetExpiryTime( TimerHandle_t xTimer ) PRIVILEGED_FUNCTION;
 BaseType_t xTimerCreateTimerTask( void ) PRIVILEGED_FUNCTION;
 BaseType_t xTimerGenericCommand( TimerHandle_t xTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue, BaseType_t * const pxHigherPriorityTaskWoken, const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+#if( configUSE_TIMER_BATCH_COMMANDS == 1 )
+	BaseType_t xTimerGenericCommandBatch( TimerHandle_t const * const pxTimers, const UBaseType_t uxCount, const BaseType_t xCommandID, const TickType_t xOptionalValue, BaseType_t * const pxHigherPriorityTaskWoken, const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+#endif
+
 #if( configUSE_TRACE_FACILITY == 1 )
 	void vTimerSetTimerNumber( TimerHandle_t xTimer, UBaseType_t uxTimerNumber ) PRIVILEGED_FUNCTION;
 	UBaseType_t uxTimerGetTimerNumber( TimerHandle_t xTimer ) PRIVILEGED_FUNCTION;
@@ -0,0 +1,116 @@
+/*
+ * Fixed size block pools - see mempool.h.
+ */
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mempool.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/*-----------------------------------------------------------*/
+
+void vMemPoolInit( MemPool_t *pxPool, void *pvStorage, size_t xBlockSize, UBaseType_t uxBlockCount )
+{
+uint8_t *pucBlock;
+UBaseType_t ux;
+
+	configASSERT( pxPool );
+	configASSERT( ( ( portPOINTER_SIZE_TYPE ) pvStorage & ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) == 0 );
+
+	/* Each free block has to be able to hold the link to the next one, and
+	every block has to stay aligned. */
+	if( xBlockSize < sizeof( void * ) )
+	{
+		xBlockSize = sizeof( void * );
+	}
+	xBlockSize = ( xBlockSize + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+	if( pvStorage == NULL )
+	{
+		uxBlockCount = 0;
+	}
+
+	pxPool->pvFreeList = NULL;
+	pxPool->pucStart = ( uint8_t * ) pvStorage;
+	pxPool->pucEnd = ( uint8_t * ) pvStorage + ( xBlockSize * ( size_t ) uxBlockCount );
+	pxPool->xBlockSize = xBlockSize;
+	pxPool->uxFreeBlocks = uxBlockCount;
+	pxPool->uxMinimumFreeBlocks = uxBlockCount;
+
+	/* Link the blocks last to first so the first allocation returns the
+	lowest address. */
+	for( ux = uxBlockCount; ux > 0; ux-- )
+	{
+		pucBlock = pxPool->pucStart + ( xBlockSize * ( size_t ) ( ux - 1 ) );
+		*( ( void ** ) pucBlock ) = pxPool->pvFreeList;
+		pxPool->pvFreeList = pucBlock;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void *pvMemPoolAlloc( MemPool_t *pxPool )
+{
+void *pvReturn;
+UBaseType_t uxSavedInterruptStatus;
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		pvReturn = pxPool->pvFreeList;
+
+		if( pvReturn != NULL )
+		{
+			pxPool->pvFreeList = *( ( void ** ) pvReturn );
+			pxPool->uxFreeBlocks--;
+
+			if( pxPool->uxFreeBlocks < pxPool->uxMinimumFreeBlocks )
+			{
+				pxPool->uxMinimumFreeBlocks = pxPool->uxFreeBlocks;
+			}
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vMemPoolFree( MemPool_t *pxPool, void *pv )
+{
+UBaseType_t uxSavedInterruptStatus;
+
+	configASSERT( xMemPoolContains( pxPool, pv ) != pdFALSE );
+	configASSERT( ( ( size_t ) ( ( uint8_t * ) pv - pxPool->pucStart ) % pxPool->xBlockSize ) == 0 );
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		*( ( void ** ) pv ) = pxPool->pvFreeList;
+		pxPool->pvFreeList = pv;
+		pxPool->uxFreeBlocks++;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xMemPoolContains( const MemPool_t *pxPool, const void *pv )
+{
+	return ( ( ( const uint8_t * ) pv >= pxPool->pucStart ) && ( ( const uint8_t * ) pv < pxPool->pucEnd ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxMemPoolGetFreeBlocks( const MemPool_t *pxPool )
+{
+	return pxPool->uxFreeBlocks;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxMemPoolGetMinimumFreeBlocks( const MemPool_t *pxPool )
+{
+	return pxPool->uxMinimumFreeBlocks;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,155 @@
+/*
+ * Word copy and fill for the kernel and heap on Cortex-M4 - see portMEMCPY()
+ * and portMEMSET() in portmacro.h.
+ *
+ * Copies and fills of eight bytes or more first bring the destination up to a
+ * word boundary a byte at a time.  If the source is then word aligned too, the
+ * bulk moves 32 bytes per iteration as two pairs of four register LDM and STM;
+ * if not, it moves a word at a time with LDR, which the Cortex-M4 allows at
+ * any alignment for a small penalty, and an aligned STR.  Whatever is left,
+ * fewer than 32 bytes, goes a word and then a byte at a time.
+ *
+ * The image links newlib-nano (--specs=nano.specs), whose memcpy() and
+ * memset() are built for size and move a byte at a time.  Queue items,
+ * stream buffer data and new stacks are mostly word aligned, so most copies
+ * here take the LDM and STM path.  The kernbench build times both, see
+ * kernbench.h.
+ *
+ * LDR is only unaligned safe while SCB->CCR.UNALIGN_TRP is clear, as it is
+ * out of reset; nothing in this tree sets it.
+ */
+
+#include "FreeRTOS.h"
+
+#if( configUSE_PORT_MEMOPS == 1 )
+
+void *pvPortMemCpy( void *pvDest, const void *pvSrc, size_t xLength ) __attribute__ (( naked )) portKERNEL_HOT_PATH;
+void *pvPortMemSet( void *pvDest, int iValue, size_t xLength ) __attribute__ (( naked )) portKERNEL_HOT_PATH;
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMemCpy( void *pvDest, const void *pvSrc, size_t xLength )
+{
+	/* This is a naked function.  r0 is pvDest, r1 pvSrc, r2 xLength; r12
+	keeps pvDest to return. */
+
+	__asm volatile
+	(
+	"	mov r12, r0							\n"
+	"	cmp r2, #8							\n"
+	"	blo .Lcpy_bytes						\n"
+	"										\n"
+	".Lcpy_head:							\n" /* Align the destination. */
+	"	lsls r3, r0, #30					\n"
+	"	beq .Lcpy_aligned					\n"
+	"	ldrb r3, [r1], #1					\n"
+	"	strb r3, [r0], #1					\n"
+	"	subs r2, r2, #1						\n"
+	"	b .Lcpy_head						\n"
+	"										\n"
+	".Lcpy_aligned:							\n"
+	"	lsls r3, r1, #30					\n" /* Source still unaligned? */
+	"	bne .Lcpy_words						\n"
+	"	subs r2, r2, #32					\n"
+	"	blo .Lcpy_blocks_done				\n"
+	"	push {r4-r6}						\n"
+	"										\n"
+	".Lcpy_block:							\n"
+	"	ldmia r1!, {r3-r6}					\n"
+	"	stmia r0!, {r3-r6}					\n"
+	"	ldmia r1!, {r3-r6}					\n"
+	"	stmia r0!, {r3-r6}					\n"
+	"	subs r2, r2, #32					\n"
+	"	bhs .Lcpy_block						\n"
+	"	pop {r4-r6}							\n"
+	"										\n"
+	".Lcpy_blocks_done:						\n"
+	"	adds r2, r2, #32					\n"
+	"										\n"
+	".Lcpy_words:							\n"
+	"	subs r2, r2, #4						\n"
+	"	blo .Lcpy_words_done				\n"
+	"	ldr r3, [r1], #4					\n"
+	"	str r3, [r0], #4					\n"
+	"	b .Lcpy_words						\n"
+	"										\n"
+	".Lcpy_words_done:						\n"
+	"	adds r2, r2, #4						\n"
+	"										\n"
+	".Lcpy_bytes:							\n"
+	"	cbz r2, .Lcpy_done					\n"
+	".Lcpy_byte:							\n"
+	"	ldrb r3, [r1], #1					\n"
+	"	strb r3, [r0], #1					\n"
+	"	subs r2, r2, #1						\n"
+	"	bne .Lcpy_byte						\n"
+	"										\n"
+	".Lcpy_done:							\n"
+	"	mov r0, r12							\n"
+	"	bx lr								\n"
+	);
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMemSet( void *pvDest, int iValue, size_t xLength )
+{
+	/* This is a naked function.  r0 is pvDest, r1 iValue, r2 xLength; r12
+	keeps pvDest to return. */
+
+	__asm volatile
+	(
+	"	mov r12, r0							\n"
+	"	uxtb r1, r1							\n"
+	"	cmp r2, #8							\n"
+	"	blo .Lset_bytes						\n"
+	"										\n"
+	".Lset_head:							\n" /* Align the destination. */
+	"	lsls r3, r0, #30					\n"
+	"	beq .Lset_aligned					\n"
+	"	strb r1, [r0], #1					\n"
+	"	subs r2, r2, #1						\n"
+	"	b .Lset_head						\n"
+	"										\n"
+	".Lset_aligned:							\n" /* The byte in all four lanes. */
+	"	orr r1, r1, r1, lsl #8				\n"
+	"	orr r1, r1, r1, lsl #16				\n"
+	"	subs r2, r2, #32					\n"
+	"	blo .Lset_blocks_done				\n"
+	"	push {r4-r5}						\n"
+	"	mov r3, r1							\n"
+	"	mov r4, r1							\n"
+	"	mov r5, r1							\n"
+	"										\n"
+	".Lset_block:							\n"
+	"	stmia r0!, {r1, r3-r5}				\n"
+	"	stmia r0!, {r1, r3-r5}				\n"
+	"	subs r2, r2, #32					\n"
+	"	bhs .Lset_block						\n"
+	"	pop {r4-r5}							\n"
+	"										\n"
+	".Lset_blocks_done:						\n"
+	"	adds r2, r2, #32					\n"
+	"										\n"
+	".Lset_words:							\n"
+	"	subs r2, r2, #4						\n"
+	"	blo .Lset_words_done				\n"
+	"	str r1, [r0], #4					\n"
+	"	b .Lset_words						\n"
+	"										\n"
+	".Lset_words_done:						\n"
+	"	adds r2, r2, #4						\n"
+	"										\n"
+	".Lset_bytes:							\n"
+	"	cbz r2, .Lset_done					\n"
+	".Lset_byte:							\n"
+	"	strb r1, [r0], #1					\n"
+	"	subs r2, r2, #1						\n"
+	"	bne .Lset_byte						\n"
+	"										\n"
+	".Lset_done:							\n"
+	"	mov r0, r12							\n"
+	"	bx lr								\n"
+	);
+}
+
+#endif /* configUSE_PORT_MEMOPS */
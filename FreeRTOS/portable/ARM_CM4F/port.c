@@ -68,6 +68,17 @@ r0p1 port. */
 #define portNVIC_PENDSV_PRI					( ( ( uint32_t ) configKERNEL_INTERRUPT_PRIORITY ) << 16UL )
 #define portNVIC_SYSTICK_PRI				( ( ( uint32_t ) configKERNEL_INTERRUPT_PRIORITY ) << 24UL )
 
+/* MPU registers and the attributes of the stack guard region: read only at
+any privilege, never executable, normal write back memory as SRAM and CCM
+are, and 2^( SIZE + 1 ) = 32 bytes.  Read only rather than no access, so that
+the high water mark scan and a fault dump can still read the guarded words. */
+#define portMPU_CTRL_REG					( * ( ( volatile uint32_t * ) 0xe000ed94 ) )
+#define portMPU_RNR_REG						( * ( ( volatile uint32_t * ) 0xe000ed98 ) )
+#define portMPU_RASR_REG					( * ( ( volatile uint32_t * ) 0xe000eda0 ) )
+#define portMPU_CTRL_ENABLE_BIT				( 1UL << 0UL )
+#define portMPU_CTRL_PRIVDEFENA_BIT			( 1UL << 2UL )
+#define portMPU_RASR_STACK_GUARD			( ( 1UL << 28UL ) | ( 6UL << 24UL ) | ( 1UL << 19UL ) | ( 1UL << 17UL ) | ( 1UL << 16UL ) | ( 4UL << 1UL ) | 1UL )
+
 /* Constants required to check the validity of an interrupt priority. */
 #define portFIRST_USER_INTERRUPT_NUMBER		( 16 )
 #define portNVIC_IP_REGISTERS_OFFSET_16 	( 0xE000E3F0 )
@@ -120,8 +131,8 @@ void vPortSetupTimerInterrupt( void );
 /*
  * Exception handlers.
  */
-void xPortPendSVHandler( void ) __attribute__ (( naked ));
-void xPortSysTickHandler( void );
+void xPortPendSVHandler( void ) __attribute__ (( naked )) portKERNEL_HOT_PATH;
+void xPortSysTickHandler( void ) portKERNEL_HOT_PATH;
 void vPortSVCHandler( void ) __attribute__ (( naked ));
 
 /*
@@ -168,6 +179,29 @@ static UBaseType_t uxCriticalNesting = 0xaaaaaaaa;
 	static uint32_t ulStoppedTimerCompensation = 0;
 #endif /* configUSE_TICKLESS_IDLE */
 
+/*
+ * Written by xPortPendSVHandler(): entry time, exit time and the EXC_RETURN
+ * value the handler was entered with.  Read by the kernel through the
+ * portSWITCH_PROFILE_ macros.
+ */
+#if( configUSE_SWITCH_PROFILER == 1 )
+	portDONT_DISCARD volatile uint32_t ulPortPendSVStamps[ 3 ] = { 0 };
+#endif /* configUSE_SWITCH_PROFILER */
+
+/*
+ * The mask profiler's figures, and the outermost section in progress: the
+ * time it was raised at and by whom, and whether one is in progress at all.
+ * ulMaskClearedAt lets vPortExitCritical() name its caller as the code that
+ * cleared the mask.
+ */
+#if( configUSE_MASK_PROFILER == 1 )
+	static PortMaskProfile_t xMaskProfile = { 0 };
+	static uint32_t ulMaskRaisedTime = 0;
+	static uint32_t ulMaskRaisedAt = 0;
+	static uint32_t ulMaskClearedAt = 0;
+	static BaseType_t xMaskRaised = pdFALSE;
+#endif /* configUSE_MASK_PROFILER */
+
 /*
  * Used by the portASSERT_IF_INTERRUPT_PRIORITY_INVALID() macro to ensure
  * FreeRTOS API functions are not called from interrupts that have been assigned
@@ -362,6 +396,18 @@ BaseType_t xPortStartScheduler( void )
 	portNVIC_SYSPRI2_REG |= portNVIC_PENDSV_PRI;
 	portNVIC_SYSPRI2_REG |= portNVIC_SYSTICK_PRI;
 
+	#if( configUSE_MPU_STACK_GUARD == 1 )
+	{
+		/* vTaskStartScheduler() has already placed the region under the first
+		task's stack.  Everything outside it keeps the default memory map. */
+		portMPU_RNR_REG = portSTACK_GUARD_REGION;
+		portMPU_RASR_REG = portMPU_RASR_STACK_GUARD;
+		portMPU_CTRL_REG = portMPU_CTRL_PRIVDEFENA_BIT | portMPU_CTRL_ENABLE_BIT;
+		__asm volatile( "dsb" ::: "memory" );
+		__asm volatile( "isb" );
+	}
+	#endif
+
 	/* Start the timer that generates the tick ISR.  Interrupts are disabled
 	here already. */
 	vPortSetupTimerInterrupt();
@@ -369,6 +415,15 @@ BaseType_t xPortStartScheduler( void )
 	/* Initialise the critical nesting count ready for the first task. */
 	uxCriticalNesting = 0;
 
+	#if( configUSE_MASK_PROFILER == 1 )
+	{
+		/* The first task starts with BASEPRI cleared from assembly, which the
+		profiler does not see, so forget the section vTaskStartScheduler()
+		opened. */
+		xMaskRaised = pdFALSE;
+	}
+	#endif
+
 	/* Ensure the VFP is enabled - it should be anyway. */
 	vPortEnableVFP();
 
@@ -376,6 +431,7 @@ BaseType_t xPortStartScheduler( void )
 	*( portFPCCR ) |= portASPEN_AND_LSPEN_BITS;
 
 	/* Start the first task. */
+	traceSTART_FIRST_TASK();
 	prvPortStartFirstTask();
 
 	/* Should never get here as the tasks will now be executing!  Call the task
@@ -405,6 +461,16 @@ void vPortEnterCritical( void )
 	portDISABLE_INTERRUPTS();
 	uxCriticalNesting++;
 
+	#if( configUSE_MASK_PROFILER == 1 )
+	{
+		/* Credit the section to the caller rather than to this function. */
+		if( uxCriticalNesting == 1 )
+		{
+			ulMaskRaisedAt = portMASK_PROFILE_CALLER();
+		}
+	}
+	#endif
+
 	/* This is not the interrupt safe version of the enter critical function so
 	assert() if it is being called from an interrupt context.  Only API
 	functions that end in "FromISR" can be used in an interrupt.  Only assert if
@@ -423,24 +489,117 @@ void vPortExitCritical( void )
 	uxCriticalNesting--;
 	if( uxCriticalNesting == 0 )
 	{
+		#if( configUSE_MASK_PROFILER == 1 )
+		{
+			ulMaskClearedAt = portMASK_PROFILE_CALLER();
+		}
+		#endif
+
 		portENABLE_INTERRUPTS();
 	}
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_MASK_PROFILER == 1 )
+
+	__attribute__( ( noinline ) ) void vPortMaskProfileRaised( void )
+	{
+		/* BASEPRI is already raised, so nothing the mask covers can run before
+		the section is closed. */
+		ulMaskRaisedAt = portMASK_PROFILE_CALLER();
+		xMaskRaised = pdTRUE;
+		ulMaskRaisedTime = portMASK_PROFILE_TIME();
+	}
+
+#endif /* configUSE_MASK_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MASK_PROFILER == 1 )
+
+	__attribute__( ( noinline ) ) void vPortMaskProfileCleared( void )
+	{
+	uint32_t ulTime = portMASK_PROFILE_TIME() - ulMaskRaisedTime;
+	uint32_t ulClearedAt = ulMaskClearedAt;
+
+		if( ulClearedAt == 0 )
+		{
+			ulClearedAt = portMASK_PROFILE_CALLER();
+		}
+		ulMaskClearedAt = 0;
+
+		/* Clearing a mask that was never raised, as portENABLE_INTERRUPTS()
+		does on the way into a task, is not a section. */
+		if( xMaskRaised != pdFALSE )
+		{
+			xMaskRaised = pdFALSE;
+			( xMaskProfile.ulCount )++;
+
+			if( ulTime > xMaskProfile.ulMaxTime )
+			{
+				xMaskProfile.ulMaxTime = ulTime;
+				xMaskProfile.ulMaxRaisedAt = ulMaskRaisedAt;
+				xMaskProfile.ulMaxClearedAt = ulClearedAt;
+			}
+
+			#if( configUSE_SECTION_PROFILER == 1 )
+			{
+				vTaskSectionProfileRecord( eSectionMasked, ulMaskRaisedAt, ulTime );
+			}
+			#endif
+		}
+	}
+
+#endif /* configUSE_MASK_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MASK_PROFILER == 1 )
+
+	void vPortGetMaskProfile( PortMaskProfile_t *pxProfile, BaseType_t xReset )
+	{
+	uint32_t ulOriginalBASEPRI;
+
+		configASSERT( pxProfile );
+
+		/* Counted as a section itself, after the copy is taken. */
+		ulOriginalBASEPRI = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			*pxProfile = xMaskProfile;
+
+			if( xReset != pdFALSE )
+			{
+				xMaskProfile.ulCount = 0;
+				xMaskProfile.ulMaxTime = 0;
+				xMaskProfile.ulMaxRaisedAt = 0;
+				xMaskProfile.ulMaxClearedAt = 0;
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( ulOriginalBASEPRI );
+	}
+
+#endif /* configUSE_MASK_PROFILER */
+/*-----------------------------------------------------------*/
+
 void xPortPendSVHandler( void )
 {
 	/* This is a naked function. */
 
 	__asm volatile
 	(
+	#if( configUSE_SWITCH_PROFILER == 1 )
+	"	ldr r1, ulDwtCycCntConst			\n" /* Stamp the entry time and EXC_RETURN.  r1 and r2 were stacked by the hardware. */
+	"	ldr r1, [r1]						\n"
+	"	ldr r2, ulPendSVStampsConst			\n"
+	"	str r1, [r2]						\n"
+	"	str r14, [r2, #8]					\n"
+	"										\n"
+	#endif
 	"	mrs r0, psp							\n"
 	"	isb									\n"
 	"										\n"
 	"	ldr	r3, pxCurrentTCBConst			\n" /* Get the location of the current TCB. */
 	"	ldr	r2, [r3]						\n"
 	"										\n"
-	"	tst r14, #0x10						\n" /* Is the task using the FPU context?  If so, push high vfp registers. */
+	"	tst r14, #0x10						\n" /* Is the task using the FPU context?  If so, push high vfp registers.  An integer only task never is, see vTaskSetFpuPolicy(). */
 	"	it eq								\n"
 	"	vstmdbeq r0!, {s16-s31}				\n"
 	"										\n"
@@ -469,6 +628,13 @@ void xPortPendSVHandler( void )
 	"	msr psp, r0							\n"
 	"	isb									\n"
 	"										\n"
+	#if( configUSE_SWITCH_PROFILER == 1 )
+	"	ldr r2, ulDwtCycCntConst			\n" /* Stamp the exit time.  r2 and r3 are restored by the exception return. */
+	"	ldr r2, [r2]						\n"
+	"	ldr r3, ulPendSVStampsConst			\n"
+	"	str r2, [r3, #4]					\n"
+	"										\n"
+	#endif
 	#ifdef WORKAROUND_PMU_CM001 /* XMC4000 specific errata workaround. */
 		#if WORKAROUND_PMU_CM001 == 1
 	"			push { r14 }				\n"
@@ -480,6 +646,10 @@ void xPortPendSVHandler( void )
 	"										\n"
 	"	.align 4							\n"
 	"pxCurrentTCBConst: .word pxCurrentTCB	\n"
+	#if( configUSE_SWITCH_PROFILER == 1 )
+	"ulDwtCycCntConst: .word 0xe0001004		\n"
+	"ulPendSVStampsConst: .word ulPortPendSVStamps	\n"
+	#endif
 	::"i"(configMAX_SYSCALL_INTERRUPT_PRIORITY)
 	);
 }
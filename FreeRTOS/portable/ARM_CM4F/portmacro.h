@@ -112,6 +112,99 @@ not necessary for to use this port.  They are defined so the common demo files
 #define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
 /*-----------------------------------------------------------*/
 
+/* Switch profiler support, used when configUSE_SWITCH_PROFILER is 1.  The
+PendSV handler stamps its own entry and exit with the DWT cycle counter, which
+the application must have started, and records the EXC_RETURN value it was
+entered with so the kernel can tell whether s16-s31 had to be saved. */
+extern volatile uint32_t ulPortPendSVStamps[ 3 ];
+#define portSWITCH_PROFILE_TIME()			( *( ( volatile uint32_t * ) 0xe0001004UL ) )
+#define portSWITCH_PROFILE_ENTRY_TIME()		( ulPortPendSVStamps[ 0 ] )
+#define portSWITCH_PROFILE_EXIT_TIME()		( ulPortPendSVStamps[ 1 ] )
+#define portSWITCH_PROFILE_SAVED_FPU()		( ( ulPortPendSVStamps[ 2 ] & 0x10UL ) == 0UL )
+/*-----------------------------------------------------------*/
+
+/* Mask profiler support, used when configUSE_MASK_PROFILER is 1.  The BASEPRI
+functions below call into port.c when they raise BASEPRI from zero and when
+they set it back to zero, and port.c keeps the longest interval between the two
+in portMASK_PROFILE_TIME() counts, together with the code addresses that raised
+and cleared the mask.  Sections that set PRIMASK, or BASEPRI from assembly, are
+not seen. */
+#if( configUSE_MASK_PROFILER == 1 )
+
+	typedef struct xPORT_MASK_PROFILE
+	{
+		uint32_t ulCount;			/* Outermost masked sections since the last reset. */
+		uint32_t ulMaxTime;			/* Longest of them. */
+		uint32_t ulMaxRaisedAt;		/* Return address into the code that raised the mask for the longest. */
+		uint32_t ulMaxClearedAt;	/* Return address into the code that cleared it. */
+	} PortMaskProfile_t;
+
+	#define portMASK_PROFILE_TIME()		( *( ( volatile uint32_t * ) 0xe0001004UL ) )
+
+	/* Return address of the calling function, without the Thumb bit. */
+	#define portMASK_PROFILE_CALLER()	( ( uint32_t ) __builtin_return_address( 0 ) & ~1UL )
+
+	extern void vPortMaskProfileRaised( void );
+	extern void vPortMaskProfileCleared( void );
+	extern void vPortGetMaskProfile( PortMaskProfile_t *pxProfile, BaseType_t xReset );
+
+#endif /* configUSE_MASK_PROFILER */
+/*-----------------------------------------------------------*/
+
+/* Code placed in .RamFunc is copied to SRAM by the startup code along with
+.data.  CCM is on the data bus only, so it cannot hold code.  Calls between
+flash and SRAM are out of BL range and go through linker veneers. */
+#define portRAM_FUNCTION	__attribute__( ( section( ".RamFunc" ) ) )
+/*-----------------------------------------------------------*/
+
+/* For symbols only referenced from inline assembly, which link time
+optimisation cannot see into and would otherwise drop. */
+#define portDONT_DISCARD	__attribute__( ( used ) )
+/*-----------------------------------------------------------*/
+
+/* Return address of the calling function, without the Thumb bit, recorded
+against each allocation when configHEAP_TRACK_OWNERS is 1. */
+#define portHEAP_CALLER()	( ( uint32_t ) __builtin_return_address( 0 ) & ~1UL )
+/*-----------------------------------------------------------*/
+
+/* Whether a task switched out by xPortPendSVHandler() had an FPU frame, for
+configUSE_TASK_FPU_POLICY.  The handler saves r4-r11 and then EXC_RETURN below
+the hardware frame, and bit 4 of EXC_RETURN is clear when that frame includes
+the FPU registers. */
+#define portTASK_USED_FPU( pxTopOfStack )	( ( ( ( pxTopOfStack )[ 8 ] & 0x10UL ) == 0UL ) ? pdTRUE : pdFALSE )
+/*-----------------------------------------------------------*/
+
+/* MPU region that keeps the lowest bytes of the running task's stack read
+only, for configUSE_MPU_STACK_GUARD.  xPortStartScheduler() sets up its size
+and attributes, and vTaskSwitchContext() moves it to each task switched in
+with a single write to RBAR, which selects the region through its REGION and
+VALID fields.  The base is rounded up to the region size, so the guard always
+lies inside the stack. */
+#define portSTACK_GUARD_REGION		7UL
+#define portSTACK_GUARD_BYTES		32UL
+#define portMPU_RBAR_REG			( * ( ( volatile uint32_t * ) 0xe000ed9c ) )
+#define portMPU_RBAR_VALID_BIT		( 1UL << 4UL )
+
+#define portSET_STACK_GUARD( pxStack )																		\
+	portMPU_RBAR_REG = ( ( ( uint32_t ) ( pxStack ) + ( portSTACK_GUARD_BYTES - 1UL ) ) & ~( portSTACK_GUARD_BYTES - 1UL ) ) |	\
+					   portMPU_RBAR_VALID_BIT | portSTACK_GUARD_REGION
+/*-----------------------------------------------------------*/
+
+/* Word copy and fill for the kernel and heap, in memops.c.  They replace
+newlib-nano's byte loops for queue items, stream buffer data, stack fills and
+reallocations. */
+#ifndef configUSE_PORT_MEMOPS
+	#define configUSE_PORT_MEMOPS	0
+#endif
+
+#if( configUSE_PORT_MEMOPS == 1 )
+	void *pvPortMemCpy( void *pvDest, const void *pvSrc, size_t xLength );
+	void *pvPortMemSet( void *pvDest, int iValue, size_t xLength );
+	#define portMEMCPY( pvDest, pvSrc, xLength )	pvPortMemCpy( ( pvDest ), ( pvSrc ), ( xLength ) )
+	#define portMEMSET( pvDest, iValue, xLength )	pvPortMemSet( ( pvDest ), ( iValue ), ( xLength ) )
+#endif
+/*-----------------------------------------------------------*/
+
 /* Tickless idle/low power functionality. */
 #ifndef portSUPPRESS_TICKS_AND_SLEEP
 	extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
@@ -136,17 +229,63 @@ not necessary for to use this port.  They are defined so the common demo files
 	}
 
 	/* Check the configuration. */
-	#if( configMAX_PRIORITIES > 32 )
-		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 32.  It is very rare that a system requires more than 10 to 15 difference priorities as tasks that share a priority will time slice.
+	#if( configMAX_PRIORITIES > 256 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 256.  It is very rare that a system requires more than 10 to 15 difference priorities as tasks that share a priority will time slice.
 	#endif
 
-	/* Store/clear the ready priorities in a bit map. */
-	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
-	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+	#if( configMAX_PRIORITIES <= 32 )
 
-	/*-----------------------------------------------------------*/
+		/* Store/clear the ready priorities in a bit map. */
+		#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+		#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
 
-	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( 31UL - ( uint32_t ) ucPortCountLeadingZeros( ( uxReadyPriorities ) ) )
+		/*-----------------------------------------------------------*/
+
+		#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( 31UL - ( uint32_t ) ucPortCountLeadingZeros( ( uxReadyPriorities ) ) )
+
+	#else
+
+		/* Beyond 32 priorities the ready priorities are kept in two levels: a
+		bit map per group of 32 priorities, and a bit map of the groups that
+		have any bit set.  Selection is still two CLZ instructions. */
+		#define portREADY_PRIORITY_GROUPS	( ( configMAX_PRIORITIES + 31 ) / 32 )
+
+		typedef struct xPORT_READY_PRIORITIES
+		{
+			uint32_t ulGroups;
+			uint32_t ulPriorities[ portREADY_PRIORITY_GROUPS ];
+		} PortReadyPriorities_t;
+
+		/* tasks.c declares its ready priorities with this type, zero
+		initialised, in place of a UBaseType_t. */
+		#define portREADY_PRIORITIES_TYPE	PortReadyPriorities_t
+
+		/* Store/clear the ready priorities in the bit maps. */
+		#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities )											\
+		{																											\
+			( uxReadyPriorities ).ulPriorities[ ( uxPriority ) >> 5 ] |= ( 1UL << ( ( uxPriority ) & 31UL ) );	\
+			( uxReadyPriorities ).ulGroups |= ( 1UL << ( ( uxPriority ) >> 5 ) );									\
+		}
+
+		#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities )											\
+		{																											\
+			( uxReadyPriorities ).ulPriorities[ ( uxPriority ) >> 5 ] &= ~( 1UL << ( ( uxPriority ) & 31UL ) );	\
+			if( ( uxReadyPriorities ).ulPriorities[ ( uxPriority ) >> 5 ] == 0UL )									\
+			{																										\
+				( uxReadyPriorities ).ulGroups &= ~( 1UL << ( ( uxPriority ) >> 5 ) );								\
+			}																										\
+		}
+
+		/*-----------------------------------------------------------*/
+
+		#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities )										\
+		{																											\
+		uint32_t ulGroup = 31UL - ( uint32_t ) ucPortCountLeadingZeros( ( uxReadyPriorities ).ulGroups );			\
+																													\
+			uxTopPriority = ( ulGroup << 5 ) + ( 31UL - ( uint32_t ) ucPortCountLeadingZeros( ( uxReadyPriorities ).ulPriorities[ ulGroup ] ) );	\
+		}
+
+	#endif /* configMAX_PRIORITIES */
 
 #endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
 
@@ -191,6 +330,11 @@ BaseType_t xReturn;
 portFORCE_INLINE static void vPortRaiseBASEPRI( void )
 {
 uint32_t ulNewBASEPRI;
+#if( configUSE_MASK_PROFILER == 1 )
+uint32_t ulOriginalBASEPRI;
+
+	__asm volatile( "mrs %0, basepri" : "=r" ( ulOriginalBASEPRI ) :: "memory" );
+#endif
 
 	__asm volatile
 	(
@@ -200,6 +344,15 @@ uint32_t ulNewBASEPRI;
 		"	dsb														\n" \
 		:"=r" (ulNewBASEPRI) : "i" ( configMAX_SYSCALL_INTERRUPT_PRIORITY ) : "memory"
 	);
+
+	#if( configUSE_MASK_PROFILER == 1 )
+	{
+		if( ulOriginalBASEPRI == 0 )
+		{
+			vPortMaskProfileRaised();
+		}
+	}
+	#endif
 }
 
 /*-----------------------------------------------------------*/
@@ -218,6 +371,15 @@ uint32_t ulOriginalBASEPRI, ulNewBASEPRI;
 		:"=r" (ulOriginalBASEPRI), "=r" (ulNewBASEPRI) : "i" ( configMAX_SYSCALL_INTERRUPT_PRIORITY ) : "memory"
 	);
 
+	#if( configUSE_MASK_PROFILER == 1 )
+	{
+		if( ulOriginalBASEPRI == 0 )
+		{
+			vPortMaskProfileRaised();
+		}
+	}
+	#endif
+
 	/* This return will not be reached but is necessary to prevent compiler
 	warnings. */
 	return ulOriginalBASEPRI;
@@ -226,6 +388,15 @@ uint32_t ulOriginalBASEPRI, ulNewBASEPRI;
 
 portFORCE_INLINE static void vPortSetBASEPRI( uint32_t ulNewMaskValue )
 {
+	#if( configUSE_MASK_PROFILER == 1 )
+	{
+		if( ulNewMaskValue == 0 )
+		{
+			vPortMaskProfileCleared();
+		}
+	}
+	#endif
+
 	__asm volatile
 	(
 		"	msr basepri, %0	" :: "r" ( ulNewMaskValue ) : "memory"
@@ -0,0 +1,465 @@
+/*
+ * FreeRTOS Kernel V10.2.1
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Port specific definitions.
+ *
+ * The settings in this file configure FreeRTOS correctly for the
+ * given hardware and compiler.
+ *
+ * These settings should not be altered.
+ *-----------------------------------------------------------
+ */
+
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	uint32_t
+#define portBASE_TYPE	long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef uint16_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffff
+#else
+	typedef uint32_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+
+	/* 32-bit tick type on a 32-bit architecture, so reads of the tick count do
+	not need to be guarded with a critical section. */
+	#define portTICK_TYPE_IS_ATOMIC 1
+#endif
+/*-----------------------------------------------------------*/
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_PERIOD_MS			( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+/*-----------------------------------------------------------*/
+
+/* MPU specific constants.  Regions 0 to 3 are set up once by the port and are
+the same for every task; regions 4 to 7 are the task's own, its stack and up to
+three regions given to xTaskCreateRestricted() or vTaskAllocateMPURegions(),
+and are reloaded on each switch.  A higher region number takes precedence
+where regions overlap. */
+#define portUSING_MPU_WRAPPERS		1
+#define portPRIVILEGE_BIT			( 0x80000000UL )
+
+#define portMPU_REGION_READ_WRITE				( 0x03UL << 24UL )
+#define portMPU_REGION_PRIVILEGED_READ_ONLY		( 0x05UL << 24UL )
+#define portMPU_REGION_READ_ONLY				( 0x06UL << 24UL )
+#define portMPU_REGION_PRIVILEGED_READ_WRITE	( 0x01UL << 24UL )
+#define portMPU_REGION_CACHEABLE_BUFFERABLE		( 0x07UL << 16UL )
+#define portMPU_REGION_EXECUTE_NEVER			( 0x01UL << 28UL )
+
+#define portUNPRIVILEGED_FLASH_REGION		( 0UL )
+#define portUNPRIVILEGED_SRAM_REGION		( 1UL )
+#define portPRIVILEGED_SRAM_REGION			( 2UL )
+#define portSPARE_REGION					( 3UL )
+#define portSTACK_REGION					( 4UL )
+#define portFIRST_CONFIGURABLE_REGION		( 5UL )
+#define portLAST_CONFIGURABLE_REGION		( 7UL )
+#define portNUM_CONFIGURABLE_REGIONS		( ( portLAST_CONFIGURABLE_REGION - portFIRST_CONFIGURABLE_REGION ) + 1 )
+#define portTOTAL_NUM_REGIONS				( portNUM_CONFIGURABLE_REGIONS + 1 ) /* Plus one to make space for the stack region. */
+
+/* The smallest MPU region, a power of two of at least 32 bytes, that holds x
+bytes, for aligning buffers that are to be covered by a single region. */
+#define portMPU_REGION_SIZE_FOR( x )	( ( ( x ) <= 32UL ) ? 32UL : ( ( x ) <= 64UL ) ? 64UL : ( ( x ) <= 128UL ) ? 128UL :		\
+										( ( x ) <= 256UL ) ? 256UL : ( ( x ) <= 512UL ) ? 512UL : ( ( x ) <= 1024UL ) ? 1024UL :	\
+										( ( x ) <= 2048UL ) ? 2048UL : ( ( x ) <= 4096UL ) ? 4096UL : ( ( x ) <= 8192UL ) ? 8192UL :	\
+										( ( x ) <= 16384UL ) ? 16384UL : ( ( x ) <= 32768UL ) ? 32768UL : ( ( x ) <= 65536UL ) ? 65536UL : 131072UL )
+
+typedef struct MPU_REGION_REGISTERS
+{
+	uint32_t ulRegionBaseAddress;	/* RBAR, with the VALID bit and the region number. */
+	uint32_t ulRegionAttribute;		/* RASR. */
+} xMPU_REGION_REGISTERS;
+
+/* Laid out as the RBAR/RASR pair and its three aliases, so that the context
+switch reloads all four task regions with one LDM and one STM. */
+typedef struct MPU_SETTINGS
+{
+	xMPU_REGION_REGISTERS xRegion[ portTOTAL_NUM_REGIONS ];
+} xMPU_SETTINGS;
+
+/* The kernel's data is kept in the CCM, which no region grants to
+unprivileged code, rather than in a privileged_data section of its own.  Kernel
+code is left in flash and .RamFunc with everything else: an unprivileged caller
+gets no further than the first kernel variable it touches. */
+#define portPRIVILEGED_DATA			__attribute__( ( section( ".ccmram" ) ) )
+#define portPRIVILEGED_FUNCTION
+#define portFREERTOS_SYSTEM_CALL
+
+/* Keep restricted tasks out of the SRAM block pvBase, the heap's SRAM region
+for example, with portPRIVILEGED_SRAM_REGION.  pvBase must be aligned to
+portMPU_REGION_SIZE_FOR( ulSizeInBytes ). */
+void vPortSetPrivilegedSRAMRegion( void *pvBase, uint32_t ulSizeInBytes );
+
+/* Cycles spent reloading the incoming task's regions by the last context
+switch that changed task, 0 once read, for the switch profiler.  See
+configMPU_REGION_SWITCH_BUDGET. */
+#define portSWITCH_PROFILE_REGION_TIME()	( ulPortPendSVStamps[ 3 ] )
+#define portSWITCH_PROFILE_REGION_CLEAR()	( ulPortPendSVStamps[ 3 ] = 0UL )
+/*-----------------------------------------------------------*/
+
+/* SVC numbers for various services. */
+#define portSVC_START_SCHEDULER				0
+#define portSVC_YIELD						1
+#define portSVC_RAISE_PRIVILEGE				2
+
+/* Scheduler utilities.  A task may be unprivileged, and cannot then write the
+ICSR, so it yields through the SVC.  The kernel always runs privileged. */
+#define portYIELD()				__asm volatile ( "	SVC	%0	\n" :: "i" ( portSVC_YIELD ) : "memory" )
+#define portYIELD_WITHIN_API() 													\
+{																				\
+	/* Set a PendSV to request a context switch. */								\
+	portNVIC_INT_CTRL_REG = portNVIC_PENDSVSET_BIT;								\
+																				\
+	/* Barriers are normally not required but do ensure the code is completely	\
+	within the specified behaviour for the architecture. */						\
+	__asm volatile( "dsb" ::: "memory" );										\
+	__asm volatile( "isb" );													\
+}
+
+#define portNVIC_INT_CTRL_REG		( * ( ( volatile uint32_t * ) 0xe000ed04 ) )
+#define portNVIC_PENDSVSET_BIT		( 1UL << 28UL )
+#define portEND_SWITCHING_ISR( xSwitchRequired ) if( xSwitchRequired != pdFALSE ) portYIELD_WITHIN_API()
+#define portYIELD_FROM_ISR( x ) portEND_SWITCHING_ISR( x )
+/*-----------------------------------------------------------*/
+
+/* Critical section management. */
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+#define portSET_INTERRUPT_MASK_FROM_ISR()		ulPortRaiseBASEPRI()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	vPortSetBASEPRI(x)
+#define portDISABLE_INTERRUPTS()				vPortRaiseBASEPRI()
+#define portENABLE_INTERRUPTS()					vPortSetBASEPRI(0)
+#define portENTER_CRITICAL()					vPortEnterCritical()
+#define portEXIT_CRITICAL()						vPortExitCritical()
+
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site.  These are
+not necessary for to use this port.  They are defined so the common demo files
+(which build with all the ports) will build. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+/*-----------------------------------------------------------*/
+
+/* Switch profiler support, used when configUSE_SWITCH_PROFILER is 1.  The
+PendSV handler stamps its own entry and exit with the DWT cycle counter, which
+the application must have started, and records the EXC_RETURN value it was
+entered with so the kernel can tell whether s16-s31 had to be saved.  The
+fourth word is the region reload time, see portSWITCH_PROFILE_REGION_TIME(). */
+extern volatile uint32_t ulPortPendSVStamps[ 4 ];
+#define portSWITCH_PROFILE_TIME()			( *( ( volatile uint32_t * ) 0xe0001004UL ) )
+#define portSWITCH_PROFILE_ENTRY_TIME()		( ulPortPendSVStamps[ 0 ] )
+#define portSWITCH_PROFILE_EXIT_TIME()		( ulPortPendSVStamps[ 1 ] )
+#define portSWITCH_PROFILE_SAVED_FPU()		( ( ulPortPendSVStamps[ 2 ] & 0x10UL ) == 0UL )
+/*-----------------------------------------------------------*/
+
+/* Mask profiler support, used when configUSE_MASK_PROFILER is 1.  The BASEPRI
+functions below call into port.c when they raise BASEPRI from zero and when
+they set it back to zero, and port.c keeps the longest interval between the two
+in portMASK_PROFILE_TIME() counts, together with the code addresses that raised
+and cleared the mask.  Sections that set PRIMASK, or BASEPRI from assembly, are
+not seen. */
+#if( configUSE_MASK_PROFILER == 1 )
+
+	typedef struct xPORT_MASK_PROFILE
+	{
+		uint32_t ulCount;			/* Outermost masked sections since the last reset. */
+		uint32_t ulMaxTime;			/* Longest of them. */
+		uint32_t ulMaxRaisedAt;		/* Return address into the code that raised the mask for the longest. */
+		uint32_t ulMaxClearedAt;	/* Return address into the code that cleared it. */
+	} PortMaskProfile_t;
+
+	#define portMASK_PROFILE_TIME()		( *( ( volatile uint32_t * ) 0xe0001004UL ) )
+
+	/* Return address of the calling function, without the Thumb bit. */
+	#define portMASK_PROFILE_CALLER()	( ( uint32_t ) __builtin_return_address( 0 ) & ~1UL )
+
+	extern void vPortMaskProfileRaised( void );
+	extern void vPortMaskProfileCleared( void );
+	extern void vPortGetMaskProfile( PortMaskProfile_t *pxProfile, BaseType_t xReset );
+
+#endif /* configUSE_MASK_PROFILER */
+/*-----------------------------------------------------------*/
+
+/* Code placed in .RamFunc is copied to SRAM by the startup code along with
+.data.  CCM is on the data bus only, so it cannot hold code.  Calls between
+flash and SRAM are out of BL range and go through linker veneers. */
+#define portRAM_FUNCTION	__attribute__( ( section( ".RamFunc" ) ) )
+/*-----------------------------------------------------------*/
+
+/* For symbols only referenced from inline assembly, which link time
+optimisation cannot see into and would otherwise drop. */
+#define portDONT_DISCARD	__attribute__( ( used ) )
+/*-----------------------------------------------------------*/
+
+/* Return address of the calling function, without the Thumb bit, recorded
+against each allocation when configHEAP_TRACK_OWNERS is 1. */
+#define portHEAP_CALLER()	( ( uint32_t ) __builtin_return_address( 0 ) & ~1UL )
+/*-----------------------------------------------------------*/
+
+/* Whether a task switched out by xPortPendSVHandler() had an FPU frame, for
+configUSE_TASK_FPU_POLICY.  The handler saves CONTROL, r4-r11 and then
+EXC_RETURN below the hardware frame, and bit 4 of EXC_RETURN is clear when that
+frame includes the FPU registers. */
+#define portTASK_USED_FPU( pxTopOfStack )	( ( ( ( pxTopOfStack )[ 9 ] & 0x10UL ) == 0UL ) ? pdTRUE : pdFALSE )
+/*-----------------------------------------------------------*/
+
+/* Privilege management, for the MPU_ wrappers in portable/Common.
+xPortRaisePrivilege() returns whether the caller was already privileged, to be
+passed back to vPortResetPrivilege() once the kernel call is done. */
+extern BaseType_t xPortRaisePrivilege( void );
+extern void vPortResetPrivilege( BaseType_t xRunningPrivileged );
+
+#define portSWITCH_TO_USER_MODE() __asm volatile ( " mrs r0, control \n orr r0, #1 \n msr control, r0 " ::: "r0", "memory" )
+/*-----------------------------------------------------------*/
+
+/* Tickless idle/low power functionality. */
+#ifndef portSUPPRESS_TICKS_AND_SLEEP
+	extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+/*-----------------------------------------------------------*/
+
+/* Architecture specific optimisations. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#endif
+
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* Generic helper function. */
+	__attribute__( ( always_inline ) ) static inline uint8_t ucPortCountLeadingZeros( uint32_t ulBitmap )
+	{
+	uint8_t ucReturn;
+
+		__asm volatile ( "clz %0, %1" : "=r" ( ucReturn ) : "r" ( ulBitmap ) : "memory" );
+		return ucReturn;
+	}
+
+	/* Check the configuration. */
+	#if( configMAX_PRIORITIES > 256 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 256.  It is very rare that a system requires more than 10 to 15 difference priorities as tasks that share a priority will time slice.
+	#endif
+
+	#if( configMAX_PRIORITIES <= 32 )
+
+		/* Store/clear the ready priorities in a bit map. */
+		#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+		#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+
+		/*-----------------------------------------------------------*/
+
+		#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( 31UL - ( uint32_t ) ucPortCountLeadingZeros( ( uxReadyPriorities ) ) )
+
+	#else
+
+		/* Beyond 32 priorities the ready priorities are kept in two levels: a
+		bit map per group of 32 priorities, and a bit map of the groups that
+		have any bit set.  Selection is still two CLZ instructions. */
+		#define portREADY_PRIORITY_GROUPS	( ( configMAX_PRIORITIES + 31 ) / 32 )
+
+		typedef struct xPORT_READY_PRIORITIES
+		{
+			uint32_t ulGroups;
+			uint32_t ulPriorities[ portREADY_PRIORITY_GROUPS ];
+		} PortReadyPriorities_t;
+
+		/* tasks.c declares its ready priorities with this type, zero
+		initialised, in place of a UBaseType_t. */
+		#define portREADY_PRIORITIES_TYPE	PortReadyPriorities_t
+
+		/* Store/clear the ready priorities in the bit maps. */
+		#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities )											\
+		{																											\
+			( uxReadyPriorities ).ulPriorities[ ( uxPriority ) >> 5 ] |= ( 1UL << ( ( uxPriority ) & 31UL ) );	\
+			( uxReadyPriorities ).ulGroups |= ( 1UL << ( ( uxPriority ) >> 5 ) );									\
+		}
+
+		#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities )											\
+		{																											\
+			( uxReadyPriorities ).ulPriorities[ ( uxPriority ) >> 5 ] &= ~( 1UL << ( ( uxPriority ) & 31UL ) );	\
+			if( ( uxReadyPriorities ).ulPriorities[ ( uxPriority ) >> 5 ] == 0UL )									\
+			{																										\
+				( uxReadyPriorities ).ulGroups &= ~( 1UL << ( ( uxPriority ) >> 5 ) );								\
+			}																										\
+		}
+
+		/*-----------------------------------------------------------*/
+
+		#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities )										\
+		{																											\
+		uint32_t ulGroup = 31UL - ( uint32_t ) ucPortCountLeadingZeros( ( uxReadyPriorities ).ulGroups );			\
+																													\
+			uxTopPriority = ( ulGroup << 5 ) + ( 31UL - ( uint32_t ) ucPortCountLeadingZeros( ( uxReadyPriorities ).ulPriorities[ ulGroup ] ) );	\
+		}
+
+	#endif /* configMAX_PRIORITIES */
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+
+/*-----------------------------------------------------------*/
+
+#ifdef configASSERT
+	void vPortValidateInterruptPriority( void );
+	#define portASSERT_IF_INTERRUPT_PRIORITY_INVALID() 	vPortValidateInterruptPriority()
+#endif
+
+/* portNOP() is not required by this port. */
+#define portNOP()
+
+#define portINLINE	__inline
+
+#ifndef portFORCE_INLINE
+	#define portFORCE_INLINE inline __attribute__(( always_inline))
+#endif
+
+portFORCE_INLINE static BaseType_t xPortIsInsideInterrupt( void )
+{
+uint32_t ulCurrentInterrupt;
+BaseType_t xReturn;
+
+	/* Obtain the number of the currently executing interrupt. */
+	__asm volatile( "mrs %0, ipsr" : "=r"( ulCurrentInterrupt ) :: "memory" );
+
+	if( ulCurrentInterrupt == 0 )
+	{
+		xReturn = pdFALSE;
+	}
+	else
+	{
+		xReturn = pdTRUE;
+	}
+
+	return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+portFORCE_INLINE static void vPortRaiseBASEPRI( void )
+{
+uint32_t ulNewBASEPRI;
+#if( configUSE_MASK_PROFILER == 1 )
+uint32_t ulOriginalBASEPRI;
+
+	__asm volatile( "mrs %0, basepri" : "=r" ( ulOriginalBASEPRI ) :: "memory" );
+#endif
+
+	__asm volatile
+	(
+		"	mov %0, %1												\n"	\
+		"	msr basepri, %0											\n" \
+		"	isb														\n" \
+		"	dsb														\n" \
+		:"=r" (ulNewBASEPRI) : "i" ( configMAX_SYSCALL_INTERRUPT_PRIORITY ) : "memory"
+	);
+
+	#if( configUSE_MASK_PROFILER == 1 )
+	{
+		if( ulOriginalBASEPRI == 0 )
+		{
+			vPortMaskProfileRaised();
+		}
+	}
+	#endif
+}
+
+/*-----------------------------------------------------------*/
+
+portFORCE_INLINE static uint32_t ulPortRaiseBASEPRI( void )
+{
+uint32_t ulOriginalBASEPRI, ulNewBASEPRI;
+
+	__asm volatile
+	(
+		"	mrs %0, basepri											\n" \
+		"	mov %1, %2												\n"	\
+		"	msr basepri, %1											\n" \
+		"	isb														\n" \
+		"	dsb														\n" \
+		:"=r" (ulOriginalBASEPRI), "=r" (ulNewBASEPRI) : "i" ( configMAX_SYSCALL_INTERRUPT_PRIORITY ) : "memory"
+	);
+
+	#if( configUSE_MASK_PROFILER == 1 )
+	{
+		if( ulOriginalBASEPRI == 0 )
+		{
+			vPortMaskProfileRaised();
+		}
+	}
+	#endif
+
+	/* This return will not be reached but is necessary to prevent compiler
+	warnings. */
+	return ulOriginalBASEPRI;
+}
+/*-----------------------------------------------------------*/
+
+portFORCE_INLINE static void vPortSetBASEPRI( uint32_t ulNewMaskValue )
+{
+	#if( configUSE_MASK_PROFILER == 1 )
+	{
+		if( ulNewMaskValue == 0 )
+		{
+			vPortMaskProfileCleared();
+		}
+	}
+	#endif
+
+	__asm volatile
+	(
+		"	msr basepri, %0	" :: "r" ( ulNewMaskValue ) : "memory"
+	);
+}
+/*-----------------------------------------------------------*/
+
+#define portMEMORY_BARRIER() __asm volatile( "" ::: "memory" )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
+
@@ -33,8 +33,41 @@
  *
  * See heap_1.c, heap_3.c and heap_4.c for alternative implementations, and the
  * memory management pages of http://www.FreeRTOS.org for more information.
+ *
+ * With configHEAP_GUARD set to 1 every block header also holds a check word
+ * over its address, size and the size requested for it, zero while it is
+ * free, and every allocated block has a canary straight after the bytes
+ * requested.  Blocks tile the heap, so xPortHeapGuardStep() can walk it in
+ * address order a few headers at a time from the idle task, rather than
+ * stopping everything for a full scan.  vPortFree() and pvPortRealloc()
+ * check the block they are given, and the free list is checked as it is
+ * walked for a snapshot.
+ *
+ * With configHEAP_LAZY_COALESCE set to 1 vPortFree() only pushes the block
+ * onto a list of blocks waiting to be merged, which takes constant time.
+ * The idle task calls xPortHeapCoalesceStep(), which moves them to the free
+ * list heapFREE_BATCH_MAX at a time, merging and sorting them as
+ * vPortFreeBatch() does.  An allocation that finds nothing large enough
+ * merges every waiting block before it gives up.
+ *
+ * The fit policy and merging are chosen at run time with
+ * xPortHeapSetFitPolicy(), starting from configHEAP_FIT_POLICY and
+ * if_merge_mem.  The policy sets the order of the free list:
+ *
+ *   eHeapFitBest     by size, so the first block that fits is the smallest
+ *   eHeapFitFirst    most recently freed first, so freeing takes constant
+ *                    time when nothing is merged
+ *   eHeapFitNext     by address, searched from where the previous
+ *                    allocation was taken, wrapping at the end
+ *   eHeapFitAddress  by address, searched from the bottom, which keeps the
+ *                    top of the heap free longest
+ *
+ * Changing either setting puts every free block back on the list in the new
+ * order, merging them if merging is now on, so it can be done at any time.
+ * Counts, DWT latencies and the number of free blocks each search looked at
+ * are kept for each policy apart, for vPortGetHeapPolicyStats(), so one run
+ * of the same trace under each policy compares them directly.
  */
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -49,6 +82,10 @@ task.h is included from an application file. */
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+#if( configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_2 )
+
+#include "heap_stats.h"
+
 #if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
 	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
@@ -77,6 +114,10 @@ typedef struct A_BLOCK_LINK
 {
 	struct A_BLOCK_LINK *pxNextFreeBlock;	/*<< The next free block in the list. */
 	size_t xBlockSize;						/*<< The size of the free block. */
+	#if( configHEAP_GUARD == 1 )
+		uint32_t ulRequested;				/*<< Bytes asked for, 0 while free. */
+		uint32_t ulCheck;					/*<< prvGuardCheckWord() of the block. */
+	#endif
 } BlockLink_t;
 
 
@@ -86,16 +127,169 @@ static const uint16_t heapSTRUCT_SIZE	= ( ( sizeof ( BlockLink_t ) + ( portBYTE_
 /* Create a couple of list links to mark the start and end of the list. */
 static BlockLink_t xStart, xEnd;
 
+/* Set by xPortHeapSetFitPolicy(). */
+static HeapFitPolicy_t eFitPolicy = configHEAP_FIT_POLICY;
+static BaseType_t xMergeFree = ( if_merge_mem == 1 ) ? pdTRUE : pdFALSE;
+
+/* The free block after which eHeapFitNext starts its search, &xStart for the
+bottom of the heap.  Whatever unlinks it from the list moves it back to its
+predecessor. */
+static BlockLink_t *pxRover = &xStart;
+
+static BaseType_t xHeapHasBeenInitialised = pdFALSE;
+
+#if( configHEAP_GUARD == 1 )
+
+	/* Check words and canaries mix these in with the block address, so
+	that neither is likely to turn up as data.  The canary is not aligned,
+	so it is copied a byte at a time. */
+	#define heapGUARD_SEED			( ( uint32_t ) 0x5a3cc3a5UL )
+	#define heapGUARD_CANARY		( ( uint32_t ) 0xc0fee15aUL )
+	#define heapGUARD_TAIL_SIZE		sizeof( uint32_t )
+
+	/* The tiled range, set by prvHeapInit(). */
+	static uint8_t *pucHeapStart = NULL;
+	static uint8_t *pucHeapEnd = NULL;
+
+	/* Moved on by every change to the tiling, so that a walk interrupted by
+	one starts again rather than following a header that is no longer one. */
+	static uint32_t ulHeapGeneration = 0;
+
+	/*
+	 * The check word of a header at pxBlock, from its size and requested
+	 * size, and the canary of an allocated block there.
+	 */
+	static uint32_t prvGuardCheckWord( const BlockLink_t *pxBlock ) portHEAP_HOT_PATH;
+	static uint32_t prvGuardCanary( const BlockLink_t *pxBlock ) portHEAP_HOT_PATH;
+
+	/*
+	 * Record xRequested in the header of pxBlock, 0 for a free block, and
+	 * give it its check word, and an allocated block its canary.
+	 */
+	static void prvGuardSeal( BlockLink_t *pxBlock, size_t xRequested ) portHEAP_HOT_PATH;
+
+	/*
+	 * Whether pxBlock is a sound header in the heap, in the given state, or
+	 * in either when xAllocated is -1.  A failed check is reported to
+	 * vApplicationHeapCorruptedHook().
+	 */
+	static BaseType_t prvGuardCheck( const BlockLink_t *pxBlock, BaseType_t xAllocated ) portHEAP_HOT_PATH;
+
+	#define prvGuardSealFree( pxBlock )						prvGuardSeal( ( pxBlock ), 0 )
+	#define prvGuardSealAllocated( pxBlock, xRequested )	prvGuardSeal( ( pxBlock ), ( xRequested ) )
+	#define prvGuardFreeIntact( pxBlock )					prvGuardCheck( ( pxBlock ), pdFALSE )
+	#define prvGuardAllocatedIntact( pxBlock )				prvGuardCheck( ( pxBlock ), pdTRUE )
+
+#else
+
+	#define heapGUARD_TAIL_SIZE								0
+	#define prvGuardSealFree( pxBlock )
+	#define prvGuardSealAllocated( pxBlock, xRequested )	( void ) ( xRequested )
+	#define prvGuardFreeIntact( pxBlock )					( pdTRUE )
+	#define prvGuardAllocatedIntact( pxBlock )				( pdTRUE )
+
+#endif /* configHEAP_GUARD */
+
 /* Keeps track of the number of free bytes remaining, but says nothing about
 fragmentation. */
 static size_t xFreeBytesRemaining = configADJUSTED_HEAP_SIZE;
+static size_t xMinimumEverFreeBytesRemaining = configADJUSTED_HEAP_SIZE;
+
+/* Allocation counts and latencies reported by vPortGetHeapStats(). */
+static HeapCounters_t xHeapCounters = { 0 };
+static HeapJournal_t xHeapJournal = { 0 };
+
+/* The same again for each fit policy, while it was the one in use, with the
+figures vPortGetHeapPolicyStats() adds. */
+typedef struct xHEAP_POLICY_COUNTERS
+{
+	HeapCounters_t xCounters;
+	size_t xFragmentedFailures;
+	uint64_t ullBlocksSearched;
+	uint32_t ulMaxBlocksSearched;
+} HeapPolicyCounters_t;
+
+static HeapPolicyCounters_t xPolicyCounters[ heapFIT_POLICIES ];
+
+/* Most blocks vPortFreeBatch() merges with the free list in one walk.  Longer
+batches are taken this many at a time.  The working arrays live on the stack
+of the caller, which is normally the idle task. */
+#ifndef heapFREE_BATCH_MAX
+	#define heapFREE_BATCH_MAX	8
+#endif
+
+#if( configHEAP_LAZY_COALESCE == 1 )
+
+	/* Without merging, allocations made while freed blocks wait would split
+	the large blocks rather than reuse the small ones, and nothing would ever
+	join the pieces again. */
+	#if( if_merge_mem != 1 )
+		#error configHEAP_LAZY_COALESCE needs if_merge_mem to be 1
+	#endif
+
+	/* Blocks freed but not yet on the free list, most recent first, linked
+	through pxNextFreeBlock.  Their bytes already count as free. */
+	static BlockLink_t *pxPendingBlocks = NULL;
+
+	/*
+	 * Move the next heapFREE_BATCH_MAX waiting blocks to the free list, or
+	 * all of them if xAll is pdTRUE.
+	 */
+	static void prvCoalescePending( BaseType_t xAll );
+
+#endif /* configHEAP_LAZY_COALESCE */
+
+/*
+ * Sort the batch of blocks being freed into address order.
+ */
+static void prvSortBlocksByAddress( BlockLink_t *pxBlocks[], size_t xCount );
+
+/*
+ * Return an address sorted batch of blocks to the free list.  One walk of the
+ * list unlinks every free neighbour of the batch, the batch and those
+ * neighbours are then joined into runs of contiguous memory, and the runs are
+ * inserted by size in a second walk.  pxBlocks[] is reused to hold the runs.
+ */
+static void prvInsertBatchIntoFreeList( BlockLink_t *pxBlocks[], size_t xCount );
+
+/*
+ * The size of block, header included, that holds xWantedSize bytes, or 0 if
+ * the heap could never hold that many.
+ */
+static size_t prvRequiredBlockSize( size_t xWantedSize ) portHEAP_HOT_PATH;
+
+/*
+ * Cut the allocated block pxBlock down to xBlockSize bytes and return the
+ * rest to the free list, if the rest is large enough to be a block.
+ */
+static void prvTrimBlock( BlockLink_t *pxBlock, size_t xBlockSize ) portHEAP_HOT_PATH;
+
+/*
+ * The free block a request of xWantedSize bytes, header included, is taken
+ * from under the current policy, or &xEnd if none is large enough.  Its
+ * predecessor on the list is returned through ppxPreviousBlock, and the
+ * number of blocks looked at is added to *pulSearched.
+ */
+static BlockLink_t *prvFindFreeBlock( size_t xWantedSize, BlockLink_t **ppxPreviousBlock, uint32_t *pulSearched ) portHEAP_HOT_PATH;
+
+/*
+ * The free block after which pxBlock goes under the current policy, searching
+ * on from pxIterator, which must not be past that point.
+ */
+static BlockLink_t *prvFindInsertPoint( BlockLink_t *pxIterator, const BlockLink_t *pxBlock ) portHEAP_HOT_PATH;
+
+/*
+ * Take every free block off the list and put it back under the current
+ * policy and merge setting.
+ */
+static void prvRebuildFreeList( void );
 
 /* STATIC FUNCTIONS ARE DEFINED AS MACROS TO MINIMIZE THE FUNCTION CALL DEPTH. */
 
 /*
  * Insert a block into the list of free blocks - which is ordered by size of
- * the block.  Small blocks at the start of the list and large blocks at the end
- * of the list.
+ * the block, address or age, as the fit policy requires - see
+ * prvFindInsertPoint().
  */
 
 // Inserts a memory block into the free list, optionally merging with adjacent free blocks
@@ -103,12 +297,11 @@ void prvInsertBlockIntoFreeList(BlockLink_t *pxBlockToInsert)
 {
     BlockLink_t *pxIterator;
     BlockLink_t *pxBlockPtr = pxBlockToInsert;
-    size_t xBlockSize = pxBlockPtr->xBlockSize;
 
     // If memory merging is enabled, attempt to coalesce adjacent free blocks
-    if (if_merge_mem == 1) {
+    if (xMergeFree != pdFALSE) {
         size_t xStartAddress = (size_t) pxBlockPtr;
-        size_t xEndAddress = xStartAddress + xBlockSize;
+        size_t xEndAddress = xStartAddress + pxBlockPtr->xBlockSize;
 
         BlockLink_t *pxPrevBlock = &xStart;
         BlockLink_t *pxCurBlock = xStart.pxNextFreeBlock;
@@ -126,10 +319,13 @@ void prvInsertBlockIntoFreeList(BlockLink_t *pxBlockToInsert)
                 continue;
             }
 
+            prvHeapJournalRecord(&xHeapJournal, eHeapChangeMerge, pxCurBlock, xCurBlockSize);
+
             // Merge if the block to insert is immediately after the current block
             if (xStartAddress == xCurBlockEndAddr) {
+                // Use the current size, the block may already have absorbed its follower
+                pxCurBlock->xBlockSize += pxBlockPtr->xBlockSize;
                 pxBlockPtr = pxCurBlock; // Update pointer to merged block
-                pxBlockPtr->xBlockSize += xBlockSize;
             }
             // Merge if the block to insert is immediately before the current block
             else if (xEndAddress == xCurBlockStartAddr) {
@@ -137,39 +333,36 @@ void prvInsertBlockIntoFreeList(BlockLink_t *pxBlockToInsert)
             }
 
             // Remove the merged block from the free list
+            if (pxCurBlock == pxRover) {
+                pxRover = pxPrevBlock;
+            }
             pxPrevBlock->pxNextFreeBlock = pxCurBlock->pxNextFreeBlock;
             pxCurBlock = pxCurBlock->pxNextFreeBlock;
         }
-
-        // Update the block size to reflect any merging
-        xBlockSize = pxBlockPtr->xBlockSize;
     }
 
-    // Insert the block into the free list in sorted order by size
-    for (pxIterator = &xStart;
-         pxIterator->pxNextFreeBlock->xBlockSize < xBlockSize;
-         pxIterator = pxIterator->pxNextFreeBlock)
-    {
-        // Traverse to find the correct position
-    }
+    // Insert the block into the free list in the order the fit policy keeps
+    pxIterator = prvFindInsertPoint(&xStart, pxBlockPtr);
 
     // Link the block into the list
     pxBlockPtr->pxNextFreeBlock = pxIterator->pxNextFreeBlock;
     pxIterator->pxNextFreeBlock = pxBlockPtr;
+    prvGuardSealFree(pxBlockPtr);
+    prvHeapJournalRecord(&xHeapJournal, eHeapChangeInsert, pxBlockPtr, pxBlockPtr->xBlockSize);
 }
 
 /*-----------------------------------------------------------*/
 
-void *pvPortMalloc( size_t xWantedSize )
+portHEAP_HOT_PATH void *pvPortMalloc( size_t xWantedSize )
 {
 BlockLink_t *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
-static BaseType_t xHeapHasBeenInitialised = pdFALSE;
 void *pvReturn = NULL;
-size_t BlockSize, WantedSize;
-char data[80];
-WantedSize = xWantedSize;
+uint32_t ulStartCycles, ulSearched = 0;
+const size_t xRequestedSize = xWantedSize;
+HeapPolicyCounters_t *pxPolicy;
+UBaseType_t uxHeapLockState;
 
-	vTaskSuspendAll();
+	uxHeapLockState = prvHeapLock();
 	{
 		/* If this is the first call to malloc then the heap will require
 		initialisation to setup the list of free blocks. */
@@ -179,11 +372,13 @@ WantedSize = xWantedSize;
 			xHeapHasBeenInitialised = pdTRUE;
 		}
 
+		ulStartCycles = heapSTATS_TIMESTAMP();
+
 		/* The wanted size is increased so it can contain a BlockLink_t
 		structure in addition to the requested amount of bytes. */
 		if( xWantedSize > 0 )
 		{
-			xWantedSize += heapSTRUCT_SIZE;
+			xWantedSize += heapSTRUCT_SIZE + heapGUARD_TAIL_SIZE;
 
 			/* Ensure that blocks are always aligned to the required number of bytes. */
 			if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0 )
@@ -195,15 +390,19 @@ WantedSize = xWantedSize;
 
 		if( ( xWantedSize > 0 ) && ( xWantedSize < configADJUSTED_HEAP_SIZE ) )
 		{
-			/* Blocks are stored in byte order - traverse the list from the start
-			(smallest) block until one of adequate size is found. */
-			pxPreviousBlock = &xStart;
-			pxBlock = xStart.pxNextFreeBlock;
-			while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock != NULL ) )
+			pxBlock = prvFindFreeBlock( xWantedSize, &pxPreviousBlock, &ulSearched );
+
+			#if( configHEAP_LAZY_COALESCE == 1 )
 			{
-				pxPreviousBlock = pxBlock;
-				pxBlock = pxBlock->pxNextFreeBlock;
+				/* Nothing fits, but the blocks still waiting to be merged
+				may, so merge them all now and look again. */
+				if( ( pxBlock == &xEnd ) && ( pxPendingBlocks != NULL ) )
+				{
+					prvCoalescePending( pdTRUE );
+					pxBlock = prvFindFreeBlock( xWantedSize, &pxPreviousBlock, &ulSearched );
+				}
 			}
+			#endif /* configHEAP_LAZY_COALESCE */
 
 			/* If we found the end marker then a block of adequate size was not found. */
 			if( pxBlock != &xEnd )
@@ -213,8 +412,11 @@ WantedSize = xWantedSize;
 				pvReturn = ( void * ) ( ( ( uint8_t * ) pxPreviousBlock->pxNextFreeBlock ) + heapSTRUCT_SIZE );
 
 				/* This block is being returned for use so must be taken out of the
-				list of free blocks. */
+				list of free blocks.  Next fit carries on from here, which is
+				also where the rest of the block goes if it is split. */
 				pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+				pxRover = pxPreviousBlock;
+				prvHeapJournalRecord( &xHeapJournal, eHeapChangeRemove, pxBlock, pxBlock->xBlockSize );
 
 				/* If the block is larger than required it can be split into two. */
 				if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
@@ -228,18 +430,39 @@ WantedSize = xWantedSize;
 					block. */
 					pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
 					pxBlock->xBlockSize = xWantedSize;
+					prvHeapJournalRecord( &xHeapJournal, eHeapChangeSplit, pxBlock, xWantedSize );
 
 					/* Insert the new block into the list of free blocks. */
 					prvInsertBlockIntoFreeList( ( pxNewBlockLink ) );
 				}
 
 				xFreeBytesRemaining -= pxBlock->xBlockSize;
+				prvGuardSealAllocated( pxBlock, xRequestedSize );
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
 			}
 		}
 
+		pxPolicy = &( xPolicyCounters[ eFitPolicy ] );
+		pxPolicy->ullBlocksSearched += ulSearched;
+		if( ulSearched > pxPolicy->ulMaxBlocksSearched )
+		{
+			pxPolicy->ulMaxBlocksSearched = ulSearched;
+		}
+		if( ( pvReturn == NULL ) && ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
+		{
+			pxPolicy->xFragmentedFailures++;
+		}
+		prvHeapStatsMalloc( &( pxPolicy->xCounters ), pvReturn, xWantedSize, ulStartCycles );
+
+		prvHeapStatsMalloc( &xHeapCounters, pvReturn, xWantedSize, ulStartCycles );
 		traceMALLOC( pvReturn, xWantedSize );
 	}
-	( void ) xTaskResumeAll();
+	prvHeapUnlock( uxHeapLockState );
+	prvHeapWatchCheck();
 
 	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
 	{
@@ -251,18 +474,25 @@ WantedSize = xWantedSize;
 	}
 	#endif
 
-    BlockSize = xWantedSize;
-    sprintf(data, "pvReturn: %p | heapSTRUCT_SIZE: %0d | WantedSize: %3d | BlockSize: %3d\n\r", pvReturn, heapSTRUCT_SIZE, WantedSize, BlockSize);
-	HAL_UART_Transmit(&huart2, (uint8_t *)data, strlen(data), 0xffff);
-
 	return pvReturn;
 }
 /*-----------------------------------------------------------*/
 
-void vPortFree( void *pv )
+portHEAP_HOT_PATH void *pvPortMallocFlags( size_t xWantedSize, UBaseType_t uxFlags )
+{
+	/* There is only the one heap, in DMA capable SRAM. */
+	( void ) uxFlags;
+	return pvPortMalloc( xWantedSize );
+}
+/*-----------------------------------------------------------*/
+
+portHEAP_HOT_PATH void vPortFree( void *pv )
 {
 uint8_t *puc = ( uint8_t * ) pv;
 BlockLink_t *pxLink;
+size_t xBlockSize;
+uint32_t ulStartCycles;
+UBaseType_t uxHeapLockState;
 
 	if( pv != NULL )
 	{
@@ -274,14 +504,464 @@ BlockLink_t *pxLink;
 		byte alignment warnings. */
 		pxLink = ( void * ) puc;
 
-		vTaskSuspendAll();
+		uxHeapLockState = prvHeapLock();
+		{
+			ulStartCycles = heapSTATS_TIMESTAMP();
+
+			/* A block that fails its check is left where it is, as putting it
+			on the free list would spread the damage. */
+			if( prvGuardAllocatedIntact( pxLink ) != pdFALSE )
+			{
+				/* Take the size before the block is inserted, as merging may
+				grow it to include a neighbour that was already free. */
+				xBlockSize = pxLink->xBlockSize;
+
+				#if( configHEAP_LAZY_COALESCE == 1 )
+				{
+					/* Merging and sorting are left to the idle task. */
+					pxLink->pxNextFreeBlock = pxPendingBlocks;
+					pxPendingBlocks = pxLink;
+					prvGuardSealFree( pxLink );
+
+					/* Waiting blocks are listed as free by
+					vPortGetHeapSnapshot(), so they are journalled as such. */
+					prvHeapJournalRecord( &xHeapJournal, eHeapChangeInsert, pxLink, xBlockSize );
+				}
+				#else
+				{
+					/* Add this block to the list of free blocks. */
+					prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
+				}
+				#endif /* configHEAP_LAZY_COALESCE */
+
+				xFreeBytesRemaining += xBlockSize;
+				prvHeapStatsFree( &( xPolicyCounters[ eFitPolicy ].xCounters ), ulStartCycles );
+				prvHeapStatsFree( &xHeapCounters, ulStartCycles );
+				traceFREE( pv, xBlockSize );
+			}
+		}
+		prvHeapUnlock( uxHeapLockState );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvRequiredBlockSize( size_t xWantedSize )
+{
+	if( ( xWantedSize == 0 ) || ( xWantedSize >= ( configADJUSTED_HEAP_SIZE - heapSTRUCT_SIZE - heapGUARD_TAIL_SIZE ) ) )
+	{
+		return 0;
+	}
+
+	/* Same rounding as pvPortMalloc(). */
+	xWantedSize += heapSTRUCT_SIZE + heapGUARD_TAIL_SIZE;
+
+	if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0 )
+	{
+		xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+	}
+
+	return xWantedSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTrimBlock( BlockLink_t *pxBlock, size_t xBlockSize )
+{
+BlockLink_t *pxNewBlockLink;
+
+	if( ( pxBlock->xBlockSize - xBlockSize ) > heapMINIMUM_BLOCK_SIZE )
+	{
+		pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xBlockSize );
+		pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xBlockSize;
+		pxBlock->xBlockSize = xBlockSize;
+		prvHeapJournalRecord( &xHeapJournal, eHeapChangeSplit, pxBlock, xBlockSize );
+
+		xFreeBytesRemaining += pxNewBlockLink->xBlockSize;
+		prvInsertBlockIntoFreeList( pxNewBlockLink );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortRealloc( void *pv, size_t xWantedSize )
+{
+BlockLink_t *pxLink, *pxBlock, *pxPreviousBlock;
+size_t xBlockSize, xOldSize;
+void *pvReturn = NULL;
+UBaseType_t uxHeapLockState;
+
+	if( pv == NULL )
+	{
+		return pvPortMalloc( xWantedSize );
+	}
+
+	if( xWantedSize == 0 )
+	{
+		vPortFree( pv );
+		return NULL;
+	}
+
+	pxLink = ( void * ) ( ( ( uint8_t * ) pv ) - heapSTRUCT_SIZE );
+	xBlockSize = prvRequiredBlockSize( xWantedSize );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		if( prvGuardAllocatedIntact( pxLink ) == pdFALSE )
+		{
+			prvHeapUnlock( uxHeapLockState );
+			return NULL;
+		}
+
+		xOldSize = pxLink->xBlockSize;
+
+		/* To grow in place the block that starts where this one ends must be
+		free.  It can only be absorbed when free blocks are being merged, as
+		otherwise the list may hold adjacent fragments of it. */
+		if( ( xBlockSize > xOldSize ) && ( xMergeFree != pdFALSE ) )
+		{
+			pxPreviousBlock = &xStart;
+
+			for( pxBlock = xStart.pxNextFreeBlock; pxBlock != &xEnd; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( ( uint8_t * ) pxBlock == ( ( uint8_t * ) pxLink ) + xOldSize )
+				{
+					break;
+				}
+
+				pxPreviousBlock = pxBlock;
+			}
+
+			if( ( pxBlock != &xEnd ) && ( ( xOldSize + pxBlock->xBlockSize ) >= xBlockSize ) )
+			{
+				if( pxBlock == pxRover )
+				{
+					pxRover = pxPreviousBlock;
+				}
+				pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+				prvHeapJournalRecord( &xHeapJournal, eHeapChangeMerge, pxBlock, pxBlock->xBlockSize );
+				pxLink->xBlockSize += pxBlock->xBlockSize;
+				xFreeBytesRemaining -= pxBlock->xBlockSize;
+			}
+		}
+
+		if( ( xBlockSize != 0 ) && ( xBlockSize <= pxLink->xBlockSize ) )
+		{
+			prvTrimBlock( pxLink, xBlockSize );
+			prvGuardSealAllocated( pxLink, xWantedSize );
+
+			if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+			{
+				xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+			}
+
+			traceFREE( pv, xOldSize );
+			traceMALLOC( pv, pxLink->xBlockSize );
+			pvReturn = pv;
+		}
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	if( pvReturn == NULL )
+	{
+		/* The block has to move, or is too large for the heap, in which case
+		pvPortMalloc() fails and calls the malloc failed hook.  Either way it
+		is growing, so all of the old contents fit in the new block. */
+		pvReturn = pvPortMalloc( xWantedSize );
+
+		if( pvReturn != NULL )
+		{
+			portMEMCPY( pvReturn, pv, xOldSize - heapSTRUCT_SIZE - heapGUARD_TAIL_SIZE );
+			vPortFree( pv );
+		}
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocAligned( size_t xWantedSize, size_t xAlignment, UBaseType_t uxFlags )
+{
+BlockLink_t *pxLink, *pxAlignedLink;
+uint8_t *pucBlock, *pucAligned;
+size_t xBlockSize, xLeading;
+UBaseType_t uxHeapLockState;
+
+	configASSERT( ( xAlignment & ( xAlignment - 1 ) ) == 0 );
+
+	xBlockSize = prvRequiredBlockSize( xWantedSize );
+
+	/* pvPortMalloc() already gives portBYTE_ALIGNMENT, and also deals with
+	requests that can never succeed. */
+	if( ( xAlignment <= portBYTE_ALIGNMENT ) || ( xBlockSize == 0 ) )
+	{
+		return pvPortMallocFlags( xWantedSize, uxFlags );
+	}
+
+	/* Allow for the worst case padding - up to xAlignment bytes to reach the
+	boundary, plus one more step of xAlignment if the gap is too small to be
+	given back as a free block.  The request is based on the rounded block
+	size so that it covers any minimum block size as well. */
+	pucBlock = pvPortMallocFlags( ( xBlockSize - heapSTRUCT_SIZE ) + xAlignment + heapMINIMUM_BLOCK_SIZE, uxFlags );
+
+	if( pucBlock == NULL )
+	{
+		return NULL;
+	}
+
+	pucAligned = ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) pucBlock + ( xAlignment - 1 ) ) & ~( ( portPOINTER_SIZE_TYPE ) xAlignment - 1 ) );
+
+	while( ( pucAligned != pucBlock ) && ( ( size_t ) ( pucAligned - pucBlock ) <= heapMINIMUM_BLOCK_SIZE ) )
+	{
+		pucAligned += xAlignment;
+	}
+
+	xLeading = ( size_t ) ( pucAligned - pucBlock );
+	pxLink = ( void * ) ( pucBlock - heapSTRUCT_SIZE );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		traceFREE( pucBlock, pxLink->xBlockSize );
+
+		/* The padding in front of the aligned address becomes a free block,
+		and the aligned address gets a header of its own. */
+		if( xLeading > 0 )
+		{
+			pxAlignedLink = ( void * ) ( pucAligned - heapSTRUCT_SIZE );
+			pxAlignedLink->xBlockSize = pxLink->xBlockSize - xLeading;
+			pxLink->xBlockSize = xLeading;
+
+			xFreeBytesRemaining += xLeading;
+			prvInsertBlockIntoFreeList( pxLink );
+			pxLink = pxAlignedLink;
+		}
+
+		prvTrimBlock( pxLink, xBlockSize );
+		prvGuardSealAllocated( pxLink, xWantedSize );
+		traceMALLOC( pucAligned, pxLink->xBlockSize );
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return pucAligned;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFreeBatch( void * const pvBlocks[], size_t xCount )
+{
+BlockLink_t *pxBlocks[ heapFREE_BATCH_MAX ];
+size_t x, xBatch, xBlockBytes;
+uint32_t ulStartCycles;
+UBaseType_t uxHeapLockState;
+
+	while( xCount > 0 )
+	{
+		/* Take the next heapFREE_BATCH_MAX blocks that are not NULL. */
+		for( xBatch = 0; ( xCount > 0 ) && ( xBatch < heapFREE_BATCH_MAX ); xCount--, pvBlocks++ )
+		{
+			if( *pvBlocks != NULL )
+			{
+				pxBlocks[ xBatch ] = ( void * ) ( ( ( uint8_t * ) *pvBlocks ) - heapSTRUCT_SIZE );
+				xBatch++;
+			}
+		}
+
+		if( xBatch == 0 )
+		{
+			break;
+		}
+
+		uxHeapLockState = prvHeapLock();
+		{
+			ulStartCycles = heapSTATS_TIMESTAMP();
+
+			/* As in vPortFree(), sizes are taken before anything is merged, and
+			a block that fails its check is left out. */
+			xBlockBytes = 0;
+			for( x = 0; x < xBatch; )
+			{
+				if( prvGuardAllocatedIntact( pxBlocks[ x ] ) == pdFALSE )
+				{
+					xBatch--;
+					pxBlocks[ x ] = pxBlocks[ xBatch ];
+					continue;
+				}
+
+				xBlockBytes += pxBlocks[ x ]->xBlockSize;
+				traceFREE( ( ( uint8_t * ) pxBlocks[ x ] ) + heapSTRUCT_SIZE, pxBlocks[ x ]->xBlockSize );
+				x++;
+			}
+
+			if( xBatch > 0 )
+			{
+				prvSortBlocksByAddress( pxBlocks, xBatch );
+				prvInsertBatchIntoFreeList( pxBlocks, xBatch );
+				xFreeBytesRemaining += xBlockBytes;
+				prvHeapStatsFreeBatch( &( xPolicyCounters[ eFitPolicy ].xCounters ), xBatch, ulStartCycles );
+				prvHeapStatsFreeBatch( &xHeapCounters, xBatch, ulStartCycles );
+			}
+		}
+		prvHeapUnlock( uxHeapLockState );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSortBlocksByAddress( BlockLink_t *pxBlocks[], size_t xCount )
+{
+BlockLink_t *pxBlock;
+size_t x, y;
+
+	/* Insertion sort - the batch is at most heapFREE_BATCH_MAX long. */
+	for( x = 1; x < xCount; x++ )
+	{
+		pxBlock = pxBlocks[ x ];
+
+		for( y = x; ( y > 0 ) && ( pxBlocks[ y - 1 ] > pxBlock ); y-- )
+		{
+			pxBlocks[ y ] = pxBlocks[ y - 1 ];
+		}
+
+		pxBlocks[ y ] = pxBlock;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertBatchIntoFreeList( BlockLink_t *pxBlocks[], size_t xCount )
+{
+BlockLink_t *pxBefore[ heapFREE_BATCH_MAX ], *pxAfter[ heapFREE_BATCH_MAX ];
+BlockLink_t *pxSegments[ 3 ];
+BlockLink_t *pxPreviousBlock, *pxCurrentBlock, *pxIterator, *pxRun = NULL, *pxBlock;
+BaseType_t xNeighbour;
+size_t x, xSegment, xRuns = 0;
+
+	for( x = 0; x < xCount; x++ )
+	{
+		pxBefore[ x ] = NULL;
+		pxAfter[ x ] = NULL;
+	}
+
+	if( xMergeFree != pdFALSE )
+	{
+		/* The single walk of the free list.  The list is kept fully merged, so
+		each block in the batch has at most one free neighbour on each side,
+		and one free block can sit between two blocks of the batch. */
+		pxPreviousBlock = &xStart;
+		pxCurrentBlock = xStart.pxNextFreeBlock;
+
+		while( pxCurrentBlock != &xEnd )
+		{
+			xNeighbour = pdFALSE;
+
+			for( x = 0; x < xCount; x++ )
+			{
+				if( ( ( uint8_t * ) pxCurrentBlock + pxCurrentBlock->xBlockSize ) == ( uint8_t * ) pxBlocks[ x ] )
+				{
+					pxBefore[ x ] = pxCurrentBlock;
+					xNeighbour = pdTRUE;
+				}
+
+				if( ( ( uint8_t * ) pxBlocks[ x ] + pxBlocks[ x ]->xBlockSize ) == ( uint8_t * ) pxCurrentBlock )
+				{
+					pxAfter[ x ] = pxCurrentBlock;
+					xNeighbour = pdTRUE;
+				}
+			}
+
+			if( xNeighbour != pdFALSE )
+			{
+				if( pxCurrentBlock == pxRover )
+				{
+					pxRover = pxPreviousBlock;
+				}
+				pxPreviousBlock->pxNextFreeBlock = pxCurrentBlock->pxNextFreeBlock;
+				prvHeapJournalRecord( &xHeapJournal, eHeapChangeMerge, pxCurrentBlock, pxCurrentBlock->xBlockSize );
+			}
+			else
+			{
+				pxPreviousBlock = pxCurrentBlock;
+			}
+
+			pxCurrentBlock = pxCurrentBlock->pxNextFreeBlock;
+		}
+	}
+
+	/* Join the batch and its neighbours, in address order, into runs.  Only
+	runs that have been completed are written back to pxBlocks[], and each one
+	holds at least one block of the batch, so nothing is overwritten before it
+	has been read. */
+	for( x = 0; x < xCount; x++ )
+	{
+		/* A block between two members of the batch is already in the run. */
+		pxSegments[ 0 ] = ( ( x > 0 ) && ( pxBefore[ x ] == pxAfter[ x - 1 ] ) ) ? NULL : pxBefore[ x ];
+		pxSegments[ 1 ] = pxBlocks[ x ];
+		pxSegments[ 2 ] = pxAfter[ x ];
+
+		for( xSegment = 0; xSegment < 3; xSegment++ )
+		{
+			pxBlock = pxSegments[ xSegment ];
+
+			if( pxBlock == NULL )
+			{
+				continue;
+			}
+
+			if( ( xMergeFree != pdFALSE ) && ( pxRun != NULL ) && ( ( ( uint8_t * ) pxRun + pxRun->xBlockSize ) == ( uint8_t * ) pxBlock ) )
+			{
+				#if( configHEAP_LAZY_COALESCE == 1 )
+				{
+					/* A block that was waiting to be merged was journalled
+					as free, so it is journalled leaving again.  Its free
+					neighbours were journalled by the walk above. */
+					if( xSegment == 1 )
+					{
+						prvHeapJournalRecord( &xHeapJournal, eHeapChangeMerge, pxBlock, pxBlock->xBlockSize );
+					}
+				}
+				#endif
+				pxRun->xBlockSize += pxBlock->xBlockSize;
+			}
+			else
+			{
+				if( pxRun != NULL )
+				{
+					pxBlocks[ xRuns ] = pxRun;
+					xRuns++;
+				}
+
+				pxRun = pxBlock;
+			}
+		}
+	}
+
+	pxBlocks[ xRuns ] = pxRun;
+	xRuns++;
+
+	/* Put the runs in list order so they can all be inserted in one more
+	walk, each search carrying on from where the previous run went in.  They
+	are already in address order, and the most recently freed list takes
+	them in any order. */
+	if( eFitPolicy == eHeapFitBest )
+	{
+		for( x = 1; x < xRuns; x++ )
 		{
-			/* Add this block to the list of free blocks. */
-			prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
-			xFreeBytesRemaining += pxLink->xBlockSize;
-			traceFREE( pv, pxLink->xBlockSize );
+			pxBlock = pxBlocks[ x ];
+
+			for( xSegment = x; ( xSegment > 0 ) && ( pxBlocks[ xSegment - 1 ]->xBlockSize > pxBlock->xBlockSize ); xSegment-- )
+			{
+				pxBlocks[ xSegment ] = pxBlocks[ xSegment - 1 ];
+			}
+
+			pxBlocks[ xSegment ] = pxBlock;
 		}
-		( void ) xTaskResumeAll();
+	}
+
+	pxIterator = &xStart;
+
+	for( x = 0; x < xRuns; x++ )
+	{
+		pxIterator = prvFindInsertPoint( pxIterator, pxBlocks[ x ] );
+
+		pxBlocks[ x ]->pxNextFreeBlock = pxIterator->pxNextFreeBlock;
+		pxIterator->pxNextFreeBlock = pxBlocks[ x ];
+		pxIterator = pxBlocks[ x ];
+		prvGuardSealFree( pxBlocks[ x ] );
+		prvHeapJournalRecord( &xHeapJournal, eHeapChangeInsert, pxBlocks[ x ], pxBlocks[ x ]->xBlockSize );
 	}
 }
 /*-----------------------------------------------------------*/
@@ -292,6 +972,12 @@ size_t xPortGetFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
 	/* This just exists to keep the linker quiet. */
@@ -303,6 +989,8 @@ static void prvHeapInit( void )
 BlockLink_t *pxFirstFreeBlock;
 uint8_t *pucAlignedHeap;
 
+	prvHeapStatsInit();
+
 	/* Ensure the heap starts on a correctly aligned boundary. */
 	pucAlignedHeap = ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) &ucHeap[ portBYTE_ALIGNMENT ] ) & ( ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) ) );
 
@@ -320,63 +1008,489 @@ uint8_t *pucAlignedHeap;
 	pxFirstFreeBlock = ( void * ) pucAlignedHeap;
 	pxFirstFreeBlock->xBlockSize = configADJUSTED_HEAP_SIZE;
 	pxFirstFreeBlock->pxNextFreeBlock = &xEnd;
+	pxRover = &xStart;
+	prvHeapJournalRecord( &xHeapJournal, eHeapChangeInsert, pxFirstFreeBlock, configADJUSTED_HEAP_SIZE );
+
+	#if( configHEAP_GUARD == 1 )
+	{
+		pucHeapStart = pucAlignedHeap;
+		pucHeapEnd = pucAlignedHeap + configADJUSTED_HEAP_SIZE;
+		prvGuardSealFree( pxFirstFreeBlock );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapSnapshot( HeapSnapshot_t *pxSnapshot, HeapBlockInfo_t *pxBlocks, size_t xMaxBlocks )
+{
+BlockLink_t *pxBlock;
+size_t xCount = 0;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		/* A link that fails its check ends the walk, rather than being
+		followed into whatever it points at. */
+		for( pxBlock = xStart.pxNextFreeBlock; ( pxBlock != NULL ) && ( pxBlock != &xEnd ) && ( prvGuardFreeIntact( pxBlock ) != pdFALSE ); pxBlock = pxBlock->pxNextFreeBlock )
+		{
+			if( xCount < xMaxBlocks )
+			{
+				pxBlocks[ xCount ].pvStartAddress = ( void * ) pxBlock;
+				pxBlocks[ xCount ].xBlockSize = pxBlock->xBlockSize;
+			}
+			xCount++;
+		}
+
+		#if( configHEAP_LAZY_COALESCE == 1 )
+		{
+			/* Blocks waiting to be merged are free too, and are listed after
+			the free list. */
+			for( pxBlock = pxPendingBlocks; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( xCount < xMaxBlocks )
+				{
+					pxBlocks[ xCount ].pvStartAddress = ( void * ) pxBlock;
+					pxBlocks[ xCount ].xBlockSize = pxBlock->xBlockSize;
+				}
+				xCount++;
+			}
+		}
+		#endif /* configHEAP_LAZY_COALESCE */
+
+		pxSnapshot->xFreeBytesRemaining = xFreeBytesRemaining;
+		pxSnapshot->ulSequence = xHeapJournal.ulSequence;
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	pxSnapshot->xHeapSize = configADJUSTED_HEAP_SIZE;
+	pxSnapshot->xHeaderSize = heapSTRUCT_SIZE;
+	pxSnapshot->xNumberOfFreeBlocks = xCount;
+	pxSnapshot->xBlocksCaptured = ( xCount < xMaxBlocks ) ? xCount : xMaxBlocks;
 }
 /*-----------------------------------------------------------*/
 
-void vPadding(char str [], int padNum) {
-	for (int i = 0; i < padNum; ++i) {
-		strcat(str, " ");
+BaseType_t xPortGetHeapChanges( uint32_t *pulSequence, HeapChange_t *pxChanges, size_t xMaxChanges, size_t *pxChangesCopied )
+{
+BaseType_t xReturn;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		xReturn = prvHeapJournalCopy( &xHeapJournal, pulSequence, pxChanges, xMaxChanges, pxChangesCopied );
 	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return xReturn;
 }
+/*-----------------------------------------------------------*/
 
-void vPrintFreeList(void)
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
 {
-    char msg [100];
-    memset(msg, '\0', sizeof(msg));
-    sprintf(msg, "StartAddress heapSTRUCT_SIZE xBlockSize EndAddress\n\r");
-    HAL_UART_Transmit(&huart2, (uint8_t *) msg, strlen(msg), 0xffff);
-
-    BlockLink_t *curNode = xStart.pxNextFreeBlock;
-    while ( (void *) curNode != (void *) &(xEnd) ) {
-
-    	memset(msg, '\0', sizeof(msg));
-
-    	char startAddr [20];
-    	memset(startAddr, '\0', sizeof(startAddr));
-    	itoa((size_t) curNode, startAddr, 16);
-    	strcat(msg, "0x");
-    	strcat(msg, startAddr);
-    	vPadding(msg, 9);
-
-    	char heapStructSize [5];
-    	memset(heapStructSize, '\0', sizeof(heapStructSize));
-    	itoa((uint16_t) heapSTRUCT_SIZE, heapStructSize, 10);
-    	strcat(msg, heapStructSize);
-    	vPadding(msg, 10);
-
-    	char blockSize [10];
-    	memset(blockSize, '\0', sizeof(blockSize));
-    	itoa((size_t) curNode->xBlockSize, blockSize, 10);
-    	char tmp [10];
-    	memset(tmp, '\0', sizeof(tmp));
-    	vPadding(tmp, 5 - strlen(blockSize));
-    	strcat(tmp, blockSize);
-    	strcat(msg, tmp);
-    	vPadding(msg, 5);
-
-    	char endAddr [20];
-    	memset(endAddr, '\0', sizeof(endAddr));
-    	itoa((size_t) curNode + curNode->xBlockSize, endAddr, 16);
-    	strcat(msg, "0x");
-    	strcat(msg, endAddr);
-    	strcat(msg, "\n\r");
-
-    	HAL_UART_Transmit(&huart2, (uint8_t *) msg, strlen(msg), 0xffff);
-
-    	curNode = curNode->pxNextFreeBlock;
-    }
+BlockLink_t *pxBlock;
+UBaseType_t uxHeapLockState;
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+	pxHeapStats->xNumberOfFreeBlocks = 0;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		for( pxBlock = xStart.pxNextFreeBlock; ( pxBlock != NULL ) && ( pxBlock != &xEnd ) && ( prvGuardFreeIntact( pxBlock ) != pdFALSE ); pxBlock = pxBlock->pxNextFreeBlock )
+		{
+			prvHeapStatsAddFreeBlock( pxHeapStats, pxBlock->xBlockSize );
+		}
+
+		#if( configHEAP_LAZY_COALESCE == 1 )
+		{
+			for( pxBlock = pxPendingBlocks; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				prvHeapStatsAddFreeBlock( pxHeapStats, pxBlock->xBlockSize );
+			}
+		}
+		#endif /* configHEAP_LAZY_COALESCE */
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		prvHeapStatsCopy( &xHeapCounters, pxHeapStats );
+	}
+	prvHeapUnlock( uxHeapLockState );
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapPolicyStats( HeapFitPolicy_t ePolicy, HeapPolicyStats_t *pxStats )
+{
+const HeapPolicyCounters_t *pxPolicy;
+size_t xSearches;
+UBaseType_t uxHeapLockState;
 
-    memset(msg, '\0', sizeof(msg));
-	sprintf(msg, "configADJUSTED_HEAP_SIZE: %d xFreeBytesRemaining: %d\n\r", configADJUSTED_HEAP_SIZE, xFreeBytesRemaining);
-	HAL_UART_Transmit(&huart2, (uint8_t *) msg, strlen(msg), 0xffff);
+	configASSERT( ( UBaseType_t ) ePolicy < heapFIT_POLICIES );
+	pxPolicy = &( xPolicyCounters[ ePolicy ] );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		xSearches = pxPolicy->xCounters.xSuccessfulAllocations + pxPolicy->xCounters.xFailedAllocations;
+
+		pxStats->xSuccessfulAllocations = pxPolicy->xCounters.xSuccessfulAllocations;
+		pxStats->xFailedAllocations = pxPolicy->xCounters.xFailedAllocations;
+		pxStats->xFragmentedFailures = pxPolicy->xFragmentedFailures;
+		pxStats->xSuccessfulFrees = pxPolicy->xCounters.xSuccessfulFrees;
+		pxStats->ulBlocksSearchedAverage = ( xSearches == 0 ) ? 0UL : ( uint32_t ) ( pxPolicy->ullBlocksSearched / xSearches );
+		pxStats->ulBlocksSearchedMax = pxPolicy->ulMaxBlocksSearched;
+		pxStats->ulMallocCyclesAverage = prvHeapLatencyAverage( &( pxPolicy->xCounters.xMallocLatency ) );
+		pxStats->ulMallocCyclesMax = pxPolicy->xCounters.xMallocLatency.ulMaxCycles;
+		pxStats->ulFreeCyclesAverage = prvHeapLatencyAverage( &( pxPolicy->xCounters.xFreeLatency ) );
+		pxStats->ulFreeCyclesMax = pxPolicy->xCounters.xFreeLatency.ulMaxCycles;
+	}
+	prvHeapUnlock( uxHeapLockState );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortHeapSetFitPolicy( HeapFitPolicy_t ePolicy, BaseType_t xMerge )
+{
+UBaseType_t uxHeapLockState;
+
+	if( ( UBaseType_t ) ePolicy >= heapFIT_POLICIES )
+	{
+		return pdFAIL;
+	}
+
+	#if( configHEAP_LAZY_COALESCE == 1 )
+	{
+		/* See the check on if_merge_mem above. */
+		if( xMerge == pdFALSE )
+		{
+			return pdFAIL;
+		}
+	}
+	#endif
+
+	uxHeapLockState = prvHeapLock();
+	{
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			/* Nothing to rebuild yet; pvPortMalloc() lays the heap out. */
+			eFitPolicy = ePolicy;
+			xMergeFree = xMerge;
+		}
+		else
+		{
+			#if( configHEAP_LAZY_COALESCE == 1 )
+			{
+				/* Under the old setting, which they were freed under. */
+				prvCoalescePending( pdTRUE );
+			}
+			#endif
+
+			eFitPolicy = ePolicy;
+			xMergeFree = xMerge;
+			prvRebuildFreeList();
+		}
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return pdPASS;
 }
+/*-----------------------------------------------------------*/
+
+static BlockLink_t *prvFindFreeBlock( size_t xWantedSize, BlockLink_t **ppxPreviousBlock, uint32_t *pulSearched )
+{
+BlockLink_t *pxPreviousBlock, *pxBlock;
+BaseType_t xWrapped = pdFALSE;
+uint32_t ulSearched = 0;
+
+	if( eFitPolicy != eHeapFitNext )
+	{
+		/* From the bottom of the list to the first block that fits.  xEnd is
+		sized to the whole heap, so the walk always stops there. */
+		pxPreviousBlock = &xStart;
+		pxBlock = xStart.pxNextFreeBlock;
+		while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock != NULL ) )
+		{
+			ulSearched++;
+			pxPreviousBlock = pxBlock;
+			pxBlock = pxBlock->pxNextFreeBlock;
+		}
+	}
+	else
+	{
+		/* From the rover to the end, then from the bottom back to the rover,
+		which is looked at last. */
+		pxPreviousBlock = pxRover;
+		pxBlock = pxRover->pxNextFreeBlock;
+
+		for( ;; )
+		{
+			if( pxBlock == &xEnd )
+			{
+				if( ( xWrapped != pdFALSE ) || ( pxRover == &xStart ) )
+				{
+					break;
+				}
+
+				xWrapped = pdTRUE;
+				pxPreviousBlock = &xStart;
+				pxBlock = xStart.pxNextFreeBlock;
+				continue;
+			}
+
+			ulSearched++;
+
+			if( pxBlock->xBlockSize >= xWantedSize )
+			{
+				break;
+			}
+
+			if( ( xWrapped != pdFALSE ) && ( pxBlock == pxRover ) )
+			{
+				pxBlock = &xEnd;
+				break;
+			}
+
+			pxPreviousBlock = pxBlock;
+			pxBlock = pxBlock->pxNextFreeBlock;
+		}
+	}
+
+	*ppxPreviousBlock = pxPreviousBlock;
+	*pulSearched += ulSearched;
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t *prvFindInsertPoint( BlockLink_t *pxIterator, const BlockLink_t *pxBlock )
+{
+	switch( eFitPolicy )
+	{
+		case eHeapFitBest:
+			/* By size.  xEnd is sized to the whole heap, so the walk always
+			stops there. */
+			while( pxIterator->pxNextFreeBlock->xBlockSize < pxBlock->xBlockSize )
+			{
+				pxIterator = pxIterator->pxNextFreeBlock;
+			}
+			break;
+
+		case eHeapFitFirst:
+			/* Most recent first. */
+			pxIterator = &xStart;
+			break;
+
+		default:
+			/* By address. */
+			while( ( pxIterator->pxNextFreeBlock != &xEnd ) && ( pxIterator->pxNextFreeBlock < pxBlock ) )
+			{
+				pxIterator = pxIterator->pxNextFreeBlock;
+			}
+			break;
+	}
+
+	return pxIterator;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRebuildFreeList( void )
+{
+BlockLink_t *pxBlock, *pxNext;
+
+	pxBlock = xStart.pxNextFreeBlock;
+	xStart.pxNextFreeBlock = &xEnd;
+	pxRover = &xStart;
+
+	while( pxBlock != &xEnd )
+	{
+		pxNext = pxBlock->pxNextFreeBlock;
+		prvInsertBlockIntoFreeList( pxBlock );
+		pxBlock = pxNext;
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_LAZY_COALESCE == 1 )
+
+	static void prvCoalescePending( BaseType_t xAll )
+	{
+	BlockLink_t *pxBlocks[ heapFREE_BATCH_MAX ];
+	size_t xBatch;
+
+		do
+		{
+			for( xBatch = 0; ( pxPendingBlocks != NULL ) && ( xBatch < heapFREE_BATCH_MAX ); xBatch++ )
+			{
+				pxBlocks[ xBatch ] = pxPendingBlocks;
+				pxPendingBlocks = pxPendingBlocks->pxNextFreeBlock;
+			}
+
+			if( xBatch > 0 )
+			{
+				prvSortBlocksByAddress( pxBlocks, xBatch );
+				prvInsertBatchIntoFreeList( pxBlocks, xBatch );
+			}
+
+		} while( ( xAll != pdFALSE ) && ( pxPendingBlocks != NULL ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xPortHeapCoalesceStep( void )
+	{
+	BaseType_t xDone;
+	UBaseType_t uxHeapLockState;
+
+		/* Read without the lock, as the idle task calls this every time round
+		its loop and there is usually nothing to do.  A block freed just after
+		the test waits for the next call. */
+		if( pxPendingBlocks == NULL )
+		{
+			return pdTRUE;
+		}
+
+		uxHeapLockState = prvHeapLock();
+		{
+			prvCoalescePending( pdFALSE );
+			xDone = ( pxPendingBlocks == NULL ) ? pdTRUE : pdFALSE;
+		}
+		prvHeapUnlock( uxHeapLockState );
+
+		return xDone;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_LAZY_COALESCE */
+
+#if( configHEAP_GUARD == 1 )
+
+	static uint32_t prvGuardCheckWord( const BlockLink_t *pxBlock )
+	{
+		#ifdef configHEAP_GUARD_CHECK_WORD
+		{
+		uint32_t ulWords[ 3 ];
+
+			/* A CRC over the three catches every error of up to 32
+			adjacent bits in them. */
+			ulWords[ 0 ] = ( uint32_t ) ( portPOINTER_SIZE_TYPE ) pxBlock;
+			ulWords[ 1 ] = ( uint32_t ) pxBlock->xBlockSize;
+			ulWords[ 2 ] = pxBlock->ulRequested;
+			return heapGUARD_SEED ^ configHEAP_GUARD_CHECK_WORD( ulWords, 3 );
+		}
+		#else
+		{
+			/* The sizes are spread over the word so that a small change to one
+			cannot be cancelled out by the address or the other. */
+			return heapGUARD_SEED ^ ( uint32_t ) ( portPOINTER_SIZE_TYPE ) pxBlock ^
+				   ( ( uint32_t ) pxBlock->xBlockSize * 0x9e3779b1UL ) ^
+				   ( pxBlock->ulRequested * 0x85ebca6bUL );
+		}
+		#endif
+	}
+	/*-----------------------------------------------------------*/
+
+	static uint32_t prvGuardCanary( const BlockLink_t *pxBlock )
+	{
+		return heapGUARD_CANARY ^ ( uint32_t ) ( portPOINTER_SIZE_TYPE ) pxBlock;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvGuardSeal( BlockLink_t *pxBlock, size_t xRequested )
+	{
+	uint32_t ulCanary;
+
+		pxBlock->ulRequested = ( uint32_t ) xRequested;
+		pxBlock->ulCheck = prvGuardCheckWord( pxBlock );
+
+		if( xRequested != 0 )
+		{
+			ulCanary = prvGuardCanary( pxBlock );
+			( void ) memcpy( ( ( uint8_t * ) pxBlock ) + heapSTRUCT_SIZE + xRequested, &ulCanary, heapGUARD_TAIL_SIZE );
+		}
+
+		ulHeapGeneration++;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvGuardCheck( const BlockLink_t *pxBlock, BaseType_t xAllocated )
+	{
+	const uint8_t *pucBlock = ( const uint8_t * ) pxBlock;
+	BaseType_t xIntact = pdFALSE;
+	uint32_t ulCanary;
+
+		/* The header must lie in the heap before anything in it is read, and
+		the block it describes must end there too. */
+		if( ( pucBlock >= pucHeapStart ) &&
+			( pucBlock <= ( pucHeapEnd - heapSTRUCT_SIZE ) ) &&
+			( ( ( portPOINTER_SIZE_TYPE ) pucBlock & portBYTE_ALIGNMENT_MASK ) == 0 ) &&
+			( pxBlock->xBlockSize >= heapSTRUCT_SIZE ) &&
+			( ( pxBlock->xBlockSize & portBYTE_ALIGNMENT_MASK ) == 0 ) &&
+			( pxBlock->xBlockSize <= ( size_t ) ( pucHeapEnd - pucBlock ) ) &&
+			( pxBlock->ulCheck == prvGuardCheckWord( pxBlock ) ) )
+		{
+			if( pxBlock->ulRequested == 0UL )
+			{
+				xIntact = ( xAllocated != pdTRUE ) ? pdTRUE : pdFALSE;
+			}
+			else if( ( xAllocated != pdFALSE ) && ( ( heapSTRUCT_SIZE + pxBlock->ulRequested + heapGUARD_TAIL_SIZE ) <= pxBlock->xBlockSize ) )
+			{
+				( void ) memcpy( &ulCanary, pucBlock + heapSTRUCT_SIZE + pxBlock->ulRequested, heapGUARD_TAIL_SIZE );
+				xIntact = ( ulCanary == prvGuardCanary( pxBlock ) ) ? pdTRUE : pdFALSE;
+			}
+		}
+
+		if( xIntact == pdFALSE )
+		{
+			extern void vApplicationHeapCorruptedHook( void *pvBlock );
+			vApplicationHeapCorruptedHook( ( void * ) pxBlock );
+		}
+
+		return xIntact;
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xPortHeapGuardStep( void )
+	{
+	static uint8_t *pucCursor = NULL;
+	static uint32_t ulCursorGeneration = 0;
+	const BlockLink_t *pxBlock;
+	size_t x;
+	BaseType_t xPassComplete = pdFALSE;
+	UBaseType_t uxHeapLockState;
+
+		uxHeapLockState = prvHeapLock();
+		{
+			/* Nothing to walk until the first allocation has laid the heap
+			out. */
+			if( pucHeapStart != NULL )
+			{
+				if( ( pucCursor == NULL ) || ( ulCursorGeneration != ulHeapGeneration ) )
+				{
+					pucCursor = pucHeapStart;
+					ulCursorGeneration = ulHeapGeneration;
+				}
+
+				for( x = 0; x < ( size_t ) configHEAP_GUARD_STEP_BLOCKS; x++ )
+				{
+					pxBlock = ( const void * ) pucCursor;
+
+					if( prvGuardCheck( pxBlock, -1 ) == pdFALSE )
+					{
+						pucCursor = NULL;
+						break;
+					}
+
+					pucCursor += pxBlock->xBlockSize;
+
+					if( pucCursor == pucHeapEnd )
+					{
+						pucCursor = NULL;
+						xPassComplete = pdTRUE;
+						break;
+					}
+				}
+			}
+		}
+		prvHeapUnlock( uxHeapLockState );
+
+		return xPassComplete;
+	}
+
+#endif /* configHEAP_GUARD */
+
+#endif /* configHEAP_IMPLEMENTATION */
@@ -0,0 +1,725 @@
+/*
+ * A boundary-tag variant of heap_2.c.  Every block carries a header holding
+ * its size plus two flag bits (this block allocated, previous block
+ * allocated), and every free block also carries a footer repeating its size.
+ * That lets vPortFree() find and merge with both physical neighbours in
+ * constant time, without walking the free list the way
+ * prvInsertBlockIntoFreeList() in heap_2.c does when if_merge_mem is set.
+ *
+ * Free blocks are indexed by size in power of two bins.  Each bin is kept in
+ * ascending size order, so the first block that fits in the first non-empty
+ * bin is the best fit.  A bitmap of non-empty bins lets pvPortMalloc() skip
+ * straight to the next populated bin with a single CLZ.
+ *
+ * Select this file by setting configHEAP_IMPLEMENTATION to
+ * heapIMPLEMENTATION_BTAG in FreeRTOSConfig.h.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_BTAG )
+
+#include "heap_stats.h"
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+/* A few bytes might be lost to byte aligning the heap start address. */
+#define configADJUSTED_HEAP_SIZE	( configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT )
+
+/* Allocate the memory for the heap. */
+#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+	extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* The header at the start of every block.  xBlockSize includes the header
+itself, is always a multiple of portBYTE_ALIGNMENT, and so has its bottom bits
+free to hold the heapBLOCK_ALLOCATED and heapPREV_ALLOCATED flags.  The free
+list links are only valid while the block is free - for an allocated block
+that memory belongs to the application. */
+typedef struct A_TAGGED_BLOCK
+{
+	size_t xBlockSize;						/*<< Size of the block plus flag bits. */
+	struct A_TAGGED_BLOCK *pxNextFreeBlock;	/*<< Next free block in the same bin. */
+	struct A_TAGGED_BLOCK *pxPrevFreeBlock;	/*<< Previous free block in the same bin. */
+} TaggedBlock_t;
+
+#define heapBLOCK_ALLOCATED		( ( size_t ) 0x01 )
+#define heapPREV_ALLOCATED		( ( size_t ) 0x02 )
+#define heapFLAG_MASK			( ( size_t ) portBYTE_ALIGNMENT_MASK )
+
+#define heapBLOCK_SIZE( pxBlock )		( ( pxBlock )->xBlockSize & ~heapFLAG_MASK )
+#define heapNEXT_PHYSICAL( pxBlock )	( ( TaggedBlock_t * ) ( ( ( uint8_t * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+#define heapFOOTER( pxBlock )			( * ( size_t * ) ( ( ( uint8_t * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) - sizeof( size_t ) ) )
+
+/* Only the size word of the header is overhead on an allocated block. */
+static const uint16_t heapSTRUCT_SIZE	= ( ( sizeof( size_t ) + ( portBYTE_ALIGNMENT - 1 ) ) & ~portBYTE_ALIGNMENT_MASK );
+
+/* A free block must be able to hold its header, both links and a footer. */
+#define heapMINIMUM_BLOCK_SIZE	( ( ( sizeof( TaggedBlock_t ) + sizeof( size_t ) ) + ( portBYTE_ALIGNMENT - 1 ) ) & ~portBYTE_ALIGNMENT_MASK )
+
+/* Bin n holds free blocks whose size has its most significant bit at position
+n + heapBIN_SHIFT.  Anything larger than the last bin is kept in the last bin. */
+#define heapBIN_SHIFT		( 4 )
+#define heapNUMBER_OF_BINS	( 16 )
+
+static TaggedBlock_t *pxBins[ heapNUMBER_OF_BINS ];
+static uint32_t ulBinBitmap = 0;
+
+/* Keeps track of the number of free bytes remaining, and the lowest that
+value has ever been. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+
+/* Allocation counts and latencies reported by vPortGetHeapStats(). */
+static HeapCounters_t xHeapCounters = { 0 };
+
+/* Blocks only enter and leave the bins here, so the journal holds inserts and
+removes, with no splits or merges. */
+static HeapJournal_t xHeapJournal = { 0 };
+
+/*
+ * Initialises the heap structures before their first use.
+ */
+static void prvHeapInit( void );
+
+/*
+ * Returns the bin a block of xBlockSize bytes belongs in.
+ */
+static UBaseType_t prvBinIndex( size_t xBlockSize ) portHEAP_HOT_PATH;
+
+/*
+ * Add a free block to, or remove it from, its size bin.
+ */
+static void prvInsertBlockIntoBin( TaggedBlock_t *pxBlockToInsert ) portHEAP_HOT_PATH;
+static void prvRemoveBlockFromBin( TaggedBlock_t *pxBlockToRemove ) portHEAP_HOT_PATH;
+
+/*
+ * Merge the allocated block pxLink with any free neighbours and file the
+ * result as free.  The caller accounts for the bytes.
+ */
+static void prvReleaseBlock( TaggedBlock_t *pxLink ) portHEAP_HOT_PATH;
+
+/*
+ * The size of block, header included, that holds xWantedSize bytes, or 0 if
+ * the heap could never hold that many.
+ */
+static size_t prvRequiredBlockSize( size_t xWantedSize ) portHEAP_HOT_PATH;
+
+/*
+ * Cut the allocated block pxBlock down to xBlockSize bytes and release the
+ * rest, if the rest is large enough to be a block.
+ */
+static void prvTrimBlock( TaggedBlock_t *pxBlock, size_t xBlockSize ) portHEAP_HOT_PATH;
+
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvBinIndex( size_t xBlockSize )
+{
+UBaseType_t uxMsb;
+
+	/* __builtin_clz() compiles to a single CLZ on the Cortex-M4. */
+	uxMsb = ( UBaseType_t ) ( 31 - __builtin_clz( ( unsigned int ) xBlockSize ) );
+
+	if( uxMsb < heapBIN_SHIFT )
+	{
+		return 0;
+	}
+
+	uxMsb -= heapBIN_SHIFT;
+
+	return ( uxMsb < heapNUMBER_OF_BINS ) ? uxMsb : ( heapNUMBER_OF_BINS - 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertBlockIntoBin( TaggedBlock_t *pxBlockToInsert )
+{
+TaggedBlock_t *pxIterator, *pxPrevious = NULL;
+size_t xBlockSize = heapBLOCK_SIZE( pxBlockToInsert );
+UBaseType_t uxBin = prvBinIndex( xBlockSize );
+
+	/* Keep each bin in ascending size order so the first fit in a bin is also
+	the best fit in that bin. */
+	for( pxIterator = pxBins[ uxBin ]; ( pxIterator != NULL ) && ( heapBLOCK_SIZE( pxIterator ) < xBlockSize ); pxIterator = pxIterator->pxNextFreeBlock )
+	{
+		pxPrevious = pxIterator;
+	}
+
+	pxBlockToInsert->pxNextFreeBlock = pxIterator;
+	pxBlockToInsert->pxPrevFreeBlock = pxPrevious;
+
+	if( pxIterator != NULL )
+	{
+		pxIterator->pxPrevFreeBlock = pxBlockToInsert;
+	}
+
+	if( pxPrevious != NULL )
+	{
+		pxPrevious->pxNextFreeBlock = pxBlockToInsert;
+	}
+	else
+	{
+		pxBins[ uxBin ] = pxBlockToInsert;
+	}
+
+	ulBinBitmap |= ( 1UL << uxBin );
+	prvHeapJournalRecord( &xHeapJournal, eHeapChangeInsert, pxBlockToInsert, heapBLOCK_SIZE( pxBlockToInsert ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveBlockFromBin( TaggedBlock_t *pxBlockToRemove )
+{
+UBaseType_t uxBin = prvBinIndex( heapBLOCK_SIZE( pxBlockToRemove ) );
+
+	prvHeapJournalRecord( &xHeapJournal, eHeapChangeRemove, pxBlockToRemove, heapBLOCK_SIZE( pxBlockToRemove ) );
+
+	if( pxBlockToRemove->pxPrevFreeBlock != NULL )
+	{
+		pxBlockToRemove->pxPrevFreeBlock->pxNextFreeBlock = pxBlockToRemove->pxNextFreeBlock;
+	}
+	else
+	{
+		pxBins[ uxBin ] = pxBlockToRemove->pxNextFreeBlock;
+
+		if( pxBins[ uxBin ] == NULL )
+		{
+			ulBinBitmap &= ~( 1UL << uxBin );
+		}
+	}
+
+	if( pxBlockToRemove->pxNextFreeBlock != NULL )
+	{
+		pxBlockToRemove->pxNextFreeBlock->pxPrevFreeBlock = pxBlockToRemove->pxPrevFreeBlock;
+	}
+}
+/*-----------------------------------------------------------*/
+
+portHEAP_HOT_PATH void *pvPortMalloc( size_t xWantedSize )
+{
+TaggedBlock_t *pxBlock = NULL, *pxNewBlockLink;
+static BaseType_t xHeapHasBeenInitialised = pdFALSE;
+void *pvReturn = NULL;
+UBaseType_t uxBin;
+uint32_t ulCandidates;
+uint32_t ulStartCycles;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the bins. */
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+			xHeapHasBeenInitialised = pdTRUE;
+		}
+
+		ulStartCycles = heapSTATS_TIMESTAMP();
+
+		/* The wanted size is increased so it can contain the size word, and
+		rounded up so the block can later hold its free list links and
+		footer. */
+		if( xWantedSize > 0 )
+		{
+			xWantedSize += heapSTRUCT_SIZE;
+
+			if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0 )
+			{
+				xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+			}
+
+			if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+			{
+				xWantedSize = heapMINIMUM_BLOCK_SIZE;
+			}
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
+		{
+			/* Look for the best fit within the bin the request maps to. */
+			uxBin = prvBinIndex( xWantedSize );
+
+			for( pxBlock = pxBins[ uxBin ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( heapBLOCK_SIZE( pxBlock ) >= xWantedSize )
+				{
+					break;
+				}
+			}
+
+			/* Otherwise the smallest block of the next populated bin is the
+			best fit, as every block in it is larger than the request. */
+			if( pxBlock == NULL )
+			{
+				ulCandidates = ulBinBitmap & ~( ( 2UL << uxBin ) - 1UL );
+
+				if( ulCandidates != 0UL )
+				{
+					pxBlock = pxBins[ __builtin_ctz( ulCandidates ) ];
+				}
+			}
+
+			if( pxBlock != NULL )
+			{
+				prvRemoveBlockFromBin( pxBlock );
+
+				/* If the block is larger than required it can be split into
+				two.  The remainder follows an allocated block, so its
+				heapPREV_ALLOCATED flag is set. */
+				if( ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) >= heapMINIMUM_BLOCK_SIZE )
+				{
+					pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+					pxNewBlockLink->xBlockSize = ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) | heapPREV_ALLOCATED;
+					heapFOOTER( pxNewBlockLink ) = heapBLOCK_SIZE( pxNewBlockLink );
+					prvInsertBlockIntoBin( pxNewBlockLink );
+
+					pxBlock->xBlockSize = xWantedSize | ( pxBlock->xBlockSize & heapPREV_ALLOCATED );
+				}
+				else
+				{
+					heapNEXT_PHYSICAL( pxBlock )->xBlockSize |= heapPREV_ALLOCATED;
+				}
+
+				pxBlock->xBlockSize |= heapBLOCK_ALLOCATED;
+				xFreeBytesRemaining -= heapBLOCK_SIZE( pxBlock );
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+
+				pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + heapSTRUCT_SIZE );
+			}
+		}
+
+		prvHeapStatsMalloc( &xHeapCounters, pvReturn, xWantedSize, ulStartCycles );
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	prvHeapUnlock( uxHeapLockState );
+	prvHeapWatchCheck();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+portHEAP_HOT_PATH void *pvPortMallocFlags( size_t xWantedSize, UBaseType_t uxFlags )
+{
+	/* There is only the one heap, in DMA capable SRAM. */
+	( void ) uxFlags;
+	return pvPortMalloc( xWantedSize );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseBlock( TaggedBlock_t *pxLink )
+{
+TaggedBlock_t *pxNeighbour;
+size_t xBlockSize = heapBLOCK_SIZE( pxLink );
+
+	/* Merge with the physically following block if it is free,
+	otherwise tell it that its predecessor is now free. */
+	pxNeighbour = heapNEXT_PHYSICAL( pxLink );
+
+	if( ( pxNeighbour->xBlockSize & heapBLOCK_ALLOCATED ) == 0 )
+	{
+		prvRemoveBlockFromBin( pxNeighbour );
+		xBlockSize += heapBLOCK_SIZE( pxNeighbour );
+	}
+	else
+	{
+		pxNeighbour->xBlockSize &= ~heapPREV_ALLOCATED;
+	}
+
+	/* Merge with the physically preceding block if it is free.  Its
+	footer sits in the word immediately before this block. */
+	if( ( pxLink->xBlockSize & heapPREV_ALLOCATED ) == 0 )
+	{
+		pxNeighbour = ( void * ) ( ( ( uint8_t * ) pxLink ) - * ( ( size_t * ) pxLink - 1 ) );
+		prvRemoveBlockFromBin( pxNeighbour );
+		xBlockSize += heapBLOCK_SIZE( pxNeighbour );
+		pxLink = pxNeighbour;
+	}
+
+	/* Two free blocks are never adjacent, so whatever precedes the
+	merged block is allocated. */
+	pxLink->xBlockSize = xBlockSize | heapPREV_ALLOCATED;
+	heapFOOTER( pxLink ) = xBlockSize;
+	prvInsertBlockIntoBin( pxLink );
+}
+/*-----------------------------------------------------------*/
+
+portHEAP_HOT_PATH void vPortFree( void *pv )
+{
+TaggedBlock_t *pxLink;
+size_t xFreedSize;
+uint32_t ulStartCycles;
+UBaseType_t uxHeapLockState;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have its size word immediately before
+		it.  The void cast keeps the compiler quiet about alignment. */
+		pxLink = ( void * ) ( ( ( uint8_t * ) pv ) - heapSTRUCT_SIZE );
+		configASSERT( ( pxLink->xBlockSize & heapBLOCK_ALLOCATED ) != 0 );
+
+		uxHeapLockState = prvHeapLock();
+		{
+			ulStartCycles = heapSTATS_TIMESTAMP();
+
+			xFreedSize = heapBLOCK_SIZE( pxLink );
+			prvReleaseBlock( pxLink );
+
+			xFreeBytesRemaining += xFreedSize;
+			prvHeapStatsFree( &xHeapCounters, ulStartCycles );
+			traceFREE( pv, xFreedSize );
+		}
+		prvHeapUnlock( uxHeapLockState );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvRequiredBlockSize( size_t xWantedSize )
+{
+	if( ( xWantedSize == 0 ) || ( xWantedSize >= ( configADJUSTED_HEAP_SIZE - heapSTRUCT_SIZE ) ) )
+	{
+		return 0;
+	}
+
+	/* Same rounding as pvPortMalloc(). */
+	xWantedSize += heapSTRUCT_SIZE;
+
+	if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0 )
+	{
+		xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+	}
+
+	if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+	{
+		xWantedSize = heapMINIMUM_BLOCK_SIZE;
+	}
+
+	return xWantedSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTrimBlock( TaggedBlock_t *pxBlock, size_t xBlockSize )
+{
+TaggedBlock_t *pxNewBlockLink;
+
+	if( ( heapBLOCK_SIZE( pxBlock ) - xBlockSize ) >= heapMINIMUM_BLOCK_SIZE )
+	{
+		/* The tail starts life as an allocated block following an allocated
+		block, and is then released like any other. */
+		pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xBlockSize );
+		pxNewBlockLink->xBlockSize = ( heapBLOCK_SIZE( pxBlock ) - xBlockSize ) | heapBLOCK_ALLOCATED | heapPREV_ALLOCATED;
+		pxBlock->xBlockSize = xBlockSize | ( pxBlock->xBlockSize & heapFLAG_MASK );
+
+		xFreeBytesRemaining += heapBLOCK_SIZE( pxNewBlockLink );
+		prvReleaseBlock( pxNewBlockLink );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortRealloc( void *pv, size_t xWantedSize )
+{
+TaggedBlock_t *pxLink, *pxNext;
+size_t xBlockSize, xOldSize;
+void *pvReturn = NULL;
+UBaseType_t uxHeapLockState;
+
+	if( pv == NULL )
+	{
+		return pvPortMalloc( xWantedSize );
+	}
+
+	if( xWantedSize == 0 )
+	{
+		vPortFree( pv );
+		return NULL;
+	}
+
+	pxLink = ( void * ) ( ( ( uint8_t * ) pv ) - heapSTRUCT_SIZE );
+	configASSERT( ( pxLink->xBlockSize & heapBLOCK_ALLOCATED ) != 0 );
+	xBlockSize = prvRequiredBlockSize( xWantedSize );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		xOldSize = heapBLOCK_SIZE( pxLink );
+
+		/* Grow in place by absorbing the physically following block when it
+		is free.  The end marker stops this at the end of the heap. */
+		pxNext = heapNEXT_PHYSICAL( pxLink );
+
+		if( ( xBlockSize > xOldSize ) && ( ( pxNext->xBlockSize & heapBLOCK_ALLOCATED ) == 0 ) && ( ( xOldSize + heapBLOCK_SIZE( pxNext ) ) >= xBlockSize ) )
+		{
+			prvRemoveBlockFromBin( pxNext );
+			xFreeBytesRemaining -= heapBLOCK_SIZE( pxNext );
+			pxLink->xBlockSize += heapBLOCK_SIZE( pxNext );
+			heapNEXT_PHYSICAL( pxLink )->xBlockSize |= heapPREV_ALLOCATED;
+		}
+
+		if( ( xBlockSize != 0 ) && ( xBlockSize <= heapBLOCK_SIZE( pxLink ) ) )
+		{
+			prvTrimBlock( pxLink, xBlockSize );
+
+			if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+			{
+				xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+			}
+
+			traceFREE( pv, xOldSize );
+			traceMALLOC( pv, heapBLOCK_SIZE( pxLink ) );
+			pvReturn = pv;
+		}
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	if( pvReturn == NULL )
+	{
+		/* The block has to move, or is too large for the heap, in which case
+		pvPortMalloc() fails and calls the malloc failed hook.  Either way it
+		is growing, so all of the old contents fit in the new block. */
+		pvReturn = pvPortMalloc( xWantedSize );
+
+		if( pvReturn != NULL )
+		{
+			portMEMCPY( pvReturn, pv, xOldSize - heapSTRUCT_SIZE );
+			vPortFree( pv );
+		}
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocAligned( size_t xWantedSize, size_t xAlignment, UBaseType_t uxFlags )
+{
+TaggedBlock_t *pxLink, *pxAlignedLink;
+uint8_t *pucBlock, *pucAligned;
+size_t xBlockSize, xLeading;
+UBaseType_t uxHeapLockState;
+
+	configASSERT( ( xAlignment & ( xAlignment - 1 ) ) == 0 );
+
+	xBlockSize = prvRequiredBlockSize( xWantedSize );
+
+	/* pvPortMalloc() already gives portBYTE_ALIGNMENT, and also deals with
+	requests that can never succeed. */
+	if( ( xAlignment <= portBYTE_ALIGNMENT ) || ( xBlockSize == 0 ) )
+	{
+		return pvPortMallocFlags( xWantedSize, uxFlags );
+	}
+
+	/* Allow for the worst case padding - up to xAlignment bytes to reach the
+	boundary, plus one more step of xAlignment if the gap is too small to be
+	given back as a free block.  The request is based on the rounded block
+	size so that it covers any minimum block size as well. */
+	pucBlock = pvPortMallocFlags( ( xBlockSize - heapSTRUCT_SIZE ) + xAlignment + heapMINIMUM_BLOCK_SIZE, uxFlags );
+
+	if( pucBlock == NULL )
+	{
+		return NULL;
+	}
+
+	pucAligned = ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) pucBlock + ( xAlignment - 1 ) ) & ~( ( portPOINTER_SIZE_TYPE ) xAlignment - 1 ) );
+
+	while( ( pucAligned != pucBlock ) && ( ( size_t ) ( pucAligned - pucBlock ) < heapMINIMUM_BLOCK_SIZE ) )
+	{
+		pucAligned += xAlignment;
+	}
+
+	xLeading = ( size_t ) ( pucAligned - pucBlock );
+	pxLink = ( void * ) ( pucBlock - heapSTRUCT_SIZE );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		traceFREE( pucBlock, heapBLOCK_SIZE( pxLink ) );
+
+		/* The padding in front of the aligned address is split off as a block
+		of its own and released, which also clears the heapPREV_ALLOCATED flag
+		of the aligned block. */
+		if( xLeading > 0 )
+		{
+			pxAlignedLink = ( void * ) ( pucAligned - heapSTRUCT_SIZE );
+			pxAlignedLink->xBlockSize = ( heapBLOCK_SIZE( pxLink ) - xLeading ) | heapBLOCK_ALLOCATED | heapPREV_ALLOCATED;
+			pxLink->xBlockSize = xLeading | ( pxLink->xBlockSize & heapFLAG_MASK );
+
+			xFreeBytesRemaining += xLeading;
+			prvReleaseBlock( pxLink );
+			pxLink = pxAlignedLink;
+		}
+
+		prvTrimBlock( pxLink, xBlockSize );
+		traceMALLOC( pucAligned, heapBLOCK_SIZE( pxLink ) );
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return pucAligned;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFreeBatch( void * const pvBlocks[], size_t xCount )
+{
+size_t x;
+
+	/* Boundary tags already free in constant time, so there is no list walk
+	to share between the blocks. */
+	for( x = 0; x < xCount; x++ )
+	{
+		vPortFree( pvBlocks[ x ] );
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+TaggedBlock_t *pxFirstFreeBlock, *pxEndMarker;
+uint8_t *pucAlignedHeap;
+size_t xUsableSize;
+
+	prvHeapStatsInit();
+
+	/* Ensure the heap starts on a correctly aligned boundary. */
+	pucAlignedHeap = ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) &ucHeap[ portBYTE_ALIGNMENT ] ) & ( ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) ) );
+
+	/* The last heapSTRUCT_SIZE bytes hold an end marker that looks like a
+	zero length allocated block, so the free path never merges past the end of
+	the heap. */
+	xUsableSize = ( configADJUSTED_HEAP_SIZE - heapSTRUCT_SIZE ) & ~portBYTE_ALIGNMENT_MASK;
+
+	pxEndMarker = ( void * ) ( pucAlignedHeap + xUsableSize );
+	pxEndMarker->xBlockSize = heapBLOCK_ALLOCATED;
+
+	/* To start with there is a single free block that is sized to take up
+	the entire heap space.  Nothing precedes it, so it is marked as following
+	an allocated block. */
+	pxFirstFreeBlock = ( void * ) pucAlignedHeap;
+	pxFirstFreeBlock->xBlockSize = xUsableSize | heapPREV_ALLOCATED;
+	heapFOOTER( pxFirstFreeBlock ) = xUsableSize;
+	prvInsertBlockIntoBin( pxFirstFreeBlock );
+
+	xFreeBytesRemaining = xUsableSize;
+	xMinimumEverFreeBytesRemaining = xUsableSize;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapSnapshot( HeapSnapshot_t *pxSnapshot, HeapBlockInfo_t *pxBlocks, size_t xMaxBlocks )
+{
+TaggedBlock_t *pxBlock;
+UBaseType_t uxBin;
+size_t xCount = 0;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		/* Walk the bins in order, which lists the free blocks smallest first
+		just like heap_2.c does. */
+		for( uxBin = 0; uxBin < heapNUMBER_OF_BINS; uxBin++ )
+		{
+			for( pxBlock = pxBins[ uxBin ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( xCount < xMaxBlocks )
+				{
+					pxBlocks[ xCount ].pvStartAddress = ( void * ) pxBlock;
+					pxBlocks[ xCount ].xBlockSize = heapBLOCK_SIZE( pxBlock );
+				}
+				xCount++;
+			}
+		}
+
+		pxSnapshot->xFreeBytesRemaining = xFreeBytesRemaining;
+		pxSnapshot->ulSequence = xHeapJournal.ulSequence;
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	pxSnapshot->xHeapSize = configADJUSTED_HEAP_SIZE;
+	pxSnapshot->xHeaderSize = heapSTRUCT_SIZE;
+	pxSnapshot->xNumberOfFreeBlocks = xCount;
+	pxSnapshot->xBlocksCaptured = ( xCount < xMaxBlocks ) ? xCount : xMaxBlocks;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortGetHeapChanges( uint32_t *pulSequence, HeapChange_t *pxChanges, size_t xMaxChanges, size_t *pxChangesCopied )
+{
+BaseType_t xReturn;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		xReturn = prvHeapJournalCopy( &xHeapJournal, pulSequence, pxChanges, xMaxChanges, pxChangesCopied );
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+TaggedBlock_t *pxBlock;
+UBaseType_t uxBin;
+UBaseType_t uxHeapLockState;
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+	pxHeapStats->xNumberOfFreeBlocks = 0;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		for( uxBin = 0; uxBin < heapNUMBER_OF_BINS; uxBin++ )
+		{
+			for( pxBlock = pxBins[ uxBin ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				prvHeapStatsAddFreeBlock( pxHeapStats, heapBLOCK_SIZE( pxBlock ) );
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		prvHeapStatsCopy( &xHeapCounters, pxHeapStats );
+	}
+	prvHeapUnlock( uxHeapLockState );
+}
+
+#endif /* configHEAP_IMPLEMENTATION */
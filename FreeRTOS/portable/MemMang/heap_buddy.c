@@ -0,0 +1,352 @@
+/*
+ * A binary buddy allocator over a region of its own, for power of two
+ * buffers - packets, DMA and audio blocks - kept apart from the general heap.
+ *
+ * Mixed in with task stacks and odd sized objects on one free list, buffers
+ * of 64 to 1024 bytes leave gaps nothing else fits.  Here the region is
+ * configBUDDY_HEAP_TOP_BLOCKS blocks of 2^configBUDDY_HEAP_MAX_BLOCK_ORDER
+ * bytes, each of which splits in halves down to
+ * 2^configBUDDY_HEAP_MIN_BLOCK_ORDER bytes.  A request is rounded up to the
+ * next power of two, so every block is aligned to its own size, and a freed
+ * block merges with its buddy - the other half of the block it was split
+ * from - whenever that is free too, so the region never fragments below the
+ * size of the largest block still in use.
+ *
+ * The blocks carry no header.  The state is two bitmaps over the nodes of
+ * the split trees, one bit per possible block of every size: free, and split
+ * into halves.  A block in use is a node that is neither, under a split
+ * parent.  Allocation takes the first free node at the smallest level that
+ * has one and splits it down, free finds the block by following the split
+ * bits from its top block and merges it back up, so both are O(levels), plus
+ * one pass over the words of a single level's bitmap.  A count of free nodes
+ * per level skips the empty levels without looking at the bitmaps.
+ *
+ * The state is protected by masking interrupts up to
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY, as in mempool.h, so the allocator can
+ * be used from tasks and interrupts alike.  The region is static, in SRAM so
+ * DMA can reach it, and is set up by the first call.
+ *
+ * Enabled by configUSE_BUDDY_HEAP, alongside whichever general heap
+ * configHEAP_IMPLEMENTATION selects.
+ */
+#include <stddef.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_BUDDY_HEAP == 1 )
+
+#if( ( 1UL << configBUDDY_HEAP_MIN_BLOCK_ORDER ) < portBYTE_ALIGNMENT )
+	#error configBUDDY_HEAP_MIN_BLOCK_ORDER gives blocks smaller than portBYTE_ALIGNMENT
+#endif
+
+#if( ( configBUDDY_HEAP_MAX_BLOCK_ORDER < configBUDDY_HEAP_MIN_BLOCK_ORDER ) || ( ( configBUDDY_HEAP_MAX_BLOCK_ORDER - configBUDDY_HEAP_MIN_BLOCK_ORDER ) > 15 ) )
+	#error configBUDDY_HEAP_MAX_BLOCK_ORDER must be 0 to 15 orders above configBUDDY_HEAP_MIN_BLOCK_ORDER
+#endif
+
+#if( configBUDDY_HEAP_TOP_BLOCKS < 1 )
+	#error configBUDDY_HEAP_TOP_BLOCKS must be at least 1
+#endif
+
+/* Level 0 holds the top blocks, level heapBUDDY_LEVELS - 1 the smallest. */
+#define heapBUDDY_LEVELS			( ( UBaseType_t ) ( configBUDDY_HEAP_MAX_BLOCK_ORDER - configBUDDY_HEAP_MIN_BLOCK_ORDER + 1 ) )
+#define heapBUDDY_MAX_BLOCK			( ( size_t ) 1 << configBUDDY_HEAP_MAX_BLOCK_ORDER )
+#define heapBUDDY_REGION_SIZE		( heapBUDDY_MAX_BLOCK * ( size_t ) configBUDDY_HEAP_TOP_BLOCKS )
+#define heapBUDDY_BLOCK_SIZE( uxLevel )	( heapBUDDY_MAX_BLOCK >> ( uxLevel ) )
+
+/* The nodes of level uxLevel are numbered from heapBUDDY_FIRST( uxLevel ), so
+the node of block x on that level is heapBUDDY_FIRST( uxLevel ) + x, and its
+halves are blocks 2x and 2x + 1 of the level below. */
+#define heapBUDDY_FIRST( uxLevel )	( ( UBaseType_t ) configBUDDY_HEAP_TOP_BLOCKS * ( ( ( UBaseType_t ) 1 << ( uxLevel ) ) - 1U ) )
+#define heapBUDDY_COUNT( uxLevel )	( ( UBaseType_t ) configBUDDY_HEAP_TOP_BLOCKS << ( uxLevel ) )
+#define heapBUDDY_NODES				heapBUDDY_FIRST( heapBUDDY_LEVELS )
+#define heapBUDDY_WORDS				( ( heapBUDDY_NODES + 31U ) / 32U )
+
+/* __builtin_clz()/__builtin_ctz() compile to CLZ (plus RBIT) on the
+Cortex-M4, as in heap_tlsf.c. */
+#define heapFLS( x )	( ( UBaseType_t ) ( 31 - __builtin_clz( ( unsigned int ) ( x ) ) ) )
+#define heapFFS( x )	( ( UBaseType_t ) __builtin_ctz( ( unsigned int ) ( x ) ) )
+
+/* The region, aligned to its top block size so every block is aligned to its
+own.  Nothing reads it before it is allocated, so it is not cleared. */
+static uint8_t ucBuddyRegion[ heapBUDDY_REGION_SIZE ] __attribute__( ( section( ".noinit.buddy_heap" ), aligned( heapBUDDY_MAX_BLOCK ) ) );
+
+/* One bit per node: free, and split into halves. */
+static uint32_t ulFreeNodes[ heapBUDDY_WORDS ];
+static uint32_t ulSplitNodes[ heapBUDDY_WORDS ];
+
+/* Free nodes on each level. */
+static UBaseType_t uxFreeBlocks[ heapBUDDY_LEVELS ];
+
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+static size_t xSuccessfulAllocations = 0U;
+static size_t xFailedAllocations = 0U;
+static size_t xSuccessfulFrees = 0U;
+
+static BaseType_t xBuddyInitialised = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Mark every top block free.
+ */
+static void prvBuddyInit( void );
+
+/*
+ * The level of the smallest block that holds xWantedSize bytes, which must be
+ * 1 to heapBUDDY_MAX_BLOCK.
+ */
+static UBaseType_t prvLevelForSize( size_t xWantedSize ) portHEAP_HOT_PATH;
+
+/*
+ * The first free block on uxLevel, which must have one.
+ */
+static UBaseType_t prvFirstFree( UBaseType_t uxLevel ) portHEAP_HOT_PATH;
+
+static BaseType_t prvTestBit( const uint32_t *pulBits, UBaseType_t uxNode ) portHEAP_HOT_PATH;
+static void prvSetBit( uint32_t *pulBits, UBaseType_t uxNode ) portHEAP_HOT_PATH;
+static void prvClearBit( uint32_t *pulBits, UBaseType_t uxNode ) portHEAP_HOT_PATH;
+
+/*-----------------------------------------------------------*/
+
+void *pvPortBuddyMalloc( size_t xWantedSize )
+{
+UBaseType_t uxSavedInterruptStatus;
+UBaseType_t uxLevel, uxFrom, uxBlock;
+void *pvReturn = NULL;
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		if( xBuddyInitialised == pdFALSE )
+		{
+			prvBuddyInit();
+		}
+
+		if( ( xWantedSize > 0U ) && ( xWantedSize <= heapBUDDY_MAX_BLOCK ) )
+		{
+			uxLevel = prvLevelForSize( xWantedSize );
+
+			/* The smallest free block at least as large. */
+			uxFrom = uxLevel + 1U;
+			do
+			{
+				uxFrom--;
+			} while( ( uxFreeBlocks[ uxFrom ] == 0U ) && ( uxFrom > 0U ) );
+
+			if( uxFreeBlocks[ uxFrom ] != 0U )
+			{
+				uxBlock = prvFirstFree( uxFrom );
+				prvClearBit( ulFreeNodes, heapBUDDY_FIRST( uxFrom ) + uxBlock );
+				uxFreeBlocks[ uxFrom ]--;
+
+				/* Split it down, keeping the lower half each time and freeing
+				the upper one. */
+				while( uxFrom < uxLevel )
+				{
+					prvSetBit( ulSplitNodes, heapBUDDY_FIRST( uxFrom ) + uxBlock );
+					uxFrom++;
+					uxBlock <<= 1;
+					prvSetBit( ulFreeNodes, heapBUDDY_FIRST( uxFrom ) + uxBlock + 1U );
+					uxFreeBlocks[ uxFrom ]++;
+				}
+
+				pvReturn = &( ucBuddyRegion[ ( size_t ) uxBlock * heapBUDDY_BLOCK_SIZE( uxLevel ) ] );
+
+				xFreeBytesRemaining -= heapBUDDY_BLOCK_SIZE( uxLevel );
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				xSuccessfulAllocations++;
+			}
+		}
+
+		if( pvReturn == NULL )
+		{
+			xFailedAllocations++;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	traceMALLOC( pvReturn, xWantedSize );
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortBuddyFree( void *pv )
+{
+UBaseType_t uxSavedInterruptStatus;
+UBaseType_t uxLevel = 0U, uxBlock;
+size_t xOffset;
+
+	if( pv == NULL )
+	{
+		return;
+	}
+
+	/* Blocks from pvPortMalloc() must go back through vPortFree(). */
+	configASSERT( xPortBuddyContains( pv ) != pdFALSE );
+
+	xOffset = ( size_t ) ( ( uint8_t * ) pv - ucBuddyRegion );
+	uxBlock = ( UBaseType_t ) ( xOffset / heapBUDDY_MAX_BLOCK );
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		/* Down from the top block to the one in use. */
+		while( prvTestBit( ulSplitNodes, heapBUDDY_FIRST( uxLevel ) + uxBlock ) != pdFALSE )
+		{
+			uxLevel++;
+			uxBlock = ( UBaseType_t ) ( xOffset / heapBUDDY_BLOCK_SIZE( uxLevel ) );
+		}
+
+		/* Not the start of a block in use, or freed twice. */
+		configASSERT( ( xOffset & ( heapBUDDY_BLOCK_SIZE( uxLevel ) - 1U ) ) == 0U );
+		configASSERT( prvTestBit( ulFreeNodes, heapBUDDY_FIRST( uxLevel ) + uxBlock ) == pdFALSE );
+
+		xFreeBytesRemaining += heapBUDDY_BLOCK_SIZE( uxLevel );
+		xSuccessfulFrees++;
+
+		/* Merge with the buddy for as long as it is free. */
+		while( ( uxLevel > 0U ) && ( prvTestBit( ulFreeNodes, heapBUDDY_FIRST( uxLevel ) + ( uxBlock ^ 1U ) ) != pdFALSE ) )
+		{
+			prvClearBit( ulFreeNodes, heapBUDDY_FIRST( uxLevel ) + ( uxBlock ^ 1U ) );
+			uxFreeBlocks[ uxLevel ]--;
+			uxLevel--;
+			uxBlock >>= 1;
+			prvClearBit( ulSplitNodes, heapBUDDY_FIRST( uxLevel ) + uxBlock );
+		}
+
+		prvSetBit( ulFreeNodes, heapBUDDY_FIRST( uxLevel ) + uxBlock );
+		uxFreeBlocks[ uxLevel ]++;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	traceFREE( pv, heapBUDDY_BLOCK_SIZE( uxLevel ) );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortBuddyContains( const void *pv )
+{
+const uint8_t *pucBlock = ( const uint8_t * ) pv;
+
+	return ( ( pucBlock >= ucBuddyRegion ) && ( pucBlock < &( ucBuddyRegion[ heapBUDDY_REGION_SIZE ] ) ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetBuddyHeapStats( BuddyHeapStats_t *pxStats )
+{
+UBaseType_t uxSavedInterruptStatus;
+UBaseType_t uxLevel;
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		if( xBuddyInitialised == pdFALSE )
+		{
+			prvBuddyInit();
+		}
+
+		pxStats->xRegionSize = heapBUDDY_REGION_SIZE;
+		pxStats->xFreeBytes = xFreeBytesRemaining;
+		pxStats->xMinimumEverFreeBytes = xMinimumEverFreeBytesRemaining;
+		pxStats->xLargestFreeBlock = 0U;
+		pxStats->xSuccessfulAllocations = xSuccessfulAllocations;
+		pxStats->xFailedAllocations = xFailedAllocations;
+		pxStats->xSuccessfulFrees = xSuccessfulFrees;
+
+		for( uxLevel = 0U; uxLevel < heapBUDDY_LEVELS; uxLevel++ )
+		{
+			if( uxFreeBlocks[ uxLevel ] != 0U )
+			{
+				pxStats->xLargestFreeBlock = heapBUDDY_BLOCK_SIZE( uxLevel );
+				break;
+			}
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBuddyInit( void )
+{
+UBaseType_t uxBlock;
+
+	for( uxBlock = 0U; uxBlock < configBUDDY_HEAP_TOP_BLOCKS; uxBlock++ )
+	{
+		prvSetBit( ulFreeNodes, uxBlock );
+	}
+	uxFreeBlocks[ 0 ] = configBUDDY_HEAP_TOP_BLOCKS;
+
+	xFreeBytesRemaining = heapBUDDY_REGION_SIZE;
+	xMinimumEverFreeBytesRemaining = heapBUDDY_REGION_SIZE;
+	xBuddyInitialised = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvLevelForSize( size_t xWantedSize )
+{
+UBaseType_t uxOrder = configBUDDY_HEAP_MIN_BLOCK_ORDER;
+
+	if( xWantedSize > ( ( size_t ) 1 << configBUDDY_HEAP_MIN_BLOCK_ORDER ) )
+	{
+		/* The power of two at or above xWantedSize. */
+		uxOrder = heapFLS( xWantedSize - 1U ) + 1U;
+	}
+
+	return ( UBaseType_t ) configBUDDY_HEAP_MAX_BLOCK_ORDER - uxOrder;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvFirstFree( UBaseType_t uxLevel )
+{
+UBaseType_t uxNode = heapBUDDY_FIRST( uxLevel );
+UBaseType_t uxEnd = uxNode + heapBUDDY_COUNT( uxLevel );
+uint32_t ulWord;
+
+	/* A level's nodes need not start or end on a word boundary, so the bits
+	of the first word below it are masked off, and the search stops at its
+	end. */
+	ulWord = ulFreeNodes[ uxNode / 32U ] & ( 0xFFFFFFFFUL << ( uxNode % 32U ) );
+
+	while( ulWord == 0U )
+	{
+		uxNode = ( ( uxNode / 32U ) + 1U ) * 32U;
+		configASSERT( uxNode < uxEnd );
+		ulWord = ulFreeNodes[ uxNode / 32U ];
+	}
+
+	uxNode = ( ( uxNode / 32U ) * 32U ) + heapFFS( ulWord );
+	configASSERT( uxNode < uxEnd );
+	( void ) uxEnd;
+
+	return uxNode - heapBUDDY_FIRST( uxLevel );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTestBit( const uint32_t *pulBits, UBaseType_t uxNode )
+{
+	return ( ( pulBits[ uxNode / 32U ] & ( 1UL << ( uxNode % 32U ) ) ) != 0U ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetBit( uint32_t *pulBits, UBaseType_t uxNode )
+{
+	pulBits[ uxNode / 32U ] |= 1UL << ( uxNode % 32U );
+}
+/*-----------------------------------------------------------*/
+
+static void prvClearBit( uint32_t *pulBits, UBaseType_t uxNode )
+{
+	pulBits[ uxNode / 32U ] &= ~( 1UL << ( uxNode % 32U ) );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_BUDDY_HEAP */
@@ -0,0 +1,471 @@
+/*
+ * Movable allocations reached through handles, from a region of their own
+ * that the idle task compacts.
+ *
+ * Coalescing only joins free blocks that touch, so a long lived block left
+ * between two free ones keeps them apart however long the device runs.
+ * Blocks from xHeapHandleAlloc() are not addressed directly: the owner locks
+ * the handle to get a pointer, uses it, and unlocks it again, and while a
+ * block is unlocked xPortHeapCompactStep() may slide it down over the free
+ * space below it and update the handle.  Free space so collects at the top of
+ * the region, where it is one block.  Log and cache buffers, which are large
+ * and only touched now and then, are the intended users.
+ *
+ * Blocks tile the region in address order, each starting with a header that
+ * gives its size and the handle that owns it, NULL for a free block.
+ * Allocation is first fit along that chain, merging free neighbours as it
+ * goes; when nothing fits the region is compacted completely and searched
+ * again.  Each compaction step moves at most one block, with the heap
+ * locked, starting from a cursor below which only locked blocks hold free
+ * space apart.  A locked block stays where it is, and the free space below it
+ * is found again once it is unlocked.
+ *
+ * The handles themselves are the entries of a fixed table, so a handle never
+ * moves.  Everything is called from tasks only, and takes the same lock as
+ * the general heap, see heap_stats.h.
+ *
+ * Enabled by configUSE_HEAP_HANDLES, alongside whichever general heap
+ * configHEAP_IMPLEMENTATION selects.  The idle task calls
+ * xPortHeapCompactStep() every time round its loop.
+ */
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_HEAP_HANDLES == 1 )
+
+#include "heap_stats.h"
+
+#if( ( configHEAP_HANDLE_REGION_SIZE & portBYTE_ALIGNMENT_MASK ) != 0 )
+	#error configHEAP_HANDLE_REGION_SIZE must be a multiple of portBYTE_ALIGNMENT
+#endif
+
+/* The header at the start of every block. */
+typedef struct xHANDLE_BLOCK
+{
+	size_t xBlockSize;					/*<< Header included. */
+	struct xHEAP_HANDLE *pxHandle;		/*<< Owner, NULL while the block is free. */
+} HandleBlock_t;
+
+/* One entry of the handle table. */
+struct xHEAP_HANDLE
+{
+	HandleBlock_t *pxBlock;				/*<< NULL while the entry is unused. */
+	UBaseType_t uxLocks;
+};
+
+#define heapHANDLE_HEADER_SIZE		( ( sizeof( HandleBlock_t ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define heapHANDLE_MINIMUM_BLOCK	( heapHANDLE_HEADER_SIZE * 2U )
+
+#define heapHANDLE_NEXT( pxBlock )	( ( HandleBlock_t * ) ( ( uint8_t * ) ( pxBlock ) + ( pxBlock )->xBlockSize ) )
+#define heapHANDLE_DATA( pxBlock )	( ( void * ) ( ( uint8_t * ) ( pxBlock ) + heapHANDLE_HEADER_SIZE ) )
+
+/* The region.  It is only read once written, so it is not cleared. */
+static uint8_t ucHandleRegion[ configHEAP_HANDLE_REGION_SIZE ] __attribute__( ( section( ".noinit.handle_heap" ), aligned( portBYTE_ALIGNMENT ) ) );
+#define heapHANDLE_REGION_END		( ( HandleBlock_t * ) &( ucHandleRegion[ configHEAP_HANDLE_REGION_SIZE ] ) )
+
+static struct xHEAP_HANDLE xHandles[ configHEAP_HANDLES ];
+
+/* Every block below the cursor is in use, or free but held apart from the
+blocks above it by a locked one. */
+static HandleBlock_t *pxCompactCursor = NULL;
+
+/* Set when a step passed a locked block, so unlocking it moves the cursor
+back to the bottom of the region. */
+static BaseType_t xPassedLockedBlock = pdFALSE;
+
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+static size_t xFailedAllocations = 0U;
+static size_t xBytesMoved = 0U;
+static size_t xBlocksMoved = 0U;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Make the whole region one free block.
+ */
+static void prvHandleHeapInit( void );
+
+/*
+ * Join pxBlock, which is free, with any free blocks that follow it.
+ */
+static void prvMergeFollowing( HandleBlock_t *pxBlock );
+
+/*
+ * First fit for xBlockSize bytes, header included, or NULL.
+ */
+static HandleBlock_t *prvFindFreeBlock( size_t xBlockSize );
+
+/*
+ * Move one block down over the free space below it.  Returns pdTRUE once no
+ * block can be moved.  Called with the heap locked.
+ */
+static BaseType_t prvCompactStep( void );
+
+/*-----------------------------------------------------------*/
+
+HeapHandle_t xHeapHandleAlloc( size_t xWantedSize )
+{
+HeapHandle_t xHandle = NULL;
+HandleBlock_t *pxBlock = NULL, *pxRest;
+size_t xBlockSize = 0U;
+UBaseType_t ux;
+UBaseType_t uxHeapLockState;
+
+	if( ( xWantedSize > 0U ) && ( xWantedSize <= ( configHEAP_HANDLE_REGION_SIZE - heapHANDLE_HEADER_SIZE ) ) )
+	{
+		xBlockSize = ( xWantedSize + heapHANDLE_HEADER_SIZE + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+	}
+
+	uxHeapLockState = prvHeapLock();
+	{
+		if( pxCompactCursor == NULL )
+		{
+			prvHandleHeapInit();
+		}
+
+		for( ux = 0U; ( ux < configHEAP_HANDLES ) && ( xBlockSize > 0U ); ux++ )
+		{
+			if( xHandles[ ux ].pxBlock == NULL )
+			{
+				xHandle = &( xHandles[ ux ] );
+				break;
+			}
+		}
+
+		if( ( xHandle != NULL ) && ( xBlockSize <= xFreeBytesRemaining ) )
+		{
+			pxBlock = prvFindFreeBlock( xBlockSize );
+
+			if( pxBlock == NULL )
+			{
+				/* Enough bytes, but not together. */
+				while( prvCompactStep() == pdFALSE )
+				{
+				}
+
+				pxBlock = prvFindFreeBlock( xBlockSize );
+			}
+		}
+
+		if( pxBlock != NULL )
+		{
+			if( ( pxBlock->xBlockSize - xBlockSize ) >= heapHANDLE_MINIMUM_BLOCK )
+			{
+				pxRest = ( HandleBlock_t * ) ( ( uint8_t * ) pxBlock + xBlockSize );
+				pxRest->xBlockSize = pxBlock->xBlockSize - xBlockSize;
+				pxRest->pxHandle = NULL;
+				pxBlock->xBlockSize = xBlockSize;
+			}
+
+			pxBlock->pxHandle = xHandle;
+			xHandle->pxBlock = pxBlock;
+			xHandle->uxLocks = 0U;
+
+			xFreeBytesRemaining -= pxBlock->xBlockSize;
+			if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+			{
+				xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+			}
+		}
+		else
+		{
+			xHandle = NULL;
+			xFailedAllocations++;
+		}
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	traceMALLOC( ( xHandle != NULL ) ? heapHANDLE_DATA( pxBlock ) : NULL, xWantedSize );
+
+	return xHandle;
+}
+/*-----------------------------------------------------------*/
+
+void vHeapHandleFree( HeapHandle_t xHandle )
+{
+HandleBlock_t *pxBlock;
+UBaseType_t uxHeapLockState;
+
+	if( xHandle == NULL )
+	{
+		return;
+	}
+
+	uxHeapLockState = prvHeapLock();
+	{
+		pxBlock = xHandle->pxBlock;
+
+		/* Freed twice, or freed while a pointer to it is still in use. */
+		configASSERT( pxBlock != NULL );
+		configASSERT( xHandle->uxLocks == 0U );
+
+		traceFREE( heapHANDLE_DATA( pxBlock ), pxBlock->xBlockSize );
+
+		xFreeBytesRemaining += pxBlock->xBlockSize;
+		pxBlock->pxHandle = NULL;
+		xHandle->pxBlock = NULL;
+		prvMergeFollowing( pxBlock );
+
+		if( pxBlock < pxCompactCursor )
+		{
+			pxCompactCursor = pxBlock;
+		}
+	}
+	prvHeapUnlock( uxHeapLockState );
+}
+/*-----------------------------------------------------------*/
+
+void *pvHeapHandleLock( HeapHandle_t xHandle )
+{
+void *pvReturn;
+UBaseType_t uxHeapLockState;
+
+	configASSERT( xHandle != NULL );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		configASSERT( xHandle->pxBlock != NULL );
+
+		xHandle->uxLocks++;
+		pvReturn = heapHANDLE_DATA( xHandle->pxBlock );
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vHeapHandleUnlock( HeapHandle_t xHandle )
+{
+UBaseType_t uxHeapLockState;
+
+	configASSERT( xHandle != NULL );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		configASSERT( xHandle->uxLocks > 0U );
+
+		xHandle->uxLocks--;
+
+		if( ( xHandle->uxLocks == 0U ) && ( xPassedLockedBlock != pdFALSE ) )
+		{
+			/* The free space below this block, or another that was locked,
+			can be filled now. */
+			pxCompactCursor = ( HandleBlock_t * ) ucHandleRegion;
+			xPassedLockedBlock = pdFALSE;
+		}
+	}
+	prvHeapUnlock( uxHeapLockState );
+}
+/*-----------------------------------------------------------*/
+
+size_t xHeapHandleGetSize( HeapHandle_t xHandle )
+{
+size_t xReturn;
+UBaseType_t uxHeapLockState;
+
+	configASSERT( xHandle != NULL );
+
+	/* Locked, as the header may be on its way to another address. */
+	uxHeapLockState = prvHeapLock();
+	{
+		configASSERT( xHandle->pxBlock != NULL );
+
+		xReturn = xHandle->pxBlock->xBlockSize - heapHANDLE_HEADER_SIZE;
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortHeapCompactStep( void )
+{
+BaseType_t xDone = pdTRUE;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		if( pxCompactCursor != NULL )
+		{
+			xDone = prvCompactStep();
+		}
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return xDone;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapHandleStats( HeapHandleStats_t *pxStats )
+{
+HandleBlock_t *pxBlock;
+UBaseType_t ux;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		if( pxCompactCursor == NULL )
+		{
+			prvHandleHeapInit();
+		}
+
+		pxStats->xRegionSize = configHEAP_HANDLE_REGION_SIZE;
+		pxStats->xFreeBytes = xFreeBytesRemaining;
+		pxStats->xMinimumEverFreeBytes = xMinimumEverFreeBytesRemaining;
+		pxStats->xLargestFreeBlock = 0U;
+		pxStats->xFreeBlocks = 0U;
+		pxStats->uxHandlesInUse = 0U;
+		pxStats->xFailedAllocations = xFailedAllocations;
+		pxStats->xBytesMoved = xBytesMoved;
+		pxStats->xBlocksMoved = xBlocksMoved;
+
+		for( pxBlock = ( HandleBlock_t * ) ucHandleRegion; pxBlock < heapHANDLE_REGION_END; pxBlock = heapHANDLE_NEXT( pxBlock ) )
+		{
+			if( pxBlock->pxHandle == NULL )
+			{
+				prvMergeFollowing( pxBlock );
+				pxStats->xFreeBlocks++;
+
+				/* Less its header, as for a request. */
+				if( ( pxBlock->xBlockSize - heapHANDLE_HEADER_SIZE ) > pxStats->xLargestFreeBlock )
+				{
+					pxStats->xLargestFreeBlock = pxBlock->xBlockSize - heapHANDLE_HEADER_SIZE;
+				}
+			}
+		}
+
+		for( ux = 0U; ux < configHEAP_HANDLES; ux++ )
+		{
+			if( xHandles[ ux ].pxBlock != NULL )
+			{
+				pxStats->uxHandlesInUse++;
+			}
+		}
+	}
+	prvHeapUnlock( uxHeapLockState );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHandleHeapInit( void )
+{
+HandleBlock_t *pxBlock = ( HandleBlock_t * ) ucHandleRegion;
+
+	pxBlock->xBlockSize = configHEAP_HANDLE_REGION_SIZE;
+	pxBlock->pxHandle = NULL;
+
+	pxCompactCursor = pxBlock;
+	xFreeBytesRemaining = configHEAP_HANDLE_REGION_SIZE;
+	xMinimumEverFreeBytesRemaining = configHEAP_HANDLE_REGION_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMergeFollowing( HandleBlock_t *pxBlock )
+{
+HandleBlock_t *pxNext = heapHANDLE_NEXT( pxBlock );
+
+	while( ( pxNext < heapHANDLE_REGION_END ) && ( pxNext->pxHandle == NULL ) )
+	{
+		/* The cursor must stay on a block boundary. */
+		if( pxCompactCursor == pxNext )
+		{
+			pxCompactCursor = pxBlock;
+		}
+
+		pxBlock->xBlockSize += pxNext->xBlockSize;
+		pxNext = heapHANDLE_NEXT( pxBlock );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static HandleBlock_t *prvFindFreeBlock( size_t xBlockSize )
+{
+HandleBlock_t *pxBlock;
+
+	for( pxBlock = ( HandleBlock_t * ) ucHandleRegion; pxBlock < heapHANDLE_REGION_END; pxBlock = heapHANDLE_NEXT( pxBlock ) )
+	{
+		if( pxBlock->pxHandle == NULL )
+		{
+			prvMergeFollowing( pxBlock );
+
+			if( pxBlock->xBlockSize >= xBlockSize )
+			{
+				return pxBlock;
+			}
+		}
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCompactStep( void )
+{
+HandleBlock_t *pxFree = pxCompactCursor, *pxMove;
+size_t xFreeSize, xMoveSize;
+
+	for( ;; )
+	{
+		/* The next free block at or above the cursor. */
+		while( ( pxFree < heapHANDLE_REGION_END ) && ( pxFree->pxHandle != NULL ) )
+		{
+			pxFree = heapHANDLE_NEXT( pxFree );
+		}
+
+		pxCompactCursor = pxFree;
+
+		if( pxFree >= heapHANDLE_REGION_END )
+		{
+			return pdTRUE;
+		}
+
+		prvMergeFollowing( pxFree );
+		pxMove = heapHANDLE_NEXT( pxFree );
+
+		if( pxMove >= heapHANDLE_REGION_END )
+		{
+			/* The free space is all at the top. */
+			return pdTRUE;
+		}
+
+		if( pxMove->pxHandle->uxLocks == 0U )
+		{
+			break;
+		}
+
+		/* Pinned; try the free space above it. */
+		xPassedLockedBlock = pdTRUE;
+		pxFree = heapHANDLE_NEXT( pxMove );
+	}
+
+	/* Slide the block down, header and all, and put the free space above
+	it. */
+	xFreeSize = pxFree->xBlockSize;
+	xMoveSize = pxMove->xBlockSize;
+	( void ) memmove( pxFree, pxMove, xMoveSize );
+	pxFree->pxHandle->pxBlock = pxFree;
+
+	pxMove = heapHANDLE_NEXT( pxFree );
+	pxMove->xBlockSize = xFreeSize;
+	pxMove->pxHandle = NULL;
+	prvMergeFollowing( pxMove );
+	pxCompactCursor = pxMove;
+
+	xBytesMoved += xMoveSize;
+	xBlocksMoved++;
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_HEAP_HANDLES */
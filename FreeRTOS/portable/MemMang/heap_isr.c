@@ -0,0 +1,130 @@
+/*
+ * Fixed size allocation for interrupt handlers, shared by every allocator in
+ * portable/MemMang.
+ *
+ * pvPortMalloc() locks the heap against other tasks, which an interrupt
+ * cannot do, so an interrupt that needs a fresh buffer has had to defer to a
+ * task.  pvPortMallocFromISR() instead serves fixed size blocks from the
+ * mempool.h pools listed in configISR_HEAP_POOLS, whose push and pop only
+ * mask interrupts for a few instructions.  The storage for the pools is
+ * taken from the heap once, DMA capable, by xPortInitialiseISRPools() and is
+ * never returned, so it does not fragment the heap.
+ */
+#include <stddef.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mempool.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_ISR_HEAP_POOLS == 1 )
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error heap_isr.c takes the storage for its pools from the heap, so configSUPPORT_DYNAMIC_ALLOCATION must be 1
+#endif
+
+/* One pool per entry of configISR_HEAP_POOLS, which lists
+{ block size in bytes, number of blocks } pairs with the smallest size first. */
+typedef struct xISR_POOL_CONFIG
+{
+	size_t xBlockSize;
+	UBaseType_t uxBlocks;
+} ISRPoolConfig_t;
+
+static const ISRPoolConfig_t xISRPoolConfig[] = configISR_HEAP_POOLS;
+#define heapISR_POOL_COUNT		( sizeof( xISRPoolConfig ) / sizeof( xISRPoolConfig[ 0 ] ) )
+
+static MemPool_t xISRPools[ heapISR_POOL_COUNT ];
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortInitialiseISRPools( void )
+{
+size_t xPool;
+void *pvStorage;
+BaseType_t xReturn = pdPASS;
+
+	for( xPool = 0; xPool < heapISR_POOL_COUNT; xPool++ )
+	{
+		/* The classes must be listed smallest first for the search in
+		pvPortMallocFromISR() to pick the tightest fit. */
+		configASSERT( ( xPool == 0 ) || ( xISRPoolConfig[ xPool - 1 ].xBlockSize < xISRPoolConfig[ xPool ].xBlockSize ) );
+
+		/* Interrupt buffers are usually DMA buffers. */
+		pvStorage = pvPortMallocFlags( mempoolSTORAGE_SIZE( xISRPoolConfig[ xPool ].xBlockSize, xISRPoolConfig[ xPool ].uxBlocks ), heapALLOC_DMA_CAPABLE );
+
+		if( pvStorage == NULL )
+		{
+			/* Left as an empty pool, so allocations fall through to the next
+			class. */
+			xReturn = pdFAIL;
+		}
+
+		vMemPoolInit( &( xISRPools[ xPool ] ), pvStorage, xISRPoolConfig[ xPool ].xBlockSize, xISRPoolConfig[ xPool ].uxBlocks );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocFromISR( size_t xWantedSize )
+{
+size_t xPool;
+void *pvReturn = NULL;
+
+	/* The smallest class that fits, or the next one up if that is empty. */
+	for( xPool = 0; ( xPool < heapISR_POOL_COUNT ) && ( pvReturn == NULL ); xPool++ )
+	{
+		if( xWantedSize <= xISRPoolConfig[ xPool ].xBlockSize )
+		{
+			pvReturn = pvMemPoolAlloc( &( xISRPools[ xPool ] ) );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+	traceMALLOC( pvReturn, xWantedSize );
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFreeFromISR( void *pv )
+{
+size_t xPool;
+
+	if( pv != NULL )
+	{
+		for( xPool = 0; xPool < heapISR_POOL_COUNT; xPool++ )
+		{
+			if( xMemPoolContains( &( xISRPools[ xPool ] ), pv ) != pdFALSE )
+			{
+				vMemPoolFree( &( xISRPools[ xPool ] ), pv );
+				traceFREE( pv, xISRPools[ xPool ].xBlockSize );
+				break;
+			}
+		}
+
+		/* Blocks from pvPortMalloc() must go back through vPortFree(). */
+		configASSERT( xPool < heapISR_POOL_COUNT );
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortGetISRPoolMinimumFreeBlocks( size_t xPool )
+{
+	configASSERT( xPool < heapISR_POOL_COUNT );
+
+	return uxMemPoolGetMinimumFreeBlocks( &( xISRPools[ xPool ] ) );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_ISR_HEAP_POOLS */
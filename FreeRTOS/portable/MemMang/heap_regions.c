@@ -0,0 +1,1355 @@
+/*
+ * A multi-region variant of heap_2.c in the style of heap_5.c.  The heap is
+ * made of up to heapMAX_REGIONS separate blocks of RAM, each with its own
+ * heap_2 size ordered free list, so a block is always returned to the region
+ * it came from and blocks from different regions are never merged.  Free
+ * blocks are merged with their neighbours when if_merge_mem is set, just as in
+ * heap_2.c.
+ *
+ * pvPortMalloc() tries the regions in the order they were defined.  By
+ * default the first region is a heap in the core coupled memory, which has no
+ * wait states and is not on the bus matrix the DMA controllers use, so task
+ * stacks and TCBs stop competing with DMA for SRAM.  The CCM cannot be reached
+ * by DMA at all, so buffers that a DMA stream will access must be requested
+ * with pvPortMallocFlags( xSize, heapALLOC_DMA_CAPABLE ), which only uses
+ * regions marked heapREGION_DMA_CAPABLE.
+ *
+ * The default regions are ucCcmHeap (configCCM_HEAP_SIZE bytes, in the
+ * .ccmbss section) followed by ucHeap (configTOTAL_HEAP_SIZE bytes in SRAM, in
+ * the .noinit section).  Neither is cleared by the startup code, as only the
+ * block headers written by prvHeapInit() are ever read before being written.
+ * With configHEAP_SRAM_FROM_LINKER set to 1 there is no ucHeap, and the SRAM
+ * region is instead all the RAM the linker script leaves between
+ * __heap_sram_start, after .bss, .noinit and the newlib heap, and
+ * __heap_sram_end, below the MSP stack, so it grows and shrinks with the rest
+ * of the image and configTOTAL_HEAP_SIZE is not used.
+ * An application can instead pass its own table to vPortDefineHeapRegions()
+ * before the first allocation.
+ *
+ * Select this file by setting configHEAP_IMPLEMENTATION to
+ * heapIMPLEMENTATION_REGIONS in FreeRTOSConfig.h.
+ *
+ * With configHEAP_TRACK_OWNERS set to 1 every block header also records the
+ * task that allocated the block, as an index into a table of
+ * configHEAP_OWNER_SLOTS owners, and the return address of the allocating
+ * call.  Each owner keeps a count of its blocks and bytes, so the tasks that
+ * hold the heap can be found without walking it.  An allocated block has no
+ * next free block, which is how uxPortGetHeapAllocations() tells the blocks
+ * apart as it walks each region in address order.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_REGIONS )
+
+#include "heap_stats.h"
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+/* Most regions that can be defined. */
+#ifndef heapMAX_REGIONS
+	#define heapMAX_REGIONS		4
+#endif
+
+/* Memory for the default region table. */
+#if( configCCM_HEAP_SIZE > 0 )
+	static uint8_t ucCcmHeap[ configCCM_HEAP_SIZE ] __attribute__( ( section( ".ccmbss" ), aligned( portBYTE_ALIGNMENT ) ) );
+#endif
+
+#if( configHEAP_SRAM_FROM_LINKER == 1 )
+	#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+		#error configHEAP_SRAM_FROM_LINKER and configAPPLICATION_ALLOCATED_HEAP cannot both be 1
+	#endif
+	#if( portUSING_MPU_WRAPPERS == 1 )
+		/* The privileged region needs a power of two aligned to its size. */
+		#error configHEAP_SRAM_FROM_LINKER cannot be used with the MPU port
+	#endif
+
+	/* Defined by the linker script, see STM32F407VGTX_FLASH.ld. */
+	extern uint8_t __heap_sram_start[];
+	extern uint8_t __heap_sram_end[];
+#elif( configAPPLICATION_ALLOCATED_HEAP == 1 )
+	extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#elif( portUSING_MPU_WRAPPERS == 1 )
+	/* Aligned for the privileged only MPU region put over it. */
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ] __attribute__( ( section( ".noinit" ), aligned( portMPU_REGION_SIZE_FOR( configTOTAL_HEAP_SIZE ) ) ) );
+#else
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ] __attribute__( ( section( ".noinit" ) ) );
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* Define the linked list structure.  This is used to link free blocks in order
+of their size. */
+typedef struct A_BLOCK_LINK
+{
+	struct A_BLOCK_LINK *pxNextFreeBlock;	/*<< The next free block in the list. */
+	size_t xBlockSize;						/*<< The size of the free block. */
+	#if( configHEAP_TRACK_OWNERS == 1 )
+		uint32_t ulSite;					/*<< Return address of the allocating call. */
+		uint16_t usOwner;					/*<< Index of the allocating task in xHeapOwners[]. */
+		uint16_t usGeneration;				/*<< usHeapGeneration when it was allocated. */
+	#endif
+} BlockLink_t;
+
+/* The state kept for each region. */
+typedef struct xREGION
+{
+	BlockLink_t xStart;				/*<< Head of the size ordered free list. */
+	BlockLink_t xEnd;				/*<< Its terminator, sized to the whole region. */
+	uint8_t *pucStartAddress;		/*<< First byte of the aligned region. */
+	uint8_t *pucEndAddress;			/*<< One past its last usable byte. */
+	size_t xFreeBytesRemaining;
+	UBaseType_t uxAttributes;		/*<< heapREGION_* flags. */
+} Region_t;
+
+static const uint16_t heapSTRUCT_SIZE	= ( ( sizeof ( BlockLink_t ) + ( portBYTE_ALIGNMENT - 1 ) ) & ~portBYTE_ALIGNMENT_MASK );
+#define heapMINIMUM_BLOCK_SIZE	( ( size_t ) ( heapSTRUCT_SIZE * 2 ) )
+
+PRIVILEGED_DATA static Region_t xRegions[ heapMAX_REGIONS ];
+PRIVILEGED_DATA static UBaseType_t uxRegionCount = 0;
+
+/* Totals across every region. */
+PRIVILEGED_DATA static size_t xTotalHeapSize = 0U;
+PRIVILEGED_DATA static size_t xFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = 0U;
+
+/* Allocation counts and latencies reported by vPortGetHeapStats(). */
+static HeapCounters_t xHeapCounters = { 0 };
+static HeapJournal_t xHeapJournal = { 0 };
+
+#if( configHEAP_TRACK_OWNERS == 1 )
+
+	/* The bytes and blocks held by one allocating task.  Slot 0 has no task,
+	and takes the allocations made before the scheduler started and those of
+	tasks that found the table full.  A slot whose task has been deleted
+	keeps counting until the last of its blocks is freed, and is then reused. */
+	typedef struct xHEAP_OWNER
+	{
+		TaskHandle_t xOwner;		/*<< NULL for slot 0 and deleted tasks. */
+		size_t xBytes;				/*<< Held now, headers included. */
+		size_t xBlocks;
+		size_t xPeakBytes;			/*<< Most ever held at once. */
+	} HeapOwner_t;
+
+	static HeapOwner_t xHeapOwners[ configHEAP_OWNER_SLOTS ];
+
+	/* Stamped into each block as it is allocated, and advanced by
+	ulPortHeapNewGeneration(), so a block's age is the number of generations
+	it has outlived.  It wraps, so ages are only meaningful up to 65535. */
+	static uint16_t usHeapGeneration = 0;
+
+	/*
+	 * The slot of the calling task, which is given a free one if it has none.
+	 */
+	static uint32_t prvOwnerSlot( void ) portHEAP_HOT_PATH;
+
+	/*
+	 * Charge the allocated block pxBlock to the calling task, at the size it
+	 * has now, and mark it allocated.
+	 */
+	static void prvOwnerTake( BlockLink_t *pxBlock, uint32_t ulSite ) portHEAP_HOT_PATH;
+
+	/*
+	 * Take pxBlock off its owner's account, before it is freed or merged.
+	 */
+	static void prvOwnerRelease( const BlockLink_t *pxBlock ) portHEAP_HOT_PATH;
+
+	/*
+	 * Move the owner's account of pxBlock from xOldSize to the size it has now.
+	 */
+	static void prvOwnerResize( const BlockLink_t *pxBlock, size_t xOldSize );
+
+#else
+
+	#define prvOwnerTake( pxBlock, ulSite )		( void ) ( ulSite )
+	#define prvOwnerRelease( pxBlock )
+	#define prvOwnerResize( pxBlock, xOldSize )
+
+#endif /* configHEAP_TRACK_OWNERS */
+
+/* Most blocks vPortFreeBatch() merges with the free lists in one walk each.
+Longer batches are taken this many at a time. */
+#ifndef heapFREE_BATCH_MAX
+	#define heapFREE_BATCH_MAX	8
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Defines the built in regions if the application did not call
+ * vPortDefineHeapRegions() before the first allocation.
+ */
+static void prvHeapInit( void );
+
+/*
+ * Insert a block into the free list of its region, merging it with the blocks
+ * either side of it first when if_merge_mem is set.
+ */
+static void prvInsertBlockIntoFreeList( Region_t *pxRegion, BlockLink_t *pxBlockToInsert ) portHEAP_HOT_PATH;
+
+/*
+ * The region holding pxBlock, or NULL if it is not in the heap.
+ */
+static Region_t *prvRegionOfBlock( const BlockLink_t *pxBlock ) portHEAP_HOT_PATH;
+
+/*
+ * Sort the batch of blocks being freed into address order, which also groups
+ * them by region.
+ */
+static void prvSortBlocksByAddress( BlockLink_t *pxBlocks[], size_t xCount );
+
+/*
+ * Return an address sorted batch of blocks, all from pxRegion, to its free
+ * list.  One walk of the list unlinks every free neighbour of the batch, the
+ * batch and those neighbours are then joined into runs of contiguous memory,
+ * and the runs are inserted by size in a second walk.  pxBlocks[] is reused to
+ * hold the runs.
+ */
+static void prvInsertBatchIntoFreeList( Region_t *pxRegion, BlockLink_t *pxBlocks[], size_t xCount );
+
+/*
+ * The size of block, header included, that holds xWantedSize bytes, or 0 if
+ * no region could ever hold that many.
+ */
+static size_t prvRequiredBlockSize( size_t xWantedSize ) portHEAP_HOT_PATH;
+
+/*
+ * Cut the allocated block pxBlock down to xBlockSize bytes and return the
+ * rest to the free list of pxRegion, if the rest is large enough to be a block.
+ */
+static void prvTrimBlock( Region_t *pxRegion, BlockLink_t *pxBlock, size_t xBlockSize ) portHEAP_HOT_PATH;
+
+/*
+ * pvPortMallocFlags(), with the return address of the public function that
+ * was called, which the allocation is recorded against.
+ */
+static void *prvMallocFlags( size_t xWantedSize, UBaseType_t uxFlags, uint32_t ulSite ) portHEAP_HOT_PATH;
+
+/*-----------------------------------------------------------*/
+
+static void prvInsertBlockIntoFreeList( Region_t *pxRegion, BlockLink_t *pxBlockToInsert )
+{
+BlockLink_t *pxIterator, *pxPreviousBlock, *pxCurrentBlock;
+size_t xBlockSize;
+
+	if( if_merge_mem == 1 )
+	{
+		pxPreviousBlock = &( pxRegion->xStart );
+		pxCurrentBlock = pxRegion->xStart.pxNextFreeBlock;
+
+		/* Each free neighbour is unlinked and absorbed.  A block has at most one
+		neighbour on each side, so at most two merges happen. */
+		while( pxCurrentBlock != &( pxRegion->xEnd ) )
+		{
+			if( ( ( uint8_t * ) pxCurrentBlock + pxCurrentBlock->xBlockSize ) == ( uint8_t * ) pxBlockToInsert )
+			{
+				/* The current block ends where the new block starts. */
+				prvHeapJournalRecord( &xHeapJournal, eHeapChangeMerge, pxCurrentBlock, pxCurrentBlock->xBlockSize );
+				pxCurrentBlock->xBlockSize += pxBlockToInsert->xBlockSize;
+				pxBlockToInsert = pxCurrentBlock;
+			}
+			else if( ( ( uint8_t * ) pxBlockToInsert + pxBlockToInsert->xBlockSize ) == ( uint8_t * ) pxCurrentBlock )
+			{
+				/* The current block starts where the new block ends. */
+				prvHeapJournalRecord( &xHeapJournal, eHeapChangeMerge, pxCurrentBlock, pxCurrentBlock->xBlockSize );
+				pxBlockToInsert->xBlockSize += pxCurrentBlock->xBlockSize;
+			}
+			else
+			{
+				pxPreviousBlock = pxCurrentBlock;
+				pxCurrentBlock = pxCurrentBlock->pxNextFreeBlock;
+				continue;
+			}
+
+			pxPreviousBlock->pxNextFreeBlock = pxCurrentBlock->pxNextFreeBlock;
+			pxCurrentBlock = pxCurrentBlock->pxNextFreeBlock;
+		}
+	}
+
+	xBlockSize = pxBlockToInsert->xBlockSize;
+
+	/* Iterate through the list until a block is found that has a larger size
+	than the block we are inserting. */
+	for( pxIterator = &( pxRegion->xStart ); pxIterator->pxNextFreeBlock->xBlockSize < xBlockSize; pxIterator = pxIterator->pxNextFreeBlock )
+	{
+		/* There is nothing to do here - just iterate to the correct position. */
+	}
+
+	/* Update the list to include the block being inserted in the correct
+	position. */
+	pxBlockToInsert->pxNextFreeBlock = pxIterator->pxNextFreeBlock;
+	pxIterator->pxNextFreeBlock = pxBlockToInsert;
+	prvHeapJournalRecord( &xHeapJournal, eHeapChangeInsert, pxBlockToInsert, xBlockSize );
+}
+/*-----------------------------------------------------------*/
+
+static Region_t *prvRegionOfBlock( const BlockLink_t *pxBlock )
+{
+UBaseType_t uxRegion;
+
+	for( uxRegion = 0; uxRegion < uxRegionCount; uxRegion++ )
+	{
+		if( ( ( const uint8_t * ) pxBlock >= xRegions[ uxRegion ].pucStartAddress ) &&
+			( ( const uint8_t * ) pxBlock < xRegions[ uxRegion ].pucEndAddress ) )
+		{
+			return &( xRegions[ uxRegion ] );
+		}
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvMallocFlags( size_t xWantedSize, UBaseType_t uxFlags, uint32_t ulSite )
+{
+BlockLink_t *pxBlock = NULL, *pxPreviousBlock, *pxNewBlockLink;
+Region_t *pxRegion;
+UBaseType_t uxRegion;
+void *pvReturn = NULL;
+uint32_t ulStartCycles;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		/* If this is the first call to malloc and no regions were defined then
+		the built in regions are used. */
+		if( uxRegionCount == 0 )
+		{
+			prvHeapInit();
+		}
+
+		ulStartCycles = heapSTATS_TIMESTAMP();
+
+		/* The wanted size is increased so it can contain a BlockLink_t
+		structure in addition to the requested amount of bytes. */
+		if( xWantedSize > 0 )
+		{
+			xWantedSize += heapSTRUCT_SIZE;
+
+			/* Ensure that blocks are always aligned to the required number of bytes. */
+			if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0 )
+			{
+				/* Byte alignment required. */
+				xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+			}
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
+		{
+			for( uxRegion = 0; uxRegion < uxRegionCount; uxRegion++ )
+			{
+				pxRegion = &( xRegions[ uxRegion ] );
+
+				if( ( ( uxFlags & heapALLOC_DMA_CAPABLE ) != 0 ) && ( ( pxRegion->uxAttributes & heapREGION_DMA_CAPABLE ) == 0 ) )
+				{
+					continue;
+				}
+
+				if( xWantedSize > pxRegion->xFreeBytesRemaining )
+				{
+					continue;
+				}
+
+				/* Blocks are stored in byte order - traverse the list from the
+				start (smallest) block until one of adequate size is found. */
+				pxPreviousBlock = &( pxRegion->xStart );
+				pxBlock = pxRegion->xStart.pxNextFreeBlock;
+				while( ( pxBlock->xBlockSize < xWantedSize ) && ( pxBlock->pxNextFreeBlock != NULL ) )
+				{
+					pxPreviousBlock = pxBlock;
+					pxBlock = pxBlock->pxNextFreeBlock;
+				}
+
+				/* If we found the end marker then a block of adequate size was
+				not found in this region. */
+				if( pxBlock == &( pxRegion->xEnd ) )
+				{
+					continue;
+				}
+
+				/* Return the memory space - jumping over the BlockLink_t
+				structure at its start. */
+				pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + heapSTRUCT_SIZE );
+
+				/* This block is being returned for use so must be taken out of
+				the list of free blocks. */
+				pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+				prvHeapJournalRecord( &xHeapJournal, eHeapChangeRemove, pxBlock, pxBlock->xBlockSize );
+
+				/* If the block is larger than required it can be split into two. */
+				if( ( pxBlock->xBlockSize - xWantedSize ) > heapMINIMUM_BLOCK_SIZE )
+				{
+					pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+					pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+					pxBlock->xBlockSize = xWantedSize;
+					prvHeapJournalRecord( &xHeapJournal, eHeapChangeSplit, pxBlock, xWantedSize );
+					prvInsertBlockIntoFreeList( pxRegion, pxNewBlockLink );
+				}
+
+				pxRegion->xFreeBytesRemaining -= pxBlock->xBlockSize;
+				xFreeBytesRemaining -= pxBlock->xBlockSize;
+				prvOwnerTake( pxBlock, ulSite );
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+
+				break;
+			}
+		}
+
+		prvHeapStatsMalloc( &xHeapCounters, pvReturn, xWantedSize, ulStartCycles );
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	prvHeapUnlock( uxHeapLockState );
+	prvHeapWatchCheck();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+portHEAP_HOT_PATH void *pvPortMallocFlags( size_t xWantedSize, UBaseType_t uxFlags )
+{
+	return prvMallocFlags( xWantedSize, uxFlags, portHEAP_CALLER() );
+}
+/*-----------------------------------------------------------*/
+
+portHEAP_HOT_PATH void *pvPortMalloc( size_t xWantedSize )
+{
+	return prvMallocFlags( xWantedSize, 0, portHEAP_CALLER() );
+}
+/*-----------------------------------------------------------*/
+
+portHEAP_HOT_PATH void vPortFree( void *pv )
+{
+BlockLink_t *pxLink;
+Region_t *pxRegion;
+size_t xBlockSize;
+uint32_t ulStartCycles;
+UBaseType_t uxHeapLockState;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have an BlockLink_t structure immediately
+		before it. */
+		pxLink = ( void * ) ( ( ( uint8_t * ) pv ) - heapSTRUCT_SIZE );
+		pxRegion = prvRegionOfBlock( pxLink );
+		configASSERT( pxRegion != NULL );
+
+		uxHeapLockState = prvHeapLock();
+		{
+			ulStartCycles = heapSTATS_TIMESTAMP();
+
+			/* Take the size before the block is inserted, as merging may grow
+			it to include a neighbour that was already free. */
+			xBlockSize = pxLink->xBlockSize;
+
+			prvOwnerRelease( pxLink );
+			prvInsertBlockIntoFreeList( pxRegion, pxLink );
+			pxRegion->xFreeBytesRemaining += xBlockSize;
+			xFreeBytesRemaining += xBlockSize;
+			prvHeapStatsFree( &xHeapCounters, ulStartCycles );
+			traceFREE( pv, xBlockSize );
+		}
+		prvHeapUnlock( uxHeapLockState );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvRequiredBlockSize( size_t xWantedSize )
+{
+	if( ( xWantedSize == 0 ) || ( xWantedSize >= ( xTotalHeapSize - heapSTRUCT_SIZE ) ) )
+	{
+		return 0;
+	}
+
+	/* Same rounding as pvPortMallocFlags(). */
+	xWantedSize += heapSTRUCT_SIZE;
+
+	if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0 )
+	{
+		xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+	}
+
+	return xWantedSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTrimBlock( Region_t *pxRegion, BlockLink_t *pxBlock, size_t xBlockSize )
+{
+BlockLink_t *pxNewBlockLink;
+
+	if( ( pxBlock->xBlockSize - xBlockSize ) > heapMINIMUM_BLOCK_SIZE )
+	{
+		pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xBlockSize );
+		pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xBlockSize;
+		pxBlock->xBlockSize = xBlockSize;
+		prvHeapJournalRecord( &xHeapJournal, eHeapChangeSplit, pxBlock, xBlockSize );
+
+		pxRegion->xFreeBytesRemaining += pxNewBlockLink->xBlockSize;
+		xFreeBytesRemaining += pxNewBlockLink->xBlockSize;
+		prvInsertBlockIntoFreeList( pxRegion, pxNewBlockLink );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortRealloc( void *pv, size_t xWantedSize )
+{
+BlockLink_t *pxLink, *pxBlock, *pxPreviousBlock;
+Region_t *pxRegion;
+size_t xBlockSize, xOldSize;
+void *pvReturn = NULL;
+const uint32_t ulSite = portHEAP_CALLER();
+UBaseType_t uxHeapLockState;
+
+	if( pv == NULL )
+	{
+		return prvMallocFlags( xWantedSize, 0, ulSite );
+	}
+
+	if( xWantedSize == 0 )
+	{
+		vPortFree( pv );
+		return NULL;
+	}
+
+	pxLink = ( void * ) ( ( ( uint8_t * ) pv ) - heapSTRUCT_SIZE );
+	pxRegion = prvRegionOfBlock( pxLink );
+	configASSERT( pxRegion != NULL );
+	xBlockSize = prvRequiredBlockSize( xWantedSize );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		xOldSize = pxLink->xBlockSize;
+
+		/* To grow in place the block that starts where this one ends must be
+		free.  It can only be absorbed when free blocks are being merged, as
+		otherwise the list may hold adjacent fragments of it. */
+		if( ( xBlockSize > xOldSize ) && ( if_merge_mem == 1 ) )
+		{
+			pxPreviousBlock = &( pxRegion->xStart );
+
+			for( pxBlock = pxRegion->xStart.pxNextFreeBlock; pxBlock != &( pxRegion->xEnd ); pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( ( uint8_t * ) pxBlock == ( ( uint8_t * ) pxLink ) + xOldSize )
+				{
+					break;
+				}
+
+				pxPreviousBlock = pxBlock;
+			}
+
+			if( ( pxBlock != &( pxRegion->xEnd ) ) && ( ( xOldSize + pxBlock->xBlockSize ) >= xBlockSize ) )
+			{
+				pxPreviousBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+				prvHeapJournalRecord( &xHeapJournal, eHeapChangeMerge, pxBlock, pxBlock->xBlockSize );
+				pxLink->xBlockSize += pxBlock->xBlockSize;
+				pxRegion->xFreeBytesRemaining -= pxBlock->xBlockSize;
+				xFreeBytesRemaining -= pxBlock->xBlockSize;
+			}
+		}
+
+		if( ( xBlockSize != 0 ) && ( xBlockSize <= pxLink->xBlockSize ) )
+		{
+			prvTrimBlock( pxRegion, pxLink, xBlockSize );
+			prvOwnerResize( pxLink, xOldSize );
+
+			if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+			{
+				xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+			}
+
+			traceFREE( pv, xOldSize );
+			traceMALLOC( pv, pxLink->xBlockSize );
+			pvReturn = pv;
+		}
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	if( pvReturn == NULL )
+	{
+		/* The block has to move, or is too large for the heap, in which case
+		pvPortMallocFlags() fails and calls the malloc failed hook.  Either way
+		it is growing, so all of the old contents fit in the new block.  A
+		block that had to be DMA capable stays so. */
+		pvReturn = prvMallocFlags( xWantedSize, ( ( pxRegion->uxAttributes & heapREGION_DMA_CAPABLE ) != 0 ) ? heapALLOC_DMA_CAPABLE : 0, ulSite );
+
+		if( pvReturn != NULL )
+		{
+			portMEMCPY( pvReturn, pv, xOldSize - heapSTRUCT_SIZE );
+			vPortFree( pv );
+		}
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocAligned( size_t xWantedSize, size_t xAlignment, UBaseType_t uxFlags )
+{
+BlockLink_t *pxLink, *pxAlignedLink;
+Region_t *pxRegion;
+uint8_t *pucBlock, *pucAligned;
+size_t xBlockSize, xLeading;
+const uint32_t ulSite = portHEAP_CALLER();
+UBaseType_t uxHeapLockState;
+
+	configASSERT( ( xAlignment & ( xAlignment - 1 ) ) == 0 );
+
+	xBlockSize = prvRequiredBlockSize( xWantedSize );
+
+	/* pvPortMallocFlags() already gives portBYTE_ALIGNMENT, and also deals
+	with requests that can never succeed.  Before the first allocation
+	xTotalHeapSize is still 0, so that path also initialises the heap. */
+	if( ( xAlignment <= portBYTE_ALIGNMENT ) || ( xBlockSize == 0 ) )
+	{
+		return prvMallocFlags( xWantedSize, uxFlags, ulSite );
+	}
+
+	/* Allow for the worst case padding - up to xAlignment bytes to reach the
+	boundary, plus one more step of xAlignment if the gap is too small to be
+	given back as a free block.  The request is based on the rounded block
+	size so that it covers any minimum block size as well. */
+	pucBlock = prvMallocFlags( ( xBlockSize - heapSTRUCT_SIZE ) + xAlignment + heapMINIMUM_BLOCK_SIZE, uxFlags, ulSite );
+
+	if( pucBlock == NULL )
+	{
+		return NULL;
+	}
+
+	pucAligned = ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) pucBlock + ( xAlignment - 1 ) ) & ~( ( portPOINTER_SIZE_TYPE ) xAlignment - 1 ) );
+
+	while( ( pucAligned != pucBlock ) && ( ( size_t ) ( pucAligned - pucBlock ) <= heapMINIMUM_BLOCK_SIZE ) )
+	{
+		pucAligned += xAlignment;
+	}
+
+	xLeading = ( size_t ) ( pucAligned - pucBlock );
+	pxLink = ( void * ) ( pucBlock - heapSTRUCT_SIZE );
+	pxRegion = prvRegionOfBlock( pxLink );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		traceFREE( pucBlock, pxLink->xBlockSize );
+
+		/* Charged again below at the size and header it ends up with. */
+		prvOwnerRelease( pxLink );
+
+		/* The padding in front of the aligned address becomes a free block,
+		and the aligned address gets a header of its own. */
+		if( xLeading > 0 )
+		{
+			pxAlignedLink = ( void * ) ( pucAligned - heapSTRUCT_SIZE );
+			pxAlignedLink->xBlockSize = pxLink->xBlockSize - xLeading;
+			pxLink->xBlockSize = xLeading;
+
+			pxRegion->xFreeBytesRemaining += xLeading;
+			xFreeBytesRemaining += xLeading;
+			prvInsertBlockIntoFreeList( pxRegion, pxLink );
+			pxLink = pxAlignedLink;
+		}
+
+		prvTrimBlock( pxRegion, pxLink, xBlockSize );
+		prvOwnerTake( pxLink, ulSite );
+		traceMALLOC( pucAligned, pxLink->xBlockSize );
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return pucAligned;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFreeBatch( void * const pvBlocks[], size_t xCount )
+{
+BlockLink_t *pxBlocks[ heapFREE_BATCH_MAX ];
+Region_t *pxRegion;
+size_t x, xFirst, xBatch, xBlockBytes;
+uint32_t ulStartCycles;
+UBaseType_t uxHeapLockState;
+
+	while( xCount > 0 )
+	{
+		/* Take the next heapFREE_BATCH_MAX blocks that are not NULL. */
+		for( xBatch = 0; ( xCount > 0 ) && ( xBatch < heapFREE_BATCH_MAX ); xCount--, pvBlocks++ )
+		{
+			if( *pvBlocks != NULL )
+			{
+				pxBlocks[ xBatch ] = ( void * ) ( ( ( uint8_t * ) *pvBlocks ) - heapSTRUCT_SIZE );
+				configASSERT( prvRegionOfBlock( pxBlocks[ xBatch ] ) != NULL );
+				xBatch++;
+			}
+		}
+
+		if( xBatch == 0 )
+		{
+			break;
+		}
+
+		uxHeapLockState = prvHeapLock();
+		{
+			ulStartCycles = heapSTATS_TIMESTAMP();
+
+			prvSortBlocksByAddress( pxBlocks, xBatch );
+
+			/* Regions do not overlap, so after sorting the blocks of each
+			region are next to each other in pxBlocks[]. */
+			for( xFirst = 0; xFirst < xBatch; xFirst = x )
+			{
+				pxRegion = prvRegionOfBlock( pxBlocks[ xFirst ] );
+
+				/* As in vPortFree(), sizes are taken before anything is
+				merged. */
+				xBlockBytes = 0;
+				for( x = xFirst; ( x < xBatch ) && ( prvRegionOfBlock( pxBlocks[ x ] ) == pxRegion ); x++ )
+				{
+					prvOwnerRelease( pxBlocks[ x ] );
+					xBlockBytes += pxBlocks[ x ]->xBlockSize;
+					traceFREE( ( ( uint8_t * ) pxBlocks[ x ] ) + heapSTRUCT_SIZE, pxBlocks[ x ]->xBlockSize );
+				}
+
+				prvInsertBatchIntoFreeList( pxRegion, &( pxBlocks[ xFirst ] ), x - xFirst );
+				pxRegion->xFreeBytesRemaining += xBlockBytes;
+				xFreeBytesRemaining += xBlockBytes;
+			}
+
+			prvHeapStatsFreeBatch( &xHeapCounters, xBatch, ulStartCycles );
+		}
+		prvHeapUnlock( uxHeapLockState );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSortBlocksByAddress( BlockLink_t *pxBlocks[], size_t xCount )
+{
+BlockLink_t *pxBlock;
+size_t x, y;
+
+	/* Insertion sort - the batch is at most heapFREE_BATCH_MAX long. */
+	for( x = 1; x < xCount; x++ )
+	{
+		pxBlock = pxBlocks[ x ];
+
+		for( y = x; ( y > 0 ) && ( pxBlocks[ y - 1 ] > pxBlock ); y-- )
+		{
+			pxBlocks[ y ] = pxBlocks[ y - 1 ];
+		}
+
+		pxBlocks[ y ] = pxBlock;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertBatchIntoFreeList( Region_t *pxRegion, BlockLink_t *pxBlocks[], size_t xCount )
+{
+BlockLink_t *pxBefore[ heapFREE_BATCH_MAX ], *pxAfter[ heapFREE_BATCH_MAX ];
+BlockLink_t *pxSegments[ 3 ];
+BlockLink_t *pxPreviousBlock, *pxCurrentBlock, *pxIterator, *pxRun = NULL, *pxBlock;
+BaseType_t xNeighbour;
+size_t x, xSegment, xRuns = 0;
+
+	for( x = 0; x < xCount; x++ )
+	{
+		pxBefore[ x ] = NULL;
+		pxAfter[ x ] = NULL;
+	}
+
+	if( if_merge_mem == 1 )
+	{
+		/* The single walk of the free list.  The list is kept fully merged, so
+		each block in the batch has at most one free neighbour on each side,
+		and one free block can sit between two blocks of the batch. */
+		pxPreviousBlock = &( pxRegion->xStart );
+		pxCurrentBlock = pxRegion->xStart.pxNextFreeBlock;
+
+		while( pxCurrentBlock != &( pxRegion->xEnd ) )
+		{
+			xNeighbour = pdFALSE;
+
+			for( x = 0; x < xCount; x++ )
+			{
+				if( ( ( uint8_t * ) pxCurrentBlock + pxCurrentBlock->xBlockSize ) == ( uint8_t * ) pxBlocks[ x ] )
+				{
+					pxBefore[ x ] = pxCurrentBlock;
+					xNeighbour = pdTRUE;
+				}
+
+				if( ( ( uint8_t * ) pxBlocks[ x ] + pxBlocks[ x ]->xBlockSize ) == ( uint8_t * ) pxCurrentBlock )
+				{
+					pxAfter[ x ] = pxCurrentBlock;
+					xNeighbour = pdTRUE;
+				}
+			}
+
+			if( xNeighbour != pdFALSE )
+			{
+				pxPreviousBlock->pxNextFreeBlock = pxCurrentBlock->pxNextFreeBlock;
+				prvHeapJournalRecord( &xHeapJournal, eHeapChangeMerge, pxCurrentBlock, pxCurrentBlock->xBlockSize );
+			}
+			else
+			{
+				pxPreviousBlock = pxCurrentBlock;
+			}
+
+			pxCurrentBlock = pxCurrentBlock->pxNextFreeBlock;
+		}
+	}
+
+	/* Join the batch and its neighbours, in address order, into runs.  Only
+	runs that have been completed are written back to pxBlocks[], and each one
+	holds at least one block of the batch, so nothing is overwritten before it
+	has been read. */
+	for( x = 0; x < xCount; x++ )
+	{
+		/* A block between two members of the batch is already in the run. */
+		pxSegments[ 0 ] = ( ( x > 0 ) && ( pxBefore[ x ] == pxAfter[ x - 1 ] ) ) ? NULL : pxBefore[ x ];
+		pxSegments[ 1 ] = pxBlocks[ x ];
+		pxSegments[ 2 ] = pxAfter[ x ];
+
+		for( xSegment = 0; xSegment < 3; xSegment++ )
+		{
+			pxBlock = pxSegments[ xSegment ];
+
+			if( pxBlock == NULL )
+			{
+				continue;
+			}
+
+			if( ( if_merge_mem == 1 ) && ( pxRun != NULL ) && ( ( ( uint8_t * ) pxRun + pxRun->xBlockSize ) == ( uint8_t * ) pxBlock ) )
+			{
+				pxRun->xBlockSize += pxBlock->xBlockSize;
+			}
+			else
+			{
+				if( pxRun != NULL )
+				{
+					pxBlocks[ xRuns ] = pxRun;
+					xRuns++;
+				}
+
+				pxRun = pxBlock;
+			}
+		}
+	}
+
+	pxBlocks[ xRuns ] = pxRun;
+	xRuns++;
+
+	/* Order the runs by size so they can all be inserted in one more walk,
+	each search carrying on from where the previous run went in. */
+	for( x = 1; x < xRuns; x++ )
+	{
+		pxBlock = pxBlocks[ x ];
+
+		for( xSegment = x; ( xSegment > 0 ) && ( pxBlocks[ xSegment - 1 ]->xBlockSize > pxBlock->xBlockSize ); xSegment-- )
+		{
+			pxBlocks[ xSegment ] = pxBlocks[ xSegment - 1 ];
+		}
+
+		pxBlocks[ xSegment ] = pxBlock;
+	}
+
+	pxIterator = &( pxRegion->xStart );
+
+	for( x = 0; x < xRuns; x++ )
+	{
+		while( pxIterator->pxNextFreeBlock->xBlockSize < pxBlocks[ x ]->xBlockSize )
+		{
+			pxIterator = pxIterator->pxNextFreeBlock;
+		}
+
+		pxBlocks[ x ]->pxNextFreeBlock = pxIterator->pxNextFreeBlock;
+		pxIterator->pxNextFreeBlock = pxBlocks[ x ];
+		pxIterator = pxBlocks[ x ];
+		prvHeapJournalRecord( &xHeapJournal, eHeapChangeInsert, pxBlocks[ x ], pxBlocks[ x ]->xBlockSize );
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions )
+{
+const HeapRegion_t *pxHeapRegion;
+Region_t *pxRegion;
+BlockLink_t *pxFirstFreeBlock;
+portPOINTER_SIZE_TYPE uxAddress, uxEndAddress;
+size_t xUsableSize;
+
+	/* Must only be called once, before the first allocation. */
+	configASSERT( uxRegionCount == 0 );
+
+	prvHeapStatsInit();
+
+	for( pxHeapRegion = pxHeapRegions; pxHeapRegion->xSizeInBytes > 0; pxHeapRegion++ )
+	{
+		configASSERT( uxRegionCount < heapMAX_REGIONS );
+
+		/* Ensure the region starts and ends on a correctly aligned boundary. */
+		uxAddress = ( portPOINTER_SIZE_TYPE ) pxHeapRegion->pucStartAddress;
+		uxEndAddress = uxAddress + pxHeapRegion->xSizeInBytes;
+		uxAddress = ( uxAddress + portBYTE_ALIGNMENT_MASK ) & ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK );
+		uxEndAddress &= ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK );
+
+		if( uxEndAddress <= ( uxAddress + heapMINIMUM_BLOCK_SIZE ) )
+		{
+			/* Too small to hold a block once aligned. */
+			continue;
+		}
+
+		xUsableSize = ( size_t ) ( uxEndAddress - uxAddress );
+		pxRegion = &( xRegions[ uxRegionCount ] );
+		pxRegion->pucStartAddress = ( uint8_t * ) uxAddress;
+		pxRegion->pucEndAddress = ( uint8_t * ) uxEndAddress;
+		pxRegion->uxAttributes = pxHeapRegion->uxAttributes;
+		pxRegion->xFreeBytesRemaining = xUsableSize;
+
+		/* xStart is used to hold a pointer to the first item in the list of
+		free blocks.  xEnd marks the end of the list and is sized so that no
+		search ever passes it. */
+		pxRegion->xStart.pxNextFreeBlock = ( void * ) pxRegion->pucStartAddress;
+		pxRegion->xStart.xBlockSize = ( size_t ) 0;
+		pxRegion->xEnd.xBlockSize = xUsableSize;
+		pxRegion->xEnd.pxNextFreeBlock = NULL;
+
+		/* To start with there is a single free block that is sized to take up
+		the entire region. */
+		pxFirstFreeBlock = ( void * ) pxRegion->pucStartAddress;
+		pxFirstFreeBlock->xBlockSize = xUsableSize;
+		pxFirstFreeBlock->pxNextFreeBlock = &( pxRegion->xEnd );
+		prvHeapJournalRecord( &xHeapJournal, eHeapChangeInsert, pxFirstFreeBlock, xUsableSize );
+
+		xTotalHeapSize += xUsableSize;
+		uxRegionCount++;
+	}
+
+	configASSERT( uxRegionCount > 0 );
+
+	xFreeBytesRemaining = xTotalHeapSize;
+	xMinimumEverFreeBytesRemaining = xTotalHeapSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+const HeapRegion_t xDefaultRegions[] =
+{
+	#if( configCCM_HEAP_SIZE > 0 )
+		{ ucCcmHeap, sizeof( ucCcmHeap ), 0 },
+	#endif
+	#if( configHEAP_SRAM_FROM_LINKER == 1 )
+		{ __heap_sram_start, ( size_t ) ( __heap_sram_end - __heap_sram_start ), heapREGION_DMA_CAPABLE },
+	#else
+		{ ucHeap, sizeof( ucHeap ), heapREGION_DMA_CAPABLE },
+	#endif
+	{ NULL, 0, 0 }
+};
+
+	vPortDefineHeapRegions( xDefaultRegions );
+
+	#if( ( portUSING_MPU_WRAPPERS == 1 ) && ( configAPPLICATION_ALLOCATED_HEAP == 0 ) )
+	{
+		/* The CCM heap is already out of reach of unprivileged tasks.  Keep
+		them out of the SRAM one too, except for stacks given their own
+		region. */
+		vPortSetPrivilegedSRAMRegion( ucHeap, sizeof( ucHeap ) );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapSnapshot( HeapSnapshot_t *pxSnapshot, HeapBlockInfo_t *pxBlocks, size_t xMaxBlocks )
+{
+BlockLink_t *pxBlock;
+UBaseType_t uxRegion;
+size_t xCount = 0;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		/* Regions are listed in the order they are searched. */
+		for( uxRegion = 0; uxRegion < uxRegionCount; uxRegion++ )
+		{
+			for( pxBlock = xRegions[ uxRegion ].xStart.pxNextFreeBlock; pxBlock != &( xRegions[ uxRegion ].xEnd ); pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( xCount < xMaxBlocks )
+				{
+					pxBlocks[ xCount ].pvStartAddress = ( void * ) pxBlock;
+					pxBlocks[ xCount ].xBlockSize = pxBlock->xBlockSize;
+				}
+				xCount++;
+			}
+		}
+
+		pxSnapshot->xFreeBytesRemaining = xFreeBytesRemaining;
+		pxSnapshot->ulSequence = xHeapJournal.ulSequence;
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	pxSnapshot->xHeapSize = xTotalHeapSize;
+	pxSnapshot->xHeaderSize = heapSTRUCT_SIZE;
+	pxSnapshot->xNumberOfFreeBlocks = xCount;
+	pxSnapshot->xBlocksCaptured = ( xCount < xMaxBlocks ) ? xCount : xMaxBlocks;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortGetHeapChanges( uint32_t *pulSequence, HeapChange_t *pxChanges, size_t xMaxChanges, size_t *pxChangesCopied )
+{
+BaseType_t xReturn;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		xReturn = prvHeapJournalCopy( &xHeapJournal, pulSequence, pxChanges, xMaxChanges, pxChangesCopied );
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+BlockLink_t *pxBlock;
+UBaseType_t uxRegion;
+UBaseType_t uxHeapLockState;
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+	pxHeapStats->xNumberOfFreeBlocks = 0;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		for( uxRegion = 0; uxRegion < uxRegionCount; uxRegion++ )
+		{
+			for( pxBlock = xRegions[ uxRegion ].xStart.pxNextFreeBlock; pxBlock != &( xRegions[ uxRegion ].xEnd ); pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				prvHeapStatsAddFreeBlock( pxHeapStats, pxBlock->xBlockSize );
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		prvHeapStatsCopy( &xHeapCounters, pxHeapStats );
+	}
+	prvHeapUnlock( uxHeapLockState );
+}
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_TRACK_OWNERS == 1 )
+
+	static uint32_t prvOwnerSlot( void )
+	{
+	TaskHandle_t xTask;
+	uint32_t ulSlot, ulFree = 0;
+
+		if( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED )
+		{
+			return 0;
+		}
+
+		xTask = xTaskGetCurrentTaskHandle();
+
+		for( ulSlot = 1; ulSlot < ( uint32_t ) configHEAP_OWNER_SLOTS; ulSlot++ )
+		{
+			if( xHeapOwners[ ulSlot ].xOwner == xTask )
+			{
+				return ulSlot;
+			}
+
+			if( ( ulFree == 0 ) && ( xHeapOwners[ ulSlot ].xOwner == NULL ) && ( xHeapOwners[ ulSlot ].xBlocks == 0 ) )
+			{
+				ulFree = ulSlot;
+			}
+		}
+
+		/* With no free slot left ulFree is still 0, so the task shares the
+		slot of allocations without an owner. */
+		if( ulFree != 0 )
+		{
+			xHeapOwners[ ulFree ].xOwner = xTask;
+			xHeapOwners[ ulFree ].xPeakBytes = 0;
+		}
+
+		return ulFree;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvOwnerTake( BlockLink_t *pxBlock, uint32_t ulSite )
+	{
+	HeapOwner_t *pxOwner;
+
+		pxBlock->pxNextFreeBlock = NULL;
+		pxBlock->ulSite = ulSite;
+		pxBlock->usOwner = ( uint16_t ) prvOwnerSlot();
+		pxBlock->usGeneration = usHeapGeneration;
+
+		pxOwner = &( xHeapOwners[ pxBlock->usOwner ] );
+		pxOwner->xBytes += pxBlock->xBlockSize;
+		pxOwner->xBlocks++;
+
+		if( pxOwner->xBytes > pxOwner->xPeakBytes )
+		{
+			pxOwner->xPeakBytes = pxOwner->xBytes;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvOwnerRelease( const BlockLink_t *pxBlock )
+	{
+	HeapOwner_t *pxOwner;
+
+		configASSERT( ( pxBlock->pxNextFreeBlock == NULL ) && ( pxBlock->usOwner < ( uint16_t ) configHEAP_OWNER_SLOTS ) );
+
+		pxOwner = &( xHeapOwners[ pxBlock->usOwner ] );
+		pxOwner->xBytes -= pxBlock->xBlockSize;
+		pxOwner->xBlocks--;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvOwnerResize( const BlockLink_t *pxBlock, size_t xOldSize )
+	{
+	HeapOwner_t *pxOwner = &( xHeapOwners[ pxBlock->usOwner ] );
+
+		pxOwner->xBytes = ( pxOwner->xBytes - xOldSize ) + pxBlock->xBlockSize;
+
+		if( pxOwner->xBytes > pxOwner->xPeakBytes )
+		{
+			pxOwner->xPeakBytes = pxOwner->xBytes;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortHeapOwnerDeleted( TaskHandle_t xTask )
+	{
+	uint32_t ulSlot;
+	UBaseType_t uxHeapLockState;
+
+		uxHeapLockState = prvHeapLock();
+		{
+			for( ulSlot = 1; ulSlot < ( uint32_t ) configHEAP_OWNER_SLOTS; ulSlot++ )
+			{
+				if( xHeapOwners[ ulSlot ].xOwner == xTask )
+				{
+					xHeapOwners[ ulSlot ].xOwner = NULL;
+					break;
+				}
+			}
+		}
+		prvHeapUnlock( uxHeapLockState );
+	}
+	/*-----------------------------------------------------------*/
+
+	size_t xPortGetHeapOwnerBytes( TaskHandle_t xTask )
+	{
+	uint32_t ulSlot;
+
+		/* No lock, so that the kernel can call this with the scheduler
+		suspended.  Only tasks change the table, so it is still consistent. */
+		for( ulSlot = 1; ulSlot < ( uint32_t ) configHEAP_OWNER_SLOTS; ulSlot++ )
+		{
+			if( xHeapOwners[ ulSlot ].xOwner == xTask )
+			{
+				return xHeapOwners[ ulSlot ].xBytes;
+			}
+		}
+
+		return 0;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortGetHeapOwners( HeapOwnerInfo_t *pxOwners )
+	{
+	uint32_t ulSlot;
+	const char *pcName;
+	size_t x;
+	UBaseType_t uxHeapLockState;
+
+		uxHeapLockState = prvHeapLock();
+		{
+			/* Only a task the heap can be locked against can delete a task,
+			so every owner is still alive while its name is copied. */
+			for( ulSlot = 0; ulSlot < ( uint32_t ) configHEAP_OWNER_SLOTS; ulSlot++ )
+			{
+				pxOwners[ ulSlot ].xOwner = xHeapOwners[ ulSlot ].xOwner;
+				pxOwners[ ulSlot ].xBytes = xHeapOwners[ ulSlot ].xBytes;
+				pxOwners[ ulSlot ].xBlocks = xHeapOwners[ ulSlot ].xBlocks;
+				pxOwners[ ulSlot ].xPeakBytes = xHeapOwners[ ulSlot ].xPeakBytes;
+				pxOwners[ ulSlot ].pcTaskName[ 0 ] = '\0';
+
+				if( xHeapOwners[ ulSlot ].xOwner != NULL )
+				{
+					pcName = pcTaskGetName( xHeapOwners[ ulSlot ].xOwner );
+
+					for( x = 0; ( x < ( size_t ) ( configMAX_TASK_NAME_LEN - 1 ) ) && ( pcName[ x ] != '\0' ); x++ )
+					{
+						pxOwners[ ulSlot ].pcTaskName[ x ] = pcName[ x ];
+					}
+
+					pxOwners[ ulSlot ].pcTaskName[ x ] = '\0';
+				}
+			}
+		}
+		prvHeapUnlock( uxHeapLockState );
+	}
+	/*-----------------------------------------------------------*/
+
+	size_t uxPortGetHeapAllocations( HeapAllocationInfo_t *pxBlocks, size_t xMaxBlocks )
+	{
+	const BlockLink_t *pxBlock;
+	UBaseType_t uxRegion;
+	size_t xCount = 0;
+	UBaseType_t uxHeapLockState;
+
+		uxHeapLockState = prvHeapLock();
+		{
+			/* Blocks tile each region, so the walk steps from header to
+			header. */
+			for( uxRegion = 0; uxRegion < uxRegionCount; uxRegion++ )
+			{
+				for( pxBlock = ( const void * ) xRegions[ uxRegion ].pucStartAddress;
+					 ( const uint8_t * ) pxBlock < xRegions[ uxRegion ].pucEndAddress;
+					 pxBlock = ( const void * ) ( ( ( const uint8_t * ) pxBlock ) + pxBlock->xBlockSize ) )
+				{
+					if( pxBlock->pxNextFreeBlock != NULL )
+					{
+						continue;
+					}
+
+					if( xCount < xMaxBlocks )
+					{
+						pxBlocks[ xCount ].pvStartAddress = ( void * ) pxBlock;
+						pxBlocks[ xCount ].xBlockSize = pxBlock->xBlockSize;
+						pxBlocks[ xCount ].ulSite = pxBlock->ulSite;
+						pxBlocks[ xCount ].uxOwner = ( UBaseType_t ) pxBlock->usOwner;
+					}
+					xCount++;
+				}
+			}
+		}
+		prvHeapUnlock( uxHeapLockState );
+
+		return xCount;
+	}
+	/*-----------------------------------------------------------*/
+
+	uint32_t ulPortHeapNewGeneration( void )
+	{
+	uint32_t ulGeneration;
+	UBaseType_t uxHeapLockState;
+
+		uxHeapLockState = prvHeapLock();
+		{
+			usHeapGeneration++;
+			ulGeneration = ( uint32_t ) usHeapGeneration;
+		}
+		prvHeapUnlock( uxHeapLockState );
+
+		return ulGeneration;
+	}
+	/*-----------------------------------------------------------*/
+
+	size_t uxPortGetHeapLeaks( HeapLeakInfo_t *pxSites, size_t xMaxSites, UBaseType_t uxMinAge )
+	{
+	const BlockLink_t *pxBlock;
+	UBaseType_t uxRegion, uxAge;
+	size_t x, xSites = 0;
+	UBaseType_t uxHeapLockState;
+
+		uxHeapLockState = prvHeapLock();
+		{
+			for( uxRegion = 0; uxRegion < uxRegionCount; uxRegion++ )
+			{
+				for( pxBlock = ( const void * ) xRegions[ uxRegion ].pucStartAddress;
+					 ( const uint8_t * ) pxBlock < xRegions[ uxRegion ].pucEndAddress;
+					 pxBlock = ( const void * ) ( ( ( const uint8_t * ) pxBlock ) + pxBlock->xBlockSize ) )
+				{
+					if( pxBlock->pxNextFreeBlock != NULL )
+					{
+						continue;
+					}
+
+					uxAge = ( UBaseType_t ) ( uint16_t ) ( usHeapGeneration - pxBlock->usGeneration );
+
+					if( uxAge < uxMinAge )
+					{
+						continue;
+					}
+
+					/* A linear search, as a leak report has few sites and
+					heap_report.c keeps the table small. */
+					for( x = 0; ( x < xSites ) && ( pxSites[ x ].ulSite != pxBlock->ulSite ); x++ )
+					{
+					}
+
+					if( x == xSites )
+					{
+						if( xSites == xMaxSites )
+						{
+							/* Sites past the end of the table are left out. */
+							continue;
+						}
+
+						pxSites[ x ].ulSite = pxBlock->ulSite;
+						pxSites[ x ].xBlocks = 0;
+						pxSites[ x ].xBytes = 0;
+						pxSites[ x ].uxOldestAge = 0;
+						xSites++;
+					}
+
+					pxSites[ x ].xBlocks++;
+					pxSites[ x ].xBytes += pxBlock->xBlockSize;
+
+					if( uxAge > pxSites[ x ].uxOldestAge )
+					{
+						pxSites[ x ].uxOldestAge = uxAge;
+					}
+				}
+			}
+		}
+		prvHeapUnlock( uxHeapLockState );
+
+		return xSites;
+	}
+
+#endif /* configHEAP_TRACK_OWNERS */
+
+#endif /* configHEAP_IMPLEMENTATION */
@@ -0,0 +1,348 @@
+/*
+ * Free list report shared by every allocator in portable/MemMang.
+ *
+ * vPrintFreeList() takes a snapshot of the free list through
+ * vPortGetHeapSnapshot(), so the heap is only held for one copy of the block
+ * descriptors.  Each line of the table is then one BINLOG() site: formatted
+ * on the target by xLogPrintf(), or with binlogENABLE sent as a record of
+ * raw words for Tools/binlog_decode.py to format.
+ *
+ * xPrintHeapChanges() sends only what has happened to the free list since the
+ * previous report, from the heap's change journal - see xPortGetHeapChanges()
+ * - and nothing at all while the heap is idle.  The first report, and any
+ * made after the journal has wrapped past the last one, fall back to the whole
+ * list from vPrintFreeList().
+ *
+ * vPrintHeapStats() reports the figures from vPortGetHeapStats() the same
+ * way.
+ *
+ * With configHEAP_TRACK_OWNERS set, vPrintHeapOwners() lists the bytes each
+ * task holds and then the allocated blocks with their owners and call sites.
+ * Those lines carry task names, which a BINLOG() record cannot, so they are
+ * always formatted on the target.
+ *
+ * vPrintHeapLeaks() then lists the call sites holding blocks that have
+ * outlived a number of heap generations, one generation per report.  Only
+ * what changed since the previous report is sent: a site that newly appears
+ * (+), one whose blocks changed (~) and one that has gone (-), then a summary
+ * line.  A site that keeps the same old blocks report after report is a leak.
+ */
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "binlog.h"
+
+/* Most free blocks listed in one report.  Any further blocks are counted in
+the summary line. */
+#ifndef heapREPORT_MAX_BLOCKS
+	#define heapREPORT_MAX_BLOCKS	32
+#endif
+
+static HeapBlockInfo_t xReportBlocks[ heapREPORT_MAX_BLOCKS ];
+
+/* Changes taken from the journal at a time. */
+#ifndef heapREPORT_MAX_CHANGES
+	#define heapREPORT_MAX_CHANGES	16
+#endif
+
+static HeapChange_t xReportChanges[ heapREPORT_MAX_CHANGES ];
+
+/* The journal position the last report left off at, valid once xReportSynced
+is set by a full list. */
+static uint32_t ulReportSequence = 0;
+static BaseType_t xReportSynced = pdFALSE;
+
+#if( configHEAP_TRACK_OWNERS == 1 )
+
+	/* Most allocated blocks listed in one report. */
+	#ifndef heapREPORT_MAX_ALLOCATIONS
+		#define heapREPORT_MAX_ALLOCATIONS	16
+	#endif
+
+	static HeapOwnerInfo_t xReportOwners[ configHEAP_OWNER_SLOTS ];
+	static HeapAllocationInfo_t xReportAllocations[ heapREPORT_MAX_ALLOCATIONS ];
+
+	/* Most call sites listed in one leak report. */
+	#ifndef heapREPORT_MAX_LEAKS
+		#define heapREPORT_MAX_LEAKS	16
+	#endif
+
+	static HeapLeakInfo_t xReportLeaks[ heapREPORT_MAX_LEAKS ];
+	static HeapLeakInfo_t xPreviousLeaks[ heapREPORT_MAX_LEAKS ];
+	static size_t xPreviousLeakSites = 0;
+
+	/*
+	 * What to call the owner in slot uxOwner of xReportOwners[].
+	 */
+	static const char *prvOwnerName( UBaseType_t uxOwner );
+
+	/*
+	 * The entry for ulSite in the first xSites of pxSites, or NULL.
+	 */
+	static const HeapLeakInfo_t *prvFindLeakSite( const HeapLeakInfo_t *pxSites, size_t xSites, uint32_t ulSite );
+
+#endif /* configHEAP_TRACK_OWNERS */
+
+/*-----------------------------------------------------------*/
+
+void vPrintFreeList( void )
+{
+HeapSnapshot_t xSnapshot;
+size_t x;
+
+	vPortGetHeapSnapshot( &xSnapshot, xReportBlocks, heapREPORT_MAX_BLOCKS );
+
+	BINLOG( "StartAddress heapSTRUCT_SIZE xBlockSize EndAddress\n\r" );
+
+	for( x = 0; x < xSnapshot.xBlocksCaptured; x++ )
+	{
+		BINLOG( "0x%08lx         %-10lu%5lu     0x%08lx\n\r",
+				( unsigned long ) ( uint32_t ) xReportBlocks[ x ].pvStartAddress,
+				( unsigned long ) xSnapshot.xHeaderSize,
+				( unsigned long ) xReportBlocks[ x ].xBlockSize,
+				( unsigned long ) ( ( uint32_t ) xReportBlocks[ x ].pvStartAddress + ( uint32_t ) xReportBlocks[ x ].xBlockSize ) );
+	}
+
+	if( xSnapshot.xNumberOfFreeBlocks > xSnapshot.xBlocksCaptured )
+	{
+		BINLOG( "... %lu more free blocks\n\r",
+				( unsigned long ) ( xSnapshot.xNumberOfFreeBlocks - xSnapshot.xBlocksCaptured ) );
+	}
+
+	BINLOG( "configADJUSTED_HEAP_SIZE: %lu xFreeBytesRemaining: %lu\n\r",
+			( unsigned long ) xSnapshot.xHeapSize, ( unsigned long ) xSnapshot.xFreeBytesRemaining );
+
+	/* Changes from here on are the next delta report. */
+	ulReportSequence = xSnapshot.ulSequence;
+	xReportSynced = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPrintHeapChanges( void )
+{
+size_t x, xCopied, xPrinted = 0;
+UBaseType_t uxRounds = 0;
+
+	if( xReportSynced == pdFALSE )
+	{
+		vPrintFreeList();
+		return pdTRUE;
+	}
+
+	/* Bounded, so a heap that changes faster than the lines can be sent
+	cannot keep the reporter here. */
+	do
+	{
+		if( xPortGetHeapChanges( &ulReportSequence, xReportChanges, heapREPORT_MAX_CHANGES, &xCopied ) == pdFALSE )
+		{
+			BINLOG( "heap journal overrun, full list follows\n\r" );
+			vPrintFreeList();
+			return pdTRUE;
+		}
+
+		for( x = 0; x < xCopied; x++ )
+		{
+			/* One site per kind, as a BINLOG() record cannot carry a string. */
+			switch( xReportChanges[ x ].eType )
+			{
+				case eHeapChangeInsert:
+					BINLOG( "free  0x%08lx %5lu\n\r", ( unsigned long ) ( uint32_t ) xReportChanges[ x ].pvStartAddress, ( unsigned long ) xReportChanges[ x ].xBlockSize );
+					break;
+
+				case eHeapChangeRemove:
+					BINLOG( "alloc 0x%08lx %5lu\n\r", ( unsigned long ) ( uint32_t ) xReportChanges[ x ].pvStartAddress, ( unsigned long ) xReportChanges[ x ].xBlockSize );
+					break;
+
+				case eHeapChangeSplit:
+					BINLOG( "split 0x%08lx %5lu\n\r", ( unsigned long ) ( uint32_t ) xReportChanges[ x ].pvStartAddress, ( unsigned long ) xReportChanges[ x ].xBlockSize );
+					break;
+
+				default:
+					BINLOG( "merge 0x%08lx %5lu\n\r", ( unsigned long ) ( uint32_t ) xReportChanges[ x ].pvStartAddress, ( unsigned long ) xReportChanges[ x ].xBlockSize );
+					break;
+			}
+		}
+
+		xPrinted += xCopied;
+		uxRounds++;
+	} while( ( xCopied == heapREPORT_MAX_CHANGES ) && ( uxRounds <= ( UBaseType_t ) ( configHEAP_JOURNAL_LENGTH / heapREPORT_MAX_CHANGES ) ) );
+
+	if( xPrinted == 0 )
+	{
+		return pdFALSE;
+	}
+
+	BINLOG( "heap changes: %lu to %lu xFreeBytesRemaining: %lu\n\r",
+			( unsigned long ) xPrinted, ( unsigned long ) ulReportSequence, ( unsigned long ) xPortGetFreeHeapSize() );
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPrintHeapStats( void )
+{
+HeapStats_t xStats;
+
+	vPortGetHeapStats( &xStats );
+
+	BINLOG( "free/min ever/blocks: %lu/%lu/%lu largest: %lu smallest: %lu\n\r",
+			( unsigned long ) xStats.xAvailableHeapSpaceInBytes,
+			( unsigned long ) xStats.xMinimumEverFreeBytesRemaining,
+			( unsigned long ) xStats.xNumberOfFreeBlocks,
+			( unsigned long ) xStats.xSizeOfLargestFreeBlockInBytes,
+			( unsigned long ) xStats.xSizeOfSmallestFreeBlockInBytes );
+
+	BINLOG( "malloc ok/failed, free: %lu/%lu/%lu\n\r",
+			( unsigned long ) xStats.xNumberOfSuccessfulAllocations,
+			( unsigned long ) xStats.xNumberOfFailedAllocations,
+			( unsigned long ) xStats.xNumberOfSuccessfulFrees );
+
+	/* Two sites, so that the text form of the line fits logPRINTF_LENGTH
+	whatever the counts. */
+	BINLOG( "malloc cycles min/avg/max: %lu/%lu/%lu",
+			( unsigned long ) xStats.ulMallocCyclesMin,
+			( unsigned long ) xStats.ulMallocCyclesAverage,
+			( unsigned long ) xStats.ulMallocCyclesMax );
+	BINLOG( " free: %lu/%lu/%lu\n\r",
+			( unsigned long ) xStats.ulFreeCyclesMin,
+			( unsigned long ) xStats.ulFreeCyclesAverage,
+			( unsigned long ) xStats.ulFreeCyclesMax );
+}
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_TRACK_OWNERS == 1 )
+
+	void vPrintHeapOwners( void )
+	{
+	size_t x, xAllocations, xCaptured;
+	UBaseType_t uxOwner;
+
+		/* The owner table is taken first, so a block may name a slot that has
+		since changed hands.  That is the price of not holding the heap while
+		printing. */
+		vPortGetHeapOwners( xReportOwners );
+		xAllocations = uxPortGetHeapAllocations( xReportAllocations, heapREPORT_MAX_ALLOCATIONS );
+		xCaptured = ( xAllocations < heapREPORT_MAX_ALLOCATIONS ) ? xAllocations : heapREPORT_MAX_ALLOCATIONS;
+
+		( void ) xLogPrintf( "owner      bytes blocks  peak\n\r" );
+
+		for( uxOwner = 0; uxOwner < ( UBaseType_t ) configHEAP_OWNER_SLOTS; uxOwner++ )
+		{
+			if( ( xReportOwners[ uxOwner ].xOwner == NULL ) && ( xReportOwners[ uxOwner ].xBlocks == 0 ) )
+			{
+				continue;
+			}
+
+			( void ) xLogPrintf( "%-10s %5lu %6lu %5lu\n\r", prvOwnerName( uxOwner ),
+								 ( unsigned long ) xReportOwners[ uxOwner ].xBytes,
+								 ( unsigned long ) xReportOwners[ uxOwner ].xBlocks,
+								 ( unsigned long ) xReportOwners[ uxOwner ].xPeakBytes );
+		}
+
+		( void ) xLogPrintf( "StartAddress xBlockSize owner      site\n\r" );
+
+		for( x = 0; x < xCaptured; x++ )
+		{
+			( void ) xLogPrintf( "0x%08lx   %5lu      %-10s 0x%08lx\n\r",
+								 ( unsigned long ) ( uint32_t ) xReportAllocations[ x ].pvStartAddress,
+								 ( unsigned long ) xReportAllocations[ x ].xBlockSize,
+								 prvOwnerName( xReportAllocations[ x ].uxOwner ),
+								 ( unsigned long ) xReportAllocations[ x ].ulSite );
+		}
+
+		if( xAllocations > xCaptured )
+		{
+			( void ) xLogPrintf( "... %lu more allocated blocks\n\r", ( unsigned long ) ( xAllocations - xCaptured ) );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPrintHeapLeaks( UBaseType_t uxMinAge )
+	{
+	const HeapLeakInfo_t *pxPrevious;
+	size_t x, xSites, xBytes = 0;
+	uint32_t ulGeneration;
+
+		xSites = uxPortGetHeapLeaks( xReportLeaks, heapREPORT_MAX_LEAKS, uxMinAge );
+
+		for( x = 0; x < xSites; x++ )
+		{
+			xBytes += xReportLeaks[ x ].xBytes;
+			pxPrevious = prvFindLeakSite( xPreviousLeaks, xPreviousLeakSites, xReportLeaks[ x ].ulSite );
+
+			if( pxPrevious == NULL )
+			{
+				BINLOG( "leak+ 0x%08lx %5lu bytes %4lu blocks age %lu\n\r",
+						( unsigned long ) xReportLeaks[ x ].ulSite,
+						( unsigned long ) xReportLeaks[ x ].xBytes,
+						( unsigned long ) xReportLeaks[ x ].xBlocks,
+						( unsigned long ) xReportLeaks[ x ].uxOldestAge );
+			}
+			else if( ( pxPrevious->xBytes != xReportLeaks[ x ].xBytes ) || ( pxPrevious->xBlocks != xReportLeaks[ x ].xBlocks ) )
+			{
+				BINLOG( "leak~ 0x%08lx %5lu bytes %4lu blocks age %lu\n\r",
+						( unsigned long ) xReportLeaks[ x ].ulSite,
+						( unsigned long ) xReportLeaks[ x ].xBytes,
+						( unsigned long ) xReportLeaks[ x ].xBlocks,
+						( unsigned long ) xReportLeaks[ x ].uxOldestAge );
+			}
+		}
+
+		for( x = 0; x < xPreviousLeakSites; x++ )
+		{
+			if( prvFindLeakSite( xReportLeaks, xSites, xPreviousLeaks[ x ].ulSite ) == NULL )
+			{
+				BINLOG( "leak- 0x%08lx\n\r", ( unsigned long ) xPreviousLeaks[ x ].ulSite );
+			}
+		}
+
+		for( x = 0; x < xSites; x++ )
+		{
+			xPreviousLeaks[ x ] = xReportLeaks[ x ];
+		}
+		xPreviousLeakSites = xSites;
+
+		/* Blocks allocated from here on are one generation younger than
+		those this report has seen. */
+		ulGeneration = ulPortHeapNewGeneration();
+
+		BINLOG( "leaks: %lu sites %lu bytes older than %lu, generation %lu\n\r",
+				( unsigned long ) xSites, ( unsigned long ) xBytes,
+				( unsigned long ) uxMinAge, ( unsigned long ) ulGeneration );
+	}
+	/*-----------------------------------------------------------*/
+
+	static const HeapLeakInfo_t *prvFindLeakSite( const HeapLeakInfo_t *pxSites, size_t xSites, uint32_t ulSite )
+	{
+	size_t x;
+
+		for( x = 0; x < xSites; x++ )
+		{
+			if( pxSites[ x ].ulSite == ulSite )
+			{
+				return &( pxSites[ x ] );
+			}
+		}
+
+		return NULL;
+	}
+	/*-----------------------------------------------------------*/
+
+	static const char *prvOwnerName( UBaseType_t uxOwner )
+	{
+		if( uxOwner == 0 )
+		{
+			return "(none)";
+		}
+		else if( xReportOwners[ uxOwner ].xOwner == NULL )
+		{
+			return "(deleted)";
+		}
+		else
+		{
+			return xReportOwners[ uxOwner ].pcTaskName;
+		}
+	}
+
+#endif /* configHEAP_TRACK_OWNERS */
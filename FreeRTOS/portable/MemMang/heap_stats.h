@@ -0,0 +1,272 @@
+/*
+ * Allocation counters and DWT latency accumulators shared by the allocators
+ * in portable/MemMang.  Each allocator keeps one HeapCounters_t, updates it
+ * with the heap locked and copies it out in vPortGetHeapStats().
+ *
+ * Latency is measured from just after the heap is locked to just before it is
+ * unlocked, so it covers the allocator itself and not the context switch
+ * unlocking may perform.  It is only collected when configGENERATE_HEAP_STATS
+ * is 1; the counters are always kept.
+ *
+ * The lock suspends the scheduler unless configHEAP_LOCK_CEILING is set, in
+ * which case the caller runs at that priority until it unlocks.  Every heap
+ * user must run below the ceiling, so none of them can run meanwhile, even by
+ * taking a time slice at the ceiling, while tasks above it are not held up at
+ * all.
+ *
+ * Each allocator also keeps a HeapJournal_t, recording every change to its
+ * free list with the heap locked, for xPortGetHeapChanges().  The journal is a
+ * ring, so a reader that falls more than configHEAP_JOURNAL_LENGTH changes
+ * behind is told to start again from a snapshot.
+ */
+
+#ifndef HEAP_STATS_H
+#define HEAP_STATS_H
+
+#include <stdint.h>
+
+/* The journal is indexed with the wrapping sequence count. */
+#if( ( configHEAP_JOURNAL_LENGTH & ( configHEAP_JOURNAL_LENGTH - 1 ) ) != 0 )
+	#error configHEAP_JOURNAL_LENGTH must be a power of two
+#endif
+
+#if( configGENERATE_HEAP_STATS == 1 )
+	#include "dwt.h"
+	#define heapSTATS_TIMESTAMP()		ulDwtCycles()
+#else
+	#define heapSTATS_TIMESTAMP()		( 0UL )
+#endif
+
+typedef struct xHEAP_LATENCY
+{
+	uint32_t ulMinCycles;
+	uint32_t ulMaxCycles;
+	uint64_t ullTotalCycles;
+	uint32_t ulSamples;
+} HeapLatency_t;
+
+typedef struct xHEAP_COUNTERS
+{
+	size_t xSuccessfulAllocations;
+	size_t xFailedAllocations;
+	size_t xSuccessfulFrees;
+	HeapLatency_t xMallocLatency;
+	HeapLatency_t xFreeLatency;
+} HeapCounters_t;
+
+typedef struct xHEAP_JOURNAL
+{
+	uint32_t ulSequence;			/* Changes recorded, wrapping. */
+	#if( configHEAP_JOURNAL_LENGTH > 0 )
+		HeapChange_t xChanges[ configHEAP_JOURNAL_LENGTH ];
+	#endif
+} HeapJournal_t;
+
+/* prvHeapLock() returns what prvHeapUnlock() needs to undo it, the priority
+the caller ran at before the ceiling, so nothing is left in a static for the
+next caller to overwrite. */
+static inline UBaseType_t prvHeapLock( void )
+{
+	#if( configHEAP_LOCK_CEILING > 0 )
+	{
+		return uxTaskPriorityCeilingRaise( configHEAP_LOCK_CEILING );
+	}
+	#else
+	{
+		vTaskSuspendAll();
+		return ( UBaseType_t ) 0;
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static inline void prvHeapUnlock( UBaseType_t uxHeapLockState )
+{
+	#if( configHEAP_LOCK_CEILING > 0 )
+	{
+		vTaskPriorityCeilingRestore( configHEAP_LOCK_CEILING, uxHeapLockState );
+	}
+	#else
+	{
+		( void ) uxHeapLockState;
+		( void ) xTaskResumeAll();
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static inline void prvHeapWatchCheck( void )
+{
+	#if( configUSE_HEAP_WATCH == 1 )
+	{
+		vPortHeapWatchCheck();
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static inline void prvHeapStatsInit( void )
+{
+	#if( configGENERATE_HEAP_STATS == 1 )
+	{
+		vDwtInit();
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static inline void prvHeapLatencyRecord( HeapLatency_t *pxLatency, uint32_t ulStartCycles )
+{
+	#if( configGENERATE_HEAP_STATS == 1 )
+	{
+	uint32_t ulCycles = ulDwtCycles() - ulStartCycles;
+
+		if( ( pxLatency->ulSamples == 0UL ) || ( ulCycles < pxLatency->ulMinCycles ) )
+		{
+			pxLatency->ulMinCycles = ulCycles;
+		}
+
+		if( ulCycles > pxLatency->ulMaxCycles )
+		{
+			pxLatency->ulMaxCycles = ulCycles;
+		}
+
+		pxLatency->ullTotalCycles += ulCycles;
+		pxLatency->ulSamples++;
+	}
+	#else
+	{
+		( void ) pxLatency;
+		( void ) ulStartCycles;
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static inline void prvHeapStatsMalloc( HeapCounters_t *pxCounters, const void *pvReturn, size_t xWantedSize, uint32_t ulStartCycles )
+{
+	/* A zero length request is not an allocation attempt. */
+	if( xWantedSize > 0 )
+	{
+		if( pvReturn != NULL )
+		{
+			pxCounters->xSuccessfulAllocations++;
+		}
+		else
+		{
+			pxCounters->xFailedAllocations++;
+		}
+
+		prvHeapLatencyRecord( &( pxCounters->xMallocLatency ), ulStartCycles );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static inline void prvHeapStatsFree( HeapCounters_t *pxCounters, uint32_t ulStartCycles )
+{
+	pxCounters->xSuccessfulFrees++;
+	prvHeapLatencyRecord( &( pxCounters->xFreeLatency ), ulStartCycles );
+}
+/*-----------------------------------------------------------*/
+
+static inline void prvHeapStatsFreeBatch( HeapCounters_t *pxCounters, size_t xBlocks, uint32_t ulStartCycles )
+{
+	/* The whole batch is timed as one sample. */
+	pxCounters->xSuccessfulFrees += xBlocks;
+	prvHeapLatencyRecord( &( pxCounters->xFreeLatency ), ulStartCycles );
+}
+/*-----------------------------------------------------------*/
+
+static inline void prvHeapStatsAddFreeBlock( HeapStats_t *pxHeapStats, size_t xBlockSize )
+{
+	if( xBlockSize > pxHeapStats->xSizeOfLargestFreeBlockInBytes )
+	{
+		pxHeapStats->xSizeOfLargestFreeBlockInBytes = xBlockSize;
+	}
+
+	if( ( pxHeapStats->xNumberOfFreeBlocks == 0 ) || ( xBlockSize < pxHeapStats->xSizeOfSmallestFreeBlockInBytes ) )
+	{
+		pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xBlockSize;
+	}
+
+	pxHeapStats->xNumberOfFreeBlocks++;
+}
+/*-----------------------------------------------------------*/
+
+static inline uint32_t prvHeapLatencyAverage( const HeapLatency_t *pxLatency )
+{
+	return ( pxLatency->ulSamples == 0UL ) ? 0UL : ( uint32_t ) ( pxLatency->ullTotalCycles / pxLatency->ulSamples );
+}
+/*-----------------------------------------------------------*/
+
+static inline void prvHeapJournalRecord( HeapJournal_t *pxJournal, HeapChangeType_t eType, const void *pvBlock, size_t xBlockSize )
+{
+	#if( configHEAP_JOURNAL_LENGTH > 0 )
+	{
+	HeapChange_t *pxChange = &( pxJournal->xChanges[ pxJournal->ulSequence % ( uint32_t ) configHEAP_JOURNAL_LENGTH ] );
+
+		pxChange->eType = eType;
+		pxChange->pvStartAddress = ( void * ) pvBlock;
+		pxChange->xBlockSize = xBlockSize;
+	}
+	#else
+	{
+		( void ) eType;
+		( void ) pvBlock;
+		( void ) xBlockSize;
+	}
+	#endif
+
+	pxJournal->ulSequence++;
+}
+/*-----------------------------------------------------------*/
+
+/* Called with the heap locked, see xPortGetHeapChanges(). */
+static inline BaseType_t prvHeapJournalCopy( const HeapJournal_t *pxJournal, uint32_t *pulSequence, HeapChange_t *pxChanges, size_t xMaxChanges, size_t *pxChangesCopied )
+{
+uint32_t ulPending = pxJournal->ulSequence - *pulSequence;
+size_t x = 0;
+
+	/* The oldest wanted change has been overwritten, or with no journal at
+	all, was never kept. */
+	if( ulPending > ( uint32_t ) configHEAP_JOURNAL_LENGTH )
+	{
+		*pulSequence = pxJournal->ulSequence;
+		*pxChangesCopied = 0;
+		return pdFALSE;
+	}
+
+	#if( configHEAP_JOURNAL_LENGTH > 0 )
+	{
+		for( ; ( x < xMaxChanges ) && ( x < ( size_t ) ulPending ); x++ )
+		{
+			pxChanges[ x ] = pxJournal->xChanges[ ( *pulSequence + ( uint32_t ) x ) % ( uint32_t ) configHEAP_JOURNAL_LENGTH ];
+		}
+	}
+	#else
+	{
+		( void ) pxChanges;
+		( void ) xMaxChanges;
+	}
+	#endif
+
+	*pulSequence += ( uint32_t ) x;
+	*pxChangesCopied = x;
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static inline void prvHeapStatsCopy( const HeapCounters_t *pxCounters, HeapStats_t *pxHeapStats )
+{
+	pxHeapStats->xNumberOfSuccessfulAllocations = pxCounters->xSuccessfulAllocations;
+	pxHeapStats->xNumberOfFailedAllocations = pxCounters->xFailedAllocations;
+	pxHeapStats->xNumberOfSuccessfulFrees = pxCounters->xSuccessfulFrees;
+	pxHeapStats->ulMallocCyclesMin = pxCounters->xMallocLatency.ulMinCycles;
+	pxHeapStats->ulMallocCyclesMax = pxCounters->xMallocLatency.ulMaxCycles;
+	pxHeapStats->ulMallocCyclesAverage = prvHeapLatencyAverage( &( pxCounters->xMallocLatency ) );
+	pxHeapStats->ulFreeCyclesMin = pxCounters->xFreeLatency.ulMinCycles;
+	pxHeapStats->ulFreeCyclesMax = pxCounters->xFreeLatency.ulMaxCycles;
+	pxHeapStats->ulFreeCyclesAverage = prvHeapLatencyAverage( &( pxCounters->xFreeLatency ) );
+}
+
+#endif /* HEAP_STATS_H */
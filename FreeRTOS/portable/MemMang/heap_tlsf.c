@@ -0,0 +1,756 @@
+/*
+ * A two-level segregated fit (TLSF) implementation of pvPortMalloc() and
+ * vPortFree().  Both operations run in bounded, constant time regardless of
+ * how fragmented the heap is, which makes their worst case latency something
+ * that can be stated rather than measured.
+ *
+ * Free blocks are kept in one of heapFL_INDEX_COUNT x heapSL_INDEX_COUNT
+ * lists.  The first level index is the position of the most significant bit
+ * of the block size, the second level index splits each power of two range
+ * into heapSL_INDEX_COUNT equal slices.  A bitmap per level records which
+ * lists are non-empty, so a suitable list is found with two CLZ/CTZ
+ * operations and no searching.
+ *
+ * Blocks use the same boundary tags as heap_btag.c - a size word with
+ * allocated/previous-allocated flag bits, plus a footer on free blocks - so
+ * coalescing with both neighbours is also constant time.
+ *
+ * Select this file by setting configHEAP_IMPLEMENTATION to
+ * heapIMPLEMENTATION_TLSF in FreeRTOSConfig.h.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "FreeRTOSConfig.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_TLSF )
+
+#include "heap_stats.h"
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+/* A few bytes might be lost to byte aligning the heap start address. */
+#define configADJUSTED_HEAP_SIZE	( configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT )
+
+/* Allocate the memory for the heap. */
+#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+	extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* log2 of the number of second level lists per first level range. */
+#define heapSL_INDEX_COUNT_LOG2		( 4 )
+#define heapSL_INDEX_COUNT			( 1 << heapSL_INDEX_COUNT_LOG2 )
+
+/* Blocks below heapSMALL_BLOCK_SIZE all share first level list 0, which is
+split linearly in portBYTE_ALIGNMENT steps. */
+#define heapALIGN_SIZE_LOG2			( 3 )
+#define heapFL_INDEX_SHIFT			( heapSL_INDEX_COUNT_LOG2 + heapALIGN_SIZE_LOG2 )
+#define heapSMALL_BLOCK_SIZE		( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+
+/* The lists describe blocks of less than 2^heapFL_INDEX_MAX bytes, which
+covers the whole of SRAM1 or CCM on this part.  A block of 2^heapFL_INDEX_MAX
+or more would map to a first level of heapFL_INDEX_COUNT, one past the end. */
+#define heapFL_INDEX_MAX			( 17 )
+#define heapFL_INDEX_COUNT			( heapFL_INDEX_MAX - heapFL_INDEX_SHIFT + 1 )
+
+#if( ( 1 << heapALIGN_SIZE_LOG2 ) != portBYTE_ALIGNMENT )
+	#error heapALIGN_SIZE_LOG2 must match portBYTE_ALIGNMENT
+#endif
+
+/* The header at the start of every block.  See heap_btag.c. */
+typedef struct A_TLSF_BLOCK
+{
+	size_t xBlockSize;						/*<< Size of the block plus flag bits. */
+	struct A_TLSF_BLOCK *pxNextFreeBlock;	/*<< Next free block in the same list. */
+	struct A_TLSF_BLOCK *pxPrevFreeBlock;	/*<< Previous free block in the same list. */
+} TlsfBlock_t;
+
+#define heapBLOCK_ALLOCATED		( ( size_t ) 0x01 )
+#define heapPREV_ALLOCATED		( ( size_t ) 0x02 )
+#define heapFLAG_MASK			( ( size_t ) portBYTE_ALIGNMENT_MASK )
+
+#define heapBLOCK_SIZE( pxBlock )		( ( pxBlock )->xBlockSize & ~heapFLAG_MASK )
+#define heapNEXT_PHYSICAL( pxBlock )	( ( TlsfBlock_t * ) ( ( ( uint8_t * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+#define heapFOOTER( pxBlock )			( * ( size_t * ) ( ( ( uint8_t * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) - sizeof( size_t ) ) )
+
+static const uint16_t heapSTRUCT_SIZE	= ( ( sizeof( size_t ) + ( portBYTE_ALIGNMENT - 1 ) ) & ~portBYTE_ALIGNMENT_MASK );
+#define heapMINIMUM_BLOCK_SIZE	( ( ( sizeof( TlsfBlock_t ) + sizeof( size_t ) ) + ( portBYTE_ALIGNMENT - 1 ) ) & ~portBYTE_ALIGNMENT_MASK )
+
+/* The segregated lists and the bitmaps that summarise them. */
+static TlsfBlock_t *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+static uint32_t ulFirstLevelBitmap = 0;
+static uint32_t ulSecondLevelBitmap[ heapFL_INDEX_COUNT ];
+
+/* Keeps track of the number of free bytes remaining, and the lowest that
+value has ever been. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+
+/* Allocation counts and latencies reported by vPortGetHeapStats(). */
+static HeapCounters_t xHeapCounters = { 0 };
+
+/* Blocks only enter and leave the bins here, so the journal holds inserts and
+removes, with no splits or merges. */
+static HeapJournal_t xHeapJournal = { 0 };
+
+/* __builtin_clz()/__builtin_ctz() compile to CLZ (plus RBIT) on the
+Cortex-M4, so both are single cycle operations. */
+#define heapFLS( x )	( ( UBaseType_t ) ( 31 - __builtin_clz( ( unsigned int ) ( x ) ) ) )
+#define heapFFS( x )	( ( UBaseType_t ) __builtin_ctz( ( unsigned int ) ( x ) ) )
+
+/*
+ * Initialises the heap structures before their first use.
+ */
+static void prvHeapInit( void );
+
+/*
+ * Compute the list indexes for a block of xBlockSize bytes.
+ */
+static void prvMappingInsert( size_t xBlockSize, UBaseType_t *puxFl, UBaseType_t *puxSl ) portHEAP_HOT_PATH;
+
+/*
+ * Add a free block to, or remove it from, its segregated list.
+ */
+static void prvInsertFreeBlock( TlsfBlock_t *pxBlock ) portHEAP_HOT_PATH;
+static void prvRemoveFreeBlock( TlsfBlock_t *pxBlock ) portHEAP_HOT_PATH;
+
+/*
+ * Return a free block of at least xWantedSize bytes, or NULL.  Constant time.
+ */
+static TlsfBlock_t *prvFindSuitableBlock( size_t xWantedSize ) portHEAP_HOT_PATH;
+
+/*
+ * Merge the allocated block pxLink with any free neighbours and file the
+ * result as free.  The caller accounts for the bytes.
+ */
+static void prvReleaseBlock( TlsfBlock_t *pxLink ) portHEAP_HOT_PATH;
+
+/*
+ * The size of block, header included, that holds xWantedSize bytes, or 0 if
+ * the heap could never hold that many.
+ */
+static size_t prvRequiredBlockSize( size_t xWantedSize ) portHEAP_HOT_PATH;
+
+/*
+ * Cut the allocated block pxBlock down to xBlockSize bytes and release the
+ * rest, if the rest is large enough to be a block.
+ */
+static void prvTrimBlock( TlsfBlock_t *pxBlock, size_t xBlockSize ) portHEAP_HOT_PATH;
+
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xBlockSize, UBaseType_t *puxFl, UBaseType_t *puxSl )
+{
+UBaseType_t uxMsb;
+
+	if( xBlockSize < heapSMALL_BLOCK_SIZE )
+	{
+		*puxFl = 0;
+		*puxSl = ( UBaseType_t ) ( xBlockSize / ( heapSMALL_BLOCK_SIZE / heapSL_INDEX_COUNT ) );
+	}
+	else
+	{
+		uxMsb = heapFLS( xBlockSize );
+		*puxSl = ( UBaseType_t ) ( ( xBlockSize >> ( uxMsb - heapSL_INDEX_COUNT_LOG2 ) ) ^ ( 1UL << heapSL_INDEX_COUNT_LOG2 ) );
+		*puxFl = uxMsb - heapFL_INDEX_SHIFT + 1;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( TlsfBlock_t *pxBlock )
+{
+UBaseType_t uxFl, uxSl;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &uxFl, &uxSl );
+
+	pxBlock->pxPrevFreeBlock = NULL;
+	pxBlock->pxNextFreeBlock = pxFreeLists[ uxFl ][ uxSl ];
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock;
+	}
+
+	pxFreeLists[ uxFl ][ uxSl ] = pxBlock;
+	ulFirstLevelBitmap |= ( 1UL << uxFl );
+	ulSecondLevelBitmap[ uxFl ] |= ( 1UL << uxSl );
+	prvHeapJournalRecord( &xHeapJournal, eHeapChangeInsert, pxBlock, heapBLOCK_SIZE( pxBlock ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( TlsfBlock_t *pxBlock )
+{
+UBaseType_t uxFl, uxSl;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &uxFl, &uxSl );
+	prvHeapJournalRecord( &xHeapJournal, eHeapChangeRemove, pxBlock, heapBLOCK_SIZE( pxBlock ) );
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock->pxPrevFreeBlock;
+	}
+
+	if( pxBlock->pxPrevFreeBlock != NULL )
+	{
+		pxBlock->pxPrevFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		pxFreeLists[ uxFl ][ uxSl ] = pxBlock->pxNextFreeBlock;
+
+		if( pxFreeLists[ uxFl ][ uxSl ] == NULL )
+		{
+			ulSecondLevelBitmap[ uxFl ] &= ~( 1UL << uxSl );
+
+			if( ulSecondLevelBitmap[ uxFl ] == 0UL )
+			{
+				ulFirstLevelBitmap &= ~( 1UL << uxFl );
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static TlsfBlock_t *prvFindSuitableBlock( size_t xWantedSize )
+{
+UBaseType_t uxFl, uxSl;
+uint32_t ulMap;
+
+	/* Round the request up to the start of the next second level slice, so
+	that any block in the list it maps to is large enough.  This trades a
+	little internal fragmentation for never having to search a list. */
+	if( xWantedSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xWantedSize += ( ( size_t ) 1 << ( heapFLS( xWantedSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1;
+	}
+
+	prvMappingInsert( xWantedSize, &uxFl, &uxSl );
+
+	if( uxFl >= heapFL_INDEX_COUNT )
+	{
+		return NULL;
+	}
+
+	/* First try the lists in the same first level range. */
+	ulMap = ulSecondLevelBitmap[ uxFl ] & ( ~0UL << uxSl );
+
+	if( ulMap == 0UL )
+	{
+		/* Nothing there, so take the smallest non-empty larger range. */
+		ulMap = ( uxFl + 1 < 32 ) ? ( ulFirstLevelBitmap & ( ~0UL << ( uxFl + 1 ) ) ) : 0UL;
+
+		if( ulMap == 0UL )
+		{
+			return NULL;
+		}
+
+		uxFl = heapFFS( ulMap );
+		ulMap = ulSecondLevelBitmap[ uxFl ];
+	}
+
+	uxSl = heapFFS( ulMap );
+
+	return pxFreeLists[ uxFl ][ uxSl ];
+}
+/*-----------------------------------------------------------*/
+
+portHEAP_HOT_PATH void *pvPortMalloc( size_t xWantedSize )
+{
+TlsfBlock_t *pxBlock, *pxNewBlockLink;
+static BaseType_t xHeapHasBeenInitialised = pdFALSE;
+void *pvReturn = NULL;
+uint32_t ulStartCycles;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+			xHeapHasBeenInitialised = pdTRUE;
+		}
+
+		ulStartCycles = heapSTATS_TIMESTAMP();
+
+		/* The wanted size is increased so it can contain the size word, and
+		rounded up so the block can later hold its free list links and
+		footer. */
+		if( xWantedSize > 0 )
+		{
+			xWantedSize += heapSTRUCT_SIZE;
+
+			if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0 )
+			{
+				xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+			}
+
+			if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+			{
+				xWantedSize = heapMINIMUM_BLOCK_SIZE;
+			}
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize <= xFreeBytesRemaining ) )
+		{
+			pxBlock = prvFindSuitableBlock( xWantedSize );
+
+			if( pxBlock != NULL )
+			{
+				prvRemoveFreeBlock( pxBlock );
+
+				/* Split off and re-file the remainder if it is big enough to
+				be a block in its own right. */
+				if( ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) >= heapMINIMUM_BLOCK_SIZE )
+				{
+					pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+					pxNewBlockLink->xBlockSize = ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) | heapPREV_ALLOCATED;
+					heapFOOTER( pxNewBlockLink ) = heapBLOCK_SIZE( pxNewBlockLink );
+					prvInsertFreeBlock( pxNewBlockLink );
+
+					pxBlock->xBlockSize = xWantedSize | ( pxBlock->xBlockSize & heapPREV_ALLOCATED );
+				}
+				else
+				{
+					heapNEXT_PHYSICAL( pxBlock )->xBlockSize |= heapPREV_ALLOCATED;
+				}
+
+				pxBlock->xBlockSize |= heapBLOCK_ALLOCATED;
+				xFreeBytesRemaining -= heapBLOCK_SIZE( pxBlock );
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+
+				pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + heapSTRUCT_SIZE );
+			}
+		}
+
+		prvHeapStatsMalloc( &xHeapCounters, pvReturn, xWantedSize, ulStartCycles );
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	prvHeapUnlock( uxHeapLockState );
+	prvHeapWatchCheck();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+portHEAP_HOT_PATH void *pvPortMallocFlags( size_t xWantedSize, UBaseType_t uxFlags )
+{
+	/* There is only the one heap, in DMA capable SRAM. */
+	( void ) uxFlags;
+	return pvPortMalloc( xWantedSize );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseBlock( TlsfBlock_t *pxLink )
+{
+TlsfBlock_t *pxNeighbour;
+size_t xBlockSize = heapBLOCK_SIZE( pxLink );
+
+	/* Merge with the physically following block if it is free. */
+	pxNeighbour = heapNEXT_PHYSICAL( pxLink );
+
+	if( ( pxNeighbour->xBlockSize & heapBLOCK_ALLOCATED ) == 0 )
+	{
+		prvRemoveFreeBlock( pxNeighbour );
+		xBlockSize += heapBLOCK_SIZE( pxNeighbour );
+	}
+	else
+	{
+		pxNeighbour->xBlockSize &= ~heapPREV_ALLOCATED;
+	}
+
+	/* Merge with the physically preceding block if it is free. */
+	if( ( pxLink->xBlockSize & heapPREV_ALLOCATED ) == 0 )
+	{
+		pxNeighbour = ( void * ) ( ( ( uint8_t * ) pxLink ) - * ( ( size_t * ) pxLink - 1 ) );
+		prvRemoveFreeBlock( pxNeighbour );
+		xBlockSize += heapBLOCK_SIZE( pxNeighbour );
+		pxLink = pxNeighbour;
+	}
+
+	pxLink->xBlockSize = xBlockSize | heapPREV_ALLOCATED;
+	heapFOOTER( pxLink ) = xBlockSize;
+	prvInsertFreeBlock( pxLink );
+}
+/*-----------------------------------------------------------*/
+
+portHEAP_HOT_PATH void vPortFree( void *pv )
+{
+TlsfBlock_t *pxLink;
+size_t xFreedSize;
+uint32_t ulStartCycles;
+UBaseType_t uxHeapLockState;
+
+	if( pv != NULL )
+	{
+		pxLink = ( void * ) ( ( ( uint8_t * ) pv ) - heapSTRUCT_SIZE );
+		configASSERT( ( pxLink->xBlockSize & heapBLOCK_ALLOCATED ) != 0 );
+
+		uxHeapLockState = prvHeapLock();
+		{
+			ulStartCycles = heapSTATS_TIMESTAMP();
+
+			xFreedSize = heapBLOCK_SIZE( pxLink );
+			prvReleaseBlock( pxLink );
+
+			xFreeBytesRemaining += xFreedSize;
+			prvHeapStatsFree( &xHeapCounters, ulStartCycles );
+			traceFREE( pv, xFreedSize );
+		}
+		prvHeapUnlock( uxHeapLockState );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvRequiredBlockSize( size_t xWantedSize )
+{
+	if( ( xWantedSize == 0 ) || ( xWantedSize >= ( configADJUSTED_HEAP_SIZE - heapSTRUCT_SIZE ) ) )
+	{
+		return 0;
+	}
+
+	/* Same rounding as pvPortMalloc(). */
+	xWantedSize += heapSTRUCT_SIZE;
+
+	if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0 )
+	{
+		xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+	}
+
+	if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+	{
+		xWantedSize = heapMINIMUM_BLOCK_SIZE;
+	}
+
+	return xWantedSize;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTrimBlock( TlsfBlock_t *pxBlock, size_t xBlockSize )
+{
+TlsfBlock_t *pxNewBlockLink;
+
+	if( ( heapBLOCK_SIZE( pxBlock ) - xBlockSize ) >= heapMINIMUM_BLOCK_SIZE )
+	{
+		/* The tail starts life as an allocated block following an allocated
+		block, and is then released like any other. */
+		pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xBlockSize );
+		pxNewBlockLink->xBlockSize = ( heapBLOCK_SIZE( pxBlock ) - xBlockSize ) | heapBLOCK_ALLOCATED | heapPREV_ALLOCATED;
+		pxBlock->xBlockSize = xBlockSize | ( pxBlock->xBlockSize & heapFLAG_MASK );
+
+		xFreeBytesRemaining += heapBLOCK_SIZE( pxNewBlockLink );
+		prvReleaseBlock( pxNewBlockLink );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortRealloc( void *pv, size_t xWantedSize )
+{
+TlsfBlock_t *pxLink, *pxNext;
+size_t xBlockSize, xOldSize;
+void *pvReturn = NULL;
+UBaseType_t uxHeapLockState;
+
+	if( pv == NULL )
+	{
+		return pvPortMalloc( xWantedSize );
+	}
+
+	if( xWantedSize == 0 )
+	{
+		vPortFree( pv );
+		return NULL;
+	}
+
+	pxLink = ( void * ) ( ( ( uint8_t * ) pv ) - heapSTRUCT_SIZE );
+	configASSERT( ( pxLink->xBlockSize & heapBLOCK_ALLOCATED ) != 0 );
+	xBlockSize = prvRequiredBlockSize( xWantedSize );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		xOldSize = heapBLOCK_SIZE( pxLink );
+
+		/* Grow in place by absorbing the physically following block when it
+		is free.  The end marker stops this at the end of the heap. */
+		pxNext = heapNEXT_PHYSICAL( pxLink );
+
+		if( ( xBlockSize > xOldSize ) && ( ( pxNext->xBlockSize & heapBLOCK_ALLOCATED ) == 0 ) && ( ( xOldSize + heapBLOCK_SIZE( pxNext ) ) >= xBlockSize ) )
+		{
+			prvRemoveFreeBlock( pxNext );
+			xFreeBytesRemaining -= heapBLOCK_SIZE( pxNext );
+			pxLink->xBlockSize += heapBLOCK_SIZE( pxNext );
+			heapNEXT_PHYSICAL( pxLink )->xBlockSize |= heapPREV_ALLOCATED;
+		}
+
+		if( ( xBlockSize != 0 ) && ( xBlockSize <= heapBLOCK_SIZE( pxLink ) ) )
+		{
+			prvTrimBlock( pxLink, xBlockSize );
+
+			if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+			{
+				xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+			}
+
+			traceFREE( pv, xOldSize );
+			traceMALLOC( pv, heapBLOCK_SIZE( pxLink ) );
+			pvReturn = pv;
+		}
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	if( pvReturn == NULL )
+	{
+		/* The block has to move, or is too large for the heap, in which case
+		pvPortMalloc() fails and calls the malloc failed hook.  Either way it
+		is growing, so all of the old contents fit in the new block. */
+		pvReturn = pvPortMalloc( xWantedSize );
+
+		if( pvReturn != NULL )
+		{
+			portMEMCPY( pvReturn, pv, xOldSize - heapSTRUCT_SIZE );
+			vPortFree( pv );
+		}
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMallocAligned( size_t xWantedSize, size_t xAlignment, UBaseType_t uxFlags )
+{
+TlsfBlock_t *pxLink, *pxAlignedLink;
+uint8_t *pucBlock, *pucAligned;
+size_t xBlockSize, xLeading;
+UBaseType_t uxHeapLockState;
+
+	configASSERT( ( xAlignment & ( xAlignment - 1 ) ) == 0 );
+
+	xBlockSize = prvRequiredBlockSize( xWantedSize );
+
+	/* pvPortMalloc() already gives portBYTE_ALIGNMENT, and also deals with
+	requests that can never succeed. */
+	if( ( xAlignment <= portBYTE_ALIGNMENT ) || ( xBlockSize == 0 ) )
+	{
+		return pvPortMallocFlags( xWantedSize, uxFlags );
+	}
+
+	/* Allow for the worst case padding - up to xAlignment bytes to reach the
+	boundary, plus one more step of xAlignment if the gap is too small to be
+	given back as a free block.  The request is based on the rounded block
+	size so that it covers any minimum block size as well. */
+	pucBlock = pvPortMallocFlags( ( xBlockSize - heapSTRUCT_SIZE ) + xAlignment + heapMINIMUM_BLOCK_SIZE, uxFlags );
+
+	if( pucBlock == NULL )
+	{
+		return NULL;
+	}
+
+	pucAligned = ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) pucBlock + ( xAlignment - 1 ) ) & ~( ( portPOINTER_SIZE_TYPE ) xAlignment - 1 ) );
+
+	while( ( pucAligned != pucBlock ) && ( ( size_t ) ( pucAligned - pucBlock ) < heapMINIMUM_BLOCK_SIZE ) )
+	{
+		pucAligned += xAlignment;
+	}
+
+	xLeading = ( size_t ) ( pucAligned - pucBlock );
+	pxLink = ( void * ) ( pucBlock - heapSTRUCT_SIZE );
+
+	uxHeapLockState = prvHeapLock();
+	{
+		traceFREE( pucBlock, heapBLOCK_SIZE( pxLink ) );
+
+		/* The padding in front of the aligned address is split off as a block
+		of its own and released, which also clears the heapPREV_ALLOCATED flag
+		of the aligned block. */
+		if( xLeading > 0 )
+		{
+			pxAlignedLink = ( void * ) ( pucAligned - heapSTRUCT_SIZE );
+			pxAlignedLink->xBlockSize = ( heapBLOCK_SIZE( pxLink ) - xLeading ) | heapBLOCK_ALLOCATED | heapPREV_ALLOCATED;
+			pxLink->xBlockSize = xLeading | ( pxLink->xBlockSize & heapFLAG_MASK );
+
+			xFreeBytesRemaining += xLeading;
+			prvReleaseBlock( pxLink );
+			pxLink = pxAlignedLink;
+		}
+
+		prvTrimBlock( pxLink, xBlockSize );
+		traceMALLOC( pucAligned, heapBLOCK_SIZE( pxLink ) );
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return pucAligned;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFreeBatch( void * const pvBlocks[], size_t xCount )
+{
+size_t x;
+
+	/* TLSF already frees in constant time, so there is no list walk to
+	share between the blocks. */
+	for( x = 0; x < xCount; x++ )
+	{
+		vPortFree( pvBlocks[ x ] );
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+TlsfBlock_t *pxFirstFreeBlock, *pxEndMarker;
+uint8_t *pucAlignedHeap;
+size_t xUsableSize;
+
+	prvHeapStatsInit();
+
+	configASSERT( configADJUSTED_HEAP_SIZE < ( ( size_t ) 1 << heapFL_INDEX_MAX ) );
+
+	/* Ensure the heap starts on a correctly aligned boundary. */
+	pucAlignedHeap = ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) &ucHeap[ portBYTE_ALIGNMENT ] ) & ( ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) ) );
+
+	/* Reserve an end marker that looks like a zero length allocated block so
+	the free path never merges past the end of the heap. */
+	xUsableSize = ( configADJUSTED_HEAP_SIZE - heapSTRUCT_SIZE ) & ~portBYTE_ALIGNMENT_MASK;
+
+	pxEndMarker = ( void * ) ( pucAlignedHeap + xUsableSize );
+	pxEndMarker->xBlockSize = heapBLOCK_ALLOCATED;
+
+	pxFirstFreeBlock = ( void * ) pucAlignedHeap;
+	pxFirstFreeBlock->xBlockSize = xUsableSize | heapPREV_ALLOCATED;
+	heapFOOTER( pxFirstFreeBlock ) = xUsableSize;
+	prvInsertFreeBlock( pxFirstFreeBlock );
+
+	xFreeBytesRemaining = xUsableSize;
+	xMinimumEverFreeBytesRemaining = xUsableSize;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapSnapshot( HeapSnapshot_t *pxSnapshot, HeapBlockInfo_t *pxBlocks, size_t xMaxBlocks )
+{
+TlsfBlock_t *pxBlock;
+UBaseType_t uxFl, uxSl;
+size_t xCount = 0;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		/* The lists are visited in size class order, so the blocks come out
+		roughly smallest first, like heap_2.c. */
+		for( uxFl = 0; uxFl < heapFL_INDEX_COUNT; uxFl++ )
+		{
+			for( uxSl = 0; uxSl < heapSL_INDEX_COUNT; uxSl++ )
+			{
+				for( pxBlock = pxFreeLists[ uxFl ][ uxSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+				{
+					if( xCount < xMaxBlocks )
+					{
+						pxBlocks[ xCount ].pvStartAddress = ( void * ) pxBlock;
+						pxBlocks[ xCount ].xBlockSize = heapBLOCK_SIZE( pxBlock );
+					}
+					xCount++;
+				}
+			}
+		}
+
+		pxSnapshot->xFreeBytesRemaining = xFreeBytesRemaining;
+		pxSnapshot->ulSequence = xHeapJournal.ulSequence;
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	pxSnapshot->xHeapSize = configADJUSTED_HEAP_SIZE;
+	pxSnapshot->xHeaderSize = heapSTRUCT_SIZE;
+	pxSnapshot->xNumberOfFreeBlocks = xCount;
+	pxSnapshot->xBlocksCaptured = ( xCount < xMaxBlocks ) ? xCount : xMaxBlocks;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortGetHeapChanges( uint32_t *pulSequence, HeapChange_t *pxChanges, size_t xMaxChanges, size_t *pxChangesCopied )
+{
+BaseType_t xReturn;
+UBaseType_t uxHeapLockState;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		xReturn = prvHeapJournalCopy( &xHeapJournal, pulSequence, pxChanges, xMaxChanges, pxChangesCopied );
+	}
+	prvHeapUnlock( uxHeapLockState );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+TlsfBlock_t *pxBlock;
+UBaseType_t uxFl, uxSl;
+UBaseType_t uxHeapLockState;
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+	pxHeapStats->xNumberOfFreeBlocks = 0;
+
+	uxHeapLockState = prvHeapLock();
+	{
+		for( uxFl = 0; uxFl < heapFL_INDEX_COUNT; uxFl++ )
+		{
+			for( uxSl = 0; uxSl < heapSL_INDEX_COUNT; uxSl++ )
+			{
+				for( pxBlock = pxFreeLists[ uxFl ][ uxSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+				{
+					prvHeapStatsAddFreeBlock( pxHeapStats, heapBLOCK_SIZE( pxBlock ) );
+				}
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		prvHeapStatsCopy( &xHeapCounters, pxHeapStats );
+	}
+	prvHeapUnlock( uxHeapLockState );
+}
+
+#endif /* configHEAP_IMPLEMENTATION */
@@ -0,0 +1,135 @@
+/*
+ * Low-water watches shared by every allocator in portable/MemMang.
+ *
+ * Each watch registered with xPortHeapWatchAdd() has a threshold on the free
+ * bytes and one on the largest free block, either of which may be 0 to leave
+ * it out.  The allocators call vPortHeapWatchCheck() at the end of each
+ * pvPortMalloc(), once the heap is unlocked, and a watch's callback runs the
+ * first time the heap is found below one of its thresholds.  The watch is
+ * then disarmed until a later check finds the heap above both of them again,
+ * so a cache can shrink itself once per shortage rather than once per
+ * allocation.
+ *
+ * Free bytes come from xPortGetFreeHeapSize(), which is cheap.  The largest
+ * free block comes from vPortGetHeapStats(), which walks the free list with
+ * the heap locked, so it is only measured when some watch has a threshold on
+ * it.
+ *
+ * A callback runs in the task that allocated, with the heap unlocked and
+ * interrupts enabled, so it may free memory and allocate.  Allocations it
+ * makes check the watches again, but cannot fire the watch that is running,
+ * which is already disarmed.
+ */
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if( configUSE_HEAP_WATCH == 1 )
+
+typedef struct xHEAP_WATCH
+{
+	size_t xFreeBytesBelow;
+	size_t xLargestBlockBelow;
+	HeapWatchCallback_t pxCallback;
+	void *pvContext;
+	BaseType_t xFired;				/* pdTRUE from the callback until the heap recovers. */
+} HeapWatch_t;
+
+static HeapWatch_t xHeapWatches[ configHEAP_WATCHES ];
+static volatile UBaseType_t uxHeapWatchCount = 0;
+static BaseType_t xHeapWatchLargest = pdFALSE;	/* Some watch has a largest block threshold. */
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortHeapWatchAdd( size_t xFreeBytesBelow, size_t xLargestBlockBelow, HeapWatchCallback_t pxCallback, void *pvContext )
+{
+HeapWatch_t *pxWatch;
+BaseType_t xReturn = pdFAIL;
+
+	configASSERT( pxCallback != NULL );
+
+	taskENTER_CRITICAL();
+	{
+		if( uxHeapWatchCount < ( UBaseType_t ) configHEAP_WATCHES )
+		{
+			pxWatch = &( xHeapWatches[ uxHeapWatchCount ] );
+			pxWatch->xFreeBytesBelow = xFreeBytesBelow;
+			pxWatch->xLargestBlockBelow = xLargestBlockBelow;
+			pxWatch->pxCallback = pxCallback;
+			pxWatch->pvContext = pvContext;
+			pxWatch->xFired = pdFALSE;
+
+			if( xLargestBlockBelow > 0 )
+			{
+				xHeapWatchLargest = pdTRUE;
+			}
+
+			/* Counted last, so a check never sees a half written watch. */
+			uxHeapWatchCount++;
+			xReturn = pdPASS;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortHeapWatchCheck( void )
+{
+HeapStats_t xHeapStats;
+HeapWatch_t *pxWatch;
+UBaseType_t ux, uxCount = uxHeapWatchCount;
+size_t xFreeBytes, xLargestFreeBlock = 0;
+BaseType_t xLow, xFire;
+
+	if( uxCount == 0 )
+	{
+		return;
+	}
+
+	if( xHeapWatchLargest != pdFALSE )
+	{
+		vPortGetHeapStats( &xHeapStats );
+		xFreeBytes = xHeapStats.xAvailableHeapSpaceInBytes;
+		xLargestFreeBlock = xHeapStats.xSizeOfLargestFreeBlockInBytes;
+	}
+	else
+	{
+		xFreeBytes = xPortGetFreeHeapSize();
+	}
+
+	for( ux = 0; ux < uxCount; ux++ )
+	{
+		pxWatch = &( xHeapWatches[ ux ] );
+
+		/* A threshold of 0 is never crossed. */
+		xLow = ( ( xFreeBytes < pxWatch->xFreeBytesBelow ) || ( xLargestFreeBlock < pxWatch->xLargestBlockBelow ) ) ? pdTRUE : pdFALSE;
+
+		if( xLow == pxWatch->xFired )
+		{
+			continue;
+		}
+
+		/* Another task may be checking the same watch, so only the one that
+		changes its state runs the callback. */
+		xFire = pdFALSE;
+		taskENTER_CRITICAL();
+		{
+			if( pxWatch->xFired != xLow )
+			{
+				pxWatch->xFired = xLow;
+				xFire = xLow;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xFire != pdFALSE )
+		{
+			pxWatch->pxCallback( pxWatch->pvContext, xFreeBytes, xLargestFreeBlock );
+		}
+	}
+}
+
+#endif /* configUSE_HEAP_WATCH */
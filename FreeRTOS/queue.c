@@ -41,6 +41,10 @@ task.h is included from an application file. */
 	#include "croutine.h"
 #endif
 
+#if ( configUSE_KERNEL_SLABS == 1 )
+	#include "slab.h"
+#endif
+
 /* Lint e9021, e961 and e750 are suppressed as a MISRA exception justified
 because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
 for the header files above, but not in this file, in order to generate the
@@ -51,6 +55,7 @@ correct privileged Vs unprivileged linkage and placement. */
 /* Constants used with the cRxLock and cTxLock structure members. */
 #define queueUNLOCKED					( ( int8_t ) -1 )
 #define queueLOCKED_UNMODIFIED			( ( int8_t ) 0 )
+#define queueMAX_LOCK_COUNT				( ( int8_t ) 127 )
 
 /* When the Queue_t structure is used to represent a base queue its pcHead and
 pcTail members are used as pointers into the queue storage area.  When the
@@ -81,6 +86,29 @@ zero. */
 #define queueSEMAPHORE_QUEUE_ITEM_LENGTH ( ( UBaseType_t ) 0 )
 #define queueMUTEX_GIVE_BLOCK_TIME		 ( ( TickType_t ) 0U )
 
+/* Copies one item into or out of the queue storage area.  Items of four and
+eight bytes - words, pointers, including the buffers of a zero copy queue, and
+pairs of them, which is what most queues carry - are moved by memcpy() with a
+constant length, which the compiler turns into one or two loads and stores
+that are safe at any alignment on this core, rather than a call to
+portMEMCPY() with a length it only learns at run time. */
+#define prvCopyItem( pxQueue, pvDestination, pvSource )												\
+	do																								\
+	{																								\
+		if( ( pxQueue )->uxItemSize == ( UBaseType_t ) 4 )											\
+		{																							\
+			( void ) memcpy( ( void * ) ( pvDestination ), ( pvSource ), ( size_t ) 4 );			\
+		}																							\
+		else if( ( pxQueue )->uxItemSize == ( UBaseType_t ) 8 )										\
+		{																							\
+			( void ) memcpy( ( void * ) ( pvDestination ), ( pvSource ), ( size_t ) 8 );			\
+		}																							\
+		else																						\
+		{																							\
+			( void ) portMEMCPY( ( void * ) ( pvDestination ), ( pvSource ), ( size_t ) ( pxQueue )->uxItemSize );	\
+		}																							\
+	} while( 0 )
+
 #if( configUSE_PREEMPTION == 0 )
 	/* If the cooperative scheduler is being used then a yield should not be
 	performed just because a higher priority task has been woken. */
@@ -121,6 +149,10 @@ typedef struct QueueDefinition 		/* The old naming convention is used to prevent
 
 	#if ( configUSE_QUEUE_SETS == 1 )
 		struct QueueDefinition *pxQueueSetContainer;
+		uint32_t ulQueueSetReady;		/*< Used by a queue set: one bit per member that holds data. */
+		uint32_t ulQueueSetMembers;		/*< Used by a queue set: one bit per member. */
+		uint8_t ucQueueSetIndex;		/*< Used by a set member: its bit in the set's masks. */
+		uint8_t ucQueueSetMasked;		/*< Used by a queue set: pdTRUE if created by xQueueCreateSetMasked(). */
 	#endif
 
 	#if ( configUSE_TRACE_FACILITY == 1 )
@@ -128,6 +160,10 @@ typedef struct QueueDefinition 		/* The old naming convention is used to prevent
 		uint8_t ucQueueType;
 	#endif
 
+	#if ( configUSE_ZERO_COPY_QUEUES == 1 )
+		MemPool_t *pxBufferPool;	/*< The pool the buffers of a zero copy queue come from, NULL for a queue that copies its items. */
+	#endif
+
 } xQUEUE;
 
 /* The old xQUEUE name is maintained above then typedefed to the new Queue_t
@@ -136,6 +172,27 @@ typedef xQUEUE Queue_t;
 
 /*-----------------------------------------------------------*/
 
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_KERNEL_SLABS == 1 ) )
+
+	/* The structures of dynamically created queues, semaphores and mutexes,
+	packed together in slabs.  The storage area of a queue is a separate
+	block from the heap. */
+	PRIVILEGED_DATA static SlabCache_t xQueueSlabs = slabCACHE_INIT( sizeof( Queue_t ) );
+
+	/*
+	 * Give back the structure of a dynamically created queue and its storage
+	 * area.
+	 */
+	static void prvFreeQueue( Queue_t *pxQueue ) PRIVILEGED_FUNCTION;
+
+#else
+
+	#define prvFreeQueue( pxQueue )		vPortFree( pxQueue )
+
+#endif
+
+/*-----------------------------------------------------------*/
+
 /*
  * The queue registry is just a means for kernel aware debuggers to locate
  * queue structures.  It has no other purpose so is an optional component.
@@ -204,6 +261,18 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer
 	 * the queue set that the queue contains data.
 	 */
 	static BaseType_t prvNotifyQueueSetContainer( const Queue_t * const pxQueue, const BaseType_t xCopyPosition ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Clears a queue's bit in its queue set's ready mask once the queue has
+	 * been emptied.  Must be called from a critical section.
+	 */
+	#define prvQueueSetClearReady( pxQueue )																	\
+		if( ( ( pxQueue )->pxQueueSetContainer != NULL ) && ( ( pxQueue )->uxMessagesWaiting == ( UBaseType_t ) 0 ) )	\
+		{																										\
+			( pxQueue )->pxQueueSetContainer->ulQueueSetReady &= ~( 1UL << ( pxQueue )->ucQueueSetIndex );		\
+		}
+#else
+	#define prvQueueSetClearReady( pxQueue )
 #endif
 
 /*
@@ -231,6 +300,39 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 	 */
 	static UBaseType_t prvGetDisinheritPriorityAfterTimeout( const Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
 #endif
+
+#if( configUSE_QUEUE_BATCH_OPERATIONS == 1 )
+	/*
+	 * Copy as many of uxCount items as fit to the back of the queue, or as many
+	 * of uxCount items as are queued out of the front, with at most two
+	 * memcpy() calls each as the storage wraps.  Both return the number of
+	 * items moved and are called from a critical section.
+	 */
+	static UBaseType_t prvCopyItemsToQueue( Queue_t * const pxQueue, const uint8_t *pucItems, UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+	static UBaseType_t prvCopyItemsFromQueue( Queue_t * const pxQueue, uint8_t *pucItems, UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Unblock up to uxMaxTasks tasks from an event list, one per item moved.
+	 * Returns pdTRUE if any of them has a higher priority than the running
+	 * task.
+	 */
+	static BaseType_t prvUnblockTasks( List_t * const pxEventList, UBaseType_t uxMaxTasks ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Record uxItems moved while the queue was locked, so prvUnlockQueue()
+	 * unblocks as many tasks.  The count saturates, which is harmless as
+	 * prvUnlockQueue() stops once the event list is empty.
+	 */
+	static int8_t prvAddToLockCount( const int8_t cLock, const UBaseType_t uxItems ) PRIVILEGED_FUNCTION;
+#endif
+
+#if( configUSE_ZERO_COPY_QUEUES == 1 )
+	/*
+	 * Returns every buffer still held by a zero copy queue to its pool, oldest
+	 * first.  The queue's read and write positions are left unchanged.
+	 */
+	static void prvReleaseQueuedBuffers( const Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -260,6 +362,21 @@ Queue_t * const pxQueue = xQueue;
 
 	taskENTER_CRITICAL();
 	{
+		#if( configUSE_ZERO_COPY_QUEUES == 1 )
+		{
+			/* The queue owns the buffers it holds, so emptying it returns
+			them to the pool. */
+			if( ( xNewQueue == pdFALSE ) && ( pxQueue->pxBufferPool != NULL ) )
+			{
+				prvReleaseQueuedBuffers( pxQueue );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_ZERO_COPY_QUEUES */
+
 		pxQueue->u.xQueue.pcTail = pxQueue->pcHead + ( pxQueue->uxLength * pxQueue->uxItemSize ); /*lint !e9016 Pointer arithmetic allowed on char types, especially when it assists conveying intent. */
 		pxQueue->uxMessagesWaiting = ( UBaseType_t ) 0U;
 		pxQueue->pcWriteTo = pxQueue->pcHead;
@@ -269,6 +386,8 @@ Queue_t * const pxQueue = xQueue;
 
 		if( xNewQueue == pdFALSE )
 		{
+			prvQueueSetClearReady( pxQueue );
+
 			/* If there are tasks blocked waiting to read from the queue, then
 			the tasks will remain blocked as after this function exits the queue
 			will still be empty.  If there are tasks blocked waiting to write to
@@ -394,14 +513,41 @@ Queue_t * const pxQueue = xQueue;
 		are greater than or equal to the pointer to char requirements the cast
 		is safe.  In other cases alignment requirements are not strict (one or
 		two bytes). */
-		pxNewQueue = ( Queue_t * ) pvPortMalloc( sizeof( Queue_t ) + xQueueSizeInBytes ); /*lint !e9087 !e9079 see comment above. */
+		#if( configUSE_KERNEL_SLABS == 1 )
+		{
+			/* The structure from the slab cache and the storage area, if
+			there is one, from the heap. */
+			pxNewQueue = ( Queue_t * ) pvSlabAlloc( &xQueueSlabs );
+			pucQueueStorage = NULL;
+
+			if( ( pxNewQueue != NULL ) && ( xQueueSizeInBytes > ( size_t ) 0 ) )
+			{
+				pucQueueStorage = ( uint8_t * ) pvPortMalloc( xQueueSizeInBytes );
+
+				if( pucQueueStorage == NULL )
+				{
+					vSlabFree( &xQueueSlabs, pxNewQueue );
+					pxNewQueue = NULL;
+				}
+			}
+		}
+		#else
+		{
+			pxNewQueue = ( Queue_t * ) pvPortMalloc( sizeof( Queue_t ) + xQueueSizeInBytes ); /*lint !e9087 !e9079 see comment above. */
+			pucQueueStorage = NULL;
+
+			if( pxNewQueue != NULL )
+			{
+				/* Jump past the queue structure to find the location of the
+				queue storage area. */
+				pucQueueStorage = ( uint8_t * ) pxNewQueue;
+				pucQueueStorage += sizeof( Queue_t ); /*lint !e9016 Pointer arithmetic allowed on char types, especially when it assists conveying intent. */
+			}
+		}
+		#endif /* configUSE_KERNEL_SLABS */
 
 		if( pxNewQueue != NULL )
 		{
-			/* Jump past the queue structure to find the location of the queue
-			storage area. */
-			pucQueueStorage = ( uint8_t * ) pxNewQueue;
-			pucQueueStorage += sizeof( Queue_t ); /*lint !e9016 Pointer arithmetic allowed on char types, especially when it assists conveying intent. */
 
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
@@ -452,6 +598,12 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 	pxNewQueue->uxItemSize = uxItemSize;
 	( void ) xQueueGenericReset( pxNewQueue, pdTRUE );
 
+	#if( configUSE_ZERO_COPY_QUEUES == 1 )
+	{
+		pxNewQueue->pxBufferPool = NULL;
+	}
+	#endif /* configUSE_ZERO_COPY_QUEUES */
+
 	#if ( configUSE_TRACE_FACILITY == 1 )
 	{
 		pxNewQueue->ucQueueType = ucQueueType;
@@ -461,6 +613,10 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 	#if( configUSE_QUEUE_SETS == 1 )
 	{
 		pxNewQueue->pxQueueSetContainer = NULL;
+		pxNewQueue->ulQueueSetReady = 0U;
+		pxNewQueue->ulQueueSetMembers = 0U;
+		pxNewQueue->ucQueueSetIndex = 0U;
+		pxNewQueue->ucQueueSetMasked = pdFALSE;
 	}
 	#endif /* configUSE_QUEUE_SETS */
 
@@ -1308,6 +1464,7 @@ Queue_t * const pxQueue = xQueue;
 				prvCopyDataFromQueue( pxQueue, pvBuffer );
 				traceQUEUE_RECEIVE( pxQueue );
 				pxQueue->uxMessagesWaiting = uxMessagesWaiting - ( UBaseType_t ) 1;
+				prvQueueSetClearReady( pxQueue );
 
 				/* There is now space in the queue, were any tasks waiting to
 				post to the queue?  If so, unblock the highest priority waiting
@@ -1456,6 +1613,7 @@ Queue_t * const pxQueue = xQueue;
 				/* Semaphores are queues with a data size of zero and where the
 				messages waiting is the semaphore's count.  Reduce the count. */
 				pxQueue->uxMessagesWaiting = uxSemaphoreCount - ( UBaseType_t ) 1;
+				prvQueueSetClearReady( pxQueue );
 
 				#if ( configUSE_MUTEXES == 1 )
 				{
@@ -1816,6 +1974,7 @@ Queue_t * const pxQueue = xQueue;
 
 			prvCopyDataFromQueue( pxQueue, pvBuffer );
 			pxQueue->uxMessagesWaiting = uxMessagesWaiting - ( UBaseType_t ) 1;
+			prvQueueSetClearReady( pxQueue );
 
 			/* If the queue is locked the event list will not be modified.
 			Instead update the lock count so the task that unlocks the queue
@@ -1923,146 +2082,725 @@ Queue_t * const pxQueue = xQueue;
 }
 /*-----------------------------------------------------------*/
 
-UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue )
-{
-UBaseType_t uxReturn;
-
-	configASSERT( xQueue );
+#if( configUSE_QUEUE_BATCH_OPERATIONS == 1 )
 
-	taskENTER_CRITICAL();
+	UBaseType_t uxQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxCount, TickType_t xTicksToWait )
 	{
-		uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
-	}
-	taskEXIT_CRITICAL();
-
-	return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
-/*-----------------------------------------------------------*/
-
-UBaseType_t uxQueueSpacesAvailable( const QueueHandle_t xQueue )
-{
-UBaseType_t uxReturn;
-Queue_t * const pxQueue = xQueue;
+	BaseType_t xEntryTimeSet = pdFALSE;
+	TimeOut_t xTimeOut;
+	UBaseType_t uxSent = 0, uxCopied;
+	Queue_t * const pxQueue = xQueue;
 
-	configASSERT( pxQueue );
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		configASSERT( !( ( pvItems == NULL ) && ( uxCount != ( UBaseType_t ) 0U ) ) );
+		#if ( configUSE_QUEUE_SETS == 1 )
+		{
+			/* A set would need one notification per item. */
+			configASSERT( pxQueue->pxQueueSetContainer == NULL );
+		}
+		#endif
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+		{
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
 
-	taskENTER_CRITICAL();
-	{
-		uxReturn = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
-	}
-	taskEXIT_CRITICAL();
+		/*lint -save -e904 As xQueueGenericSend(). */
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				/* Move everything that fits in one go, then wake as many
+				receivers as there are new items rather than one per call. */
+				if( pxQueue->uxMessagesWaiting < pxQueue->uxLength )
+				{
+					traceQUEUE_SEND( pxQueue );
 
-	return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
-/*-----------------------------------------------------------*/
+					uxCopied = prvCopyItemsToQueue( pxQueue, ( const uint8_t * ) pvItems + ( uxSent * pxQueue->uxItemSize ), uxCount - uxSent );
+					uxSent += uxCopied;
 
-UBaseType_t uxQueueMessagesWaitingFromISR( const QueueHandle_t xQueue )
-{
-UBaseType_t uxReturn;
-Queue_t * const pxQueue = xQueue;
+					if( prvUnblockTasks( &( pxQueue->xTasksWaitingToReceive ), uxCopied ) != pdFALSE )
+					{
+						queueYIELD_IF_USING_PREEMPTION();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 
-	configASSERT( pxQueue );
-	uxReturn = pxQueue->uxMessagesWaiting;
+				if( uxSent == uxCount )
+				{
+					taskEXIT_CRITICAL();
+					return uxSent;
+				}
+				else if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					/* The rest does not fit and no block time is specified
+					(or the block time has expired) so leave now. */
+					taskEXIT_CRITICAL();
+					traceQUEUE_SEND_FAILED( pxQueue );
+					return uxSent;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					vTaskInternalSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			taskEXIT_CRITICAL();
 
-	return uxReturn;
-} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
-/*-----------------------------------------------------------*/
+			vTaskSuspendAll();
+			prvLockQueue( pxQueue );
 
-void vQueueDelete( QueueHandle_t xQueue )
-{
-Queue_t * const pxQueue = xQueue;
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+			{
+				if( prvIsQueueFull( pxQueue ) != pdFALSE )
+				{
+					traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+					vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+					prvUnlockQueue( pxQueue );
 
-	configASSERT( pxQueue );
-	traceQUEUE_DELETE( pxQueue );
+					if( xTaskResumeAll() == pdFALSE )
+					{
+						portYIELD_WITHIN_API();
+					}
+				}
+				else
+				{
+					/* Try again. */
+					prvUnlockQueue( pxQueue );
+					( void ) xTaskResumeAll();
+				}
+			}
+			else
+			{
+				/* The timeout has expired with part of the items sent. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
 
-	#if ( configQUEUE_REGISTRY_SIZE > 0 )
-	{
-		vQueueUnregisterQueue( pxQueue );
+				traceQUEUE_SEND_FAILED( pxQueue );
+				return uxSent;
+			}
+		} /*lint -restore */
 	}
-	#endif
 
-	#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
-	{
-		/* The queue can only have been allocated dynamically - free it
-		again. */
-		vPortFree( pxQueue );
-	}
-	#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
-	{
-		/* The queue could have been allocated statically or dynamically, so
-		check before attempting to free the memory. */
-		if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
-		{
-			vPortFree( pxQueue );
-		}
-		else
-		{
-			mtCOVERAGE_TEST_MARKER();
-		}
-	}
-	#else
-	{
-		/* The queue must have been statically allocated, so is not going to be
-		deleted.  Avoid compiler warnings about the unused parameter. */
-		( void ) pxQueue;
-	}
-	#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
-}
+#endif /* configUSE_QUEUE_BATCH_OPERATIONS */
 /*-----------------------------------------------------------*/
 
-#if ( configUSE_TRACE_FACILITY == 1 )
+#if( configUSE_QUEUE_BATCH_OPERATIONS == 1 )
 
-	UBaseType_t uxQueueGetQueueNumber( QueueHandle_t xQueue )
+	UBaseType_t uxQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxCount, BaseType_t * const pxHigherPriorityTaskWoken )
 	{
-		return ( ( Queue_t * ) xQueue )->uxQueueNumber;
-	}
+	UBaseType_t uxSent = 0;
+	UBaseType_t uxSavedInterruptStatus;
+	Queue_t * const pxQueue = xQueue;
 
-#endif /* configUSE_TRACE_FACILITY */
-/*-----------------------------------------------------------*/
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		configASSERT( !( ( pvItems == NULL ) && ( uxCount != ( UBaseType_t ) 0U ) ) );
+		#if ( configUSE_QUEUE_SETS == 1 )
+		{
+			configASSERT( pxQueue->pxQueueSetContainer == NULL );
+		}
+		#endif
 
-#if ( configUSE_TRACE_FACILITY == 1 )
+		/* See xQueueGenericSendFromISR(). */
+		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-	void vQueueSetQueueNumber( QueueHandle_t xQueue, UBaseType_t uxQueueNumber )
-	{
-		( ( Queue_t * ) xQueue )->uxQueueNumber = uxQueueNumber;
-	}
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( pxQueue->uxMessagesWaiting < pxQueue->uxLength )
+			{
+				const int8_t cTxLock = pxQueue->cTxLock;
 
-#endif /* configUSE_TRACE_FACILITY */
-/*-----------------------------------------------------------*/
+				traceQUEUE_SEND_FROM_ISR( pxQueue );
 
-#if ( configUSE_TRACE_FACILITY == 1 )
+				uxSent = prvCopyItemsToQueue( pxQueue, ( const uint8_t * ) pvItems, uxCount );
 
-	uint8_t ucQueueGetQueueType( QueueHandle_t xQueue )
-	{
-		return ( ( Queue_t * ) xQueue )->ucQueueType;
+				/* The event list is not altered if the queue is locked.  This
+				will be done when the queue is unlocked later. */
+				if( cTxLock == queueUNLOCKED )
+				{
+					if( prvUnblockTasks( &( pxQueue->xTasksWaitingToReceive ), uxSent ) != pdFALSE )
+					{
+						if( pxHigherPriorityTaskWoken != NULL )
+						{
+							*pxHigherPriorityTaskWoken = pdTRUE;
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					pxQueue->cTxLock = prvAddToLockCount( cTxLock, uxSent );
+				}
+			}
+			else
+			{
+				traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return uxSent;
 	}
 
-#endif /* configUSE_TRACE_FACILITY */
+#endif /* configUSE_QUEUE_BATCH_OPERATIONS */
 /*-----------------------------------------------------------*/
 
-#if( configUSE_MUTEXES == 1 )
+#if( configUSE_QUEUE_BATCH_OPERATIONS == 1 )
 
-	static UBaseType_t prvGetDisinheritPriorityAfterTimeout( const Queue_t * const pxQueue )
+	UBaseType_t uxQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxCount, TickType_t xTicksToWait )
 	{
-	UBaseType_t uxHighestPriorityOfWaitingTasks;
+	BaseType_t xEntryTimeSet = pdFALSE;
+	TimeOut_t xTimeOut;
+	UBaseType_t uxReceived;
+	Queue_t * const pxQueue = xQueue;
 
-		/* If a task waiting for a mutex causes the mutex holder to inherit a
-		priority, but the waiting task times out, then the holder should
-		disinherit the priority - but only down to the highest priority of any
-		other tasks that are waiting for the same mutex.  For this purpose,
-		return the priority of the highest priority task that is waiting for the
-		mutex. */
-		if( listCURRENT_LIST_LENGTH( &( pxQueue->xTasksWaitingToReceive ) ) > 0U )
-		{
-			uxHighestPriorityOfWaitingTasks = ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( &( pxQueue->xTasksWaitingToReceive ) );
-		}
-		else
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		configASSERT( pvBuffer != NULL );
+		configASSERT( uxMaxCount > ( UBaseType_t ) 0U );
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
 		{
-			uxHighestPriorityOfWaitingTasks = tskIDLE_PRIORITY;
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
 		}
+		#endif
 
-		return uxHighestPriorityOfWaitingTasks;
-	}
+		/*lint -save -e904 As xQueueReceive(). */
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				/* Block only until the first item arrives, then take whatever
+				is there up to uxMaxCount. */
+				if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+				{
+					uxReceived = prvCopyItemsFromQueue( pxQueue, ( uint8_t * ) pvBuffer, uxMaxCount );
+					traceQUEUE_RECEIVE( pxQueue );
+
+					if( prvUnblockTasks( &( pxQueue->xTasksWaitingToSend ), uxReceived ) != pdFALSE )
+					{
+						queueYIELD_IF_USING_PREEMPTION();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+
+					taskEXIT_CRITICAL();
+					return uxReceived;
+				}
+				else
+				{
+					if( xTicksToWait == ( TickType_t ) 0 )
+					{
+						taskEXIT_CRITICAL();
+						traceQUEUE_RECEIVE_FAILED( pxQueue );
+						return 0;
+					}
+					else if( xEntryTimeSet == pdFALSE )
+					{
+						vTaskInternalSetTimeOutState( &xTimeOut );
+						xEntryTimeSet = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			vTaskSuspendAll();
+			prvLockQueue( pxQueue );
+
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+			{
+				if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+				{
+					traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+					vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+					prvUnlockQueue( pxQueue );
+					if( xTaskResumeAll() == pdFALSE )
+					{
+						portYIELD_WITHIN_API();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					prvUnlockQueue( pxQueue );
+					( void ) xTaskResumeAll();
+				}
+			}
+			else
+			{
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+
+				if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+				{
+					traceQUEUE_RECEIVE_FAILED( pxQueue );
+					return 0;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		} /*lint -restore */
+	}
+
+#endif /* configUSE_QUEUE_BATCH_OPERATIONS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_QUEUE_BATCH_OPERATIONS == 1 )
+
+	UBaseType_t uxQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxCount, BaseType_t * const pxHigherPriorityTaskWoken )
+	{
+	UBaseType_t uxReceived = 0;
+	UBaseType_t uxSavedInterruptStatus;
+	Queue_t * const pxQueue = xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		configASSERT( pvBuffer != NULL );
+
+		/* See xQueueGenericSendFromISR(). */
+		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+			{
+				const int8_t cRxLock = pxQueue->cRxLock;
+
+				traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
+
+				uxReceived = prvCopyItemsFromQueue( pxQueue, ( uint8_t * ) pvBuffer, uxMaxCount );
+
+				if( cRxLock == queueUNLOCKED )
+				{
+					if( prvUnblockTasks( &( pxQueue->xTasksWaitingToSend ), uxReceived ) != pdFALSE )
+					{
+						if( pxHigherPriorityTaskWoken != NULL )
+						{
+							*pxHigherPriorityTaskWoken = pdTRUE;
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					pxQueue->cRxLock = prvAddToLockCount( cRxLock, uxReceived );
+				}
+			}
+			else
+			{
+				traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return uxReceived;
+	}
+
+#endif /* configUSE_QUEUE_BATCH_OPERATIONS */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue )
+{
+UBaseType_t uxReturn;
+
+	configASSERT( xQueue );
+
+	taskENTER_CRITICAL();
+	{
+		uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+	}
+	taskEXIT_CRITICAL();
+
+	return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueSpacesAvailable( const QueueHandle_t xQueue )
+{
+UBaseType_t uxReturn;
+Queue_t * const pxQueue = xQueue;
+
+	configASSERT( pxQueue );
+
+	taskENTER_CRITICAL();
+	{
+		uxReturn = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
+	}
+	taskEXIT_CRITICAL();
+
+	return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueMessagesWaitingFromISR( const QueueHandle_t xQueue )
+{
+UBaseType_t uxReturn;
+Queue_t * const pxQueue = xQueue;
+
+	configASSERT( pxQueue );
+	uxReturn = pxQueue->uxMessagesWaiting;
+
+	return uxReturn;
+} /*lint !e818 Pointer cannot be declared const as xQueue is a typedef not pointer. */
+/*-----------------------------------------------------------*/
+
+void vQueueDelete( QueueHandle_t xQueue )
+{
+Queue_t * const pxQueue = xQueue;
+
+	configASSERT( pxQueue );
+	traceQUEUE_DELETE( pxQueue );
+
+	#if ( configQUEUE_REGISTRY_SIZE > 0 )
+	{
+		vQueueUnregisterQueue( pxQueue );
+	}
+	#endif
+
+	#if( configUSE_ZERO_COPY_QUEUES == 1 )
+	{
+		if( pxQueue->pxBufferPool != NULL )
+		{
+			prvReleaseQueuedBuffers( pxQueue );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif /* configUSE_ZERO_COPY_QUEUES */
+
+	#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
+	{
+		/* The queue can only have been allocated dynamically - free it
+		again. */
+		prvFreeQueue( pxQueue );
+	}
+	#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+	{
+		/* The queue could have been allocated statically or dynamically, so
+		check before attempting to free the memory. */
+		if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+		{
+			prvFreeQueue( pxQueue );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#else
+	{
+		/* The queue must have been statically allocated, so is not going to be
+		deleted.  Avoid compiler warnings about the unused parameter. */
+		( void ) pxQueue;
+	}
+	#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+}
+/*-----------------------------------------------------------*/
+
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_KERNEL_SLABS == 1 ) )
+
+	static void prvFreeQueue( Queue_t *pxQueue )
+	{
+		/* Semaphores and mutexes have no storage area, and pcHead is not a
+		block of its own for them. */
+		if( pxQueue->uxItemSize != ( UBaseType_t ) 0 )
+		{
+			vPortFree( pxQueue->pcHead );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		vSlabFree( &xQueueSlabs, pxQueue );
+	}
+
+#endif /* configUSE_KERNEL_SLABS */
+/*-----------------------------------------------------------*/
+
+#if( ( configUSE_ZERO_COPY_QUEUES == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+	QueueHandle_t xQueueCreateZeroCopy( const UBaseType_t uxQueueLength, MemPool_t *pxPool )
+	{
+	Queue_t *pxNewQueue;
+
+		configASSERT( pxPool );
+
+		/* pvPortMalloc() aligns the block, and Queue_t is a whole number of
+		pointers long when the storage follows it in the same block, so the
+		storage holds aligned pointers. */
+		pxNewQueue = ( Queue_t * ) xQueueGenericCreate( uxQueueLength, ( UBaseType_t ) sizeof( void * ), queueQUEUE_TYPE_BASE );
+
+		if( pxNewQueue != NULL )
+		{
+			pxNewQueue->pxBufferPool = pxPool;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pxNewQueue;
+	}
+
+#endif /* configUSE_ZERO_COPY_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if( ( configUSE_ZERO_COPY_QUEUES == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+
+	QueueHandle_t xQueueCreateZeroCopyStatic( const UBaseType_t uxQueueLength, MemPool_t *pxPool, void **ppvQueueStorage, StaticQueue_t *pxStaticQueue )
+	{
+	Queue_t *pxNewQueue;
+
+		configASSERT( pxPool );
+
+		pxNewQueue = ( Queue_t * ) xQueueGenericCreateStatic( uxQueueLength, ( UBaseType_t ) sizeof( void * ), ( uint8_t * ) ppvQueueStorage, pxStaticQueue, queueQUEUE_TYPE_BASE );
+
+		if( pxNewQueue != NULL )
+		{
+			pxNewQueue->pxBufferPool = pxPool;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pxNewQueue;
+	}
+
+#endif /* configUSE_ZERO_COPY_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_ZERO_COPY_QUEUES == 1 )
+
+	void *pvQueueAcquireBuffer( QueueHandle_t xQueue )
+	{
+	Queue_t * const pxQueue = xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->pxBufferPool != NULL );
+
+		return pvMemPoolAlloc( pxQueue->pxBufferPool );
+	}
+
+#endif /* configUSE_ZERO_COPY_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_ZERO_COPY_QUEUES == 1 )
+
+	BaseType_t xQueueSendBuffer( QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait )
+	{
+	Queue_t * const pxQueue = xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->pxBufferPool != NULL );
+		configASSERT( xMemPoolContains( pxQueue->pxBufferPool, pvBuffer ) != pdFALSE );
+
+		/* Only the pointer is queued.  Ownership passes with it on success. */
+		return xQueueGenericSend( xQueue, &pvBuffer, xTicksToWait, queueSEND_TO_BACK );
+	}
+
+#endif /* configUSE_ZERO_COPY_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_ZERO_COPY_QUEUES == 1 )
+
+	BaseType_t xQueueSendBufferFromISR( QueueHandle_t xQueue, void *pvBuffer, BaseType_t * const pxHigherPriorityTaskWoken )
+	{
+	Queue_t * const pxQueue = xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->pxBufferPool != NULL );
+		configASSERT( xMemPoolContains( pxQueue->pxBufferPool, pvBuffer ) != pdFALSE );
+
+		return xQueueGenericSendFromISR( xQueue, &pvBuffer, pxHigherPriorityTaskWoken, queueSEND_TO_BACK );
+	}
+
+#endif /* configUSE_ZERO_COPY_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_ZERO_COPY_QUEUES == 1 )
+
+	void *pvQueueReceiveBuffer( QueueHandle_t xQueue, TickType_t xTicksToWait )
+	{
+	void *pvBuffer = NULL;
+
+		configASSERT( xQueue );
+		configASSERT( ( ( Queue_t * ) xQueue )->pxBufferPool != NULL );
+
+		if( xQueueReceive( xQueue, &pvBuffer, xTicksToWait ) != pdPASS )
+		{
+			pvBuffer = NULL;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pvBuffer;
+	}
+
+#endif /* configUSE_ZERO_COPY_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_ZERO_COPY_QUEUES == 1 )
+
+	void *pvQueueReceiveBufferFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken )
+	{
+	void *pvBuffer = NULL;
+
+		configASSERT( xQueue );
+		configASSERT( ( ( Queue_t * ) xQueue )->pxBufferPool != NULL );
+
+		if( xQueueReceiveFromISR( xQueue, &pvBuffer, pxHigherPriorityTaskWoken ) != pdPASS )
+		{
+			pvBuffer = NULL;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pvBuffer;
+	}
+
+#endif /* configUSE_ZERO_COPY_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_ZERO_COPY_QUEUES == 1 )
+
+	void vQueueReleaseBuffer( QueueHandle_t xQueue, void *pvBuffer )
+	{
+	Queue_t * const pxQueue = xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->pxBufferPool != NULL );
+
+		vMemPoolFree( pxQueue->pxBufferPool, pvBuffer );
+	}
+
+#endif /* configUSE_ZERO_COPY_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_ZERO_COPY_QUEUES == 1 )
+
+	static void prvReleaseQueuedBuffers( const Queue_t * const pxQueue )
+	{
+	int8_t *pcItem = pxQueue->u.xQueue.pcReadFrom;
+	UBaseType_t uxItems;
+
+		/* Walk the items as prvCopyDataFromQueue() would read them. */
+		for( uxItems = pxQueue->uxMessagesWaiting; uxItems > ( UBaseType_t ) 0; uxItems-- )
+		{
+			pcItem += pxQueue->uxItemSize;
+			if( pcItem >= pxQueue->u.xQueue.pcTail )
+			{
+				pcItem = pxQueue->pcHead;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			vMemPoolFree( pxQueue->pxBufferPool, *( ( void ** ) pcItem ) );
+		}
+	}
+
+#endif /* configUSE_ZERO_COPY_QUEUES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	UBaseType_t uxQueueGetQueueNumber( QueueHandle_t xQueue )
+	{
+		return ( ( Queue_t * ) xQueue )->uxQueueNumber;
+	}
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	void vQueueSetQueueNumber( QueueHandle_t xQueue, UBaseType_t uxQueueNumber )
+	{
+		( ( Queue_t * ) xQueue )->uxQueueNumber = uxQueueNumber;
+	}
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	uint8_t ucQueueGetQueueType( QueueHandle_t xQueue )
+	{
+		return ( ( Queue_t * ) xQueue )->ucQueueType;
+	}
+
+#endif /* configUSE_TRACE_FACILITY */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MUTEXES == 1 )
+
+	static UBaseType_t prvGetDisinheritPriorityAfterTimeout( const Queue_t * const pxQueue )
+	{
+	UBaseType_t uxHighestPriorityOfWaitingTasks;
+
+		/* If a task waiting for a mutex causes the mutex holder to inherit a
+		priority, but the waiting task times out, then the holder should
+		disinherit the priority - but only down to the highest priority of any
+		other tasks that are waiting for the same mutex.  For this purpose,
+		return the priority of the highest priority task that is waiting for the
+		mutex. */
+		if( listCURRENT_LIST_LENGTH( &( pxQueue->xTasksWaitingToReceive ) ) > 0U )
+		{
+			uxHighestPriorityOfWaitingTasks = ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) listGET_ITEM_VALUE_OF_HEAD_ENTRY( &( pxQueue->xTasksWaitingToReceive ) );
+		}
+		else
+		{
+			uxHighestPriorityOfWaitingTasks = tskIDLE_PRIORITY;
+		}
+
+		return uxHighestPriorityOfWaitingTasks;
+	}
 
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
@@ -2095,7 +2833,7 @@ UBaseType_t uxMessagesWaiting;
 	}
 	else if( xPosition == queueSEND_TO_BACK )
 	{
-		( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
+		prvCopyItem( pxQueue, pxQueue->pcWriteTo, pvItemToQueue ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
 		pxQueue->pcWriteTo += pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
 		if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
 		{
@@ -2108,7 +2846,7 @@ UBaseType_t uxMessagesWaiting;
 	}
 	else
 	{
-		( void ) memcpy( ( void * ) pxQueue->u.xQueue.pcReadFrom, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e9087 !e418 MISRA exception as the casts are only redundant for some ports.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes.  Assert checks null pointer only used when length is 0. */
+		prvCopyItem( pxQueue, pxQueue->u.xQueue.pcReadFrom, pvItemToQueue ); /*lint !e961 !e9087 !e418 MISRA exception as the casts are only redundant for some ports.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes.  Assert checks null pointer only used when length is 0. */
 		pxQueue->u.xQueue.pcReadFrom -= pxQueue->uxItemSize;
 		if( pxQueue->u.xQueue.pcReadFrom < pxQueue->pcHead ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
 		{
@@ -2159,11 +2897,139 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
-		( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
+		prvCopyItem( pxQueue, pvBuffer, pxQueue->u.xQueue.pcReadFrom ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0.  Cast to void required by function signature and safe as no alignment requirement and copy length specified in bytes. */
 	}
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_QUEUE_BATCH_OPERATIONS == 1 )
+
+	static UBaseType_t prvCopyItemsToQueue( Queue_t * const pxQueue, const uint8_t *pucItems, UBaseType_t uxCount )
+	{
+	UBaseType_t uxSpace, uxRemaining;
+	size_t xBytes;
+
+		uxSpace = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
+		if( uxCount > uxSpace )
+		{
+			uxCount = uxSpace;
+		}
+
+		for( uxRemaining = uxCount; uxRemaining > ( UBaseType_t ) 0; uxRemaining -= ( UBaseType_t ) ( xBytes / pxQueue->uxItemSize ) )
+		{
+			/* Fill up to the end of the storage area, then wrap. */
+			xBytes = ( size_t ) ( pxQueue->u.xQueue.pcTail - pxQueue->pcWriteTo );
+			if( xBytes > ( ( size_t ) uxRemaining * pxQueue->uxItemSize ) )
+			{
+				xBytes = ( size_t ) uxRemaining * pxQueue->uxItemSize;
+			}
+
+			( void ) portMEMCPY( ( void * ) pxQueue->pcWriteTo, ( const void * ) pucItems, xBytes );
+			pucItems += xBytes;
+			pxQueue->pcWriteTo += xBytes;
+
+			if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail )
+			{
+				pxQueue->pcWriteTo = pxQueue->pcHead;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		pxQueue->uxMessagesWaiting += uxCount;
+
+		return uxCount;
+	}
+
+#endif /* configUSE_QUEUE_BATCH_OPERATIONS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_QUEUE_BATCH_OPERATIONS == 1 )
+
+	static UBaseType_t prvCopyItemsFromQueue( Queue_t * const pxQueue, uint8_t *pucItems, UBaseType_t uxCount )
+	{
+	UBaseType_t uxRemaining;
+	int8_t *pcNext;
+	size_t xBytes;
+
+		if( uxCount > pxQueue->uxMessagesWaiting )
+		{
+			uxCount = pxQueue->uxMessagesWaiting;
+		}
+
+		for( uxRemaining = uxCount; uxRemaining > ( UBaseType_t ) 0; uxRemaining -= ( UBaseType_t ) ( xBytes / pxQueue->uxItemSize ) )
+		{
+			/* pcReadFrom points at the last item read, so the next one
+			follows it, wrapping at the end of the storage area. */
+			pcNext = pxQueue->u.xQueue.pcReadFrom + pxQueue->uxItemSize;
+			if( pcNext >= pxQueue->u.xQueue.pcTail )
+			{
+				pcNext = pxQueue->pcHead;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			xBytes = ( size_t ) ( pxQueue->u.xQueue.pcTail - pcNext );
+			if( xBytes > ( ( size_t ) uxRemaining * pxQueue->uxItemSize ) )
+			{
+				xBytes = ( size_t ) uxRemaining * pxQueue->uxItemSize;
+			}
+
+			( void ) portMEMCPY( ( void * ) pucItems, ( const void * ) pcNext, xBytes );
+			pucItems += xBytes;
+			pxQueue->u.xQueue.pcReadFrom = pcNext + ( xBytes - pxQueue->uxItemSize );
+		}
+
+		pxQueue->uxMessagesWaiting -= uxCount;
+
+		return uxCount;
+	}
+
+#endif /* configUSE_QUEUE_BATCH_OPERATIONS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_QUEUE_BATCH_OPERATIONS == 1 )
+
+	static BaseType_t prvUnblockTasks( List_t * const pxEventList, UBaseType_t uxMaxTasks )
+	{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+		while( ( uxMaxTasks > ( UBaseType_t ) 0 ) && ( listLIST_IS_EMPTY( pxEventList ) == pdFALSE ) )
+		{
+			if( xTaskRemoveFromEventList( pxEventList ) != pdFALSE )
+			{
+				xHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			uxMaxTasks--;
+		}
+
+		return xHigherPriorityTaskWoken;
+	}
+
+#endif /* configUSE_QUEUE_BATCH_OPERATIONS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_QUEUE_BATCH_OPERATIONS == 1 )
+
+	static int8_t prvAddToLockCount( const int8_t cLock, const UBaseType_t uxItems )
+	{
+	UBaseType_t uxLock = ( UBaseType_t ) cLock + uxItems;
+
+		return ( uxLock > ( UBaseType_t ) queueMAX_LOCK_COUNT ) ? queueMAX_LOCK_COUNT : ( int8_t ) uxLock;
+	}
+
+#endif /* configUSE_QUEUE_BATCH_OPERATIONS */
+/*-----------------------------------------------------------*/
+
 static void prvUnlockQueue( Queue_t * const pxQueue )
 {
 	/* THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED. */
@@ -2493,7 +3359,7 @@ Queue_t * const pxQueue = xQueue;
 					mtCOVERAGE_TEST_MARKER();
 				}
 				--( pxQueue->uxMessagesWaiting );
-				( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
+				( void ) portMEMCPY( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
 
 				xReturn = pdPASS;
 
@@ -2601,7 +3467,7 @@ Queue_t * const pxQueue = xQueue;
 				mtCOVERAGE_TEST_MARKER();
 			}
 			--( pxQueue->uxMessagesWaiting );
-			( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
+			( void ) portMEMCPY( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
 
 			if( ( *pxCoRoutineWoken ) == pdFALSE )
 			{
@@ -2778,11 +3644,38 @@ Queue_t * const pxQueue = xQueue;
 #endif /* configUSE_QUEUE_SETS */
 /*-----------------------------------------------------------*/
 
+#if( ( configUSE_QUEUE_SETS == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+	QueueSetHandle_t xQueueCreateSetMasked( void )
+	{
+	QueueSetHandle_t pxQueue;
+
+		/* The event queue of a masked set only ever holds one event, which
+		wakes the task blocked in ulQueueSelectMaskFromSet(); the members that
+		are ready are read from the mask. */
+		pxQueue = xQueueGenericCreate( ( UBaseType_t ) 1, ( UBaseType_t ) sizeof( Queue_t * ), queueQUEUE_TYPE_SET );
+
+		if( pxQueue != NULL )
+		{
+			pxQueue->ucQueueSetMasked = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pxQueue;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_QUEUE_SETS == 1 )
 
 	BaseType_t xQueueAddToSet( QueueSetMemberHandle_t xQueueOrSemaphore, QueueSetHandle_t xQueueSet )
 	{
 	BaseType_t xReturn;
+	uint8_t ucIndex;
 
 		taskENTER_CRITICAL();
 		{
@@ -2797,8 +3690,22 @@ Queue_t * const pxQueue = xQueue;
 				items in the queue/semaphore. */
 				xReturn = pdFAIL;
 			}
+			else if( xQueueSet->ulQueueSetMembers == 0xFFFFFFFFUL )
+			{
+				/* Every bit of the set's masks is taken. */
+				xReturn = pdFAIL;
+			}
 			else
 			{
+				/* Give the member the lowest free bit, so members added in
+				turn to an empty set get bits 0, 1, 2... */
+				for( ucIndex = 0U; ( xQueueSet->ulQueueSetMembers & ( 1UL << ucIndex ) ) != 0UL; ucIndex++ )
+				{
+				}
+
+				xQueueSet->ulQueueSetMembers |= ( 1UL << ucIndex );
+				xQueueSet->ulQueueSetReady &= ~( 1UL << ucIndex );
+				( ( Queue_t * ) xQueueOrSemaphore )->ucQueueSetIndex = ucIndex;
 				( ( Queue_t * ) xQueueOrSemaphore )->pxQueueSetContainer = xQueueSet;
 				xReturn = pdPASS;
 			}
@@ -2835,6 +3742,8 @@ Queue_t * const pxQueue = xQueue;
 			taskENTER_CRITICAL();
 			{
 				/* The queue is no longer contained in the set. */
+				xQueueSet->ulQueueSetMembers &= ~( 1UL << pxQueueOrSemaphore->ucQueueSetIndex );
+				xQueueSet->ulQueueSetReady &= ~( 1UL << pxQueueOrSemaphore->ucQueueSetIndex );
 				pxQueueOrSemaphore->pxQueueSetContainer = NULL;
 			}
 			taskEXIT_CRITICAL();
@@ -2842,7 +3751,7 @@ Queue_t * const pxQueue = xQueue;
 		}
 
 		return xReturn;
-	} /*lint !e818 xQueueSet could not be declared as pointing to const as it is a typedef. */
+	}
 
 #endif /* configUSE_QUEUE_SETS */
 /*-----------------------------------------------------------*/
@@ -2853,6 +3762,9 @@ Queue_t * const pxQueue = xQueue;
 	{
 	QueueSetMemberHandle_t xReturn = NULL;
 
+		/* A masked set does not keep an event per item. */
+		configASSERT( xQueueSet->ucQueueSetMasked == pdFALSE );
+
 		( void ) xQueueReceive( ( QueueHandle_t ) xQueueSet, &xReturn, xTicksToWait ); /*lint !e961 Casting from one typedef to another is not redundant. */
 		return xReturn;
 	}
@@ -2860,6 +3772,99 @@ Queue_t * const pxQueue = xQueue;
 #endif /* configUSE_QUEUE_SETS */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	uint32_t ulQueueSelectMaskFromSet( QueueSetHandle_t xQueueSet, TickType_t xTicksToWait )
+	{
+	Queue_t * const pxQueue = xQueueSet;
+	uint32_t ulReady;
+	TimeOut_t xTimeOut;
+	Queue_t *pxEvent;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->ucQueueSetMasked != pdFALSE );
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+		{
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
+
+		vTaskInternalSetTimeOutState( &xTimeOut );
+
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				ulReady = pxQueue->ulQueueSetReady;
+
+				/* The mask says everything the pending event could, so the
+				event is dropped, leaving room for the next send to wake the
+				task when it blocks below. */
+				pxQueue->uxMessagesWaiting = ( UBaseType_t ) 0U;
+				pxQueue->pcWriteTo = pxQueue->pcHead;
+				pxQueue->u.xQueue.pcReadFrom = pxQueue->pcHead + ( ( pxQueue->uxLength - 1U ) * pxQueue->uxItemSize ); /*lint !e9016 Pointer arithmetic allowed on char types, especially when it assists conveying intent. */
+			}
+			taskEXIT_CRITICAL();
+
+			if( ulReady != 0UL )
+			{
+				break;
+			}
+
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+			{
+				break;
+			}
+
+			/* Peek rather than receive so the event is still there, and
+			dropped, on the next pass. */
+			( void ) xQueuePeek( ( QueueHandle_t ) pxQueue, &pxEvent, xTicksToWait );
+		}
+
+		return ulReady;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	uint32_t ulQueueSelectMaskFromSetFromISR( QueueSetHandle_t xQueueSet )
+	{
+	Queue_t * const pxQueue = xQueueSet;
+	uint32_t ulReady;
+	UBaseType_t uxSavedInterruptStatus;
+
+		configASSERT( pxQueue );
+		configASSERT( pxQueue->ucQueueSetMasked != pdFALSE );
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			ulReady = pxQueue->ulQueueSetReady;
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return ulReady;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	UBaseType_t uxQueueGetSetIndex( QueueSetMemberHandle_t xQueueOrSemaphore )
+	{
+	const Queue_t * const pxQueueOrSemaphore = ( const Queue_t * ) xQueueOrSemaphore;
+
+		configASSERT( pxQueueOrSemaphore );
+		configASSERT( pxQueueOrSemaphore->pxQueueSetContainer != NULL );
+
+		return ( UBaseType_t ) pxQueueOrSemaphore->ucQueueSetIndex;
+	}
+
+#endif /* configUSE_QUEUE_SETS */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_QUEUE_SETS == 1 )
 
 	QueueSetMemberHandle_t xQueueSelectFromSetFromISR( QueueSetHandle_t xQueueSet )
@@ -2883,8 +3888,21 @@ Queue_t * const pxQueue = xQueue;
 		/* This function must be called form a critical section. */
 
 		configASSERT( pxQueueSetContainer );
-		configASSERT( pxQueueSetContainer->uxMessagesWaiting < pxQueueSetContainer->uxLength );
+		configASSERT( ( pxQueueSetContainer->ucQueueSetMasked != pdFALSE ) || ( pxQueueSetContainer->uxMessagesWaiting < pxQueueSetContainer->uxLength ) );
+
+		/* A send made while the queue was locked is only passed on here once
+		the queue is unlocked, by which time the item may have been taken. */
+		if( pxQueue->uxMessagesWaiting != ( UBaseType_t ) 0 )
+		{
+			pxQueueSetContainer->ulQueueSetReady |= ( 1UL << pxQueue->ucQueueSetIndex );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
 
+		/* A masked set's one event slot being full means a wake is already
+		pending, so there is nothing more to post. */
 		if( pxQueueSetContainer->uxMessagesWaiting < pxQueueSetContainer->uxLength )
 		{
 			const int8_t cTxLock = pxQueueSetContainer->cTxLock;
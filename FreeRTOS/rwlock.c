@@ -0,0 +1,322 @@
+/*
+ * Reader-writer locks - see rwlock.h.
+ */
+
+#include <stddef.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "rwlock.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_TASK_NOTIFICATIONS != 1 )
+	#error rwlock.c wakes a waiting writer with a task notification, so configUSE_TASK_NOTIFICATIONS must be 1
+#endif
+
+#if( configUSE_MUTEXES != 1 )
+	#error rwlock.c queues writers on a mutex, so configUSE_MUTEXES must be 1
+#endif
+
+/*
+ * Count the calling task in as a reader, and remember it if there is room so
+ * that a writer can raise it.  Called from a critical section.
+ */
+static void prvAddReader( RWLock_t *pxLock ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xRWLockInit( RWLock_t *pxLock )
+{
+UBaseType_t uxIndex;
+
+	configASSERT( pxLock );
+
+	pxLock->uxReaders = ( UBaseType_t ) 0;
+	pxLock->uxWriters = ( UBaseType_t ) 0;
+	pxLock->xWriterWaiting = NULL;
+
+	for( uxIndex = ( UBaseType_t ) 0; uxIndex < ( UBaseType_t ) rwlockTRACKED_READERS; uxIndex++ )
+	{
+		pxLock->xReaderTasks[ uxIndex ] = NULL;
+	}
+
+	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	{
+		pxLock->xWriteMutex = xSemaphoreCreateMutexStatic( &( pxLock->xWriteMutexBuffer ) );
+	}
+	#else
+	{
+		pxLock->xWriteMutex = xSemaphoreCreateMutex();
+	}
+	#endif
+
+	return ( pxLock->xWriteMutex != NULL ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRWLockReadTake( RWLock_t *pxLock, TickType_t xTicksToWait )
+{
+BaseType_t xReturn = pdFAIL;
+
+	configASSERT( pxLock );
+
+	/* With no writer about, a reader only has to count itself in. */
+	taskENTER_CRITICAL();
+	{
+		if( pxLock->uxWriters == ( UBaseType_t ) 0 )
+		{
+			prvAddReader( pxLock );
+			xReturn = pdPASS;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xReturn == pdFAIL )
+	{
+		/* Otherwise queue on the writers' mutex, which raises the writer
+		holding it to this task's priority, and count in once it is free. */
+		if( xSemaphoreTake( pxLock->xWriteMutex, xTicksToWait ) != pdFALSE )
+		{
+			taskENTER_CRITICAL();
+			{
+				prvAddReader( pxLock );
+			}
+			taskEXIT_CRITICAL();
+
+			( void ) xSemaphoreGive( pxLock->xWriteMutex );
+			xReturn = pdPASS;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vRWLockReadGive( RWLock_t *pxLock )
+{
+BaseType_t xYieldRequired = pdFALSE;
+TaskHandle_t const xSelf = xTaskGetCurrentTaskHandle();
+UBaseType_t uxIndex;
+
+	configASSERT( pxLock );
+
+	taskENTER_CRITICAL();
+	{
+		configASSERT( pxLock->uxReaders != ( UBaseType_t ) 0 );
+		( pxLock->uxReaders )--;
+
+		for( uxIndex = ( UBaseType_t ) 0; uxIndex < ( UBaseType_t ) rwlockTRACKED_READERS; uxIndex++ )
+		{
+			if( pxLock->xReaderTasks[ uxIndex ] == xSelf )
+			{
+				pxLock->xReaderTasks[ uxIndex ] = NULL;
+
+				/* Drop any priority inherited from a waiting writer.  As in
+				fastmutex.c, the kernel only does that once no kernel mutexes
+				are held, and counts the mutexes this task holds, so count
+				this lock in for the call to count back out. */
+				( void ) pvTaskIncrementMutexHeldCount();
+				if( xTaskPriorityDisinherit( xSelf ) != pdFALSE )
+				{
+					xYieldRequired = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				break;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		if( ( pxLock->uxReaders == ( UBaseType_t ) 0 ) && ( pxLock->xWriterWaiting != NULL ) )
+		{
+			/* The last reader out lets the writer in. */
+			( void ) xTaskNotifyFromISR( pxLock->xWriterWaiting, 0UL, eNoAction, &xYieldRequired );
+			pxLock->xWriterWaiting = NULL;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xYieldRequired != pdFALSE )
+	{
+		portYIELD_WITHIN_API();
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xRWLockWriteTake( RWLock_t *pxLock, TickType_t xTicksToWait )
+{
+TimeOut_t xTimeOut;
+BaseType_t xReturn = pdFAIL, xWait;
+UBaseType_t uxIndex;
+
+	configASSERT( pxLock );
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	/* Both waits come out of the one timeout. */
+	vTaskSetTimeOutState( &xTimeOut );
+
+	/* Counted before queuing on the mutex, so readers arriving from now on
+	queue behind this writer rather than keep it waiting. */
+	taskENTER_CRITICAL();
+	{
+		( pxLock->uxWriters )++;
+	}
+	taskEXIT_CRITICAL();
+
+	if( xSemaphoreTake( pxLock->xWriteMutex, xTicksToWait ) != pdFALSE )
+	{
+		/* No new readers can get in now, so wait for those already in to
+		leave. */
+		do
+		{
+			xWait = pdFALSE;
+
+			taskENTER_CRITICAL();
+			{
+				pxLock->xWriterWaiting = NULL;
+
+				if( pxLock->uxReaders == ( UBaseType_t ) 0 )
+				{
+					xReturn = pdPASS;
+				}
+				else if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+				{
+					/* A notification left over from an earlier wait must not
+					end this one. */
+					( void ) xTaskNotifyStateClear( NULL );
+					pxLock->xWriterWaiting = xTaskGetCurrentTaskHandle();
+					xWait = pdTRUE;
+
+					/* As with a kernel mutex, the readers keeping this task
+					waiting run at no lower a priority than it does. */
+					for( uxIndex = ( UBaseType_t ) 0; uxIndex < ( UBaseType_t ) rwlockTRACKED_READERS; uxIndex++ )
+					{
+						( void ) xTaskPriorityInherit( pxLock->xReaderTasks[ uxIndex ] );
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			if( xWait != pdFALSE )
+			{
+				( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		} while( xWait != pdFALSE );
+
+		if( xReturn == pdFAIL )
+		{
+			( void ) xSemaphoreGive( pxLock->xWriteMutex );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( xReturn == pdFAIL )
+	{
+		taskENTER_CRITICAL();
+		{
+			( pxLock->uxWriters )--;
+		}
+		taskEXIT_CRITICAL();
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vRWLockWriteGive( RWLock_t *pxLock )
+{
+BaseType_t xGiven;
+
+	configASSERT( pxLock );
+
+	taskENTER_CRITICAL();
+	{
+		configASSERT( pxLock->uxWriters != ( UBaseType_t ) 0 );
+		( pxLock->uxWriters )--;
+	}
+	taskEXIT_CRITICAL();
+
+	/* Readers and writers queued on the mutex are let in in priority order.
+	Giving it also drops any priority this task inherited from them. */
+	xGiven = xSemaphoreGive( pxLock->xWriteMutex );
+	configASSERT( xGiven != pdFALSE );
+	( void ) xGiven;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddReader( RWLock_t *pxLock )
+{
+UBaseType_t uxIndex;
+
+	( pxLock->uxReaders )++;
+
+	for( uxIndex = ( UBaseType_t ) 0; uxIndex < ( UBaseType_t ) rwlockTRACKED_READERS; uxIndex++ )
+	{
+		if( pxLock->xReaderTasks[ uxIndex ] == NULL )
+		{
+			pxLock->xReaderTasks[ uxIndex ] = xTaskGetCurrentTaskHandle();
+			break;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
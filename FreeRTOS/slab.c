@@ -0,0 +1,197 @@
+/*
+ * Slab caches for fixed size kernel objects - see slab.h.
+ */
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "slab.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_KERNEL_SLABS == 1 )
+
+#if( ( configKERNEL_SLAB_SIZE & ( configKERNEL_SLAB_SIZE - 1 ) ) != 0 )
+	#error configKERNEL_SLAB_SIZE must be a power of two
+#endif
+
+/* The slab an object belongs to, from its address. */
+#define slabOF( pv )	( ( Slab_t * ) ( ( portPOINTER_SIZE_TYPE ) ( pv ) & ~( ( portPOINTER_SIZE_TYPE ) configKERNEL_SLAB_SIZE - 1U ) ) )
+
+/* ulFreeMap of a slab with every object free. */
+#define slabFULL_MAP( pxCache )	\
+	( ( ( pxCache )->uxObjectsPerSlab >= 32U ) ? 0xFFFFFFFFUL : ( ( 1UL << ( pxCache )->uxObjectsPerSlab ) - 1UL ) )
+
+/*
+ * Take an object from the first slab on the list, which must have room.
+ * Called with interrupts masked.
+ */
+static void *prvTakeObject( SlabCache_t *pxCache );
+
+static void prvUnlinkSlab( SlabCache_t *pxCache, Slab_t *pxSlab );
+
+/*-----------------------------------------------------------*/
+
+void *pvSlabAlloc( SlabCache_t *pxCache )
+{
+UBaseType_t uxSavedInterruptStatus;
+Slab_t *pxSlab;
+void *pvReturn = NULL;
+
+	configASSERT( pxCache );
+	configASSERT( pxCache->uxObjectsPerSlab > 0U );
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		if( pxCache->pxPartial != NULL )
+		{
+			pvReturn = prvTakeObject( pxCache );
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	if( pvReturn == NULL )
+	{
+		/* Aligned to its size, so slabOF() finds it from any of its
+		objects. */
+		pxSlab = ( Slab_t * ) pvPortMallocAligned( configKERNEL_SLAB_SIZE, configKERNEL_SLAB_SIZE, 0U );
+
+		if( pxSlab != NULL )
+		{
+			pxSlab->ulFreeMap = slabFULL_MAP( pxCache );
+			pxSlab->pxPrevious = NULL;
+
+			uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+			{
+				pxSlab->pxNext = pxCache->pxPartial;
+				if( pxCache->pxPartial != NULL )
+				{
+					pxCache->pxPartial->pxPrevious = pxSlab;
+				}
+				pxCache->pxPartial = pxSlab;
+				pxCache->uxSlabs++;
+
+				pvReturn = prvTakeObject( pxCache );
+			}
+			portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		}
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vSlabFree( SlabCache_t *pxCache, void *pv )
+{
+UBaseType_t uxSavedInterruptStatus;
+Slab_t *pxSlab, *pxRelease = NULL;
+size_t xOffset;
+uint32_t ulBit;
+
+	configASSERT( pxCache );
+
+	if( pv == NULL )
+	{
+		return;
+	}
+
+	pxSlab = slabOF( pv );
+	xOffset = ( size_t ) ( ( uint8_t * ) pv - ( ( uint8_t * ) pxSlab + slabHEADER_SIZE ) );
+	configASSERT( ( xOffset % pxCache->xObjectSize ) == 0U );
+	ulBit = 1UL << ( xOffset / pxCache->xObjectSize );
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		/* Freed twice. */
+		configASSERT( ( pxSlab->ulFreeMap & ulBit ) == 0U );
+
+		if( pxSlab->ulFreeMap == 0U )
+		{
+			/* It was full, so was off the list. */
+			pxSlab->pxPrevious = NULL;
+			pxSlab->pxNext = pxCache->pxPartial;
+			if( pxCache->pxPartial != NULL )
+			{
+				pxCache->pxPartial->pxPrevious = pxSlab;
+			}
+			pxCache->pxPartial = pxSlab;
+		}
+
+		pxSlab->ulFreeMap |= ulBit;
+		pxCache->uxObjectsInUse--;
+
+		/* Keep an empty slab only while no other slab has room. */
+		if( ( pxSlab->ulFreeMap == slabFULL_MAP( pxCache ) ) &&
+			( ( pxSlab->pxNext != NULL ) || ( pxSlab->pxPrevious != NULL ) ) )
+		{
+			prvUnlinkSlab( pxCache, pxSlab );
+			pxCache->uxSlabs--;
+			pxRelease = pxSlab;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	if( pxRelease != NULL )
+	{
+		vPortFree( pxRelease );
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxSlabGetObjectsInUse( const SlabCache_t *pxCache )
+{
+	return pxCache->uxObjectsInUse;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxSlabGetSlabCount( const SlabCache_t *pxCache )
+{
+	return pxCache->uxSlabs;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvTakeObject( SlabCache_t *pxCache )
+{
+Slab_t *pxSlab = pxCache->pxPartial;
+UBaseType_t uxObject;
+
+	/* __builtin_ctz() compiles to RBIT and CLZ on the Cortex-M4. */
+	uxObject = ( UBaseType_t ) __builtin_ctz( ( unsigned int ) pxSlab->ulFreeMap );
+	pxSlab->ulFreeMap &= ~( 1UL << uxObject );
+	pxCache->uxObjectsInUse++;
+
+	if( pxSlab->ulFreeMap == 0U )
+	{
+		prvUnlinkSlab( pxCache, pxSlab );
+	}
+
+	return ( uint8_t * ) pxSlab + slabHEADER_SIZE + ( ( size_t ) uxObject * pxCache->xObjectSize );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnlinkSlab( SlabCache_t *pxCache, Slab_t *pxSlab )
+{
+	if( pxSlab->pxPrevious != NULL )
+	{
+		pxSlab->pxPrevious->pxNext = pxSlab->pxNext;
+	}
+	else
+	{
+		pxCache->pxPartial = pxSlab->pxNext;
+	}
+
+	if( pxSlab->pxNext != NULL )
+	{
+		pxSlab->pxNext->pxPrevious = pxSlab->pxPrevious;
+	}
+
+	pxSlab->pxNext = NULL;
+	pxSlab->pxPrevious = NULL;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_KERNEL_SLABS */
@@ -0,0 +1,317 @@
+/*
+ * Lock free single producer, single consumer byte rings - see spscring.h.
+ */
+
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "spscring.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_TASK_NOTIFICATIONS != 1 )
+	#error spscring.c wakes the consumer with a task notification, so configUSE_TASK_NOTIFICATIONS must be 1
+#endif
+
+#if( ( INCLUDE_xTaskGetCurrentTaskHandle != 1 ) && ( configUSE_MUTEXES != 1 ) )
+	#error spscring.c needs xTaskGetCurrentTaskHandle()
+#endif
+
+/* Cortex-M4 is a single core with in order accesses to normal memory, so the
+index stores only have to be kept in program order relative to the data they
+publish, which is what a compiler barrier does. */
+#define spscORDER()						portMEMORY_BARRIER()
+
+/* The producer takes the waiting consumer with one exclusive exchange (LDREX
+and STREX on Cortex-M4), so however many writes cross the threshold the
+consumer is notified at most once per wait. */
+#define spscCLAIM_WAITER( pxRing )		__atomic_exchange_n( &( ( pxRing )->xWaitingTask ), NULL, __ATOMIC_RELAXED )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The producer side of both write functions.  Returns the consumer to wake,
+ * if this write completed what it is waiting for.
+ */
+static TaskHandle_t prvWrite( SpscRing_t *pxRing, const void *pvData, size_t xLength, size_t *pxWritten );
+
+/*
+ * The consumer side of xSpscRingRead() and xSpscRingAcquire().  Waits up to
+ * xTicksToWait until xLevel bytes are waiting.
+ */
+static void prvWaitForBytes( SpscRing_t *pxRing, size_t xLevel, TickType_t xTicksToWait );
+
+/*-----------------------------------------------------------*/
+
+void vSpscRingInit( SpscRing_t *pxRing, void *pvStorage, size_t xSize, size_t xWakeThreshold )
+{
+	configASSERT( pxRing );
+	configASSERT( pvStorage );
+	configASSERT( ( xSize != 0U ) && ( ( xSize & ( xSize - 1U ) ) == 0U ) );
+
+	pxRing->pucBuffer = ( uint8_t * ) pvStorage;
+	pxRing->xSize = xSize;
+	pxRing->xHead = 0U;
+	pxRing->xTail = 0U;
+	pxRing->xWaitLevel = 1U;
+	pxRing->xWaitingTask = NULL;
+	vSpscRingSetWakeThreshold( pxRing, xWakeThreshold );
+}
+/*-----------------------------------------------------------*/
+
+void vSpscRingSetWakeThreshold( SpscRing_t *pxRing, size_t xWakeThreshold )
+{
+	/* A threshold of zero would never block, and one above the size would
+	never be met. */
+	if( xWakeThreshold == 0U )
+	{
+		xWakeThreshold = 1U;
+	}
+	else if( xWakeThreshold > pxRing->xSize )
+	{
+		xWakeThreshold = pxRing->xSize;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	pxRing->xWakeThreshold = xWakeThreshold;
+}
+/*-----------------------------------------------------------*/
+
+size_t xSpscRingWrite( SpscRing_t *pxRing, const void *pvData, size_t xLength )
+{
+TaskHandle_t xToWake;
+size_t xWritten;
+
+	xToWake = prvWrite( pxRing, pvData, xLength, &xWritten );
+
+	if( xToWake != NULL )
+	{
+		( void ) xTaskNotifyGive( xToWake );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xWritten;
+}
+/*-----------------------------------------------------------*/
+
+size_t xSpscRingWriteFromISR( SpscRing_t *pxRing, const void *pvData, size_t xLength, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+TaskHandle_t xToWake;
+size_t xWritten;
+
+	xToWake = prvWrite( pxRing, pvData, xLength, &xWritten );
+
+	if( xToWake != NULL )
+	{
+		vTaskNotifyGiveFromISR( xToWake, pxHigherPriorityTaskWoken );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xWritten;
+}
+/*-----------------------------------------------------------*/
+
+size_t xSpscRingRead( SpscRing_t *pxRing, void *pvBuffer, size_t xMaxLength, TickType_t xTicksToWait )
+{
+size_t xTail, xCount, xOffset, xFirst;
+
+	configASSERT( pxRing );
+	configASSERT( !( ( pvBuffer == NULL ) && ( xMaxLength != 0U ) ) );
+
+	prvWaitForBytes( pxRing, ( xMaxLength < pxRing->xWakeThreshold ) ? xMaxLength : pxRing->xWakeThreshold, xTicksToWait );
+
+	xTail = pxRing->xTail;
+	xCount = pxRing->xHead - xTail;
+	spscORDER();
+
+	if( xCount > xMaxLength )
+	{
+		xCount = xMaxLength;
+	}
+
+	if( xCount != 0U )
+	{
+		xOffset = xTail & ( pxRing->xSize - 1U );
+		xFirst = pxRing->xSize - xOffset;
+
+		if( xFirst >= xCount )
+		{
+			( void ) portMEMCPY( pvBuffer, &( pxRing->pucBuffer[ xOffset ] ), xCount );
+		}
+		else
+		{
+			( void ) portMEMCPY( pvBuffer, &( pxRing->pucBuffer[ xOffset ] ), xFirst );
+			( void ) portMEMCPY( ( uint8_t * ) pvBuffer + xFirst, pxRing->pucBuffer, xCount - xFirst );
+		}
+
+		/* Only hand the space back once the bytes have been copied out. */
+		spscORDER();
+		pxRing->xTail = xTail + xCount;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+size_t xSpscRingAcquire( SpscRing_t *pxRing, size_t xSkip, uint8_t **ppucData, TickType_t xTicksToWait )
+{
+size_t xCount, xOffset, xFirst;
+
+	configASSERT( pxRing );
+	configASSERT( ppucData );
+	configASSERT( xSkip < pxRing->xSize );
+
+	/* The wake threshold is not used: the caller is looking for something
+	in the bytes, so any new one may be it. */
+	prvWaitForBytes( pxRing, xSkip + 1U, xTicksToWait );
+
+	xCount = xSpscRingBytesAvailable( pxRing );
+	spscORDER();
+
+	if( xCount <= xSkip )
+	{
+		*ppucData = NULL;
+		return 0U;
+	}
+
+	xOffset = ( pxRing->xTail + xSkip ) & ( pxRing->xSize - 1U );
+	xFirst = pxRing->xSize - xOffset;
+	xCount -= xSkip;
+
+	*ppucData = &( pxRing->pucBuffer[ xOffset ] );
+
+	return ( xFirst < xCount ) ? xFirst : xCount;
+}
+/*-----------------------------------------------------------*/
+
+void vSpscRingRelease( SpscRing_t *pxRing, size_t xLength )
+{
+	configASSERT( pxRing );
+	configASSERT( xLength <= xSpscRingBytesAvailable( pxRing ) );
+
+	/* Whatever the consumer did to the bytes is done before the producer
+	may reuse them. */
+	spscORDER();
+	pxRing->xTail += xLength;
+}
+/*-----------------------------------------------------------*/
+
+size_t xSpscRingBytesAvailable( const SpscRing_t *pxRing )
+{
+	return pxRing->xHead - pxRing->xTail;
+}
+/*-----------------------------------------------------------*/
+
+size_t xSpscRingSpacesAvailable( const SpscRing_t *pxRing )
+{
+	return pxRing->xSize - ( pxRing->xHead - pxRing->xTail );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitForBytes( SpscRing_t *pxRing, size_t xLevel, TickType_t xTicksToWait )
+{
+TimeOut_t xTimeOut;
+
+	if( ( xTicksToWait != ( TickType_t ) 0 ) && ( xLevel != 0U ) && ( xSpscRingBytesAvailable( pxRing ) < xLevel ) )
+	{
+		vTaskSetTimeOutState( &xTimeOut );
+		pxRing->xWaitLevel = xLevel;
+
+		do
+		{
+			/* Publish the wait before looking at the head again, so a write
+			that lands in between either sees the waiter or is seen here. */
+			pxRing->xWaitingTask = xTaskGetCurrentTaskHandle();
+			spscORDER();
+
+			if( xSpscRingBytesAvailable( pxRing ) < xLevel )
+			{
+				( void ) ulTaskNotifyTake( pdTRUE, xTicksToWait );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* The producer clears this when it wakes us.  Clear it here too
+			for a timeout; a notification sent just before costs at most one
+			extra pass round this loop on a later read. */
+			pxRing->xWaitingTask = NULL;
+			spscORDER();
+		} while( ( xSpscRingBytesAvailable( pxRing ) < xLevel ) && ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE ) );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static TaskHandle_t prvWrite( SpscRing_t *pxRing, const void *pvData, size_t xLength, size_t *pxWritten )
+{
+size_t xHead, xOffset, xFirst;
+TaskHandle_t xToWake = NULL;
+
+	configASSERT( pxRing );
+	configASSERT( !( ( pvData == NULL ) && ( xLength != 0U ) ) );
+
+	xHead = pxRing->xHead;
+
+	if( ( xLength == 0U ) || ( xLength > ( pxRing->xSize - ( xHead - pxRing->xTail ) ) ) )
+	{
+		*pxWritten = 0U;
+		return NULL;
+	}
+
+	xOffset = xHead & ( pxRing->xSize - 1U );
+	xFirst = pxRing->xSize - xOffset;
+
+	if( xFirst >= xLength )
+	{
+		( void ) portMEMCPY( &( pxRing->pucBuffer[ xOffset ] ), pvData, xLength );
+	}
+	else
+	{
+		( void ) portMEMCPY( &( pxRing->pucBuffer[ xOffset ] ), pvData, xFirst );
+		( void ) portMEMCPY( pxRing->pucBuffer, ( const uint8_t * ) pvData + xFirst, xLength - xFirst );
+	}
+
+	/* The bytes must be in place before the head that publishes them, and
+	the head must be published before the waiter is looked at. */
+	spscORDER();
+	pxRing->xHead = xHead + xLength;
+	spscORDER();
+
+	if( ( pxRing->xWaitingTask != NULL ) && ( ( ( xHead + xLength ) - pxRing->xTail ) >= pxRing->xWaitLevel ) )
+	{
+		xToWake = spscCLAIM_WAITER( pxRing );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	*pxWritten = xLength;
+
+	return xToWake;
+}
+/*-----------------------------------------------------------*/
@@ -39,6 +39,10 @@ task.h is included from an application file. */
 #include "task.h"
 #include "stream_buffer.h"
 
+#if ( configUSE_KERNEL_SLABS == 1 )
+	#include "slab.h"
+#endif
+
 #if( configUSE_TASK_NOTIFICATIONS != 1 )
 	#error configUSE_TASK_NOTIFICATIONS must be set to 1 to build stream_buffer.c
 #endif
@@ -134,6 +138,22 @@ that uses task notifications. */
 /* Bits stored in the ucFlags field of the stream buffer. */
 #define sbFLAGS_IS_MESSAGE_BUFFER		( ( uint8_t ) 1 ) /* Set if the stream buffer was created as a message buffer, in which case it holds discrete messages rather than a stream. */
 #define sbFLAGS_IS_STATICALLY_ALLOCATED ( ( uint8_t ) 2 ) /* Set if the stream buffer was created using statically allocated memory. */
+#define sbFLAGS_LENGTH_IN_1_BYTE		( ( uint8_t ) 4 ) /* Set if the message buffer stores each message length in one byte. */
+#define sbFLAGS_LENGTH_IN_2_BYTES		( ( uint8_t ) 8 ) /* Set if the message buffer stores each message length in two bytes. */
+
+/* The number of bytes that hold the length of each message in the buffer, or
+0 for a stream buffer. */
+#define sbMESSAGE_LENGTH_BYTES( ucFlags )												\
+	( ( ( ( ucFlags ) & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 ) ? ( size_t ) 0 :	\
+	  ( ( ( ucFlags ) & sbFLAGS_LENGTH_IN_1_BYTE ) != ( uint8_t ) 0 ) ? ( size_t ) 1 :	\
+	  ( ( ( ucFlags ) & sbFLAGS_LENGTH_IN_2_BYTES ) != ( uint8_t ) 0 ) ? ( size_t ) 2 :	\
+	  sbBYTES_TO_STORE_MESSAGE_LENGTH )
+
+/* Whether a length header of xBytesToStoreMessageLength bytes can hold
+xDataLengthBytes. */
+#define sbMESSAGE_LENGTH_FITS( xDataLengthBytes, xBytesToStoreMessageLength )				\
+	( ( ( xBytesToStoreMessageLength ) >= sizeof( size_t ) ) ||								\
+	  ( ( xDataLengthBytes ) < ( ( size_t ) 1 << ( ( xBytesToStoreMessageLength ) * ( size_t ) 8 ) ) ) )
 
 /*-----------------------------------------------------------*/
 
@@ -154,11 +174,41 @@ typedef struct StreamBufferDef_t /*lint !e9058 Style convention uses tag. */
 	#endif
 } StreamBuffer_t;
 
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_KERNEL_SLABS == 1 ) )
+
+	/* The structures of dynamically created stream and message buffers,
+	packed together in slabs.  The buffer itself is a separate block from the
+	heap. */
+	PRIVILEGED_DATA static SlabCache_t xStreamBufferSlabs = slabCACHE_INIT( sizeof( StreamBuffer_t ) );
+
+#endif
+
 /*
  * The number of bytes available to be read from the buffer.
  */
 static size_t prvBytesInBuffer( const StreamBuffer_t * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * Translate the xIsMessageBuffer parameter of the create functions into
+ * ucFlags bits.
+ */
+static uint8_t prvMessageBufferFlags( BaseType_t xIsMessageBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Write or read the length header in front of a message.  A compact header
+ * is stored least significant byte first.
+ */
+static void prvWriteMessageLength( StreamBuffer_t * const pxStreamBuffer, size_t xDataLengthBytes, size_t xBytesToStoreMessageLength ) PRIVILEGED_FUNCTION;
+static size_t prvReadMessageLength( StreamBuffer_t * const pxStreamBuffer, size_t xBytesToStoreMessageLength, size_t xBytesAvailable ) PRIVILEGED_FUNCTION;
+
+/*
+ * The receive side wait shared by the receive and peek functions.  If fewer
+ * than xBytesToStoreMessageLength + 1 bytes are in the buffer and xTicksToWait
+ * is not 0, block until a write notifies the calling task or the time runs
+ * out.  Returns the bytes then in the buffer.
+ */
+static size_t prvWaitForData( StreamBuffer_t * const pxStreamBuffer, size_t xBytesToStoreMessageLength, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /*
  * Add xCount bytes from pucData into the pxStreamBuffer message buffer.
  * Returns the number of bytes written, which will either equal xCount in the
@@ -202,6 +252,14 @@ static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer,
 									  size_t xMaxCount,
 									  size_t xBytesAvailable ) PRIVILEGED_FUNCTION;
 
+/*
+ * Move the write or read index on by xLength bytes written or read in place by
+ * the reserve/commit and peek/consume functions.  Return pdTRUE if a task
+ * blocked on the other side should now be notified.
+ */
+static BaseType_t prvAdvanceHead( StreamBuffer_t * const pxStreamBuffer, size_t xLength ) PRIVILEGED_FUNCTION;
+static BaseType_t prvAdvanceTail( StreamBuffer_t * const pxStreamBuffer, size_t xLength ) PRIVILEGED_FUNCTION;
+
 /*
  * Called by both pxStreamBufferCreate() and pxStreamBufferCreateStatic() to
  * initialise the members of the newly created stream buffer structure.
@@ -218,18 +276,18 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 
 	StreamBufferHandle_t xStreamBufferGenericCreate( size_t xBufferSizeBytes, size_t xTriggerLevelBytes, BaseType_t xIsMessageBuffer )
 	{
-	uint8_t *pucAllocatedMemory;
+	uint8_t *pucAllocatedMemory, *pucStorage;
 	uint8_t ucFlags;
 
 		/* In case the stream buffer is going to be used as a message buffer
 		(that is, it will hold discrete messages with a little meta data that
 		says how big the next message is) check the buffer will be large enough
 		to hold at least one message. */
-		if( xIsMessageBuffer == pdTRUE )
+		if( xIsMessageBuffer != pdFALSE )
 		{
 			/* Is a message buffer but not statically allocated. */
-			ucFlags = sbFLAGS_IS_MESSAGE_BUFFER;
-			configASSERT( xBufferSizeBytes > sbBYTES_TO_STORE_MESSAGE_LENGTH );
+			ucFlags = prvMessageBufferFlags( xIsMessageBuffer );
+			configASSERT( xBufferSizeBytes > sbMESSAGE_LENGTH_BYTES( ucFlags ) );
 		}
 		else
 		{
@@ -255,12 +313,42 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 		space would be reported as one byte smaller than would be logically
 		expected. */
 		xBufferSizeBytes++;
-		pucAllocatedMemory = ( uint8_t * ) pvPortMalloc( xBufferSizeBytes + sizeof( StreamBuffer_t ) ); /*lint !e9079 malloc() only returns void*. */
+
+		#if( configUSE_KERNEL_SLABS == 1 )
+		{
+			/* Unless the structure comes from the slab cache and the buffer
+			from the heap. */
+			pucAllocatedMemory = ( uint8_t * ) pvSlabAlloc( &xStreamBufferSlabs );
+			pucStorage = NULL;
+
+			if( pucAllocatedMemory != NULL )
+			{
+				pucStorage = ( uint8_t * ) pvPortMalloc( xBufferSizeBytes );
+
+				if( pucStorage == NULL )
+				{
+					vSlabFree( &xStreamBufferSlabs, pucAllocatedMemory );
+					pucAllocatedMemory = NULL;
+				}
+			}
+		}
+		#else
+		{
+			pucAllocatedMemory = ( uint8_t * ) pvPortMalloc( xBufferSizeBytes + sizeof( StreamBuffer_t ) ); /*lint !e9079 malloc() only returns void*. */
+			pucStorage = NULL;
+
+			if( pucAllocatedMemory != NULL )
+			{
+				/* Storage area follows. */
+				pucStorage = pucAllocatedMemory + sizeof( StreamBuffer_t ); /*lint !e9016 Indexing past structure valid for uint8_t pointer, also storage area has no alignment requirement. */
+			}
+		}
+		#endif /* configUSE_KERNEL_SLABS */
 
 		if( pucAllocatedMemory != NULL )
 		{
 			prvInitialiseNewStreamBuffer( ( StreamBuffer_t * ) pucAllocatedMemory, /* Structure at the start of the allocated memory. */ /*lint !e9087 Safe cast as allocated memory is aligned. */ /*lint !e826 Area is not too small and alignment is guaranteed provided malloc() behaves as expected and returns aligned buffer. */
-										   pucAllocatedMemory + sizeof( StreamBuffer_t ),  /* Storage area follows. */ /*lint !e9016 Indexing past structure valid for uint8_t pointer, also storage area has no alignment requirement. */
+										   pucStorage,
 										   xBufferSizeBytes,
 										   xTriggerLevelBytes,
 										   ucFlags );
@@ -304,7 +392,7 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 		if( xIsMessageBuffer != pdFALSE )
 		{
 			/* Statically allocated message buffer. */
-			ucFlags = sbFLAGS_IS_MESSAGE_BUFFER | sbFLAGS_IS_STATICALLY_ALLOCATED;
+			ucFlags = prvMessageBufferFlags( xIsMessageBuffer ) | sbFLAGS_IS_STATICALLY_ALLOCATED;
 		}
 		else
 		{
@@ -316,7 +404,7 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 		(that is, it will hold discrete messages with a little meta data that
 		says how big the next message is) check the buffer will be large enough
 		to hold at least one message. */
-		configASSERT( xBufferSizeBytes > sbBYTES_TO_STORE_MESSAGE_LENGTH );
+		configASSERT( xBufferSizeBytes > sbMESSAGE_LENGTH_BYTES( ucFlags | sbFLAGS_IS_MESSAGE_BUFFER ) );
 
 		#if( configASSERT_DEFINED == 1 )
 		{
@@ -368,9 +456,20 @@ StreamBuffer_t * pxStreamBuffer = xStreamBuffer;
 	{
 		#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
 		{
-			/* Both the structure and the buffer were allocated using a single call
-			to pvPortMalloc(), hence only one call to vPortFree() is required. */
-			vPortFree( ( void * ) pxStreamBuffer ); /*lint !e9087 Standard free() semantics require void *, plus pxStreamBuffer was allocated by pvPortMalloc(). */
+			#if( configUSE_KERNEL_SLABS == 1 )
+			{
+				/* The buffer from the heap and the structure from the slab
+				cache. */
+				vPortFree( pxStreamBuffer->pucBuffer );
+				vSlabFree( &xStreamBufferSlabs, pxStreamBuffer );
+			}
+			#else
+			{
+				/* Both the structure and the buffer were allocated using a single call
+				to pvPortMalloc(), hence only one call to vPortFree() is required. */
+				vPortFree( ( void * ) pxStreamBuffer ); /*lint !e9087 Standard free() semantics require void *, plus pxStreamBuffer was allocated by pvPortMalloc(). */
+			}
+			#endif /* configUSE_KERNEL_SLABS */
 		}
 		#else
 		{
@@ -522,10 +621,11 @@ TimeOut_t xTimeOut;
 	message. */
 	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
 	{
-		xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+		xRequiredSpace += sbMESSAGE_LENGTH_BYTES( pxStreamBuffer->ucFlags );
 
 		/* Overflow? */
 		configASSERT( xRequiredSpace > xDataLengthBytes );
+		configASSERT( sbMESSAGE_LENGTH_FITS( xDataLengthBytes, xRequiredSpace - xDataLengthBytes ) );
 	}
 	else
 	{
@@ -625,7 +725,8 @@ size_t xRequiredSpace = xDataLengthBytes;
 	message. */
 	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
 	{
-		xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+		xRequiredSpace += sbMESSAGE_LENGTH_BYTES( pxStreamBuffer->ucFlags );
+		configASSERT( sbMESSAGE_LENGTH_FITS( xDataLengthBytes, xRequiredSpace - xDataLengthBytes ) );
 	}
 	else
 	{
@@ -681,18 +782,19 @@ static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
 		xShouldWrite = pdTRUE;
 		xDataLengthBytes = configMIN( xDataLengthBytes, xSpace );
 	}
-	else if( xSpace >= xRequiredSpace )
+	else if( ( xSpace >= xRequiredSpace ) && ( sbMESSAGE_LENGTH_FITS( xDataLengthBytes, xRequiredSpace - xDataLengthBytes ) ) )
 	{
 		/* This is a message buffer, as opposed to a stream buffer, and there
 		is enough space to write both the message length and the message itself
 		into the buffer.  Start by writing the length of the data, the data
 		itself will be written later in this function. */
 		xShouldWrite = pdTRUE;
-		( void ) prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xDataLengthBytes ), sbBYTES_TO_STORE_MESSAGE_LENGTH );
+		prvWriteMessageLength( pxStreamBuffer, xDataLengthBytes, xRequiredSpace - xDataLengthBytes );
 	}
 	else
 	{
-		/* There is space available, but not enough space. */
+		/* There is space available, but not enough space, or the message is
+		too long for a compact length header. */
 		xShouldWrite = pdFALSE;
 	}
 
@@ -723,66 +825,12 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 
 	/* This receive function is used by both message buffers, which store
 	discrete messages, and stream buffers, which store a continuous stream of
-	bytes.  Discrete messages include an additional
+	bytes.  Discrete messages include an additional one, two or
 	sbBYTES_TO_STORE_MESSAGE_LENGTH bytes that hold the length of the
 	message. */
-	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
-	{
-		xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
-	}
-	else
-	{
-		xBytesToStoreMessageLength = 0;
-	}
+	xBytesToStoreMessageLength = sbMESSAGE_LENGTH_BYTES( pxStreamBuffer->ucFlags );
 
-	if( xTicksToWait != ( TickType_t ) 0 )
-	{
-		/* Checking if there is data and clearing the notification state must be
-		performed atomically. */
-		taskENTER_CRITICAL();
-		{
-			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
-
-			/* If this function was invoked by a message buffer read then
-			xBytesToStoreMessageLength holds the number of bytes used to hold
-			the length of the next discrete message.  If this function was
-			invoked by a stream buffer read then xBytesToStoreMessageLength will
-			be 0. */
-			if( xBytesAvailable <= xBytesToStoreMessageLength )
-			{
-				/* Clear notification state as going to wait for data. */
-				( void ) xTaskNotifyStateClear( NULL );
-
-				/* Should only be one reader. */
-				configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
-				pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
-			}
-			else
-			{
-				mtCOVERAGE_TEST_MARKER();
-			}
-		}
-		taskEXIT_CRITICAL();
-
-		if( xBytesAvailable <= xBytesToStoreMessageLength )
-		{
-			/* Wait for data to be available. */
-			traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( xStreamBuffer );
-			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
-			pxStreamBuffer->xTaskWaitingToReceive = NULL;
-
-			/* Recheck the data available after blocking. */
-			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
-		}
-		else
-		{
-			mtCOVERAGE_TEST_MARKER();
-		}
-	}
-	else
-	{
-		xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
-	}
+	xBytesAvailable = prvWaitForData( pxStreamBuffer, xBytesToStoreMessageLength, xTicksToWait );
 
 	/* Whether receiving a discrete message (where xBytesToStoreMessageLength
 	holds the number of bytes used to store the message length) or a stream of
@@ -817,16 +865,16 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 size_t xStreamBufferNextMessageLengthBytes( StreamBufferHandle_t xStreamBuffer )
 {
 StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
-size_t xReturn, xBytesAvailable, xOriginalTail;
-configMESSAGE_BUFFER_LENGTH_TYPE xTempReturn;
+size_t xReturn, xBytesAvailable, xOriginalTail, xBytesToStoreMessageLength;
 
 	configASSERT( pxStreamBuffer );
 
 	/* Ensure the stream buffer is being used as a message buffer. */
 	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
 	{
+		xBytesToStoreMessageLength = sbMESSAGE_LENGTH_BYTES( pxStreamBuffer->ucFlags );
 		xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
-		if( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+		if( xBytesAvailable > xBytesToStoreMessageLength )
 		{
 			/* The number of bytes available is greater than the number of bytes
 			required to hold the length of the next message, so another message
@@ -835,16 +883,15 @@ configMESSAGE_BUFFER_LENGTH_TYPE xTempReturn;
 			returned to its prior state as the message is not actually being
 			removed from the buffer. */
 			xOriginalTail = pxStreamBuffer->xTail;
-			( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempReturn, sbBYTES_TO_STORE_MESSAGE_LENGTH, xBytesAvailable );
-			xReturn = ( size_t ) xTempReturn;
+			xReturn = prvReadMessageLength( pxStreamBuffer, xBytesToStoreMessageLength, xBytesAvailable );
 			pxStreamBuffer->xTail = xOriginalTail;
 		}
 		else
 		{
 			/* The minimum amount of bytes in a message buffer is
-			( sbBYTES_TO_STORE_MESSAGE_LENGTH + 1 ), so if xBytesAvailable is
-			less than sbBYTES_TO_STORE_MESSAGE_LENGTH the only other valid
-			value is 0. */
+			( xBytesToStoreMessageLength + 1 ), so if xBytesAvailable is
+			less than xBytesToStoreMessageLength the only other valid value
+			is 0. */
 			configASSERT( xBytesAvailable == 0 );
 			xReturn = 0;
 		}
@@ -871,17 +918,10 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 
 	/* This receive function is used by both message buffers, which store
 	discrete messages, and stream buffers, which store a continuous stream of
-	bytes.  Discrete messages include an additional
+	bytes.  Discrete messages include an additional one, two or
 	sbBYTES_TO_STORE_MESSAGE_LENGTH bytes that hold the length of the
 	message. */
-	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
-	{
-		xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
-	}
-	else
-	{
-		xBytesToStoreMessageLength = 0;
-	}
+	xBytesToStoreMessageLength = sbMESSAGE_LENGTH_BYTES( pxStreamBuffer->ucFlags );
 
 	xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
 
@@ -915,6 +955,290 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 }
 /*-----------------------------------------------------------*/
 
+size_t xStreamBufferReceiveMessages( StreamBufferHandle_t xStreamBuffer,
+									void *pvRxData,
+									size_t xBufferLengthBytes,
+									size_t * const pxMessageLengths,
+									size_t xMaxMessages,
+									TickType_t xTicksToWait )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xMessages = 0, xUsed = 0, xLength, xBytesAvailable, xBytesToStoreMessageLength, xOriginalTail;
+
+	configASSERT( pvRxData );
+	configASSERT( pxMessageLengths );
+	configASSERT( pxStreamBuffer );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 );
+
+	xBytesToStoreMessageLength = sbMESSAGE_LENGTH_BYTES( pxStreamBuffer->ucFlags );
+	xBytesAvailable = prvWaitForData( pxStreamBuffer, xBytesToStoreMessageLength, xTicksToWait );
+
+	/* Only one task reads, so the messages already in the buffer can be taken
+	one after the other without holding anything; the saving over calling
+	xStreamBufferReceive() repeatedly is that the writer is notified once. */
+	while( ( xMessages < xMaxMessages ) && ( xBytesAvailable > xBytesToStoreMessageLength ) )
+	{
+		xOriginalTail = pxStreamBuffer->xTail;
+		xLength = prvReadMessageFromBuffer( pxStreamBuffer, ( uint8_t * ) pvRxData + xUsed, xBufferLengthBytes - xUsed, xBytesAvailable, xBytesToStoreMessageLength ); /*lint !e9016 Indexing within the caller's buffer. */
+
+		/* The tail is left where it was if the next message did not fit in
+		what remains of pvRxData. */
+		if( pxStreamBuffer->xTail == xOriginalTail )
+		{
+			break;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxMessageLengths[ xMessages ] = xLength;
+		xMessages++;
+		xUsed += xLength;
+		xBytesAvailable -= xLength + xBytesToStoreMessageLength;
+	}
+
+	if( xMessages != ( size_t ) 0 )
+	{
+		traceSTREAM_BUFFER_RECEIVE( xStreamBuffer, xUsed );
+
+		/* Was a task waiting for space in the buffer? */
+		sbRECEIVE_COMPLETED( pxStreamBuffer );
+	}
+	else
+	{
+		traceSTREAM_BUFFER_RECEIVE_FAILED( xStreamBuffer );
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xMessages;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReserve( StreamBufferHandle_t xStreamBuffer, void **ppvData )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xHead, xTail, xSpace;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( ppvData );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 );
+
+	/* Only the reader moves xTail, and only ever forward, so a stale copy can
+	only under report the space. */
+	xHead = pxStreamBuffer->xHead;
+	xTail = pxStreamBuffer->xTail;
+
+	/* One byte always stays free so a full buffer can be told from an empty
+	one. */
+	if( xTail > xHead )
+	{
+		xSpace = ( xTail - xHead ) - ( size_t ) 1;
+	}
+	else
+	{
+		xSpace = pxStreamBuffer->xLength - xHead;
+
+		if( xTail == ( size_t ) 0 )
+		{
+			xSpace -= ( size_t ) 1;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+	*ppvData = ( void * ) &( pxStreamBuffer->pucBuffer[ xHead ] );
+
+	return xSpace;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferCommit( StreamBufferHandle_t xStreamBuffer, size_t xLength )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+
+	if( prvAdvanceHead( pxStreamBuffer, xLength ) != pdFALSE )
+	{
+		sbSEND_COMPLETED( pxStreamBuffer );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xLength;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferCommitFromISR( StreamBufferHandle_t xStreamBuffer, size_t xLength, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+
+	if( prvAdvanceHead( pxStreamBuffer, xLength ) != pdFALSE )
+	{
+		sbSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xLength;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferPeekContiguous( StreamBufferHandle_t xStreamBuffer, void **ppvData, TickType_t xTicksToWait )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xHead, xTail, xCount;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( ppvData );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 );
+
+	( void ) prvWaitForData( pxStreamBuffer, ( size_t ) 0, xTicksToWait );
+
+	/* Only the writer moves xHead, and only ever forward, so a stale copy can
+	only under report the data. */
+	xHead = pxStreamBuffer->xHead;
+	xTail = pxStreamBuffer->xTail;
+
+	if( xHead >= xTail )
+	{
+		xCount = xHead - xTail;
+	}
+	else
+	{
+		xCount = pxStreamBuffer->xLength - xTail;
+	}
+
+	*ppvData = ( void * ) &( pxStreamBuffer->pucBuffer[ xTail ] );
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferConsume( StreamBufferHandle_t xStreamBuffer, size_t xLength )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+
+	if( prvAdvanceTail( pxStreamBuffer, xLength ) != pdFALSE )
+	{
+		sbRECEIVE_COMPLETED( pxStreamBuffer );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xLength;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferConsumeFromISR( StreamBufferHandle_t xStreamBuffer, size_t xLength, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+
+	if( prvAdvanceTail( pxStreamBuffer, xLength ) != pdFALSE )
+	{
+		sbRECEIVE_COMPLETED_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xLength;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAdvanceHead( StreamBuffer_t * const pxStreamBuffer, size_t xLength )
+{
+size_t xNextHead;
+BaseType_t xNotify = pdFALSE;
+
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 );
+	configASSERT( xLength <= xStreamBufferSpacesAvailable( pxStreamBuffer ) );
+
+	if( xLength > ( size_t ) 0 )
+	{
+		xNextHead = pxStreamBuffer->xHead + xLength;
+		if( xNextHead >= pxStreamBuffer->xLength )
+		{
+			xNextHead -= pxStreamBuffer->xLength;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxStreamBuffer->xHead = xNextHead;
+		traceSTREAM_BUFFER_SEND( pxStreamBuffer, xLength );
+
+		/* Was a task waiting for the data? */
+		if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+		{
+			xNotify = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xNotify;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvAdvanceTail( StreamBuffer_t * const pxStreamBuffer, size_t xLength )
+{
+size_t xNextTail;
+BaseType_t xNotify = pdFALSE;
+
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 );
+	configASSERT( xLength <= prvBytesInBuffer( pxStreamBuffer ) );
+
+	if( xLength > ( size_t ) 0 )
+	{
+		xNextTail = pxStreamBuffer->xTail + xLength;
+		if( xNextTail >= pxStreamBuffer->xLength )
+		{
+			xNextTail -= pxStreamBuffer->xLength;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxStreamBuffer->xTail = xNextTail;
+		traceSTREAM_BUFFER_RECEIVE( pxStreamBuffer, xLength );
+
+		/* Was a task waiting for space in the buffer? */
+		xNotify = pdTRUE;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xNotify;
+}
+/*-----------------------------------------------------------*/
+
 static size_t prvReadMessageFromBuffer( StreamBuffer_t *pxStreamBuffer,
 										void *pvRxData,
 										size_t xBufferLengthBytes,
@@ -922,7 +1246,6 @@ static size_t prvReadMessageFromBuffer( StreamBuffer_t *pxStreamBuffer,
 										size_t xBytesToStoreMessageLength )
 {
 size_t xOriginalTail, xReceivedLength, xNextMessageLength;
-configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
 
 	if( xBytesToStoreMessageLength != ( size_t ) 0 )
 	{
@@ -931,8 +1254,7 @@ configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
 		returned to its prior state if the length of the message is too
 		large for the provided buffer. */
 		xOriginalTail = pxStreamBuffer->xTail;
-		( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, xBytesToStoreMessageLength, xBytesAvailable );
-		xNextMessageLength = ( size_t ) xTempNextMessageLength;
+		xNextMessageLength = prvReadMessageLength( pxStreamBuffer, xBytesToStoreMessageLength, xBytesAvailable );
 
 		/* Reduce the number of bytes available by the number of bytes just
 		read out. */
@@ -1000,16 +1322,10 @@ const StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
 
 	/* This generic version of the receive function is used by both message
 	buffers, which store discrete messages, and stream buffers, which store a
-	continuous stream of bytes.  Discrete messages include an additional
-	sbBYTES_TO_STORE_MESSAGE_LENGTH bytes that hold the length of the message. */
-	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
-	{
-		xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
-	}
-	else
-	{
-		xBytesToStoreMessageLength = 0;
-	}
+	continuous stream of bytes.  Discrete messages include an additional one,
+	two or sbBYTES_TO_STORE_MESSAGE_LENGTH bytes that hold the length of the
+	message. */
+	xBytesToStoreMessageLength = sbMESSAGE_LENGTH_BYTES( pxStreamBuffer->ucFlags );
 
 	/* True if the available space equals zero. */
 	if( xStreamBufferSpacesAvailable( xStreamBuffer ) <= xBytesToStoreMessageLength )
@@ -1100,7 +1416,7 @@ size_t xNextHead, xFirstLength;
 
 	/* Write as many bytes as can be written in the first write. */
 	configASSERT( ( xNextHead + xFirstLength ) <= pxStreamBuffer->xLength );
-	( void ) memcpy( ( void* ) ( &( pxStreamBuffer->pucBuffer[ xNextHead ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	( void ) portMEMCPY( ( void* ) ( &( pxStreamBuffer->pucBuffer[ xNextHead ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
 
 	/* If the number of bytes written was less than the number that could be
 	written in the first write... */
@@ -1108,7 +1424,7 @@ size_t xNextHead, xFirstLength;
 	{
 		/* ...then write the remaining bytes to the start of the buffer. */
 		configASSERT( ( xCount - xFirstLength ) <= pxStreamBuffer->xLength );
-		( void ) memcpy( ( void * ) pxStreamBuffer->pucBuffer, ( const void * ) &( pucData[ xFirstLength ] ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+		( void ) portMEMCPY( ( void * ) pxStreamBuffer->pucBuffer, ( const void * ) &( pucData[ xFirstLength ] ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
 	}
 	else
 	{
@@ -1151,7 +1467,7 @@ size_t xCount, xFirstLength, xNextTail;
 		read.  Asserts check bounds of read and write. */
 		configASSERT( xFirstLength <= xMaxCount );
 		configASSERT( ( xNextTail + xFirstLength ) <= pxStreamBuffer->xLength );
-		( void ) memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xNextTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+		( void ) portMEMCPY( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xNextTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
 
 		/* If the total number of wanted bytes is greater than the number
 		that could be read in the first read... */
@@ -1159,7 +1475,7 @@ size_t xCount, xFirstLength, xNextTail;
 		{
 			/*...then read the remaining bytes from the start of the buffer. */
 			configASSERT( xCount <= xMaxCount );
-			( void ) memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+			( void ) portMEMCPY( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
 		}
 		else
 		{
@@ -1206,6 +1522,124 @@ size_t xCount;
 }
 /*-----------------------------------------------------------*/
 
+static uint8_t prvMessageBufferFlags( BaseType_t xIsMessageBuffer )
+{
+uint8_t ucFlags;
+
+	if( xIsMessageBuffer == sbMESSAGE_BUFFER_LENGTH_1_BYTE )
+	{
+		ucFlags = sbFLAGS_IS_MESSAGE_BUFFER | sbFLAGS_LENGTH_IN_1_BYTE;
+	}
+	else if( xIsMessageBuffer == sbMESSAGE_BUFFER_LENGTH_2_BYTES )
+	{
+		ucFlags = sbFLAGS_IS_MESSAGE_BUFFER | sbFLAGS_LENGTH_IN_2_BYTES;
+	}
+	else
+	{
+		configASSERT( xIsMessageBuffer == pdTRUE );
+		ucFlags = sbFLAGS_IS_MESSAGE_BUFFER;
+	}
+
+	return ucFlags;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteMessageLength( StreamBuffer_t * const pxStreamBuffer, size_t xDataLengthBytes, size_t xBytesToStoreMessageLength )
+{
+uint8_t ucLength[ 2 ];
+
+	if( xBytesToStoreMessageLength == sbBYTES_TO_STORE_MESSAGE_LENGTH )
+	{
+		( void ) prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xDataLengthBytes ), sbBYTES_TO_STORE_MESSAGE_LENGTH );
+	}
+	else
+	{
+		configASSERT( xBytesToStoreMessageLength <= sizeof( ucLength ) );
+		ucLength[ 0 ] = ( uint8_t ) xDataLengthBytes;
+		ucLength[ 1 ] = ( uint8_t ) ( xDataLengthBytes >> 8 );
+		( void ) prvWriteBytesToBuffer( pxStreamBuffer, ucLength, xBytesToStoreMessageLength );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReadMessageLength( StreamBuffer_t * const pxStreamBuffer, size_t xBytesToStoreMessageLength, size_t xBytesAvailable )
+{
+configMESSAGE_BUFFER_LENGTH_TYPE xTempLength;
+uint8_t ucLength[ 2 ] = { 0, 0 };
+size_t xReturn;
+
+	if( xBytesToStoreMessageLength == sbBYTES_TO_STORE_MESSAGE_LENGTH )
+	{
+		( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xBytesAvailable );
+		xReturn = ( size_t ) xTempLength;
+	}
+	else
+	{
+		configASSERT( xBytesToStoreMessageLength <= sizeof( ucLength ) );
+		( void ) prvReadBytesFromBuffer( pxStreamBuffer, ucLength, xBytesToStoreMessageLength, xBytesAvailable );
+		xReturn = ( size_t ) ucLength[ 0 ] | ( ( size_t ) ucLength[ 1 ] << 8 );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWaitForData( StreamBuffer_t * const pxStreamBuffer, size_t xBytesToStoreMessageLength, TickType_t xTicksToWait )
+{
+size_t xBytesAvailable;
+
+	if( xTicksToWait != ( TickType_t ) 0 )
+	{
+		/* Checking if there is data and clearing the notification state must be
+		performed atomically. */
+		taskENTER_CRITICAL();
+		{
+			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+			/* If this is a message buffer read then xBytesToStoreMessageLength
+			holds the number of bytes used to hold the length of the next
+			discrete message.  If this is a stream buffer read then
+			xBytesToStoreMessageLength will be 0. */
+			if( xBytesAvailable <= xBytesToStoreMessageLength )
+			{
+				/* Clear notification state as going to wait for data. */
+				( void ) xTaskNotifyStateClear( NULL );
+
+				/* Should only be one reader. */
+				configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+				pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xBytesAvailable <= xBytesToStoreMessageLength )
+		{
+			/* Wait for data to be available. */
+			traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( pxStreamBuffer );
+			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+			pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+			/* Recheck the data available after blocking. */
+			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+	}
+
+	return xBytesAvailable;
+}
+/*-----------------------------------------------------------*/
+
 static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 										  uint8_t * const pucBuffer,
 										  size_t xBufferSizeBytes,
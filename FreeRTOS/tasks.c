@@ -40,6 +40,10 @@ task.h is included from an application file. */
 #include "timers.h"
 #include "stack_macros.h"
 
+#if( configUSE_TASK_POOLS == 1 )
+	#include "mempool.h"
+#endif
+
 /* Lint e9021, e961 and e750 are suppressed as a MISRA exception justified
 because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
 for the header files above, but not in this file, in order to generate the
@@ -80,6 +84,17 @@ functions but without including stdio.h here. */
 #define tskSTATICALLY_ALLOCATED_STACK_ONLY 			( ( uint8_t ) 1 )
 #define tskSTATICALLY_ALLOCATED_STACK_AND_TCB		( ( uint8_t ) 2 )
 
+/* Heap blocks a deleted task can leave behind: its stack, its TCB, with
+configUSE_TASK_ARENAS its arena and, with configUSE_NEWLIB_REENTRANT set to 2,
+its newlib reent. */
+#define tskMAX_HEAP_BLOCKS_PER_TCB	( 4 )
+
+/* Number of deleted tasks the idle task cleans up with one call to
+vPortFreeBatch(). */
+#ifndef configTASK_DELETE_BATCH_LENGTH
+	#define configTASK_DELETE_BATCH_LENGTH	4
+#endif
+
 /* If any of the following are set then task stacks are filled with a known
 value so the high water mark can be determined.  If none of the following are
 set then don't fill the stack so there is no unnecessary dependency on memset. */
@@ -89,6 +104,10 @@ set then don't fill the stack so there is no unnecessary dependency on memset. *
 	#define tskSET_NEW_STACKS_TO_KNOWN_VALUE	0
 #endif
 
+#if( ( configUSE_IDLE_STACK_PAINTER == 1 ) && ( tskSET_NEW_STACKS_TO_KNOWN_VALUE == 0 ) )
+	#error configUSE_IDLE_STACK_PAINTER paints stacks that are never filled, set it to 0
+#endif
+
 /*
  * Macros used by vListTask to indicate which state a task is in.
  */
@@ -143,7 +162,7 @@ configIDLE_TASK_NAME in FreeRTOSConfig.h. */
 																										\
 		/* listGET_OWNER_OF_NEXT_ENTRY indexes through the list, so the tasks of						\
 		the	same priority get an equal share of the processor time. */									\
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );			\
+		taskSELECT_FROM_READY_LIST( uxTopPriority );													\
 		uxTopReadyPriority = uxTopPriority;																\
 	} /* taskSELECT_HIGHEST_PRIORITY_TASK */
 
@@ -173,7 +192,7 @@ configIDLE_TASK_NAME in FreeRTOSConfig.h. */
 		/* Find the highest priority list that contains ready tasks. */								\
 		portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );								\
 		configASSERT( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxTopPriority ] ) ) > 0 );		\
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );		\
+		taskSELECT_FROM_READY_LIST( uxTopPriority );												\
 	} /* taskSELECT_HIGHEST_PRIORITY_TASK() */
 
 	/*-----------------------------------------------------------*/
@@ -193,21 +212,121 @@ configIDLE_TASK_NAME in FreeRTOSConfig.h. */
 
 /*-----------------------------------------------------------*/
 
-/* pxDelayedTaskList and pxOverflowDelayedTaskList are switched when the tick
-count overflows. */
-#define taskSWITCH_DELAYED_LISTS()																	\
-{																									\
-	List_t *pxTemp;																					\
+#if( configUSE_DELAY_WHEEL == 0 )
+
+	/* pxDelayedTaskList and pxOverflowDelayedTaskList are switched when the
+	tick count overflows. */
+	#define taskSWITCH_DELAYED_LISTS()																\
+	{																								\
+		List_t *pxTemp;																				\
 																									\
-	/* The delayed tasks list should be empty when the lists are switched. */						\
-	configASSERT( ( listLIST_IS_EMPTY( pxDelayedTaskList ) ) );										\
+		/* The delayed tasks list should be empty when the lists are switched. */					\
+		configASSERT( ( listLIST_IS_EMPTY( pxDelayedTaskList ) ) );									\
 																									\
-	pxTemp = pxDelayedTaskList;																		\
-	pxDelayedTaskList = pxOverflowDelayedTaskList;													\
-	pxOverflowDelayedTaskList = pxTemp;																\
-	xNumOfOverflows++;																				\
-	prvResetNextTaskUnblockTime();																	\
-}
+		pxTemp = pxDelayedTaskList;																	\
+		pxDelayedTaskList = pxOverflowDelayedTaskList;												\
+		pxOverflowDelayedTaskList = pxTemp;															\
+		xNumOfOverflows++;																			\
+		prvResetNextTaskUnblockTime();																\
+	}
+
+	/* Place a delayed task's state list item, whose value is its wake time.
+	Both lists are kept in wake time order. */
+	#define taskINSERT_DELAYED( pxListItem )	vListInsert( pxDelayedTaskList, ( pxListItem ) )
+	#define taskINSERT_OVERFLOW_DELAYED( pxListItem )	vListInsert( pxOverflowDelayedTaskList, ( pxListItem ) )
+
+	#define taskIS_DELAYED_LIST( pxList ) ( ( ( pxList ) == pxDelayedTaskList ) || ( ( pxList ) == pxOverflowDelayedTaskList ) )
+
+#else /* configUSE_DELAY_WHEEL */
+
+	#define taskDELAY_WHEEL_SLOTS		( ( UBaseType_t ) 1U << configDELAY_WHEEL_SLOT_BITS )
+	#define taskDELAY_WHEEL_SLOT_MASK	( taskDELAY_WHEEL_SLOTS - ( UBaseType_t ) 1U )
+
+	/* When the tick count overflows the wheel has been emptied of the tasks
+	due before it, so the tasks whose wake time had already wrapped can move
+	in. */
+	#define taskSWITCH_DELAYED_LISTS()																\
+	{																								\
+		xNumOfOverflows++;																			\
+		prvDelayWheelOverflow();																	\
+	}
+
+	/* Both inserts are constant time.  A slot holds every task whose wake time
+	falls in it, whichever turn of the wheel that is, in no particular order;
+	the overflow list is only ever walked once, when the tick count wraps. */
+	#define taskINSERT_DELAYED( pxListItem )	prvDelayWheelInsert( pxListItem )
+	#define taskINSERT_OVERFLOW_DELAYED( pxListItem )	vListInsertEnd( pxOverflowDelayedTaskList, ( pxListItem ) )
+
+	#define taskIS_DELAYED_LIST( pxList )																	\
+		( ( ( ( pxList ) >= &( xDelayWheel[ 0 ] ) ) && ( ( pxList ) < &( xDelayWheel[ taskDELAY_WHEEL_SLOTS ] ) ) ) ||	\
+		  ( ( pxList ) == pxOverflowDelayedTaskList ) )
+
+#endif /* configUSE_DELAY_WHEEL */
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Start timing how long a task waits to run.  Only the first transition is
+ * stamped, so moving an already ready task between ready lists (for example
+ * after a priority change) does not restart its wait, and the running task is
+ * never stamped.  Zero means "not waiting", so a stamp of zero is nudged to one.
+ */
+#if ( configUSE_SWITCH_PROFILER == 1 )
+
+	#define taskMARK_READY_TIME( pxTCB )												\
+		if( ( ( pxTCB )->ulReadyTime == 0UL ) && ( ( pxTCB ) != pxCurrentTCB ) )		\
+		{																			\
+			( pxTCB )->ulReadyTime = portSWITCH_PROFILE_TIME() | 1UL;				\
+		}
+
+#else
+
+	#define taskMARK_READY_TIME( pxTCB )
+
+#endif /* configUSE_SWITCH_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_EDF_SCHEDULING == 0 )
+
+	/* Tasks of equal priority take turns, so each ready list is a ring that
+	listGET_OWNER_OF_NEXT_ENTRY() walks. */
+	#define taskINSERT_READY( pxTCB )	vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) )
+	#define taskSELECT_FROM_READY_LIST( uxTopPriority )	listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ ( uxTopPriority ) ] ) )
+
+#else /* configUSE_EDF_SCHEDULING */
+
+	/* The ready list at configEDF_PRIORITY is kept in deadline order, and the
+	task at its head runs.  Every other priority takes turns as usual. */
+	#define taskINSERT_READY( pxTCB )																		\
+	{																										\
+		if( ( pxTCB )->uxPriority == ( UBaseType_t ) configEDF_PRIORITY )									\
+		{																									\
+			prvEdfInsertReady( pxTCB );																		\
+		}																									\
+		else																								\
+		{																									\
+			vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) );	\
+		}																									\
+	}
+
+	#define taskSELECT_FROM_READY_LIST( uxTopPriority )														\
+	{																										\
+		if( ( uxTopPriority ) == ( UBaseType_t ) configEDF_PRIORITY )										\
+		{																									\
+			pxCurrentTCB = listGET_OWNER_OF_HEAD_ENTRY( &( pxReadyTasksLists[ configEDF_PRIORITY ] ) );	\
+		}																									\
+		else																								\
+		{																									\
+			listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ ( uxTopPriority ) ] ) );		\
+		}																									\
+	}
+
+#endif /* configUSE_EDF_SCHEDULING */
+
+/* Whether tick count a comes before b, allowing for the tick count overflowing
+between them.  Used for times that are always within half the tick range of
+each other. */
+#define taskTICK_IS_BEFORE( a, b )	( ( ( TickType_t ) ( ( a ) - ( b ) ) > ( portMAX_DELAY >> 1 ) ) ? pdTRUE : pdFALSE )
 
 /*-----------------------------------------------------------*/
 
@@ -217,8 +336,9 @@ count overflows. */
  */
 #define prvAddTaskToReadyList( pxTCB )																\
 	traceMOVED_TASK_TO_READY_STATE( pxTCB );														\
+	taskMARK_READY_TIME( pxTCB );																	\
 	taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );												\
-	vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
+	taskINSERT_READY( pxTCB );																		\
 	tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB )
 /*-----------------------------------------------------------*/
 
@@ -259,9 +379,30 @@ typedef struct tskTaskControlBlock 			/* The old naming convention is used to pr
 
 	ListItem_t			xStateListItem;	/*< The list that the state list item of a task is reference from denotes the state of that task (Ready, Blocked, Suspended ). */
 	ListItem_t			xEventListItem;		/*< Used to reference a task from an event list. */
-	UBaseType_t			uxPriority;			/*< The priority of the task.  0 is the lowest priority. */
+
+	#if( configUSE_COMPACT_TCB == 1 )
+		/* The 16 bit fields together, so that they pack, next to the list
+		items vTaskSwitchContext() reads. */
+		uint16_t		uxPriority;			/*< The priority of the task.  0 is the lowest priority. */
+		#if ( configUSE_MUTEXES == 1 )
+			uint16_t	uxBasePriority;		/*< The priority last assigned to the task - used by the priority inheritance mechanism. */
+			uint16_t	uxMutexesHeld;
+		#endif
+		#if ( configUSE_TRACE_FACILITY == 1 )
+			uint16_t	uxTCBNumber;		/*< Stores a number that increments each time a TCB is created, modulo 2^16. */
+			uint16_t	uxTaskNumber;		/*< Stores a number specifically for use by third party trace code. */
+		#endif
+	#else
+		UBaseType_t		uxPriority;			/*< The priority of the task.  0 is the lowest priority. */
+	#endif
+
 	StackType_t			*pxStack;			/*< Points to the start of the stack. */
-	char				pcTaskName[ configMAX_TASK_NAME_LEN ];/*< Descriptive name given to the task when created.  Facilitates debugging only. */ /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+
+	#if( configUSE_COMPACT_TCB == 1 )
+		const char		*pcTaskName;		/*< The name given at creation, not copied, so it must outlive the task. */ /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+	#else
+		char			pcTaskName[ configMAX_TASK_NAME_LEN ];/*< Descriptive name given to the task when created.  Facilitates debugging only. */ /*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+	#endif
 
 	#if ( ( portSTACK_GROWTH > 0 ) || ( configRECORD_STACK_HIGH_ADDRESS == 1 ) )
 		StackType_t		*pxEndOfStack;		/*< Points to the highest valid address for the stack. */
@@ -271,12 +412,12 @@ typedef struct tskTaskControlBlock 			/* The old naming convention is used to pr
 		UBaseType_t		uxCriticalNesting;	/*< Holds the critical section nesting depth for ports that do not maintain their own count in the port layer. */
 	#endif
 
-	#if ( configUSE_TRACE_FACILITY == 1 )
+	#if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_COMPACT_TCB == 0 ) )
 		UBaseType_t		uxTCBNumber;		/*< Stores a number that increments each time a TCB is created.  It allows debuggers to determine when a task has been deleted and then recreated. */
 		UBaseType_t		uxTaskNumber;		/*< Stores a number specifically for use by third party trace code. */
 	#endif
 
-	#if ( configUSE_MUTEXES == 1 )
+	#if ( ( configUSE_MUTEXES == 1 ) && ( configUSE_COMPACT_TCB == 0 ) )
 		UBaseType_t		uxBasePriority;		/*< The priority last assigned to the task - used by the priority inheritance mechanism. */
 		UBaseType_t		uxMutexesHeld;
 	#endif
@@ -291,6 +432,12 @@ typedef struct tskTaskControlBlock 			/* The old naming convention is used to pr
 
 	#if( configGENERATE_RUN_TIME_STATS == 1 )
 		uint32_t		ulRunTimeCounter;	/*< Stores the amount of time the task has spent in the Running state. */
+		uint32_t		ulSwitchInCount;	/*< Stores the number of times the task has been switched in. */
+	#endif
+
+	#if( configUSE_TASK_ENERGY_STATS == 1 )
+		uint32_t		ulEnergyRunTime[ configENERGY_PROFILES ];	/*< ulRunTimeCounter split by the energy profile in force while the task ran. */
+		uint32_t		ulWakeCount;		/*< Low power sleeps the task was the first to run after. */
 	#endif
 
 	#if ( configUSE_NEWLIB_REENTRANT == 1 )
@@ -302,11 +449,13 @@ typedef struct tskTaskControlBlock 			/* The old naming convention is used to pr
 		stubs. Be warned that (at the time of writing) the current newlib design
 		implements a system-wide malloc() that must be provided with locks. */
 		struct	_reent xNewLib_reent;
+	#elif ( configUSE_NEWLIB_REENTRANT == 2 )
+		struct	_reent *pxNewLibReent;		/*< The task's own reent from xTaskNewlibReentCreate(), otherwise _global_impure_ptr, shared by every task without one. */
 	#endif
 
 	#if( configUSE_TASK_NOTIFICATIONS == 1 )
-		volatile uint32_t ulNotifiedValue;
-		volatile uint8_t ucNotifyState;
+		volatile uint32_t ulNotifiedValue[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
+		volatile uint8_t ucNotifyState[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
 	#endif
 
 	/* See the comments in FreeRTOS.h with the definition of
@@ -323,6 +472,50 @@ typedef struct tskTaskControlBlock 			/* The old naming convention is used to pr
 		int iTaskErrno;
 	#endif
 
+	#if( configUSE_TASK_ARENAS == 1 )
+		struct xTASK_ARENA *pxArena;		/*< Bump allocator set up by xTaskArenaCreate(), NULL if the task has none. */
+	#endif
+
+	#if( configUSE_SWITCH_PROFILER == 1 )
+		uint32_t ulReadyTime;				/*< When the task last became ready or was preempted, 0 while it is running or not ready. */
+		SwitchProfile_t xReadyLatency;		/*< How long the task waited between ulReadyTime and running. */
+	#endif
+
+	#if( configUSE_EDF_SCHEDULING == 1 )
+		TickType_t xPeriod;					/*< Set by vTaskSetDeadline(), 0 if the task has no deadline. */
+		TickType_t xRelativeDeadline;
+		TickType_t xReleaseTime;			/*< When the current job was released. */
+		TickType_t xDeadline;				/*< When the current job must be finished by. */
+		uint32_t ulDeadlineMisses;			/*< Jobs that called xTaskWaitForNextPeriod() after their deadline. */
+	#endif
+
+	#if( configUSE_TASK_BUDGETS == 1 )
+		ListItem_t xBudgetListItem;			/*< In xBudgetedTasks while the task has a budget. */
+		TickType_t xBudget;					/*< Ticks the task may run for per xBudgetPeriod, 0 for no limit. */
+		TickType_t xBudgetPeriod;
+		TickType_t xBudgetUsed;
+		TickType_t xBudgetReplenishTime;	/*< When xBudgetUsed is next cleared. */
+		UBaseType_t uxBudgetSavedPriority;	/*< The base priority to go back to when demoted. */
+		UBaseType_t uxBudgetDemoted;
+		uint32_t ulBudgetOverruns;
+	#endif
+
+	#if( configUSE_PREEMPTION_THRESHOLD == 1 )
+		UBaseType_t uxPreemptionThreshold;	/*< Set by vTaskSetPreemptionThreshold(), tskIDLE_PRIORITY if the task has none. */
+		UBaseType_t uxThresholdSavedPriority;	/*< The priority to go back to when the task stops running. */
+		UBaseType_t uxThresholdRaised;		/*< pdTRUE while the task runs, or waits preempted, at its threshold. */
+	#endif
+
+	#if( configUSE_TASK_FPU_POLICY == 1 )
+		UBaseType_t uxFpuPolicy;			/*< An eTaskFpuPolicy, eTaskFpuNone unless set by vTaskSetFpuPolicy(). */
+	#endif
+
+	#if( configUSE_IDLE_STACK_PAINTER == 1 )
+		StackType_t *pxStackPainted;		/*< One past the highest word filled, the stack being filled from pxStack up. */
+		BaseType_t xStackPaintable;			/*< pdTRUE until the task is first switched in. */
+		struct tskTaskControlBlock *pxNextToPaint;	/*< Next in pxTasksToPaint. */
+	#endif
+
 } tskTCB;
 
 /* The old tskTCB name is maintained above then typedefed to the new TCB_t name
@@ -331,29 +524,41 @@ typedef tskTCB TCB_t;
 
 /*lint -save -e956 A manual analysis and inspection has been used to determine
 which static variables must be declared volatile. */
-PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = NULL;
+portDONT_DISCARD PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE TCB_t * volatile pxCurrentTCB = NULL;
 
 /* Lists for ready and blocked tasks. --------------------
 xDelayedTaskList1 and xDelayedTaskList2 could be move to function scople but
 doing so breaks some kernel aware debuggers and debuggers that rely on removing
 the static qualifier. */
-PRIVILEGED_DATA static List_t pxReadyTasksLists[ configMAX_PRIORITIES ];/*< Prioritised ready tasks. */
-PRIVILEGED_DATA static List_t xDelayedTaskList1;						/*< Delayed tasks. */
-PRIVILEGED_DATA static List_t xDelayedTaskList2;						/*< Delayed tasks (two lists are used - one for delays that have overflowed the current tick count. */
-PRIVILEGED_DATA static List_t * volatile pxDelayedTaskList;				/*< Points to the delayed task list currently being used. */
-PRIVILEGED_DATA static List_t * volatile pxOverflowDelayedTaskList;		/*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
-PRIVILEGED_DATA static List_t xPendingReadyList;						/*< Tasks that have been readied while the scheduler was suspended.  They will be moved to the ready list when the scheduler is resumed. */
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static List_t pxReadyTasksLists[ configMAX_PRIORITIES ];/*< Prioritised ready tasks. */
+#if( configUSE_DELAY_WHEEL == 0 )
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static List_t xDelayedTaskList1;					/*< Delayed tasks. */
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static List_t xDelayedTaskList2;					/*< Delayed tasks (two lists are used - one for delays that have overflowed the current tick count. */
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static List_t * volatile pxDelayedTaskList;			/*< Points to the delayed task list currently being used. */
+#else
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static List_t xDelayWheel[ taskDELAY_WHEEL_SLOTS ];	/*< Delayed tasks, in the slot given by the low bits of their wake time. */
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static List_t xDelayedTaskList2;					/*< Delayed tasks whose wake time has overflowed the current tick count, unsorted. */
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static uint32_t ulDelayWheelOccupied = 0UL;			/*< Bit n set if slot n may hold a task.  Cleared lazily, when a slot is found empty. */
+#endif
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static List_t * volatile pxOverflowDelayedTaskList;		/*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static List_t xPendingReadyList;						/*< Tasks that have been readied while the scheduler was suspended.  They will be moved to the ready list when the scheduler is resumed. */
 
 #if( INCLUDE_vTaskDelete == 1 )
 
-	PRIVILEGED_DATA static List_t xTasksWaitingTermination;				/*< Tasks that have been deleted - but their memory not yet freed. */
-	PRIVILEGED_DATA static volatile UBaseType_t uxDeletedTasksWaitingCleanUp = ( UBaseType_t ) 0U;
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static List_t xTasksWaitingTermination;				/*< Tasks that have been deleted - but their memory not yet freed. */
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile UBaseType_t uxDeletedTasksWaitingCleanUp = ( UBaseType_t ) 0U;
+
+#endif
+
+#if( configUSE_IDLE_STACK_PAINTER == 1 )
+
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static TCB_t *pxTasksToPaint = NULL;		/*< Tasks whose stacks are only filled up to pxStackPainted, newest first. */
 
 #endif
 
 #if ( INCLUDE_vTaskSuspend == 1 )
 
-	PRIVILEGED_DATA static List_t xSuspendedTaskList;					/*< Tasks that are currently suspended. */
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static List_t xSuspendedTaskList;					/*< Tasks that are currently suspended. */
 
 #endif
 
@@ -364,16 +569,20 @@ the errno of the currently running task. */
 #endif
 
 /* Other file private variables. --------------------------------*/
-PRIVILEGED_DATA static volatile UBaseType_t uxCurrentNumberOfTasks 	= ( UBaseType_t ) 0U;
-PRIVILEGED_DATA static volatile TickType_t xTickCount 				= ( TickType_t ) configINITIAL_TICK_COUNT;
-PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority 		= tskIDLE_PRIORITY;
-PRIVILEGED_DATA static volatile BaseType_t xSchedulerRunning 		= pdFALSE;
-PRIVILEGED_DATA static volatile UBaseType_t uxPendedTicks 			= ( UBaseType_t ) 0U;
-PRIVILEGED_DATA static volatile BaseType_t xYieldPending 			= pdFALSE;
-PRIVILEGED_DATA static volatile BaseType_t xNumOfOverflows 			= ( BaseType_t ) 0;
-PRIVILEGED_DATA static UBaseType_t uxTaskNumber 					= ( UBaseType_t ) 0U;
-PRIVILEGED_DATA static volatile TickType_t xNextTaskUnblockTime		= ( TickType_t ) 0U; /* Initialised to portMAX_DELAY before the scheduler starts. */
-PRIVILEGED_DATA static TaskHandle_t xIdleTaskHandle					= NULL;			/*< Holds the handle of the idle task.  The idle task is created automatically when the scheduler is started. */
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile UBaseType_t uxCurrentNumberOfTasks 	= ( UBaseType_t ) 0U;
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile TickType_t xTickCount 				= ( TickType_t ) configINITIAL_TICK_COUNT;
+#ifdef portREADY_PRIORITIES_TYPE
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile portREADY_PRIORITIES_TYPE uxTopReadyPriority;	/*< Port defined bit maps, zero initialised. */
+#else
+	PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile UBaseType_t uxTopReadyPriority 	= tskIDLE_PRIORITY;
+#endif
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile BaseType_t xSchedulerRunning 		= pdFALSE;
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile UBaseType_t uxPendedTicks 			= ( UBaseType_t ) 0U;
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile BaseType_t xYieldPending 			= pdFALSE;
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile BaseType_t xNumOfOverflows 			= ( BaseType_t ) 0;
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static UBaseType_t uxTaskNumber 					= ( UBaseType_t ) 0U;
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile TickType_t xNextTaskUnblockTime		= ( TickType_t ) 0U; /* Initialised to portMAX_DELAY before the scheduler starts. */
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static TaskHandle_t xIdleTaskHandle					= NULL;			/*< Holds the handle of the idle task.  The idle task is created automatically when the scheduler is started. */
 
 /* Context switches are held pending while the scheduler is suspended.  Also,
 interrupts must not manipulate the xStateListItem of a TCB, or any of the
@@ -383,7 +592,7 @@ moves the task's event list item into the xPendingReadyList, ready for the
 kernel to move the task from the pending ready list into the real ready list
 when the scheduler is unsuspended.  The pending ready list itself can only be
 accessed from a critical section. */
-PRIVILEGED_DATA static volatile UBaseType_t uxSchedulerSuspended	= ( UBaseType_t ) pdFALSE;
+PRIVILEGED_DATA configKERNEL_DATA_ATTRIBUTE static volatile UBaseType_t uxSchedulerSuspended	= ( UBaseType_t ) pdFALSE;
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
@@ -394,6 +603,102 @@ PRIVILEGED_DATA static volatile UBaseType_t uxSchedulerSuspended	= ( UBaseType_t
 
 #endif
 
+#if( configUSE_TIME_SLICE_QUANTA == 1 )
+
+	/* The time slice of each priority, and the ticks of its slice the running
+	task has used.  configTIME_SLICE_QUANTA may leave out the higher
+	priorities, which are then zero. */
+	static const TickType_t xTimeSliceQuanta[ configMAX_PRIORITIES ] = configTIME_SLICE_QUANTA;
+	PRIVILEGED_DATA static TickType_t xSliceTicksUsed = ( TickType_t ) 0U;
+
+#endif
+
+#if( configUSE_TASK_ENERGY_STATS == 1 )
+
+	/* The profile set by vTaskSetEnergyProfile(), the run time counter when the
+	running task's time was last charged to it, and whether a sleep has ended
+	that no task has yet been charged with. */
+	PRIVILEGED_DATA static UBaseType_t uxEnergyProfile = 0U;
+	PRIVILEGED_DATA static uint32_t ulEnergyChargedTime = 0UL;
+	PRIVILEGED_DATA static volatile BaseType_t xWakeUnclaimed = pdFALSE;
+
+#endif
+
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_TASK_POOLS == 1 ) )
+
+	/* One stack pool per entry of configTASK_STACK_POOLS, which lists
+	{ depth in words, number of stacks } pairs with the smallest depth first. */
+	typedef struct xTASK_STACK_POOL_CONFIG
+	{
+		configSTACK_DEPTH_TYPE usStackDepth;
+		UBaseType_t uxStacks;
+	} TaskStackPoolConfig_t;
+
+	static const TaskStackPoolConfig_t xTaskStackPoolConfig[] = configTASK_STACK_POOLS;
+	#define tskSTACK_POOL_COUNT		( sizeof( xTaskStackPoolConfig ) / sizeof( xTaskStackPoolConfig[ 0 ] ) )
+
+	PRIVILEGED_DATA static MemPool_t xTCBPool;
+	PRIVILEGED_DATA static MemPool_t xStackPools[ tskSTACK_POOL_COUNT ];
+	PRIVILEGED_DATA static BaseType_t xTaskPoolsInitialised = pdFALSE;
+
+#endif
+
+#if( configUSE_TASK_ARENAS == 1 )
+
+	/* Header at the start of the single heap block that holds an arena.  The
+	arena memory follows the header, and pucNext only ever moves forward until
+	the arena is reset or freed along with its task. */
+	typedef struct xTASK_ARENA
+	{
+		uint8_t *pucNext;
+		uint8_t *pucEnd;
+	} TaskArena_t;
+
+	#define tskARENA_HEADER_SIZE	( ( sizeof( TaskArena_t ) + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+#endif
+
+#if( configUSE_SWITCH_PROFILER == 1 )
+
+	/* Time spent in the context switch handler, indexed by whether the
+	outgoing task's floating point registers had to be saved. */
+	PRIVILEGED_DATA static SwitchProfile_t xSwitchTimes[ 2 ];
+
+	/* The port stamps each entry and exit, but the exit of a given switch is
+	only known at the next one, so the previous entry is remembered here. */
+	PRIVILEGED_DATA static uint32_t ulPreviousSwitchEntry = 0UL;
+	PRIVILEGED_DATA static BaseType_t xPreviousSwitchSavedFPU = pdFALSE;
+	PRIVILEGED_DATA static BaseType_t xPreviousSwitchValid = pdFALSE;
+
+	#ifdef portSWITCH_PROFILE_REGION_TIME
+		/* The part of the switch spent reloading MPU regions, and how often
+		it took longer than configMPU_REGION_SWITCH_BUDGET. */
+		PRIVILEGED_DATA static SwitchProfile_t xRegionSwitchTimes;
+		PRIVILEGED_DATA static uint32_t ulRegionSwitchOverruns = 0UL;
+	#endif
+
+#endif
+
+#if( configUSE_SECTION_PROFILER == 1 )
+
+	/* The worst call sites of each eSectionType, in no particular order. */
+	PRIVILEGED_DATA static SectionSite_t xSectionSites[ 2 ][ configSECTION_PROFILE_SITES ];
+
+	/* When and from where the scheduler was last suspended from running. */
+	PRIVILEGED_DATA static uint32_t ulSuspendedTime = 0UL;
+	PRIVILEGED_DATA static uint32_t ulSuspendedAt = 0UL;
+
+#endif
+
+#if( configUSE_TASK_BUDGETS == 1 )
+
+	/* Tasks given a budget by vTaskSetBudget(), and the earliest time at which
+	one of them is due to be replenished. */
+	PRIVILEGED_DATA static List_t xBudgetedTasks;
+	PRIVILEGED_DATA static TickType_t xNextBudgetReplenishTime = ( TickType_t ) 0U;
+
+#endif
+
 /*lint -restore */
 
 /*-----------------------------------------------------------*/
@@ -411,6 +716,18 @@ PRIVILEGED_DATA static volatile UBaseType_t uxSchedulerSuspended	= ( UBaseType_t
 
 #endif
 
+#if( configUSE_BUDGET_OVERRUN_HOOK == 1 )
+
+	extern void vApplicationBudgetOverrunHook( TaskHandle_t xTask ); /*lint !e526 Symbol not defined as it is an application callback. */
+
+#endif
+
+#if( configUSE_TASK_FPU_POLICY == 1 )
+
+	extern void vApplicationFpuMisuseHook( TaskHandle_t xTask, char *pcTaskName ); /*lint !e526 Symbol not defined as it is an application callback. */
+
+#endif
+
 #if( configSUPPORT_STATIC_ALLOCATION == 1 )
 
 	extern void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize ); /*lint !e526 Symbol not defined as it is an application callback. */
@@ -462,6 +779,44 @@ static portTASK_FUNCTION_PROTO( prvIdleTask, pvParameters );
 
 #endif
 
+/*
+ * The work of prvDeleteTCB() without the call to the heap.  Memory that came
+ * from a task pool is returned to it straight away, and the heap blocks that
+ * remain are written to pvToFree[], which must have room for
+ * tskMAX_HEAP_BLOCKS_PER_TCB entries.  Returns the number written, so the idle
+ * task can give the blocks of several deleted tasks to one vPortFreeBatch().
+ */
+#if ( INCLUDE_vTaskDelete == 1 )
+
+	static UBaseType_t prvReleaseTCB( TCB_t *pxTCB, void *pvToFree[] ) PRIVILEGED_FUNCTION;
+
+	#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+		static UBaseType_t prvReleaseTaskMemory( void *pv, void *pvToFree[], UBaseType_t uxBlocks ) PRIVILEGED_FUNCTION;
+	#endif
+
+#endif
+
+/*
+ * Used only by the idle task.  Fills up to configSTACK_PAINT_STEP more words
+ * of the stack of the first task in pxTasksToPaint, stopping below its
+ * initial top of stack, and takes it off the list once that is reached or
+ * the task has run.
+ */
+#if( configUSE_IDLE_STACK_PAINTER == 1 )
+
+	static void prvPaintStacks( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Take pxTCB off pxTasksToPaint, if it is there.  Called in a critical section.
+ */
+#if( ( configUSE_IDLE_STACK_PAINTER == 1 ) && ( INCLUDE_vTaskDelete == 1 ) )
+
+	static void prvStopPainting( const TCB_t *pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Used only by the idle task.  This checks to see if anything has been placed
  * in the list of tasks waiting to be deleted.  If so the task is cleaned up
@@ -525,12 +880,122 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait, const BaseT
 
 #endif
 
+/*
+ * Add one sample to a switch profile distribution, and account for the
+ * previous pass through the context switch handler.
+ */
+#if ( configUSE_SWITCH_PROFILER == 1 )
+
+	static void prvSwitchProfileRecord( SwitchProfile_t *pxProfile, uint32_t ulTime ) PRIVILEGED_FUNCTION;
+	static void prvSwitchProfileReset( SwitchProfile_t *pxProfile ) PRIVILEGED_FUNCTION;
+	static void prvSwitchProfileHandlerTime( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Copy a site table out longest first, see uxTaskGetSectionProfile().
+ */
+#if ( configUSE_SECTION_PROFILER == 1 )
+
+	static UBaseType_t prvSectionProfileSort( const SectionSite_t *pxTable, SectionSite_t *pxSites, UBaseType_t uxMaxSites ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Insert a task that is becoming ready at configEDF_PRIORITY into its ready
+ * list in deadline order.
+ */
+#if ( configUSE_EDF_SCHEDULING == 1 )
+
+	static void prvEdfInsertReady( TCB_t * const pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif
+
+#if ( configUSE_TASK_BUDGETS == 1 )
+
+	/*
+	 * Replenish the budgets whose period has ended, then charge the tick that
+	 * has just ended to the running task, demoting it if that exhausts its
+	 * budget.  Returns pdTRUE if a context switch is required.
+	 */
+	static BaseType_t prvBudgetTick( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Move a task to the demoted priority until its budget is replenished, and
+	 * back again.
+	 */
+	static void prvBudgetDemote( TCB_t * const pxTCB ) PRIVILEGED_FUNCTION;
+	static void prvBudgetRestore( TCB_t * const pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif
+
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+	/*
+	 * Called as the running task is switched out.  Drops a task that has
+	 * stopped being ready back from its threshold, and returns pdTRUE if a
+	 * task still ready at its threshold is to keep the processor.
+	 */
+	static BaseType_t prvThresholdSwitchOut( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Move a task to its threshold priority as it starts running, and back
+	 * again.  Called in a critical section or from vTaskSwitchContext().
+	 */
+	static void prvThresholdRaise( TCB_t * const pxTCB ) PRIVILEGED_FUNCTION;
+	static void prvThresholdRestore( TCB_t * const pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif
+
+#if ( ( configUSE_TASK_BUDGETS == 1 ) || ( configHEAP_LOCK_CEILING > 0 ) || ( configUSE_PREEMPTION_THRESHOLD == 1 ) )
+
+	/*
+	 * Run a task at uxNewPriority without changing its base priority, moving it
+	 * to the matching ready list if it is ready.  Called in a critical section.
+	 */
+	static void prvMoveTaskToPriority( TCB_t * const pxTCB, UBaseType_t uxNewPriority ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Set xNextTaskUnblockTime to the time at which the next Blocked state task
  * will exit the Blocked state.
  */
 static void prvResetNextTaskUnblockTime( void );
 
+#if( configUSE_DELAY_WHEEL == 1 )
+
+	/*
+	 * Put a delayed task's state list item, whose value is a wake time that has
+	 * not overflowed, into its wheel slot.
+	 */
+	static void prvDelayWheelInsert( ListItem_t * const pxListItem ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Unblock every task whose wake time is from xNextTaskUnblockTime up to
+	 * and including xTimeNow.  Returns pdTRUE if a context switch is required.
+	 */
+	static BaseType_t prvDelayWheelAdvance( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Move the tasks from the overflow list into the wheel once the tick count
+	 * has wrapped.
+	 */
+	static void prvDelayWheelOverflow( void ) PRIVILEGED_FUNCTION;
+
+	#if( configUSE_TICKLESS_IDLE != 0 )
+
+		/*
+		 * xNextTaskUnblockTime is only a lower bound while the wheel is in use.
+		 * Raise it to the earliest wake time actually in the wheel before the
+		 * tick is suppressed.  Called with the scheduler suspended.
+		 */
+		static void prvDelayWheelTighten( void ) PRIVILEGED_FUNCTION;
+
+	#endif
+
+#endif /* configUSE_DELAY_WHEEL */
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
 	/*
@@ -571,6 +1036,42 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 
 #endif
 
+/*
+ * Allocate and free the TCB and stack of a dynamically created task.  With
+ * configUSE_TASK_POOLS set the TCB and any stack whose depth fits one of the
+ * configTASK_STACK_POOLS classes come from fixed size pools, so creating and
+ * deleting tasks does not fragment the heap.  Other stacks, and requests made
+ * once a pool is empty, fall back to pvPortMalloc().
+ */
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	#if( configUSE_TASK_POOLS == 1 )
+
+		static void prvInitialiseTaskPools( void ) PRIVILEGED_FUNCTION;
+		static void *prvAllocateTCB( void ) PRIVILEGED_FUNCTION;
+		static void *prvAllocateStack( configSTACK_DEPTH_TYPE usStackDepth ) PRIVILEGED_FUNCTION;
+		static BaseType_t prvReturnToTaskPool( void *pv ) PRIVILEGED_FUNCTION;
+		static void prvFreeTaskMemory( void *pv ) PRIVILEGED_FUNCTION;
+
+	#else
+
+		#define prvAllocateTCB()					pvPortMalloc( sizeof( TCB_t ) )
+		#define prvAllocateStack( usStackDepth )	pvPortMalloc( ( ( size_t ) ( usStackDepth ) ) * sizeof( StackType_t ) )
+		#define prvReturnToTaskPool( pv )			( pdFALSE )
+		#define prvFreeTaskMemory( pv )				vPortFree( pv )
+
+	#endif /* configUSE_TASK_POOLS */
+
+	#define prvFreeTaskBlocks( pvBlocks, uxCount )	vPortFreeBatch( ( pvBlocks ), ( size_t ) ( uxCount ) )
+
+#else
+
+	/* Only statically allocated tasks exist, so there is never anything for
+	the heap to free. */
+	#define prvFreeTaskBlocks( pvBlocks, uxCount )	( ( void ) ( pvBlocks ), ( void ) ( uxCount ) )
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+
 /*-----------------------------------------------------------*/
 
 #if( configSUPPORT_STATIC_ALLOCATION == 1 )
@@ -736,10 +1237,6 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 	{
 	TCB_t *pxNewTCB;
 	BaseType_t xReturn;
-    char name[20];
-    strcpy(name, pcName);
-    strcat(name, "\n\r");
-    HAL_UART_Transmit(&huart2, (uint8_t *)name, strlen(name), 0xffff);
 
 		/* If the stack grows down then allocate the stack then the TCB so the stack
 		does not grow into the TCB.  Likewise if the stack grows up then allocate
@@ -749,19 +1246,19 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 			/* Allocate space for the TCB.  Where the memory comes from depends on
 			the implementation of the port malloc function and whether or not static
 			allocation is being used. */
-			pxNewTCB = ( TCB_t * ) pvPortMalloc( sizeof( TCB_t ) );
+			pxNewTCB = ( TCB_t * ) prvAllocateTCB();
 
 			if( pxNewTCB != NULL )
 			{
 				/* Allocate space for the stack used by the task being created.
 				The base of the stack memory stored in the TCB so the task can
 				be deleted later if required. */
-				pxNewTCB->pxStack = ( StackType_t * ) pvPortMalloc( ( ( ( size_t ) usStackDepth ) * sizeof( StackType_t ) ) ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+				pxNewTCB->pxStack = ( StackType_t * ) prvAllocateStack( usStackDepth ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
 
 				if( pxNewTCB->pxStack == NULL )
 				{
 					/* Could not allocate the stack.  Delete the allocated TCB. */
-					vPortFree( pxNewTCB );
+					prvFreeTaskMemory( pxNewTCB );
 					pxNewTCB = NULL;
 				}
 			}
@@ -771,12 +1268,12 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 		StackType_t *pxStack;
 
 			/* Allocate space for the stack used by the task being created. */
-			pxStack = pvPortMalloc( ( ( ( size_t ) usStackDepth ) * sizeof( StackType_t ) ) ); /*lint !e9079 All values returned by pvPortMalloc() have at least the alignment required by the MCU's stack and this allocation is the stack. */
+			pxStack = prvAllocateStack( usStackDepth ); /*lint !e9079 All values returned by pvPortMalloc() have at least the alignment required by the MCU's stack and this allocation is the stack. */
 
 			if( pxStack != NULL )
 			{
 				/* Allocate space for the TCB. */
-				pxNewTCB = ( TCB_t * ) pvPortMalloc( sizeof( TCB_t ) ); /*lint !e9087 !e9079 All values returned by pvPortMalloc() have at least the alignment required by the MCU's stack, and the first member of TCB_t is always a pointer to the task's stack. */
+				pxNewTCB = ( TCB_t * ) prvAllocateTCB(); /*lint !e9087 !e9079 All values returned by pvPortMalloc() have at least the alignment required by the MCU's stack, and the first member of TCB_t is always a pointer to the task's stack. */
 
 				if( pxNewTCB != NULL )
 				{
@@ -787,7 +1284,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 				{
 					/* The stack cannot be used as the TCB was not created.  Free
 					it again. */
-					vPortFree( pxStack );
+					prvFreeTaskMemory( pxStack );
 				}
 			}
 			else
@@ -822,43 +1319,178 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB ) PRIVILEGED_FUNCTION;
 #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
 /*-----------------------------------------------------------*/
 
-static void prvInitialiseNewTask( 	TaskFunction_t pxTaskCode,
-									const char * const pcName,		/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
-									const uint32_t ulStackDepth,
-									void * const pvParameters,
-									UBaseType_t uxPriority,
-									TaskHandle_t * const pxCreatedTask,
-									TCB_t *pxNewTCB,
-									const MemoryRegion_t * const xRegions )
-{
-StackType_t *pxTopOfStack;
-UBaseType_t x;
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configUSE_TASK_POOLS == 1 ) )
 
-	#if( portUSING_MPU_WRAPPERS == 1 )
-		/* Should the task be created in privileged mode? */
-		BaseType_t xRunPrivileged;
-		if( ( uxPriority & portPRIVILEGE_BIT ) != 0U )
+	static void prvInitialiseTaskPools( void )
+	{
+	size_t xPool, xStackBytes;
+
+		if( xTaskPoolsInitialised != pdFALSE )
 		{
-			xRunPrivileged = pdTRUE;
+			return;
 		}
-		else
+
+		/* Tasks are only created from task context, so suspending the
+		scheduler makes the one time set up safe.  The storage for each pool is
+		taken from the heap once and never returned, so it does not fragment
+		it. */
+		vTaskSuspendAll();
+
+		if( xTaskPoolsInitialised == pdFALSE )
 		{
-			xRunPrivileged = pdFALSE;
+			vMemPoolInit( &xTCBPool, pvPortMalloc( mempoolSTORAGE_SIZE( sizeof( TCB_t ), configTASK_TCB_POOL_LENGTH ) ), sizeof( TCB_t ), configTASK_TCB_POOL_LENGTH );
+
+			for( xPool = 0; xPool < tskSTACK_POOL_COUNT; xPool++ )
+			{
+				/* The classes must be listed smallest first for the search in
+				prvAllocateStack() to pick the tightest fit. */
+				configASSERT( ( xPool == 0 ) || ( xTaskStackPoolConfig[ xPool - 1 ].usStackDepth < xTaskStackPoolConfig[ xPool ].usStackDepth ) );
+
+				xStackBytes = ( size_t ) xTaskStackPoolConfig[ xPool ].usStackDepth * sizeof( StackType_t );
+				vMemPoolInit( &( xStackPools[ xPool ] ), pvPortMalloc( mempoolSTORAGE_SIZE( xStackBytes, xTaskStackPoolConfig[ xPool ].uxStacks ) ), xStackBytes, xTaskStackPoolConfig[ xPool ].uxStacks );
+			}
+
+			xTaskPoolsInitialised = pdTRUE;
 		}
-		uxPriority &= ~portPRIVILEGE_BIT;
-	#endif /* portUSING_MPU_WRAPPERS == 1 */
 
-	/* Avoid dependency on memset() if it is not required. */
-	#if( tskSET_NEW_STACKS_TO_KNOWN_VALUE == 1 )
-	{
-		/* Fill the stack with a known value to assist debugging. */
-		( void ) memset( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) ulStackDepth * sizeof( StackType_t ) );
+		( void ) xTaskResumeAll();
 	}
-	#endif /* tskSET_NEW_STACKS_TO_KNOWN_VALUE */
+	/*-----------------------------------------------------------*/
 
-	/* Calculate the top of stack address.  This depends on whether the stack
-	grows from high memory to low (as per the 80x86) or vice versa.
-	portSTACK_GROWTH is used to make the result positive or negative as required
+	static void *prvAllocateTCB( void )
+	{
+	void *pvReturn;
+
+		prvInitialiseTaskPools();
+		pvReturn = pvMemPoolAlloc( &xTCBPool );
+
+		if( pvReturn == NULL )
+		{
+			pvReturn = pvPortMalloc( sizeof( TCB_t ) );
+		}
+
+		return pvReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void *prvAllocateStack( configSTACK_DEPTH_TYPE usStackDepth )
+	{
+	size_t xPool;
+	void *pvReturn = NULL;
+
+		prvInitialiseTaskPools();
+
+		for( xPool = 0; xPool < tskSTACK_POOL_COUNT; xPool++ )
+		{
+			if( usStackDepth <= xTaskStackPoolConfig[ xPool ].usStackDepth )
+			{
+				pvReturn = pvMemPoolAlloc( &( xStackPools[ xPool ] ) );
+				break;
+			}
+		}
+
+		if( pvReturn == NULL )
+		{
+			pvReturn = pvPortMalloc( ( ( size_t ) usStackDepth ) * sizeof( StackType_t ) );
+		}
+
+		return pvReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvReturnToTaskPool( void *pv )
+	{
+	size_t xPool;
+
+		if( xMemPoolContains( &xTCBPool, pv ) != pdFALSE )
+		{
+			vMemPoolFree( &xTCBPool, pv );
+			return pdTRUE;
+		}
+
+		for( xPool = 0; xPool < tskSTACK_POOL_COUNT; xPool++ )
+		{
+			if( xMemPoolContains( &( xStackPools[ xPool ] ), pv ) != pdFALSE )
+			{
+				vMemPoolFree( &( xStackPools[ xPool ] ), pv );
+				return pdTRUE;
+			}
+		}
+
+		return pdFALSE;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvFreeTaskMemory( void *pv )
+	{
+		if( prvReturnToTaskPool( pv ) == pdFALSE )
+		{
+			vPortFree( pv );
+		}
+	}
+
+#endif /* configUSE_TASK_POOLS */
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewTask( 	TaskFunction_t pxTaskCode,
+									const char * const pcName,		/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+									const uint32_t ulStackDepth,
+									void * const pvParameters,
+									UBaseType_t uxPriority,
+									TaskHandle_t * const pxCreatedTask,
+									TCB_t *pxNewTCB,
+									const MemoryRegion_t * const xRegions )
+{
+StackType_t *pxTopOfStack;
+UBaseType_t x;
+
+	#if( portUSING_MPU_WRAPPERS == 1 )
+		/* Should the task be created in privileged mode? */
+		BaseType_t xRunPrivileged;
+		if( ( uxPriority & portPRIVILEGE_BIT ) != 0U )
+		{
+			xRunPrivileged = pdTRUE;
+		}
+		else
+		{
+			xRunPrivileged = pdFALSE;
+		}
+		uxPriority &= ~portPRIVILEGE_BIT;
+	#endif /* portUSING_MPU_WRAPPERS == 1 */
+
+	/* Avoid dependency on memset() if it is not required. */
+	#if( tskSET_NEW_STACKS_TO_KNOWN_VALUE == 1 )
+	{
+		#if( configSTACK_FILL_WINDOW > 0 )
+		{
+		uint32_t ulFillDepth = ( ulStackDepth < ( uint32_t ) configSTACK_FILL_WINDOW ) ? ulStackDepth : ( uint32_t ) configSTACK_FILL_WINDOW;
+
+			/* Fill only the lowest words, where the overflow check looks and
+			the high water mark count starts, so that creating a task does not
+			take longer the larger its stack.  The count stops where the fill
+			does, so until the idle task paints the rest, if it does, the high
+			water mark reports no more free space than the window. */
+			( void ) portMEMSET( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) ulFillDepth * sizeof( StackType_t ) );
+
+			#if( configUSE_IDLE_STACK_PAINTER == 1 )
+			{
+				pxNewTCB->pxStackPainted = pxNewTCB->pxStack + ulFillDepth;
+				pxNewTCB->xStackPaintable = pdTRUE;
+			}
+			#endif
+		}
+		#else
+		{
+			/* Fill the stack with a known value to assist debugging. */
+			( void ) portMEMSET( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) ulStackDepth * sizeof( StackType_t ) );
+		}
+		#endif /* configSTACK_FILL_WINDOW */
+	}
+	#endif /* tskSET_NEW_STACKS_TO_KNOWN_VALUE */
+
+	/* Calculate the top of stack address.  This depends on whether the stack
+	grows from high memory to low (as per the 80x86) or vice versa.
+	portSTACK_GROWTH is used to make the result positive or negative as required
 	by the port. */
 	#if( portSTACK_GROWTH < 0 )
 	{
@@ -890,6 +1522,14 @@ UBaseType_t x;
 	#endif /* portSTACK_GROWTH */
 
 	/* Store the task name in the TCB. */
+	#if( configUSE_COMPACT_TCB == 1 )
+	{
+		/* Only the pointer, so the name is usually a string literal in
+		flash. */
+		pxNewTCB->pcTaskName = ( pcName != NULL ) ? pcName : "";
+		( void ) x;
+	}
+	#else
 	if( pcName != NULL )
 	{
 		for( x = ( UBaseType_t ) 0; x < ( UBaseType_t ) configMAX_TASK_NAME_LEN; x++ )
@@ -919,6 +1559,7 @@ UBaseType_t x;
 		terminator when it is read out. */
 		pxNewTCB->pcTaskName[ 0 ] = 0x00;
 	}
+	#endif /* configUSE_COMPACT_TCB */
 
 	/* This is used as an array index so must ensure it's not too large.  First
 	remove the privilege bit if one is present. */
@@ -965,9 +1606,17 @@ UBaseType_t x;
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 	{
 		pxNewTCB->ulRunTimeCounter = 0UL;
+		pxNewTCB->ulSwitchInCount = 0UL;
 	}
 	#endif /* configGENERATE_RUN_TIME_STATS */
 
+	#if ( configUSE_TASK_ENERGY_STATS == 1 )
+	{
+		( void ) memset( ( void * ) pxNewTCB->ulEnergyRunTime, 0x00, sizeof( pxNewTCB->ulEnergyRunTime ) );
+		pxNewTCB->ulWakeCount = 0UL;
+	}
+	#endif /* configUSE_TASK_ENERGY_STATS */
+
 	#if ( portUSING_MPU_WRAPPERS == 1 )
 	{
 		vPortStoreTaskMPUSettings( &( pxNewTCB->xMPUSettings ), xRegions, pxNewTCB->pxStack, ulStackDepth );
@@ -990,8 +1639,8 @@ UBaseType_t x;
 
 	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
 	{
-		pxNewTCB->ulNotifiedValue = 0;
-		pxNewTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		( void ) memset( ( void * ) &( pxNewTCB->ulNotifiedValue[ 0 ] ), 0x00, sizeof( pxNewTCB->ulNotifiedValue ) );
+		( void ) memset( ( void * ) &( pxNewTCB->ucNotifyState[ 0 ] ), taskNOT_WAITING_NOTIFICATION, sizeof( pxNewTCB->ucNotifyState ) );
 	}
 	#endif
 
@@ -1000,6 +1649,11 @@ UBaseType_t x;
 		/* Initialise this task's Newlib reent structure. */
 		_REENT_INIT_PTR( ( &( pxNewTCB->xNewLib_reent ) ) );
 	}
+	#elif ( configUSE_NEWLIB_REENTRANT == 2 )
+	{
+		/* Share the library's own reent until the task asks for one. */
+		pxNewTCB->pxNewLibReent = _global_impure_ptr;
+	}
 	#endif
 
 	#if( INCLUDE_xTaskAbortDelay == 1 )
@@ -1008,6 +1662,57 @@ UBaseType_t x;
 	}
 	#endif
 
+	#if( configUSE_TASK_ARENAS == 1 )
+	{
+		pxNewTCB->pxArena = NULL;
+	}
+	#endif
+
+	#if( configUSE_SWITCH_PROFILER == 1 )
+	{
+		pxNewTCB->ulReadyTime = 0UL;
+		prvSwitchProfileReset( &( pxNewTCB->xReadyLatency ) );
+	}
+	#endif
+
+	#if( configUSE_EDF_SCHEDULING == 1 )
+	{
+		pxNewTCB->xPeriod = ( TickType_t ) 0U;
+		pxNewTCB->xRelativeDeadline = ( TickType_t ) 0U;
+		pxNewTCB->xReleaseTime = ( TickType_t ) 0U;
+		pxNewTCB->xDeadline = ( TickType_t ) 0U;
+		pxNewTCB->ulDeadlineMisses = 0UL;
+	}
+	#endif
+
+	#if( configUSE_TASK_BUDGETS == 1 )
+	{
+		vListInitialiseItem( &( pxNewTCB->xBudgetListItem ) );
+		listSET_LIST_ITEM_OWNER( &( pxNewTCB->xBudgetListItem ), pxNewTCB );
+		pxNewTCB->xBudget = ( TickType_t ) 0U;
+		pxNewTCB->xBudgetPeriod = ( TickType_t ) 0U;
+		pxNewTCB->xBudgetUsed = ( TickType_t ) 0U;
+		pxNewTCB->xBudgetReplenishTime = ( TickType_t ) 0U;
+		pxNewTCB->uxBudgetSavedPriority = uxPriority;
+		pxNewTCB->uxBudgetDemoted = pdFALSE;
+		pxNewTCB->ulBudgetOverruns = 0UL;
+	}
+	#endif
+
+	#if( configUSE_PREEMPTION_THRESHOLD == 1 )
+	{
+		pxNewTCB->uxPreemptionThreshold = tskIDLE_PRIORITY;
+		pxNewTCB->uxThresholdSavedPriority = uxPriority;
+		pxNewTCB->uxThresholdRaised = pdFALSE;
+	}
+	#endif
+
+	#if( configUSE_TASK_FPU_POLICY == 1 )
+	{
+		pxNewTCB->uxFpuPolicy = ( UBaseType_t ) eTaskFpuNone;
+	}
+	#endif
+
 	/* Initialize the TCB stack to look as if the task was already running,
 	but had been interrupted by the scheduler.  The return address is set
 	to the start of the task function. Once the stack has been initialised
@@ -1132,6 +1837,15 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 		prvAddTaskToReadyList( pxNewTCB );
 
+		#if( configUSE_IDLE_STACK_PAINTER == 1 )
+		{
+			/* Its top of stack is now set, which is as far as the idle task
+			may paint. */
+			pxNewTCB->pxNextToPaint = pxTasksToPaint;
+			pxTasksToPaint = pxNewTCB;
+		}
+		#endif
+
 		portSETUP_TCB( pxNewTCB );
 	}
 	taskEXIT_CRITICAL();
@@ -1162,6 +1876,14 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 	{
 	TCB_t *pxTCB;
 
+		#if ( configHEAP_TRACK_OWNERS == 1 )
+		{
+			/* Before the handle can be reused.  The heap is locked for this,
+			so it cannot be done in the critical section. */
+			vPortHeapOwnerDeleted( prvGetTCBFromHandle( xTaskToDelete ) );
+		}
+		#endif
+
 		taskENTER_CRITICAL();
 		{
 			/* If null is passed in here then it is the calling task that is
@@ -1188,6 +1910,25 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				mtCOVERAGE_TEST_MARKER();
 			}
 
+			#if ( configUSE_TASK_BUDGETS == 1 )
+			{
+				if( listLIST_ITEM_CONTAINER( &( pxTCB->xBudgetListItem ) ) != NULL )
+				{
+					( void ) uxListRemove( &( pxTCB->xBudgetListItem ) );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif
+
+			#if( configUSE_IDLE_STACK_PAINTER == 1 )
+			{
+				prvStopPainting( pxTCB );
+			}
+			#endif
+
 			/* Increment the uxTaskNumber also so kernel aware debuggers can
 			detect that the task lists need re-generating.  This is done before
 			portPRE_TASK_DELETE_HOOK() as in the Windows port that macro will
@@ -1382,7 +2123,11 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 	eTaskState eTaskGetState( TaskHandle_t xTask )
 	{
 	eTaskState eReturn;
-	List_t const * pxStateList, *pxDelayedList, *pxOverflowedDelayedList;
+	#if( configUSE_DELAY_WHEEL == 0 )
+		List_t const * pxStateList, *pxDelayedList, *pxOverflowedDelayedList;
+	#else
+		List_t const * pxStateList;
+	#endif
 	const TCB_t * const pxTCB = xTask;
 
 		configASSERT( pxTCB );
@@ -1397,12 +2142,20 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 			taskENTER_CRITICAL();
 			{
 				pxStateList = listLIST_ITEM_CONTAINER( &( pxTCB->xStateListItem ) );
-				pxDelayedList = pxDelayedTaskList;
-				pxOverflowedDelayedList = pxOverflowDelayedTaskList;
+				#if( configUSE_DELAY_WHEEL == 0 )
+				{
+					pxDelayedList = pxDelayedTaskList;
+					pxOverflowedDelayedList = pxOverflowDelayedTaskList;
+				}
+				#endif
 			}
 			taskEXIT_CRITICAL();
 
-			if( ( pxStateList == pxDelayedList ) || ( pxStateList == pxOverflowedDelayedList ) )
+			#if( configUSE_DELAY_WHEEL == 0 )
+				if( ( pxStateList == pxDelayedList ) || ( pxStateList == pxOverflowedDelayedList ) )
+			#else
+				if( taskIS_DELAYED_LIST( pxStateList ) )
+			#endif
 			{
 				/* The task being queried is referenced from one of the Blocked
 				lists. */
@@ -1419,17 +2172,20 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 					{
 						#if( configUSE_TASK_NOTIFICATIONS == 1 )
 						{
+						BaseType_t x;
+
 							/* The task does not appear on the event list item of
 							and of the RTOS objects, but could still be in the
-							blocked state if it is waiting on its notification
-							rather than waiting on an object. */
-							if( pxTCB->ucNotifyState == taskWAITING_NOTIFICATION )
-							{
-								eReturn = eBlocked;
-							}
-							else
+							blocked state if it is waiting on one of its
+							notifications rather than waiting on an object. */
+							eReturn = eSuspended;
+							for( x = 0; x < configTASK_NOTIFICATION_ARRAY_ENTRIES; x++ )
 							{
-								eReturn = eSuspended;
+								if( pxTCB->ucNotifyState[ x ] == taskWAITING_NOTIFICATION )
+								{
+									eReturn = eBlocked;
+									break;
+								}
 							}
 						}
 						#else
@@ -1734,11 +2490,16 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 			#if( configUSE_TASK_NOTIFICATIONS == 1 )
 			{
-				if( pxTCB->ucNotifyState == taskWAITING_NOTIFICATION )
+			BaseType_t x;
+
+				for( x = 0; x < configTASK_NOTIFICATION_ARRAY_ENTRIES; x++ )
 				{
-					/* The task was blocked to wait for a notification, but is
-					now suspended, so no notification was received. */
-					pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+					if( pxTCB->ucNotifyState[ x ] == taskWAITING_NOTIFICATION )
+					{
+						/* The task was blocked to wait for a notification, but
+						is now suspended, so no notification was received. */
+						pxTCB->ucNotifyState[ x ] = taskNOT_WAITING_NOTIFICATION;
+					}
 				}
 			}
 			#endif
@@ -2048,6 +2809,10 @@ BaseType_t xReturn;
 			structure specific to the task that will run first. */
 			_impure_ptr = &( pxCurrentTCB->xNewLib_reent );
 		}
+		#elif ( configUSE_NEWLIB_REENTRANT == 2 )
+		{
+			_impure_ptr = pxCurrentTCB->pxNewLibReent;
+		}
 		#endif /* configUSE_NEWLIB_REENTRANT */
 
 		xNextTaskUnblockTime = portMAX_DELAY;
@@ -2064,6 +2829,18 @@ BaseType_t xReturn;
 
 		traceTASK_SWITCHED_IN();
 
+		#if( configUSE_IDLE_STACK_PAINTER == 1 )
+		{
+			pxCurrentTCB->xStackPaintable = pdFALSE;
+		}
+		#endif
+
+		#if( configUSE_MPU_STACK_GUARD == 1 )
+		{
+			portSET_STACK_GUARD( pxCurrentTCB->pxStack );
+		}
+		#endif
+
 		/* Setting up the timer tick is hardware specific and thus in the
 		portable interface. */
 		if( xPortStartScheduler() != pdFALSE )
@@ -2109,6 +2886,18 @@ void vTaskSuspendAll( void )
 	http://goo.gl/wu4acr */
 	++uxSchedulerSuspended;
 	portMEMORY_BARRIER();
+
+	#if( configUSE_SECTION_PROFILER == 1 )
+	{
+		/* Stamped after the increment, as no other task can run from then on
+		to overwrite the stamp. */
+		if( uxSchedulerSuspended == ( UBaseType_t ) 1U )
+		{
+			ulSuspendedTime = portMASK_PROFILE_TIME();
+			ulSuspendedAt = portMASK_PROFILE_CALLER();
+		}
+	}
+	#endif
 }
 /*----------------------------------------------------------*/
 
@@ -2130,6 +2919,18 @@ void vTaskSuspendAll( void )
 				uxHigherPriorityReadyTasks = pdTRUE;
 			}
 		}
+		#elif defined( portREADY_PRIORITIES_TYPE )
+		{
+		UBaseType_t uxTopPriority;
+
+			/* The ready priorities are in a port defined structure, so ask
+			the port for the highest one.  The idle task is always ready. */
+			portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );
+			if( uxTopPriority > tskIDLE_PRIORITY )
+			{
+				uxHigherPriorityReadyTasks = pdTRUE;
+			}
+		}
 		#else
 		{
 			const UBaseType_t uxLeastSignificantBit = ( UBaseType_t ) 0x01;
@@ -2166,6 +2967,23 @@ void vTaskSuspendAll( void )
 		}
 		else
 		{
+			#if( configUSE_DELAY_WHEEL == 1 )
+			{
+				/* Only safe to walk the wheel when no task can be unblocked
+				underneath.  The preliminary test in the idle task therefore
+				sees the lower bound, which can only make it skip a sleep that
+				is near anyway. */
+				if( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
+				{
+					prvDelayWheelTighten();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif
+
 			xReturn = xNextTaskUnblockTime - xTickCount;
 		}
 
@@ -2195,6 +3013,14 @@ BaseType_t xAlreadyYielded = pdFALSE;
 
 		if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
 		{
+			#if( configUSE_SECTION_PROFILER == 1 )
+			{
+				/* The pended ready tasks and ticks are caught up below with
+				the scheduler running again, so are not counted. */
+				vTaskSectionProfileRecord( eSectionSchedulerSuspended, ulSuspendedAt, portMASK_PROFILE_TIME() - ulSuspendedTime );
+			}
+			#endif
+
 			if( uxCurrentNumberOfTasks > ( UBaseType_t ) 0U )
 			{
 				/* Move any readied tasks from the pending list into the
@@ -2331,6 +3157,19 @@ UBaseType_t uxSavedInterruptStatus;
 }
 /*-----------------------------------------------------------*/
 
+#ifdef portGET_TIME_US
+
+	uint32_t ulTaskGetTickCountUs( void )
+	{
+		/* The counter is a single word that free runs from before the
+		scheduler starts, so it can be read from anywhere without a critical
+		section. */
+		return ( uint32_t ) portGET_TIME_US();
+	}
+
+#endif /* portGET_TIME_US */
+/*-----------------------------------------------------------*/
+
 UBaseType_t uxTaskGetNumberOfTasks( void )
 {
 	/* A critical section is not required because the variables are of type
@@ -2347,7 +3186,7 @@ TCB_t *pxTCB;
 	queried. */
 	pxTCB = prvGetTCBFromHandle( xTaskToQuery );
 	configASSERT( pxTCB );
-	return &( pxTCB->pcTaskName[ 0 ] );
+	return ( char * ) &( pxTCB->pcTaskName[ 0 ] );
 }
 /*-----------------------------------------------------------*/
 
@@ -2446,10 +3285,21 @@ TCB_t *pxTCB;
 			} while( uxQueue > ( UBaseType_t ) tskIDLE_PRIORITY ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
 
 			/* Search the delayed lists. */
-			if( pxTCB == NULL )
+			#if( configUSE_DELAY_WHEEL == 0 )
+			{
+				if( pxTCB == NULL )
+				{
+					pxTCB = prvSearchForNameWithinSingleList( ( List_t * ) pxDelayedTaskList, pcNameToQuery );
+				}
+			}
+			#else
 			{
-				pxTCB = prvSearchForNameWithinSingleList( ( List_t * ) pxDelayedTaskList, pcNameToQuery );
+				for( uxQueue = ( UBaseType_t ) 0U; ( pxTCB == NULL ) && ( uxQueue < taskDELAY_WHEEL_SLOTS ); uxQueue++ )
+				{
+					pxTCB = prvSearchForNameWithinSingleList( &( xDelayWheel[ uxQueue ] ), pcNameToQuery );
+				}
 			}
+			#endif
 
 			if( pxTCB == NULL )
 			{
@@ -2506,7 +3356,18 @@ TCB_t *pxTCB;
 
 				/* Fill in an TaskStatus_t structure with information on each
 				task in the Blocked state. */
-				uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxDelayedTaskList, eBlocked );
+				#if( configUSE_DELAY_WHEEL == 0 )
+				{
+					uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxDelayedTaskList, eBlocked );
+				}
+				#else
+				{
+					for( uxQueue = ( UBaseType_t ) 0U; uxQueue < taskDELAY_WHEEL_SLOTS; uxQueue++ )
+					{
+						uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( xDelayWheel[ uxQueue ] ), eBlocked );
+					}
+				}
+				#endif
 				uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxOverflowDelayedTaskList, eBlocked );
 
 				#if( INCLUDE_vTaskDelete == 1 )
@@ -2666,10 +3527,12 @@ implementations require configUSE_TICKLESS_IDLE to be set to a value other than
 #endif /* INCLUDE_xTaskAbortDelay */
 /*----------------------------------------------------------*/
 
-BaseType_t xTaskIncrementTick( void )
+portKERNEL_HOT_PATH BaseType_t xTaskIncrementTick( void )
 {
-TCB_t * pxTCB;
-TickType_t xItemValue;
+#if( configUSE_DELAY_WHEEL == 0 )
+	TCB_t * pxTCB;
+	TickType_t xItemValue;
+#endif
 BaseType_t xSwitchRequired = pdFALSE;
 
 	/* Called by the portable layer each time a tick interrupt occurs.
@@ -2699,6 +3562,27 @@ BaseType_t xSwitchRequired = pdFALSE;
 		the	queue in the order of their wake time - meaning once one task
 		has been found whose block time has not expired there is no need to
 		look any further down the list. */
+		#if( configUSE_DELAY_WHEEL == 1 )
+		{
+			/* The wheel is only looked at when a task may be due, as above,
+			but xNextTaskUnblockTime is then a lower bound rather than exact. */
+			if( xConstTickCount >= xNextTaskUnblockTime )
+			{
+				if( prvDelayWheelAdvance( xConstTickCount ) != pdFALSE )
+				{
+					xSwitchRequired = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#else
 		if( xConstTickCount >= xNextTaskUnblockTime )
 		{
 			for( ;; )
@@ -2776,13 +3660,11 @@ BaseType_t xSwitchRequired = pdFALSE;
 				}
 			}
 		}
+		#endif /* configUSE_DELAY_WHEEL */
 
-		/* Tasks of equal priority to the currently running task will share
-		processing time (time slice) if preemption is on, and the application
-		writer has not explicitly turned time slicing off. */
-		#if ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) )
+		#if ( configUSE_TASK_BUDGETS == 1 )
 		{
-			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ) ) > ( UBaseType_t ) 1 )
+			if( prvBudgetTick( xConstTickCount ) != pdFALSE )
 			{
 				xSwitchRequired = pdTRUE;
 			}
@@ -2791,16 +3673,57 @@ BaseType_t xSwitchRequired = pdFALSE;
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
-		#endif /* ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) ) */
+		#endif /* configUSE_TASK_BUDGETS */
 
-		#if ( configUSE_TICK_HOOK == 1 )
+		/* Tasks of equal priority to the currently running task will share
+		processing time (time slice) if preemption is on, and the application
+		writer has not explicitly turned time slicing off. */
+		#if ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) )
 		{
-			/* Guard against the tick hook being called when the pended tick
-			count is being unwound (when the scheduler is being unlocked). */
-			if( uxPendedTicks == ( UBaseType_t ) 0U )
+			/* Deadline ordered tasks do not time slice. */
+			#if ( configUSE_EDF_SCHEDULING == 1 )
+				if( ( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ) ) > ( UBaseType_t ) 1 ) && ( pxCurrentTCB->uxPriority != ( UBaseType_t ) configEDF_PRIORITY ) )
+			#else
+				if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ) ) > ( UBaseType_t ) 1 )
+			#endif
 			{
-				vApplicationTickHook();
-			}
+				#if ( configUSE_TIME_SLICE_QUANTA == 1 )
+				{
+					/* Only ticks on which another task was waiting for a turn
+					count, so a task that ran alone does not lose the CPU the
+					moment an equal comes ready. */
+					xSliceTicksUsed++;
+
+					if( xSliceTicksUsed >= xTimeSliceQuanta[ pxCurrentTCB->uxPriority ] )
+					{
+						xSwitchRequired = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#else
+				{
+					xSwitchRequired = pdTRUE;
+				}
+				#endif /* configUSE_TIME_SLICE_QUANTA */
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) ) */
+
+		#if ( configUSE_TICK_HOOK == 1 )
+		{
+			/* Guard against the tick hook being called when the pended tick
+			count is being unwound (when the scheduler is being unlocked). */
+			if( uxPendedTicks == ( UBaseType_t ) 0U )
+			{
+				vApplicationTickHook();
+			}
 			else
 			{
 				mtCOVERAGE_TEST_MARKER();
@@ -2948,8 +3871,35 @@ BaseType_t xSwitchRequired = pdFALSE;
 #endif /* configUSE_APPLICATION_TASK_TAG */
 /*-----------------------------------------------------------*/
 
-void vTaskSwitchContext( void )
+portKERNEL_HOT_PATH void vTaskSwitchContext( void )
 {
+#if ( ( configGENERATE_RUN_TIME_STATS == 1 ) || ( configUSE_SWITCH_PROFILER == 1 ) || ( configUSE_TIME_SLICE_QUANTA == 1 ) )
+	TCB_t * const pxPreviousTCB = pxCurrentTCB;
+#endif
+
+	#if ( configUSE_SWITCH_PROFILER == 1 )
+	{
+		/* Runs even with the scheduler suspended, so every pass through the
+		handler is paired with the next. */
+		prvSwitchProfileHandlerTime();
+	}
+	#endif
+
+	#if ( configUSE_TASK_FPU_POLICY == 1 )
+	{
+		/* The outgoing task's context has just been saved, and with it
+		whether the task had an FPU frame. */
+		if( ( pxCurrentTCB->uxFpuPolicy == ( UBaseType_t ) eTaskFpuNone ) && ( portTASK_USED_FPU( pxCurrentTCB->pxTopOfStack ) != pdFALSE ) )
+		{
+			vApplicationFpuMisuseHook( ( TaskHandle_t ) pxCurrentTCB, ( char * ) pxCurrentTCB->pcTaskName );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
 	if( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
 	{
 		/* The scheduler is currently suspended - do not allow a context
@@ -2961,6 +3911,21 @@ void vTaskSwitchContext( void )
 		xYieldPending = pdFALSE;
 		traceTASK_SWITCHED_OUT();
 
+		#if ( configUSE_SWITCH_PROFILER == 1 )
+		{
+			/* A preempted task is still in its ready list, and its wait to run
+			again starts now. */
+			if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ), &( pxCurrentTCB->xStateListItem ) ) != pdFALSE )
+			{
+				pxCurrentTCB->ulReadyTime = portSWITCH_PROFILE_TIME() | 1UL;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_SWITCH_PROFILER */
+
 		#if ( configGENERATE_RUN_TIME_STATS == 1 )
 		{
 			#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
@@ -2988,6 +3953,15 @@ void vTaskSwitchContext( void )
 		}
 		#endif /* configGENERATE_RUN_TIME_STATS */
 
+		#if ( configUSE_TASK_ENERGY_STATS == 1 )
+		{
+			/* Unsigned subtraction, so a counter that wrapped since is still
+			charged correctly. */
+			pxCurrentTCB->ulEnergyRunTime[ uxEnergyProfile ] += ( ulTotalRunTime - ulEnergyChargedTime );
+			ulEnergyChargedTime = ulTotalRunTime;
+		}
+		#endif /* configUSE_TASK_ENERGY_STATS */
+
 		/* Check for stack overflow, if configured. */
 		taskCHECK_FOR_STACK_OVERFLOW();
 
@@ -2999,10 +3973,107 @@ void vTaskSwitchContext( void )
 		#endif
 
 		/* Select a new task to run using either the generic C or port
-		optimised asm code. */
-		taskSELECT_HIGHEST_PRIORITY_TASK(); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+		optimised asm code, unless the running task's preemption threshold
+		keeps it running. */
+		#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+			if( prvThresholdSwitchOut() == pdFALSE )
+		#endif
+		{
+			taskSELECT_HIGHEST_PRIORITY_TASK(); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+		}
 		traceTASK_SWITCHED_IN();
 
+		#if( configUSE_IDLE_STACK_PAINTER == 1 )
+		{
+			/* Once the task has run it may have left deeper use below the top
+			of stack it is switched out with, which painting would hide. */
+			pxCurrentTCB->xStackPaintable = pdFALSE;
+		}
+		#endif
+
+		#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+		{
+			if( pxCurrentTCB->uxPreemptionThreshold > pxCurrentTCB->uxPriority )
+			{
+				prvThresholdRaise( pxCurrentTCB );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_PREEMPTION_THRESHOLD */
+
+		/* Move the guard under the stack of the task switched in.  PendSV has
+		already pushed the old task's context, and the new one is popped from
+		well above the guard. */
+		#if( configUSE_MPU_STACK_GUARD == 1 )
+		{
+			portSET_STACK_GUARD( pxCurrentTCB->pxStack );
+		}
+		#endif
+
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
+		{
+			/* Only count a real change of task, not a yield that selected the
+			same task again. */
+			if( pxCurrentTCB != pxPreviousTCB )
+			{
+				( pxCurrentTCB->ulSwitchInCount )++;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configGENERATE_RUN_TIME_STATS */
+
+		#if ( configUSE_TIME_SLICE_QUANTA == 1 )
+		{
+			/* A new task starts a fresh slice, whatever ended the last one.
+			Reselecting the same task continues its slice. */
+			if( pxCurrentTCB != pxPreviousTCB )
+			{
+				xSliceTicksUsed = ( TickType_t ) 0U;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_TIME_SLICE_QUANTA */
+
+		#if ( configUSE_TASK_ENERGY_STATS == 1 )
+		{
+			if( ( xWakeUnclaimed != pdFALSE ) && ( pxCurrentTCB != xIdleTaskHandle ) )
+			{
+				( pxCurrentTCB->ulWakeCount )++;
+				xWakeUnclaimed = pdFALSE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_TASK_ENERGY_STATS */
+
+		#if ( configUSE_SWITCH_PROFILER == 1 )
+		{
+			/* Reselecting the task that yielded is not a wait, so it is not
+			sampled. */
+			if( ( pxCurrentTCB != pxPreviousTCB ) && ( pxCurrentTCB->ulReadyTime != 0UL ) )
+			{
+				prvSwitchProfileRecord( &( pxCurrentTCB->xReadyLatency ), portSWITCH_PROFILE_TIME() - pxCurrentTCB->ulReadyTime );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxCurrentTCB->ulReadyTime = 0UL;
+		}
+		#endif /* configUSE_SWITCH_PROFILER */
+
 		/* After the new task is switched in, update the global errno. */
 		#if( configUSE_POSIX_ERRNO == 1 )
 		{
@@ -3016,6 +4087,13 @@ void vTaskSwitchContext( void )
 			structure specific to this task. */
 			_impure_ptr = &( pxCurrentTCB->xNewLib_reent );
 		}
+		#elif ( configUSE_NEWLIB_REENTRANT == 2 )
+		{
+			/* Tasks without a reent of their own all point at the shared
+			one, so between two of them this stores the value already
+			there. */
+			_impure_ptr = pxCurrentTCB->pxNewLibReent;
+		}
 		#endif /* configUSE_NEWLIB_REENTRANT */
 	}
 }
@@ -3354,6 +4432,36 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 		is responsible for freeing the deleted task's TCB and stack. */
 		prvCheckTasksWaitingTermination();
 
+		#if ( configHEAP_LAZY_COALESCE == 1 )
+		{
+			/* Merge a few of the blocks freed since the last time round. */
+			( void ) xPortHeapCoalesceStep();
+		}
+		#endif /* configHEAP_LAZY_COALESCE */
+
+		#if ( configUSE_HEAP_HANDLES == 1 )
+		{
+			/* Slide one movable block down over the free space below it. */
+			( void ) xPortHeapCompactStep();
+		}
+		#endif /* configUSE_HEAP_HANDLES */
+
+		#if ( configHEAP_GUARD == 1 )
+		{
+			/* Check the next few heap blocks, so that the whole heap is
+			checked a piece at a time while there is nothing else to do. */
+			( void ) xPortHeapGuardStep();
+		}
+		#endif /* configHEAP_GUARD */
+
+		#if ( configUSE_IDLE_STACK_PAINTER == 1 )
+		{
+			/* Fill a little more of the stacks that task creation left
+			unfilled. */
+			prvPaintStacks();
+		}
+		#endif /* configUSE_IDLE_STACK_PAINTER */
+
 		#if ( configUSE_PREEMPTION == 0 )
 		{
 			/* If we are not using preemption we keep forcing a task switch to
@@ -3431,6 +4539,17 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 
 					if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
 					{
+						#if( configUSE_TASK_ENERGY_STATS == 1 )
+						{
+							/* Nothing ran for the last wake. */
+							if( xWakeUnclaimed != pdFALSE )
+							{
+								( xIdleTaskHandle->ulWakeCount )++;
+								xWakeUnclaimed = pdFALSE;
+							}
+						}
+						#endif
+
 						traceLOW_POWER_IDLE_BEGIN();
 						portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
 						traceLOW_POWER_IDLE_END();
@@ -3531,119 +4650,1335 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 #endif /* configNUM_THREAD_LOCAL_STORAGE_POINTERS */
 /*-----------------------------------------------------------*/
 
-#if ( portUSING_MPU_WRAPPERS == 1 )
+#if ( configUSE_TASK_ARENAS == 1 )
 
-	void vTaskAllocateMPURegions( TaskHandle_t xTaskToModify, const MemoryRegion_t * const xRegions )
+	BaseType_t xTaskArenaCreate( TaskHandle_t xTask, size_t xArenaSize )
 	{
 	TCB_t *pxTCB;
+	TaskArena_t *pxArena;
+	BaseType_t xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
 
-		/* If null is passed in here then we are modifying the MPU settings of
-		the calling task. */
-		pxTCB = prvGetTCBFromHandle( xTaskToModify );
+		pxTCB = prvGetTCBFromHandle( xTask );
 
-		vPortStoreTaskMPUSettings( &( pxTCB->xMPUSettings ), xRegions, NULL, 0 );
+		/* A task owns at most one arena. */
+		configASSERT( pxTCB->pxArena == NULL );
+
+		xArenaSize = ( xArenaSize + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+		pxArena = ( TaskArena_t * ) pvPortMalloc( tskARENA_HEADER_SIZE + xArenaSize ); /*lint !e9087 All values returned by pvPortMalloc() have at least the alignment required by the MCU's stack and this allocation is the arena header. */
+
+		if( pxArena != NULL )
+		{
+			pxArena->pucNext = ( ( uint8_t * ) pxArena ) + tskARENA_HEADER_SIZE;
+			pxArena->pucEnd = pxArena->pucNext + xArenaSize;
+			pxTCB->pxArena = pxArena;
+			xReturn = pdPASS;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
 	}
 
-#endif /* portUSING_MPU_WRAPPERS */
+#endif /* configUSE_TASK_ARENAS */
 /*-----------------------------------------------------------*/
 
-static void prvInitialiseTaskLists( void )
-{
-UBaseType_t uxPriority;
+#if ( configUSE_TASK_ARENAS == 1 )
 
-	for( uxPriority = ( UBaseType_t ) 0U; uxPriority < ( UBaseType_t ) configMAX_PRIORITIES; uxPriority++ )
+	void *pvTaskArenaAlloc( size_t xWantedSize )
 	{
-		vListInitialise( &( pxReadyTasksLists[ uxPriority ] ) );
-	}
+	TaskArena_t * const pxArena = pxCurrentTCB->pxArena;
+	void *pvReturn = NULL;
 
-	vListInitialise( &xDelayedTaskList1 );
-	vListInitialise( &xDelayedTaskList2 );
-	vListInitialise( &xPendingReadyList );
+		/* Only the owning task moves pucNext, so no critical section is
+		needed. */
+		if( ( pxArena != NULL ) && ( xWantedSize > ( size_t ) 0 ) )
+		{
+			xWantedSize = ( xWantedSize + ( size_t ) portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
 
-	#if ( INCLUDE_vTaskDelete == 1 )
-	{
-		vListInitialise( &xTasksWaitingTermination );
+			/* Written as a subtraction so a huge request cannot wrap. */
+			if( xWantedSize <= ( size_t ) ( pxArena->pucEnd - pxArena->pucNext ) )
+			{
+				pvReturn = pxArena->pucNext;
+				pxArena->pucNext += xWantedSize;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pvReturn;
 	}
-	#endif /* INCLUDE_vTaskDelete */
 
-	#if ( INCLUDE_vTaskSuspend == 1 )
+#endif /* configUSE_TASK_ARENAS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_ARENAS == 1 )
+
+	void vTaskArenaReset( void )
 	{
-		vListInitialise( &xSuspendedTaskList );
+	TaskArena_t * const pxArena = pxCurrentTCB->pxArena;
+
+		if( pxArena != NULL )
+		{
+			pxArena->pucNext = ( ( uint8_t * ) pxArena ) + tskARENA_HEADER_SIZE;
+		}
 	}
-	#endif /* INCLUDE_vTaskSuspend */
 
-	/* Start with pxDelayedTaskList using list1 and the pxOverflowDelayedTaskList
-	using list2. */
-	pxDelayedTaskList = &xDelayedTaskList1;
-	pxOverflowDelayedTaskList = &xDelayedTaskList2;
-}
+#endif /* configUSE_TASK_ARENAS */
 /*-----------------------------------------------------------*/
 
-static void prvCheckTasksWaitingTermination( void )
-{
-
-	/** THIS FUNCTION IS CALLED FROM THE RTOS IDLE TASK **/
+#if ( configUSE_NEWLIB_REENTRANT == 2 )
 
-	#if ( INCLUDE_vTaskDelete == 1 )
+	BaseType_t xTaskNewlibReentCreate( void )
 	{
-		TCB_t *pxTCB;
+	struct _reent *pxReent;
 
-		/* uxDeletedTasksWaitingCleanUp is used to prevent taskENTER_CRITICAL()
-		being called too often in the idle task. */
-		while( uxDeletedTasksWaitingCleanUp > ( UBaseType_t ) 0U )
+		if( pxCurrentTCB->pxNewLibReent != _global_impure_ptr )
 		{
-			taskENTER_CRITICAL();
-			{
-				pxTCB = listGET_OWNER_OF_HEAD_ENTRY( ( &xTasksWaitingTermination ) ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
-				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
-				--uxCurrentNumberOfTasks;
-				--uxDeletedTasksWaitingCleanUp;
-			}
-			taskEXIT_CRITICAL();
+			return pdPASS;
+		}
+
+		pxReent = ( struct _reent * ) pvPortMalloc( sizeof( struct _reent ) ); /*lint !e9087 All values returned by pvPortMalloc() have at least the alignment required by the MCU's stack. */
+
+		if( pxReent == NULL )
+		{
+			return errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+		}
+
+		_REENT_INIT_PTR( pxReent );
 
-			prvDeleteTCB( pxTCB );
+		/* The switch reads the TCB, so both must change together. */
+		taskENTER_CRITICAL();
+		{
+			pxCurrentTCB->pxNewLibReent = pxReent;
+			_impure_ptr = pxReent;
 		}
+		taskEXIT_CRITICAL();
+
+		return pdPASS;
 	}
-	#endif /* INCLUDE_vTaskDelete */
-}
+
+#endif /* configUSE_NEWLIB_REENTRANT */
 /*-----------------------------------------------------------*/
 
-#if( configUSE_TRACE_FACILITY == 1 )
+#if ( configUSE_NEWLIB_REENTRANT == 2 )
 
-	void vTaskGetInfo( TaskHandle_t xTask, TaskStatus_t *pxTaskStatus, BaseType_t xGetFreeStackSpace, eTaskState eState )
+	BaseType_t xTaskHasNewlibReent( TaskHandle_t xTask )
 	{
 	TCB_t *pxTCB;
 
-		/* xTask is NULL then get the state of the calling task. */
 		pxTCB = prvGetTCBFromHandle( xTask );
 
-		pxTaskStatus->xHandle = ( TaskHandle_t ) pxTCB;
-		pxTaskStatus->pcTaskName = ( const char * ) &( pxTCB->pcTaskName [ 0 ] );
-		pxTaskStatus->uxCurrentPriority = pxTCB->uxPriority;
-		pxTaskStatus->pxStackBase = pxTCB->pxStack;
-		pxTaskStatus->xTaskNumber = pxTCB->uxTCBNumber;
+		return ( pxTCB->pxNewLibReent != _global_impure_ptr ) ? pdTRUE : pdFALSE;
+	}
 
-		#if ( configUSE_MUTEXES == 1 )
-		{
-			pxTaskStatus->uxBasePriority = pxTCB->uxBasePriority;
-		}
-		#else
-		{
-			pxTaskStatus->uxBasePriority = 0;
-		}
-		#endif
+#endif /* configUSE_NEWLIB_REENTRANT */
+/*-----------------------------------------------------------*/
 
-		#if ( configGENERATE_RUN_TIME_STATS == 1 )
-		{
-			pxTaskStatus->ulRunTimeCounter = pxTCB->ulRunTimeCounter;
-		}
-		#else
+#if ( configUSE_TASK_ARENAS == 1 )
+
+	size_t xTaskArenaGetFreeSize( TaskHandle_t xTask )
+	{
+	TCB_t *pxTCB;
+	size_t xReturn = 0;
+
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		if( pxTCB->pxArena != NULL )
 		{
-			pxTaskStatus->ulRunTimeCounter = 0;
+			xReturn = ( size_t ) ( pxTCB->pxArena->pucEnd - pxTCB->pxArena->pucNext );
 		}
-		#endif
 
-		/* Obtaining the task state is a little fiddly, so is only done if the
+		return xReturn;
+	}
+
+#endif /* configUSE_TASK_ARENAS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SWITCH_PROFILER == 1 )
+
+	void vTaskGetReadyLatency( TaskHandle_t xTask, SwitchProfile_t *pxProfile )
+	{
+	TCB_t *pxTCB;
+
+		configASSERT( pxProfile );
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			*pxProfile = pxTCB->xReadyLatency;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_SWITCH_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SWITCH_PROFILER == 1 )
+
+	void vTaskGetSwitchTime( SwitchProfile_t *pxIntegerOnly, SwitchProfile_t *pxWithFPU )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( pxIntegerOnly != NULL )
+			{
+				*pxIntegerOnly = xSwitchTimes[ 0 ];
+			}
+
+			if( pxWithFPU != NULL )
+			{
+				*pxWithFPU = xSwitchTimes[ 1 ];
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_SWITCH_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_ENERGY_STATS == 1 )
+
+	void vTaskSetEnergyProfile( UBaseType_t uxProfile )
+	{
+	uint32_t ulNow;
+
+		configASSERT( uxProfile < ( UBaseType_t ) configENERGY_PROFILES );
+
+		/* Before the scheduler starts nothing has run to be charged, and a
+		critical section would leave interrupts masked until it does. */
+		if( xSchedulerRunning == pdFALSE )
+		{
+			uxEnergyProfile = uxProfile;
+			return;
+		}
+
+		taskENTER_CRITICAL();
+		{
+			#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+				portALT_GET_RUN_TIME_COUNTER_VALUE( ulNow );
+			#else
+				ulNow = portGET_RUN_TIME_COUNTER_VALUE();
+			#endif
+
+			pxCurrentTCB->ulEnergyRunTime[ uxEnergyProfile ] += ( ulNow - ulEnergyChargedTime );
+			ulEnergyChargedTime = ulNow;
+			uxEnergyProfile = uxProfile;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_TASK_ENERGY_STATS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_ENERGY_STATS == 1 )
+
+	void vTaskAttributeWake( void )
+	{
+		xWakeUnclaimed = pdTRUE;
+	}
+
+#endif /* configUSE_TASK_ENERGY_STATS */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_SWITCH_PROFILER == 1 ) && defined( portSWITCH_PROFILE_REGION_TIME ) )
+
+	uint32_t ulTaskGetRegionSwitchTime( SwitchProfile_t *pxProfile )
+	{
+	uint32_t ulOverruns;
+
+		taskENTER_CRITICAL();
+		{
+			*pxProfile = xRegionSwitchTimes;
+			ulOverruns = ulRegionSwitchOverruns;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulOverruns;
+	}
+
+#endif /* configUSE_SWITCH_PROFILER && portSWITCH_PROFILE_REGION_TIME */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SWITCH_PROFILER == 1 )
+
+	static void prvSwitchProfileRecord( SwitchProfile_t *pxProfile, uint32_t ulTime )
+	{
+	UBaseType_t uxBucket = 0;
+	uint32_t ulLimit = 1UL << configSWITCH_PROFILE_FIRST_BUCKET_SHIFT;
+
+		/* ulLimit becoming zero on overflow just sends the sample to the last
+		bucket. */
+		while( ( ulTime >= ulLimit ) && ( uxBucket < ( UBaseType_t ) ( configSWITCH_PROFILE_BUCKETS - 1 ) ) )
+		{
+			ulLimit <<= 1;
+			uxBucket++;
+		}
+
+		( pxProfile->ulBuckets[ uxBucket ] )++;
+		( pxProfile->ulCount )++;
+
+		if( ulTime < pxProfile->ulMin )
+		{
+			pxProfile->ulMin = ulTime;
+		}
+
+		if( ulTime > pxProfile->ulMax )
+		{
+			pxProfile->ulMax = ulTime;
+		}
+	}
+
+#endif /* configUSE_SWITCH_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SWITCH_PROFILER == 1 )
+
+	static void prvSwitchProfileReset( SwitchProfile_t *pxProfile )
+	{
+		( void ) memset( ( void * ) pxProfile, 0x00, sizeof( SwitchProfile_t ) );
+		pxProfile->ulMin = 0xffffffffUL;
+	}
+
+#endif /* configUSE_SWITCH_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SWITCH_PROFILER == 1 )
+
+	static void prvSwitchProfileHandlerTime( void )
+	{
+		/* The exit stamp still belongs to the previous pass through the
+		handler, whose entry was kept last time. */
+		if( xPreviousSwitchValid != pdFALSE )
+		{
+			prvSwitchProfileRecord( &( xSwitchTimes[ ( xPreviousSwitchSavedFPU != pdFALSE ) ? 1 : 0 ] ), portSWITCH_PROFILE_EXIT_TIME() - ulPreviousSwitchEntry );
+		}
+		else
+		{
+			prvSwitchProfileReset( &( xSwitchTimes[ 0 ] ) );
+			prvSwitchProfileReset( &( xSwitchTimes[ 1 ] ) );
+
+			#ifdef portSWITCH_PROFILE_REGION_TIME
+			{
+				prvSwitchProfileReset( &xRegionSwitchTimes );
+			}
+			#endif
+		}
+
+		#ifdef portSWITCH_PROFILE_REGION_TIME
+		{
+			/* Like the exit stamp, the reload time belongs to the previous pass,
+			and is left at zero by a pass that kept the running task. */
+			if( portSWITCH_PROFILE_REGION_TIME() != 0UL )
+			{
+				prvSwitchProfileRecord( &xRegionSwitchTimes, portSWITCH_PROFILE_REGION_TIME() );
+
+				if( portSWITCH_PROFILE_REGION_TIME() > ( uint32_t ) configMPU_REGION_SWITCH_BUDGET )
+				{
+					ulRegionSwitchOverruns++;
+				}
+
+				portSWITCH_PROFILE_REGION_CLEAR();
+			}
+		}
+		#endif
+
+		ulPreviousSwitchEntry = portSWITCH_PROFILE_ENTRY_TIME();
+		xPreviousSwitchSavedFPU = ( portSWITCH_PROFILE_SAVED_FPU() ) ? pdTRUE : pdFALSE;
+		xPreviousSwitchValid = pdTRUE;
+	}
+
+#endif /* configUSE_SWITCH_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SECTION_PROFILER == 1 )
+
+	void vTaskSectionProfileRecord( eSectionType eType, uint32_t ulSite, uint32_t ulTime )
+	{
+	SectionSite_t *pxTable = xSectionSites[ eType ];
+	SectionSite_t *pxSite = NULL;
+	SectionSite_t *pxShortest = NULL;
+	UBaseType_t ux;
+
+		/* Called with BASEPRI raised, for every section, so the table is
+		small and searched in place. */
+		for( ux = 0; ux < ( UBaseType_t ) configSECTION_PROFILE_SITES; ux++ )
+		{
+			if( ( pxTable[ ux ].ulCount != 0UL ) && ( pxTable[ ux ].ulSite == ulSite ) )
+			{
+				pxSite = &( pxTable[ ux ] );
+				break;
+			}
+
+			if( ( pxShortest == NULL ) || ( pxTable[ ux ].ulMaxTime < pxShortest->ulMaxTime ) )
+			{
+				pxShortest = &( pxTable[ ux ] );
+			}
+		}
+
+		if( pxSite == NULL )
+		{
+			/* An empty entry has a count and a longest time of zero, so is
+			always the shortest.  A full table only gives up the site whose
+			longest section is shorter than this one. */
+			if( ( pxShortest->ulCount != 0UL ) && ( ulTime <= pxShortest->ulMaxTime ) )
+			{
+				return;
+			}
+
+			pxSite = pxShortest;
+			pxSite->ulSite = ulSite;
+			pxSite->ulCount = 0UL;
+			pxSite->ulMaxTime = 0UL;
+			pxSite->ulTotalTime = 0UL;
+		}
+
+		( pxSite->ulCount )++;
+		pxSite->ulTotalTime += ulTime;
+
+		if( ulTime > pxSite->ulMaxTime )
+		{
+			pxSite->ulMaxTime = ulTime;
+		}
+	}
+
+#endif /* configUSE_SECTION_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SECTION_PROFILER == 1 )
+
+	UBaseType_t uxTaskGetSectionProfile( eSectionType eType, SectionSite_t *pxSites, UBaseType_t uxMaxSites, BaseType_t xReset )
+	{
+	SectionSite_t xTable[ configSECTION_PROFILE_SITES ];
+
+		configASSERT( ( eType == eSectionMasked ) || ( eType == eSectionSchedulerSuspended ) );
+		configASSERT( ( pxSites != NULL ) || ( uxMaxSites == 0 ) );
+
+		/* Only the copy is taken with interrupts masked; the sort is done on
+		it afterwards. */
+		taskENTER_CRITICAL();
+		{
+			( void ) memcpy( ( void * ) xTable, ( void * ) xSectionSites[ eType ], sizeof( xTable ) );
+
+			if( xReset != pdFALSE )
+			{
+				( void ) memset( ( void * ) xSectionSites[ eType ], 0x00, sizeof( xTable ) );
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return prvSectionProfileSort( xTable, pxSites, uxMaxSites );
+	}
+
+#endif /* configUSE_SECTION_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SECTION_PROFILER == 1 )
+
+	static UBaseType_t prvSectionProfileSort( const SectionSite_t *pxTable, SectionSite_t *pxSites, UBaseType_t uxMaxSites )
+	{
+	UBaseType_t uxCopied = 0;
+	UBaseType_t ux, uxPosition;
+
+		/* Insertion sort into the caller's buffer, dropping whatever falls
+		off its end. */
+		for( ux = 0; ux < ( UBaseType_t ) configSECTION_PROFILE_SITES; ux++ )
+		{
+			if( pxTable[ ux ].ulCount == 0UL )
+			{
+				continue;
+			}
+
+			uxPosition = uxCopied;
+			while( ( uxPosition > 0 ) && ( pxSites[ uxPosition - 1 ].ulMaxTime < pxTable[ ux ].ulMaxTime ) )
+			{
+				if( uxPosition < uxMaxSites )
+				{
+					pxSites[ uxPosition ] = pxSites[ uxPosition - 1 ];
+				}
+				uxPosition--;
+			}
+
+			if( uxPosition < uxMaxSites )
+			{
+				pxSites[ uxPosition ] = pxTable[ ux ];
+
+				if( uxCopied < uxMaxSites )
+				{
+					uxCopied++;
+				}
+			}
+		}
+
+		return uxCopied;
+	}
+
+#endif /* configUSE_SECTION_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if( ( configUSE_EDF_SCHEDULING == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+	BaseType_t xTaskCreateEdf(	TaskFunction_t pxTaskCode,
+								const char * const pcName,		/*lint !e971 Unqualified char types are allowed for strings and single characters only. */
+								const configSTACK_DEPTH_TYPE usStackDepth,
+								void * const pvParameters,
+								const TickType_t xPeriod,
+								const TickType_t xRelativeDeadline,
+								TaskHandle_t * const pxCreatedTask )
+	{
+	BaseType_t xReturn;
+	TaskHandle_t xCreatedTask = NULL;
+
+		/* The task must not run before it has a deadline to be ordered by. */
+		vTaskSuspendAll();
+		{
+			xReturn = xTaskCreate( pxTaskCode, pcName, usStackDepth, pvParameters, configEDF_PRIORITY, &xCreatedTask );
+
+			if( xReturn == pdPASS )
+			{
+				vTaskSetDeadline( xCreatedTask, xPeriod, xRelativeDeadline );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		( void ) xTaskResumeAll();
+
+		if( pxCreatedTask != NULL )
+		{
+			*pxCreatedTask = xCreatedTask;
+		}
+
+		return xReturn;
+	}
+
+#endif /* ( configUSE_EDF_SCHEDULING == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_EDF_SCHEDULING == 1 )
+
+	void vTaskSetDeadline( TaskHandle_t xTask, TickType_t xPeriod, TickType_t xRelativeDeadline )
+	{
+	TCB_t *pxTCB;
+
+		configASSERT( xPeriod > ( TickType_t ) 0U );
+		configASSERT( xRelativeDeadline > ( TickType_t ) 0U );
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			pxTCB->xPeriod = xPeriod;
+			pxTCB->xRelativeDeadline = xRelativeDeadline;
+			pxTCB->xReleaseTime = xTickCount;
+			pxTCB->xDeadline = xTickCount + xRelativeDeadline;
+
+			/* A ready task is ordered by its deadline, which has just
+			changed. */
+			if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ configEDF_PRIORITY ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+			{
+				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+				prvAddTaskToReadyList( pxTCB );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_EDF_SCHEDULING */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_EDF_SCHEDULING == 1 )
+
+	BaseType_t xTaskWaitForNextPeriod( void )
+	{
+	TCB_t * const pxTCB = pxCurrentTCB;
+	TickType_t xTimeNow, xTimeToWake;
+	BaseType_t xDeadlineMet, xAlreadyYielded;
+
+		configASSERT( pxTCB->xPeriod > ( TickType_t ) 0U );
+		configASSERT( uxSchedulerSuspended == 0 );
+
+		vTaskSuspendAll();
+		{
+			/* Minor optimisation.  The tick count cannot change in this
+			block. */
+			xTimeNow = xTickCount;
+
+			/* Finishing on the deadline tick itself still meets it. */
+			if( taskTICK_IS_BEFORE( pxTCB->xDeadline, xTimeNow ) != pdFALSE )
+			{
+				xDeadlineMet = pdFALSE;
+				( pxTCB->ulDeadlineMisses )++;
+			}
+			else
+			{
+				xDeadlineMet = pdTRUE;
+			}
+
+			/* The next job is released a whole period after the last, not
+			after this one finished, so releases do not drift. */
+			pxTCB->xReleaseTime += pxTCB->xPeriod;
+			pxTCB->xDeadline = pxTCB->xReleaseTime + pxTCB->xRelativeDeadline;
+
+			if( taskTICK_IS_BEFORE( xTimeNow, pxTCB->xReleaseTime ) != pdFALSE )
+			{
+				/* prvAddCurrentTaskToDelayedList() needs the block time, not
+				the time to wake. */
+				xTimeToWake = pxTCB->xReleaseTime - xTimeNow;
+				prvAddCurrentTaskToDelayedList( xTimeToWake, pdFALSE );
+			}
+			else
+			{
+				/* The job overran into the next period, which is already
+				released.  Stay ready, but behind anything with an earlier
+				deadline than the new one. */
+				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+				prvAddTaskToReadyList( pxTCB );
+			}
+		}
+		xAlreadyYielded = xTaskResumeAll();
+
+		if( xAlreadyYielded == pdFALSE )
+		{
+			portYIELD_WITHIN_API();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xDeadlineMet;
+	}
+
+#endif /* configUSE_EDF_SCHEDULING */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_EDF_SCHEDULING == 1 )
+
+	uint32_t ulTaskGetDeadlineMisses( TaskHandle_t xTask )
+	{
+	uint32_t ulReturn;
+
+		taskENTER_CRITICAL();
+		{
+			ulReturn = prvGetTCBFromHandle( xTask )->ulDeadlineMisses;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif /* configUSE_EDF_SCHEDULING */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_EDF_SCHEDULING == 1 )
+
+	static void prvEdfInsertReady( TCB_t * const pxTCB )
+	{
+	List_t * const pxList = &( pxReadyTasksLists[ configEDF_PRIORITY ] );
+	ListItem_t *pxIterator;
+	TickType_t xDeadline;
+
+		/* A task without a period, such as one that inherited this priority
+		from a mutex, is treated as due now so it gets out of the way. */
+		if( pxTCB->xPeriod != ( TickType_t ) 0U )
+		{
+			xDeadline = pxTCB->xDeadline;
+		}
+		else
+		{
+			xDeadline = xTickCount;
+		}
+
+		listSET_LIST_ITEM_VALUE( &( pxTCB->xStateListItem ), xDeadline );
+
+		/* vListInsert() would sort by the raw value, which is wrong once the
+		deadlines straddle a tick count overflow.  Tasks with equal deadlines
+		stay in the order they became ready. */
+		for( pxIterator = listGET_HEAD_ENTRY( pxList ); pxIterator != listGET_END_MARKER( pxList ); pxIterator = listGET_NEXT( pxIterator ) )
+		{
+			if( taskTICK_IS_BEFORE( xDeadline, listGET_LIST_ITEM_VALUE( pxIterator ) ) != pdFALSE )
+			{
+				break;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		vListInsertBefore( pxList, pxIterator, &( pxTCB->xStateListItem ) );
+	}
+
+#endif /* configUSE_EDF_SCHEDULING */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_BUDGETS == 1 )
+
+	void vTaskSetBudget( TaskHandle_t xTask, TickType_t xBudget, TickType_t xPeriod )
+	{
+	TCB_t *pxTCB;
+
+		configASSERT( ( xBudget == ( TickType_t ) 0U ) || ( ( xPeriod >= xBudget ) && ( xPeriod <= ( portMAX_DELAY >> 1 ) ) ) );
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+
+			if( pxTCB->uxBudgetDemoted != pdFALSE )
+			{
+				prvBudgetRestore( pxTCB );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxTCB->xBudget = xBudget;
+			pxTCB->xBudgetPeriod = xPeriod;
+			pxTCB->xBudgetUsed = ( TickType_t ) 0U;
+			pxTCB->xBudgetReplenishTime = xTickCount + xPeriod;
+
+			if( xBudget == ( TickType_t ) 0U )
+			{
+				if( listIS_CONTAINED_WITHIN( &xBudgetedTasks, &( pxTCB->xBudgetListItem ) ) != pdFALSE )
+				{
+					( void ) uxListRemove( &( pxTCB->xBudgetListItem ) );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				if( listIS_CONTAINED_WITHIN( &xBudgetedTasks, &( pxTCB->xBudgetListItem ) ) == pdFALSE )
+				{
+					vListInsertEnd( &xBudgetedTasks, &( pxTCB->xBudgetListItem ) );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				if( ( listCURRENT_LIST_LENGTH( &xBudgetedTasks ) == ( UBaseType_t ) 1 ) || ( taskTICK_IS_BEFORE( pxTCB->xBudgetReplenishTime, xNextBudgetReplenishTime ) != pdFALSE ) )
+				{
+					xNextBudgetReplenishTime = pxTCB->xBudgetReplenishTime;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_TASK_BUDGETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_BUDGETS == 1 )
+
+	uint32_t ulTaskGetBudgetOverruns( TaskHandle_t xTask )
+	{
+	uint32_t ulReturn;
+
+		taskENTER_CRITICAL();
+		{
+			ulReturn = prvGetTCBFromHandle( xTask )->ulBudgetOverruns;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif /* configUSE_TASK_BUDGETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_FPU_POLICY == 1 )
+
+	void vTaskSetFpuPolicy( TaskHandle_t xTask, eTaskFpuPolicy ePolicy )
+	{
+		/* A single word, read by the context switch with interrupts masked. */
+		prvGetTCBFromHandle( xTask )->uxFpuPolicy = ( UBaseType_t ) ePolicy;
+	}
+
+	eTaskFpuPolicy eTaskGetFpuPolicy( TaskHandle_t xTask )
+	{
+		return ( eTaskFpuPolicy ) prvGetTCBFromHandle( xTask )->uxFpuPolicy;
+	}
+
+#endif /* configUSE_TASK_FPU_POLICY */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_BUDGETS == 1 )
+
+	static BaseType_t prvBudgetTick( const TickType_t xTimeNow )
+	{
+	TCB_t *pxTCB;
+	const ListItem_t *pxItem;
+	const ListItem_t * const pxEnd = listGET_END_MARKER( &xBudgetedTasks );
+	BaseType_t xSwitchRequired = pdFALSE;
+
+		/* Nothing to do unless some task has a budget. */
+		if( listLIST_IS_EMPTY( &xBudgetedTasks ) == pdFALSE )
+		{
+			/* Replenish every task whose period has ended.  The walk only happens
+			when the earliest replenish time is reached, and finds the next one. */
+			if( taskTICK_IS_BEFORE( xTimeNow, xNextBudgetReplenishTime ) == pdFALSE )
+			{
+				xNextBudgetReplenishTime = xTimeNow + ( portMAX_DELAY >> 1 );
+
+				for( pxItem = listGET_HEAD_ENTRY( &xBudgetedTasks ); pxItem != pxEnd; pxItem = listGET_NEXT( pxItem ) )
+				{
+					pxTCB = listGET_LIST_ITEM_OWNER( pxItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+
+					if( taskTICK_IS_BEFORE( xTimeNow, pxTCB->xBudgetReplenishTime ) == pdFALSE )
+					{
+						/* Periods that passed while the tick was suppressed are
+						skipped, not replenished one by one. */
+						do
+						{
+							pxTCB->xBudgetReplenishTime += pxTCB->xBudgetPeriod;
+						} while( taskTICK_IS_BEFORE( xTimeNow, pxTCB->xBudgetReplenishTime ) == pdFALSE );
+
+						pxTCB->xBudgetUsed = ( TickType_t ) 0U;
+
+						if( pxTCB->uxBudgetDemoted != pdFALSE )
+						{
+							prvBudgetRestore( pxTCB );
+
+							#if ( configUSE_PREEMPTION == 1 )
+							{
+								if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+								{
+									xSwitchRequired = pdTRUE;
+								}
+								else
+								{
+									mtCOVERAGE_TEST_MARKER();
+								}
+							}
+							#endif /* configUSE_PREEMPTION */
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+
+					if( taskTICK_IS_BEFORE( pxTCB->xBudgetReplenishTime, xNextBudgetReplenishTime ) != pdFALSE )
+					{
+						xNextBudgetReplenishTime = pxTCB->xBudgetReplenishTime;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* Charge the tick that has just ended to the task that was running
+			through it. */
+			pxTCB = pxCurrentTCB;
+			if( ( pxTCB->xBudget != ( TickType_t ) 0U ) && ( pxTCB->uxBudgetDemoted == pdFALSE ) )
+			{
+				( pxTCB->xBudgetUsed )++;
+
+				if( pxTCB->xBudgetUsed >= pxTCB->xBudget )
+				{
+					( pxTCB->ulBudgetOverruns )++;
+					prvBudgetDemote( pxTCB );
+
+					#if ( configUSE_BUDGET_OVERRUN_HOOK == 1 )
+					{
+						vApplicationBudgetOverrunHook( pxTCB );
+					}
+					#endif
+
+					/* Whatever it was sharing the processor with can now run. */
+					xSwitchRequired = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xSwitchRequired;
+	}
+
+#endif /* configUSE_TASK_BUDGETS */
+/*-----------------------------------------------------------*/
+
+#if ( ( configUSE_TASK_BUDGETS == 1 ) || ( configHEAP_LOCK_CEILING > 0 ) || ( configUSE_PREEMPTION_THRESHOLD == 1 ) )
+
+	static void prvMoveTaskToPriority( TCB_t * const pxTCB, UBaseType_t uxNewPriority )
+	{
+	const UBaseType_t uxPriorityUsedOnEntry = pxTCB->uxPriority;
+
+		pxTCB->uxPriority = uxNewPriority;
+
+		/* Only reset the event list item value if the value is not being used
+		for anything else. */
+		if( ( listGET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ) ) & taskEVENT_LIST_ITEM_VALUE_IN_USE ) == 0UL )
+		{
+			listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) uxNewPriority ) ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* As in vTaskPrioritySet(), a ready task moves to the ready list for
+		its new priority. */
+		if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ uxPriorityUsedOnEntry ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+		{
+			if( uxListRemove( &( pxTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
+			{
+				portRESET_READY_PRIORITY( uxPriorityUsedOnEntry, uxTopReadyPriority );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+			prvAddTaskToReadyList( pxTCB );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configUSE_TASK_BUDGETS || configHEAP_LOCK_CEILING || configUSE_PREEMPTION_THRESHOLD */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_BUDGETS == 1 )
+
+	static void prvBudgetDemote( TCB_t * const pxTCB )
+	{
+		pxTCB->uxBudgetDemoted = pdTRUE;
+
+		#if ( configUSE_MUTEXES == 1 )
+		{
+			/* The demotion is to the base priority, so a task that holds a
+			mutex keeps any priority it has inherited until it gives the mutex
+			back. */
+			pxTCB->uxBudgetSavedPriority = pxTCB->uxBasePriority;
+			pxTCB->uxBasePriority = configBUDGET_DEMOTED_PRIORITY;
+
+			if( pxTCB->uxPriority == pxTCB->uxBudgetSavedPriority )
+			{
+				prvMoveTaskToPriority( pxTCB, configBUDGET_DEMOTED_PRIORITY );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#else
+		{
+			pxTCB->uxBudgetSavedPriority = pxTCB->uxPriority;
+			prvMoveTaskToPriority( pxTCB, configBUDGET_DEMOTED_PRIORITY );
+		}
+		#endif
+	}
+
+#endif /* configUSE_TASK_BUDGETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_BUDGETS == 1 )
+
+	static void prvBudgetRestore( TCB_t * const pxTCB )
+	{
+		pxTCB->uxBudgetDemoted = pdFALSE;
+
+		#if ( configUSE_MUTEXES == 1 )
+		{
+			/* Leave an inherited priority above the restored one alone. */
+			if( pxTCB->uxPriority < pxTCB->uxBudgetSavedPriority )
+			{
+				prvMoveTaskToPriority( pxTCB, pxTCB->uxBudgetSavedPriority );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxTCB->uxBasePriority = pxTCB->uxBudgetSavedPriority;
+		}
+		#else
+		{
+			prvMoveTaskToPriority( pxTCB, pxTCB->uxBudgetSavedPriority );
+		}
+		#endif
+	}
+
+#endif /* configUSE_TASK_BUDGETS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+	void vTaskSetPreemptionThreshold( TaskHandle_t xTask, UBaseType_t uxThreshold )
+	{
+	TCB_t *pxTCB;
+
+		configASSERT( uxThreshold < ( UBaseType_t ) configMAX_PRIORITIES );
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+
+			/* Raising a task into or out of the deadline ordered priority
+			would put it in the wrong kind of ready list. */
+			#if ( configUSE_EDF_SCHEDULING == 1 )
+			{
+				configASSERT( ( uxThreshold <= pxTCB->uxPriority ) || ( ( uxThreshold != ( UBaseType_t ) configEDF_PRIORITY ) && ( pxTCB->uxPriority != ( UBaseType_t ) configEDF_PRIORITY ) ) );
+			}
+			#endif
+
+			if( pxTCB->uxThresholdRaised != pdFALSE )
+			{
+				prvThresholdRestore( pxTCB );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxTCB->uxPreemptionThreshold = uxThreshold;
+
+			/* The running task takes the new threshold at once, rather than
+			the next time it is switched in, and a task it no longer keeps
+			out gets to run. */
+			if( pxTCB == pxCurrentTCB )
+			{
+				if( uxThreshold > pxTCB->uxPriority )
+				{
+					prvThresholdRaise( pxTCB );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				if( xSchedulerRunning != pdFALSE )
+				{
+					taskYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+	UBaseType_t uxTaskGetPreemptionThreshold( TaskHandle_t xTask )
+	{
+	UBaseType_t uxReturn;
+
+		taskENTER_CRITICAL();
+		{
+			uxReturn = prvGetTCBFromHandle( xTask )->uxPreemptionThreshold;
+		}
+		taskEXIT_CRITICAL();
+
+		return uxReturn;
+	}
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+	static BaseType_t prvThresholdSwitchOut( void )
+	{
+	UBaseType_t uxPriority;
+
+		if( pxCurrentTCB->uxThresholdRaised == pdFALSE )
+		{
+			return pdFALSE;
+		}
+
+		/* Blocked, suspended or deleted: it waits for its turn again at its
+		own priority. */
+		if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ), &( pxCurrentTCB->xStateListItem ) ) == pdFALSE )
+		{
+			prvThresholdRestore( pxCurrentTCB );
+			return pdFALSE;
+		}
+
+		/* Still ready, so the switch was asked for by a task readied at or
+		above its threshold.  Only one above it may take over; the others
+		would otherwise take turns with it. */
+		for( uxPriority = pxCurrentTCB->uxPriority + ( UBaseType_t ) 1; uxPriority < ( UBaseType_t ) configMAX_PRIORITIES; uxPriority++ )
+		{
+			if( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxPriority ] ) ) == pdFALSE )
+			{
+				return pdFALSE;
+			}
+		}
+
+		return pdTRUE;
+	}
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+	static void prvThresholdRaise( TCB_t * const pxTCB )
+	{
+		pxTCB->uxThresholdSavedPriority = pxTCB->uxPriority;
+		pxTCB->uxThresholdRaised = pdTRUE;
+		prvMoveTaskToPriority( pxTCB, pxTCB->uxPreemptionThreshold );
+	}
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+	static void prvThresholdRestore( TCB_t * const pxTCB )
+	{
+	UBaseType_t uxPriorityToRestore = pxTCB->uxThresholdSavedPriority;
+
+		pxTCB->uxThresholdRaised = pdFALSE;
+
+		#if ( configUSE_MUTEXES == 1 )
+		{
+			/* With no mutex held nothing is inherited, and the base priority
+			is the one vTaskPrioritySet() last gave it. */
+			if( pxTCB->uxMutexesHeld == ( UBaseType_t ) 0U )
+			{
+				uxPriorityToRestore = pxTCB->uxBasePriority;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif
+
+		/* Left where it is if inheritance or vTaskPrioritySet() moved it
+		meanwhile, as with the heap lock ceiling. */
+		if( pxTCB->uxPriority == pxTCB->uxPreemptionThreshold )
+		{
+			prvMoveTaskToPriority( pxTCB, uxPriorityToRestore );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+/*-----------------------------------------------------------*/
+
+#if ( portUSING_MPU_WRAPPERS == 1 )
+
+	void vTaskAllocateMPURegions( TaskHandle_t xTaskToModify, const MemoryRegion_t * const xRegions )
+	{
+	TCB_t *pxTCB;
+
+		/* If null is passed in here then we are modifying the MPU settings of
+		the calling task. */
+		pxTCB = prvGetTCBFromHandle( xTaskToModify );
+
+		vPortStoreTaskMPUSettings( &( pxTCB->xMPUSettings ), xRegions, NULL, 0 );
+	}
+
+#endif /* portUSING_MPU_WRAPPERS */
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseTaskLists( void )
+{
+UBaseType_t uxPriority;
+
+	for( uxPriority = ( UBaseType_t ) 0U; uxPriority < ( UBaseType_t ) configMAX_PRIORITIES; uxPriority++ )
+	{
+		vListInitialise( &( pxReadyTasksLists[ uxPriority ] ) );
+	}
+
+	#if( configUSE_DELAY_WHEEL == 0 )
+	{
+		vListInitialise( &xDelayedTaskList1 );
+	}
+	#else
+	{
+		for( uxPriority = ( UBaseType_t ) 0U; uxPriority < taskDELAY_WHEEL_SLOTS; uxPriority++ )
+		{
+			vListInitialise( &( xDelayWheel[ uxPriority ] ) );
+		}
+	}
+	#endif
+	vListInitialise( &xDelayedTaskList2 );
+	vListInitialise( &xPendingReadyList );
+
+	#if ( configUSE_TASK_BUDGETS == 1 )
+	{
+		vListInitialise( &xBudgetedTasks );
+	}
+	#endif
+
+	#if ( INCLUDE_vTaskDelete == 1 )
+	{
+		vListInitialise( &xTasksWaitingTermination );
+	}
+	#endif /* INCLUDE_vTaskDelete */
+
+	#if ( INCLUDE_vTaskSuspend == 1 )
+	{
+		vListInitialise( &xSuspendedTaskList );
+	}
+	#endif /* INCLUDE_vTaskSuspend */
+
+	/* Start with pxDelayedTaskList using list1 and the pxOverflowDelayedTaskList
+	using list2. */
+	#if( configUSE_DELAY_WHEEL == 0 )
+	{
+		pxDelayedTaskList = &xDelayedTaskList1;
+	}
+	#endif
+	pxOverflowDelayedTaskList = &xDelayedTaskList2;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckTasksWaitingTermination( void )
+{
+
+	/** THIS FUNCTION IS CALLED FROM THE RTOS IDLE TASK **/
+
+	#if ( INCLUDE_vTaskDelete == 1 )
+	{
+		TCB_t *pxTCB;
+		void *pvToFree[ configTASK_DELETE_BATCH_LENGTH * tskMAX_HEAP_BLOCKS_PER_TCB ];
+		UBaseType_t uxBlocks, uxTasks;
+
+		/* uxDeletedTasksWaitingCleanUp is used to prevent taskENTER_CRITICAL()
+		being called too often in the idle task. */
+		while( uxDeletedTasksWaitingCleanUp > ( UBaseType_t ) 0U )
+		{
+			uxBlocks = 0;
+
+			/* Collect the memory of up to configTASK_DELETE_BATCH_LENGTH
+			tasks so a burst of deletions costs one pass over the heap. */
+			for( uxTasks = 0; ( uxTasks < ( UBaseType_t ) configTASK_DELETE_BATCH_LENGTH ) && ( uxDeletedTasksWaitingCleanUp > ( UBaseType_t ) 0U ); uxTasks++ )
+			{
+				taskENTER_CRITICAL();
+				{
+					pxTCB = listGET_OWNER_OF_HEAD_ENTRY( ( &xTasksWaitingTermination ) ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+					( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+					--uxCurrentNumberOfTasks;
+					--uxDeletedTasksWaitingCleanUp;
+				}
+				taskEXIT_CRITICAL();
+
+				uxBlocks += prvReleaseTCB( pxTCB, &( pvToFree[ uxBlocks ] ) );
+			}
+
+			prvFreeTaskBlocks( pvToFree, uxBlocks );
+		}
+	}
+	#endif /* INCLUDE_vTaskDelete */
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TRACE_FACILITY == 1 )
+
+	void vTaskGetInfo( TaskHandle_t xTask, TaskStatus_t *pxTaskStatus, BaseType_t xGetFreeStackSpace, eTaskState eState )
+	{
+	TCB_t *pxTCB;
+
+		/* xTask is NULL then get the state of the calling task. */
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		pxTaskStatus->xHandle = ( TaskHandle_t ) pxTCB;
+		pxTaskStatus->pcTaskName = ( const char * ) &( pxTCB->pcTaskName [ 0 ] );
+		pxTaskStatus->uxCurrentPriority = pxTCB->uxPriority;
+		pxTaskStatus->pxStackBase = pxTCB->pxStack;
+		pxTaskStatus->xTaskNumber = pxTCB->uxTCBNumber;
+
+		#if ( configUSE_MUTEXES == 1 )
+		{
+			pxTaskStatus->uxBasePriority = pxTCB->uxBasePriority;
+		}
+		#else
+		{
+			pxTaskStatus->uxBasePriority = 0;
+		}
+		#endif
+
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
+		{
+			pxTaskStatus->ulRunTimeCounter = pxTCB->ulRunTimeCounter;
+			pxTaskStatus->ulSwitchInCount = pxTCB->ulSwitchInCount;
+		}
+		#else
+		{
+			pxTaskStatus->ulRunTimeCounter = 0;
+			pxTaskStatus->ulSwitchInCount = 0;
+		}
+		#endif
+
+		#if ( configHEAP_TRACK_OWNERS == 1 )
+		{
+			pxTaskStatus->xHeapBytes = xPortGetHeapOwnerBytes( pxTCB );
+		}
+		#endif
+
+		#if ( configUSE_TASK_ENERGY_STATS == 1 )
+		{
+			( void ) memcpy( ( void * ) pxTaskStatus->ulEnergyRunTime, ( void * ) pxTCB->ulEnergyRunTime, sizeof( pxTaskStatus->ulEnergyRunTime ) );
+			pxTaskStatus->ulWakeCount = pxTCB->ulWakeCount;
+		}
+		#endif
+
+		#if ( configUSE_NEWLIB_REENTRANT == 2 )
+		{
+			pxTaskStatus->xNewlibReent = ( pxTCB->pxNewLibReent != _global_impure_ptr ) ? pdTRUE : pdFALSE;
+		}
+		#endif
+
+		/* Obtaining the task state is a little fiddly, so is only done if the
 		value of eState passed into this function is eInvalid - otherwise the
 		state is just set to whatever is passed in. */
 		if( eState != eInvalid )
@@ -3757,6 +6092,77 @@ static void prvCheckTasksWaitingTermination( void )
 #endif /* ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark2 == 1 ) ) */
 /*-----------------------------------------------------------*/
 
+#if( configUSE_IDLE_STACK_PAINTER == 1 )
+
+	static void prvPaintStacks( void )
+	{
+	TCB_t *pxTCB;
+	StackType_t *pxLimit, *pxEnd;
+
+		if( pxTasksToPaint == NULL )
+		{
+			return;
+		}
+
+		/* With the scheduler suspended the task being painted cannot run, so
+		nothing below the top of stack it was switched out with is in use.
+		Interrupts run on the main stack. */
+		vTaskSuspendAll();
+		{
+			pxTCB = pxTasksToPaint;
+
+			if( pxTCB != NULL )
+			{
+				/* Only a task that has never run can be painted up to its
+				saved top, which is still the frame pxPortInitialiseStack()
+				built.  Once it has run, whatever it left deeper down may be
+				the most it ever used, so painting over it would raise its high
+				water mark; its stack stays painted only as far as it got, and
+				the high water mark counts no further.  The idle task is
+				running, so it is never painted. */
+				pxLimit = ( pxTCB->xStackPaintable != pdFALSE ) ? ( StackType_t * ) pxTCB->pxTopOfStack : pxTCB->pxStackPainted;
+				pxEnd = pxTCB->pxStackPainted + configSTACK_PAINT_STEP;
+
+				if( pxEnd >= pxLimit )
+				{
+					/* Only tasks change the list, so it cannot change while
+					the scheduler is suspended. */
+					pxEnd = pxLimit;
+					pxTasksToPaint = pxTCB->pxNextToPaint;
+				}
+
+				if( pxEnd > pxTCB->pxStackPainted )
+				{
+					( void ) portMEMSET( pxTCB->pxStackPainted, ( int ) tskSTACK_FILL_BYTE, ( size_t ) ( pxEnd - pxTCB->pxStackPainted ) * sizeof( StackType_t ) );
+					pxTCB->pxStackPainted = pxEnd;
+				}
+			}
+		}
+		( void ) xTaskResumeAll();
+	}
+	/*-----------------------------------------------------------*/
+
+	#if( INCLUDE_vTaskDelete == 1 )
+
+		static void prvStopPainting( const TCB_t *pxTCB )
+		{
+		TCB_t **ppxLink;
+
+			for( ppxLink = &pxTasksToPaint; *ppxLink != NULL; ppxLink = &( ( *ppxLink )->pxNextToPaint ) )
+			{
+				if( *ppxLink == pxTCB )
+				{
+					*ppxLink = pxTCB->pxNextToPaint;
+					break;
+				}
+			}
+		}
+
+	#endif /* INCLUDE_vTaskDelete */
+
+#endif /* configUSE_IDLE_STACK_PAINTER */
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_uxTaskGetStackHighWaterMark2 == 1 )
 
 	/* uxTaskGetStackHighWaterMark() and uxTaskGetStackHighWaterMark2() are the
@@ -3829,25 +6235,76 @@ static void prvCheckTasksWaitingTermination( void )
 
 	static void prvDeleteTCB( TCB_t *pxTCB )
 	{
+	void *pvToFree[ tskMAX_HEAP_BLOCKS_PER_TCB ];
+
+		prvFreeTaskBlocks( pvToFree, prvReleaseTCB( pxTCB, pvToFree ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+	static UBaseType_t prvReleaseTaskMemory( void *pv, void *pvToFree[], UBaseType_t uxBlocks )
+	{
+		/* Pool memory goes straight back to its pool, heap memory is left for
+		the caller to free. */
+		if( prvReturnToTaskPool( pv ) == pdFALSE )
+		{
+			pvToFree[ uxBlocks ] = pv;
+			uxBlocks++;
+		}
+
+		return uxBlocks;
+	}
+
+	#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+	/*-----------------------------------------------------------*/
+
+	static UBaseType_t prvReleaseTCB( TCB_t *pxTCB, void *pvToFree[] )
+	{
+	UBaseType_t uxBlocks = 0;
+
 		/* This call is required specifically for the TriCore port.  It must be
-		above the vPortFree() calls.  The call is also used by ports/demos that
-		want to allocate and clean RAM statically. */
+		above the memory being released.  The call is also used by ports/demos
+		that want to allocate and clean RAM statically. */
 		portCLEAN_UP_TCB( pxTCB );
 
+		traceTASK_DELETE_TCB( pxTCB );
+
 		/* Free up the memory allocated by the scheduler for the task.  It is up
 		to the task to free any memory allocated at the application level. */
 		#if ( configUSE_NEWLIB_REENTRANT == 1 )
 		{
 			_reclaim_reent( &( pxTCB->xNewLib_reent ) );
 		}
+		#elif ( configUSE_NEWLIB_REENTRANT == 2 )
+		{
+			if( pxTCB->pxNewLibReent != _global_impure_ptr )
+			{
+				_reclaim_reent( pxTCB->pxNewLibReent );
+				pvToFree[ uxBlocks ] = pxTCB->pxNewLibReent;
+				uxBlocks++;
+			}
+		}
 		#endif /* configUSE_NEWLIB_REENTRANT */
 
+		#if ( configUSE_TASK_ARENAS == 1 )
+		{
+			/* Everything the task took from its arena is returned to the heap
+			in one go, whichever way the task itself was allocated. */
+			if( pxTCB->pxArena != NULL )
+			{
+				pvToFree[ uxBlocks ] = pxTCB->pxArena;
+				uxBlocks++;
+			}
+		}
+		#endif /* configUSE_TASK_ARENAS */
+
 		#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) && ( portUSING_MPU_WRAPPERS == 0 ) )
 		{
 			/* The task can only have been allocated dynamically - free both
 			the stack and TCB. */
-			vPortFree( pxTCB->pxStack );
-			vPortFree( pxTCB );
+			uxBlocks = prvReleaseTaskMemory( pxTCB->pxStack, pvToFree, uxBlocks );
+			uxBlocks = prvReleaseTaskMemory( pxTCB, pvToFree, uxBlocks );
 		}
 		#elif( tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE != 0 ) /*lint !e731 !e9029 Macro has been consolidated for readability reasons. */
 		{
@@ -3858,14 +6315,14 @@ static void prvCheckTasksWaitingTermination( void )
 			{
 				/* Both the stack and TCB were allocated dynamically, so both
 				must be freed. */
-				vPortFree( pxTCB->pxStack );
-				vPortFree( pxTCB );
+				uxBlocks = prvReleaseTaskMemory( pxTCB->pxStack, pvToFree, uxBlocks );
+				uxBlocks = prvReleaseTaskMemory( pxTCB, pvToFree, uxBlocks );
 			}
 			else if( pxTCB->ucStaticallyAllocated == tskSTATICALLY_ALLOCATED_STACK_ONLY )
 			{
 				/* Only the stack was statically allocated, so the TCB is the
 				only memory that must be freed. */
-				vPortFree( pxTCB );
+				uxBlocks = prvReleaseTaskMemory( pxTCB, pvToFree, uxBlocks );
 			}
 			else
 			{
@@ -3876,33 +6333,281 @@ static void prvCheckTasksWaitingTermination( void )
 			}
 		}
 		#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+
+		return uxBlocks;
 	}
 
 #endif /* INCLUDE_vTaskDelete */
 /*-----------------------------------------------------------*/
 
-static void prvResetNextTaskUnblockTime( void )
-{
-TCB_t *pxTCB;
+#if( configUSE_DELAY_WHEEL == 0 )
 
-	if( listLIST_IS_EMPTY( pxDelayedTaskList ) != pdFALSE )
+	static void prvResetNextTaskUnblockTime( void )
 	{
-		/* The new current delayed list is empty.  Set xNextTaskUnblockTime to
-		the maximum possible value so it is	extremely unlikely that the
-		if( xTickCount >= xNextTaskUnblockTime ) test will pass until
-		there is an item in the delayed list. */
-		xNextTaskUnblockTime = portMAX_DELAY;
+	TCB_t *pxTCB;
+
+		if( listLIST_IS_EMPTY( pxDelayedTaskList ) != pdFALSE )
+		{
+			/* The new current delayed list is empty.  Set xNextTaskUnblockTime to
+			the maximum possible value so it is	extremely unlikely that the
+			if( xTickCount >= xNextTaskUnblockTime ) test will pass until
+			there is an item in the delayed list. */
+			xNextTaskUnblockTime = portMAX_DELAY;
+		}
+		else
+		{
+			/* The new current delayed list is not empty, get the value of
+			the item at the head of the delayed list.  This is the time at
+			which the task at the head of the delayed list should be removed
+			from the Blocked state. */
+			( pxTCB ) = listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+			xNextTaskUnblockTime = listGET_LIST_ITEM_VALUE( &( ( pxTCB )->xStateListItem ) );
+		}
 	}
-	else
+
+#else /* configUSE_DELAY_WHEEL */
+
+	static void prvResetNextTaskUnblockTime( void )
 	{
-		/* The new current delayed list is not empty, get the value of
-		the item at the head of the delayed list.  This is the time at
-		which the task at the head of the delayed list should be removed
-		from the Blocked state. */
-		( pxTCB ) = listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
-		xNextTaskUnblockTime = listGET_LIST_ITEM_VALUE( &( ( pxTCB )->xStateListItem ) );
+	UBaseType_t uxFirst, uxOffset;
+	uint32_t ulRotated;
+	TickType_t xNext;
+
+		if( ulDelayWheelOccupied == 0UL )
+		{
+			/* No slot can hold a task, so it is extremely unlikely that the
+			if( xTickCount >= xNextTaskUnblockTime ) test will pass until a
+			task is delayed. */
+			xNextTaskUnblockTime = portMAX_DELAY;
+		}
+		else
+		{
+			/* Rotate the occupied mask so that bit 0 is the slot of the current
+			tick.  Every task in the wheel is due at or after the current tick,
+			so the start of the first occupied slot from there is a lower bound
+			on the next wake time.  Bits rotated in above the top slot duplicate
+			ones below it, so cannot be the lowest set bit. */
+			uxFirst = ( UBaseType_t ) xTickCount & taskDELAY_WHEEL_SLOT_MASK;
+			ulRotated = ulDelayWheelOccupied;
+			if( uxFirst != ( UBaseType_t ) 0U )
+			{
+				ulRotated = ( ulRotated >> uxFirst ) | ( ulRotated << ( taskDELAY_WHEEL_SLOTS - uxFirst ) );
+			}
+
+			#if defined( __GNUC__ )
+			{
+				uxOffset = ( UBaseType_t ) __builtin_ctz( ulRotated );
+			}
+			#else
+			{
+				for( uxOffset = ( UBaseType_t ) 0U; ( ulRotated & 1UL ) == 0UL; uxOffset++ )
+				{
+					ulRotated >>= 1;
+				}
+			}
+			#endif
+
+			/* A bound past the end of this epoch can only come from a slot
+			that is really empty, as nothing in the wheel has wrapped. */
+			xNext = xTickCount + ( TickType_t ) uxOffset;
+			if( xNext < xTickCount )
+			{
+				xNextTaskUnblockTime = portMAX_DELAY;
+			}
+			else
+			{
+				xNextTaskUnblockTime = xNext;
+			}
+		}
 	}
-}
+	/*-----------------------------------------------------------*/
+
+	static void prvDelayWheelInsert( ListItem_t * const pxListItem )
+	{
+	const TickType_t xTimeToWake = listGET_LIST_ITEM_VALUE( pxListItem );
+	const UBaseType_t uxSlot = ( UBaseType_t ) xTimeToWake & taskDELAY_WHEEL_SLOT_MASK;
+
+		ulDelayWheelOccupied |= ( 1UL << uxSlot );
+		vListInsertEnd( &( xDelayWheel[ uxSlot ] ), pxListItem );
+
+		/* Keep xNextTaskUnblockTime a lower bound. */
+		if( xTimeToWake < xNextTaskUnblockTime )
+		{
+			xNextTaskUnblockTime = xTimeToWake;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvDelayWheelAdvance( const TickType_t xTimeNow )
+	{
+	TCB_t *pxTCB;
+	ListItem_t *pxItem, *pxNextItem;
+	List_t *pxSlot;
+	UBaseType_t uxSlot, uxSlotsToScan;
+	BaseType_t xSwitchRequired = pdFALSE;
+
+		/* Nothing in the wheel is due before xNextTaskUnblockTime, so only the
+		slots of the ticks from there to now need looking at - and all of them
+		only if the tick count has jumped by a whole turn. */
+		if( ( xTimeNow - xNextTaskUnblockTime ) >= ( TickType_t ) taskDELAY_WHEEL_SLOT_MASK )
+		{
+			uxSlotsToScan = taskDELAY_WHEEL_SLOTS;
+		}
+		else
+		{
+			uxSlotsToScan = ( UBaseType_t ) ( xTimeNow - xNextTaskUnblockTime ) + ( UBaseType_t ) 1U;
+		}
+
+		uxSlot = ( UBaseType_t ) xNextTaskUnblockTime & taskDELAY_WHEEL_SLOT_MASK;
+
+		while( uxSlotsToScan > ( UBaseType_t ) 0U )
+		{
+			if( ( ulDelayWheelOccupied & ( 1UL << uxSlot ) ) != 0UL )
+			{
+				/* The slot also holds tasks due on later turns of the wheel,
+				which stay where they are. */
+				pxSlot = &( xDelayWheel[ uxSlot ] );
+				pxItem = listGET_HEAD_ENTRY( pxSlot );
+
+				while( pxItem != listGET_END_MARKER( pxSlot ) )
+				{
+					pxNextItem = listGET_NEXT( pxItem );
+
+					if( listGET_LIST_ITEM_VALUE( pxItem ) <= xTimeNow )
+					{
+						pxTCB = listGET_LIST_ITEM_OWNER( pxItem ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+
+						/* It is time to remove the item from the Blocked
+						state. */
+						( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+
+						/* Is the task waiting on an event also?  If so remove
+						it from the event list. */
+						if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
+						{
+							( void ) uxListRemove( &( pxTCB->xEventListItem ) );
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+
+						prvAddTaskToReadyList( pxTCB );
+
+						/* A task being unblocked cannot cause an immediate
+						context switch if preemption is turned off. */
+						#if (  configUSE_PREEMPTION == 1 )
+						{
+							if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+							{
+								xSwitchRequired = pdTRUE;
+							}
+							else
+							{
+								mtCOVERAGE_TEST_MARKER();
+							}
+						}
+						#endif /* configUSE_PREEMPTION */
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+
+					pxItem = pxNextItem;
+				}
+
+				if( listLIST_IS_EMPTY( pxSlot ) != pdFALSE )
+				{
+					ulDelayWheelOccupied &= ~( 1UL << uxSlot );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			uxSlot = ( uxSlot + ( UBaseType_t ) 1U ) & taskDELAY_WHEEL_SLOT_MASK;
+			uxSlotsToScan--;
+		}
+
+		prvResetNextTaskUnblockTime();
+
+		return xSwitchRequired;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvDelayWheelOverflow( void )
+	{
+	ListItem_t *pxItem;
+	UBaseType_t uxSlot;
+
+		/* Every task due in the epoch that has just ended has been unblocked,
+		so the wheel should be empty, whatever the occupied mask still says. */
+		for( uxSlot = ( UBaseType_t ) 0U; uxSlot < taskDELAY_WHEEL_SLOTS; uxSlot++ )
+		{
+			configASSERT( listLIST_IS_EMPTY( &( xDelayWheel[ uxSlot ] ) ) );
+		}
+
+		ulDelayWheelOccupied = 0UL;
+		xNextTaskUnblockTime = portMAX_DELAY;
+
+		/* The insertions lower xNextTaskUnblockTime to the exact earliest wake
+		time. */
+		while( listLIST_IS_EMPTY( pxOverflowDelayedTaskList ) == pdFALSE )
+		{
+			pxItem = listGET_HEAD_ENTRY( pxOverflowDelayedTaskList );
+			( void ) uxListRemove( pxItem );
+			prvDelayWheelInsert( pxItem );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	#if( configUSE_TICKLESS_IDLE != 0 )
+
+		static void prvDelayWheelTighten( void )
+		{
+		const ListItem_t *pxItem;
+		UBaseType_t uxSlot;
+		TickType_t xEarliest = portMAX_DELAY;
+
+			for( uxSlot = ( UBaseType_t ) 0U; uxSlot < taskDELAY_WHEEL_SLOTS; uxSlot++ )
+			{
+				if( ( ulDelayWheelOccupied & ( 1UL << uxSlot ) ) != 0UL )
+				{
+					for( pxItem = listGET_HEAD_ENTRY( &( xDelayWheel[ uxSlot ] ) ); pxItem != listGET_END_MARKER( &( xDelayWheel[ uxSlot ] ) ); pxItem = listGET_NEXT( pxItem ) )
+					{
+						if( listGET_LIST_ITEM_VALUE( pxItem ) < xEarliest )
+						{
+							xEarliest = listGET_LIST_ITEM_VALUE( pxItem );
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+
+			xNextTaskUnblockTime = xEarliest;
+		}
+
+	#endif /* configUSE_TICKLESS_IDLE */
+	/*-----------------------------------------------------------*/
+
+#endif /* configUSE_DELAY_WHEEL */
 /*-----------------------------------------------------------*/
 
 #if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) )
@@ -4565,19 +7270,107 @@ TickType_t uxReturn;
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
+#if ( configHEAP_LOCK_CEILING > 0 )
+
+	UBaseType_t uxTaskPriorityCeilingRaise( UBaseType_t uxCeiling )
+	{
+	UBaseType_t uxReturn = uxCeiling;
+
+		/* Before the scheduler starts, or while it is suspended, nothing can
+		preempt the caller anyway. */
+		if( ( xSchedulerRunning != pdFALSE ) && ( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE ) )
+		{
+			taskENTER_CRITICAL();
+			{
+				/* A task above the ceiling, even by inheritance, could preempt
+				another inside the section the ceiling protects, and one at
+				the ceiling could take a time slice from it. */
+				configASSERT( pxCurrentTCB->uxPriority < uxCeiling );
+
+				uxReturn = pxCurrentTCB->uxPriority;
+				prvMoveTaskToPriority( pxCurrentTCB, uxCeiling );
+			}
+			taskEXIT_CRITICAL();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return uxReturn;
+	}
+
+#endif /* configHEAP_LOCK_CEILING */
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_LOCK_CEILING > 0 )
+
+	void vTaskPriorityCeilingRestore( UBaseType_t uxCeiling, UBaseType_t uxPriorityToRestore )
+	{
+	UBaseType_t uxPriority;
+	BaseType_t xYieldRequired = pdFALSE;
+
+		if( uxPriorityToRestore < uxCeiling )
+		{
+			taskENTER_CRITICAL();
+			{
+				/* Left where it is if inheritance moved it meanwhile; giving
+				the mutex will set it back to its base priority. */
+				if( pxCurrentTCB->uxPriority == uxCeiling )
+				{
+					prvMoveTaskToPriority( pxCurrentTCB, uxPriorityToRestore );
+
+					/* Tasks above the ceiling preempted as usual, so only those
+					readied between the two priorities are waiting to run. */
+					for( uxPriority = uxPriorityToRestore + ( UBaseType_t ) 1; uxPriority <= uxCeiling; uxPriority++ )
+					{
+						if( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxPriority ] ) ) == pdFALSE )
+						{
+							xYieldRequired = pdTRUE;
+							break;
+						}
+					}
+
+					if( xYieldRequired != pdFALSE )
+					{
+						taskYIELD_IF_USING_PREEMPTION();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configHEAP_LOCK_CEILING */
+/*-----------------------------------------------------------*/
+
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
+	uint32_t ulTaskGenericNotifyTake( UBaseType_t uxIndexToWait, BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
 	{
 	uint32_t ulReturn;
 
+		configASSERT( uxIndexToWait < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+
 		taskENTER_CRITICAL();
 		{
 			/* Only block if the notification count is not already non-zero. */
-			if( pxCurrentTCB->ulNotifiedValue == 0UL )
+			if( pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ] == 0UL )
 			{
 				/* Mark this task as waiting for a notification. */
-				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+				pxCurrentTCB->ucNotifyState[ uxIndexToWait ] = taskWAITING_NOTIFICATION;
 
 				if( xTicksToWait > ( TickType_t ) 0 )
 				{
@@ -4605,17 +7398,17 @@ TickType_t uxReturn;
 		taskENTER_CRITICAL();
 		{
 			traceTASK_NOTIFY_TAKE();
-			ulReturn = pxCurrentTCB->ulNotifiedValue;
+			ulReturn = pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ];
 
 			if( ulReturn != 0UL )
 			{
 				if( xClearCountOnExit != pdFALSE )
 				{
-					pxCurrentTCB->ulNotifiedValue = 0UL;
+					pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ] = 0UL;
 				}
 				else
 				{
-					pxCurrentTCB->ulNotifiedValue = ulReturn - ( uint32_t ) 1;
+					pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ] = ulReturn - ( uint32_t ) 1;
 				}
 			}
 			else
@@ -4623,7 +7416,7 @@ TickType_t uxReturn;
 				mtCOVERAGE_TEST_MARKER();
 			}
 
-			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+			pxCurrentTCB->ucNotifyState[ uxIndexToWait ] = taskNOT_WAITING_NOTIFICATION;
 		}
 		taskEXIT_CRITICAL();
 
@@ -4635,22 +7428,24 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskNotifyWait( uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait )
+	BaseType_t xTaskGenericNotifyWait( UBaseType_t uxIndexToWait, uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait )
 	{
 	BaseType_t xReturn;
 
+		configASSERT( uxIndexToWait < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+
 		taskENTER_CRITICAL();
 		{
 			/* Only block if a notification is not already pending. */
-			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
+			if( pxCurrentTCB->ucNotifyState[ uxIndexToWait ] != taskNOTIFICATION_RECEIVED )
 			{
 				/* Clear bits in the task's notification value as bits may get
 				set	by the notifying task or interrupt.  This can be used to
 				clear the value to zero. */
-				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnEntry;
+				pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ] &= ~ulBitsToClearOnEntry;
 
 				/* Mark this task as waiting for a notification. */
-				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+				pxCurrentTCB->ucNotifyState[ uxIndexToWait ] = taskWAITING_NOTIFICATION;
 
 				if( xTicksToWait > ( TickType_t ) 0 )
 				{
@@ -4683,14 +7478,14 @@ TickType_t uxReturn;
 			{
 				/* Output the current notification value, which may or may not
 				have changed. */
-				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue;
+				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ];
 			}
 
 			/* If ucNotifyValue is set then either the task never entered the
 			blocked state (because a notification was already pending) or the
 			task unblocked because of a notification.  Otherwise the task
 			unblocked because of a timeout. */
-			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
+			if( pxCurrentTCB->ucNotifyState[ uxIndexToWait ] != taskNOTIFICATION_RECEIVED )
 			{
 				/* A notification was not received. */
 				xReturn = pdFALSE;
@@ -4699,11 +7494,11 @@ TickType_t uxReturn;
 			{
 				/* A notification was already pending or a notification was
 				received while the task was waiting. */
-				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnExit;
+				pxCurrentTCB->ulNotifiedValue[ uxIndexToWait ] &= ~ulBitsToClearOnExit;
 				xReturn = pdTRUE;
 			}
 
-			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+			pxCurrentTCB->ucNotifyState[ uxIndexToWait ] = taskNOT_WAITING_NOTIFICATION;
 		}
 		taskEXIT_CRITICAL();
 
@@ -4715,12 +7510,13 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue )
+	BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue )
 	{
 	TCB_t * pxTCB;
 	BaseType_t xReturn = pdPASS;
 	uint8_t ucOriginalNotifyState;
 
+		configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
 		configASSERT( xTaskToNotify );
 		pxTCB = xTaskToNotify;
 
@@ -4728,31 +7524,31 @@ TickType_t uxReturn;
 		{
 			if( pulPreviousNotificationValue != NULL )
 			{
-				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue[ uxIndexToNotify ];
 			}
 
-			ucOriginalNotifyState = pxTCB->ucNotifyState;
+			ucOriginalNotifyState = pxTCB->ucNotifyState[ uxIndexToNotify ];
 
-			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+			pxTCB->ucNotifyState[ uxIndexToNotify ] = taskNOTIFICATION_RECEIVED;
 
 			switch( eAction )
 			{
 				case eSetBits	:
-					pxTCB->ulNotifiedValue |= ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] |= ulValue;
 					break;
 
 				case eIncrement	:
-					( pxTCB->ulNotifiedValue )++;
+					( pxTCB->ulNotifiedValue[ uxIndexToNotify ] )++;
 					break;
 
 				case eSetValueWithOverwrite	:
-					pxTCB->ulNotifiedValue = ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					break;
 
 				case eSetValueWithoutOverwrite :
 					if( ucOriginalNotifyState != taskNOTIFICATION_RECEIVED )
 					{
-						pxTCB->ulNotifiedValue = ulValue;
+						pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					}
 					else
 					{
@@ -4770,7 +7566,7 @@ TickType_t uxReturn;
 					/* Should not get here if all enums are handled.
 					Artificially force an assert by testing a value the
 					compiler can't assume is const. */
-					configASSERT( pxTCB->ulNotifiedValue == ~0UL );
+					configASSERT( pxTCB->ulNotifiedValue[ uxIndexToNotify ] == ~0UL );
 
 					break;
 			}
@@ -4829,7 +7625,7 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue, BaseType_t *pxHigherPriorityTaskWoken )
+	BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue, BaseType_t *pxHigherPriorityTaskWoken )
 	{
 	TCB_t * pxTCB;
 	uint8_t ucOriginalNotifyState;
@@ -4837,6 +7633,7 @@ TickType_t uxReturn;
 	UBaseType_t uxSavedInterruptStatus;
 
 		configASSERT( xTaskToNotify );
+		configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
 
 		/* RTOS ports that support interrupt nesting have the concept of a
 		maximum	system call (or maximum API call) interrupt priority.
@@ -4862,30 +7659,30 @@ TickType_t uxReturn;
 		{
 			if( pulPreviousNotificationValue != NULL )
 			{
-				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue[ uxIndexToNotify ];
 			}
 
-			ucOriginalNotifyState = pxTCB->ucNotifyState;
-			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+			ucOriginalNotifyState = pxTCB->ucNotifyState[ uxIndexToNotify ];
+			pxTCB->ucNotifyState[ uxIndexToNotify ] = taskNOTIFICATION_RECEIVED;
 
 			switch( eAction )
 			{
 				case eSetBits	:
-					pxTCB->ulNotifiedValue |= ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] |= ulValue;
 					break;
 
 				case eIncrement	:
-					( pxTCB->ulNotifiedValue )++;
+					( pxTCB->ulNotifiedValue[ uxIndexToNotify ] )++;
 					break;
 
 				case eSetValueWithOverwrite	:
-					pxTCB->ulNotifiedValue = ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					break;
 
 				case eSetValueWithoutOverwrite :
 					if( ucOriginalNotifyState != taskNOTIFICATION_RECEIVED )
 					{
-						pxTCB->ulNotifiedValue = ulValue;
+						pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					}
 					else
 					{
@@ -4903,7 +7700,7 @@ TickType_t uxReturn;
 					/* Should not get here if all enums are handled.
 					Artificially force an assert by testing a value the
 					compiler can't assume is const. */
-					configASSERT( pxTCB->ulNotifiedValue == ~0UL );
+					configASSERT( pxTCB->ulNotifiedValue[ uxIndexToNotify ] == ~0UL );
 					break;
 			}
 
@@ -4958,13 +7755,14 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken )
+	void vTaskGenericNotifyGiveFromISR( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, BaseType_t *pxHigherPriorityTaskWoken )
 	{
 	TCB_t * pxTCB;
 	uint8_t ucOriginalNotifyState;
 	UBaseType_t uxSavedInterruptStatus;
 
 		configASSERT( xTaskToNotify );
+		configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
 
 		/* RTOS ports that support interrupt nesting have the concept of a
 		maximum	system call (or maximum API call) interrupt priority.
@@ -4988,12 +7786,12 @@ TickType_t uxReturn;
 
 		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
 		{
-			ucOriginalNotifyState = pxTCB->ucNotifyState;
-			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+			ucOriginalNotifyState = pxTCB->ucNotifyState[ uxIndexToNotify ];
+			pxTCB->ucNotifyState[ uxIndexToNotify ] = taskNOTIFICATION_RECEIVED;
 
 			/* 'Giving' is equivalent to incrementing a count in a counting
 			semaphore. */
-			( pxTCB->ulNotifiedValue )++;
+			( pxTCB->ulNotifiedValue[ uxIndexToNotify ] )++;
 
 			traceTASK_NOTIFY_GIVE_FROM_ISR();
 
@@ -5045,20 +7843,22 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskNotifyStateClear( TaskHandle_t xTask )
+	BaseType_t xTaskGenericNotifyStateClear( TaskHandle_t xTask, UBaseType_t uxIndexToClear )
 	{
 	TCB_t *pxTCB;
 	BaseType_t xReturn;
 
+		configASSERT( uxIndexToClear < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+
 		/* If null is passed in here then it is the calling task that is having
 		its notification state cleared. */
 		pxTCB = prvGetTCBFromHandle( xTask );
 
 		taskENTER_CRITICAL();
 		{
-			if( pxTCB->ucNotifyState == taskNOTIFICATION_RECEIVED )
+			if( pxTCB->ucNotifyState[ uxIndexToClear ] == taskNOTIFICATION_RECEIVED )
 			{
-				pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+				pxTCB->ucNotifyState[ uxIndexToClear ] = taskNOT_WAITING_NOTIFICATION;
 				xReturn = pdPASS;
 			}
 			else
@@ -5074,6 +7874,34 @@ TickType_t uxReturn;
 #endif /* configUSE_TASK_NOTIFICATIONS */
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	uint32_t ulTaskGenericNotifyValueClear( TaskHandle_t xTask, UBaseType_t uxIndexToClear, uint32_t ulBitsToClear )
+	{
+	TCB_t *pxTCB;
+	uint32_t ulReturn;
+
+		configASSERT( uxIndexToClear < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+
+		/* If null is passed in here then it is the calling task that is having
+		its notification value cleared. */
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		taskENTER_CRITICAL();
+		{
+			/* Return the notification as it was before the bits were cleared,
+			then clear the bit mask. */
+			ulReturn = pxTCB->ulNotifiedValue[ uxIndexToClear ];
+			pxTCB->ulNotifiedValue[ uxIndexToClear ] &= ~ulBitsToClear;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
 #if( ( configGENERATE_RUN_TIME_STATS == 1 ) && ( INCLUDE_xTaskGetIdleTaskHandle == 1 ) )
 	TickType_t xTaskGetIdleRunTimeCounter( void )
 	{
@@ -5132,13 +7960,13 @@ const TickType_t xConstTickCount = xTickCount;
 			{
 				/* Wake time has overflowed.  Place this item in the overflow
 				list. */
-				vListInsert( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+				taskINSERT_OVERFLOW_DELAYED( &( pxCurrentTCB->xStateListItem ) );
 			}
 			else
 			{
 				/* The wake time has not overflowed, so the current block list
 				is used. */
-				vListInsert( pxDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+				taskINSERT_DELAYED( &( pxCurrentTCB->xStateListItem ) );
 
 				/* If the task entering the blocked state was placed at the
 				head of the list of blocked tasks then xNextTaskUnblockTime
@@ -5167,12 +7995,12 @@ const TickType_t xConstTickCount = xTickCount;
 		if( xTimeToWake < xConstTickCount )
 		{
 			/* Wake time has overflowed.  Place this item in the overflow list. */
-			vListInsert( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+			taskINSERT_OVERFLOW_DELAYED( &( pxCurrentTCB->xStateListItem ) );
 		}
 		else
 		{
 			/* The wake time has not overflowed, so the current block list is used. */
-			vListInsert( pxDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+			taskINSERT_DELAYED( &( pxCurrentTCB->xStateListItem ) );
 
 			/* If the task entering the blocked state was placed at the head of the
 			list of blocked tasks then xNextTaskUnblockTime needs to be updated
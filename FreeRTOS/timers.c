@@ -69,6 +69,26 @@ defining trmTIMER_SERVICE_TASK_NAME in FreeRTOSConfig.h. */
 #define tmrSTATUS_IS_STATICALLY_ALLOCATED	( ( uint8_t ) 0x02 )
 #define tmrSTATUS_IS_AUTORELOAD				( ( uint8_t ) 0x04 )
 
+#if( configUSE_TIMER_WHEEL == 1 )
+	/* Geometry of the timer wheel, see prvWheelPlace(). */
+	#define tmrWHEEL_LEVELS			( ( UBaseType_t ) configTIMER_WHEEL_LEVELS )
+	#define tmrWHEEL_SLOT_BITS		( ( UBaseType_t ) configTIMER_WHEEL_SLOT_BITS )
+	#define tmrWHEEL_SLOTS			( ( UBaseType_t ) 1U << tmrWHEEL_SLOT_BITS )
+	#define tmrWHEEL_SLOT_MASK		( tmrWHEEL_SLOTS - ( UBaseType_t ) 1U )
+	#define tmrWHEEL_HORIZON_BITS	( tmrWHEEL_LEVELS * tmrWHEEL_SLOT_BITS )
+
+	/* Expiry times are handled as distances from the wheel's own time, and a
+	distance of more than half the tick range is taken to be in the past.  No
+	period may therefore be longer than that. */
+	#define tmrWHEEL_MAX_PERIOD		( portMAX_DELAY / ( TickType_t ) 2U )
+#endif
+
+#if( configUSE_TIMER_BATCH_COMMANDS == 1 )
+	/* Set in the message ID of a command that applies to an array of timers
+	rather than to one timer. */
+	#define tmrBATCH_COMMAND_BIT	( ( BaseType_t ) 0x100 )
+#endif
+
 /* The definition of the timers themselves. */
 typedef struct tmrTimerControl /* The old naming convention is used to prevent breaking kernel aware debuggers. */
 {
@@ -98,6 +118,14 @@ typedef struct tmrTimerParameters
 	Timer_t *			pxTimer;			/*<< The timer to which the command will be applied. */
 } TimerParameter_t;
 
+#if( configUSE_TIMER_BATCH_COMMANDS == 1 )
+	typedef struct tmrTimerBatchParameters
+	{
+		TickType_t			xMessageValue;		/*<< As for TimerParameter_t, shared by every timer in the batch. */
+		TimerHandle_t const *pxTimers;			/*<< The timers, owned by the sender until the command is processed. */
+		UBaseType_t			uxCount;			/*<< The number of timers in pxTimers. */
+	} TimerBatchParameter_t;
+#endif /* configUSE_TIMER_BATCH_COMMANDS */
 
 typedef struct tmrCallbackParameters
 {
@@ -115,6 +143,10 @@ typedef struct tmrTimerQueueMessage
 	{
 		TimerParameter_t xTimerParameters;
 
+		#if ( configUSE_TIMER_BATCH_COMMANDS == 1 )
+			TimerBatchParameter_t xBatchParameters;
+		#endif /* configUSE_TIMER_BATCH_COMMANDS */
+
 		/* Don't include xCallbackParameters if it is not going to be used as
 		it makes the structure (and therefore the timer queue) larger. */
 		#if ( INCLUDE_xTimerPendFunctionCall == 1 )
@@ -126,16 +158,38 @@ typedef struct tmrTimerQueueMessage
 /*lint -save -e956 A manual analysis and inspection has been used to determine
 which static variables must be declared volatile. */
 
-/* The list in which active timers are stored.  Timers are referenced in expire
-time order, with the nearest expiry time at the front of the list.  Only the
-timer service task is allowed to access these lists.
-xActiveTimerList1 and xActiveTimerList2 could be at function scope but that
-breaks some kernel aware debuggers, and debuggers that reply on removing the
-static qualifier. */
-PRIVILEGED_DATA static List_t xActiveTimerList1;
-PRIVILEGED_DATA static List_t xActiveTimerList2;
-PRIVILEGED_DATA static List_t *pxCurrentTimerList;
-PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	/* The hierarchical timer wheel in which active timers are stored.  Level
+	n has a slot for each 2 ^ ( n * tmrWHEEL_SLOT_BITS ) ticks, and a timer is
+	placed in the lowest level that reaches its expiry time, so inserting and
+	removing a timer is O(1) however many are active.  Slots are unsorted.
+	Timers beyond the reach of the top level wait in xTimerWheelOverflow.
+	Each bit of ulWheelOccupied[ n ] is set while the matching slot of level n
+	holds a timer.  Only the timer service task is allowed to access these. */
+	PRIVILEGED_DATA static List_t xTimerWheel[ tmrWHEEL_LEVELS ][ tmrWHEEL_SLOTS ];
+	PRIVILEGED_DATA static List_t xTimerWheelOverflow;
+	PRIVILEGED_DATA static uint32_t ulWheelOccupied[ tmrWHEEL_LEVELS ];
+
+	/* The tick up to which the wheel has been processed, and the number of
+	timers it holds. */
+	PRIVILEGED_DATA static TickType_t xWheelTime = ( TickType_t ) 0U;
+	PRIVILEGED_DATA static UBaseType_t uxWheelTimers = ( UBaseType_t ) 0U;
+
+#else
+
+	/* The list in which active timers are stored.  Timers are referenced in expire
+	time order, with the nearest expiry time at the front of the list.  Only the
+	timer service task is allowed to access these lists.
+	xActiveTimerList1 and xActiveTimerList2 could be at function scope but that
+	breaks some kernel aware debuggers, and debuggers that reply on removing the
+	static qualifier. */
+	PRIVILEGED_DATA static List_t xActiveTimerList1;
+	PRIVILEGED_DATA static List_t xActiveTimerList2;
+	PRIVILEGED_DATA static List_t *pxCurrentTimerList;
+	PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
@@ -175,22 +229,70 @@ static portTASK_FUNCTION_PROTO( prvTimerTask, pvParameters ) PRIVILEGED_FUNCTION
 static void prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
 
 /*
- * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
- * depending on if the expire time causes a timer counter overflow.
+ * Apply one timer command, received either on its own or as part of a batch.
  */
-static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
+static void prvProcessTimerCommand( const BaseType_t xCommandID, Timer_t * const pxTimer, const TickType_t xMessageValue ) PRIVILEGED_FUNCTION;
 
 /*
- * An active timer has reached its expire time.  Reload the timer if it is an
- * auto reload timer, then call its callback.
+ * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
+ * depending on if the expire time causes a timer counter overflow.  With the
+ * timer wheel, insert it in the wheel instead.  Returns pdTRUE if the timer
+ * has already expired and must be processed now.
  */
-static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
 
 /*
- * The tick count has overflowed.  Switch the timer lists after ensuring the
- * current timer list does not still reference some timers.
+ * Take an active timer out of whichever list or wheel slot holds it.
  */
-static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	/*
+	 * An active timer has reached its expire time.  Reload the timer if it is
+	 * an auto reload timer, then call its callback.
+	 */
+	static void prvProcessExpiredTimer( Timer_t * const pxTimer, const TickType_t xExpiryTime ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Put a timer in the wheel slot that covers xExpiryTime, which must not be
+	 * before xWheelTime.
+	 */
+	static void prvWheelPlace( Timer_t * const pxTimer, const TickType_t xExpiryTime ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Re-place every timer in a slot or the overflow list relative to the
+	 * wheel's current time, moving each closer to level 0.
+	 */
+	static void prvWheelCascade( List_t * const pxList ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The next tick at which the wheel has work to do, either expiring timers
+	 * or cascading a slot.  Only valid while the wheel holds a timer.
+	 */
+	static TickType_t prvWheelNextEvent( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Process the wheel up to and including xTimeNow, skipping straight over
+	 * ticks at which there is nothing to do.
+	 */
+	static void prvWheelAdvance( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+#else
+
+	/*
+	 * An active timer has reached its expire time.  Reload the timer if it is an
+	 * auto reload timer, then call its callback.
+	 */
+	static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The tick count has overflowed.  Switch the timer lists after ensuring the
+	 * current timer list does not still reference some timers.
+	 */
+	static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /*
  * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
@@ -356,6 +458,12 @@ static void prvInitialiseNewTimer(	const char * const pcTimerName,			/*lint !e97
 	/* 0 is not a valid value for xTimerPeriodInTicks. */
 	configASSERT( ( xTimerPeriodInTicks > 0 ) );
 
+	#if( configUSE_TIMER_WHEEL == 1 )
+	{
+		configASSERT( ( xTimerPeriodInTicks <= tmrWHEEL_MAX_PERIOD ) );
+	}
+	#endif
+
 	if( pxNewTimer != NULL )
 	{
 		/* Ensure the infrastructure used by the timer service task has been
@@ -421,6 +529,58 @@ DaemonTaskMessage_t xMessage;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_BATCH_COMMANDS == 1 )
+
+	BaseType_t xTimerGenericCommandBatch( TimerHandle_t const * const pxTimers, const UBaseType_t uxCount, const BaseType_t xCommandID, const TickType_t xOptionalValue, BaseType_t * const pxHigherPriorityTaskWoken, const TickType_t xTicksToWait )
+	{
+	BaseType_t xReturn = pdFAIL;
+	DaemonTaskMessage_t xMessage;
+	UBaseType_t ux;
+
+		configASSERT( pxTimers );
+		configASSERT( ( xCommandID >= tmrCOMMAND_START_DONT_TRACE ) && ( xCommandID < tmrBATCH_COMMAND_BIT ) );
+
+		/* The whole batch travels in one message, so it takes one slot of
+		xTimerQueue however many timers it names. */
+		if( ( xTimerQueue != NULL ) && ( uxCount > ( UBaseType_t ) 0U ) )
+		{
+			xMessage.xMessageID = xCommandID | tmrBATCH_COMMAND_BIT;
+			xMessage.u.xBatchParameters.xMessageValue = xOptionalValue;
+			xMessage.u.xBatchParameters.pxTimers = pxTimers;
+			xMessage.u.xBatchParameters.uxCount = uxCount;
+
+			if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+			{
+				if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
+				{
+					xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+				}
+				else
+				{
+					xReturn = xQueueSendToBack( xTimerQueue, &xMessage, tmrNO_DELAY );
+				}
+			}
+			else
+			{
+				xReturn = xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
+			}
+
+			for( ux = ( UBaseType_t ) 0U; ux < uxCount; ux++ )
+			{
+				traceTIMER_COMMAND_SEND( pxTimers[ ux ], xCommandID, xOptionalValue, xReturn );
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TIMER_BATCH_COMMANDS */
+/*-----------------------------------------------------------*/
+
 TaskHandle_t xTimerGetTimerDaemonTaskHandle( void )
 {
 	/* If xTimerGetTimerDaemonTaskHandle() is called before the scheduler has been
@@ -479,46 +639,6 @@ Timer_t *pxTimer = xTimer;
 }
 /*-----------------------------------------------------------*/
 
-static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow )
-{
-BaseType_t xResult;
-Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
-
-	/* Remove the timer from the list of active timers.  A check has already
-	been performed to ensure the list is not empty. */
-	( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
-	traceTIMER_EXPIRED( pxTimer );
-
-	/* If the timer is an auto reload timer then calculate the next
-	expiry time and re-insert the timer in the list of active timers. */
-	if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
-	{
-		/* The timer is inserted into a list using a time relative to anything
-		other than the current time.  It will therefore be inserted into the
-		correct list relative to the time this task thinks it is now. */
-		if( prvInsertTimerInActiveList( pxTimer, ( xNextExpireTime + pxTimer->xTimerPeriodInTicks ), xTimeNow, xNextExpireTime ) != pdFALSE )
-		{
-			/* The timer expired before it was added to the active timer
-			list.  Reload it now.  */
-			xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xNextExpireTime, NULL, tmrNO_DELAY );
-			configASSERT( xResult );
-			( void ) xResult;
-		}
-		else
-		{
-			mtCOVERAGE_TEST_MARKER();
-		}
-	}
-	else
-	{
-		pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
-		mtCOVERAGE_TEST_MARKER();
-	}
-
-	/* Call the timer callback. */
-	pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
-}
-/*-----------------------------------------------------------*/
 
 static portTASK_FUNCTION( prvTimerTask, pvParameters )
 {
@@ -556,42 +676,315 @@ BaseType_t xListWasEmpty;
 }
 /*-----------------------------------------------------------*/
 
-static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
-{
-TickType_t xTimeNow;
-BaseType_t xTimerListsWereSwitched;
+#if( configUSE_TIMER_WHEEL == 0 )
 
-	vTaskSuspendAll();
+	static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow )
 	{
-		/* Obtain the time now to make an assessment as to whether the timer
-		has expired or not.  If obtaining the time causes the lists to switch
-		then don't process this timer as any timers that remained in the list
-		when the lists were switched will have been processed within the
-		prvSampleTimeNow() function. */
-		xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
-		if( xTimerListsWereSwitched == pdFALSE )
+	BaseType_t xResult;
+	Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+
+		/* Remove the timer from the list of active timers.  A check has already
+		been performed to ensure the list is not empty. */
+		( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+		traceTIMER_EXPIRED( pxTimer );
+
+		/* If the timer is an auto reload timer then calculate the next
+		expiry time and re-insert the timer in the list of active timers. */
+		if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
+		{
+			/* The timer is inserted into a list using a time relative to anything
+			other than the current time.  It will therefore be inserted into the
+			correct list relative to the time this task thinks it is now. */
+			if( prvInsertTimerInActiveList( pxTimer, ( xNextExpireTime + pxTimer->xTimerPeriodInTicks ), xTimeNow, xNextExpireTime ) != pdFALSE )
+			{
+				/* The timer expired before it was added to the active timer
+				list.  Reload it now.  */
+				xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xNextExpireTime, NULL, tmrNO_DELAY );
+				configASSERT( xResult );
+				( void ) xResult;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
 		{
-			/* The tick count has not overflowed, has the timer expired? */
-			if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
+			pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Call the timer callback. */
+		pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+	}
+
+	/*-----------------------------------------------------------*/
+
+	static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
+	{
+	TickType_t xTimeNow;
+	BaseType_t xTimerListsWereSwitched;
+
+		vTaskSuspendAll();
+		{
+			/* Obtain the time now to make an assessment as to whether the timer
+			has expired or not.  If obtaining the time causes the lists to switch
+			then don't process this timer as any timers that remained in the list
+			when the lists were switched will have been processed within the
+			prvSampleTimeNow() function. */
+			xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+			if( xTimerListsWereSwitched == pdFALSE )
+			{
+				/* The tick count has not overflowed, has the timer expired? */
+				if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
+				{
+					( void ) xTaskResumeAll();
+					prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+				}
+				else
+				{
+					/* The tick count has not overflowed, and the next expire
+					time has not been reached yet.  This task should therefore
+					block to wait for the next expire time or a command to be
+					received - whichever comes first.  The following line cannot
+					be reached unless xNextExpireTime > xTimeNow, except in the
+					case when the current timer list is empty. */
+					if( xListWasEmpty != pdFALSE )
+					{
+						/* The current timer list is empty - is the overflow list
+						also empty? */
+						xListWasEmpty = listLIST_IS_EMPTY( pxOverflowTimerList );
+					}
+
+					vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
+
+					if( xTaskResumeAll() == pdFALSE )
+					{
+						/* Yield to wait for either a command to arrive, or the
+						block time to expire.  If a command arrived between the
+						critical section being exited and this yield then the yield
+						will not cause the task to block. */
+						portYIELD_WITHIN_API();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+			else
 			{
 				( void ) xTaskResumeAll();
-				prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+			}
+		}
+	}
+
+	/*-----------------------------------------------------------*/
+
+	static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
+	{
+	TickType_t xNextExpireTime;
+
+		/* Timers are listed in expiry time order, with the head of the list
+		referencing the task that will expire first.  Obtain the time at which
+		the timer with the nearest expiry time will expire.  If there are no
+		active timers then just set the next expire time to 0.  That will cause
+		this task to unblock when the tick count overflows, at which point the
+		timer lists will be switched and the next expiry time can be
+		re-assessed.  */
+		*pxListWasEmpty = listLIST_IS_EMPTY( pxCurrentTimerList );
+		if( *pxListWasEmpty == pdFALSE )
+		{
+			xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+		}
+		else
+		{
+			/* Ensure the task unblocks when the tick count rolls over. */
+			xNextExpireTime = ( TickType_t ) 0U;
+		}
+
+		return xNextExpireTime;
+	}
+
+	/*-----------------------------------------------------------*/
+
+	static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
+	{
+	TickType_t xTimeNow;
+	PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Variable is only accessible to one task. */
+
+		xTimeNow = xTaskGetTickCount();
+
+		if( xTimeNow < xLastTime )
+		{
+			prvSwitchTimerLists();
+			*pxTimerListsWereSwitched = pdTRUE;
+		}
+		else
+		{
+			*pxTimerListsWereSwitched = pdFALSE;
+		}
+
+		xLastTime = xTimeNow;
+
+		return xTimeNow;
+	}
+
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime )
+	{
+	BaseType_t xProcessTimerNow = pdFALSE;
+
+		listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
+		listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+
+		if( xNextExpiryTime <= xTimeNow )
+		{
+			/* Has the expiry time elapsed between the command to start/reset a
+			timer was issued, and the time the command was processed? */
+			if( ( ( TickType_t ) ( xTimeNow - xCommandTime ) ) >= pxTimer->xTimerPeriodInTicks ) /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+			{
+				/* The time between a command being issued and the command being
+				processed actually exceeds the timers period.  */
+				xProcessTimerNow = pdTRUE;
 			}
 			else
 			{
-				/* The tick count has not overflowed, and the next expire
-				time has not been reached yet.  This task should therefore
-				block to wait for the next expire time or a command to be
-				received - whichever comes first.  The following line cannot
-				be reached unless xNextExpireTime > xTimeNow, except in the
-				case when the current timer list is empty. */
-				if( xListWasEmpty != pdFALSE )
+				vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+			}
+		}
+		else
+		{
+			if( ( xTimeNow < xCommandTime ) && ( xNextExpiryTime >= xCommandTime ) )
+			{
+				/* If, since the command was issued, the tick count has overflowed
+				but the expiry time has not, then the timer must have already passed
+				its expiry time and should be processed immediately. */
+				xProcessTimerNow = pdTRUE;
+			}
+			else
+			{
+				vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+			}
+		}
+
+		return xProcessTimerNow;
+	}
+
+	/*-----------------------------------------------------------*/
+
+	static void prvSwitchTimerLists( void )
+	{
+	TickType_t xNextExpireTime, xReloadTime;
+	List_t *pxTemp;
+	Timer_t *pxTimer;
+	BaseType_t xResult;
+
+		/* The tick count has overflowed.  The timer lists must be switched.
+		If there are any timers still referenced from the current timer list
+		then they must have expired and should be processed before the lists
+		are switched. */
+		while( listLIST_IS_EMPTY( pxCurrentTimerList ) == pdFALSE )
+		{
+			xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+
+			/* Remove the timer from the list. */
+			pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+			( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+			traceTIMER_EXPIRED( pxTimer );
+
+			/* Execute its callback, then send a command to restart the timer if
+			it is an auto-reload timer.  It cannot be restarted here as the lists
+			have not yet been switched. */
+			pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+
+			if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
+			{
+				/* Calculate the reload value, and if the reload value results in
+				the timer going into the same timer list then it has already expired
+				and the timer should be re-inserted into the current list so it is
+				processed again within this loop.  Otherwise a command should be sent
+				to restart the timer to ensure it is only inserted into a list after
+				the lists have been swapped. */
+				xReloadTime = ( xNextExpireTime + pxTimer->xTimerPeriodInTicks );
+				if( xReloadTime > xNextExpireTime )
+				{
+					listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xReloadTime );
+					listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+					vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+				}
+				else
 				{
-					/* The current timer list is empty - is the overflow list
-					also empty? */
-					xListWasEmpty = listLIST_IS_EMPTY( pxOverflowTimerList );
+					xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xNextExpireTime, NULL, tmrNO_DELAY );
+					configASSERT( xResult );
+					( void ) xResult;
 				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		pxTemp = pxCurrentTimerList;
+		pxCurrentTimerList = pxOverflowTimerList;
+		pxOverflowTimerList = pxTemp;
+	}
 
+	/*-----------------------------------------------------------*/
+
+	static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer )
+	{
+		( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+	}
+
+#else /* configUSE_TIMER_WHEEL */
+
+	static void prvProcessExpiredTimer( Timer_t * const pxTimer, const TickType_t xExpiryTime )
+	{
+		/* Remove the timer from the wheel.  It is due exactly now, so an auto
+		reload timer goes straight back in one period on and cannot already
+		have expired again. */
+		prvRemoveTimerFromActiveList( pxTimer );
+		traceTIMER_EXPIRED( pxTimer );
+
+		if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
+		{
+			listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), ( xExpiryTime + pxTimer->xTimerPeriodInTicks ) );
+			prvWheelPlace( pxTimer, ( xExpiryTime + pxTimer->xTimerPeriodInTicks ) );
+		}
+		else
+		{
+			pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Call the timer callback. */
+		pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
+	{
+	TickType_t xTimeNow;
+
+		vTaskSuspendAll();
+		{
+			/* The wheel measures everything from its own time, so unlike the
+			timer lists it needs no special handling when the tick count
+			overflows.  Whatever is due is processed in one go. */
+			xTimeNow = xTaskGetTickCount();
+			if( ( xListWasEmpty == pdFALSE ) && ( ( TickType_t ) ( xTimeNow - xNextExpireTime ) <= tmrWHEEL_MAX_PERIOD ) )
+			{
+				( void ) xTaskResumeAll();
+				prvWheelAdvance( xTimeNow );
+			}
+			else
+			{
+				/* Block until the wheel next has work to do, which may be a
+				cascade rather than an expiry, or until a command arrives.
+				With nothing in the wheel, block indefinitely. */
 				vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
 
 				if( xTaskResumeAll() == pdFALSE )
@@ -608,110 +1001,250 @@ BaseType_t xTimerListsWereSwitched;
 				}
 			}
 		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
+	{
+	TickType_t xNextExpireTime;
+
+		*pxListWasEmpty = ( uxWheelTimers == ( UBaseType_t ) 0U ) ? pdTRUE : pdFALSE;
+		if( *pxListWasEmpty == pdFALSE )
+		{
+			xNextExpireTime = prvWheelNextEvent();
+		}
 		else
 		{
-			( void ) xTaskResumeAll();
+			xNextExpireTime = ( TickType_t ) 0U;
 		}
-	}
-}
-/*-----------------------------------------------------------*/
 
-static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
-{
-TickType_t xNextExpireTime;
+		return xNextExpireTime;
+	}
+	/*-----------------------------------------------------------*/
 
-	/* Timers are listed in expiry time order, with the head of the list
-	referencing the task that will expire first.  Obtain the time at which
-	the timer with the nearest expiry time will expire.  If there are no
-	active timers then just set the next expire time to 0.  That will cause
-	this task to unblock when the tick count overflows, at which point the
-	timer lists will be switched and the next expiry time can be
-	re-assessed.  */
-	*pxListWasEmpty = listLIST_IS_EMPTY( pxCurrentTimerList );
-	if( *pxListWasEmpty == pdFALSE )
+	static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
 	{
-		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+		/* There are no timer lists to switch. */
+		*pxTimerListsWereSwitched = pdFALSE;
+		return xTaskGetTickCount();
 	}
-	else
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime )
 	{
-		/* Ensure the task unblocks when the tick count rolls over. */
-		xNextExpireTime = ( TickType_t ) 0U;
-	}
+	BaseType_t xProcessTimerNow = pdFALSE;
+	TickType_t xDistance;
 
-	return xNextExpireTime;
-}
-/*-----------------------------------------------------------*/
+		/* The wheel's own time takes the place of the command time: the timer
+		has expired if its expiry time is not after the point the wheel has
+		been processed up to. */
+		( void ) xCommandTime;
 
-static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
-{
-TickType_t xTimeNow;
-PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Variable is only accessible to one task. */
+		listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
+		listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
 
-	xTimeNow = xTaskGetTickCount();
+		/* An empty wheel has nothing to catch up on, so its time can jump
+		straight to now however long it has been idle. */
+		if( uxWheelTimers == ( UBaseType_t ) 0U )
+		{
+			xWheelTime = xTimeNow;
+		}
 
-	if( xTimeNow < xLastTime )
-	{
-		prvSwitchTimerLists();
-		*pxTimerListsWereSwitched = pdTRUE;
-	}
-	else
-	{
-		*pxTimerListsWereSwitched = pdFALSE;
-	}
+		xDistance = ( TickType_t ) ( xNextExpiryTime - xWheelTime );
+		if( ( xDistance == ( TickType_t ) 0U ) || ( xDistance > tmrWHEEL_MAX_PERIOD ) )
+		{
+			xProcessTimerNow = pdTRUE;
+		}
+		else
+		{
+			prvWheelPlace( pxTimer, xNextExpiryTime );
+		}
 
-	xLastTime = xTimeNow;
+		return xProcessTimerNow;
+	}
+	/*-----------------------------------------------------------*/
 
-	return xTimeNow;
-}
-/*-----------------------------------------------------------*/
+	static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer )
+	{
+	List_t * const pxList = listLIST_ITEM_CONTAINER( &( pxTimer->xTimerListItem ) );
+	UBaseType_t uxIndex;
 
-static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime )
-{
-BaseType_t xProcessTimerNow = pdFALSE;
+		if( ( uxListRemove( &( pxTimer->xTimerListItem ) ) == ( UBaseType_t ) 0U ) && ( pxList != &xTimerWheelOverflow ) )
+		{
+			/* The slot is now empty.  Slots are stored level by level, so its
+			position in the array gives both. */
+			uxIndex = ( UBaseType_t ) ( pxList - &( xTimerWheel[ 0 ][ 0 ] ) );
+			ulWheelOccupied[ uxIndex >> tmrWHEEL_SLOT_BITS ] &= ~( 1UL << ( uxIndex & tmrWHEEL_SLOT_MASK ) );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
 
-	listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
-	listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+		uxWheelTimers--;
+	}
+	/*-----------------------------------------------------------*/
 
-	if( xNextExpiryTime <= xTimeNow )
+	static void prvWheelPlace( Timer_t * const pxTimer, const TickType_t xExpiryTime )
 	{
-		/* Has the expiry time elapsed between the command to start/reset a
-		timer was issued, and the time the command was processed? */
-		if( ( ( TickType_t ) ( xTimeNow - xCommandTime ) ) >= pxTimer->xTimerPeriodInTicks ) /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+	const TickType_t xDistance = ( TickType_t ) ( xExpiryTime - xWheelTime );
+	UBaseType_t uxLevel = ( UBaseType_t ) 0U, uxShift = ( UBaseType_t ) 0U, uxSlot;
+	List_t *pxList;
+
+		/* Use the lowest level whose slots still reach the expiry time.  The
+		slot is picked from the expiry time itself, not from the distance, so
+		that it is found again when the wheel's time reaches the start of the
+		slot.  The distance is then at least one slot of this level, which
+		means that start cannot already have passed. */
+		while( ( uxLevel < tmrWHEEL_LEVELS ) && ( ( xDistance >> ( uxShift + tmrWHEEL_SLOT_BITS ) ) != ( TickType_t ) 0U ) )
 		{
-			/* The time between a command being issued and the command being
-			processed actually exceeds the timers period.  */
-			xProcessTimerNow = pdTRUE;
+			uxLevel++;
+			uxShift += tmrWHEEL_SLOT_BITS;
+		}
+
+		if( uxLevel < tmrWHEEL_LEVELS )
+		{
+			uxSlot = ( UBaseType_t ) ( xExpiryTime >> uxShift ) & tmrWHEEL_SLOT_MASK;
+			pxList = &( xTimerWheel[ uxLevel ][ uxSlot ] );
+			ulWheelOccupied[ uxLevel ] |= ( 1UL << uxSlot );
 		}
 		else
 		{
-			vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+			pxList = &xTimerWheelOverflow;
 		}
+
+		vListInsertEnd( pxList, &( pxTimer->xTimerListItem ) );
+		uxWheelTimers++;
 	}
-	else
+	/*-----------------------------------------------------------*/
+
+	static void prvWheelCascade( List_t * const pxList )
 	{
-		if( ( xTimeNow < xCommandTime ) && ( xNextExpiryTime >= xCommandTime ) )
+	UBaseType_t uxCount;
+	Timer_t *pxTimer;
+
+		/* A timer in the overflow list may go straight back into it, so only
+		the timers that were there to begin with are visited. */
+		for( uxCount = listCURRENT_LIST_LENGTH( pxList ); uxCount > ( UBaseType_t ) 0U; uxCount-- )
 		{
-			/* If, since the command was issued, the tick count has overflowed
-			but the expiry time has not, then the timer must have already passed
-			its expiry time and should be processed immediately. */
-			xProcessTimerNow = pdTRUE;
+			pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+			prvRemoveTimerFromActiveList( pxTimer );
+			prvWheelPlace( pxTimer, listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) );
 		}
-		else
+	}
+	/*-----------------------------------------------------------*/
+
+	static TickType_t prvWheelNextEvent( void )
+	{
+	TickType_t xNearest = portMAX_DELAY, xDistance, xTurns;
+	UBaseType_t uxLevel, uxShift, uxFirst, uxOffset;
+	uint32_t ulRotated;
+
+		for( uxLevel = ( UBaseType_t ) 0U, uxShift = ( UBaseType_t ) 0U; uxLevel < tmrWHEEL_LEVELS; uxLevel++, uxShift += tmrWHEEL_SLOT_BITS )
+		{
+			if( ulWheelOccupied[ uxLevel ] == 0UL )
+			{
+				continue;
+			}
+
+			/* Rotate the occupied mask so that bit 0 is the slot after the
+			current one.  The current slot itself comes last, as anything in it
+			is a whole turn of this level away.  Bits rotated in above the top
+			slot duplicate ones below it, so cannot be the lowest set bit. */
+			xTurns = xWheelTime >> uxShift;
+			uxFirst = ( ( UBaseType_t ) xTurns + ( UBaseType_t ) 1U ) & tmrWHEEL_SLOT_MASK;
+			ulRotated = ulWheelOccupied[ uxLevel ];
+			if( uxFirst != ( UBaseType_t ) 0U )
+			{
+				ulRotated = ( ulRotated >> uxFirst ) | ( ulRotated << ( tmrWHEEL_SLOTS - uxFirst ) );
+			}
+
+			#if defined( __GNUC__ )
+			{
+				uxOffset = ( UBaseType_t ) 1U + ( UBaseType_t ) __builtin_ctz( ulRotated );
+			}
+			#else
+			{
+				for( uxOffset = ( UBaseType_t ) 1U; ( ulRotated & 1UL ) == 0UL; uxOffset++ )
+				{
+					ulRotated >>= 1;
+				}
+			}
+			#endif
+
+			/* The slot's start, which for level 0 is its expiry time and for
+			higher levels is when it cascades. */
+			xDistance = ( TickType_t ) ( ( ( xTurns + ( TickType_t ) uxOffset ) << uxShift ) - xWheelTime );
+			if( xDistance < xNearest )
+			{
+				xNearest = xDistance;
+			}
+		}
+
+		/* The overflow list is looked at again each time the top level
+		completes a turn. */
+		if( listLIST_IS_EMPTY( &xTimerWheelOverflow ) == pdFALSE )
 		{
-			vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+			xDistance = ( TickType_t ) ( ( ( ( xWheelTime >> tmrWHEEL_HORIZON_BITS ) + ( TickType_t ) 1U ) << tmrWHEEL_HORIZON_BITS ) - xWheelTime );
+			if( xDistance < xNearest )
+			{
+				xNearest = xDistance;
+			}
 		}
+
+		return xWheelTime + xNearest;
 	}
+	/*-----------------------------------------------------------*/
 
-	return xProcessTimerNow;
-}
+	static void prvWheelAdvance( const TickType_t xTimeNow )
+	{
+	TickType_t xEvent;
+	UBaseType_t uxLevel, uxCount;
+	List_t *pxList;
+
+		while( uxWheelTimers > ( UBaseType_t ) 0U )
+		{
+			xEvent = prvWheelNextEvent();
+			if( ( TickType_t ) ( xEvent - xWheelTime ) > ( TickType_t ) ( xTimeNow - xWheelTime ) )
+			{
+				break;
+			}
+
+			xWheelTime = xEvent;
+
+			/* Cascade from the top down, so a timer that is due now drops
+			through every level in this one step. */
+			if( ( xEvent & ( ( ( TickType_t ) 1U << tmrWHEEL_HORIZON_BITS ) - ( TickType_t ) 1U ) ) == ( TickType_t ) 0U )
+			{
+				prvWheelCascade( &xTimerWheelOverflow );
+			}
+
+			for( uxLevel = tmrWHEEL_LEVELS - ( UBaseType_t ) 1U; uxLevel > ( UBaseType_t ) 0U; uxLevel-- )
+			{
+				if( ( xEvent & ( ( ( TickType_t ) 1U << ( uxLevel * tmrWHEEL_SLOT_BITS ) ) - ( TickType_t ) 1U ) ) == ( TickType_t ) 0U )
+				{
+					prvWheelCascade( &( xTimerWheel[ uxLevel ][ ( UBaseType_t ) ( xEvent >> ( uxLevel * tmrWHEEL_SLOT_BITS ) ) & tmrWHEEL_SLOT_MASK ] ) );
+				}
+			}
+
+			/* Every timer in the level 0 slot is due at exactly this tick. */
+			pxList = &( xTimerWheel[ 0 ][ ( UBaseType_t ) xEvent & tmrWHEEL_SLOT_MASK ] );
+			for( uxCount = listCURRENT_LIST_LENGTH( pxList ); uxCount > ( UBaseType_t ) 0U; uxCount-- )
+			{
+				prvProcessExpiredTimer( ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxList ), xEvent ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too. */
+			}
+		}
+
+		/* Nothing else is due before xTimeNow. */
+		xWheelTime = xTimeNow;
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void	prvProcessReceivedCommands( void )
 {
 DaemonTaskMessage_t xMessage;
-Timer_t *pxTimer;
-BaseType_t xTimerListsWereSwitched, xResult;
-TickType_t xTimeNow;
 
 	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL ) /*lint !e603 xMessage does not have to be initialised as it is passed out, not in, and it is not used unless xQueueReceive() returns pdTRUE. */
 	{
@@ -741,177 +1274,159 @@ TickType_t xTimeNow;
 		function calls. */
 		if( xMessage.xMessageID >= ( BaseType_t ) 0 )
 		{
+			#if ( configUSE_TIMER_BATCH_COMMANDS == 1 )
+			{
+				/* A batch applies the same command to each of its timers in
+				turn. */
+				if( ( xMessage.xMessageID & tmrBATCH_COMMAND_BIT ) != ( BaseType_t ) 0 )
+				{
+					const TimerBatchParameter_t * const pxBatch = &( xMessage.u.xBatchParameters );
+					UBaseType_t ux;
+
+					for( ux = ( UBaseType_t ) 0U; ux < pxBatch->uxCount; ux++ )
+					{
+						prvProcessTimerCommand( ( xMessage.xMessageID & ~tmrBATCH_COMMAND_BIT ), pxBatch->pxTimers[ ux ], pxBatch->xMessageValue );
+					}
+
+					continue;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif /* configUSE_TIMER_BATCH_COMMANDS */
+
 			/* The messages uses the xTimerParameters member to work on a
 			software timer. */
-			pxTimer = xMessage.u.xTimerParameters.pxTimer;
+			prvProcessTimerCommand( xMessage.xMessageID, xMessage.u.xTimerParameters.pxTimer, xMessage.u.xTimerParameters.xMessageValue );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
 
-			if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
-			{
-				/* The timer is in a list, remove it. */
-				( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
-			}
-			else
-			{
-				mtCOVERAGE_TEST_MARKER();
-			}
+static void prvProcessTimerCommand( const BaseType_t xCommandID, Timer_t * const pxTimer, const TickType_t xMessageValue )
+{
+BaseType_t xTimerListsWereSwitched, xResult;
+TickType_t xTimeNow;
 
-			traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
+		if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
+		{
+			/* The timer is in a list, remove it. */
+			prvRemoveTimerFromActiveList( pxTimer );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
 
-			/* In this case the xTimerListsWereSwitched parameter is not used, but
-			it must be present in the function call.  prvSampleTimeNow() must be
-			called after the message is received from xTimerQueue so there is no
-			possibility of a higher priority task adding a message to the message
-			queue with a time that is ahead of the timer daemon task (because it
-			pre-empted the timer daemon task after the xTimeNow value was set). */
-			xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+		traceTIMER_COMMAND_RECEIVED( pxTimer, xCommandID, xMessageValue );
 
-			switch( xMessage.xMessageID )
-			{
-				case tmrCOMMAND_START :
-				case tmrCOMMAND_START_FROM_ISR :
-				case tmrCOMMAND_RESET :
-				case tmrCOMMAND_RESET_FROM_ISR :
-				case tmrCOMMAND_START_DONT_TRACE :
-					/* Start or restart a timer. */
-					pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
-					if( prvInsertTimerInActiveList( pxTimer,  xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.u.xTimerParameters.xMessageValue ) != pdFALSE )
+		/* In this case the xTimerListsWereSwitched parameter is not used, but
+		it must be present in the function call.  prvSampleTimeNow() must be
+		called after the message is received from xTimerQueue so there is no
+		possibility of a higher priority task adding a message to the message
+		queue with a time that is ahead of the timer daemon task (because it
+		pre-empted the timer daemon task after the xTimeNow value was set). */
+		xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+
+		switch( xCommandID )
+		{
+			case tmrCOMMAND_START :
+			case tmrCOMMAND_START_FROM_ISR :
+			case tmrCOMMAND_RESET :
+			case tmrCOMMAND_RESET_FROM_ISR :
+			case tmrCOMMAND_START_DONT_TRACE :
+				/* Start or restart a timer. */
+				pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
+				if( prvInsertTimerInActiveList( pxTimer,  xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessageValue ) != pdFALSE )
+				{
+					/* The timer expired before it was added to the active
+					timer list.  Process it now. */
+					pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+					traceTIMER_EXPIRED( pxTimer );
+
+					if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
 					{
-						/* The timer expired before it was added to the active
-						timer list.  Process it now. */
-						pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
-						traceTIMER_EXPIRED( pxTimer );
-
-						if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
-						{
-							xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
-							configASSERT( xResult );
-							( void ) xResult;
-						}
-						else
-						{
-							mtCOVERAGE_TEST_MARKER();
-						}
+						xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
+						configASSERT( xResult );
+						( void ) xResult;
 					}
 					else
 					{
 						mtCOVERAGE_TEST_MARKER();
 					}
-					break;
-
-				case tmrCOMMAND_STOP :
-				case tmrCOMMAND_STOP_FROM_ISR :
-					/* The timer has already been removed from the active list. */
-					pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
-					break;
-
-				case tmrCOMMAND_CHANGE_PERIOD :
-				case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR :
-					pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
-					pxTimer->xTimerPeriodInTicks = xMessage.u.xTimerParameters.xMessageValue;
-					configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
-
-					/* The new period does not really have a reference, and can
-					be longer or shorter than the old one.  The command time is
-					therefore set to the current time, and as the period cannot
-					be zero the next expiry time can only be in the future,
-					meaning (unlike for the xTimerStart() case above) there is
-					no fail case that needs to be handled here. */
-					( void ) prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
-					break;
-
-				case tmrCOMMAND_DELETE :
-					#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+				break;
+
+			case tmrCOMMAND_STOP :
+			case tmrCOMMAND_STOP_FROM_ISR :
+				/* The timer has already been removed from the active list. */
+				pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+				break;
+
+			case tmrCOMMAND_CHANGE_PERIOD :
+			case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR :
+				pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
+				pxTimer->xTimerPeriodInTicks = xMessageValue;
+				configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
+				#if( configUSE_TIMER_WHEEL == 1 )
+				{
+					configASSERT( ( pxTimer->xTimerPeriodInTicks <= tmrWHEEL_MAX_PERIOD ) );
+				}
+				#endif
+
+				/* The new period does not really have a reference, and can
+				be longer or shorter than the old one.  The command time is
+				therefore set to the current time, and as the period cannot
+				be zero the next expiry time can only be in the future,
+				meaning (unlike for the xTimerStart() case above) there is
+				no fail case that needs to be handled here. */
+				( void ) prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
+				break;
+
+			case tmrCOMMAND_DELETE :
+				#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+				{
+					/* The timer has already been removed from the active list,
+					just free up the memory if the memory was dynamically
+					allocated. */
+					if( ( pxTimer->ucStatus & tmrSTATUS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
 					{
-						/* The timer has already been removed from the active list,
-						just free up the memory if the memory was dynamically
-						allocated. */
-						if( ( pxTimer->ucStatus & tmrSTATUS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
-						{
-							vPortFree( pxTimer );
-						}
-						else
-						{
-							pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
-						}
+						vPortFree( pxTimer );
 					}
-					#else
+					else
 					{
-						/* If dynamic allocation is not enabled, the memory
-						could not have been dynamically allocated. So there is
-						no need to free the memory - just mark the timer as
-						"not active". */
 						pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
 					}
-					#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
-					break;
+				}
+				#else
+				{
+					/* If dynamic allocation is not enabled, the memory
+					could not have been dynamically allocated. So there is
+					no need to free the memory - just mark the timer as
+					"not active". */
+					pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+				}
+				#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+				break;
 
-				default	:
-					/* Don't expect to get here. */
-					break;
-			}
+			default	:
+				/* Don't expect to get here. */
+				break;
 		}
-	}
 }
 /*-----------------------------------------------------------*/
 
-static void prvSwitchTimerLists( void )
-{
-TickType_t xNextExpireTime, xReloadTime;
-List_t *pxTemp;
-Timer_t *pxTimer;
-BaseType_t xResult;
-
-	/* The tick count has overflowed.  The timer lists must be switched.
-	If there are any timers still referenced from the current timer list
-	then they must have expired and should be processed before the lists
-	are switched. */
-	while( listLIST_IS_EMPTY( pxCurrentTimerList ) == pdFALSE )
-	{
-		xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
 
-		/* Remove the timer from the list. */
-		pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
-		( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
-		traceTIMER_EXPIRED( pxTimer );
 
-		/* Execute its callback, then send a command to restart the timer if
-		it is an auto-reload timer.  It cannot be restarted here as the lists
-		have not yet been switched. */
-		pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
 
-		if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
-		{
-			/* Calculate the reload value, and if the reload value results in
-			the timer going into the same timer list then it has already expired
-			and the timer should be re-inserted into the current list so it is
-			processed again within this loop.  Otherwise a command should be sent
-			to restart the timer to ensure it is only inserted into a list after
-			the lists have been swapped. */
-			xReloadTime = ( xNextExpireTime + pxTimer->xTimerPeriodInTicks );
-			if( xReloadTime > xNextExpireTime )
-			{
-				listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xReloadTime );
-				listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
-				vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
-			}
-			else
-			{
-				xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xNextExpireTime, NULL, tmrNO_DELAY );
-				configASSERT( xResult );
-				( void ) xResult;
-			}
-		}
-		else
-		{
-			mtCOVERAGE_TEST_MARKER();
-		}
-	}
 
-	pxTemp = pxCurrentTimerList;
-	pxCurrentTimerList = pxOverflowTimerList;
-	pxOverflowTimerList = pxTemp;
-}
-/*-----------------------------------------------------------*/
+
 
 static void prvCheckForValidListAndQueue( void )
 {
@@ -922,10 +1437,27 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
+			#if( configUSE_TIMER_WHEEL == 1 )
+			{
+			UBaseType_t uxLevel, uxSlot;
+
+				for( uxLevel = ( UBaseType_t ) 0U; uxLevel < tmrWHEEL_LEVELS; uxLevel++ )
+				{
+					for( uxSlot = ( UBaseType_t ) 0U; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
+					{
+						vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+					}
+				}
+				vListInitialise( &xTimerWheelOverflow );
+			}
+			#else
+			{
+				vListInitialise( &xActiveTimerList1 );
+				vListInitialise( &xActiveTimerList2 );
+				pxCurrentTimerList = &xActiveTimerList1;
+				pxOverflowTimerList = &xActiveTimerList2;
+			}
+			#endif /* configUSE_TIMER_WHEEL */
 
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+Turn a UART capture with BINLOG() records back into text.
+
+With binlogENABLE set the firmware sends each BINLOG() site (see
+Core/Inc/binlog.h) as a record instead of a formatted line:
+
+  0xB1, argument count, format offset (2 bytes), timestamp in us (4 bytes),
+  then one 4 byte word per argument, all little endian
+
+With binlogCRC set the count has bit 7 set and the record ends with the
+CRC-32/MPEG-2 of its words, as the CRC unit computes it (Core/Inc/crc.h).
+A record whose checksum does not match is shown as a replacement character
+and the decoder resynchronises on the next byte.
+
+The format offset indexes the .binlog section of the ELF the capture was
+taken with, which the linker scripts keep out of flash.  Plain text in the
+stream, from xLogWrite(), xLogPrintf() or printf(), is passed through as it
+is, and each line that starts with a record is prefixed with its timestamp.
+
+  python3 Tools/binlog_decode.py Debug/Lab4.elf capture.bin [--no-time]
+
+Pass - as the capture to read from stdin, for example from a serial port.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = 0xB1
+CRC_FLAG = 0x80
+HEADER = struct.Struct("<BBHI")
+CONVERSION = re.compile(r"%([-0]*)(\*|\d*)(?:\.(\*|\d*))?(?:hh|h|ll|l|z)?([diuxXpsc%])")
+
+
+def crc32_mpeg2(data):
+    """CRC of little endian words, the last padded with zeros, as crc.c does."""
+    data = data + bytes(-len(data) % 4)
+    crc = 0xFFFFFFFF
+    for word, in struct.iter_unpack("<I", data):
+        crc ^= word
+        for _ in range(32):
+            crc = ((crc << 1) ^ 0x04C11DB7) & 0xFFFFFFFF if crc & 0x80000000 else (crc << 1) & 0xFFFFFFFF
+    return crc
+
+
+def read_formats(path):
+    """Contents of the .binlog section of an ELF32 little endian file."""
+    with open(path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        sys.exit("%s is not a 32 bit little endian ELF file" % path)
+
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(index):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from("<IIIIII", elf, shoff + index * shentsize)
+
+    names = section(shstrndx)
+    for index in range(shnum):
+        name, _, _, _, offset, size = section(index)
+        start = names[4] + name
+        if elf[start:elf.index(b"\0", start)] == b".binlog":
+            return elf[offset:offset + size]
+
+    sys.exit("no .binlog section in %s; built without BINLOG() sites?" % path)
+
+
+def format_string(formats, offset):
+    """The format at an offset, or None if the offset is not the start of one."""
+    if offset >= len(formats) or (offset > 0 and formats[offset - 1] != 0):
+        return None
+    end = formats.find(b"\0", offset)
+    if end < 0:
+        return None
+    return formats[offset:end].decode("ascii", errors="replace")
+
+
+def render(fmt, args):
+    """Format as the firmware's fmt.c would, with every argument a 32 bit word."""
+    words = iter(args)
+
+    def take():
+        return next(words, 0)
+
+    def convert(m):
+        flags, width, precision, kind = m.groups()
+        if kind == "%":
+            return "%"
+        if width == "*":
+            width = take()
+            if width >= 0x80000000:
+                flags += "-"
+                width = 0x100000000 - width
+        width = int(width or 0)
+        if precision == "*":
+            take()
+
+        value = take()
+        if kind in "di":
+            text = str(value - 0x100000000 if value >= 0x80000000 else value)
+        elif kind == "u":
+            text = str(value)
+        elif kind in "xX":
+            text = "%x" % value if kind == "x" else "%X" % value
+        elif kind == "p":
+            text, flags, width = "0x%08x" % value, flags.replace("0", ""), max(width, 10)
+        elif kind == "c":
+            text, flags = chr(value & 0xFF), flags.replace("0", "")
+        else:
+            # Only the address of a string reaches the stream.
+            text, flags = "<string at 0x%08x>" % value, flags.replace("0", "")
+
+        if "-" in flags:
+            return text.ljust(width)
+        if "0" in flags:
+            sign = "-" if text.startswith("-") else ""
+            return sign + text[len(sign):].rjust(width - len(sign), "0")
+        return text.rjust(width)
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(formats, data, out, timestamps):
+    """Write the text of a capture, a record or a run of plain bytes at a time."""
+    at_line_start = True
+    pos = 0
+
+    while pos < len(data):
+        sync = data.find(bytes([SYNC]), pos)
+        if sync < 0:
+            sync = len(data)
+        if sync > pos:
+            text = data[pos:sync].decode("ascii", errors="replace")
+            out.write(text)
+            at_line_start = text.endswith("\n") or text.endswith("\r")
+            pos = sync
+            continue
+
+        fmt = None
+        if pos + HEADER.size <= len(data):
+            _, count, offset, timestamp = HEADER.unpack_from(data, pos)
+            checked = (count & CRC_FLAG) != 0
+            count &= ~CRC_FLAG
+            end = pos + HEADER.size + 4 * count
+            if checked and end + 4 <= len(data):
+                crc, = struct.unpack_from("<I", data, end)
+                if crc == crc32_mpeg2(data[pos:end]):
+                    fmt = format_string(formats, offset)
+                end += 4
+            elif not checked and end <= len(data):
+                fmt = format_string(formats, offset)
+
+        if fmt is None:
+            # A corrupt or cut off record; resynchronise on the next byte.
+            out.write("\ufffd")
+            pos += 1
+            continue
+
+        args = struct.unpack_from("<%dI" % count, data, pos + HEADER.size)
+        text = render(fmt, args)
+        if timestamps and at_line_start:
+            out.write("[%10u us] " % timestamp)
+        out.write(text)
+        at_line_start = text.endswith("\n") or text.endswith("\r")
+        pos = end
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("elf", help="ELF file of the build the capture was taken with")
+    parser.add_argument("capture", help="raw UART capture, or - for stdin")
+    parser.add_argument("--no-time", action="store_true", help="leave out the record timestamps")
+    args = parser.parse_args()
+
+    formats = read_formats(args.elf)
+    if args.capture == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+
+    decode(formats, data, sys.stdout, not args.no_time)
+
+
+if __name__ == "__main__":
+    main()
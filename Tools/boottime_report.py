@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+Boot time per phase, from reset to the first task switch, and whether it
+regressed.
+
+The firmware logs its boot trace once after the scheduler starts (see
+Core/Inc/boottime.h), one line per phase and then the total:
+
+  boot <phase>: <cycles> cycles <us> us
+  boot total: <us> us
+
+Given one UART capture this prints the phases.  Given a baseline as well it
+compares the two and exits with status 1 if the total, or any phase taking
+at least --floor microseconds, grew by more than --tolerance percent, so it
+can gate a change on a bench run.
+
+  python3 Tools/boottime_report.py capture.txt [--baseline old.txt] [--tolerance 10] [--floor 50]
+"""
+
+import argparse
+import re
+import sys
+
+PHASE_LINE = re.compile(r"boot (\w+): (\d+) cycles (\d+) us")
+TOTAL_LINE = re.compile(r"boot total: (\d+) us")
+
+
+def read_trace(path):
+    """(phases, total) from the last boot trace in a capture, phases as an
+    ordered list of (name, cycles, us)."""
+    phases = []
+    current = []
+    total = None
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = PHASE_LINE.search(line)
+            if m:
+                current.append((m.group(1), int(m.group(2)), int(m.group(3))))
+                continue
+            m = TOTAL_LINE.search(line)
+            if m:
+                # A device reset mid capture starts a new trace.
+                phases, current = current, []
+                total = int(m.group(1))
+
+    if total is None:
+        sys.exit("no boot trace in %s" % path)
+    return phases, total
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("capture", help="UART capture of the build under test")
+    parser.add_argument("--baseline", help="UART capture of the build to compare against")
+    parser.add_argument("--tolerance", type=float, default=10.0, help="allowed growth in percent")
+    parser.add_argument("--floor", type=int, default=50, help="phases shorter than this many us are not gated")
+    args = parser.parse_args()
+
+    phases, total = read_trace(args.capture)
+
+    if not args.baseline:
+        print("%-16s %10s %10s" % ("phase", "cycles", "us"))
+        for name, cycles, us in phases:
+            print("%-16s %10d %10d" % (name, cycles, us))
+        print("%-16s %10s %10d" % ("total", "", total))
+        return
+
+    base_phases, base_total = read_trace(args.baseline)
+    base = dict((name, us) for name, _, us in base_phases)
+    regressed = []
+
+    def row(name, before, after, gated):
+        delta = ("%+.1f%%" % ((after - before) * 100.0 / before)) if before else ""
+        flag = ""
+        if gated and before and after > before * (1.0 + args.tolerance / 100.0):
+            flag = "REGRESSED"
+            regressed.append(name)
+        print("%-16s %10d %10d %8s  %s" % (name, before, after, delta, flag))
+
+    print("%-16s %10s %10s %8s" % ("us", "baseline", "now", "change"))
+    for name, _, us in phases:
+        if name not in base:
+            print("%-16s %10s %10d" % (name, "-", us))
+            continue
+        row(name, base[name], us, max(base[name], us) >= args.floor)
+    row("total", base_total, total, True)
+
+    if regressed:
+        sys.exit("boot time regressed: %s" % ", ".join(regressed))
+
+
+if __name__ == "__main__":
+    main()
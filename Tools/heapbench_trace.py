@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""
+Turn the allocator events of a trace recorder capture into a recorded trace
+for the heap benchmark.
+
+With configUSE_TRACE_RECORDER set the firmware records every pvPortMalloc()
+and vPortFree() (see Core/Inc/trace.h), as binary frames that
+Tools/trace_export.py reads or, with traceBINARY clear, as lines
+
+  [<cycles>] pvReturn: 0x<address> | BlockSize: <bytes>
+  [<cycles>] vPortFree: 0x<address> | BlockSize: <bytes>
+
+where the size is that of the whole block.  Either kind of capture will do.  This maps each live address to
+one of the benchmark's slots, takes the block header off each size, and
+writes the sequence as Core/Inc/heapbench_trace.h, which heapbench.c picks up
+for its "recorded" scenario in the next build.  Frees of blocks allocated
+before the capture started are left out.
+
+  python3 Tools/heapbench_trace.py capture.txt [--header 8] [--out Core/Inc/heapbench_trace.h]
+"""
+
+import argparse
+import re
+import sys
+
+from trace_export import CODES, read_records
+
+MALLOC_LINE = re.compile(r"pvReturn: 0x([0-9a-fA-F]+) \| BlockSize: +(\d+)")
+FREE_LINE = re.compile(r"vPortFree: 0x([0-9a-fA-F]+) \| BlockSize: +(\d+)")
+
+# ucSlot is a uint8_t.
+MAX_SLOTS = 256
+
+
+def read_events(path):
+    """[(is_malloc, address, size)] in capture order."""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    records, _ = read_records(data)
+    if records:
+        return [(event == CODES["MALLOC"], arg0, arg1) for _, event, arg0, arg1 in records
+                if event in (CODES["MALLOC"], CODES["FREE"])]
+
+    events = []
+    for line in data.decode("ascii", errors="replace").splitlines():
+        m = MALLOC_LINE.search(line) or FREE_LINE.search(line)
+        if m:
+            events.append((m.re is MALLOC_LINE, int(m.group(1), 16), int(m.group(2))))
+    return events
+
+
+def read_ops(path, header):
+    """[(size, slot)] in capture order with size 0 for a free, and the number
+    of slots used."""
+    ops = []
+    live = {}
+    free_slots = []
+    slots = 0
+
+    for is_malloc, address, size in read_events(path):
+        if is_malloc:
+            if address == 0:
+                continue
+            if free_slots:
+                slot = free_slots.pop()
+            else:
+                slot, slots = slots, slots + 1
+                if slots > MAX_SLOTS:
+                    sys.exit("more than %d blocks live at once" % MAX_SLOTS)
+            live[address] = slot
+            ops.append((max(size - header, 1), slot))
+        else:
+            slot = live.pop(address, None)
+            if slot is not None:
+                free_slots.append(slot)
+                ops.append((0, slot))
+
+    if not ops:
+        sys.exit("no allocator events in %s" % path)
+    return ops, slots
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("capture", help="UART capture with trace recorder output, binary or text")
+    parser.add_argument("--header", type=int, default=8, help="block header bytes included in BlockSize")
+    parser.add_argument("--out", default="Core/Inc/heapbench_trace.h", help="header to write")
+    args = parser.parse_args()
+
+    ops, slots = read_ops(args.capture, args.header)
+
+    with open(args.out, "w") as f:
+        f.write("/* Written by Tools/heapbench_trace.py from %s; do not edit. */\n" % args.capture)
+        f.write("#define heapbenchTRACE_SLOTS        %dU\n\n" % slots)
+        f.write("static const HeapBenchOp_t xHeapBenchTrace[] =\n{\n")
+        for size, slot in ops:
+            f.write("  { %5dU, %3dU },\n" % (size, slot))
+        f.write("};\n")
+
+    print("%d operations over %d slots written to %s" % (len(ops), slots, args.out))
+
+
+if __name__ == "__main__":
+    main()
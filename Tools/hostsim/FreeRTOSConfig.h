@@ -0,0 +1,94 @@
+/*
+ * Kernel configuration for the host simulator build.
+ *
+ * The Makefile force-includes this file ahead of everything else, so it
+ * claims the FREERTOS_CONFIG_H guard and FreeRTOS/include/FreeRTOSConfig.h,
+ * which FreeRTOS.h would otherwise find first, compiles to nothing.
+ *
+ * The kernel features that change the code paths being measured follow the
+ * target configuration.  Everything that needs the Cortex-M4 or the HAL -
+ * DWT timestamps, the trace recorder, tickless idle, RAM placement, the
+ * switch profiler - is off.
+ */
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/* The allocator under test, and whether heap_2.c merges neighbours.  Both can
+be overridden from the make command line, see the Makefile. */
+#ifndef configHEAP_IMPLEMENTATION
+	#define configHEAP_IMPLEMENTATION	heapIMPLEMENTATION_2
+#endif
+#ifndef if_merge_mem
+	#define if_merge_mem				1
+#endif
+/* Much larger than on the target, so that runs of millions of operations
+measure the allocator rather than allocation failures. */
+#ifndef configTOTAL_HEAP_SIZE
+	#define configTOTAL_HEAP_SIZE		( ( size_t ) ( 256 * 1024 ) )
+#endif
+#define configCCM_HEAP_SIZE				( 32 * 1024 )
+#define configGENERATE_HEAP_STATS		0
+#define configHEAP_LOCK_CEILING			3
+#define configUSE_ISR_HEAP_POOLS		0
+#define configUSE_BUDDY_HEAP			1
+#define configBUDDY_HEAP_TOP_BLOCKS		64
+#define configUSE_HEAP_HANDLES			1
+#define configHEAP_HANDLE_REGION_SIZE	( 64 * 1024 )
+#define configHEAP_HANDLES				64
+#define configHEAP_JOURNAL_LENGTH		64
+#define configKERNEL_HOT_PATHS_IN_RAM	0
+#define configHEAP_HOT_PATHS_IN_RAM		0
+
+#define configSUPPORT_STATIC_ALLOCATION	0
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
+#define configUSE_TASK_POOLS			0
+#define configUSE_TASK_ARENAS			0
+#define configUSE_SWITCH_PROFILER		0
+#define configUSE_DELAY_WHEEL			1
+#define configUSE_PREEMPTION			1
+/* The idle hook is where the simulator advances time, see port.c. */
+#define configUSE_IDLE_HOOK				1
+#define configUSE_TICK_HOOK				0
+#define configCPU_CLOCK_HZ				( 168000000UL )
+#define configTICK_RATE_HZ				( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES			( 5 )
+/* In StackType_t words of 8 bytes; port.c keeps its context at the top. */
+#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 512 )
+#define configMAX_TASK_NAME_LEN			( 10 )
+#define configUSE_TRACE_FACILITY		1
+#define configUSE_16_BIT_TICKS			0
+#define configIDLE_SHOULD_YIELD			1
+#define configUSE_MUTEXES				1
+#define configQUEUE_REGISTRY_SIZE		0
+#define configUSE_ZERO_COPY_QUEUES		0
+#define configUSE_QUEUE_BATCH_OPERATIONS	1
+#define configCHECK_FOR_STACK_OVERFLOW	0
+#define configUSE_RECURSIVE_MUTEXES		1
+#define configUSE_MALLOC_FAILED_HOOK	0
+#define configUSE_APPLICATION_TASK_TAG	0
+#define configUSE_COUNTING_SEMAPHORES	1
+#define configGENERATE_RUN_TIME_STATS	0
+#define configUSE_TICKLESS_IDLE			0
+#define configUSE_CO_ROUTINES			0
+#define configMAX_CO_ROUTINE_PRIORITIES	( 2 )
+#define configUSE_TIMERS				0
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	0
+
+#define INCLUDE_vTaskPrioritySet		1
+#define INCLUDE_uxTaskPriorityGet		1
+#define INCLUDE_vTaskDelete				1
+#define INCLUDE_vTaskSuspend			1
+#define INCLUDE_vTaskDelayUntil			1
+#define INCLUDE_vTaskDelay				1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
+#define INCLUDE_xTaskGetIdleTaskHandle	1
+#define INCLUDE_xTaskGetCurrentTaskHandle	1
+
+/* A failed assertion ends the run with its location. */
+extern void vHostAssert( const char *pcFile, int iLine );
+#define configASSERT( x ) if( ( x ) == 0 ) { vHostAssert( __FILE__, __LINE__ ); }
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,858 @@
+/*
+ * Allocator and scheduler microbenchmarks for the host simulator build.
+ *
+ * One controlling task runs each benchmark in turn and prints a line
+ *
+ *   bench,<heap>,<merge>,<name>,<operations>,<ns per operation>
+ *
+ * then ends the scheduler.  The heap benchmarks replay the patterns of
+ * Core/Src/heapbench.c - random slots and sizes, LIFO and FIFO fill and drain
+ * - over many more operations than the target heap allows.  The scheduler
+ * benchmarks bounce between two tasks through a queue, a direct to task
+ * notification and a plain taskYIELD(), so each operation there is one round
+ * trip, two context switches.
+ *
+ * With heap_2 and MERGE=1 the random pattern is then run once under each fit
+ * policy, see xPortHeapSetFitPolicy(), each run reported as random_<policy>
+ * and followed by the policy's own figures:
+ *
+ *   policy,<name>,<allocations>,<failures>,<fragmented failures>,
+ *          <blocks searched average>,<blocks searched max>
+ *
+ * Without merging four more random passes leave the heap too fragmented for
+ * the benchmarks after them, so MERGE=0 skips the policies.  A scheduler
+ * benchmark whose partner task cannot be created is reported and skipped:
+ *
+ *   skip,<heap>,<merge>,<name>
+ *
+ * semaphore_create_delete creates and deletes a binary semaphore, and
+ * queue_create_delete a queue of eight words, with 64 of each alive at a time,
+ * which with SLABS=1 measures the slab caches of slab.c.
+ *
+ * The buddy allocator, heap_buddy.c, runs the same random pattern as buddy,
+ * then a pass that fills every block it hands out and checks the pattern when
+ * freeing it, and that the region is whole again at the end:
+ *
+ *   buddy,check,<clean or FAULT>
+ *
+ * Movable blocks from heap_handle.c are exercised the same way, with a few
+ * of them kept locked, compacting a step at a time in between, and each
+ * block's contents are checked whenever it is locked.  At the end the free
+ * space must be one block:
+ *
+ *   handle,check,<clean or FAULT>,<blocks moved>,<bytes moved>
+ *
+ * The heap's change journal is checked by keeping a copy of the free list up
+ * to date from xPortGetHeapChanges() alone, over bursts of random
+ * allocations, reallocations and frees, and comparing it with a fresh
+ * vPortGetHeapSnapshot() after each burst.  A burst that outruns the journal
+ * must be reported as such, and the copy is then taken again:
+ *
+ *   journal,check,<clean or FAULT>,<changes>,<overruns>
+ *
+ * Built with GUARD=1 it also checks that a guard pass over a full heap finds
+ * nothing, and that a block overrun by one byte is caught when freed.
+ *
+ *   hostsim [operations]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#define hostsimDEFAULT_OPS		1000000UL
+#define hostsimSLOTS			256
+#define hostsimMIN_SIZE			8
+#define hostsimMAX_SIZE			512
+
+#if( configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_2 )
+	#define hostsimHEAP_NAME	"heap_2"
+#elif( configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_BTAG )
+	#define hostsimHEAP_NAME	"heap_btag"
+#elif( configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_TLSF )
+	#define hostsimHEAP_NAME	"heap_tlsf"
+#else
+	#define hostsimHEAP_NAME	"other"
+#endif
+
+static unsigned long ulOps = hostsimDEFAULT_OPS;
+static void *pvSlots[ hostsimSLOTS ];
+static uint32_t ulRandom = 0x2545F491UL;
+
+static QueueHandle_t xPing, xPong;
+static TaskHandle_t xControlTask, xPartnerTask;
+
+static void prvControlTask( void *pvParameters );
+static void prvQueuePartner( void *pvParameters );
+static void prvNotifyPartner( void *pvParameters );
+static void prvYieldPartner( void *pvParameters );
+static void prvBenchHeapRandom( const char *pcName );
+static void prvBenchHeapFill( BaseType_t xLifo );
+static void prvBenchBuddy( void );
+static void prvBuddySelfTest( void );
+static void prvHandleSelfTest( void );
+static void prvJournalSelfTest( void );
+static size_t prvJournalFind( void *pvBlock );
+static uint32_t prvJournalResync( void );
+static void prvBenchCreateDelete( BaseType_t xSemaphore );
+static void prvBenchQueue( void );
+static void prvBenchNotify( void );
+static void prvBenchYield( void );
+static BaseType_t prvCreatePartner( TaskFunction_t pxPartner, UBaseType_t uxPriority, const char *pcBench );
+static uint32_t prvRandom( void );
+static size_t prvRandomSize( void );
+static uint64_t prvNowNs( void );
+static void prvReport( const char *pcName, unsigned long ulCount, uint64_t ullNs );
+#if( configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_2 )
+	static void prvBenchHeapPolicies( void );
+#endif
+#if( configHEAP_GUARD == 1 )
+	static void prvGuardSelfTest( void );
+	static void *pvCorruptedBlock = NULL;
+#endif
+
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+	if( argc > 1 )
+	{
+		ulOps = strtoul( argv[ 1 ], NULL, 0 );
+	}
+
+	xPing = xQueueCreate( 1, sizeof( uint32_t ) );
+	xPong = xQueueCreate( 1, sizeof( uint32_t ) );
+	configASSERT( xPing && xPong );
+
+	( void ) xTaskCreate( prvControlTask, "CONTROL", configMINIMAL_STACK_SIZE, NULL, 1, &xControlTask );
+	vTaskStartScheduler();
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvControlTask( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	prvBenchHeapRandom( "random" );
+	prvBenchHeapFill( pdTRUE );
+	prvBenchHeapFill( pdFALSE );
+
+	#if( configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_2 )
+	{
+		if( if_merge_mem == 1 )
+		{
+			prvBenchHeapPolicies();
+		}
+	}
+	#endif
+
+	prvBenchBuddy();
+	prvBuddySelfTest();
+	prvHandleSelfTest();
+	prvJournalSelfTest();
+	prvBenchCreateDelete( pdTRUE );
+	prvBenchCreateDelete( pdFALSE );
+	prvBenchQueue();
+	prvBenchNotify();
+	prvBenchYield();
+
+	#if( configHEAP_GUARD == 1 )
+	{
+		prvGuardSelfTest();
+	}
+	#endif
+
+	vTaskEndScheduler();
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchHeapRandom( const char *pcName )
+{
+unsigned long ul;
+size_t xSlot;
+uint64_t ullStart;
+
+	ullStart = prvNowNs();
+
+	for( ul = 0; ul < ulOps; ul++ )
+	{
+		xSlot = prvRandom() % hostsimSLOTS;
+
+		if( pvSlots[ xSlot ] == NULL )
+		{
+			pvSlots[ xSlot ] = pvPortMalloc( prvRandomSize() );
+		}
+		else
+		{
+			vPortFree( pvSlots[ xSlot ] );
+			pvSlots[ xSlot ] = NULL;
+		}
+	}
+
+	prvReport( pcName, ulOps, prvNowNs() - ullStart );
+
+	for( xSlot = 0; xSlot < hostsimSLOTS; xSlot++ )
+	{
+		vPortFree( pvSlots[ xSlot ] );
+		pvSlots[ xSlot ] = NULL;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchHeapFill( BaseType_t xLifo )
+{
+unsigned long ulRound, ulRounds = ulOps / ( 2 * hostsimSLOTS );
+uint64_t ullMallocNs = 0, ullFreeNs = 0, ullStart;
+size_t x;
+
+	for( ulRound = 0; ulRound < ulRounds; ulRound++ )
+	{
+		ullStart = prvNowNs();
+		for( x = 0; x < hostsimSLOTS; x++ )
+		{
+			pvSlots[ x ] = pvPortMalloc( prvRandomSize() );
+		}
+		ullMallocNs += prvNowNs() - ullStart;
+
+		ullStart = prvNowNs();
+		for( x = 0; x < hostsimSLOTS; x++ )
+		{
+			size_t xSlot = ( xLifo != pdFALSE ) ? ( hostsimSLOTS - 1 - x ) : x;
+
+			vPortFree( pvSlots[ xSlot ] );
+			pvSlots[ xSlot ] = NULL;
+		}
+		ullFreeNs += prvNowNs() - ullStart;
+	}
+
+	prvReport( ( xLifo != pdFALSE ) ? "lifo_malloc" : "fifo_malloc", ulRounds * hostsimSLOTS, ullMallocNs );
+	prvReport( ( xLifo != pdFALSE ) ? "lifo_free" : "fifo_free", ulRounds * hostsimSLOTS, ullFreeNs );
+}
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_IMPLEMENTATION == heapIMPLEMENTATION_2 )
+
+	static void prvBenchHeapPolicies( void )
+	{
+	static const char * const pcPolicies[ heapFIT_POLICIES ] = { "best", "first", "next", "address" };
+	char cName[ 24 ];
+	HeapPolicyStats_t xStats;
+	BaseType_t xPolicy, xResult;
+
+		for( xPolicy = 0; xPolicy < heapFIT_POLICIES; xPolicy++ )
+		{
+			xResult = xPortHeapSetFitPolicy( ( HeapFitPolicy_t ) xPolicy, ( if_merge_mem == 1 ) ? pdTRUE : pdFALSE );
+			configASSERT( xResult == pdPASS );
+			( void ) xResult;
+
+			/* The same sequence for each. */
+			ulRandom = 0x2545F491UL;
+			snprintf( cName, sizeof( cName ), "random_%s", pcPolicies[ xPolicy ] );
+			prvBenchHeapRandom( cName );
+
+			vPortGetHeapPolicyStats( ( HeapFitPolicy_t ) xPolicy, &xStats );
+			printf( "policy,%s,%lu,%lu,%lu,%lu,%lu\n", pcPolicies[ xPolicy ],
+					( unsigned long ) xStats.xSuccessfulAllocations, ( unsigned long ) xStats.xFailedAllocations,
+					( unsigned long ) xStats.xFragmentedFailures, ( unsigned long ) xStats.ulBlocksSearchedAverage,
+					( unsigned long ) xStats.ulBlocksSearchedMax );
+		}
+
+		( void ) xPortHeapSetFitPolicy( configHEAP_FIT_POLICY, ( if_merge_mem == 1 ) ? pdTRUE : pdFALSE );
+		fflush( stdout );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configHEAP_IMPLEMENTATION */
+
+static void prvBenchBuddy( void )
+{
+unsigned long ul;
+size_t xSlot;
+uint64_t ullStart;
+
+	ullStart = prvNowNs();
+
+	for( ul = 0; ul < ulOps; ul++ )
+	{
+		xSlot = prvRandom() % hostsimSLOTS;
+
+		if( pvSlots[ xSlot ] == NULL )
+		{
+			pvSlots[ xSlot ] = pvPortBuddyMalloc( prvRandomSize() );
+		}
+		else
+		{
+			vPortBuddyFree( pvSlots[ xSlot ] );
+			pvSlots[ xSlot ] = NULL;
+		}
+	}
+
+	prvReport( "buddy", ulOps, prvNowNs() - ullStart );
+
+	for( xSlot = 0; xSlot < hostsimSLOTS; xSlot++ )
+	{
+		vPortBuddyFree( pvSlots[ xSlot ] );
+		pvSlots[ xSlot ] = NULL;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvBuddySelfTest( void )
+{
+size_t xSizes[ hostsimSLOTS ];
+BuddyHeapStats_t xStats;
+BaseType_t xClean = pdTRUE;
+unsigned long ul;
+size_t xSlot, x;
+uint8_t *pucBlock;
+
+	for( ul = 0; ul < ( ulOps / 10 ) + hostsimSLOTS; ul++ )
+	{
+		xSlot = prvRandom() % hostsimSLOTS;
+		pucBlock = pvSlots[ xSlot ];
+
+		if( pucBlock == NULL )
+		{
+			xSizes[ xSlot ] = prvRandomSize();
+			pucBlock = pvPortBuddyMalloc( xSizes[ xSlot ] );
+
+			if( pucBlock != NULL )
+			{
+				/* Aligned to the power of two at or above the request. */
+				for( x = 1; x < xSizes[ xSlot ]; x <<= 1 )
+				{
+				}
+				if( ( ( uintptr_t ) pucBlock & ( x - 1 ) ) != 0 )
+				{
+					xClean = pdFALSE;
+				}
+				memset( pucBlock, ( int ) xSlot, xSizes[ xSlot ] );
+			}
+			pvSlots[ xSlot ] = pucBlock;
+		}
+		else
+		{
+			/* Overwritten by another block if any two overlapped. */
+			for( x = 0; x < xSizes[ xSlot ]; x++ )
+			{
+				if( pucBlock[ x ] != ( uint8_t ) xSlot )
+				{
+					xClean = pdFALSE;
+				}
+			}
+			vPortBuddyFree( pucBlock );
+			pvSlots[ xSlot ] = NULL;
+		}
+	}
+
+	for( xSlot = 0; xSlot < hostsimSLOTS; xSlot++ )
+	{
+		vPortBuddyFree( pvSlots[ xSlot ] );
+		pvSlots[ xSlot ] = NULL;
+	}
+
+	vPortGetBuddyHeapStats( &xStats );
+	if( ( xStats.xFreeBytes != xStats.xRegionSize ) || ( xStats.xLargestFreeBlock != ( ( size_t ) 1 << configBUDDY_HEAP_MAX_BLOCK_ORDER ) ) )
+	{
+		xClean = pdFALSE;
+	}
+
+	printf( "buddy,check,%s\n", ( xClean != pdFALSE ) ? "clean" : "FAULT" );
+	fflush( stdout );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHandleSelfTest( void )
+{
+HeapHandle_t xHandles[ 64 ];
+size_t xSizes[ 64 ];
+HeapHandleStats_t xStats;
+BaseType_t xClean = pdTRUE;
+unsigned long ul;
+size_t xSlot, x;
+uint8_t *pucBlock;
+uint64_t ullStart;
+
+	memset( xHandles, 0, sizeof( xHandles ) );
+
+	ullStart = prvNowNs();
+	for( ul = 0; ul < ulOps; ul++ )
+	{
+		xSlot = prvRandom() % 64;
+
+		if( xHandles[ xSlot ] == NULL )
+		{
+			xSizes[ xSlot ] = prvRandomSize() * 4;
+			xHandles[ xSlot ] = xHeapHandleAlloc( xSizes[ xSlot ] );
+
+			if( xHandles[ xSlot ] != NULL )
+			{
+				pucBlock = pvHeapHandleLock( xHandles[ xSlot ] );
+				memset( pucBlock, ( int ) xSlot, xSizes[ xSlot ] );
+
+				/* The first few slots stay locked for a while. */
+				if( xSlot >= 4 )
+				{
+					vHeapHandleUnlock( xHandles[ xSlot ] );
+				}
+			}
+		}
+		else
+		{
+			if( xSlot >= 4 )
+			{
+				pucBlock = pvHeapHandleLock( xHandles[ xSlot ] );
+			}
+			else
+			{
+				pucBlock = pvHeapHandleLock( xHandles[ xSlot ] );
+				vHeapHandleUnlock( xHandles[ xSlot ] );
+			}
+
+			for( x = 0; x < xSizes[ xSlot ]; x++ )
+			{
+				if( pucBlock[ x ] != ( uint8_t ) xSlot )
+				{
+					xClean = pdFALSE;
+				}
+			}
+
+			vHeapHandleUnlock( xHandles[ xSlot ] );
+			vHeapHandleFree( xHandles[ xSlot ] );
+			xHandles[ xSlot ] = NULL;
+		}
+
+		/* As the idle task would. */
+		( void ) xPortHeapCompactStep();
+	}
+	prvReport( "handle", ulOps, prvNowNs() - ullStart );
+
+	/* Unlock the pinned ones and compact everything. */
+	for( xSlot = 0; xSlot < 4; xSlot++ )
+	{
+		if( xHandles[ xSlot ] != NULL )
+		{
+			vHeapHandleUnlock( xHandles[ xSlot ] );
+		}
+	}
+	while( xPortHeapCompactStep() == pdFALSE )
+	{
+	}
+
+	vPortGetHeapHandleStats( &xStats );
+	if( xStats.xFreeBlocks > 1 )
+	{
+		xClean = pdFALSE;
+	}
+
+	for( xSlot = 0; xSlot < 64; xSlot++ )
+	{
+		if( xHandles[ xSlot ] != NULL )
+		{
+			pucBlock = pvHeapHandleLock( xHandles[ xSlot ] );
+			for( x = 0; x < xSizes[ xSlot ]; x++ )
+			{
+				if( pucBlock[ x ] != ( uint8_t ) xSlot )
+				{
+					xClean = pdFALSE;
+				}
+			}
+			vHeapHandleUnlock( xHandles[ xSlot ] );
+			vHeapHandleFree( xHandles[ xSlot ] );
+		}
+	}
+
+	vPortGetHeapHandleStats( &xStats );
+	if( ( xStats.xFreeBytes != xStats.xRegionSize ) || ( xStats.xFreeBlocks != 1 ) || ( xStats.uxHandlesInUse != 0 ) )
+	{
+		xClean = pdFALSE;
+	}
+
+	printf( "handle,check,%s,%lu,%lu\n", ( xClean != pdFALSE ) ? "clean" : "FAULT", ( unsigned long ) xStats.xBlocksMoved, ( unsigned long ) xStats.xBytesMoved );
+	fflush( stdout );
+}
+/*-----------------------------------------------------------*/
+
+#define hostsimJOURNAL_BLOCKS	16384
+
+static HeapBlockInfo_t xJournalCopy[ hostsimJOURNAL_BLOCKS ];
+static HeapBlockInfo_t xJournalSnapshot[ hostsimJOURNAL_BLOCKS ];
+static size_t xJournalCopyBlocks;
+
+static size_t prvJournalFind( void *pvBlock )
+{
+size_t x;
+
+	for( x = 0; x < xJournalCopyBlocks; x++ )
+	{
+		if( xJournalCopy[ x ].pvStartAddress == pvBlock )
+		{
+			break;
+		}
+	}
+
+	return x;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvJournalResync( void )
+{
+HeapSnapshot_t xSnapshot;
+
+	vPortGetHeapSnapshot( &xSnapshot, xJournalCopy, hostsimJOURNAL_BLOCKS );
+	configASSERT( xSnapshot.xBlocksCaptured == xSnapshot.xNumberOfFreeBlocks );
+	xJournalCopyBlocks = xSnapshot.xBlocksCaptured;
+
+	return xSnapshot.ulSequence;
+}
+/*-----------------------------------------------------------*/
+
+static void prvJournalSelfTest( void )
+{
+HeapSnapshot_t xSnapshot;
+HeapChange_t xChanges[ 16 ];
+BaseType_t xClean = pdTRUE;
+uint32_t ulSequence;
+unsigned long ul, ulBurst, ulChanges = 0, ulOverruns = 0;
+size_t x, xCopied, xSlot, xFound;
+
+	memset( pvSlots, 0, sizeof( pvSlots ) );
+	ulSequence = prvJournalResync();
+
+	for( ul = 0; ul < ulOps / 16; ul++ )
+	{
+		/* Mostly bursts the journal holds, now and then one it cannot. */
+		for( ulBurst = 1 + ( prvRandom() % 24 ); ulBurst > 0; ulBurst-- )
+		{
+			xSlot = prvRandom() % hostsimSLOTS;
+
+			if( pvSlots[ xSlot ] == NULL )
+			{
+				pvSlots[ xSlot ] = pvPortMalloc( prvRandomSize() );
+			}
+			else if( ( prvRandom() & 3U ) == 0U )
+			{
+				pvSlots[ xSlot ] = pvPortRealloc( pvSlots[ xSlot ], prvRandomSize() );
+			}
+			else
+			{
+				vPortFree( pvSlots[ xSlot ] );
+				pvSlots[ xSlot ] = NULL;
+			}
+		}
+
+		do
+		{
+			if( xPortGetHeapChanges( &ulSequence, xChanges, 16, &xCopied ) == pdFALSE )
+			{
+				ulOverruns++;
+				ulSequence = prvJournalResync();
+				break;
+			}
+
+			for( x = 0; x < xCopied; x++ )
+			{
+				xFound = prvJournalFind( xChanges[ x ].pvStartAddress );
+
+				switch( xChanges[ x ].eType )
+				{
+					case eHeapChangeInsert:
+						if( xFound == xJournalCopyBlocks )
+						{
+							configASSERT( xJournalCopyBlocks < hostsimJOURNAL_BLOCKS );
+							xJournalCopyBlocks++;
+						}
+						xJournalCopy[ xFound ].pvStartAddress = xChanges[ x ].pvStartAddress;
+						xJournalCopy[ xFound ].xBlockSize = xChanges[ x ].xBlockSize;
+						break;
+
+					case eHeapChangeRemove:
+					case eHeapChangeMerge:
+						if( xFound == xJournalCopyBlocks )
+						{
+							xClean = pdFALSE;
+						}
+						else
+						{
+							xJournalCopy[ xFound ] = xJournalCopy[ xJournalCopyBlocks - 1 ];
+							xJournalCopyBlocks--;
+						}
+						break;
+
+					default:
+						/* Splits cut down a block already removed or
+						allocated. */
+						break;
+				}
+			}
+
+			ulChanges += xCopied;
+		} while( xCopied == 16 );
+
+		vPortGetHeapSnapshot( &xSnapshot, xJournalSnapshot, hostsimJOURNAL_BLOCKS );
+
+		if( ( xSnapshot.ulSequence != ulSequence ) || ( xSnapshot.xNumberOfFreeBlocks != xJournalCopyBlocks ) )
+		{
+			xClean = pdFALSE;
+		}
+
+		for( x = 0; x < xSnapshot.xBlocksCaptured; x++ )
+		{
+			xFound = prvJournalFind( xJournalSnapshot[ x ].pvStartAddress );
+
+			if( ( xFound == xJournalCopyBlocks ) || ( xJournalCopy[ xFound ].xBlockSize != xJournalSnapshot[ x ].xBlockSize ) )
+			{
+				xClean = pdFALSE;
+			}
+		}
+	}
+
+	for( xSlot = 0; xSlot < hostsimSLOTS; xSlot++ )
+	{
+		vPortFree( pvSlots[ xSlot ] );
+		pvSlots[ xSlot ] = NULL;
+	}
+
+	printf( "journal,check,%s,%lu,%lu\n", ( xClean != pdFALSE ) ? "clean" : "FAULT", ulChanges, ulOverruns );
+	fflush( stdout );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchCreateDelete( BaseType_t xSemaphore )
+{
+QueueHandle_t xQueues[ 64 ];
+unsigned long ul;
+size_t x;
+uint64_t ullStart;
+
+	memset( xQueues, 0, sizeof( xQueues ) );
+
+	ullStart = prvNowNs();
+	for( ul = 0; ul < ulOps; ul++ )
+	{
+		x = prvRandom() % 64;
+
+		if( xQueues[ x ] == NULL )
+		{
+			xQueues[ x ] = ( xSemaphore != pdFALSE ) ? xSemaphoreCreateBinary() : xQueueCreate( 8, sizeof( uint32_t ) );
+		}
+		else
+		{
+			vQueueDelete( xQueues[ x ] );
+			xQueues[ x ] = NULL;
+		}
+	}
+	prvReport( ( xSemaphore != pdFALSE ) ? "semaphore_create_delete" : "queue_create_delete", ulOps, prvNowNs() - ullStart );
+
+	for( x = 0; x < 64; x++ )
+	{
+		if( xQueues[ x ] != NULL )
+		{
+			vQueueDelete( xQueues[ x ] );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchQueue( void )
+{
+unsigned long ul;
+uint32_t ulValue = 0;
+uint64_t ullStart;
+
+	if( prvCreatePartner( prvQueuePartner, 2, "queue_round_trip" ) == pdFALSE )
+	{
+		return;
+	}
+
+	ullStart = prvNowNs();
+	for( ul = 0; ul < ulOps; ul++ )
+	{
+		( void ) xQueueSend( xPing, &ulValue, portMAX_DELAY );
+		( void ) xQueueReceive( xPong, &ulValue, portMAX_DELAY );
+	}
+	prvReport( "queue_round_trip", ulOps, prvNowNs() - ullStart );
+
+	vTaskDelete( xPartnerTask );
+}
+/*-----------------------------------------------------------*/
+
+static void prvQueuePartner( void *pvParameters )
+{
+uint32_t ulValue;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		( void ) xQueueReceive( xPing, &ulValue, portMAX_DELAY );
+		ulValue++;
+		( void ) xQueueSend( xPong, &ulValue, portMAX_DELAY );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchNotify( void )
+{
+unsigned long ul;
+uint64_t ullStart;
+
+	if( prvCreatePartner( prvNotifyPartner, 2, "notify_round_trip" ) == pdFALSE )
+	{
+		return;
+	}
+
+	ullStart = prvNowNs();
+	for( ul = 0; ul < ulOps; ul++ )
+	{
+		( void ) xTaskNotifyGive( xPartnerTask );
+		( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+	}
+	prvReport( "notify_round_trip", ulOps, prvNowNs() - ullStart );
+
+	vTaskDelete( xPartnerTask );
+}
+/*-----------------------------------------------------------*/
+
+static void prvNotifyPartner( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+		( void ) xTaskNotifyGive( xControlTask );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchYield( void )
+{
+unsigned long ul;
+uint64_t ullStart;
+
+	/* Same priority as this task, so each yield switches to the other. */
+	if( prvCreatePartner( prvYieldPartner, 1, "yield_round_trip" ) == pdFALSE )
+	{
+		return;
+	}
+
+	ullStart = prvNowNs();
+	for( ul = 0; ul < ulOps; ul++ )
+	{
+		taskYIELD();
+	}
+	prvReport( "yield_round_trip", ulOps, prvNowNs() - ullStart );
+
+	vTaskDelete( xPartnerTask );
+}
+/*-----------------------------------------------------------*/
+
+static void prvYieldPartner( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		taskYIELD();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCreatePartner( TaskFunction_t pxPartner, UBaseType_t uxPriority, const char *pcBench )
+{
+	/* Waiting on a partner that was never created would hang the run. */
+	if( xTaskCreate( pxPartner, "PARTNER", configMINIMAL_STACK_SIZE, NULL, uxPriority, &xPartnerTask ) != pdPASS )
+	{
+		printf( "skip,%s,%d,%s\n", hostsimHEAP_NAME, ( int ) if_merge_mem, pcBench );
+		fflush( stdout );
+		return pdFALSE;
+	}
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRandom( void )
+{
+	ulRandom ^= ulRandom << 13;
+	ulRandom ^= ulRandom >> 17;
+	ulRandom ^= ulRandom << 5;
+
+	return ulRandom;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvRandomSize( void )
+{
+	return hostsimMIN_SIZE + ( ( prvRandom() >> 8 ) % ( hostsimMAX_SIZE - hostsimMIN_SIZE + 1 ) );
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+struct timespec xNow;
+
+	( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+	return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char *pcName, unsigned long ulCount, uint64_t ullNs )
+{
+	printf( "bench,%s,%d,%s,%lu,%.1f\n", hostsimHEAP_NAME, ( int ) if_merge_mem, pcName, ulCount,
+			( ulCount != 0 ) ? ( ( double ) ullNs / ( double ) ulCount ) : 0.0 );
+	fflush( stdout );
+}
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_GUARD == 1 )
+
+	static void prvGuardSelfTest( void )
+	{
+	size_t x;
+	unsigned long ulSteps = 1;
+	uint8_t *pucBlock;
+
+		for( x = 0; x < hostsimSLOTS; x++ )
+		{
+			pvSlots[ x ] = pvPortMalloc( prvRandomSize() );
+		}
+
+		while( ( xPortHeapGuardStep() == pdFALSE ) && ( pvCorruptedBlock == NULL ) )
+		{
+			ulSteps++;
+		}
+
+		printf( "guard,pass,%lu steps,%s\n", ulSteps, ( pvCorruptedBlock == NULL ) ? "clean" : "FAULT" );
+
+		/* One byte past the end of the request. */
+		pucBlock = pvPortMalloc( 10 );
+		configASSERT( pucBlock );
+		memset( pucBlock, 0xa5, 11 );
+		vPortFree( pucBlock );
+		printf( "guard,overrun,%s\n", ( pvCorruptedBlock != NULL ) ? "caught" : "MISSED" );
+
+		for( x = 0; x < hostsimSLOTS; x++ )
+		{
+			vPortFree( pvSlots[ x ] );
+			pvSlots[ x ] = NULL;
+		}
+		fflush( stdout );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vApplicationHeapCorruptedHook( void *pvBlock )
+	{
+		pvCorruptedBlock = pvBlock;
+	}
+
+#endif /* configHEAP_GUARD */
@@ -0,0 +1,193 @@
+/*
+ * Port layer of the host simulator build.
+ *
+ * Every task runs on a host stack of its own through a ucontext, and
+ * vPortYield() swaps contexts whenever vTaskSwitchContext() picks another
+ * task, so all tasks share one host thread and switches happen only where
+ * the kernel asks for them.  The context lives at the top of the task's
+ * FreeRTOS stack, which is where the TCB's pxTopOfStack points, so the
+ * kernel needs no change.
+ *
+ * There is no tick interrupt.  The idle task advances the tick count instead,
+ * from the idle hook, so time passes only once every other task is blocked,
+ * and then jumps straight to the next tick.  A run is therefore deterministic
+ * and takes no longer in wall clock time than the work it does, which is what
+ * cachegrind and perf want.  The price is that a task that never blocks is
+ * never preempted by a tick, so benchmarks must block or yield.
+ *
+ * swapcontext() also saves the signal mask, which costs a system call per
+ * switch; subtract the switch-only figure hostsim.c reports when looking at
+ * the kernel's share.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Host stack of each task.  The FreeRTOS stack only holds the context. */
+#define portHOST_STACK_SIZE		( 256 * 1024 )
+
+typedef struct HOST_CONTEXT
+{
+	ucontext_t xContext;
+	void *pvHostStack;
+	TaskFunction_t pxCode;
+	void *pvParameters;
+} HostContext_t;
+
+/* Where vPortEndScheduler() returns to: the caller of vTaskStartScheduler(). */
+static ucontext_t xSchedulerContext;
+
+/* Critical sections and interrupt masks are both counted here. */
+static UBaseType_t uxCriticalNesting = 0;
+static BaseType_t xYieldPending = pdFALSE;
+
+static HostContext_t *prvCurrentContext( void );
+static void prvSwitchContext( void );
+static void prvTaskEntry( void );
+
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+HostContext_t *pxHost;
+
+	pxHost = ( HostContext_t * ) ( ( ( uintptr_t ) pxTopOfStack - sizeof( HostContext_t ) ) & ~( ( uintptr_t ) 15 ) );
+	pxHost->pvHostStack = malloc( portHOST_STACK_SIZE );
+	configASSERT( pxHost->pvHostStack );
+	pxHost->pxCode = pxCode;
+	pxHost->pvParameters = pvParameters;
+
+	( void ) getcontext( &( pxHost->xContext ) );
+	pxHost->xContext.uc_stack.ss_sp = pxHost->pvHostStack;
+	pxHost->xContext.uc_stack.ss_size = portHOST_STACK_SIZE;
+	pxHost->xContext.uc_link = NULL;
+	makecontext( &( pxHost->xContext ), prvTaskEntry, 0 );
+
+	return ( StackType_t * ) pxHost;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+	/* vTaskStartScheduler() masked "interrupts"; the first task starts with
+	them enabled, as on the target. */
+	uxCriticalNesting = 0;
+	xYieldPending = pdFALSE;
+
+	( void ) swapcontext( &xSchedulerContext, &( prvCurrentContext()->xContext ) );
+
+	/* Only reached through vPortEndScheduler(). */
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+	( void ) setcontext( &xSchedulerContext );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	if( uxCriticalNesting != 0 )
+	{
+		/* Held over until the critical section ends, like PendSV. */
+		xYieldPending = pdTRUE;
+	}
+	else
+	{
+		prvSwitchContext();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	vPortClearInterruptMask( uxCriticalNesting - 1 );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortSetInterruptMask( void )
+{
+	return uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxSavedMask )
+{
+	uxCriticalNesting = uxSavedMask;
+
+	if( ( uxCriticalNesting == 0 ) && ( xYieldPending != pdFALSE ) )
+	{
+		xYieldPending = pdFALSE;
+		prvSwitchContext();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortCleanUpTask( void *pvTCB )
+{
+	/* pxTopOfStack is the first member of the TCB. */
+	HostContext_t *pxHost = *( HostContext_t ** ) pvTCB;
+
+	free( pxHost->pvHostStack );
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+	/* Everything else is blocked, so no time need pass before the next tick. */
+	if( xTaskIncrementTick() != pdFALSE )
+	{
+		vPortYield();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vHostAssert( const char *pcFile, int iLine )
+{
+	fprintf( stderr, "assertion failed at %s:%d\n", pcFile, iLine );
+	abort();
+}
+/*-----------------------------------------------------------*/
+
+static HostContext_t *prvCurrentContext( void )
+{
+	return *( HostContext_t ** ) xTaskGetCurrentTaskHandle();
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchContext( void )
+{
+HostContext_t *pxFrom, *pxTo;
+
+	pxFrom = prvCurrentContext();
+	vTaskSwitchContext();
+	pxTo = prvCurrentContext();
+
+	if( pxTo != pxFrom )
+	{
+		( void ) swapcontext( &( pxFrom->xContext ), &( pxTo->xContext ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskEntry( void )
+{
+HostContext_t *pxHost = prvCurrentContext();
+
+	pxHost->pxCode( pxHost->pvParameters );
+
+	/* Tasks must delete themselves rather than return. */
+	vHostAssert( __FILE__, __LINE__ );
+}
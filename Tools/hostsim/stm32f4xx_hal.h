@@ -0,0 +1,16 @@
+/*
+ * Stand-in for the STM32 HAL header in the host simulator build.
+ *
+ * task.h includes the HAL and declares huart2 for the application's logging.
+ * None of the kernel files built here use either, so the handle type only has
+ * to exist.
+ */
+#ifndef STM32F4xx_HAL_H
+#define STM32F4xx_HAL_H
+
+typedef struct __UART_HandleTypeDef
+{
+	void *Instance;
+} UART_HandleTypeDef;
+
+#endif /* STM32F4xx_HAL_H */
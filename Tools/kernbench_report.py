@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Kernel microbenchmark results from a Bench image, and whether they regressed.
+
+The Bench build configuration logs one row per test once it has run them
+all (see Core/Inc/kernbench.h):
+
+  kbench,<test>,<param>,<samples>,<min>,<avg>,<max>,<hclk MHz>
+
+in cycles.  Given one UART capture this prints the rows with the times in
+ns, the queue rows as round trips and bytes moved per second, and the
+memcpy and memset rows as bytes per second with the port's speedup over
+newlib.  Given a
+baseline as well it compares the minimum and average of each test and exits
+with status 1 if either grew by more than --tolerance percent, so it can
+gate a kernel or port change on a bench run.  Maximums are printed but not
+gated, since interrupts land in them.
+
+  python3 Tools/kernbench_report.py capture.txt [--baseline old.txt] [--tolerance 5]
+"""
+
+import argparse
+import re
+import sys
+
+ROW = re.compile(r"kbench,(\w+),(\d+),(\d+),(\d+),(\d+),(\d+),(\d+)")
+
+
+def read_rows(path):
+    """Rows of the last complete run in a capture, as an ordered list of
+    ((test, param), samples, min, avg, max, mhz)."""
+    runs = []
+    current = []
+    seen = set()
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = ROW.search(line)
+            if not m:
+                continue
+            key = (m.group(1), int(m.group(2)))
+            if key in seen:
+                # A device reset mid capture starts a new run.
+                runs.append(current)
+                current, seen = [], set()
+            seen.add(key)
+            current.append((key,) + tuple(int(m.group(i)) for i in range(3, 8)))
+    runs.append(current)
+
+    runs = [run for run in runs if run]
+    if not runs:
+        sys.exit("no kbench rows in %s" % path)
+    return runs[-1]
+
+
+def label(key):
+    test, param = key
+    return "%s_%d" % (test, param) if param else test
+
+
+def ns(cycles, mhz):
+    return cycles * 1000.0 / mhz if mhz else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("capture", help="UART capture of the build under test")
+    parser.add_argument("--baseline", help="UART capture of the build to compare against")
+    parser.add_argument("--tolerance", type=float, default=5.0, help="allowed growth in percent")
+    args = parser.parse_args()
+
+    rows = read_rows(args.capture)
+
+    if not args.baseline:
+        print("%-20s %7s %8s %8s %8s %9s %9s" % ("test", "samples", "min", "avg", "max", "min ns", "avg ns"))
+        for key, samples, low, avg, high, mhz in rows:
+            print("%-20s %7d %8d %8d %8d %9.0f %9.0f" %
+                  (label(key), samples, low, avg, high, ns(low, mhz), ns(avg, mhz)))
+        for key, _, _, avg, _, mhz in rows:
+            if key[0] == "queue" and avg:
+                trips = mhz * 1e6 / avg
+                # Each round trip copies the item in and out of both queues.
+                print("%-20s %10.0f round trips/s %12.0f bytes/s" % (label(key), trips, trips * 2 * key[1]))
+        averages = dict((key, avg) for key, _, _, avg, _, _ in rows)
+        for key, _, _, avg, _, mhz in rows:
+            test, size = key
+            if test.startswith("mem") and "_port" in test and avg:
+                newlib = averages.get((test.replace("_port", "_newlib"), size))
+                print("%-20s %12.0f bytes/s %6.2fx newlib" %
+                      (label(key), size * mhz * 1e6 / avg, (newlib / avg) if newlib else 0.0))
+        return
+
+    base = dict((key, (low, avg)) for key, _, low, avg, _, _ in read_rows(args.baseline))
+    regressed = []
+
+    print("%-20s %10s %10s %8s %10s %10s %8s" % ("cycles", "min base", "min now", "change",
+                                                 "avg base", "avg now", "change"))
+    for key, _, low, avg, _, _ in rows:
+        name = label(key)
+        if key not in base:
+            print("%-20s %10s %10d %8s %10s %10d" % (name, "-", low, "", "-", avg))
+            continue
+
+        cells = []
+        flag = ""
+        for before, after in zip(base[key], (low, avg)):
+            cells += [before, after, ("%+.1f%%" % ((after - before) * 100.0 / before)) if before else ""]
+            if before and after > before * (1.0 + args.tolerance / 100.0):
+                flag = "REGRESSED"
+        if flag:
+            regressed.append(name)
+        print("%-20s %10d %10d %8s %10d %10d %8s  %s" % tuple([name] + cells + [flag]))
+
+    if regressed:
+        sys.exit("kernel benchmarks regressed: %s" % ", ".join(regressed))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+Flash and RAM per module from a linker map, and how they moved between builds.
+
+Every input section the map lists is charged to the object it came from:
+to flash if its output section runs from FLASH, to RAM if it runs from RAM
+or CCMRAM, and to both if it is also loaded from FLASH, as .data and
+.RamFunc are.  Padding goes to (fill), and the heap and stack reserve of
+._user_heap_stack is (fill) too.
+
+The Release configuration links with -flto, which leaves every section in
+a map credited to a temporary ltrans object.  Such sections are given back
+to their modules by name, .text.<function> and .bss.<variable>, looked up in
+a map of a build without LTO (--index, Debug/Lab4.map by default).
+Functions inlined away have no section and so cost their caller; what
+cannot be found is listed as (lto).
+
+  python3 Tools/map_report.py Release/Lab4.map [--baseline old.map] [--by dir] [--index Debug/Lab4.map]
+
+With --baseline the table has the change in each column, largest growth
+first.  --csv prints module,flash,ram rows instead, to keep per build.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+MEMORY = re.compile(r"^(\w+)\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)")
+OUTPUT = re.compile(r"^(\.\S+|\S+)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)(?:\s+load address (0x[0-9a-f]+))?)?\s*$")
+OUTPUT_NEXT = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)(?:\s+load address (0x[0-9a-f]+))?\s*$")
+INPUT = re.compile(r"^ (\S+)\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*)$")
+INPUT_NAME_ONLY = re.compile(r"^ (\.\S+)\s*$")
+INPUT_NEXT = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*)$")
+FILL = re.compile(r"^ \*fill\*\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)")
+LTRANS = re.compile(r"ltrans\d*\.ltrans\.o$|\.ltrans\d*\.o$")
+
+SECTION_PREFIXES = (".text.", ".rodata.", ".data.", ".bss.", ".ccmbss.", ".RamFunc.", ".noinit.")
+
+
+def module_of(obj, by_dir):
+    """A short name for the object an input section came from."""
+    obj = obj.strip().replace("\\", "/")
+    archive = re.match(r"(.*/)?([^/]+\.a)\(", obj)
+    if archive:
+        return archive.group(2)
+    if not obj.startswith("./"):
+        return "(toolchain)"
+    obj = obj[2:]
+    if by_dir:
+        return os.path.dirname(obj) or "."
+    return obj[:-2] if obj.endswith(".o") else obj
+
+
+def symbol_of(section):
+    """The function or variable a -ffunction-sections / -fdata-sections
+    section was made for, without the suffixes GCC adds to clones."""
+    for prefix in SECTION_PREFIXES:
+        if section.startswith(prefix):
+            return section[len(prefix):].split(".")[0]
+    return None
+
+
+def read_map(path):
+    """(regions, sections): the memory regions as name -> (origin, length),
+    and every non-empty input section as (region, load region, section name,
+    size, object), fill having no name or object."""
+    regions = {}
+    sections = []
+    vma_region = lma_region = None
+    in_memory = in_map = False
+    pending_output = pending_input = None
+
+    def region_at(address):
+        for name, (origin, length) in regions.items():
+            if name != "*default*" and origin <= address < origin + length:
+                return name
+        return None
+
+    def set_output(vma, lma):
+        nonlocal vma_region, lma_region
+        vma_region = region_at(int(vma, 16))
+        lma_region = region_at(int(lma, 16)) if lma else vma_region
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+
+            if line.startswith("Memory Configuration"):
+                in_memory = True
+                continue
+            if line.startswith("Linker script and memory map"):
+                in_memory, in_map = False, True
+                continue
+            if in_memory:
+                m = MEMORY.match(line)
+                if m:
+                    regions[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+                elif line.startswith("*default*"):
+                    regions["*default*"] = (0, 0xFFFFFFFF)
+                continue
+            if not in_map:
+                continue
+
+            # Long output and input section names push the address, size
+            # and object onto the next line.
+            if pending_output:
+                pending_output = None
+                m = OUTPUT_NEXT.match(line)
+                if m:
+                    set_output(m.group(1), m.group(3))
+                    continue
+            if pending_input:
+                name, pending_input = pending_input, None
+                m = INPUT_NEXT.match(line)
+                if m:
+                    sections.append((vma_region, lma_region, name, int(m.group(2), 16), m.group(3)))
+                    continue
+
+            if line and not line[0].isspace():
+                m = OUTPUT.match(line)
+                if m:
+                    if m.group(2):
+                        set_output(m.group(2), m.group(4))
+                    else:
+                        vma_region = lma_region = None
+                        pending_output = m.group(1)
+                continue
+
+            m = FILL.match(line)
+            if m:
+                sections.append((vma_region, lma_region, None, int(m.group(2), 16), None))
+                continue
+
+            m = INPUT.match(line)
+            if m:
+                sections.append((vma_region, lma_region, m.group(1), int(m.group(3), 16), m.group(4)))
+                continue
+
+            m = INPUT_NAME_ONLY.match(line)
+            if m:
+                pending_input = m.group(1)
+
+    return regions, [s for s in sections if s[0] is not None and s[3] > 0]
+
+
+def read_index(path, by_dir):
+    """Symbol -> module, from the section names of a map built without LTO."""
+    index = {}
+    if not path or not os.path.exists(path):
+        return index
+    for _, _, name, _, obj in read_map(path)[1]:
+        symbol = symbol_of(name) if name else None
+        if symbol and obj and not LTRANS.search(obj):
+            index.setdefault(symbol, module_of(obj, by_dir))
+    return index
+
+
+def sizes(path, by_dir, index):
+    """Module -> [flash, ram] in bytes."""
+    regions, sections = read_map(path)
+    ram_regions = set(name for name in regions if name not in ("FLASH", "*default*"))
+    table = {}
+
+    for vma, lma, name, size, obj in sections:
+        if name is None:
+            module = "(fill)"
+        elif LTRANS.search(obj.strip()):
+            module = index.get(symbol_of(name), "(lto)")
+        else:
+            module = module_of(obj, by_dir)
+
+        row = table.setdefault(module, [0, 0])
+        if vma == "FLASH" or lma == "FLASH":
+            row[0] += size
+        if vma in ram_regions:
+            row[1] += size
+    return table
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("map", help="linker map of the build to report, e.g. Release/Lab4.map")
+    parser.add_argument("--baseline", help="linker map of the build to compare against")
+    parser.add_argument("--index", default=os.path.join("Debug", "Lab4.map"),
+                        help="map of a build without LTO, to place LTO sections by name")
+    parser.add_argument("--by", choices=("module", "dir"), default="module",
+                        help="charge to each object or to each source directory")
+    parser.add_argument("--csv", action="store_true", help="print module,flash,ram rows")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.map):
+        sys.exit("no map at %s" % args.map)
+
+    by_dir = args.by == "dir"
+    index = read_index(args.index, by_dir)
+    now = sizes(args.map, by_dir, index)
+
+    if args.csv:
+        print("module,flash,ram")
+        for module in sorted(now):
+            print("%s,%d,%d" % (module, now[module][0], now[module][1]))
+        return
+
+    if not args.baseline:
+        print("%-54s %8s %8s" % ("module", "flash", "ram"))
+        for module, (flash, ram) in sorted(now.items(), key=lambda kv: (-kv[1][0], -kv[1][1], kv[0])):
+            print("%-54s %8d %8d" % (module, flash, ram))
+        print("%-54s %8d %8d" % ("total", sum(r[0] for r in now.values()), sum(r[1] for r in now.values())))
+        return
+
+    base = sizes(args.baseline, by_dir, index)
+    modules = set(now) | set(base)
+    rows = []
+    for module in modules:
+        b = base.get(module, [0, 0])
+        a = now.get(module, [0, 0])
+        rows.append((module, b[0], a[0], a[0] - b[0], b[1], a[1], a[1] - b[1]))
+
+    print("%-54s %9s %8s %7s %9s %8s %7s" % ("module", "flash was", "now", "change", "ram was", "now", "change"))
+    for row in sorted(rows, key=lambda r: (-r[3], -r[6], r[0])):
+        if row[1:] == (0, 0, 0, 0, 0, 0):
+            continue
+        print("%-54s %9d %8d %+7d %9d %8d %+7d" % row)
+    totals = [sum(r[i] for r in rows) for i in range(1, 7)]
+    print("%-54s %9d %8d %+7d %9d %8d %+7d" % tuple(["total"] + totals))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+Flat and per task profiles from the samples the PC sampling profiler logs.
+
+With profilerENABLE set the firmware logs a window of samples every
+profilerREPORT_MS, see Core/Inc/profiler.h:
+
+  prof,window,<samples>,<lost>,<rate Hz>
+  prof,<task>,<pc>,<count>
+
+This sums every window in a UART capture and names each PC after the
+function that holds it.  The functions come from the linker map: every code
+input section, .text and .RamFunc, is split at the symbols the map lists in
+it, and a section with none, as a static function's is, takes its name from
+the section, .text.<function>.  With --elf the symbol table from
+arm-none-eabi-nm is used instead, which sizes every function exactly and
+also knows the static ones inside a shared section.
+
+  python3 Tools/profile_report.py capture.txt [--map Debug/Lab4.map] [--elf Debug/Lab4.elf]
+                                  [--top 20] [--task NAME] [--lines]
+
+The flat profile lists the functions with the most samples first; then
+comes one profile per task, "isr" being samples taken inside another
+interrupt.  --lines keeps the PCs apart instead, for addr2line.
+"""
+
+import argparse
+import bisect
+import collections
+import re
+import subprocess
+import sys
+
+WINDOW_LINE = re.compile(r"prof,window,(\d+),(\d+),(\d+)")
+SAMPLE_LINE = re.compile(r"prof,([^,\s]+),0x([0-9a-fA-F]+),(\d+)")
+
+MAP_SECTION = re.compile(r"^ (\.text\S*|\.RamFunc\S*)\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+)")
+MAP_SECTION_NAME_ONLY = re.compile(r"^ (\.text\S*|\.RamFunc\S*)\s*$")
+MAP_ADDRESS_SIZE = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+)")
+MAP_SYMBOL = re.compile(r"^\s+(0x[0-9a-f]+)\s+([A-Za-z_]\w*)\s*$")
+NM_LINE = re.compile(r"^([0-9a-f]+)\s+([0-9a-f]+)\s+([tTwW])\s+(\S+)$")
+
+
+def read_capture(path):
+    """(samples, lost, rate, {(task, pc): count}) over every window."""
+    samples = lost = rate = 0
+    counts = collections.Counter()
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = WINDOW_LINE.search(line)
+            if m:
+                samples += int(m.group(1))
+                lost += int(m.group(2))
+                rate = int(m.group(3))
+                continue
+            m = SAMPLE_LINE.search(line)
+            if m:
+                counts[(m.group(1), int(m.group(2), 16))] += int(m.group(3))
+
+    return samples, lost, rate, counts
+
+
+def section_name(section):
+    """The function a -ffunction-sections section was made for."""
+    for prefix in (".text.", ".RamFunc."):
+        if section.startswith(prefix):
+            return section[len(prefix):].split(".")[0]
+    return None
+
+
+def read_map(path):
+    """Sorted (address, size, name) of every function in the map's code."""
+    sections = []
+    pending = None
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+
+            if pending is not None:
+                m = MAP_ADDRESS_SIZE.match(line)
+                if m:
+                    sections.append((int(m.group(1), 16), int(m.group(2), 16), pending, []))
+                pending = None
+                continue
+
+            m = MAP_SECTION.match(line)
+            if m:
+                sections.append((int(m.group(2), 16), int(m.group(3), 16), m.group(1), []))
+                continue
+
+            # Long section names push the address onto the next line.
+            m = MAP_SECTION_NAME_ONLY.match(line)
+            if m:
+                pending = m.group(1)
+                continue
+
+            m = MAP_SYMBOL.match(line)
+            if m and sections:
+                start, size, _, symbols = sections[-1]
+                address = int(m.group(1), 16)
+                if start <= address < start + size:
+                    symbols.append((address, m.group(2)))
+
+    funcs = []
+    for start, size, section, symbols in sections:
+        # Discarded sections are listed at 0.
+        if size == 0 or start == 0:
+            continue
+        if not symbols or symbols[0][0] != start:
+            symbols.insert(0, (start, section_name(section) or section))
+        symbols.sort()
+        ends = [a for a, _ in symbols[1:]] + [start + size]
+        for (address, name), stop in zip(symbols, ends):
+            if stop > address:
+                funcs.append((address, stop - address, name))
+    funcs.sort()
+    return funcs
+
+
+def read_elf(path):
+    """Sorted (address, size, name) of every function in the ELF."""
+    try:
+        out = subprocess.run(["arm-none-eabi-nm", "-S", "-n", "--defined-only", path],
+                             check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        sys.exit("arm-none-eabi-nm failed on %s: %s" % (path, e))
+
+    funcs = []
+    for line in out.splitlines():
+        m = NM_LINE.match(line)
+        if m:
+            # Thumb function symbols may carry bit 0.
+            funcs.append((int(m.group(1), 16) & ~1, int(m.group(2), 16), m.group(4)))
+    funcs.sort()
+    return funcs
+
+
+def symbolize(funcs, pc):
+    """The function holding pc, or its address if none does."""
+    i = bisect.bisect_right(funcs, (pc, float("inf"), "")) - 1
+    if i >= 0:
+        address, size, name = funcs[i]
+        if address <= pc < address + size:
+            return name
+    return "0x%08x" % pc
+
+
+def print_profile(title, counts, total, top):
+    print("%s: %d samples" % (title, sum(counts.values())))
+    print("  %8s %6s %6s  %s" % ("samples", "%", "cum %", "function"))
+    cumulative = 0
+    for name, count in counts.most_common(top):
+        cumulative += count
+        print("  %8d %6.2f %6.2f  %s" % (count, count * 100.0 / total, cumulative * 100.0 / total, name))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("capture", help="UART capture with prof lines")
+    parser.add_argument("--map", default="Debug/Lab4.map", help="linker map of the build")
+    parser.add_argument("--elf", help="ELF of the build, read with arm-none-eabi-nm instead of the map")
+    parser.add_argument("--top", type=int, default=20, help="rows per profile")
+    parser.add_argument("--task", help="only this task's profile")
+    parser.add_argument("--lines", action="store_true", help="profile PCs rather than functions")
+    args = parser.parse_args()
+
+    samples, lost, rate, counts = read_capture(args.capture)
+    if not counts:
+        sys.exit("no prof lines in %s" % args.capture)
+
+    funcs = read_elf(args.elf) if args.elf else read_map(args.map)
+
+    flat = collections.Counter()
+    tasks = collections.defaultdict(collections.Counter)
+    for (task, pc), count in counts.items():
+        name = symbolize(funcs, pc)
+        if args.lines:
+            name = "0x%08x %s" % (pc, name)
+        flat[name] += count
+        tasks[task][name] += count
+
+    total = sum(flat.values())
+    print("%d samples at %d Hz, %.1f s, %d lost (%.2f%%)" %
+          (samples, rate, (samples / float(rate)) if rate else 0.0, lost,
+           (lost * 100.0 / samples) if samples else 0.0))
+    print()
+
+    if not args.task:
+        print_profile("all", flat, total, args.top)
+
+    for task in sorted(tasks, key=lambda t: -sum(tasks[t].values())):
+        if args.task and task != args.task:
+            continue
+        print_profile("task %s, %.2f%% of samples" % (task, sum(tasks[task].values()) * 100.0 / total),
+                      tasks[task], total, args.top)
+
+
+if __name__ == "__main__":
+    main()
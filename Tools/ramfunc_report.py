@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Which functions run from SRAM, what they cost in SRAM and flash, and what
+that bought in cycles.
+
+Functions tagged portKERNEL_HOT_PATH or portHEAP_HOT_PATH land in .RamFunc
+when configKERNEL_HOT_PATHS_IN_RAM or configHEAP_HOT_PATHS_IN_RAM is 1.  The
+startup code copies them from flash to SRAM with .data, so each costs its size
+twice.  The placement is read from the linker map, Debug/Lab4.map.
+
+The cycle comparison takes two UART captures, one from a build with the hot
+paths in flash and one with them in SRAM, and compares the last of each of
+the lines the firmware logs every few seconds:
+
+  malloc cycles min/avg/max: a/b/c free: d/e/f     (vPrintHeapStats)
+  switch cycles min/max: a/b fpu: c/d              (vCpuStatsPrintSwitchTime)
+
+Both captures should come from the same clock profile.
+
+  python3 Tools/ramfunc_report.py [--build Debug] [--before flash.txt --after ram.txt]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+MAP_SECTION = re.compile(r"^ (\.RamFunc\S*)\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+)")
+MAP_SECTION_NAME_ONLY = re.compile(r"^ (\.RamFunc\S*)\s*$")
+MAP_ADDRESS_SIZE = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+)")
+MAP_SYMBOL = re.compile(r"^\s+(0x[0-9a-f]+)\s+([A-Za-z_]\w*)\s*$")
+
+HEAP_LINE = re.compile(r"malloc cycles min/avg/max: (\d+)/(\d+)/(\d+) free: (\d+)/(\d+)/(\d+)")
+SWITCH_LINE = re.compile(r"switch cycles min/max: (\d+|-)/(\d+|-) fpu: (\d+|-)/(\d+|-)")
+
+HEAP_FIELDS = ("malloc min", "malloc avg", "malloc max", "free min", "free avg", "free max")
+SWITCH_FIELDS = ("switch min", "switch max", "switch fpu min", "switch fpu max")
+
+
+def read_ramfuncs(map_path):
+    """(symbol, address, bytes, object) for every function in .RamFunc.
+
+    Functions from one object share an input section, so each is sized up to
+    the next symbol or the end of its section."""
+    sections = []
+    pending = False
+
+    with open(map_path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+
+            if pending:
+                pending = False
+                m = MAP_ADDRESS_SIZE.match(line)
+                if m:
+                    sections.append((int(m.group(1), 16), int(m.group(2), 16), m.group(3), []))
+                continue
+
+            m = MAP_SECTION.match(line)
+            if m:
+                sections.append((int(m.group(2), 16), int(m.group(3), 16), m.group(4), []))
+                continue
+
+            # Long section names push the address onto the next line.
+            if MAP_SECTION_NAME_ONLY.match(line):
+                pending = True
+                continue
+
+            m = MAP_SYMBOL.match(line)
+            if m and sections:
+                start, size, _, symbols = sections[-1]
+                address = int(m.group(1), 16)
+                if start <= address < start + size:
+                    symbols.append((address, m.group(2)))
+
+    funcs = []
+    for start, size, obj, symbols in sections:
+        if size == 0:
+            continue
+        if not symbols:
+            funcs.append(("?", start, size, obj))
+            continue
+        symbols.sort()
+        ends = [a for a, _ in symbols[1:]] + [start + size]
+        for (address, name), stop in zip(symbols, ends):
+            funcs.append((name, address, stop - address, obj))
+    return funcs
+
+
+def last_match(path, pattern):
+    found = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = pattern.search(line)
+            if m:
+                found = m.groups()
+    return found
+
+
+def compare(label_fields, before, after):
+    if before is None or after is None:
+        print("  (%s line missing from a capture)" % label_fields[0].split()[0])
+        return
+    for name, b, a in zip(label_fields, before, after):
+        if b == "-" or a == "-":
+            print("  %-16s %8s %8s" % (name, b, a))
+            continue
+        b, a = int(b), int(a)
+        delta = ("%+.1f%%" % ((a - b) * 100.0 / b)) if b else ""
+        print("  %-16s %8d %8d %8s" % (name, b, a, delta))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--build", default="Debug", help="build directory holding Lab4.map")
+    parser.add_argument("--before", help="UART capture of a build with the hot paths in flash")
+    parser.add_argument("--after", help="UART capture of a build with the hot paths in SRAM")
+    args = parser.parse_args()
+
+    map_path = os.path.join(args.build, "Lab4.map")
+    if not os.path.exists(map_path):
+        sys.exit("no linker map at %s" % map_path)
+
+    funcs = read_ramfuncs(map_path)
+    total = 0
+    print("%-28s %-10s %6s  %s" % ("function", "address", "bytes", "object"))
+    for name, address, size, obj in sorted(funcs, key=lambda f: f[1]):
+        print("%-28s 0x%08x %6d  %s" % (name or "?", address, size, os.path.basename(obj)))
+        total += size
+    print("%d functions, %d bytes of SRAM and as many of flash" % (len(funcs), total))
+
+    if args.before and args.after:
+        print()
+        print("  %-16s %8s %8s %8s" % ("cycles", "flash", "sram", "change"))
+        compare(HEAP_FIELDS, last_match(args.before, HEAP_LINE), last_match(args.after, HEAP_LINE))
+        compare(SWITCH_FIELDS, last_match(args.before, SWITCH_LINE), last_match(args.after, SWITCH_LINE))
+    elif args.before or args.after:
+        sys.exit("--before and --after go together")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,345 @@
+#!/usr/bin/env python3
+"""
+Worst case stack depth of every task in APP_TASK_TABLE and of every task
+declared with TASK_REGISTER() or TASK_REGISTER_IN() in Core/Src, and of the
+main stack the interrupts share.
+
+The static figure combines the per function frame sizes that -fstack-usage
+writes to Debug/**/*.su with a call graph recovered from the direct calls and
+tail calls in the objdump listing Debug/Lab4.list, then adds the exception
+frames the Cortex-M4F port stacks on a task's PSP:
+
+  - an interrupt taken while the task runs stacks 8 words, or 26 words when
+    the task has used the FPU (lazy stacking still reserves the space);
+  - PendSV then saves r4-r11 and r14, plus s16-s31 for an FPU task.
+
+Handlers themselves run on MSP, so nested interrupts cost the task nothing.
+They are the MSP row instead: one handler per priority of BOARD_IRQ_TABLE in
+Core/Inc/irqtable.h, the deepest at each, with PendSV and SVC at the lowest
+and the fault handlers above them all, nested in that order.  Every handler
+that preempts another stacks its frame on MSP, 26 words if the one it
+preempts uses the FPU.  The depth is _Min_Stack_Size from the linker script.
+
+Indirect calls, recursion, dynamically sized frames and functions without .su
+data (assembly, newlib) make the static figure a lower bound; such tasks are
+flagged and the recommendation leans on the runtime watermark instead.  The
+watermark comes from the "stack" lines vStackCheckReport() writes to the log;
+pass a capture of the UART output with --log.
+
+  python3 Tools/stack_usage.py [--build Debug] [--log capture.txt]
+"""
+
+import argparse
+import glob
+import math
+import os
+import re
+import sys
+
+WORD = 4
+
+# Exception frames on the task stack, in words.
+HW_FRAME = 8
+HW_FRAME_FPU = 26
+SW_FRAME = 9
+SW_FRAME_FPU = 25
+
+TABLE_ROW = re.compile(r"X\(\s*(\w+)\s*,\s*(\w+)\s*,\s*(\d+)\s*,\s*(\d+)\s*,\s*(\w+)\s*\)")
+SU_LINE = re.compile(r"^(.*):(\d+):(\d+):([^\t]+)\t(\d+)\t(\S+)")
+LIST_FUNC = re.compile(r"^([0-9a-f]{8}) <([^>]+)>:$")
+LIST_INSN = re.compile(r"^\s*[0-9a-f]+:\s+(?:[0-9a-f]{4} ?){1,2}\s+(\S+)\s*(.*)$")
+BRANCH_TARGET = re.compile(r"^[0-9a-f]+ <([^>+]+)>$")
+REGISTER_LINE = re.compile(r"^TASK_REGISTER(?:_IN)?\((?:\s*(?:SRAM|CCM)\s*,)?\s*(\w+)\s*,\s*(\w+)\s*,"
+                           r"\s*[^,]+,\s*([^,]+?)\s*,", re.M)
+DEFINE_LINE = re.compile(r"^#define\s+(\w+)\s+\(?\s*(\d+)U?\s*\)?\s*$", re.M)
+LOG_LINE = re.compile(r"stack\s+(\S+)\s+depth\s+(\d+)\s+used\s+(\d+)")
+IRQ_ROW = re.compile(r"X\(\s*(\w+)\s*,\s*([^,]+?)\s*,\s*(KERNEL|FAST|BARE)\s*\)")
+ANY_DEFINE = re.compile(r"^#define\s+(\w+)[ \t]+([^/\n]+?)\s*(?:/[*/].*)?$", re.M)
+MIN_STACK = re.compile(r"^_Min_Stack_Size\s*=\s*(0x[0-9a-fA-F]+|\d+)", re.M)
+CAST = re.compile(r"\(\s*(?:uint32_t|UBaseType_t|BaseType_t)\s*\)")
+INT_SUFFIX = re.compile(r"\b(0x[0-9a-fA-F]+|\d+)[uUlL]+\b")
+NAME = re.compile(r"\b[A-Za-z_]\w*\b")
+
+# Exceptions outside BOARD_IRQ_TABLE that run on MSP.
+KERNEL_HANDLERS = ("PendSV_Handler", "SVC_Handler", "SysTick_Handler")
+FAULT_HANDLERS = ("NMI_Handler", "HardFault_Handler", "MemManage_Handler", "BusFault_Handler",
+                  "UsageFault_Handler")
+
+CALLS = ("bl",)
+TAIL_CALLS = ("b", "b.w", "b.n")
+INDIRECT_CALLS = ("blx",)
+
+
+class Function:
+    def __init__(self, name):
+        self.name = name
+        self.frame = None          # Bytes, None if no .su data.
+        self.dynamic = False
+        self.calls = set()
+        self.indirect = False
+        self.fpu = False
+
+
+def parse_table(path):
+    rows = []
+    with open(path) as f:
+        text = f.read()
+    body = text[text.index("#define APP_TASK_TABLE"):]
+    body = body[:body.index("\n\n")]
+    for m in TABLE_ROW.finditer(body):
+        rows.append((m.group(1), m.group(2), int(m.group(3))))
+    return rows
+
+
+def parse_registered(src, inc):
+    """TASK_REGISTER() rows outside the table, depths resolved through plain
+    numeric #defines in the headers."""
+    defines = {}
+    for path in glob.glob(os.path.join(inc, "*.h")):
+        with open(path) as f:
+            defines.update((m.group(1), int(m.group(2))) for m in DEFINE_LINE.finditer(f.read()))
+    rows = []
+    for path in sorted(glob.glob(os.path.join(src, "*.c"))):
+        with open(path) as f:
+            for m in REGISTER_LINE.finditer(f.read()):
+                depth = m.group(3)
+                depth = int(depth.rstrip("U")) if depth.rstrip("U").isdigit() else defines.get(depth)
+                if depth is not None:
+                    rows.append((m.group(1), m.group(2), depth))
+    return rows
+
+
+def parse_su(build, funcs):
+    for path in glob.glob(os.path.join(build, "**", "*.su"), recursive=True):
+        with open(path) as f:
+            for line in f:
+                m = SU_LINE.match(line.rstrip("\n"))
+                if not m:
+                    continue
+                fn = funcs.setdefault(m.group(4), Function(m.group(4)))
+                # Static functions of the same name in two units share an
+                # entry, so keep the larger frame.
+                fn.frame = max(fn.frame or 0, int(m.group(5)))
+                # "dynamic,bounded" still has a known upper limit.
+                fn.dynamic |= m.group(6) == "dynamic"
+
+
+def parse_list(path, funcs):
+    current = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = LIST_FUNC.match(line.rstrip("\n"))
+            if m:
+                current = funcs.setdefault(m.group(2), Function(m.group(2)))
+                continue
+            if current is None:
+                continue
+            m = LIST_INSN.match(line)
+            if not m:
+                continue
+            op, args = m.group(1), m.group(2).split(";")[0].split("@")[0].strip()
+            if op.startswith("v"):
+                current.fpu = True
+            if op in INDIRECT_CALLS:
+                current.indirect = True
+                continue
+            t = BRANCH_TARGET.match(args)
+            if not t:
+                continue
+            target = t.group(1)
+            if op in CALLS or (op in TAIL_CALLS and target != current.name):
+                current.calls.add(target)
+
+
+def walk(funcs, name, stack, memo):
+    """Return (bytes, fpu, caveats, path) for the deepest chain from name."""
+    if name in memo:
+        return memo[name]
+    fn = funcs.get(name)
+    if fn is None:
+        return 0, False, {"no code for " + name}, [name]
+    caveats = set()
+    if fn.frame is None:
+        caveats.add("no .su for " + name)
+    if fn.dynamic:
+        caveats.add("dynamic frame in " + name)
+    if fn.indirect:
+        caveats.add("indirect call in " + name)
+    deepest, fpu, path = 0, fn.fpu, []
+    stack.add(name)
+    for callee in sorted(fn.calls):
+        if callee in stack:
+            caveats.add("recursion through " + callee)
+            continue
+        depth, callee_fpu, callee_caveats, callee_path = walk(funcs, callee, stack, memo)
+        caveats |= callee_caveats
+        fpu |= callee_fpu
+        if depth > deepest:
+            deepest, path = depth, callee_path
+    stack.discard(name)
+    result = ((fn.frame or 0) + deepest, fpu, caveats, [name] + path)
+    memo[name] = result
+    return result
+
+
+def parse_defines(paths):
+    defines = {}
+    for path in paths:
+        with open(path) as f:
+            defines.update((m.group(1), m.group(2)) for m in ANY_DEFINE.finditer(f.read()))
+    return defines
+
+
+def resolve(expr, defines, depth=0):
+    """Value of a constant expression of the headers, None if unknown."""
+    def expand(m):
+        if m.group(0) not in defines or depth > 8:
+            raise KeyError(m.group(0))
+        value = resolve(defines[m.group(0)], defines, depth + 1)
+        if value is None:
+            raise KeyError(m.group(0))
+        return "(%d)" % value
+    try:
+        expr = NAME.sub(expand, INT_SUFFIX.sub(r"\1", CAST.sub("", expr)))
+        return int(eval(expr, {"__builtins__": {}}))
+    except (KeyError, SyntaxError, TypeError, NameError):
+        return None
+
+
+def parse_irq_levels(table, defines):
+    """{priority: [handler, ...]}, the most urgent priority lowest; the fault
+    handlers are at -1."""
+    with open(table) as f:
+        text = f.read()
+    body = text[text.index("#define BOARD_IRQ_TABLE"):]
+    body = body[:body.index("\n\n")]
+    lowest = resolve("configLIBRARY_LOWEST_INTERRUPT_PRIORITY", defines)
+    levels = {-1: list(FAULT_HANDLERS), lowest: list(KERNEL_HANDLERS)}
+    for m in IRQ_ROW.finditer(body):
+        priority = resolve(m.group(2), defines)
+        if priority is None:
+            sys.exit("cannot work out the priority of %s: %s" % (m.group(1), m.group(2)))
+        levels.setdefault(priority, []).append(m.group(1) + "_IRQHandler")
+    return levels
+
+
+def msp_worst_case(funcs, levels, memo):
+    """(bytes, frame words, caveats, per level notes) of the deepest nesting."""
+    total, frames, caveats, notes = 0, 0, set(), []
+    below_fpu = None
+    for priority in sorted(levels, reverse=True):
+        deepest = None
+        for handler in levels[priority]:
+            # Handlers of peripherals this image does not use are not linked.
+            if handler not in funcs:
+                continue
+            depth, fpu, handler_caveats, _ = walk(funcs, handler, set(), memo)
+            if deepest is None or depth > deepest[0]:
+                deepest = (depth, fpu, handler_caveats, handler)
+        if deepest is None:
+            continue
+        depth, fpu, handler_caveats, handler = deepest
+        total += depth
+        caveats |= handler_caveats
+        # The least urgent level is entered from a task, on its PSP.
+        if below_fpu is not None:
+            frames += HW_FRAME_FPU if below_fpu else HW_FRAME
+        below_fpu = fpu
+        notes.append("%s %s %d bytes" % ("fault" if priority < 0 else "priority %d" % priority, handler, depth))
+    return total, frames, caveats, notes
+
+
+def parse_log(path):
+    """Return {task: (depth, most words ever used)} from a UART capture."""
+    used = {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = LOG_LINE.search(line)
+            if m:
+                seen = used.get(m.group(1), (0, 0))[1]
+                used[m.group(1)] = (int(m.group(2)), max(seen, int(m.group(3))))
+    return used
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0].strip())
+    ap.add_argument("--build", default=os.path.join(root, "Debug"), help="build directory with .su files")
+    ap.add_argument("--list", help="objdump listing, default <build>/Lab4.list")
+    ap.add_argument("--table", default=os.path.join(root, "Core", "Inc", "tasktable.h"))
+    ap.add_argument("--irqs", default=os.path.join(root, "Core", "Inc", "irqtable.h"))
+    ap.add_argument("--ld", default=os.path.join(root, "STM32F407VGTX_FLASH.ld"),
+                    help="linker script giving _Min_Stack_Size")
+    ap.add_argument("--log", help="UART capture containing vStackCheckReport() output")
+    ap.add_argument("--margin", type=float, default=0.1, help="headroom as a fraction, default 0.1")
+    ap.add_argument("-v", "--verbose", action="store_true", help="print the deepest call chain and caveats")
+    args = ap.parse_args()
+
+    funcs = {}
+    parse_su(args.build, funcs)
+    parse_list(args.list or os.path.join(args.build, "Lab4.list"), funcs)
+    rows = parse_table(args.table)
+    rows += parse_registered(os.path.join(root, "Core", "Src"), os.path.dirname(args.table))
+    used = parse_log(args.log) if args.log else {}
+
+    print("%-10s %-16s %6s %7s %6s %6s %6s  %s" %
+          ("task", "entry", "config", "static", "frames", "used", "recom", "notes"))
+    memo = {}
+    for name, entry, depth in rows:
+        static, fpu, caveats, path = walk(funcs, entry, set(), memo)
+        frames = (HW_FRAME_FPU + SW_FRAME_FPU) if fpu else (HW_FRAME + SW_FRAME)
+        static_words = math.ceil(static / WORD) + frames
+        need = static_words
+        runtime = used.pop(name, (None, None))[1]
+        if runtime is not None:
+            need = max(need, runtime)
+        recommended = math.ceil(need * (1.0 + args.margin))
+        notes = []
+        if caveats:
+            notes.append("lower bound")
+        if recommended > depth:
+            notes.append("TOO SMALL")
+        elif recommended < depth and (runtime is not None or not caveats):
+            notes.append("save %d words" % (depth - recommended))
+        print("%-10s %-16s %6d %7d %6d %6s %6d  %s" %
+              (name, entry, depth, static_words - frames, frames,
+               "-" if runtime is None else str(runtime), recommended, ", ".join(notes)))
+        if args.verbose:
+            print("    deepest: " + " -> ".join(path))
+            for c in sorted(caveats):
+                print("    " + c)
+
+    defines = parse_defines(glob.glob(os.path.join(os.path.dirname(args.irqs), "*.h")) +
+                            [os.path.join(root, "FreeRTOS", "include", "FreeRTOSConfig.h")])
+    with open(args.ld) as f:
+        msp_depth = int(MIN_STACK.search(f.read()).group(1), 0) // WORD
+    static, frames, caveats, notes = msp_worst_case(funcs, parse_irq_levels(args.irqs, defines), memo)
+    static_words = math.ceil(static / WORD)
+    runtime = used.pop("MSP", (None, None))[1]
+    recommended = math.ceil(max(static_words + frames, runtime or 0) * (1.0 + args.margin))
+    status = []
+    if caveats:
+        status.append("lower bound")
+    if recommended > msp_depth:
+        status.append("TOO SMALL")
+    elif recommended < msp_depth and (runtime is not None or not caveats):
+        status.append("save %d words" % (msp_depth - recommended))
+    print("%-10s %-16s %6d %7d %6d %6s %6d  %s" %
+          ("MSP", "(interrupts)", msp_depth, static_words, frames,
+           "-" if runtime is None else str(runtime), recommended, ", ".join(status)))
+    if args.verbose:
+        for note in notes:
+            print("    " + note)
+        for c in sorted(caveats):
+            print("    " + c)
+
+    # Tasks outside the table, such as IDLE, have only a watermark.
+    for name, (depth, runtime) in sorted(used.items()):
+        print("%-10s %-16s %6d %7s %6s %6d %6d" %
+              (name, "-", depth, "-", "-", runtime, math.ceil(runtime * (1.0 + args.margin))))
+    print("\nstatic and frames in words; config, used and recom are stack depths in words.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,260 @@
+#!/usr/bin/env python3
+"""
+Turn a UART capture of the trace recorder's binary frames into a Perfetto
+timeline.
+
+With configUSE_TRACE_RECORDER and traceBINARY set the firmware sends its
+trace records (see Core/Inc/trace.h) as frames
+
+  0xB2, record count, then per record: timestamp in core cycles (4 bytes),
+  argument 0 (4 bytes), argument 1 (2 bytes), event code, reserved byte
+
+  0xB3, name length, task or queue address (4 bytes), name
+
+all little endian, mixed with any text other code writes to the log.  This
+writes the records as Chrome trace event JSON, which ui.perfetto.dev opens
+directly: one track per task with the spans it ran and the spans it was
+blocked and on what, queue operations, notifications and allocations as
+instants on the track of the task (or interrupt) that made them, and counter
+tracks for the items in each queue and the bytes allocated.
+
+Timestamps are DWT cycle counts, which wrap every 2^32 cycles; the firmware
+reports SystemCoreClock whenever it changes, and --hz gives the clock for any
+records before the first report.  A gap of more than one wrap between two
+records, as in STOP mode where the counter stops, cannot be told apart from
+a shorter one.
+
+  python3 Tools/trace_export.py capture.bin [--out trace.json] [--hz 168000000]
+  python3 Tools/trace_export.py capture.bin --text
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+SYNC_RECORDS = 0xB2
+SYNC_NAME = 0xB3
+RECORD = struct.Struct("<IIHBB")
+MAX_RECORDS = 64
+MAX_NAME = 32
+
+# Codes as in Core/Inc/trace.h.
+EVENTS = {
+    1: "MALLOC",
+    2: "FREE",
+    3: "TASK_CREATE",
+    4: "TASK_DELETE",
+    5: "TASK_DELETE_TCB",
+    6: "TASK_SWITCHED_IN",
+    7: "TASK_READY",
+    8: "TASK_DELAY",
+    9: "TASK_DELAY_UNTIL",
+    10: "TASK_SUSPEND",
+    11: "TASK_RESUME",
+    12: "TASK_RESUME_FROM_ISR",
+    13: "TASK_PRIORITY_SET",
+    14: "TASK_PRIORITY_INHERIT",
+    15: "TASK_PRIORITY_DISINHERIT",
+    16: "QUEUE_CREATE",
+    17: "QUEUE_DELETE",
+    18: "QUEUE_REGISTRY_ADD",
+    19: "QUEUE_SEND",
+    20: "QUEUE_SEND_FAILED",
+    21: "QUEUE_RECEIVE",
+    22: "QUEUE_RECEIVE_FAILED",
+    23: "QUEUE_PEEK",
+    24: "QUEUE_SEND_FROM_ISR",
+    25: "QUEUE_RECEIVE_FROM_ISR",
+    26: "BLOCKING_ON_QUEUE_SEND",
+    27: "BLOCKING_ON_QUEUE_RECEIVE",
+    28: "BLOCKING_ON_QUEUE_PEEK",
+    29: "TASK_NOTIFY",
+    30: "TASK_NOTIFY_FROM_ISR",
+    31: "TASK_NOTIFY_GIVE_FROM_ISR",
+    32: "TASK_NOTIFY_TAKE_BLOCK",
+    33: "TASK_NOTIFY_WAIT_BLOCK",
+    34: "DROPPED",
+    35: "CLOCK",
+}
+CODES = {name: code for code, name in EVENTS.items()}
+
+# Track for events made from interrupts.
+ISR_TID = 0
+
+
+def read_records(data):
+    """[(cycles, event, arg0, arg1)] in capture order, and {address: name}."""
+    records = []
+    names = {}
+    pos = 0
+
+    while pos < len(data):
+        byte = data[pos]
+        if byte == SYNC_RECORDS and pos + 2 <= len(data):
+            count = data[pos + 1]
+            end = pos + 2 + count * RECORD.size
+            if 1 <= count <= MAX_RECORDS and end <= len(data):
+                frame = [RECORD.unpack_from(data, pos + 2 + i * RECORD.size) for i in range(count)]
+                if all(event in EVENTS for _, _, _, event, _ in frame):
+                    records.extend((cycles, event, arg0, arg1) for cycles, arg0, arg1, event, _ in frame)
+                    pos = end
+                    continue
+        elif byte == SYNC_NAME and pos + 6 <= len(data):
+            length = data[pos + 1]
+            end = pos + 6 + length
+            if length <= MAX_NAME and end <= len(data):
+                name = data[pos + 6:end]
+                if all(0x20 <= c < 0x7F for c in name):
+                    address, = struct.unpack_from("<I", data, pos + 2)
+                    names[address] = name.decode("ascii")
+                    pos = end
+                    continue
+        # Text, or a cut off frame; resynchronise on the next byte.
+        pos += 1
+
+    return records, names
+
+
+def times_us(records, hz):
+    """The time of each record in microseconds from the first, unwrapping the
+    cycle counter and following the clock reports."""
+    times = []
+    now = 0.0
+    last = None
+    for cycles, event, arg0, _ in records:
+        if last is not None:
+            now += ((cycles - last) & 0xFFFFFFFF) * 1e6 / hz
+        last = cycles
+        times.append(now)
+        if event == CODES["CLOCK"] and arg0:
+            hz = arg0
+    return times
+
+
+def timeline(records, names, hz):
+    """Chrome trace events for the records."""
+    out = []
+    tids = {}
+    running = None
+    blocked = {}
+    queue_items = {}
+    live = {}
+    heap = 0
+
+    def name_of(address):
+        return names.get(address, "0x%08x" % address)
+
+    def tid_of(task):
+        if task not in tids:
+            tids[task] = len(tids) + 1
+            out.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": tids[task],
+                        "args": {"name": name_of(task)}})
+            out.append({"ph": "M", "name": "thread_sort_index", "pid": 1, "tid": tids[task],
+                        "args": {"sort_index": tids[task]}})
+        return tids[task]
+
+    def instant(ts, tid, name, **args):
+        out.append({"ph": "i", "s": "t", "name": name, "pid": 1, "tid": tid, "ts": ts, "args": args})
+
+    def span(start, end, tid, name, cat, **args):
+        out.append({"ph": "X", "name": name, "cat": cat, "pid": 1, "tid": tid, "ts": start,
+                    "dur": max(end - start, 0.0), "args": args})
+
+    def counter(ts, name, value):
+        out.append({"ph": "C", "name": name, "pid": 1, "ts": ts, "args": {"value": value}})
+
+    out.append({"ph": "M", "name": "process_name", "pid": 1, "args": {"name": "target"}})
+    out.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": ISR_TID, "args": {"name": "interrupts"}})
+
+    for ts, (_, event, arg0, arg1) in zip(times_us(records, hz), records):
+        kind = EVENTS[event]
+        here = ISR_TID if kind.endswith("FROM_ISR") or running is None else tid_of(running[0])
+
+        if kind == "TASK_SWITCHED_IN":
+            if running is not None:
+                span(running[1], ts, tid_of(running[0]), "running", "sched", priority=running[2])
+            running = (arg0, ts, arg1)
+            tid_of(arg0)
+        elif kind == "TASK_READY":
+            if arg0 in blocked:
+                start, reason = blocked.pop(arg0)
+                span(start, ts, tid_of(arg0), reason, "blocked")
+        elif kind in ("BLOCKING_ON_QUEUE_SEND", "BLOCKING_ON_QUEUE_RECEIVE", "BLOCKING_ON_QUEUE_PEEK"):
+            if running is not None:
+                verb = kind.rsplit("_", 1)[1].lower()
+                blocked[running[0]] = (ts, "blocked on %s %s" % (verb, name_of(arg0)))
+        elif kind in ("TASK_DELAY", "TASK_DELAY_UNTIL"):
+            if running is not None:
+                blocked[running[0]] = (ts, "delay")
+        elif kind in ("TASK_NOTIFY_TAKE_BLOCK", "TASK_NOTIFY_WAIT_BLOCK"):
+            if running is not None:
+                blocked[running[0]] = (ts, "blocked on notification %d" % arg1)
+        elif kind == "TASK_SUSPEND":
+            blocked[arg0] = (ts, "suspended")
+        elif kind.startswith("TASK_NOTIFY"):
+            instant(ts, here, "notify %s" % name_of(arg0), index=arg1)
+        elif kind.startswith("QUEUE_SEND") or kind.startswith("QUEUE_RECEIVE") or kind == "QUEUE_PEEK":
+            instant(ts, here, "%s %s" % (kind.lower().replace("_from_isr", ""), name_of(arg0)), items=arg1)
+            if kind in ("QUEUE_SEND", "QUEUE_SEND_FROM_ISR"):
+                queue_items[arg0] = arg1 + 1
+            elif kind in ("QUEUE_RECEIVE", "QUEUE_RECEIVE_FROM_ISR"):
+                queue_items[arg0] = max(arg1 - 1, 0)
+            else:
+                continue
+            counter(ts, "queue %s" % name_of(arg0), queue_items[arg0])
+        elif kind == "MALLOC":
+            if arg0 == 0:
+                instant(ts, here, "malloc failed", size=arg1)
+            else:
+                live[arg0] = arg1
+                heap += arg1
+                instant(ts, here, "malloc", address="0x%08x" % arg0, size=arg1)
+                counter(ts, "heap allocated", heap)
+        elif kind == "FREE":
+            heap -= live.pop(arg0, 0)
+            instant(ts, here, "free", address="0x%08x" % arg0, size=arg1)
+            counter(ts, "heap allocated", heap)
+        elif kind == "DROPPED":
+            out.append({"ph": "i", "s": "g", "name": "%d records dropped since boot" % arg0, "pid": 1, "ts": ts})
+        elif kind == "CLOCK":
+            continue
+        elif kind.startswith("TASK_"):
+            instant(ts, tid_of(arg0), kind.lower(), argument=arg1)
+        else:
+            instant(ts, here, kind.lower(), object=name_of(arg0), argument=arg1)
+
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("capture", help="raw UART capture, or - for stdin")
+    parser.add_argument("--out", default="trace.json", help="JSON file to write")
+    parser.add_argument("--hz", type=int, default=168000000, help="core clock before the first clock report")
+    parser.add_argument("--text", action="store_true", help="print the records instead")
+    args = parser.parse_args()
+
+    if args.capture == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+
+    records, names = read_records(data)
+    if not records:
+        sys.exit("no trace records in %s" % args.capture)
+
+    if args.text:
+        for ts, (_, event, arg0, arg1) in zip(times_us(records, args.hz), records):
+            print("%14.3f us  %-26s %-16s %u" % (ts, EVENTS[event], names.get(arg0, "0x%08x" % arg0), arg1))
+        return
+
+    with open(args.out, "w") as f:
+        json.dump({"traceEvents": timeline(records, names, args.hz), "displayTimeUnit": "ns"}, f)
+
+    print("%d records, %d names written to %s" % (len(records), len(names), args.out))
+
+
+if __name__ == "__main__":
+    main()